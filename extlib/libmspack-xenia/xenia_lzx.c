@@ -161,3 +161,71 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
 
   return result_code;
 }
+
+typedef struct mspack_callback_file_t {
+  lzx_read_fn read_fn;
+  void* opaque;
+} mspack_callback_file;
+static int mspack_callback_read(struct mspack_file* file, void* buffer, int chars) {
+  mspack_callback_file* cbfile = (mspack_callback_file*)file;
+  return cbfile->read_fn(cbfile->opaque, buffer, chars);
+}
+
+struct lzx_stream {
+  struct mspack_system sys;
+  mspack_callback_file src;
+  mspack_memory_file dst;
+  struct lzxd_stream* lzxd;
+};
+
+struct lzx_stream* lzx_stream_init(uint32_t window_size, size_t dest_len,
+                                   lzx_read_fn read_fn, void* opaque) {
+  struct lzx_stream* stream;
+  uint32_t window_bits;
+
+  if (!read_fn || !bit_scan_forward(window_size, &window_bits)) {
+    return NULL;
+  }
+
+  stream = (struct lzx_stream*)calloc(1, sizeof(struct lzx_stream));
+  if (!stream) {
+    return NULL;
+  }
+  stream->sys.read = mspack_callback_read;
+  stream->sys.write = mspack_memory_write;
+  stream->sys.alloc = mspack_memory_alloc;
+  stream->sys.free = mspack_memory_free;
+  stream->sys.copy = mspack_memory_copy;
+  stream->src.read_fn = read_fn;
+  stream->src.opaque = opaque;
+
+  stream->lzxd = lzxd_init(&stream->sys, (struct mspack_file*)&stream->src,
+                           (struct mspack_file*)&stream->dst, window_bits, 0,
+                           0x8000, (off_t)dest_len, 0);
+  if (!stream->lzxd) {
+    free(stream);
+    return NULL;
+  }
+  return stream;
+}
+
+int lzx_stream_read(struct lzx_stream* stream, void* dest, size_t dest_len) {
+  assert_true(dest_len < INT_MAX);
+  if (!stream || dest_len >= INT_MAX) {
+    return MSPACK_ERR_ARGS;
+  }
+
+  // Write directly to the caller's buffer.
+  stream->dst.buffer = dest;
+  stream->dst.buffer_size = (off_t)dest_len;
+  stream->dst.offset = 0;
+  return lzxd_decompress(stream->lzxd, (off_t)dest_len);
+}
+
+void lzx_stream_free(struct lzx_stream* stream) {
+  if (!stream) {
+    return;
+  }
+  lzxd_free(stream->lzxd);
+  free(stream);
+}
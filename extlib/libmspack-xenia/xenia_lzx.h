@@ -21,6 +21,44 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
                    size_t dest_len, uint32_t window_size, void* window_data,
                    size_t window_data_len);
 
+/**
+ * Streaming LZX decompression.
+ * Compressed data is requested from read_fn() as needed, and the
+ * decompressed data is returned in pieces by lzx_stream_read().
+ * Memory usage is bounded by the LZX window size.
+ *
+ * read_fn() returns the number of bytes read, 0 at the end of
+ * the compressed data, or a negative value on error.
+ */
+typedef int (*lzx_read_fn)(void* opaque, void* buf, int size);
+struct lzx_stream;
+
+/**
+ * Initialize a streaming LZX decompressor.
+ * @param window_size LZX window size.
+ * @param dest_len Total size of the decompressed data.
+ * @param read_fn Compressed data read function.
+ * @param opaque Parameter for read_fn().
+ * @return lzx_stream, or NULL on error.
+ */
+struct lzx_stream* lzx_stream_init(uint32_t window_size, size_t dest_len,
+                                   lzx_read_fn read_fn, void* opaque);
+
+/**
+ * Decompress the next dest_len bytes.
+ * @param stream lzx_stream.
+ * @param dest Output buffer.
+ * @param dest_len Number of bytes to decompress.
+ * @return 0 (MSPACK_ERR_OK) on success; MSPACK_ERR_* on error.
+ */
+int lzx_stream_read(struct lzx_stream* stream, void* dest, size_t dest_len);
+
+/**
+ * Free a streaming LZX decompressor.
+ * @param stream lzx_stream.
+ */
+void lzx_stream_free(struct lzx_stream* stream);
+
 #ifdef __cplusplus
 }
 #endif
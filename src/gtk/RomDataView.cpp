@@ -105,6 +105,10 @@ static void	rom_data_view_init_header_row	(RomDataView	*page);
 static void	rom_data_view_update_display	(RomDataView	*page);
 static gboolean	rom_data_view_load_rom_data	(gpointer	 data);
 static void	rom_data_view_delete_tabs	(RomDataView	*page);
+static void	rom_data_view_add_fields	(RomDataView	*page,
+						 const RomFields *pFields);
+static void	rom_data_view_load_tab		(RomDataView	*page,
+						 int		 tabIdx);
 
 /** Signal handlers. **/
 static void	checkbox_no_toggle_signal_handler   (GtkToggleButton	*togglebutton,
@@ -117,6 +121,10 @@ static void	tree_view_realize_signal_handler    (GtkTreeView	*treeView,
 						     RomDataView	*page);
 static void	cboLanguage_changed_signal_handler  (GtkComboBox	*widget,
 						     gpointer	 	 user_data);
+static void	tabWidget_switch_page_signal_handler(GtkNotebook	*notebook,
+						     GtkWidget		*tab_page,
+						     guint		 page_num,
+						     RomDataView	*page);
 
 /** Icon animation timer. **/
 static void	start_anim_timer(RomDataView *page);
@@ -140,20 +148,22 @@ struct _RomDataViewClass {
 
 // Multi-language stuff.
 typedef enum _StringMultiColumns { SM_COL_ICON, SM_COL_TEXT, SM_COL_LC } StringMultiColumns;
-typedef std::pair<GtkWidget*, const RomFields::Field*> Data_StringMulti_t;
+// NOTE: Fields are stored as indexes, since loading more tabs
+// may reallocate the fields and invalidate Field pointers.
+typedef std::pair<GtkWidget*, int> Data_StringMulti_t;
 
 struct Data_ListDataMulti_t {
 	GtkListStore *listStore;
 	GtkTreeView *treeView;
-	const RomFields::Field *field;
+	int fieldIdx;
 
 	Data_ListDataMulti_t(
 		GtkListStore *listStore,
 		GtkTreeView *treeView,
-		const RomFields::Field *field)
+		int fieldIdx)
 		: listStore(listStore)
 		, treeView(treeView)
-		, field(field) { }
+		, fieldIdx(fieldIdx) { }
 };
 
 // GTK+ property page.
@@ -191,9 +201,15 @@ struct _RomDataView {
 		GtkWidget	*vbox;		// Either page or a GtkVBox/GtkBox.
 		GtkWidget	*table;		// GtkTable (2.x); GtkGrid (3.x)
 		GtkWidget	*lblCredits;
+		int		rowCount;	// Rows used in the table.
 	};
 	vector<tab>	*tabs;
 
+	// Lazy tab loading.
+	int		fieldsShown;		// Number of fields that have widgets.
+	uint32_t	tabsNamedMask;		// RomFields::TabMask of named tabs.
+	GtkSizeGroup	*size_group;		// Description label size group.
+
 	// Description labels.
 	RpDescFormatType	desc_format_type;
 	vector<GtkWidget*>	*vecDescLabels;
@@ -338,6 +354,9 @@ rom_data_view_init(RomDataView *page)
 	page->iconAnimHelper = new IconAnimHelper();
 	page->tabWidget = nullptr;
 	page->tabs = new vector<RomDataView::tab>();
+	page->fieldsShown = 0;
+	page->tabsNamedMask = RomFields::TAB_MASK_NONE;
+	page->size_group = nullptr;
 
 	page->desc_format_type = RP_DFT_XFCE;
 
@@ -915,12 +934,13 @@ rom_data_view_init_bitfield(RomDataView *page, const RomFields::Field &field)
 
 /**
  * Initialize a list data field.
- * @param page	[in] RomDataView object.
- * @param field	[in] RomFields::Field
+ * @param page		[in] RomDataView object.
+ * @param field		[in] RomFields::Field
+ * @param fieldIdx	[in] Field index.
  * @return Display widget, or nullptr on error.
  */
 static GtkWidget*
-rom_data_view_init_listdata(G_GNUC_UNUSED RomDataView *page, const RomFields::Field &field)
+rom_data_view_init_listdata(G_GNUC_UNUSED RomDataView *page, const RomFields::Field &field, int fieldIdx)
 {
 	// ListData type. Create a GtkListStore for the data.
 	const auto &listDataDesc = field.desc.list_data;
@@ -1174,7 +1194,7 @@ rom_data_view_init_listdata(G_GNUC_UNUSED RomDataView *page, const RomFields::Fi
 
 	if (isMulti) {
 		page->vecListDataMulti->emplace_back(
-			Data_ListDataMulti_t(listStore, GTK_TREE_VIEW(treeView), &field));
+			Data_ListDataMulti_t(listStore, GTK_TREE_VIEW(treeView), fieldIdx));
 	}
 
 	return widget;
@@ -1282,12 +1302,13 @@ rom_data_view_init_dimensions(G_GNUC_UNUSED RomDataView *page, const RomFields::
 
 /**
  * Initialize a multi-language string field.
- * @param page	[in] RomDataView object.
- * @param field	[in] RomFields::Field
+ * @param page		[in] RomDataView object.
+ * @param field		[in] RomFields::Field
+ * @param fieldIdx	[in] Field index.
  * @return Display widget, or nullptr on error.
  */
 static GtkWidget*
-rom_data_view_init_string_multi(G_GNUC_UNUSED RomDataView *page, const RomFields::Field &field)
+rom_data_view_init_string_multi(G_GNUC_UNUSED RomDataView *page, const RomFields::Field &field, int fieldIdx)
 {
 	// Mutli-language string.
 	// NOTE: The string contents won't be initialized here.
@@ -1295,7 +1316,7 @@ rom_data_view_init_string_multi(G_GNUC_UNUSED RomDataView *page, const RomFields
 	// be able to change the displayed language.
 	GtkWidget *const lblStringMulti = rom_data_view_init_string(page, field, "");
 	if (lblStringMulti) {
-		page->vecStringMulti->emplace_back(lblStringMulti, &field);
+		page->vecStringMulti->emplace_back(lblStringMulti, fieldIdx);
 	}
 	return lblStringMulti;
 }
@@ -1371,13 +1392,20 @@ rom_data_view_update_cboLanguage_images(RomDataView *page)
 static void
 rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
 {
+	// Only use the fields that have already been loaded.
+	const RomFields *const pFields = (page->romData ? page->romData->fields(RomFields::TAB_MASK_NONE) : nullptr);
+	if (!pFields) {
+		// No fields...
+		return;
+	}
+
 	// RFT_STRING_MULTI
 	for (auto iter = page->vecStringMulti->cbegin();
 	     iter != page->vecStringMulti->cend(); ++iter)
 	{
 		GtkWidget *const lblString = iter->first;
-		const RomFields::Field *const pField = iter->second;
-		const auto *const pStr_multi = pField->data.str_multi;
+		const RomFields::Field *const pField = pFields->at(iter->second);
+		const auto *const pStr_multi = (pField ? pField->data.str_multi : nullptr);
 		assert(pStr_multi != nullptr);
 		assert(!pStr_multi->empty());
 		if (!pStr_multi || pStr_multi->empty()) {
@@ -1421,8 +1449,8 @@ rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
 	     iter != page->vecListDataMulti->cend(); ++iter)
 	{
 		GtkListStore *const listStore = iter->listStore;
-		const RomFields::Field *const pField = iter->field;
-		const auto *const pListData_multi = pField->data.list_data.data.multi;
+		const RomFields::Field *const pField = pFields->at(iter->fieldIdx);
+		const auto *const pListData_multi = (pField ? pField->data.list_data.data.multi : nullptr);
 		assert(pListData_multi != nullptr);
 		assert(!pListData_multi->empty());
 		if (!pListData_multi || pListData_multi->empty()) {
@@ -1601,19 +1629,19 @@ rom_data_view_update_display(RomDataView *page)
 	}
 
 	// Get the fields.
-	const RomFields *const pFields = page->romData->fields();
+	// Only the first tab is loaded here. The names of all tabs
+	// are set by the first call, so all tabs can be created now;
+	// the other tabs are loaded when they're selected.
+	const RomFields *const pFields = page->romData->fields(RomFields::tabMaskBit(0));
 	if (!pFields) {
 		// No fields.
 		// TODO: Show an error?
 		return;
 	}
 	const int count = pFields->count();
-#if !GTK_CHECK_VERSION(3,0,0)
-	int rowCount = count;
-#endif
 
 	// Create the GtkNotebook.
-	int tabCount = pFields->tabCount();
+	const int tabCount = pFields->tabCount();
 	if (tabCount > 1) {
 		page->tabs->resize(tabCount);
 		page->tabWidget = gtk_notebook_new();
@@ -1631,6 +1659,8 @@ rom_data_view_update_display(RomDataView *page)
 			}
 
 			auto &tab = *tabIter;
+			const uint32_t tabBit = RomFields::tabMaskBit(i);
+			page->tabsNamedMask |= (tabBit != RomFields::TAB_MASK_NONE ? tabBit : RomFields::TAB_MASK_ALL);
 #if GTK_CHECK_VERSION(3,0,0)
 			tab.vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
 			tab.table = gtk_grid_new();
@@ -1639,7 +1669,7 @@ rom_data_view_update_display(RomDataView *page)
 #else /* !GTK_CHECK_VERSION(3,0,0) */
 			tab.vbox = gtk_vbox_new(false, 8);
 			// TODO: Adjust the table size?
-			tab.table = gtk_table_new(rowCount, 2, false);
+			tab.table = gtk_table_new(count, 2, false);
 			gtk_table_set_row_spacings(GTK_TABLE(tab.table), 2);
 			gtk_table_set_col_spacings(GTK_TABLE(tab.table), 8);
 #endif /* GTK_CHECK_VERSION(3,0,0) */
@@ -1649,6 +1679,9 @@ rom_data_view_update_display(RomDataView *page)
 			gtk_widget_show(tab.table);
 			gtk_widget_show(tab.vbox);
 
+			// Save the tab index for the "switch-page" signal handler.
+			g_object_set_data(G_OBJECT(tab.vbox), "RomDataView.tabIdx", GINT_TO_POINTER(i));
+
 			// Add the tab.
 			GtkWidget *label = gtk_label_new(name);
 			gtk_notebook_append_page(GTK_NOTEBOOK(page->tabWidget), tab.vbox, label);
@@ -1659,8 +1692,8 @@ rom_data_view_update_display(RomDataView *page)
 		// No tabs.
 		// Don't create a GtkNotebook, but simulate a single
 		// tab in page->tabs[] to make it easier to work with.
-		tabCount = 1;
 		page->tabs->resize(1);
+		page->tabsNamedMask = RomFields::tabMaskBit(0);
 		auto &tab = page->tabs->at(0);
 		tab.vbox = GTK_WIDGET(page);
 
@@ -1680,25 +1713,57 @@ rom_data_view_update_display(RomDataView *page)
 		gtk_widget_show(tab.table);
 	}
 
-	// Reserve enough space for vecDescLabels.
-	page->vecDescLabels->reserve(count);
-	// Per-tab row counts.
-	vector<int> tabRowCount(page->tabs->size());
-
 	// Use a GtkSizeGroup to ensure that the description
 	// labels on all tabs have the same width.
 	// NOTE: GtkSizeGroup automatically unreferences itself
 	// once all referenced widgets are deleted, so we don't
 	// need to manage it ourselves.
-	GtkSizeGroup *const size_group = gtk_size_group_new(GTK_SIZE_GROUP_HORIZONTAL);
+	page->size_group = gtk_size_group_new(GTK_SIZE_GROUP_HORIZONTAL);
+
+	// Create the data widgets for the first tab.
+	rom_data_view_add_fields(page, pFields);
+
+	if (page->tabWidget) {
+		// Load the other tabs when they're selected.
+		g_signal_connect(page->tabWidget, "switch-page",
+			G_CALLBACK(tabWidget_switch_page_signal_handler), page);
+
+		// The current tab might not be the first tab
+		// if the first tab doesn't have a name.
+		GtkWidget *const curTab = gtk_notebook_get_nth_page(GTK_NOTEBOOK(page->tabWidget),
+			gtk_notebook_get_current_page(GTK_NOTEBOOK(page->tabWidget)));
+		if (curTab) {
+			rom_data_view_load_tab(page,
+				GPOINTER_TO_INT(g_object_get_data(G_OBJECT(curTab), "RomDataView.tabIdx")));
+		}
+	}
+}
+
+/**
+ * Create widgets for fields that don't have widgets yet.
+ * @param page		[in] RomDataView object.
+ * @param pFields	[in] RomFields from page->romData.
+ */
+static void
+rom_data_view_add_fields(RomDataView *page, const RomFields *pFields)
+{
+	const int count = pFields->count();
+#if !GTK_CHECK_VERSION(3,0,0)
+	int rowCount = count;
+#endif
+
+	// Reserve enough space for vecDescLabels.
+	page->vecDescLabels->reserve(page->vecDescLabels->size() + (count - page->fieldsShown));
+	// Check for new multi-language fields afterwards.
+	const size_t stringMultiCount = page->vecStringMulti->size();
+	const size_t listDataMultiCount = page->vecListDataMulti->size();
 
 	// tr: Field description label.
 	const char *const desc_label_fmt = C_("RomDataView", "%s:");
 
 	// Create the data widgets.
-	const auto iter_end = pFields->cend();
-	for (auto iter = pFields->cbegin(); iter != iter_end; ++iter) {
-		const RomFields::Field &field = *iter;
+	for (int fieldIdx = page->fieldsShown; fieldIdx < count; fieldIdx++) {
+		const RomFields::Field &field = *pFields->at(fieldIdx);
 		if (!field.isValid)
 			continue;
 
@@ -1732,7 +1797,7 @@ rom_data_view_update_display(RomDataView *page)
 				break;
 			case RomFields::RFT_LISTDATA:
 				separate_rows = !!(field.desc.list_data.flags & RomFields::RFT_LISTDATA_SEPARATE_ROW);
-				widget = rom_data_view_init_listdata(page, field);
+				widget = rom_data_view_init_listdata(page, field, fieldIdx);
 				break;
 			case RomFields::RFT_DATETIME:
 				widget = rom_data_view_init_datetime(page, field);
@@ -1744,7 +1809,7 @@ rom_data_view_update_display(RomDataView *page)
 				widget = rom_data_view_init_dimensions(page, field);
 				break;
 			case RomFields::RFT_STRING_MULTI:
-				widget = rom_data_view_init_string_multi(page, field);
+				widget = rom_data_view_init_string_multi(page, field, fieldIdx);
 				break;
 		}
 
@@ -1757,7 +1822,7 @@ rom_data_view_update_display(RomDataView *page)
 			GtkWidget *lblDesc = gtk_label_new(txt.c_str());
 			gtk_label_set_use_underline(GTK_LABEL(lblDesc), false);
 			gtk_widget_show(lblDesc);
-			gtk_size_group_add_widget(size_group, lblDesc);
+			gtk_size_group_add_widget(page->size_group, lblDesc);
 			page->vecDescLabels->emplace_back(lblDesc);
 
 			// Check if this is an RFT_STRING with warning set.
@@ -1770,7 +1835,7 @@ rom_data_view_update_display(RomDataView *page)
 			set_label_format_type(GTK_LABEL(lblDesc), page->desc_format_type);
 
 			// Value widget.
-			int &row = tabRowCount[tabIdx];
+			int &row = tab.rowCount;
 #if GTK_CHECK_VERSION(3,0,0)
 			// TODO: GTK_FILL
 			gtk_grid_attach(GTK_GRID(tab.table), lblDesc, 0, row, 1, 1);
@@ -1792,20 +1857,11 @@ rom_data_view_update_display(RomDataView *page)
 
 				// If this is the last field in the tab,
 				// put the RFT_LISTDATA in the GtkGrid instead.
-				bool doVBox = false;
-				RomFields::const_iterator nextIter = iter;
-				++nextIter;
-				if (tabIdx + 1 == tabCount && (nextIter == iter_end)) {
-					// Last tab, and last field.
-					doVBox = true;
-				} else {
-					// Check if the next field is on the next tab.
-					const RomFields::Field &nextField = *nextIter;
-					if (nextField.tabIdx != tabIdx) {
-						// Next field is on the next tab.
-						doVBox = true;
-					}
-				}
+				// NOTE: All fields for a tab are loaded at once,
+				// so the next field is either on another tab or
+				// hasn't been loaded at all.
+				const bool doVBox = (fieldIdx + 1 >= count ||
+					pFields->at(fieldIdx + 1)->tabIdx != tabIdx);
 
 				if (doVBox) {
 					// FIXME: There still seems to be a good amount of space
@@ -1879,10 +1935,53 @@ rom_data_view_update_display(RomDataView *page)
 		}
 	}
 
-	// Initial update of RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
-	if (!page->vecStringMulti->empty() || !page->vecListDataMulti->empty()) {
-		page->def_lc = pFields->defaultLanguageCode();
-		rom_data_view_update_multi(page, 0);
+	page->fieldsShown = count;
+
+	// Update the new RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
+	if (page->vecStringMulti->size() != stringMultiCount ||
+	    page->vecListDataMulti->size() != listDataMultiCount)
+	{
+		if (page->cboLanguage) {
+			// Use the selected language.
+			cboLanguage_changed_signal_handler(GTK_COMBO_BOX(page->cboLanguage), page);
+		} else {
+			// Initial update.
+			page->def_lc = pFields->defaultLanguageCode();
+			rom_data_view_update_multi(page, 0);
+		}
+	}
+}
+
+/**
+ * Load a tab's fields if they haven't been loaded yet.
+ * The file is closed once all tabs have been loaded.
+ * @param page		[in] RomDataView object.
+ * @param tabIdx	[in] Tab index.
+ */
+static void
+rom_data_view_load_tab(RomDataView *page, int tabIdx)
+{
+	if (!page->romData) {
+		// No ROM data...
+		return;
+	}
+
+	uint32_t tabMask = RomFields::tabMaskBit(tabIdx);
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Tab index is too high for a TabMask.
+		tabMask = RomFields::TAB_MASK_ALL;
+	}
+	if ((page->romData->fieldTabsLoaded() & tabMask) != tabMask) {
+		const RomFields *const pFields = page->romData->fields(tabMask);
+		if (pFields) {
+			rom_data_view_add_fields(page, pFields);
+		}
+	}
+
+	// Close the underlying file handle once all tabs
+	// have been loaded, since it won't be needed anymore.
+	if ((page->romData->fieldTabsLoaded() & page->tabsNamedMask) == page->tabsNamedMask) {
+		page->romData->close();
 	}
 }
 
@@ -1922,7 +2021,11 @@ rom_data_view_load_rom_data(gpointer data)
 		// Make sure the underlying file handle is closed,
 		// since we don't need it once the RomData has been
 		// loaded by RomDataView.
-		if (page->romData) {
+		// NOTE: If some tabs haven't been loaded yet, the file
+		// is closed by rom_data_view_load_tab() once they are.
+		if (page->romData &&
+		    (page->romData->fieldTabsLoaded() & page->tabsNamedMask) == page->tabsNamedMask)
+		{
 			page->romData->close();
 		}
 	}
@@ -1949,6 +2052,13 @@ rom_data_view_delete_tabs(RomDataView *page)
 	assert(page->vecStringMulti != nullptr);
 	assert(page->vecListDataMulti != nullptr);
 
+	if (page->tabWidget) {
+		// Deleting the tabs may switch pages.
+		// Don't try to load the tabs that are being deleted.
+		g_signal_handlers_disconnect_by_func(page->tabWidget,
+			(gpointer)tabWidget_switch_page_signal_handler, page);
+	}
+
 	// Delete the tab contents.
 	std::for_each(page->tabs->begin(), page->tabs->end(),
 		[page](_RomDataView::tab &tab) {
@@ -1964,6 +2074,9 @@ rom_data_view_delete_tabs(RomDataView *page)
 		}
 	);
 	page->tabs->clear();
+	page->fieldsShown = 0;
+	page->tabsNamedMask = RomFields::TAB_MASK_NONE;
+	page->size_group = nullptr;
 
 	if (page->tabWidget) {
 		// Delete the tab widget.
@@ -2148,6 +2261,26 @@ cboLanguage_changed_signal_handler(GtkComboBox	*widget,
 	rom_data_view_update_multi(page, lc);
 }
 
+/**
+ * A different tab was selected.
+ * Load the tab's fields if they haven't been loaded yet.
+ * @param notebook	GtkNotebook
+ * @param tab_page	Tab page widget.
+ * @param page_num	Tab page number.
+ * @param page		RomDataView
+ */
+static void
+tabWidget_switch_page_signal_handler(GtkNotebook	*notebook,
+				     GtkWidget		*tab_page,
+				     guint		 page_num,
+				     RomDataView	*page)
+{
+	RP_UNUSED(notebook);
+	RP_UNUSED(page_num);
+	rom_data_view_load_tab(page,
+		GPOINTER_TO_INT(g_object_get_data(G_OBJECT(tab_page), "RomDataView.tabIdx")));
+}
+
 /** Icon animation timer. **/
 
 /**
@@ -90,16 +90,23 @@ class RomDataViewPrivate
 		};
 		vector<tab> tabs;
 
+		// Lazy tab loading.
+		int fieldsShown;		// Number of fields that have widgets.
+		uint32_t tabsNamedMask;		// RomFields::TabMask of named tabs.
+
 		// Multi-language functionality.
 		uint32_t def_lc;
 		QComboBox *cboLanguage;
 
+		// NOTE: Fields are stored as indexes, since loading more tabs
+		// may reallocate the fields and invalidate Field pointers.
+
 		// RFT_STRING_MULTI value labels.
-		typedef QPair<QLabel*, const RomFields::Field*> Data_StringMulti_t;
+		typedef QPair<QLabel*, int> Data_StringMulti_t;
 		QVector<Data_StringMulti_t> vecStringMulti;
 
 		// RFT_LISTDATA_MULTI value QTreeWidgets.
-		typedef QPair<QTreeWidget*, const RomFields::Field*> Data_ListDataMulti_t;
+		typedef QPair<QTreeWidget*, int> Data_ListDataMulti_t;
 		QVector<Data_ListDataMulti_t> vecListDataMulti;
 
 		// RomData object.
@@ -148,8 +155,9 @@ class RomDataViewPrivate
 		 * Initialize a list data field.
 		 * @param lblDesc	[in] Description label.
 		 * @param field		[in] RomFields::Field
+		 * @param fieldIdx	[in] Field index.
 		 */
-		void initListData(QLabel *lblDesc, const RomFields::Field &field);
+		void initListData(QLabel *lblDesc, const RomFields::Field &field, int fieldIdx);
 
 		/**
 		 * Adjust an RFT_LISTDATA field if it's the last field in a tab.
@@ -182,8 +190,9 @@ class RomDataViewPrivate
 		 * Initialize a multi-language string field.
 		 * @param lblDesc	[in] Description label.
 		 * @param field		[in] RomFields::Field
+		 * @param fieldIdx	[in] Field index.
 		 */
-		void initStringMulti(QLabel *lblDesc, const RomFields::Field &field);
+		void initStringMulti(QLabel *lblDesc, const RomFields::Field &field, int fieldIdx);
 
 		/**
 		 * Update all multi-language fields.
@@ -197,12 +206,27 @@ class RomDataViewPrivate
 		 * be deleted and recreated.
 		 */
 		void initDisplayWidgets(void);
+
+		/**
+		 * Create widgets for fields that don't have widgets yet.
+		 * @param pFields RomFields from romData.
+		 */
+		void addFields(const RomFields *pFields);
+
+		/**
+		 * Load a tab's fields if they haven't been loaded yet.
+		 * The file is closed once all tabs have been loaded.
+		 * @param tabIdx Tab index.
+		 */
+		void loadTab(int tabIdx);
 };
 
 /** RomDataViewPrivate **/
 
 RomDataViewPrivate::RomDataViewPrivate(RomDataView *q, RomData *romData)
 	: q_ptr(q)
+	, fieldsShown(0)
+	, tabsNamedMask(RomFields::TAB_MASK_NONE)
 	, def_lc(0)
 	, cboLanguage(nullptr)
 	, romData(romData->ref())
@@ -477,8 +501,9 @@ void RomDataViewPrivate::initBitfield(QLabel *lblDesc, const RomFields::Field &f
  * Initialize a list data field.
  * @param lblDesc Description label.
  * @param field RomFields::Field
+ * @param fieldIdx Field index.
  */
-void RomDataViewPrivate::initListData(QLabel *lblDesc, const RomFields::Field &field)
+void RomDataViewPrivate::initListData(QLabel *lblDesc, const RomFields::Field &field, int fieldIdx)
 {
 	// ListData type. Create a QTreeWidget.
 	const auto &listDataDesc = field.desc.list_data;
@@ -685,7 +710,7 @@ void RomDataViewPrivate::initListData(QLabel *lblDesc, const RomFields::Field &f
 	treeWidget->installEventFilter(q);
 
 	if (isMulti) {
-		vecListDataMulti.append(Data_ListDataMulti_t(treeWidget, &field));
+		vecListDataMulti.append(Data_ListDataMulti_t(treeWidget, fieldIdx));
 	}
 }
 
@@ -870,8 +895,9 @@ void RomDataViewPrivate::initDimensions(QLabel *lblDesc, const RomFields::Field
  * Initialize a multi-language string field.
  * @param lblDesc	[in] Description label.
  * @param field		[in] RomFields::Field
+ * @param fieldIdx	[in] Field index.
  */
-void RomDataViewPrivate::initStringMulti(QLabel *lblDesc, const RomFields::Field &field)
+void RomDataViewPrivate::initStringMulti(QLabel *lblDesc, const RomFields::Field &field, int fieldIdx)
 {
 	// Mutli-language string.
 	// NOTE: The string contents won't be initialized here.
@@ -881,7 +907,7 @@ void RomDataViewPrivate::initStringMulti(QLabel *lblDesc, const RomFields::Field
 	QString qs_empty;
 	QLabel *const lblStringMulti = initString(lblDesc, field, &qs_empty);
 	if (lblStringMulti) {
-		vecStringMulti.append(Data_StringMulti_t(lblStringMulti, &field));
+		vecStringMulti.append(Data_StringMulti_t(lblStringMulti, fieldIdx));
 	}
 }
 
@@ -891,6 +917,13 @@ void RomDataViewPrivate::initStringMulti(QLabel *lblDesc, const RomFields::Field
  */
 void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 {
+	// Only use the fields that have already been loaded.
+	const RomFields *const pFields = (romData ? romData->fields(RomFields::TAB_MASK_NONE) : nullptr);
+	if (!pFields) {
+		// No fields...
+		return;
+	}
+
 	// Set of supported language codes.
 	// NOTE: Using std::set instead of QSet for sorting.
 	set<uint32_t> set_lc;
@@ -898,8 +931,8 @@ void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 	// RFT_STRING_MULTI
 	foreach(const Data_StringMulti_t &data, vecStringMulti) {
 		QLabel *const lblString = data.first;
-		const RomFields::Field *const pField = data.second;
-		const auto *const pStr_multi = pField->data.str_multi;
+		const RomFields::Field *const pField = pFields->at(data.second);
+		const auto *const pStr_multi = (pField ? pField->data.str_multi : nullptr);
 		assert(pStr_multi != nullptr);
 		assert(!pStr_multi->empty());
 		if (!pStr_multi || pStr_multi->empty()) {
@@ -941,8 +974,8 @@ void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 	// RFT_LISTDATA_MULTI
 	foreach(const Data_ListDataMulti_t &data, vecListDataMulti) {
 		QTreeWidget *const treeWidget = data.first;
-		const RomFields::Field *const pField = data.second;
-		const auto *const pListData_multi = pField->data.list_data.data.multi;
+		const RomFields::Field *const pField = pFields->at(data.second);
+		const auto *const pListData_multi = (pField ? pField->data.list_data.data.multi : nullptr);
 		assert(pListData_multi != nullptr);
 		assert(!pListData_multi->empty());
 		if (!pListData_multi || pListData_multi->empty()) {
@@ -1095,8 +1128,16 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 		}
 	);
 	tabs.clear();
+	fieldsShown = 0;
+	tabsNamedMask = RomFields::TAB_MASK_NONE;
+	vecStringMulti.clear();
+	vecListDataMulti.clear();
+
+	// Don't load tabs while the QTabWidget is being changed.
+	ui.tabWidget->blockSignals(true);
 	ui.tabWidget->clear();
 	ui.tabWidget->hide();
+	ui.tabWidget->blockSignals(false);
 
 	// Initialize the header row.
 	initHeaderRow();
@@ -1107,7 +1148,10 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	}
 
 	// Get the fields.
-	const RomFields *const pFields = romData->fields();
+	// Only the first tab is loaded here. The names of all tabs
+	// are set by the first call, so all tabs can be created now;
+	// the other tabs are loaded when they're selected.
+	const RomFields *const pFields = romData->fields(RomFields::tabMaskBit(0));
 	if (!pFields) {
 		// No fields.
 		// TODO: Show an error?
@@ -1119,6 +1163,7 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	const int tabCount = pFields->tabCount();
 	if (tabCount > 1) {
 		tabs.resize(tabCount);
+		ui.tabWidget->blockSignals(true);
 		ui.tabWidget->show();
 		for (int i = 0; i < tabCount; i++) {
 			// Create a tab.
@@ -1130,6 +1175,11 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 
 			auto &tab = tabs[i];
 			QWidget *widget = new QWidget(q);
+			const uint32_t tabBit = RomFields::tabMaskBit(i);
+			tabsNamedMask |= (tabBit != RomFields::TAB_MASK_NONE ? tabBit : RomFields::TAB_MASK_ALL);
+
+			// Save the tab index for tabWidget_currentChanged_slot().
+			widget->setProperty("RomDataView.tabIdx", i);
 
 			// Layouts.
 			// NOTE: We shouldn't zero out the QVBoxLayout margins here.
@@ -1141,11 +1191,13 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 			// Add the tab.
 			ui.tabWidget->addTab(widget, (name ? U82Q(name) : QString()));
 		}
+		ui.tabWidget->blockSignals(false);
 	} else {
 		// No tabs.
 		// Don't create a QTabWidget, but simulate a single
 		// tab in tabs[] to make it easier to work with.
 		tabs.resize(1);
+		tabsNamedMask = RomFields::tabMaskBit(0);
 		auto &tab = tabs[0];
 
 		// QVBoxLayout
@@ -1158,6 +1210,35 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 		tab.vboxLayout->addLayout(tab.formLayout, 1);
 	}
 
+	// Create the data widgets for the first tab.
+	addFields(pFields);
+
+	if (tabCount > 1) {
+		// The current tab might not be the first tab
+		// if the first tab doesn't have a name.
+		// Other tabs are loaded by tabWidget_currentChanged_slot().
+		QWidget *const curTab = ui.tabWidget->currentWidget();
+		if (curTab) {
+			loadTab(curTab->property("RomDataView.tabIdx").toInt());
+		}
+	} else {
+		loadTab(0);
+	}
+}
+
+/**
+ * Create widgets for fields that don't have widgets yet.
+ * @param pFields RomFields from romData.
+ */
+void RomDataViewPrivate::addFields(const RomFields *pFields)
+{
+	Q_Q(RomDataView);
+	const int count = pFields->count();
+
+	// Check for new multi-language fields afterwards.
+	const int stringMultiCount = vecStringMulti.size();
+	const int listDataMultiCount = vecListDataMulti.size();
+
 	// TODO: Ensure the description column has the
 	// same width on all tabs.
 
@@ -1165,10 +1246,11 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	const char *const desc_label_fmt = C_("RomDataView", "%s:");
 
 	// Create the data widgets.
-	int prevTabIdx = 0;
-	const auto iter_end = pFields->cend();
-	for (auto iter = pFields->cbegin(); iter != iter_end; ++iter) {
-		const RomFields::Field &field = *iter;
+	// NOTE: All fields for a tab are loaded at once,
+	// so each tab is only adjusted once.
+	int prevTabIdx = -1;
+	for (int fieldIdx = fieldsShown; fieldIdx < count; fieldIdx++) {
+		const RomFields::Field &field = *pFields->at(fieldIdx);
 		if (!field.isValid)
 			continue;
 
@@ -1188,7 +1270,9 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 			// Check if the last field in the previous tab
 			// was RFT_LISTDATA. If it is, expand it vertically.
 			// NOTE: Only for RFT_LISTDATA_SEPARATE_ROW.
-			adjustListData(prevTabIdx);
+			if (prevTabIdx >= 0) {
+				adjustListData(prevTabIdx);
+			}
 			prevTabIdx = tabIdx;
 		}
 
@@ -1216,7 +1300,7 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 				initBitfield(lblDesc, field);
 				break;
 			case RomFields::RFT_LISTDATA:
-				initListData(lblDesc, field);
+				initListData(lblDesc, field, fieldIdx);
 				break;
 			case RomFields::RFT_DATETIME:
 				initDateTime(lblDesc, field);
@@ -1228,28 +1312,66 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 				initDimensions(lblDesc, field);
 				break;
 			case RomFields::RFT_STRING_MULTI:
-				initStringMulti(lblDesc, field);
+				initStringMulti(lblDesc, field, fieldIdx);
 				break;
 		}
 	}
 
-	// Initial update of RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
-	if (!vecStringMulti.isEmpty() || !vecListDataMulti.isEmpty()) {
-		def_lc = pFields->defaultLanguageCode();
-		updateMulti(0);
+	fieldsShown = count;
+
+	// Update the new RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
+	if (vecStringMulti.size() != stringMultiCount ||
+	    vecListDataMulti.size() != listDataMultiCount)
+	{
+		if (cboLanguage) {
+			// Use the selected language.
+			const int index = cboLanguage->currentIndex();
+			updateMulti(index >= 0 ? cboLanguage->itemData(index).value<uint32_t>() : 0);
+		} else {
+			// Initial update.
+			def_lc = pFields->defaultLanguageCode();
+			updateMulti(0);
+		}
 	}
 
-	// Check if the last field in the last tab
+	// Check if the last field in the last loaded tab
 	// was RFT_LISTDATA. If it is, expand it vertically.
 	// NOTE: Only for RFT_LISTDATA_SEPARATE_ROW.
-	if (!tabs.empty()) {
-		adjustListData(static_cast<int>(tabs.size()-1));
+	if (prevTabIdx >= 0) {
+		adjustListData(prevTabIdx);
 	}
+}
 
-	// Close the file.
+/**
+ * Load a tab's fields if they haven't been loaded yet.
+ * The file is closed once all tabs have been loaded.
+ * @param tabIdx Tab index.
+ */
+void RomDataViewPrivate::loadTab(int tabIdx)
+{
+	if (!romData) {
+		// No ROM data...
+		return;
+	}
+
+	uint32_t tabMask = RomFields::tabMaskBit(tabIdx);
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Tab index is too high for a TabMask.
+		tabMask = RomFields::TAB_MASK_ALL;
+	}
+	if ((romData->fieldTabsLoaded() & tabMask) != tabMask) {
+		const RomFields *const pFields = romData->fields(tabMask);
+		if (pFields) {
+			addFields(pFields);
+		}
+	}
+
+	// Close the file once all tabs have been loaded.
 	// Keeping the file open may prevent the user from
 	// changing the file.
-	romData->close();
+	if ((romData->fieldTabsLoaded() & tabsNamedMask) == tabsNamedMask) {
+		romData->close();
+	}
 }
 
 /** RomDataView **/
@@ -1261,6 +1383,10 @@ RomDataView::RomDataView(QWidget *parent)
 	Q_D(RomDataView);
 	d->ui.setupUi(this);
 
+	// Load the other tabs when they're selected.
+	connect(d->ui.tabWidget, SIGNAL(currentChanged(int)),
+		this, SLOT(tabWidget_currentChanged_slot(int)));
+
 	// No display widgets to initialize...
 }
 
@@ -1271,6 +1397,10 @@ RomDataView::RomDataView(RomData *romData, QWidget *parent)
 	Q_D(RomDataView);
 	d->ui.setupUi(this);
 
+	// Load the other tabs when they're selected.
+	connect(d->ui.tabWidget, SIGNAL(currentChanged(int)),
+		this, SLOT(tabWidget_currentChanged_slot(int)));
+
 	// Initialize the display widgets.
 	d->initDisplayWidgets();
 }
@@ -1417,6 +1547,23 @@ void RomDataView::cboLanguage_currentIndexChanged_slot(int index)
 	d->updateMulti(lc);
 }
 
+/**
+ * A different tab was selected.
+ * Load the tab's fields if they haven't been loaded yet.
+ * @param index Tab page index.
+ */
+void RomDataView::tabWidget_currentChanged_slot(int index)
+{
+	Q_D(RomDataView);
+	QWidget *const widget = d->ui.tabWidget->widget(index);
+	if (!widget) {
+		// Invalid index...
+		return;
+	}
+
+	d->loadTab(widget->property("RomDataView.tabIdx").toInt());
+}
+
 /** Properties. **/
 
 /**
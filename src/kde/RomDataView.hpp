@@ -72,6 +72,12 @@ class RomDataView : public QWidget
 		 */
 		void cboLanguage_currentIndexChanged_slot(int index);
 
+		/**
+		 * A different tab was selected.
+		 * @param index Tab page index.
+		 */
+		void tabWidget_currentChanged_slot(int index);
+
 	public:
 		/** Properties. **/
 
@@ -0,0 +1,314 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachedRomData.cpp: RomData proxy using detection cache data.            *
+ * (INTERNAL CLASS; used by RomDataFactory)                                *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CachedRomData.hpp"
+#include "DetectCache.hpp"
+
+// librpbase
+#include "librpbase/RomData_p.hpp"
+using namespace LibRpBase;
+using LibRpTexture::rp_image;
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRomData {
+
+class CachedRomDataPrivate : public RomDataPrivate
+{
+	public:
+		CachedRomDataPrivate(CachedRomData *q, IRpFile *file,
+			CachedRomData::pfnNewRomData_t newRomData, const string &systemName);
+		~CachedRomDataPrivate();
+
+	private:
+		typedef RomDataPrivate super;
+		RP_DISABLE_COPY(CachedRomDataPrivate)
+
+	public:
+		// Function to create the RomData subclass.
+		CachedRomData::pfnNewRomData_t newRomData;
+		// RomData subclass. (created on demand)
+		RomData *romData;
+		// Set to true once creating the RomData subclass was attempted.
+		bool romDataCreated;
+
+		// System name. (SYSNAME_TYPE_LONG | SYSNAME_REGION_ROM_LOCAL)
+		// If empty, the RomData subclass is used.
+		string systemName;
+
+	public:
+		/**
+		 * Get the RomData subclass.
+		 * It will be created if it hasn't been created yet.
+		 * @return RomData subclass, or nullptr if it isn't valid.
+		 */
+		RomData *getRomData(void);
+};
+
+/** CachedRomDataPrivate **/
+
+CachedRomDataPrivate::CachedRomDataPrivate(CachedRomData *q, IRpFile *file,
+	CachedRomData::pfnNewRomData_t newRomData, const string &systemName)
+	: super(q, file)
+	, newRomData(newRomData)
+	, romData(nullptr)
+	, romDataCreated(false)
+	, systemName(systemName)
+{ }
+
+CachedRomDataPrivate::~CachedRomDataPrivate()
+{
+	if (romData) {
+		romData->unref();
+	}
+}
+
+/**
+ * Get the RomData subclass.
+ * It will be created if it hasn't been created yet.
+ * @return RomData subclass, or nullptr if it isn't valid.
+ */
+RomData *CachedRomDataPrivate::getRomData(void)
+{
+	if (romDataCreated) {
+		return romData;
+	}
+	romDataCreated = true;
+	if (!file) {
+		// File was closed.
+		return nullptr;
+	}
+
+	romData = newRomData(file);
+	if (!romData->isValid()) {
+		// The file was modified after it was cached.
+		romData->unref();
+		romData = nullptr;
+	}
+	return romData;
+}
+
+/** CachedRomData **/
+
+/**
+ * Create a RomData proxy using data from the detection cache.
+ * Ownership of data.fields and data.metaData is transferred
+ * to this object.
+ * @param file		[in] ROM file.
+ * @param className	[in] RomData subclass name.
+ * @param newRomData	[in] Function to create the RomData subclass.
+ * @param data		[in] Detection cache data.
+ */
+CachedRomData::CachedRomData(IRpFile *file, const char *className,
+	pfnNewRomData_t newRomData, const DetectCache::Data &data)
+	: super(new CachedRomDataPrivate(this, file, newRomData, data.systemName))
+{
+	RP_D(CachedRomData);
+	d->className = className;
+	d->fileType = static_cast<FileType>(data.fileType);
+	d->isValid = (d->file != nullptr);
+	setCachedData(data.fields, data.metaData);
+}
+
+/**
+ * Get the RomData subclass.
+ * It will be created if it hasn't been created yet.
+ * @return RomData subclass, or nullptr if it isn't valid.
+ */
+RomData *CachedRomData::romData(void) const
+{
+	// NOTE: Creating the RomData subclass doesn't
+	// change the proxy's observable state.
+	return const_cast<CachedRomDataPrivate*>(
+		static_cast<const CachedRomDataPrivate*>(d_ptr))->getRomData();
+}
+
+/**
+ * Close the opened file.
+ */
+void CachedRomData::close(void)
+{
+	RP_D(CachedRomData);
+	if (d->romData) {
+		d->romData->close();
+	}
+	super::close();
+}
+
+/**
+ * Is a ROM image supported by this object?
+ * @param info DetectInfo containing ROM detection information.
+ * @return Class-specific system ID (>= 0) if supported; -1 if not.
+ */
+int CachedRomData::isRomSupported(const DetectInfo *info) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->isRomSupported(info) : -1);
+}
+
+/**
+ * Get the name of the system the loaded ROM is designed for.
+ * @param type System name type. (See the SystemName enum.)
+ * @return System name, or nullptr if type is invalid.
+ */
+const char *CachedRomData::systemName(unsigned int type) const
+{
+	RP_D(const CachedRomData);
+	if (type == (SYSNAME_TYPE_LONG | SYSNAME_REGION_ROM_LOCAL) && !d->systemName.empty()) {
+		return d->systemName.c_str();
+	}
+
+	const RomData *const romData = this->romData();
+	return (romData ? romData->systemName(type) : nullptr);
+}
+
+/**
+ * Get a list of all supported file extensions.
+ * @return NULL-terminated array of all supported file extensions, or nullptr on error.
+ */
+const char *const *CachedRomData::supportedFileExtensions(void) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->supportedFileExtensions() : nullptr);
+}
+
+/**
+ * Get a list of all supported MIME types.
+ * @return NULL-terminated array of all supported file extensions, or nullptr on error.
+ */
+const char *const *CachedRomData::supportedMimeTypes(void) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->supportedMimeTypes() : nullptr);
+}
+
+/**
+ * Get a bitfield of image types this object can retrieve.
+ * @return Bitfield of supported image types. (ImageTypesBF)
+ */
+uint32_t CachedRomData::supportedImageTypes(void) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->supportedImageTypes() : 0);
+}
+
+/**
+ * Get a list of all available image sizes for the specified image type.
+ * @param imageType Image type.
+ * @return Vector of available image sizes, or empty vector if no images are available.
+ */
+vector<RomData::ImageSizeDef> CachedRomData::supportedImageSizes(ImageType imageType) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->supportedImageSizes(imageType) : vector<ImageSizeDef>());
+}
+
+/**
+ * Get image processing flags.
+ * @param imageType Image type.
+ * @return Bitfield of ImageProcessingBF operations to perform.
+ */
+uint32_t CachedRomData::imgpf(ImageType imageType) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->imgpf(imageType) : 0);
+}
+
+/**
+ * Load an internal image.
+ * Called by RomData::image().
+ * @param imageType	[in] Image type to load.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachedRomData::loadInternalImage(ImageType imageType, const rp_image **pImage)
+{
+	RomData *const romData = this->romData();
+	if (!romData) {
+		*pImage = nullptr;
+		return -EIO;
+	}
+	return romData->loadInternalImage(imageType, pImage);
+}
+
+/**
+ * Get a list of URLs for an external image type.
+ * @param imageType	[in]     Image type.
+ * @param pExtURLs	[out]    Output vector.
+ * @param size		[in,opt] Requested image size. This may be a requested
+ *                               thumbnail size in pixels, or an ImageSizeType
+ *                               enum value.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachedRomData::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->extURLs(imageType, pExtURLs, size) : -EIO);
+}
+
+/**
+ * Scrape an image URL from a downloaded HTML page.
+ * @param html HTML data.
+ * @param size Size of HTML data.
+ * @return Image URL, or empty string if not found or not supported.
+ */
+string CachedRomData::scrapeImageURL(const char *html, size_t size) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->scrapeImageURL(html, size) : string());
+}
+
+/**
+ * Get the animated icon data.
+ * @return Animated icon data, or nullptr if no animated icon is present.
+ */
+const IconAnimData *CachedRomData::iconAnimData(void) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->iconAnimData() : nullptr);
+}
+
+/**
+ * Does this ROM image have "dangerous" permissions?
+ * @return True if the ROM image has "dangerous" permissions; false if not.
+ */
+bool CachedRomData::hasDangerousPermissions(void) const
+{
+	const RomData *const romData = this->romData();
+	return (romData ? romData->hasDangerousPermissions() : false);
+}
+
+/**
+ * Load field data.
+ * The fields are always loaded from the detection cache,
+ * so this is never called.
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int CachedRomData::loadFieldData(void)
+{
+	RP_D(const CachedRomData);
+	return d->fields->count();
+}
+
+/**
+ * Load metadata properties.
+ * Called by RomData::metaData() if no metadata was stored.
+ * @return Number of metadata properties read on success; negative POSIX error code on error.
+ */
+int CachedRomData::loadMetaData(void)
+{
+	// NOTE: Metadata is always stored with the fields,
+	// so if there isn't any, the file doesn't have any.
+	return -ENOENT;
+}
+
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachedRomData.hpp: RomData proxy using detection cache data.            *
+ * (INTERNAL CLASS; used by RomDataFactory)                                *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__
+
+#include "librpbase/RomData.hpp"
+
+namespace LibRomData {
+
+namespace DetectCache {
+	struct Data;
+}
+
+/**
+ * RomData proxy for files that have fields and metadata
+ * stored in the detection cache.
+ *
+ * The fields, metadata, file type, and system name are taken
+ * from the detection cache, so the file isn't parsed at all.
+ * The actual RomData subclass is only created if something
+ * else is needed, e.g. images.
+ */
+class CachedRomDataPrivate;
+class CachedRomData final : public LibRpBase::RomData
+{
+	public:
+		typedef RomData* (*pfnNewRomData_t)(LibRpBase::IRpFile *file);
+
+		/**
+		 * Create a RomData proxy using data from the detection cache.
+		 * Ownership of data.fields and data.metaData is transferred
+		 * to this object.
+		 * @param file		[in] ROM file.
+		 * @param className	[in] RomData subclass name.
+		 * @param newRomData	[in] Function to create the RomData subclass.
+		 * @param data		[in] Detection cache data.
+		 */
+		CachedRomData(LibRpBase::IRpFile *file, const char *className,
+			pfnNewRomData_t newRomData, const DetectCache::Data &data);
+	protected:
+		virtual ~CachedRomData() { }
+
+	private:
+		typedef RomData super;
+		friend class CachedRomDataPrivate;
+		RP_DISABLE_COPY(CachedRomData)
+
+	public:
+		/**
+		 * Get the RomData subclass.
+		 * It will be created if it hasn't been created yet.
+		 * @return RomData subclass, or nullptr if it isn't valid.
+		 */
+		RomData *romData(void) const;
+
+		/**
+		 * Close the opened file.
+		 */
+		void close(void) final;
+
+	public:
+		/** RomData functions. (forwarded to the RomData subclass) **/
+
+		int isRomSupported(const DetectInfo *info) const final;
+		const char *systemName(unsigned int type) const final;
+		const char *const *supportedFileExtensions(void) const final;
+		const char *const *supportedMimeTypes(void) const final;
+
+		uint32_t supportedImageTypes(void) const final;
+		std::vector<ImageSizeDef> supportedImageSizes(ImageType imageType) const final;
+		uint32_t imgpf(ImageType imageType) const final;
+		int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage) final;
+		int extURLs(ImageType imageType, std::vector<ExtURL> *pExtURLs, int size = IMAGE_SIZE_DEFAULT) const final;
+		std::string scrapeImageURL(const char *html, size_t size) const final;
+		const LibRpBase::IconAnimData *iconAnimData(void) const final;
+		bool hasDangerousPermissions(void) const final;
+
+	protected:
+		/**
+		 * Load field data.
+		 * The fields are always loaded from the detection cache,
+		 * so this is never called.
+		 * @return Number of fields read on success; negative POSIX error code on error.
+		 */
+		int loadFieldData(void) final;
+
+		/**
+		 * Load metadata properties.
+		 * Called by RomData::metaData() if no metadata was stored.
+		 * @return Number of metadata properties read on success; negative POSIX error code on error.
+		 */
+		int loadMetaData(void) final;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__ */
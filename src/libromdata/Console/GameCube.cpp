@@ -189,6 +189,30 @@ class GameCubePrivate : public RomDataPrivate
 		 * @return nullptr if partition is readable; error message if not.
 		 */
 		const char *wii_getCryptoStatus(WiiPartition *partition);
+
+		/**
+		 * Add fields for the disc header tab.
+		 * On Wii, this includes the TMD fields and the game name.
+		 * @param wiiPtLoaded Return value from loadWiiPartitionTables().
+		 */
+		void addFields_discHeader(int wiiPtLoaded);
+
+		/**
+		 * Add fields for the Wii partitions tab.
+		 * The partition tables must have been loaded by loadWiiPartitionTables().
+		 */
+		void addFields_wiiPartitions(void);
+
+	public:
+		// Verify the Wii partition hashes in loadFieldData().
+		bool verifyHashes;
+
+		/**
+		 * [Wii] Verify each partition's hash tree.
+		 * This adds an RFT_LISTDATA field with the results.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int wii_addHashVerification(void);
 };
 
 /** GameCubePrivate **/
@@ -214,6 +238,7 @@ GameCubePrivate::GameCubePrivate(GameCube *q, IRpFile *file)
 	, wiiPtblLoaded(false)
 	, updatePartition(nullptr)
 	, gamePartition(nullptr)
+	, verifyHashes(false)
 {
 	// Clear the various structs.
 	memset(&discHeader, 0, sizeof(discHeader));
@@ -385,6 +410,7 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 	}
 
 	// Done reading the partition tables.
+	wiiPtblLoaded = true;
 	return 0;
 }
 
@@ -641,6 +667,112 @@ const char *GameCubePrivate::wii_getCryptoStatus(WiiPartition *partition)
 	return err;
 }
 
+/**
+ * [Wii] Verify each partition's hash tree.
+ * This adds an RFT_LISTDATA field with the results.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCubePrivate::wii_addHashVerification(void)
+{
+	if (wiiPtbl.empty()) {
+		// No partitions.
+		return -ENOENT;
+	}
+
+	// Maximum number of bad clusters to list for each partition.
+	static const size_t MAX_BAD_CLUSTERS = 32;
+
+	auto vv_hashes = new RomFields::ListData_t();
+	vv_hashes->resize(wiiPtbl.size());
+
+	// Hash verification reads each partition's clusters sequentially.
+	// The partitions are laid out in order, so the whole disc image
+	// is mostly read sequentially.
+	// NOTE: The constructor set AH_RANDOM; it's restored afterwards.
+	file->setAccessHint(IRpFile::AH_SEQUENTIAL);
+
+	auto src_iter = wiiPtbl.cbegin();
+	auto dest_iter = vv_hashes->begin();
+	for ( ; dest_iter != vv_hashes->end(); ++src_iter, ++dest_iter) {
+		vector<string> &data_row = *dest_iter;
+		data_row.reserve(4);	// 4 fields per row.
+
+		// Partition number.
+		const WiiPartEntry &entry = *src_iter;
+		data_row.emplace_back(rp_sprintf("%dp%d", entry.vg, entry.pt));
+
+		WiiPartition::HashVerifyResult result;
+		const int ret = entry.partition->verifyHashes(&result);
+		if (ret != 0) {
+			// Unable to verify the partition.
+			const char *s_err;
+			if (ret == -ENOTSUP) {
+				// tr: Partition doesn't have hashes, or decryption is disabled.
+				s_err = C_("GameCube|Hashes", "Not supported");
+			} else if (entry.partition->verifyResult() != KeyManager::VERIFY_OK) {
+				s_err = wii_getCryptoStatus(entry.partition);
+			} else {
+				s_err = strerror(-ret);
+			}
+			data_row.emplace_back(s_err);
+			data_row.emplace_back(string());
+			data_row.emplace_back(string());
+			continue;
+		}
+
+		// Status.
+		const unsigned int badCount = static_cast<unsigned int>(result.badClusters.size());
+		if (badCount > 0) {
+			data_row.emplace_back(rp_sprintf(
+				NC_("GameCube|Hashes", "%u bad cluster", "%u bad clusters", badCount), badCount));
+		} else if (!result.h3TableOK) {
+			data_row.emplace_back(C_("GameCube|Hashes", "H3 table mismatch"));
+		} else {
+			data_row.emplace_back(C_("GameCube|Hashes", "OK"));
+		}
+
+		// Cluster count.
+		data_row.emplace_back(rp_sprintf("%u", result.clusterCount));
+
+		// Bad clusters.
+		string s_bad;
+		const size_t count = (badCount < MAX_BAD_CLUSTERS ? badCount : MAX_BAD_CLUSTERS);
+		for (size_t i = 0; i < count; i++) {
+			if (i > 0) {
+				s_bad += ", ";
+			}
+			s_bad += rp_sprintf("%u", result.badClusters[i]);
+		}
+		if (badCount > count) {
+			s_bad += ", ...";
+		}
+		data_row.emplace_back(std::move(s_bad));
+	}
+
+	// Other fields are read in random order.
+	file->setAccessHint(IRpFile::AH_RANDOM);
+
+	// Fields.
+	static const char *const hashes_names[] = {
+		// tr: Partition number.
+		NOP_C_("GameCube|Hashes", "#"),
+		// tr: Verification status.
+		NOP_C_("GameCube|Hashes", "Status"),
+		// tr: Number of clusters checked.
+		NOP_C_("GameCube|Hashes", "Clusters"),
+		// tr: Clusters that failed verification.
+		NOP_C_("GameCube|Hashes", "Bad Clusters"),
+	};
+	vector<string> *const v_hashes_names = RomFields::strArrayToVector_i18n(
+		"GameCube|Hashes", hashes_names, ARRAY_SIZE(hashes_names));
+
+	RomFields::AFLD_PARAMS params;
+	params.headers = v_hashes_names;
+	params.data.single = vv_hashes;
+	fields->addField_listData(C_("GameCube", "Hash Verification"), &params);
+	return 0;
+}
+
 /** GameCube **/
 
 /**
@@ -739,6 +871,11 @@ GameCube::GameCube(IRpFile *file)
 		return;
 	}
 
+	// Disc images are read in random order: the partition tables,
+	// FST lookups, and banners are scattered across the disc, so
+	// read-ahead past each read is usually wasted.
+	d->file->setAccessHint(IRpFile::AH_RANDOM);
+
 	if (!d->discReader) {
 		// No WiaReader yet. If this is WIA,
 		// retrieve the header from header[].
@@ -1006,6 +1143,24 @@ void GameCube::close(void)
 	super::close();
 }
 
+/**
+ * Enable or disable Wii partition hash verification.
+ *
+ * If enabled, loadFieldData() verifies the hash tree of
+ * each Wii partition and adds a field with the results.
+ * This reads the entire disc image, so it's disabled
+ * by default.
+ *
+ * NOTE: This must be called before the fields are loaded.
+ *
+ * @param enabled True to enable; false to disable.
+ */
+void GameCube::setHashVerificationEnabled(bool enabled)
+{
+	RP_D(GameCube);
+	d->verifyHashes = enabled;
+}
+
 /** ROM detection functions. **/
 
 /**
@@ -1369,12 +1524,20 @@ uint32_t GameCube::imgpf(ImageType imageType) const
  * @return Number of fields read on success; negative POSIX error code on error.
  */
 int GameCube::loadFieldData(void)
+{
+	return loadFieldTabs(RomFields::TAB_MASK_ALL);
+}
+
+/**
+ * Load field data for the specified tabs.
+ * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+ * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int GameCube::loadFieldTabs(uint32_t tabMask)
 {
 	RP_D(GameCube);
-	if (!d->fields->empty()) {
-		// Field data *has* been loaded...
-		return 0;
-	} else if (!d->file || !d->file->isOpen()) {
+	if (!d->file || !d->file->isOpen()) {
 		// File isn't open.
 		return -EBADF;
 	} else if (!d->isValid || d->discType < 0) {
@@ -1382,14 +1545,71 @@ int GameCube::loadFieldData(void)
 		return -EIO;
 	}
 
-	// Disc header is read in the constructor.
+	// Don't load tabs that have already been loaded.
+	// loadFieldData() may be called after fields() loaded some tabs.
+	tabMask &= ~d->fieldsTabsLoaded;
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Field data *has* been loaded...
+		return 0;
+	}
+
+	// The ID6 cannot have non-printable characters.
+	// (NDDEMO has ID6 "00\0E01".)
 	const GCN_DiscHeader *const discHeader = &d->discHeader;
+	for (int i = ARRAY_SIZE(discHeader->id6)-1; i >= 0; i--) {
+		if (!ISPRINT(discHeader->id6[i])) {
+			// Non-printable character found.
+			return -ENOENT;
+		}
+	}
 
 	// TODO: Reserve fewer fields for GCN?
 	// Maximum number of fields:
 	// - GameCube and Wii: 7 (includes Game Info)
-	// - Wii only: 5
-	d->fields->reserve(12);
+	// - Wii only: 6 (includes Hash Verification)
+	d->fields->reserve(13);
+
+	// Load the Wii partition tables.
+	// NOTE: This fails on GameCube discs.
+	const int wiiPtLoaded = d->loadWiiPartitionTables();
+
+	// Tab layout:
+	// - GameCube: Single tab.
+	// - Wii:
+	//   - 0: Disc header
+	//   - 1: Partitions (only if the partition tables were loaded)
+	if (wiiPtLoaded == 0) {
+		d->fields->reserveTabs(2);
+		d->fields->setTabName(0, "Wii");
+		d->fields->setTabName(1, C_("GameCube", "Partitions"));
+	}
+
+	if (RomFields::isTabSelected(tabMask, 0)) {
+		d->fields->setTabIndex(0);
+		d->addFields_discHeader(wiiPtLoaded);
+	}
+
+	if (wiiPtLoaded == 0 && RomFields::isTabSelected(tabMask, 1)) {
+		// Reading the update partition and the partitions'
+		// used sizes is expensive, so these are on a separate tab.
+		d->fields->setTabIndex(1);
+		d->addFields_wiiPartitions();
+	}
+
+	// Finished reading the field data.
+	d->fieldsTabsLoaded |= tabMask;
+	return static_cast<int>(d->fields->count());
+}
+
+/**
+ * Add fields for the disc header tab.
+ * On Wii, this includes the TMD fields and the game name.
+ * @param wiiPtLoaded Return value from loadWiiPartitionTables().
+ */
+void GameCubePrivate::addFields_discHeader(int wiiPtLoaded)
+{
+	// Disc header is read in the constructor.
+	const GCN_DiscHeader *const discHeader = &this->discHeader;
 
 	// TODO: Trim the titles. (nulls, spaces)
 	// NOTE: The titles are dup()'d as C strings, so maybe not nulls.
@@ -1398,13 +1618,13 @@ int GameCube::loadFieldData(void)
 	// Game title.
 	// TODO: Is Shift-JIS actually permissible here?
 	const char *const title_title = C_("RomData", "Title");
-	switch (d->gcnRegion) {
+	switch (gcnRegion) {
 		case GCN_REGION_USA:
 		case GCN_REGION_EUR:
 		case GCN_REGION_ALL:	// TODO: Assume JP?
 		default:
 			// USA/PAL uses cp1252.
-			d->fields->addField_string(title_title,
+			fields->addField_string(title_title,
 				cp1252_to_utf8(
 					discHeader->game_title, sizeof(discHeader->game_title)));
 			break;
@@ -1414,56 +1634,49 @@ int GameCube::loadFieldData(void)
 		case GCN_REGION_CHN:
 		case GCN_REGION_TWN:
 			// Japan uses Shift-JIS.
-			d->fields->addField_string(title_title,
+			fields->addField_string(title_title,
 				cp1252_sjis_to_utf8(
 					discHeader->game_title, sizeof(discHeader->game_title)));
 			break;
 	}
 
 	// Game ID.
-	// The ID6 cannot have non-printable characters.
-	// (NDDEMO has ID6 "00\0E01".)
-	for (int i = ARRAY_SIZE(discHeader->id6)-1; i >= 0; i--) {
-		if (!ISPRINT(discHeader->id6[i])) {
-			// Non-printable character found.
-			return -ENOENT;
-		}
-	}
-	d->fields->addField_string(C_("GameCube", "Game ID"),
+	// NOTE: loadFieldTabs() checks for non-printable characters.
+	fields->addField_string(C_("GameCube", "Game ID"),
 		latin1_to_utf8(discHeader->id6, ARRAY_SIZE(discHeader->id6)));
 
 	// Publisher.
-	d->fields->addField_string(C_("RomData", "Publisher"), d->getPublisher());
+	fields->addField_string(C_("RomData", "Publisher"), getPublisher());
 
 	// Other fields.
-	d->fields->addField_string_numeric(C_("RomData", "Disc #"),
+	fields->addField_string_numeric(C_("RomData", "Disc #"),
 		discHeader->disc_number+1, RomFields::FB_DEC);
-	d->fields->addField_string_numeric(C_("RomData", "Revision"),
+	fields->addField_string_numeric(C_("RomData", "Revision"),
 		discHeader->revision, RomFields::FB_DEC, 2);
 
 	// The remaining fields are not located in the disc header.
 	// If we can't read the disc contents for some reason, e.g.
 	// unimplemented DiscReader (WIA), skip the fields.
-	if (!d->discReader) {
+	if (!discReader) {
 		// Cannot read the disc contents.
 		// We're done for now.
-		return static_cast<int>(d->fields->count());
+		return;
 	}
 
 	// Region code.
 	// bi2.bin and/or RVL_RegionSetting is loaded in the constructor,
-	// and the region code is stored in d->gcnRegion.
-	if (d->hasRegionCode) {
+	// and the region code is stored in gcnRegion.
+	if (hasRegionCode) {
 		bool isDefault;
 		const char *const region =
-			GameCubeRegions::gcnRegionToString(d->gcnRegion, discHeader->id4[3], &isDefault);
+			GameCubeRegions::gcnRegionToString(gcnRegion, discHeader->id4[3], &isDefault);
 		const char *const region_code_title = C_("RomData", "Region Code");
 		if (region) {
 			// Append the GCN region name (USA/JPN/EUR/KOR) if
 			// the ID4 value differs.
 			const char *suffix = nullptr;
 			if (!isDefault) {
-				suffix = GameCubeRegions::gcnRegionToAbbrevString(d->gcnRegion);
+				suffix = GameCubeRegions::gcnRegionToAbbrevString(gcnRegion);
 			}
 
 			string s_region;
@@ -1474,37 +1687,32 @@ int GameCube::loadFieldData(void)
 				s_region = region;
 			}
 
-			d->fields->addField_string(region_code_title, s_region);
+			fields->addField_string(region_code_title, s_region);
 		} else {
 			// Invalid region code.
-			d->fields->addField_string(region_code_title,
-				rp_sprintf(C_("RomData", "Unknown (0x%08X)"), d->gcnRegion));
+			fields->addField_string(region_code_title,
+				rp_sprintf(C_("RomData", "Unknown (0x%08X)"), gcnRegion));
 		}
 
-		if ((d->discType & GameCubePrivate::DISC_SYSTEM_MASK) != GameCubePrivate::DISC_SYSTEM_WII) {
+		if ((discType & GameCubePrivate::DISC_SYSTEM_MASK) != GameCubePrivate::DISC_SYSTEM_WII) {
 			// GameCube-specific fields.
 
 			// Add the Game Info field from opening.bnr.
-			d->gcn_addGameInfo();
-
-			// Finished reading the field data.
-			return static_cast<int>(d->fields->count());
+			gcn_addGameInfo();
+			return;
 		}
 	}
 
 	/** Wii-specific fields. **/
 
-	// Load the Wii partition tables.
-	int wiiPtLoaded = d->loadWiiPartitionTables();
-
 	// TMD fields.
-	if (d->gamePartition) {
-		const RVL_TMD_Header *const tmdHeader = d->gamePartition->tmdHeader();
+	if (gamePartition) {
+		const RVL_TMD_Header *const tmdHeader = gamePartition->tmdHeader();
 		if (tmdHeader) {
 			// Title ID.
 			// TID Lo is usually the same as the game ID,
 			// except for some diagnostics discs.
-			d->fields->addField_string(C_("GameCube", "Title ID"),
+			fields->addField_string(C_("GameCube", "Title ID"),
 				rp_sprintf("%08X-%08X",
 					be32_to_cpu(tmdHeader->title_id.hi),
 					be32_to_cpu(tmdHeader->title_id.lo)));
@@ -1514,7 +1722,7 @@ int GameCube::loadFieldData(void)
 			v_access_rights_hdr->reserve(2);
 			v_access_rights_hdr->emplace_back("AHBPROT");
 			v_access_rights_hdr->emplace_back(C_("GameCube", "DVD Video"));
-			d->fields->addField_bitfield(C_("GameCube", "Access Rights"),
+			fields->addField_bitfield(C_("GameCube", "Access Rights"),
 				v_access_rights_hdr, 0, be32_to_cpu(tmdHeader->access_rights));
 		}
 	}
@@ -1524,7 +1732,7 @@ int GameCube::loadFieldData(void)
 	// Note that not all 16 fields are present on GCN,
 	// though the fields do match exactly, so no
 	// mapping is necessary.
-	if (d->hasRegionCode) {
+	if (hasRegionCode) {
 		RomFields::age_ratings_t age_ratings;
 		// Valid ratings: 0-1, 3-9
 		static const uint16_t valid_ratings = 0x3FB;
@@ -1540,7 +1748,7 @@ int GameCube::loadFieldData(void)
 			// - 0x1F: Age rating.
 			// - 0x20: Has online play if set.
 			// - 0x80: Unused if set.
-			const uint8_t rvl_rating = d->regionSetting.ratings[i];
+			const uint8_t rvl_rating = regionSetting.ratings[i];
 			if (rvl_rating & 0x80) {
 				// Rating is unused.
 				age_ratings[i] = 0;
@@ -1554,252 +1762,257 @@ int GameCube::loadFieldData(void)
 				age_ratings[i] |= RomFields::AGEBF_ONLINE_PLAY;
 			}
 		}
-		d->fields->addField_ageRatings(C_("RomData", "Age Ratings"), age_ratings);
+		fields->addField_ageRatings(C_("RomData", "Age Ratings"), age_ratings);
 	}
 
-	// Display the Wii partition table(s).
 	if (wiiPtLoaded == 0) {
 		// Add the game name from opening.bnr.
-		int ret = d->wii_addBannerName();
+		int ret = wii_addBannerName();
 		if (ret != 0) {
 			// Unable to load the game name from opening.bnr.
 			// This might be because it's homebrew, a prototype, or a key error.
 			const char *const game_info_title = C_("GameCube", "Game Info");
-			if (!d->gamePartition) {
+			if (!gamePartition) {
 				// No game partition.
-				if ((d->discType & GameCubePrivate::DISC_FORMAT_MASK) != GameCubePrivate::DISC_FORMAT_PARTITION) {
-					d->fields->addField_string(game_info_title,
+				if ((discType & GameCubePrivate::DISC_FORMAT_MASK) != GameCubePrivate::DISC_FORMAT_PARTITION) {
+					fields->addField_string(game_info_title,
 						C_("GameCube", "ERROR: No game partition was found."));
 				}
-			} else if (d->gamePartition->verifyResult() != KeyManager::VERIFY_OK) {
+			} else if (gamePartition->verifyResult() != KeyManager::VERIFY_OK) {
 				// Key error.
-				const char *status = d->wii_getCryptoStatus(d->gamePartition);
-				d->fields->addField_string(game_info_title,
+				const char *status = wii_getCryptoStatus(gamePartition);
+				fields->addField_string(game_info_title,
 					rp_sprintf(C_("GameCube", "ERROR: %s"),
 						(status ? status : C_("GameCube", "Unknown"))));
 			}
 		}
+	}
+}
 
-		// Update version.
-		const char *sysMenu = nullptr;
-		unsigned int ios_slot = 0, ios_major = 0, ios_minor = 0;
-		unsigned int ios_retail_count = 0;
-		bool isDebugIOS = false;
-		if (d->updatePartition) {
-			// Get the update version.
-			//
-			// On retail discs, the update partition usually contains
-			// a System Menu, but some (RHMP99, Harvest Moon PAL) only
-			// contain Boot2 and IOS.
-			//
-			// Debug discs generally only have two copies of IOS.
-			// Both copies are the same version, with one compiled for
-			// 64M systems and one for 128M systems.
-			//
-			// Filename patterns:
-			// - Retail:
-			//   - System menu: RVL-WiiSystemmenu-v*.wad file.
-			//   - IOS: IOS21-64-v514.wad
-			//     - 21: IOS slot
-			//     - 64: Memory configuration (64 only)
-			//     - 514: IOS version. (v514 == 2.2)
-			// - Debug: firmware.64.56.21.29.wad
-			//   - 64: Memory configuration (64 or 128)
-			//   - 56: IOS slot
-			//   - 21.29: IOS version. (21.29 == v5405)
-			IFst::Dir *dirp = d->updatePartition->opendir("/_sys/");
-			if (dirp) {
-				IFst::DirEnt *dirent;
-				while ((dirent = d->updatePartition->readdir(dirp)) != nullptr) {
-					if (!dirent->name || dirent->type != DT_REG)
-						continue;
-
-					// Check for a retail System Menu.
-					if (dirent->name[0] == 'R') {
-						unsigned int version;
-						int ret = sscanf(dirent->name, "RVL-WiiSystemmenu-v%u.wad", &version);
-						if (ret == 1) {
-							// Found a retail System Menu.
-							sysMenu = WiiSystemMenuVersion::lookup(version);
-							break;
-						}
-					}
-
-					// Check for a debug IOS.
-					if (dirent->name[0] == 'f') {
-						unsigned int ios_mem;
-						int ret = sscanf(dirent->name, "firmware.%u.%u.%u.%u.wad",
-							&ios_mem, &ios_slot, &ios_major, &ios_minor);
-						if (ret == 4 && (ios_mem == 64 || ios_mem == 128)) {
-							// Found a debug IOS.
-							isDebugIOS = true;
-							break;
-						}
+/**
+ * Add fields for the Wii partitions tab.
+ * The partition tables must have been loaded by loadWiiPartitionTables().
+ */
+void GameCubePrivate::addFields_wiiPartitions(void)
+{
+	// Update version.
+	const char *sysMenu = nullptr;
+	unsigned int ios_slot = 0, ios_major = 0, ios_minor = 0;
+	unsigned int ios_retail_count = 0;
+	bool isDebugIOS = false;
+	if (updatePartition) {
+		// Get the update version.
+		//
+		// On retail discs, the update partition usually contains
+		// a System Menu, but some (RHMP99, Harvest Moon PAL) only
+		// contain Boot2 and IOS.
+		//
+		// Debug discs generally only have two copies of IOS.
+		// Both copies are the same version, with one compiled for
+		// 64M systems and one for 128M systems.
+		//
+		// Filename patterns:
+		// - Retail:
+		//   - System menu: RVL-WiiSystemmenu-v*.wad file.
+		//   - IOS: IOS21-64-v514.wad
+		//     - 21: IOS slot
+		//     - 64: Memory configuration (64 only)
+		//     - 514: IOS version. (v514 == 2.2)
+		// - Debug: firmware.64.56.21.29.wad
+		//   - 64: Memory configuration (64 or 128)
+		//   - 56: IOS slot
+		//   - 21.29: IOS version. (21.29 == v5405)
+		IFst::Dir *dirp = updatePartition->opendir("/_sys/");
+		if (dirp) {
+			IFst::DirEnt *dirent;
+			while ((dirent = updatePartition->readdir(dirp)) != nullptr) {
+				if (!dirent->name || dirent->type != DT_REG)
+					continue;
+
+				// Check for a retail System Menu.
+				if (dirent->name[0] == 'R') {
+					unsigned int version;
+					int ret = sscanf(dirent->name, "RVL-WiiSystemmenu-v%u.wad", &version);
+					if (ret == 1) {
+						// Found a retail System Menu.
+						sysMenu = WiiSystemMenuVersion::lookup(version);
+						break;
 					}
+				}
 
-					// Check for a retail IOS.
-					if (dirent->name[0] == 'I') {
-						unsigned int ios_mem;
-						int ret = sscanf(dirent->name, "IOS%u-%u-v%u.wad",
-							&ios_slot, &ios_mem, &ios_major);
-						if (ret == 3 && ios_mem == 64) {
-							// Found a retail IOS.
-							// NOTE: ios_major has a combined version number,
-							// so it needs to be split into major/minor.
-							ios_minor = ios_major & 0xFF;
-							ios_major >>= 8;
-							ios_retail_count++;
-						}
+				// Check for a debug IOS.
+				if (dirent->name[0] == 'f') {
+					unsigned int ios_mem;
+					int ret = sscanf(dirent->name, "firmware.%u.%u.%u.%u.wad",
+						&ios_mem, &ios_slot, &ios_major, &ios_minor);
+					if (ret == 4 && (ios_mem == 64 || ios_mem == 128)) {
+						// Found a debug IOS.
+						isDebugIOS = true;
+						break;
 					}
 				}
-				d->updatePartition->closedir(dirp);
-			}
-		}
 
-		const char *const update_title = C_("GameCube", "Update");
-		if (isDebugIOS || ios_retail_count == 1) {
-			d->fields->addField_string(update_title,
-				rp_sprintf("IOS%u %u.%u (v%u)", ios_slot, ios_major, ios_minor,
-					(ios_major << 8) | ios_minor));
-		} else {
-			if (!sysMenu) {
-				if (!d->updatePartition) {
-					sysMenu = C_("GameCube", "None");
-				} else {
-					sysMenu = d->wii_getCryptoStatus(d->updatePartition);
+				// Check for a retail IOS.
+				if (dirent->name[0] == 'I') {
+					unsigned int ios_mem;
+					int ret = sscanf(dirent->name, "IOS%u-%u-v%u.wad",
+						&ios_slot, &ios_mem, &ios_major);
+					if (ret == 3 && ios_mem == 64) {
+						// Found a retail IOS.
+						// NOTE: ios_major has a combined version number,
+						// so it needs to be split into major/minor.
+						ios_minor = ios_major & 0xFF;
+						ios_major >>= 8;
+						ios_retail_count++;
+					}
 				}
 			}
-			d->fields->addField_string(update_title, sysMenu);
+			updatePartition->closedir(dirp);
 		}
+	}
 
-		// Partition table.
-		auto vv_partitions = new RomFields::ListData_t();
-		vv_partitions->resize(d->wiiPtbl.size());
-
-		auto src_iter = d->wiiPtbl.cbegin();
-		auto dest_iter = vv_partitions->begin();
-		for ( ; dest_iter != vv_partitions->end(); ++src_iter, ++dest_iter) {
-			vector<string> &data_row = *dest_iter;
-			data_row.reserve(5);	// 5 fields per row.
-
-			// Partition entry.
-			const GameCubePrivate::WiiPartEntry &entry = *src_iter;
-
-			// Partition number.
-			data_row.emplace_back(rp_sprintf("%dp%d", entry.vg, entry.pt));
-
-			// Partition type.
-			string s_ptype;
-			static const char *const part_type_tbl[3] = {
-				// tr: GameCubePrivate::PARTITION_GAME
-				NOP_C_("GameCube|Partition", "Game"),
-				// tr: GameCubePrivate::PARTITION_UPDATE
-				NOP_C_("GameCube|Partition", "Update"),
-				// tr: GameCubePrivate::PARTITION_CHANNEL
-				NOP_C_("GameCube|Partition", "Channel"),
-			};
-			if (entry.type <= GameCubePrivate::PARTITION_CHANNEL) {
-				s_ptype = dpgettext_expr(RP_I18N_DOMAIN, "GameCube|Partition", part_type_tbl[entry.type]);
+	const char *const update_title = C_("GameCube", "Update");
+	if (isDebugIOS || ios_retail_count == 1) {
+		fields->addField_string(update_title,
+			rp_sprintf("IOS%u %u.%u (v%u)", ios_slot, ios_major, ios_minor,
+				(ios_major << 8) | ios_minor));
+	} else {
+		if (!sysMenu) {
+			if (!updatePartition) {
+				sysMenu = C_("GameCube", "None");
 			} else {
-				// If all four bytes are ASCII letters and/or numbers,
-				// print it as-is. (SSBB demo channel)
-				// Otherwise, print the hexadecimal value.
-				// NOTE: Must be BE32 for proper display.
-				union {
-					uint32_t be32_type;
-					char chr[4];
-				} part_type;
-				part_type.be32_type = cpu_to_be32(entry.type);
-				if (ISALNUM(part_type.chr[0]) && ISALNUM(part_type.chr[1]) &&
-				    ISALNUM(part_type.chr[2]) && ISALNUM(part_type.chr[3]))
-				{
-					// All four bytes are ASCII letters and/or numbers.
-					s_ptype = latin1_to_utf8(part_type.chr, sizeof(part_type.chr));
-				} else {
-					// Non-ASCII data. Print the hex values instead.
-					s_ptype = rp_sprintf("%08X", entry.type);
-				}
+				sysMenu = wii_getCryptoStatus(updatePartition);
 			}
-			data_row.emplace_back(std::move(s_ptype));
-
-			// Encryption key.
-			// TODO: Use a string table?
-			WiiPartition::EncKey encKey;
-			if ((d->discType & GameCubePrivate::DISC_FORMAT_MASK) == GameCubePrivate::DISC_FORMAT_NASOS) {
-				// NASOS disc image.
-				// If this would normally be an encrypted image, use encKeyReal().
-				encKey = (d->discHeader.disc_noCrypto == 0
-					? entry.partition->encKeyReal()
-					: entry.partition->encKey());
+		}
+		fields->addField_string(update_title, sysMenu);
+	}
+
+	// Partition table.
+	auto vv_partitions = new RomFields::ListData_t();
+	vv_partitions->resize(wiiPtbl.size());
+
+	auto src_iter = wiiPtbl.cbegin();
+	auto dest_iter = vv_partitions->begin();
+	for ( ; dest_iter != vv_partitions->end(); ++src_iter, ++dest_iter) {
+		vector<string> &data_row = *dest_iter;
+		data_row.reserve(5);	// 5 fields per row.
+
+		// Partition entry.
+		const GameCubePrivate::WiiPartEntry &entry = *src_iter;
+
+		// Partition number.
+		data_row.emplace_back(rp_sprintf("%dp%d", entry.vg, entry.pt));
+
+		// Partition type.
+		string s_ptype;
+		static const char *const part_type_tbl[3] = {
+			// tr: GameCubePrivate::PARTITION_GAME
+			NOP_C_("GameCube|Partition", "Game"),
+			// tr: GameCubePrivate::PARTITION_UPDATE
+			NOP_C_("GameCube|Partition", "Update"),
+			// tr: GameCubePrivate::PARTITION_CHANNEL
+			NOP_C_("GameCube|Partition", "Channel"),
+		};
+		if (entry.type <= GameCubePrivate::PARTITION_CHANNEL) {
+			s_ptype = dpgettext_expr(RP_I18N_DOMAIN, "GameCube|Partition", part_type_tbl[entry.type]);
+		} else {
+			// If all four bytes are ASCII letters and/or numbers,
+			// print it as-is. (SSBB demo channel)
+			// Otherwise, print the hexadecimal value.
+			// NOTE: Must be BE32 for proper display.
+			union {
+				uint32_t be32_type;
+				char chr[4];
+			} part_type;
+			part_type.be32_type = cpu_to_be32(entry.type);
+			if (ISALNUM(part_type.chr[0]) && ISALNUM(part_type.chr[1]) &&
+			    ISALNUM(part_type.chr[2]) && ISALNUM(part_type.chr[3]))
+			{
+				// All four bytes are ASCII letters and/or numbers.
+				s_ptype = latin1_to_utf8(part_type.chr, sizeof(part_type.chr));
 			} else {
-				// Other disc image. Use encKey().
-				encKey = entry.partition->encKey();
+				// Non-ASCII data. Print the hex values instead.
+				s_ptype = rp_sprintf("%08X", entry.type);
 			}
+		}
+		data_row.emplace_back(std::move(s_ptype));
+
+		// Encryption key.
+		// TODO: Use a string table?
+		WiiPartition::EncKey encKey;
+		if ((discType & GameCubePrivate::DISC_FORMAT_MASK) == GameCubePrivate::DISC_FORMAT_NASOS) {
+			// NASOS disc image.
+			// If this would normally be an encrypted image, use encKeyReal().
+			encKey = (discHeader.disc_noCrypto == 0
+				? entry.partition->encKeyReal()
+				: entry.partition->encKey());
+		} else {
+			// Other disc image. Use encKey().
+			encKey = entry.partition->encKey();
+		}
 
-			static const char *const wii_key_tbl[] = {
-				// tr: WiiPartition::ENCKEY_COMMON - Retail encryption key.
-				NOP_C_("GameCube|KeyIdx", "Retail"),
-				// tr: WiiPartition::ENCKEY_KOREAN - Korean encryption key.
-				NOP_C_("GameCube|KeyIdx", "Korean"),
-				// tr: WiiPartition::ENCKEY_VWII - vWii-specific encryption key.
-				NOP_C_("GameCube|KeyIdx", "vWii"),
-				// tr: WiiPartition::ENCKEY_DEBUG - Debug encryption key.
-				NOP_C_("GameCube|KeyIdx", "Debug"),
-				// tr: WiiPartition::ENCKEY_NONE - No encryption.
-				NOP_C_("GameCube|KeyIdx", "None"),
-			};
-			static_assert(ARRAY_SIZE(wii_key_tbl) == WiiPartition::ENCKEY_MAX,
-				"wii_key_tbl[] size is incorrect.");
-
-			const char *s_key_name;
-			if (encKey >= 0 && encKey < ARRAY_SIZE(wii_key_tbl)) {
-				s_key_name = dpgettext_expr(RP_I18N_DOMAIN, "GameCube|KeyIdx", wii_key_tbl[encKey]);
-			} else {
-				// WiiPartition::ENCKEY_UNKNOWN
-				s_key_name = C_("RomData", "Unknown");
-			}
-			data_row.emplace_back(s_key_name);
+		static const char *const wii_key_tbl[] = {
+			// tr: WiiPartition::ENCKEY_COMMON - Retail encryption key.
+			NOP_C_("GameCube|KeyIdx", "Retail"),
+			// tr: WiiPartition::ENCKEY_KOREAN - Korean encryption key.
+			NOP_C_("GameCube|KeyIdx", "Korean"),
+			// tr: WiiPartition::ENCKEY_VWII - vWii-specific encryption key.
+			NOP_C_("GameCube|KeyIdx", "vWii"),
+			// tr: WiiPartition::ENCKEY_DEBUG - Debug encryption key.
+			NOP_C_("GameCube|KeyIdx", "Debug"),
+			// tr: WiiPartition::ENCKEY_NONE - No encryption.
+			NOP_C_("GameCube|KeyIdx", "None"),
+		};
+		static_assert(ARRAY_SIZE(wii_key_tbl) == WiiPartition::ENCKEY_MAX,
+			"wii_key_tbl[] size is incorrect.");
 
-			// Used size.
-			const off64_t used_size = entry.partition->partition_size_used();
-			if (used_size >= 0) {
-				data_row.emplace_back(LibRpBase::formatFileSize(used_size));
-			} else {
-				// tr: Unknown used size.
-				data_row.emplace_back(C_("GameCube|Partition", "Unknown"));
-			}
+		const char *s_key_name;
+		if (encKey >= 0 && encKey < ARRAY_SIZE(wii_key_tbl)) {
+			s_key_name = dpgettext_expr(RP_I18N_DOMAIN, "GameCube|KeyIdx", wii_key_tbl[encKey]);
+		} else {
+			// WiiPartition::ENCKEY_UNKNOWN
+			s_key_name = C_("RomData", "Unknown");
+		}
+		data_row.emplace_back(s_key_name);
 
-			// Partition size.
-			data_row.emplace_back(LibRpBase::formatFileSize(entry.partition->partition_size()));
+		// Used size.
+		const off64_t used_size = entry.partition->partition_size_used();
+		if (used_size >= 0) {
+			data_row.emplace_back(LibRpBase::formatFileSize(used_size));
+		} else {
+			// tr: Unknown used size.
+			data_row.emplace_back(C_("GameCube|Partition", "Unknown"));
 		}
 
-		// Fields.
-		static const char *const partitions_names[] = {
-			// tr: Partition number.
-			NOP_C_("GameCube|Partition", "#"),
-			// tr: Partition type.
-			NOP_C_("GameCube|Partition", "Type"),
-			// tr: Encryption key.
-			NOP_C_("GameCube|Partition", "Key"),
-			// tr: Actual data used within the partition.
-			NOP_C_("GameCube|Partition", "Used Size"),
-			// tr: Total size of the partition.
-			NOP_C_("GameCube|Partition", "Total Size"),
-		};
-		vector<string> *const v_partitions_names = RomFields::strArrayToVector_i18n(
-			"GameCube|Partition", partitions_names, ARRAY_SIZE(partitions_names));
+		// Partition size.
+		data_row.emplace_back(LibRpBase::formatFileSize(entry.partition->partition_size()));
+	}
+
+	// Fields.
+	static const char *const partitions_names[] = {
+		// tr: Partition number.
+		NOP_C_("GameCube|Partition", "#"),
+		// tr: Partition type.
+		NOP_C_("GameCube|Partition", "Type"),
+		// tr: Encryption key.
+		NOP_C_("GameCube|Partition", "Key"),
+		// tr: Actual data used within the partition.
+		NOP_C_("GameCube|Partition", "Used Size"),
+		// tr: Total size of the partition.
+		NOP_C_("GameCube|Partition", "Total Size"),
+	};
+	vector<string> *const v_partitions_names = RomFields::strArrayToVector_i18n(
+		"GameCube|Partition", partitions_names, ARRAY_SIZE(partitions_names));
 
-		RomFields::AFLD_PARAMS params;
-		params.headers = v_partitions_names;
-		params.data.single = vv_partitions;
-		d->fields->addField_listData(C_("GameCube", "Partitions"), &params);
-	} else {
-		// Could not load partition tables.
-		// FIXME: Show an error?
-	}
+	RomFields::AFLD_PARAMS params;
+	params.headers = v_partitions_names;
+	params.data.single = vv_partitions;
+	fields->addField_listData(C_("GameCube", "Partitions"), &params);
 
-	// Finished reading the field data.
-	return static_cast<int>(d->fields->count());
+	if (verifyHashes) {
+		// Verify the partition hashes.
+		wii_addHashVerification();
+	}
 }
 
 /**
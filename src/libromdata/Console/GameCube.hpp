@@ -14,7 +14,24 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(GameCube)
+
+	public:
+		/**
+		 * Enable or disable Wii partition hash verification.
+		 *
+		 * If enabled, loadFieldData() verifies the hash tree of
+		 * each Wii partition and adds a field with the results.
+		 * This reads the entire disc image, so it's disabled
+		 * by default.
+		 *
+		 * NOTE: This must be called before the fields are loaded.
+		 *
+		 * @param enabled True to enable; false to disable.
+		 */
+		void setHashVerificationEnabled(bool enabled);
+
 ROMDATA_DECL_CLOSE()
+ROMDATA_DECL_FIELDTABS()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -1023,6 +1023,7 @@ int Xbox360_XDBF_Private::addFields_avatarAwards(void)
 	for (; p < p_end && xgaa_iter != vv_xgaa->end(); p++, ++xgaa_iter, ++icon_iter) {
 		// String data row
 		auto &data_row = *xgaa_iter;
+		data_row.reserve(2);
 
 		// Icon
 		*icon_iter = loadImage(be32_to_cpu(p->image_id));
@@ -127,6 +127,57 @@ class Xbox360_XEX_Private : public RomDataPrivate
 		ao::uvector<uint8_t> lzx_peHeader;
 		// Decompressed XDBF section.
 		ao::uvector<uint8_t> lzx_xdbfSection;
+
+		/**
+		 * LZX de-blocking state.
+		 * The compressed data is split into blocks. Each block
+		 * starts with the next block's header, followed by
+		 * size-prefixed chunks of LZX data.
+		 */
+		struct LzxDeblockState {
+			CBCReader *reader;
+			uint32_t block_size;		// Current block size. (0 == end of data)
+			uint32_t block_remain;		// Bytes remaining in the current block.
+			uint32_t chunk_remain;		// Bytes remaining in the current chunk.
+			XEX2_Compression_Normal_Info next_block;	// Next block header.
+			bool inBlock;			// True if the next block header has been read.
+		};
+
+		/**
+		 * Advance to the next chunk of LZX data.
+		 * @param state LzxDeblockState.
+		 * @return 1 if a chunk is available; 0 at end of data; negative POSIX error code on error.
+		 */
+		static int lzxNextChunk(LzxDeblockState *state);
+
+		/**
+		 * LZX read callback for lzx_stream.
+		 * @param opaque LzxDeblockState.
+		 * @param buf Output buffer.
+		 * @param size Size of buf.
+		 * @return Number of bytes read; 0 at end of data; -1 on error.
+		 */
+		static int lzxReadFn(void *opaque, void *buf, int size);
+
+		/**
+		 * Decompress the PE header and the XDBF section
+		 * from an LZX-compressed executable.
+		 *
+		 * The compressed data is decrypted and decompressed as it's
+		 * read, and decompression stops once the PE header and the
+		 * XDBF section have been decompressed. An incorrect key is
+		 * detected after decompressing the PE header.
+		 *
+		 * On success, lzx_peHeader and lzx_xdbfSection are set.
+		 *
+		 * @param reader	[in] CBCReader.
+		 * @param first_block	[in] First block header. (byteswapped)
+		 * @param window_size	[in] LZX window size.
+		 * @param image_size	[in] Decompressed image size.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressLzx(CBCReader *reader, const XEX2_Compression_Normal_Info &first_block,
+			uint32_t window_size, uint32_t image_size);
 #endif /* ENABLE_LIBMSPACK */
 
 		/**
@@ -156,11 +207,15 @@ class Xbox360_XEX_Private : public RomDataPrivate
 		 * (low byte is between 0x02 and 0xFE), or have a size stored
 		 * at the beginning of the data (low byte == 0xFF).
 		 *
+		 * If the file supports IRpFile::map(), the returned data
+		 * points directly into the file and buf is not used.
+		 *
 		 * @param header_id	[in] Optional header ID.
-		 * @param pVec		[out] ao::uvector<uint8_t>&
+		 * @param ppData	[out] Pointer to the data. (valid until buf is modified)
+		 * @param buf		[out] Fallback buffer.
 		 * @return Number of bytes read on success; 0 on error.
 		 */
-		size_t getOptHdrData(uint32_t header_id, ao::uvector<uint8_t> &pVec);
+		size_t getOptHdrData(uint32_t header_id, const uint8_t **ppData, ao::uvector<uint8_t> &buf);
 
 		/**
 		 * Get the resource information.
@@ -366,11 +421,15 @@ size_t Xbox360_XEX_Private::getOptHdrData(uint32_t header_id, uint32_t *pOut32)
  * (low byte is between 0x02 and 0xFE), or have a size stored
  * at the beginning of the data (low byte == 0xFF).
  *
+ * If the file supports IRpFile::map(), the returned data
+ * points directly into the file and buf is not used.
+ *
  * @param header_id	[in] Optional header ID.
- * @param pVec		[out] ao::uvector<uint8_t>&
+ * @param ppData	[out] Pointer to the data. (valid until buf is modified)
+ * @param buf		[out] Fallback buffer.
  * @return Number of bytes read on success; 0 on error.
  */
-size_t Xbox360_XEX_Private::getOptHdrData(uint32_t header_id, ao::uvector<uint8_t> &pVec)
+size_t Xbox360_XEX_Private::getOptHdrData(uint32_t header_id, const uint8_t **ppData, ao::uvector<uint8_t> &buf)
 {
 	assert((header_id & 0xFF) > 0x01);
 	if ((header_id & 0xFF) <= 0x01) {
@@ -408,12 +467,12 @@ size_t Xbox360_XEX_Private::getOptHdrData(uint32_t header_id, ao::uvector<uint8_
 
 	// Read the data.
 	// NOTE: This includes the size value for 0xFF structs.
-	pVec.resize(size);
-	size_t sz_read = file->seekAndRead(offset, pVec.data(), size);
-	if (sz_read != size) {
+	const uint8_t *const pData = file->mapOrRead(offset, size, buf);
+	if (!pData) {
 		// Seek and/or read error.
 		return 0;
 	}
+	*ppData = pData;
 	return size;
 }
 
@@ -437,7 +496,8 @@ const XEX2_Resource_Info *Xbox360_XEX_Private::getXdbfResInfo(const char *resour
 	// Note that this is loaded even if we don't need the title ID,
 	// since other functions may need the execution ID.
 	if (!isExecutionIDLoaded) {
-		size_t size = getOptHdrData(XEX2_OPTHDR_EXECUTION_ID, u8_data);
+		const uint8_t *pData = nullptr;
+		size_t size = getOptHdrData(XEX2_OPTHDR_EXECUTION_ID, &pData, u8_data);
 		if (size != sizeof(XEX2_Execution_ID)) {
 			// Unable to read the execution ID...
 			// Can't get the title ID.
@@ -445,7 +505,7 @@ const XEX2_Resource_Info *Xbox360_XEX_Private::getXdbfResInfo(const char *resour
 		}
 
 		const XEX2_Execution_ID *const pLdExecutionId =
-			reinterpret_cast<const XEX2_Execution_ID*>(u8_data.data());
+			reinterpret_cast<const XEX2_Execution_ID*>(pData);
 		executionID.media_id		= be32_to_cpu(pLdExecutionId->media_id);
 		executionID.version.u32		= be32_to_cpu(pLdExecutionId->version.u32);
 		executionID.base_version.u32	= be32_to_cpu(pLdExecutionId->base_version.u32);
@@ -470,7 +530,8 @@ const XEX2_Resource_Info *Xbox360_XEX_Private::getXdbfResInfo(const char *resour
 	}
 
 	// Get the resource information.
-	size_t size = getOptHdrData(XEX2_OPTHDR_RESOURCE_INFO, u8_data);
+	const uint8_t *pData = nullptr;
+	size_t size = getOptHdrData(XEX2_OPTHDR_RESOURCE_INFO, &pData, u8_data);
 	if (size < sizeof(uint32_t) + sizeof(XEX2_Resource_Info)) {
 		// No resource information.
 		return nullptr;
@@ -487,7 +548,7 @@ const XEX2_Resource_Info *Xbox360_XEX_Private::getXdbfResInfo(const char *resour
 	XEX2_Resource_Info res;
 	res.vaddr = 0;
 	const XEX2_Resource_Info *p =
-		reinterpret_cast<const XEX2_Resource_Info*>(u8_data.data() + sizeof(uint32_t));
+		reinterpret_cast<const XEX2_Resource_Info*>(pData + sizeof(uint32_t));
 	for (unsigned int i = 0; i < res_count; i++, p++) {
 		// Using a string comparison, since the resource ID might not
 		// be the full 8 characters.
@@ -540,7 +601,8 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 
 	// Get the file format info.
 	ao::uvector<uint8_t> u8_ffi;
-	size_t size = getOptHdrData(XEX2_OPTHDR_FILE_FORMAT_INFO, u8_ffi);
+	const uint8_t *pData = nullptr;
+	size_t size = getOptHdrData(XEX2_OPTHDR_FILE_FORMAT_INFO, &pData, u8_ffi);
 	if (size < sizeof(fileFormatInfo)) {
 		// Seek and/or read error.
 		return nullptr;
@@ -548,7 +610,7 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 
 	// Copy the file format information.
 	const XEX2_File_Format_Info *const pLdFileFormatInfo =
-		reinterpret_cast<const XEX2_File_Format_Info*>(u8_ffi.data());
+		reinterpret_cast<const XEX2_File_Format_Info*>(pData);
 	fileFormatInfo.size             = be32_to_cpu(pLdFileFormatInfo->size);
 	fileFormatInfo.encryption_type  = be16_to_cpu(pLdFileFormatInfo->encryption_type);
 	fileFormatInfo.compression_type = be16_to_cpu(pLdFileFormatInfo->compression_type);
@@ -679,7 +741,7 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 			uint32_t vaddr = 0, physaddr = 0;
 			basicZDataSegments.resize(seg_len);
 			const XEX2_Compression_Basic_Info *p =
-				reinterpret_cast<const XEX2_Compression_Basic_Info*>(u8_ffi.data() + sizeof(XEX2_File_Format_Info));
+				reinterpret_cast<const XEX2_Compression_Basic_Info*>(pData + sizeof(XEX2_File_Format_Info));
 			for (unsigned int i = 0; i < seg_count; i++, p++) {
 				const uint32_t data_size = be32_to_cpu(p->data_size);
 				basicZDataSegments[i].vaddr = vaddr;
@@ -720,208 +782,44 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 
 			// Window size.
 			// NOTE: Technically part of XEX2_Compression_Normal_Header,
-			// but we're not using that in order to be
-			// able to swap lzx_blocks.
-			const uint8_t *p = u8_ffi.data() + sizeof(fileFormatInfo);
+			// but we're not using that in order to be able to
+			// byteswap the first block header separately.
+			const uint8_t *p = pData + sizeof(fileFormatInfo);
 			const uint32_t *const pWindowSize =
 				reinterpret_cast<const uint32_t*>(p);
 			const uint32_t window_size = be32_to_cpu(*pWindowSize);
 
-			// First block.
-			XEX2_Compression_Normal_Info first_block, lzx_blocks[2];
-			unsigned int lzx_idx = 0;
+			// First block header is stored in the XEX header.
+			// Subsequent block headers are stored in the compressed data.
+			XEX2_Compression_Normal_Info first_block;
 			memcpy(&first_block, p+sizeof(window_size), sizeof(first_block));
 #if SYS_BYTEORDER == SYS_LIL_ENDIAN
 			first_block.block_size = be32_to_cpu(first_block.block_size);
 #endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
-			memcpy(&lzx_blocks[0], &first_block, sizeof(first_block));
-			// First block header is stored in the XEX header.
-			// Second block header is stored at the beginning of the compressed data.
-
-			// NOTE: We can't easily randomly seek within the compressed data,
-			// since the uncompressed block size isn't stored anywhere.
-			// We'll have to load the entire executable into memory,
-			// save the relevant portions, then free it.
-			// FIXME: It *might* be possible to randomly seek...
-			// Need to analyze the format more.
-			const off64_t fileSize = file->size();
-			if (fileSize > 64*1024*1024 || image_size > 64*1024*1024) {
-				// 64 MB is our compressed and uncompressed limit.
-				delete reader[0];
-				delete reader[1];
-				return nullptr;
-			}
-
-			// Compressed EXE buffer.
-			// We have to de-block the compressed data first.
-			const size_t compressed_size = static_cast<size_t>(fileSize) - xex2Header.pe_offset;
-			unique_ptr<uint8_t[]> compressed_deblock(new uint8_t[compressed_size]);
-
-			// Pointer within the deblocked compressed data.
-			uint8_t *p_dblk = compressed_deblock.get();
-			uint8_t *const p_dblk_end = p_dblk + compressed_size;
 
 			// CBCReader index.
-			// If a block size is invalid, we'll switch to the other one.
-			// If both are invalid, we have a problem.
+			// If decompression fails, we'll switch to the other one.
+			// If both fail, we have a problem.
 			unsigned int rd_idx = (reader[0] ? 0 : 1);
-			if (!reader[rd_idx]) {
-				// No readers available...
-				return nullptr;
-			}
-
-			// Start at the beginning.
-			reader[rd_idx]->rewind();
-
-			// Based on: https://github.com/xenia-project/xenia/blob/5f764fc752c82674981a9f402f1bbd96b399112a/src/xenia/cpu/xex_module.cc
-			while (lzx_blocks[lzx_idx].block_size != 0) {
-				// Read the next block header.
-				size = reader[rd_idx]->read(&lzx_blocks[!lzx_idx], sizeof(lzx_blocks[!lzx_idx]));
-				if (size != sizeof(lzx_blocks[!lzx_idx])) {
-					// Seek and/or read error.
-					delete reader[0];
-					delete reader[1];
-					return nullptr;
-				}
-
-				// Does the block size make sense?
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-				lzx_blocks[!lzx_idx].block_size = be32_to_cpu(lzx_blocks[!lzx_idx].block_size);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
-				if (lzx_blocks[!lzx_idx].block_size > 65536) {
-					// Block size is invalid.
-					// Switch to the other reader.
-					if (rd_idx == 1) {
-						// No more readers...
-						delete reader[1];
-						return nullptr;
-					}
-					delete reader[0];
-					reader[0] = nullptr;
 
-					// reader[1] might be nullptr here...
-					if (!reader[1]) {
-						// Cannot continue.
-						return nullptr;
-					}
-					rd_idx = 1;
-
-					// Restart decompression in case the first few blocks
-					// were decompressed without any "errors".
-					// TODO: Also do this for errors after reading the block size?
-					reader[1]->rewind();
-					lzx_idx = 0;
-					memcpy(&lzx_blocks[0], &first_block, sizeof(first_block));
-					p_dblk = compressed_deblock.get();
-					continue;
-				}
-
-				// Read the current block.
-				uint32_t block_size = lzx_blocks[lzx_idx].block_size;
-				assert(block_size > sizeof(lzx_blocks[!lzx_idx]));
-				if (block_size <= sizeof(lzx_blocks[!lzx_idx])) {
-					// Block is missing the "next block" header...
-					delete reader[0];
-					delete reader[1];
-					return nullptr;
-				}
-				block_size -= sizeof(lzx_blocks[!lzx_idx]);
-
-				while (block_size > 2) {
-					// Get the chunk size.
-					uint16_t chunk_size;
-					size = reader[rd_idx]->read(&chunk_size, sizeof(chunk_size));
-					if (size != sizeof(chunk_size)) {
-						// Seek and/or read error.
-						delete reader[0];
-						delete reader[1];
-						return nullptr;
-					}
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-					chunk_size = be16_to_cpu(chunk_size);
-#endif /* SYS_BYTEORDER = SYS_LIL_ENDIAN */
-					block_size -= 2;
-					if (chunk_size == 0 || chunk_size > block_size) {
-						// End of block, or not enough data is available.
-						break;
-					}
-
-					// Do we have enough space?
-					if (p_dblk + chunk_size >= p_dblk_end) {
-						// Out of memory.
-						// TODO: Error reporting.
-						delete reader[0];
-						delete reader[1];
-						return nullptr;
-					}
-
-					size = reader[rd_idx]->read(p_dblk, chunk_size);
-					if (size != chunk_size) {
-						// Seek and/or read error.
-						delete reader[0];
-						delete reader[1];
-						return nullptr;
-					}
-
-					p_dblk += chunk_size;
-					block_size -= chunk_size;
-				}
-				if (block_size > 0) {
-					// Empty data at the end of the block.
-					// TODO: Error handling.
-					// TODO: SEEK_CUR?
-					reader[rd_idx]->seek(reader[rd_idx]->tell() + block_size);
-				}
-
-				// Next block.
-				lzx_idx = !lzx_idx;
+			// The compressed data is read sequentially.
+			const off64_t fileSize = file->size();
+			file->setAccessHint(IRpFile::AH_SEQUENTIAL, xex2Header.pe_offset,
+				static_cast<size_t>(fileSize - xex2Header.pe_offset));
+			int ret = decompressLzx(reader[rd_idx], first_block, window_size, image_size);
+			if (ret != 0 && rd_idx == 0 && reader[1]) {
+				// Try the other reader.
+				rd_idx = 1;
+				ret = decompressLzx(reader[rd_idx], first_block, window_size, image_size);
 			}
-
-			// Decompress the data.
-			unique_ptr<uint8_t[]> decompressed_exe(new uint8_t[image_size]);
-			int res = lzx_decompress(compressed_deblock.get(),
-				static_cast<size_t>(p_dblk - compressed_deblock.get()),
-				decompressed_exe.get(), image_size,
-				window_size, nullptr, 0);
-			if (res != MSPACK_ERR_OK) {
+			file->setAccessHint(IRpFile::AH_NORMAL);
+			if (ret != 0) {
 				// Error decompressing the data.
 				delete reader[0];
 				delete reader[1];
 				return nullptr;
 			}
 
-			// Verify the MZ header.
-			uint16_t mz;
-			memcpy(&mz, decompressed_exe.get(), sizeof(mz));
-			if (mz != cpu_to_be16('MZ')) {
-				// MZ header is not valid.
-				// TODO: Other checks?
-				delete reader[0];
-				delete reader[1];
-				return nullptr;
-			}
-
-			// Copy the PE header.
-			lzx_peHeader.resize(PE_HEADER_SIZE);
-			memcpy(lzx_peHeader.data(), decompressed_exe.get(), PE_HEADER_SIZE);
-
-			// Copy the XDBF section.
-			const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
-			if (pResInfo) {
-				const uint32_t load_address = be32_to_cpu(
-					(xexType != XEX_TYPE_XEX1
-						? secInfo.xex2.load_address
-						: secInfo.xex1.load_address));
-
-				const uint32_t xdbf_physaddr = pResInfo->vaddr - load_address;
-				if (xdbf_physaddr + pResInfo->size <= image_size) {
-					lzx_xdbfSection.resize(pResInfo->size);
-					memcpy(lzx_xdbfSection.data(),
-						decompressed_exe.get() + xdbf_physaddr,
-						pResInfo->size);
-				}
-			}
-
 			// Save the correct reader.
 			this->peReader = reader[rd_idx];
 			reader[rd_idx] = nullptr;
@@ -963,6 +861,240 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 	return this->peReader;
 }
 
+#ifdef ENABLE_LIBMSPACK
+/**
+ * Advance to the next chunk of LZX data.
+ * @param state LzxDeblockState.
+ * @return 1 if a chunk is available; 0 at end of data; negative POSIX error code on error.
+ */
+int Xbox360_XEX_Private::lzxNextChunk(LzxDeblockState *state)
+{
+	CBCReader *const reader = state->reader;
+
+	// Based on: https://github.com/xenia-project/xenia/blob/5f764fc752c82674981a9f402f1bbd96b399112a/src/xenia/cpu/xex_module.cc
+	while (true) {
+		if (!state->inBlock) {
+			if (state->block_size == 0) {
+				// End of data.
+				return 0;
+			}
+
+			// Read the next block header.
+			size_t size = reader->read(&state->next_block, sizeof(state->next_block));
+			if (size != sizeof(state->next_block)) {
+				// Seek and/or read error.
+				return -EIO;
+			}
+
+			// Does the block size make sense?
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+			state->next_block.block_size = be32_to_cpu(state->next_block.block_size);
+#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+			if (state->next_block.block_size > 65536) {
+				// Block size is invalid.
+				// The decryption key is probably wrong.
+				return -EIO;
+			}
+
+			assert(state->block_size > sizeof(state->next_block));
+			if (state->block_size <= sizeof(state->next_block)) {
+				// Block is missing the "next block" header...
+				return -EIO;
+			}
+			state->block_remain = state->block_size - sizeof(state->next_block);
+			state->inBlock = true;
+		}
+
+		if (state->block_remain > 2) {
+			// Get the chunk size.
+			uint16_t chunk_size;
+			size_t size = reader->read(&chunk_size, sizeof(chunk_size));
+			if (size != sizeof(chunk_size)) {
+				// Seek and/or read error.
+				return -EIO;
+			}
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+			chunk_size = be16_to_cpu(chunk_size);
+#endif /* SYS_BYTEORDER = SYS_LIL_ENDIAN */
+			state->block_remain -= 2;
+			if (chunk_size != 0 && chunk_size <= state->block_remain) {
+				// Found a chunk.
+				state->chunk_remain = chunk_size;
+				state->block_remain -= chunk_size;
+				return 1;
+			}
+			// End of block, or not enough data is available.
+		}
+
+		if (state->block_remain > 0) {
+			// Empty data at the end of the block.
+			// TODO: SEEK_CUR?
+			if (reader->seek(reader->tell() + state->block_remain) != 0) {
+				return -EIO;
+			}
+		}
+
+		// Next block.
+		state->block_size = state->next_block.block_size;
+		state->block_remain = 0;
+		state->inBlock = false;
+	}
+}
+
+/**
+ * LZX read callback for lzx_stream.
+ * @param opaque LzxDeblockState.
+ * @param buf Output buffer.
+ * @param size Size of buf.
+ * @return Number of bytes read; 0 at end of data; -1 on error.
+ */
+int Xbox360_XEX_Private::lzxReadFn(void *opaque, void *buf, int size)
+{
+	LzxDeblockState *const state = static_cast<LzxDeblockState*>(opaque);
+	uint8_t *buf8 = static_cast<uint8_t*>(buf);
+
+	int total = 0;
+	while (total < size) {
+		if (state->chunk_remain == 0) {
+			int ret = lzxNextChunk(state);
+			if (ret < 0) {
+				// Error reading the block data.
+				return -1;
+			} else if (ret == 0) {
+				// End of data.
+				break;
+			}
+		}
+
+		const uint32_t sz_req = std::min(state->chunk_remain, static_cast<uint32_t>(size - total));
+		size_t sz_read = state->reader->read(buf8, sz_req);
+		if (sz_read != sz_req) {
+			// Seek and/or read error.
+			return -1;
+		}
+		buf8 += sz_req;
+		total += sz_req;
+		state->chunk_remain -= sz_req;
+	}
+
+	return total;
+}
+
+/**
+ * Decompress the PE header and the XDBF section
+ * from an LZX-compressed executable.
+ *
+ * The compressed data is decrypted and decompressed as it's
+ * read, and decompression stops once the PE header and the
+ * XDBF section have been decompressed. An incorrect key is
+ * detected after decompressing the PE header.
+ *
+ * On success, lzx_peHeader and lzx_xdbfSection are set.
+ *
+ * @param reader	[in] CBCReader.
+ * @param first_block	[in] First block header. (byteswapped)
+ * @param window_size	[in] LZX window size.
+ * @param image_size	[in] Decompressed image size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Xbox360_XEX_Private::decompressLzx(CBCReader *reader, const XEX2_Compression_Normal_Info &first_block,
+	uint32_t window_size, uint32_t image_size)
+{
+	assert(image_size >= PE_HEADER_SIZE);
+	if (!reader || image_size < PE_HEADER_SIZE) {
+		return -EINVAL;
+	}
+
+	// Start at the beginning.
+	LzxDeblockState state;
+	state.reader = reader;
+	state.block_size = first_block.block_size;
+	state.block_remain = 0;
+	state.chunk_remain = 0;
+	state.inBlock = false;
+	reader->rewind();
+
+	unique_ptr<lzx_stream, decltype(&lzx_stream_free)> stream(
+		lzx_stream_init(window_size, image_size, lzxReadFn, &state),
+		lzx_stream_free);
+	if (!stream) {
+		// Invalid window size.
+		return -EIO;
+	}
+
+	// Decompress the PE header.
+	ao::uvector<uint8_t> peHeader(PE_HEADER_SIZE);
+	int res = lzx_stream_read(stream.get(), peHeader.data(), PE_HEADER_SIZE);
+	if (res != MSPACK_ERR_OK) {
+		// Error decompressing the data.
+		return -EIO;
+	}
+
+	// Verify the MZ header.
+	uint16_t mz;
+	memcpy(&mz, peHeader.data(), sizeof(mz));
+	if (mz != cpu_to_be16('MZ')) {
+		// MZ header is not valid.
+		// TODO: Other checks?
+		return -EIO;
+	}
+
+	// Decompress up to the end of the XDBF section.
+	// Data before the XDBF section is decompressed into
+	// a temporary buffer and discarded.
+	ao::uvector<uint8_t> xdbfSection;
+	const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
+	if (pResInfo) {
+		const uint32_t load_address = be32_to_cpu(
+			(xexType != XEX_TYPE_XEX1
+				? secInfo.xex2.load_address
+				: secInfo.xex1.load_address));
+
+		const uint32_t xdbf_physaddr = pResInfo->vaddr - load_address;
+		if (xdbf_physaddr < image_size && pResInfo->size <= image_size - xdbf_physaddr) {
+			xdbfSection.resize(pResInfo->size);
+			uint8_t *pXdbf = xdbfSection.data();
+			uint32_t xdbf_remain = pResInfo->size;
+			uint32_t out_pos = PE_HEADER_SIZE;
+
+			if (xdbf_physaddr < PE_HEADER_SIZE) {
+				// Part of the XDBF section is in the PE header.
+				const uint32_t sz = std::min(PE_HEADER_SIZE - xdbf_physaddr, xdbf_remain);
+				memcpy(pXdbf, &peHeader[xdbf_physaddr], sz);
+				pXdbf += sz;
+				xdbf_remain -= sz;
+			} else {
+				// Skip the data before the XDBF section.
+				static const uint32_t SKIP_BUF_SIZE = 64*1024;
+				unique_ptr<uint8_t[]> skip_buf(new uint8_t[SKIP_BUF_SIZE]);
+				while (out_pos < xdbf_physaddr) {
+					const uint32_t sz = std::min(xdbf_physaddr - out_pos, SKIP_BUF_SIZE);
+					res = lzx_stream_read(stream.get(), skip_buf.get(), sz);
+					if (res != MSPACK_ERR_OK) {
+						// Error decompressing the data.
+						return -EIO;
+					}
+					out_pos += sz;
+				}
+			}
+
+			if (xdbf_remain > 0) {
+				res = lzx_stream_read(stream.get(), pXdbf, xdbf_remain);
+				if (res != MSPACK_ERR_OK) {
+					// Error decompressing the data.
+					return -EIO;
+				}
+			}
+		}
+	}
+
+	// PE header and XDBF section have been decompressed.
+	lzx_peHeader.swap(peHeader);
+	lzx_xdbfSection.swap(xdbfSection);
+	return 0;
+}
+#endif /* ENABLE_LIBMSPACK */
+
 /**
  * Format a media ID or disc profile ID.
  *
@@ -1111,18 +1243,19 @@ Xbox360_Version_t Xbox360_XEX_Private::getMinKernelVersion(void)
 	// Minimum kernel version is determined by checking the
 	// import libraries and taking the maximum version.
 	ao::uvector<uint8_t> u8_implib;
-	size_t size = getOptHdrData(XEX2_OPTHDR_IMPORT_LIBRARIES, u8_implib);
+	const uint8_t *pData = nullptr;
+	size_t size = getOptHdrData(XEX2_OPTHDR_IMPORT_LIBRARIES, &pData, u8_implib);
 	if (size < sizeof(XEX2_Import_Libraries_Header) + (sizeof(XEX2_Import_Library_Entry) * 2)) {
 		// Too small...
 		return rver;
 	}
 
 	const XEX2_Import_Libraries_Header *const pLibHdr =
-		reinterpret_cast<const XEX2_Import_Libraries_Header*>(u8_implib.data());
+		reinterpret_cast<const XEX2_Import_Libraries_Header*>(pData);
 
 	// Pointers
-	const uint8_t *p = u8_implib.data();
-	const uint8_t *const p_end = p + u8_implib.size();
+	const uint8_t *p = pData;
+	const uint8_t *const p_end = p + size;
 
 	// Skip the string table.
 	p += sizeof(*pLibHdr) + be32_to_cpu(pLibHdr->str_tbl_size);
@@ -1607,7 +1740,8 @@ int Xbox360_XEX::loadFieldData(void)
 
 	// Original executable name
 	ao::uvector<uint8_t> u8_data;
-	size_t size = d->getOptHdrData(XEX2_OPTHDR_ORIGINAL_PE_NAME, u8_data);
+	const uint8_t *pData = nullptr;
+	size_t size = d->getOptHdrData(XEX2_OPTHDR_ORIGINAL_PE_NAME, &pData, u8_data);
 	if (size > sizeof(uint32_t)) {
 		// Sanity check: Must be less than 260 bytes. (PATH_MAX)
 		assert(size <= 260+sizeof(uint32_t));
@@ -1618,7 +1752,7 @@ int Xbox360_XEX::loadFieldData(void)
 			int len = static_cast<int>(size - sizeof(uint32_t));
 			d->fields->addField_string(C_("Xbox360_XEX", "PE Filename"),
 				cp1252_to_utf8(reinterpret_cast<const char*>(
-					u8_data.data() + sizeof(uint32_t)), len),
+					pData + sizeof(uint32_t)), len),
 				RomFields::STRF_TRIM_END);
 		}
 	}
@@ -1788,10 +1922,10 @@ int Xbox360_XEX::loadFieldData(void)
 		RomFields::STRF_MONOSPACE);
 
 	// Disc Profile ID
-	size = d->getOptHdrData(XEX2_OPTHDR_DISC_PROFILE_ID, u8_data);
+	size = d->getOptHdrData(XEX2_OPTHDR_DISC_PROFILE_ID, &pData, u8_data);
 	if (size == 16) {
 		d->fields->addField_string(C_("Xbox360_XEX", "Disc Profile ID"),
-			d->formatMediaID(u8_data.data()),
+			d->formatMediaID(pData),
 			RomFields::STRF_MONOSPACE);
 	}
 
@@ -1891,10 +2025,10 @@ int Xbox360_XEX::loadFieldData(void)
 	// Nintendo's systems. For Xbox 360, we'll need to convert the format.
 	// NOTE: The actual game ratings field is 64 bytes, but only the first
 	// 14 bytes are actually used.
-	size = d->getOptHdrData(XEX2_OPTHDR_GAME_RATINGS, u8_data);
+	size = d->getOptHdrData(XEX2_OPTHDR_GAME_RATINGS, &pData, u8_data);
 	if (size >= sizeof(XEX2_Game_Ratings)) {
 		const XEX2_Game_Ratings *const pLdGameRatings =
-			reinterpret_cast<const XEX2_Game_Ratings*>(u8_data.data());
+			reinterpret_cast<const XEX2_Game_Ratings*>(pData);
 
 		// Convert the game ratings.
 		RomFields::age_ratings_t age_ratings;
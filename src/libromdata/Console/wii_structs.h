@@ -159,6 +159,19 @@ typedef struct PACKED _RVL_TMD_Header {
 } RVL_TMD_Header;
 ASSERT_STRUCT(RVL_TMD_Header, 0x1E4);
 
+/**
+ * Wii TMD content entry.
+ * Reference: https://wiibrew.org/wiki/Tmd_file_structure
+ */
+typedef struct PACKED _RVL_Content_Entry {
+	uint32_t content_id;		// [0x000] Content ID.
+	uint16_t index;			// [0x004] Index.
+	uint16_t type;			// [0x006] Type.
+	uint64_t size;			// [0x008] Size.
+	uint8_t sha1_hash[20];		// [0x010] SHA-1 hash. (For discs, this is the H3 table hash.)
+} RVL_Content_Entry;
+ASSERT_STRUCT(RVL_Content_Entry, 0x24);
+
 /**
  * Access rights.
  */
@@ -184,6 +197,30 @@ typedef struct PACKED _RVL_PartitionHeader {
 } RVL_PartitionHeader;
 ASSERT_STRUCT(RVL_PartitionHeader, 0x8000);
 
+/**
+ * Wii partition cluster hash block.
+ * Each 0x8000-byte cluster has a 0x400-byte hash block
+ * followed by 0x7C00 bytes of data.
+ *
+ * Clusters are grouped into subgroups of 8 clusters,
+ * and subgroups are grouped into groups of 8 subgroups.
+ * All clusters in a subgroup have the same H1 table,
+ * and all clusters in a group have the same H2 table.
+ * The H3 table has one hash per group.
+ *
+ * Reference: https://wiibrew.org/wiki/Wii_Disc#Encrypted
+ */
+#define RVL_H3_TABLE_SIZE 0x18000
+typedef struct PACKED _RVL_HashBlock {
+	uint8_t h0[31][20];		// [0x000] SHA-1 hashes of each 0x400-byte data block.
+	uint8_t padding0[20];		// [0x26C]
+	uint8_t h1[8][20];		// [0x280] SHA-1 hashes of each H0 table in the subgroup.
+	uint8_t padding1[32];		// [0x320]
+	uint8_t h2[8][20];		// [0x340] SHA-1 hashes of each H1 table in the group.
+	uint8_t padding2[32];		// [0x3E0]
+} RVL_HashBlock;
+ASSERT_STRUCT(RVL_HashBlock, 0x400);
+
 /**
  * Country indexes in RVL_RegionSetting.ratings[].
  */
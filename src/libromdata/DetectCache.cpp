@@ -0,0 +1,914 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * DetectCache.cpp: Persistent RomData detection cache.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "DetectCache.hpp"
+
+// librpbase
+#include "librpbase/RomDataSerializer.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/SystemRegion.hpp"
+#include "librpbase/config/AboutTabText.hpp"
+#include "librpbase/crypto/Crc32.hpp"
+#include "librpbase/file/RpFile.hpp"
+using namespace LibRpBase;
+using LibRpBase::FileSystem::FileId;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C includes. (C++ namespace)
+#include <ctime>
+
+// C++ includes.
+#include <algorithm>
+using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::vector;
+
+namespace LibRomData { namespace DetectCache {
+
+/**
+ * The detection cache is stored in detect.cache in the
+ * rom-properties cache directory. The file consists of
+ * a header, followed by variable-length entries. Each
+ * entry starts with a DetectCacheEntry, which is followed
+ * by the serialized RomFields and RomMetaData for data
+ * entries. New entries are appended to the end of the
+ * file; if a file has multiple entries of the same type,
+ * the last one takes precedence.
+ *
+ * The cache file is locked while it's being read or
+ * written, so multiple processes can share it. If a
+ * process rewrites the file, e.g. to compact it, the
+ * generation number in the header is incremented, and
+ * other processes will reload the file the next time
+ * they lock it.
+ *
+ * All values are in host byte order, since the cache
+ * is only valid on the system that created it.
+ *
+ * Each entry also has a hash of the program state that
+ * affects detection and the stored fields: the program
+ * version, the system language, and the configuration
+ * and key files. Entries with a different state hash
+ * are ignored, and will be replaced when the file is
+ * detected again.
+ */
+
+static const char DETECT_CACHE_FILENAME[] = "detect.cache";
+static const uint32_t DETECT_CACHE_MAGIC = 'RPDC';
+static const uint32_t DETECT_CACHE_VERSION = 3;
+// Maximum size of the cache file.
+// If a new entry would exceed this, the cache file is
+// compacted, and the oldest entries are discarded.
+static const off64_t DETECT_CACHE_MAX_SIZE = 64*1024*1024;
+// Maximum size of the serialized data for a single file.
+static const uint32_t DETECT_CACHE_MAX_DATA_SIZE = 1024*1024;
+// Minimum amount of space used by outdated entries
+// before the cache file is compacted when loading it.
+static const off64_t DETECT_CACHE_MIN_DEAD_SIZE = 64*1024;
+
+struct DetectCacheHeader {
+	uint32_t magic;		// [0x000] 'RPDC' (host byte order)
+	uint32_t version;	// [0x004] DETECT_CACHE_VERSION
+	uint32_t entry_size;	// [0x008] sizeof(DetectCacheEntry)
+	uint32_t generation;	// [0x00C] Changed each time the file is rewritten.
+};
+ASSERT_STRUCT(DetectCacheHeader, 16);
+
+// Entry types.
+enum DetectCacheEntryType {
+	DCE_TYPE_DETECT	= 0,	// Detection result
+	DCE_TYPE_DATA	= 1,	// Serialized RomFields and RomMetaData
+};
+
+struct DetectCacheEntry {
+	uint64_t dev;		// [0x000] Device ID
+	uint64_t ino;		// [0x008] Inode number
+	int64_t size;		// [0x010] File size
+	int64_t mtime;		// [0x018] Modification time
+	uint32_t type;		// [0x020] Entry type (see DetectCacheEntryType)
+	uint32_t req_attrs;	// [0x024] RomDataAttr bitfield requested by the caller (0 for data entries)
+	uint32_t attrs;		// [0x028] RomDataAttr bitfield of the RomData subclass
+	int32_t romType;	// [0x02C] Class-specific system ID
+	char className[32];	// [0x030] RomData subclass name (NULL-terminated; empty if not supported)
+	uint32_t fields_size;	// [0x050] Size of the serialized RomFields (data entries only)
+	uint32_t metaData_size;	// [0x054] Size of the serialized RomMetaData (data entries only)
+	uint32_t state_hash;	// [0x058] Program state hash (see getStateHash())
+	int32_t fileType;	// [0x05C] RomData::FileType (data entries only)
+	char systemName[64];	// [0x060] System name (NULL-terminated; data entries only)
+};
+ASSERT_STRUCT(DetectCacheEntry, 160);
+
+// In-memory cache key.
+struct CacheKey {
+	uint64_t dev;
+	uint64_t ino;
+	uint32_t type;
+	uint32_t req_attrs;
+
+	inline bool operator==(const CacheKey &other) const
+	{
+		return (dev == other.dev && ino == other.ino &&
+		        type == other.type && req_attrs == other.req_attrs);
+	}
+};
+
+struct CacheKeyHash {
+	inline size_t operator()(const CacheKey &key) const
+	{
+		return std::hash<uint64_t>()(key.ino ^ (key.dev << 20) ^
+			(static_cast<uint64_t>(key.req_attrs) << 56) ^
+			(static_cast<uint64_t>(key.type) << 63));
+	}
+};
+
+// In-memory cache value.
+struct CacheValue {
+	int64_t size;
+	int64_t mtime;
+	uint64_t seq;		// Sequence number. (Higher is newer.)
+	uint32_t stateHash;
+	Entry entry;
+
+	// Data entries only.
+	off64_t dataOffset;	// Offset of the serialized data in the cache file.
+	uint32_t fields_size;
+	uint32_t metaData_size;
+	int fileType;
+	string systemName;
+
+	/**
+	 * Get the size of this entry in the cache file.
+	 * @return Size of this entry, in bytes.
+	 */
+	inline off64_t entrySize(void) const
+	{
+		return static_cast<off64_t>(sizeof(DetectCacheEntry)) + fields_size + metaData_size;
+	}
+};
+
+// Is the detection cache enabled?
+static volatile bool enabled = false;
+
+// Detection cache.
+// NOTE: The cache file is loaded on first use.
+static unordered_map<CacheKey, CacheValue, CacheKeyHash> map_cache;
+static Mutex mtxCache;
+static bool loaded = false;
+static string cacheFilename;		// Custom cache filename.
+static RpFile *cacheFile = nullptr;
+static uint32_t generation = 0;		// Generation of the loaded entries.
+static off64_t fileEnd = 0;		// End of the last loaded entry. (0 if nothing is loaded)
+static off64_t liveSize = 0;		// Total size of the entries in map_cache.
+static uint64_t seq = 0;		// Next sequence number.
+
+/**
+ * Get a hash of the program state that affects the detection
+ * results and the stored fields.
+ *
+ * This includes the program version, the system language,
+ * and the sizes and timestamps of the configuration files.
+ *
+ * @return State hash.
+ */
+static uint32_t getStateHash(void)
+{
+	Crc32 crc;
+	crc.update(AboutTabText::prg_version, strlen(AboutTabText::prg_version) + 1);
+	crc.update(AboutTabText::git_version, strlen(AboutTabText::git_version) + 1);
+
+	const uint32_t lc[2] = {SystemRegion::getLanguageCode(), SystemRegion::getCountryCode()};
+	crc.update(lc, sizeof(lc));
+
+	// NOTE: Config and KeyManager only know their filenames
+	// after the files are loaded, so the names are used here.
+	static const char *const conf_filenames[] = {
+		"rom-properties.conf",
+		"keys.conf",
+	};
+	const string &configDir = FileSystem::getConfigDirectory();
+	for (unsigned int i = 0; i < ARRAY_SIZE(conf_filenames); i++) {
+		int64_t conf_state[2] = {-1, -1};
+		if (!configDir.empty()) {
+			string filename = configDir;
+			if (filename.at(filename.size()-1) != DIR_SEP_CHR) {
+				filename += DIR_SEP_CHR;
+			}
+			filename += conf_filenames[i];
+
+			off64_t size;
+			time_t mtime;
+			if (FileSystem::get_file_size_and_mtime(filename, &size, &mtime) == 0) {
+				conf_state[0] = size;
+				conf_state[1] = mtime;
+			}
+		}
+		crc.update(conf_state, sizeof(conf_state));
+	}
+
+	return crc.value();
+}
+
+/**
+ * Initialize a DetectCacheEntry from an in-memory cache entry.
+ * @param pDce	[out] DetectCacheEntry.
+ * @param key	[in] Cache key.
+ * @param value	[in] Cache value.
+ */
+static void initDetectCacheEntry(DetectCacheEntry *pDce, const CacheKey &key, const CacheValue &value)
+{
+	memset(pDce, 0, sizeof(*pDce));
+	pDce->dev = key.dev;
+	pDce->ino = key.ino;
+	pDce->size = value.size;
+	pDce->mtime = value.mtime;
+	pDce->type = key.type;
+	pDce->req_attrs = key.req_attrs;
+	pDce->attrs = value.entry.attrs;
+	pDce->romType = value.entry.romType;
+	memcpy(pDce->className, value.entry.className.data(), value.entry.className.size());
+	pDce->fields_size = value.fields_size;
+	pDce->metaData_size = value.metaData_size;
+	pDce->state_hash = value.stateHash;
+	pDce->fileType = value.fileType;
+	memcpy(pDce->systemName, value.systemName.data(), value.systemName.size());
+}
+
+/**
+ * Close the cache file and clear the in-memory cache.
+ * mtxCache must be locked by the caller.
+ */
+static void closeCacheFile(void)
+{
+	if (cacheFile) {
+		cacheFile->unref();
+		cacheFile = nullptr;
+	}
+	map_cache.clear();
+	fileEnd = 0;
+	liveSize = 0;
+}
+
+/**
+ * Add an entry to the in-memory cache.
+ * mtxCache must be locked by the caller.
+ * @param key Cache key.
+ * @param value Cache value. (seq is assigned by this function)
+ */
+static void addCacheValue(const CacheKey &key, const CacheValue &value)
+{
+	auto iter = map_cache.find(key);
+	if (iter != map_cache.end()) {
+		// Replacing an existing entry.
+		liveSize -= iter->second.entrySize();
+		iter->second = value;
+		iter->second.seq = seq++;
+	} else {
+		CacheValue &newValue = map_cache[key];
+		newValue = value;
+		newValue.seq = seq++;
+	}
+	liveSize += value.entrySize();
+}
+
+/**
+ * Write a new cache file header, discarding all entries.
+ * mtxCache must be locked by the caller, and
+ * the cache file must be locked.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int initCacheFile(void)
+{
+	map_cache.clear();
+	liveSize = 0;
+
+	// Use a new generation number so other processes
+	// don't use their previously-loaded entries.
+	generation = (fileEnd != 0 ? generation + 1 : static_cast<uint32_t>(time(nullptr)));
+
+	DetectCacheHeader header;
+	header.magic = DETECT_CACHE_MAGIC;
+	header.version = DETECT_CACHE_VERSION;
+	header.entry_size = sizeof(DetectCacheEntry);
+	header.generation = generation;
+	if (cacheFile->truncate(0) != 0 || cacheFile->seek(0) != 0 ||
+	    cacheFile->write(&header, sizeof(header)) != sizeof(header))
+	{
+		fileEnd = 0;
+		return -EIO;
+	}
+
+	fileEnd = sizeof(header);
+	return 0;
+}
+
+/**
+ * Read entries from the cache file.
+ * mtxCache must be locked by the caller, and
+ * the cache file must be locked.
+ * @param endPos End of the file.
+ * @return 0 on success; negative POSIX error code if the file is corrupted.
+ */
+static int readEntries(off64_t endPos)
+{
+	if (cacheFile->seek(fileEnd) != 0)
+		return -EIO;
+
+	off64_t pos = fileEnd;
+	while (endPos - pos >= static_cast<off64_t>(sizeof(DetectCacheEntry))) {
+		DetectCacheEntry dce;
+		if (cacheFile->read(&dce, sizeof(dce)) != sizeof(dce))
+			return -EIO;
+
+		// Validate the entry.
+		if (dce.className[sizeof(dce.className)-1] != '\0' ||
+		    dce.systemName[sizeof(dce.systemName)-1] != '\0' ||
+		    dce.fields_size > DETECT_CACHE_MAX_DATA_SIZE ||
+		    dce.metaData_size > DETECT_CACHE_MAX_DATA_SIZE)
+		{
+			return -EIO;
+		}
+		switch (dce.type) {
+			case DCE_TYPE_DETECT:
+				if (dce.fields_size != 0 || dce.metaData_size != 0)
+					return -EIO;
+				break;
+			case DCE_TYPE_DATA:
+				if (dce.req_attrs != 0 || dce.fields_size == 0)
+					return -EIO;
+				break;
+			default:
+				return -EIO;
+		}
+
+		const off64_t dataOffset = pos + sizeof(dce);
+		const off64_t nextPos = dataOffset + dce.fields_size + dce.metaData_size;
+		if (nextPos > endPos) {
+			// Truncated entry.
+			break;
+		}
+
+		const CacheKey key = {dce.dev, dce.ino, dce.type, dce.req_attrs};
+		CacheValue value;
+		value.size = dce.size;
+		value.mtime = dce.mtime;
+		value.stateHash = dce.state_hash;
+		value.entry.className = dce.className;
+		value.entry.romType = dce.romType;
+		value.entry.attrs = dce.attrs;
+		value.dataOffset = dataOffset;
+		value.fields_size = dce.fields_size;
+		value.metaData_size = dce.metaData_size;
+		value.fileType = dce.fileType;
+		value.systemName = dce.systemName;
+		addCacheValue(key, value);
+
+		if (nextPos != dataOffset) {
+			// Skip the serialized data.
+			if (cacheFile->seek(nextPos) != 0)
+				return -EIO;
+		}
+		pos = nextPos;
+	}
+
+	if (pos != endPos) {
+		// Truncate the partial entry.
+		// This may have been left by a process that crashed
+		// while writing an entry.
+		if (cacheFile->truncate(pos) != 0)
+			return -EIO;
+	}
+	fileEnd = pos;
+	return 0;
+}
+
+/**
+ * Compact the cache file.
+ *
+ * Outdated entries are removed. If the remaining entries
+ * take up more than half of DETECT_CACHE_MAX_SIZE, the
+ * oldest entries are removed, too.
+ *
+ * mtxCache must be locked by the caller, and
+ * the cache file must be locked.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int compactCacheFile(void)
+{
+	// Sort the entries by age, newest first.
+	typedef std::pair<CacheKey, CacheValue> KeyValue;
+	vector<KeyValue> entries(map_cache.cbegin(), map_cache.cend());
+	std::sort(entries.begin(), entries.end(),
+		[](const KeyValue &a, const KeyValue &b) { return a.second.seq > b.second.seq; });
+
+	// Keep the newest entries that fit in half of the maximum size.
+	off64_t newSize = sizeof(DetectCacheHeader);
+	size_t keep = 0;
+	for (; keep < entries.size(); keep++) {
+		const off64_t entrySize = entries[keep].second.entrySize();
+		if (newSize + entrySize > DETECT_CACHE_MAX_SIZE / 2)
+			break;
+		newSize += entrySize;
+	}
+	entries.resize(keep);
+	std::reverse(entries.begin(), entries.end());
+
+	// Build the new file contents, oldest entries first.
+	// NOTE: The serialized data is read from the current file,
+	// so the file can't be rewritten until everything is read.
+	vector<uint8_t> buf;
+	buf.reserve(static_cast<size_t>(newSize - sizeof(DetectCacheHeader)));
+	for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+		const CacheKey &key = iter->first;
+		CacheValue &value = iter->second;
+
+		DetectCacheEntry dce;
+		initDetectCacheEntry(&dce, key, value);
+
+		const size_t dcePos = buf.size();
+		const size_t dataSize = value.fields_size + value.metaData_size;
+		buf.resize(dcePos + sizeof(dce) + dataSize);
+		memcpy(&buf[dcePos], &dce, sizeof(dce));
+		if (dataSize > 0) {
+			if (cacheFile->pread(value.dataOffset, &buf[dcePos + sizeof(dce)], dataSize) != dataSize)
+				return -EIO;
+		}
+
+		// Offset of the serialized data, relative to the first entry.
+		value.dataOffset = static_cast<off64_t>(dcePos + sizeof(dce));
+	}
+
+	// Rewrite the cache file.
+	int ret = initCacheFile();
+	if (ret != 0)
+		return ret;
+	if (!buf.empty() && cacheFile->write(buf.data(), buf.size()) != buf.size())
+		return -EIO;
+
+	// Re-add the remaining entries, oldest first.
+	for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+		iter->second.dataOffset += fileEnd;
+		addCacheValue(iter->first, iter->second);
+	}
+	fileEnd += buf.size();
+	return 0;
+}
+
+/**
+ * Get the default cache filename.
+ * @return Cache filename, or empty string on error.
+ */
+static string getDefaultFilename(void)
+{
+	const string &cacheDir = FileSystem::getCacheDirectory();
+	if (cacheDir.empty())
+		return string();
+
+	string filename = cacheDir;
+	if (filename.at(filename.size()-1) != DIR_SEP_CHR) {
+		filename += DIR_SEP_CHR;
+	}
+	filename += DETECT_CACHE_FILENAME;
+	return filename;
+}
+
+/**
+ * Lock the cache file and load any entries that were
+ * added by other processes.
+ *
+ * The cache file is opened on first use. If the cache
+ * file is invalid, it will be recreated. If it has too
+ * many outdated entries, it will be compacted.
+ *
+ * mtxCache must be locked by the caller.
+ *
+ * @return True if the cache file is locked; false on error.
+ */
+static bool lockCacheFile(void)
+{
+	if (!loaded) {
+		loaded = true;
+		const string filename = (!cacheFilename.empty() ? cacheFilename : getDefaultFilename());
+		if (filename.empty() || FileSystem::rmkdir(filename) != 0)
+			return false;
+
+		cacheFile = new RpFile(filename, RpFile::FM_OPEN_WRITE);
+		if (!cacheFile->isOpen()) {
+			// Create the cache file.
+			// NOTE: If another process creates the file at the same time,
+			// the file might be truncated after it wrote its entries.
+			// The generation number will be different, so it will
+			// reload the file instead of using its old entries.
+			cacheFile->unref();
+			cacheFile = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+			if (!cacheFile->isOpen()) {
+				cacheFile->unref();
+				cacheFile = nullptr;
+				return false;
+			}
+		}
+	}
+	if (!cacheFile || cacheFile->lock() != 0)
+		return false;
+
+	bool ok = false;
+	do {
+		const off64_t fileSize = cacheFile->size();
+		DetectCacheHeader header;
+		if (fileSize < static_cast<off64_t>(sizeof(header)) ||
+		    cacheFile->pread(0, &header, sizeof(header)) != sizeof(header) ||
+		    header.magic != DETECT_CACHE_MAGIC ||
+		    header.version != DETECT_CACHE_VERSION ||
+		    header.entry_size != sizeof(DetectCacheEntry))
+		{
+			// Incorrect header. (Re-)create the cache file.
+			ok = (initCacheFile() == 0);
+			break;
+		}
+
+		if (fileEnd == 0 || header.generation != generation || fileEnd > fileSize) {
+			// The cache file was rewritten by another process,
+			// or it hasn't been loaded yet. Reload it.
+			map_cache.clear();
+			liveSize = 0;
+			generation = header.generation;
+			fileEnd = sizeof(header);
+		}
+
+		if (fileEnd < fileSize) {
+			// Load the new entries.
+			if (readEntries(fileSize) != 0) {
+				// Cache file is corrupted.
+				ok = (initCacheFile() == 0);
+				break;
+			}
+
+			// Compact the cache file if it's too big, or if
+			// more than half of it consists of outdated entries.
+			const off64_t deadSize = fileEnd - static_cast<off64_t>(sizeof(header)) - liveSize;
+			if (fileEnd > DETECT_CACHE_MAX_SIZE ||
+			    (deadSize >= DETECT_CACHE_MIN_DEAD_SIZE && deadSize > liveSize))
+			{
+				ok = (compactCacheFile() == 0);
+				break;
+			}
+		}
+		ok = true;
+	} while (0);
+
+	if (!ok) {
+		// Error accessing the cache file. Stop using it.
+		// NOTE: Closing the file releases the lock.
+		closeCacheFile();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Unlock the cache file.
+ * mtxCache must be locked by the caller.
+ */
+static inline void unlockCacheFile(void)
+{
+	cacheFile->unlock();
+}
+
+/**
+ * Append an entry to the cache file.
+ * mtxCache must be locked by the caller, and
+ * the cache file must be locked.
+ * @param key	[in] Cache key.
+ * @param value	[in] Cache value. (dataOffset is set by this function)
+ * @param data	[in,opt] Serialized data, if any.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int appendEntry(const CacheKey &key, CacheValue &value, const uint8_t *data)
+{
+	if (fileEnd + value.entrySize() > DETECT_CACHE_MAX_SIZE) {
+		// Cache file is full. Remove the oldest entries.
+		int ret = compactCacheFile();
+		if (ret != 0)
+			return ret;
+	}
+
+	DetectCacheEntry dce;
+	initDetectCacheEntry(&dce, key, value);
+
+	// Write the entry and its data with a single write.
+	const size_t dataSize = value.fields_size + value.metaData_size;
+	vector<uint8_t> buf(sizeof(dce) + dataSize);
+	memcpy(buf.data(), &dce, sizeof(dce));
+	if (dataSize > 0) {
+		memcpy(&buf[sizeof(dce)], data, dataSize);
+	}
+
+	if (cacheFile->seek(fileEnd) != 0 ||
+	    cacheFile->write(buf.data(), buf.size()) != buf.size())
+	{
+		// Write error. Remove the partial entry.
+		cacheFile->truncate(fileEnd);
+		return -EIO;
+	}
+
+	value.dataOffset = fileEnd + sizeof(dce);
+	addCacheValue(key, value);
+	fileEnd += buf.size();
+	return 0;
+}
+
+/**
+ * Enable or disable the detection cache.
+ * The detection cache is disabled by default.
+ * @param enabled True to enable; false to disable.
+ */
+void setEnabled(bool enabled)
+{
+	DetectCache::enabled = enabled;
+}
+
+/**
+ * Is the detection cache enabled?
+ * @return True if enabled; false if not.
+ */
+bool isEnabled(void)
+{
+	return enabled;
+}
+
+/**
+ * Set the detection cache filename.
+ * The current cache file is closed, and the new
+ * cache file will be loaded on next use.
+ * @param filename Cache filename. (If empty, detect.cache in the cache directory is used.)
+ */
+void setFilename(const string &filename)
+{
+	MutexLocker mtxLocker(mtxCache);
+	closeCacheFile();
+	cacheFilename = filename;
+	loaded = false;
+}
+
+/**
+ * Look up a file in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataAttr bitfield requested by the caller.
+ * @param pEntry	[out] Cache entry.
+ * @return True if found; false if not.
+ */
+bool lookup(const FileId &fileId, unsigned int attrs, Entry *pEntry)
+{
+	assert(pEntry != nullptr);
+	MutexLocker mtxLocker(mtxCache);
+	if (!loaded) {
+		// Load the cache file.
+		if (lockCacheFile()) {
+			unlockCacheFile();
+		}
+	}
+
+	const CacheKey key = {fileId.dev, fileId.ino, DCE_TYPE_DETECT, attrs};
+	auto iter = map_cache.find(key);
+	if (iter == map_cache.end())
+		return false;
+
+	// Make sure the file and the program state haven't changed.
+	const CacheValue &value = iter->second;
+	if (value.size != fileId.size || value.mtime != fileId.mtime ||
+	    value.stateHash != getStateHash())
+	{
+		return false;
+	}
+
+	*pEntry = value.entry;
+	return true;
+}
+
+/**
+ * Store a file in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataAttr bitfield requested by the caller.
+ * @param entry		[in] Cache entry.
+ */
+void store(const FileId &fileId, unsigned int attrs, const Entry &entry)
+{
+	assert(entry.className.size() < sizeof(DetectCacheEntry::className));
+	if (entry.className.size() >= sizeof(DetectCacheEntry::className))
+		return;
+
+	MutexLocker mtxLocker(mtxCache);
+	if (!lockCacheFile())
+		return;
+
+	const CacheKey key = {fileId.dev, fileId.ino, DCE_TYPE_DETECT, attrs};
+	CacheValue value;
+	value.size = fileId.size;
+	value.mtime = fileId.mtime;
+	value.stateHash = getStateHash();
+	value.entry = entry;
+	value.fields_size = 0;
+	value.metaData_size = 0;
+	value.fileType = 0;
+	if (appendEntry(key, value, nullptr) != 0) {
+		// Write error. Stop using the cache file.
+		closeCacheFile();
+		return;
+	}
+	unlockCacheFile();
+}
+
+/**
+ * Look up a file's fields and metadata in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @param pData		[out] Cached data.
+ * @return True if found; false if not.
+ */
+bool lookupData(const FileId &fileId, const char *className, Data *pData)
+{
+	assert(className != nullptr);
+	assert(pData != nullptr);
+
+	const CacheKey key = {fileId.dev, fileId.ino, DCE_TYPE_DATA, 0};
+	const uint32_t stateHash = getStateHash();
+	ao::uvector<uint8_t> buf;
+	uint32_t fields_size;
+	int fileType;
+	string systemName;
+	{
+		MutexLocker mtxLocker(mtxCache);
+		if (!lockCacheFile())
+			return false;
+
+		// NOTE: Look up the entry after locking the cache file,
+		// since the data offset might have been changed if the
+		// file was rewritten by another process.
+		auto iter = map_cache.find(key);
+		if (iter == map_cache.end()) {
+			unlockCacheFile();
+			return false;
+		}
+
+		// Make sure the file and the program state haven't
+		// changed, and that the data is for the same class.
+		const CacheValue &value = iter->second;
+		if (value.size != fileId.size || value.mtime != fileId.mtime ||
+		    value.stateHash != stateHash || value.entry.className != className)
+		{
+			unlockCacheFile();
+			return false;
+		}
+
+		fields_size = value.fields_size;
+		fileType = value.fileType;
+		systemName = value.systemName;
+		buf.resize(value.fields_size + value.metaData_size);
+		const size_t size = cacheFile->pread(value.dataOffset, buf.data(), buf.size());
+		unlockCacheFile();
+		if (size != buf.size())
+			return false;
+	}
+
+	// Deserialize the data.
+	unique_ptr<RomFields> fields(RomDataSerializer::deserializeFields(buf.data(), fields_size));
+	if (!fields)
+		return false;
+	RomMetaData *metaData = nullptr;
+	if (buf.size() > fields_size) {
+		metaData = RomDataSerializer::deserializeMetaData(&buf[fields_size], buf.size() - fields_size);
+		if (!metaData)
+			return false;
+	}
+
+	pData->fileType = fileType;
+	pData->systemName = std::move(systemName);
+	pData->fields = fields.release();
+	pData->metaData = metaData;
+	return true;
+}
+
+/**
+ * Check if a file's fields and metadata are stored in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @return True if stored; false if not.
+ */
+bool hasData(const FileId &fileId, const char *className)
+{
+	assert(className != nullptr);
+	MutexLocker mtxLocker(mtxCache);
+	if (!loaded) {
+		// Load the cache file.
+		if (lockCacheFile()) {
+			unlockCacheFile();
+		}
+	}
+
+	const CacheKey key = {fileId.dev, fileId.ino, DCE_TYPE_DATA, 0};
+	auto iter = map_cache.find(key);
+	if (iter == map_cache.end())
+		return false;
+
+	const CacheValue &value = iter->second;
+	return (value.size == fileId.size && value.mtime == fileId.mtime &&
+	        value.stateHash == getStateHash() && value.entry.className == className);
+}
+
+/**
+ * Store a file's fields and metadata in the detection cache.
+ *
+ * NOTE: Fields with ListData icons can't be stored,
+ * since the icons aren't serialized.
+ *
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @param fileType	[in] RomData::FileType
+ * @param systemName	[in,opt] systemName(SYSNAME_TYPE_LONG | SYSNAME_REGION_ROM_LOCAL)
+ * @param fields	[in] RomFields.
+ * @param metaData	[in,opt] RomMetaData.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int storeData(const FileId &fileId, const char *className,
+	int fileType, const char *systemName,
+	const RomFields *fields, const RomMetaData *metaData)
+{
+	assert(className != nullptr);
+	assert(fields != nullptr);
+	if (!className || !fields)
+		return -EINVAL;
+	const size_t classNameLen = strlen(className);
+	assert(classNameLen < sizeof(DetectCacheEntry::className));
+	if (classNameLen >= sizeof(DetectCacheEntry::className))
+		return -EINVAL;
+	// NOTE: If the system name is too long, it isn't stored,
+	// and it will be retrieved from the RomData subclass.
+	const size_t systemNameLen = (systemName ? strlen(systemName) : 0);
+
+	// Make sure there aren't any ListData icons.
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		if (iter->type == RomFields::RFT_LISTDATA &&
+		    (iter->desc.list_data.flags & RomFields::RFT_LISTDATA_ICONS))
+		{
+			return -ENOTSUP;
+		}
+	}
+
+	// Serialize the data.
+	ao::uvector<uint8_t> buf;
+	int ret = RomDataSerializer::serializeFields(fields, buf);
+	if (ret != 0)
+		return ret;
+	const size_t fields_size = buf.size();
+	if (metaData && !metaData->empty()) {
+		ao::uvector<uint8_t> mdbuf;
+		ret = RomDataSerializer::serializeMetaData(metaData, mdbuf);
+		if (ret != 0)
+			return ret;
+		buf.insert(buf.end(), mdbuf.begin(), mdbuf.end());
+	}
+	if (fields_size > DETECT_CACHE_MAX_DATA_SIZE ||
+	    buf.size() - fields_size > DETECT_CACHE_MAX_DATA_SIZE)
+	{
+		return -ENOSPC;
+	}
+
+	MutexLocker mtxLocker(mtxCache);
+	if (!lockCacheFile())
+		return -EIO;
+
+	const CacheKey key = {fileId.dev, fileId.ino, DCE_TYPE_DATA, 0};
+	CacheValue value;
+	value.size = fileId.size;
+	value.mtime = fileId.mtime;
+	value.stateHash = getStateHash();
+	value.entry.className.assign(className, classNameLen);
+	value.entry.romType = 0;
+	value.entry.attrs = 0;
+	value.fields_size = static_cast<uint32_t>(fields_size);
+	value.metaData_size = static_cast<uint32_t>(buf.size() - fields_size);
+	value.fileType = fileType;
+	if (systemName && systemNameLen < sizeof(DetectCacheEntry::systemName)) {
+		value.systemName.assign(systemName, systemNameLen);
+	}
+	ret = appendEntry(key, value, buf.data());
+	if (ret != 0) {
+		// Write error. Stop using the cache file.
+		closeCacheFile();
+		return ret;
+	}
+	unlockCacheFile();
+	return 0;
+}
+
+} }
@@ -0,0 +1,118 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * DetectCache.hpp: Persistent RomData detection cache.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_DETECTCACHE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_DETECTCACHE_HPP__
+
+#include "librpbase/file/FileSystem.hpp"
+
+namespace LibRpBase {
+	class RomFields;
+	class RomMetaData;
+}
+
+// C++ includes.
+#include <string>
+
+namespace LibRomData { namespace DetectCache {
+
+/**
+ * Detection cache entry.
+ */
+struct Entry {
+	std::string className;	// RomData subclass name. (empty if not supported)
+	int romType;		// Class-specific system ID.
+	unsigned int attrs;	// RomDataAttr bitfield of the RomData subclass.
+};
+
+/**
+ * Detection cache data for a file.
+ */
+struct Data {
+	int fileType;			// RomData::FileType
+	std::string systemName;		// systemName(SYSNAME_TYPE_LONG | SYSNAME_REGION_ROM_LOCAL) (empty if not stored)
+	LibRpBase::RomFields *fields;	// RomFields. (Caller must delete it.)
+	LibRpBase::RomMetaData *metaData;	// RomMetaData, or nullptr if no metadata was stored. (Caller must delete it.)
+};
+
+/**
+ * Enable or disable the detection cache.
+ * The detection cache is disabled by default.
+ * @param enabled True to enable; false to disable.
+ */
+void setEnabled(bool enabled);
+
+/**
+ * Is the detection cache enabled?
+ * @return True if enabled; false if not.
+ */
+bool isEnabled(void);
+
+/**
+ * Set the detection cache filename.
+ * The current cache file is closed, and the new
+ * cache file will be loaded on next use.
+ * @param filename Cache filename. (If empty, detect.cache in the cache directory is used.)
+ */
+void setFilename(const std::string &filename);
+
+/**
+ * Look up a file in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataAttr bitfield requested by the caller.
+ * @param pEntry	[out] Cache entry.
+ * @return True if found; false if not.
+ */
+bool lookup(const LibRpBase::FileSystem::FileId &fileId, unsigned int attrs, Entry *pEntry);
+
+/**
+ * Store a file in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataAttr bitfield requested by the caller.
+ * @param entry		[in] Cache entry.
+ */
+void store(const LibRpBase::FileSystem::FileId &fileId, unsigned int attrs, const Entry &entry);
+
+/**
+ * Look up a file's fields and metadata in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @param pData		[out] Cached data.
+ * @return True if found; false if not.
+ */
+bool lookupData(const LibRpBase::FileSystem::FileId &fileId, const char *className, Data *pData);
+
+/**
+ * Check if a file's fields and metadata are stored in the detection cache.
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @return True if stored; false if not.
+ */
+bool hasData(const LibRpBase::FileSystem::FileId &fileId, const char *className);
+
+/**
+ * Store a file's fields and metadata in the detection cache.
+ *
+ * NOTE: Fields with ListData icons can't be stored,
+ * since the icons aren't serialized.
+ *
+ * @param fileId	[in] File identity.
+ * @param className	[in] RomData subclass name.
+ * @param fileType	[in] RomData::FileType
+ * @param systemName	[in,opt] systemName(SYSNAME_TYPE_LONG | SYSNAME_REGION_ROM_LOCAL)
+ * @param fields	[in] RomFields.
+ * @param metaData	[in,opt] RomMetaData.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int storeData(const LibRpBase::FileSystem::FileId &fileId, const char *className,
+	int fileType, const char *systemName,
+	const LibRpBase::RomFields *fields, const LibRpBase::RomMetaData *metaData);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_DETECTCACHE_HPP__ */
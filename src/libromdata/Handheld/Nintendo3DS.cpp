@@ -1886,12 +1886,20 @@ uint32_t Nintendo3DS::imgpf(ImageType imageType) const
  * @return Number of fields read on success; negative POSIX error code on error.
  */
 int Nintendo3DS::loadFieldData(void)
+{
+	return loadFieldTabs(RomFields::TAB_MASK_ALL);
+}
+
+/**
+ * Load field data for the specified tabs.
+ * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+ * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int Nintendo3DS::loadFieldTabs(uint32_t tabMask)
 {
 	RP_D(Nintendo3DS);
-	if (!d->fields->empty()) {
-		// Field data *has* been loaded...
-		return 0;
-	} else if (!d->file || !d->file->isOpen()) {
+	if (!d->file || !d->file->isOpen()) {
 		// File isn't open.
 		return -EBADF;
 	} else if (!d->isValid || d->romType < 0) {
@@ -1899,6 +1907,14 @@ int Nintendo3DS::loadFieldData(void)
 		return -EIO;
 	}
 
+	// Don't load tabs that have already been loaded.
+	// loadFieldData() may be called after fields() loaded some tabs.
+	tabMask &= ~d->fieldsTabsLoaded;
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Field data *has* been loaded...
+		return 0;
+	}
+
 	// TODO: Disambiguate the various NCCHReader pointers.
 	// TODO: Split up into smaller functions?
 	const char *const s_unknown = C_("RomData", "Unknown");
@@ -1911,9 +1927,6 @@ int Nintendo3DS::loadFieldData(void)
 	// SMDH, NCSD/CIA, ExHeader, Permissions
 	d->fields->reserveTabs(4);
 
-	// Have we shown a warning yet?
-	bool shownWarning = false;
-
 	// Load headers if we don't already have them.
 	if (!(d->headers_loaded & Nintendo3DSPrivate::HEADER_SMDH)) {
 		d->loadSMDH();
@@ -1929,102 +1942,159 @@ int Nintendo3DS::loadFieldData(void)
 	// it usually means there's a missing key.
 	const NCCHReader *const ncch = d->loadNCCH();
 
+	// Get the NCCH Extended Header.
+	const N3DS_NCCH_ExHeader_t *const ncch_exheader =
+		(ncch && ncch->isOpen() ? ncch->ncchExHeader() : nullptr);
+
+	// Tab layout:
+	// - SMDH or DSiWare (including the DSiWare tabs), if present
+	// - NCSD or CIA (combined with the first tab if there's no SMDH or DSiWare)
+	// - ExHeader, if present
+	// - Permissions, if the ExHeader is present
+	// Tab indexes don't depend on the requested tabs, since the
+	// frontends might create all tabs before loading them.
+	bool haveSeparateSMDHTab = true;
+	const RomFields *srl_fields = nullptr;
+	int nextTabIdx = 1;
+	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_SMDH) {
+		d->fields->setTabName(0, "SMDH");
+		// Will we end up having a separate SMDH tab?
+		if (!(d->headers_loaded & (Nintendo3DSPrivate::HEADER_NCSD | Nintendo3DSPrivate::HEADER_TMD))) {
+			// There will only be a single tab.
+			haveSeparateSMDHTab = false;
+		}
+	} else if (d->sbptr.srl.data && (srl_fields = d->sbptr.srl.data->fields()) != nullptr) {
+		// DSiWare SRL.
+		d->fields->setTabName(0, C_("Nintendo3DS", "DSiWare"));
+
+		// Will we end up having a separate DSiWare tab?
+		if (!(d->headers_loaded & (Nintendo3DSPrivate::HEADER_NCSD | Nintendo3DSPrivate::HEADER_TMD))) {
+			// There will only be a single tab.
+			haveSeparateSMDHTab = false;
+		}
+
+		// Do we have additional tabs?
+		// TODO: Combine "DSiWare" (tab 0) and "DSi" (tab 1)?
+		const int subtab_count = srl_fields->tabCount();
+		if (subtab_count > 1) {
+			for (int subtab = 1; subtab < subtab_count; subtab++) {
+				d->fields->setTabName(subtab, srl_fields->tabName(subtab));
+			}
+			nextTabIdx = subtab_count;
+
+			// The DSiWare fields are added all at once,
+			// so the DSiWare tabs are always loaded together.
+			RomFields::TabMask srlTabMask = RomFields::TAB_MASK_NONE;
+			for (int subtab = 0; subtab < subtab_count; subtab++) {
+				srlTabMask |= RomFields::tabMaskBit(subtab);
+			}
+			if (tabMask & srlTabMask) {
+				tabMask |= srlTabMask;
+			}
+		}
+	} else {
+		// Single tab.
+		haveSeparateSMDHTab = false;
+	}
+
+	int ncsdTabIdx = -1, ciaTabIdx = -1;
+	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_NCSD) {
+		ncsdTabIdx = (haveSeparateSMDHTab ? nextTabIdx++ : 0);
+		d->fields->setTabName(ncsdTabIdx, "NCSD");
+	}
+	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_TMD) {
+		// NOTE: This is usually for CIAs only.
+		ciaTabIdx = (haveSeparateSMDHTab ? nextTabIdx++ : 0);
+		d->fields->setTabName(ciaTabIdx, "CIA");
+	}
+
+	int exheaderTabIdx = -1;
+	if (ncch_exheader) {
+		// Permissions are technically part of the ExHeader,
+		// but we're using a separate tab because there's
+		// a lot of them.
+		exheaderTabIdx = nextTabIdx++;
+		d->fields->setTabName(exheaderTabIdx, "ExHeader");
+		d->fields->setTabName(exheaderTabIdx + 1, C_("Nintendo3DS", "Permissions"));
+	}
+
+	// Have we shown a warning yet?
+	// NOTE: This is checked even if the first tab isn't being
+	// loaded in order to prevent duplicate warnings.
+	bool shownWarning = false;
+
 	// Check for potential encryption key errors.
+	const char *warning = nullptr;
 	if (d->romType == Nintendo3DSPrivate::ROM_TYPE_CCI ||
 	    d->romType == Nintendo3DSPrivate::ROM_TYPE_CIA ||
 	    d->romType == Nintendo3DSPrivate::ROM_TYPE_NCCH)
 	{
 		if (!ncch) {
 			// Unable to open the primary NCCH section.
-			if (!shownWarning) {
-				d->fields->addField_string(C_("RomData", "Warning"),
-					C_("Nintendo3DS", "Unable to open the primary NCCH section."),
-					RomFields::STRF_WARNING);
-				shownWarning = true;
-			}
+			warning = C_("Nintendo3DS", "Unable to open the primary NCCH section.");
 		} else {
 			KeyManager::VerifyResult res = ncch->verifyResult();
 			if (!d->sbptr.srl.data && res != KeyManager::VERIFY_OK) {
 				// Missing encryption keys.
-				if (!shownWarning) {
-					const char *err = KeyManager::verifyResultToString(res);
-					if (!err) {
-						err = C_("Nintendo3DS", "Unknown error. (THIS IS A BUG!)");
-					}
-					d->fields->addField_string(C_("RomData", "Warning"),
-						err, RomFields::STRF_WARNING);
-					shownWarning = true;
+				warning = KeyManager::verifyResultToString(res);
+				if (!warning) {
+					warning = C_("Nintendo3DS", "Unknown error. (THIS IS A BUG!)");
 				}
 			}
 		}
+		shownWarning = (warning != nullptr);
 	}
 
-	// Load and parse the SMDH header.
-	bool haveSeparateSMDHTab = true;
-	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_SMDH) {
-		d->fields->setTabName(0, "SMDH");
-		// Will we end up having a separate SMDH tab?
-		if (!(d->headers_loaded & (Nintendo3DSPrivate::HEADER_NCSD | Nintendo3DSPrivate::HEADER_TMD))) {
-			// There will only be a single tab.
-			// Add the title ID and product code fields here.
-			// (Include the content type, if available.)
-			haveSeparateSMDHTab = false;
-			d->addTitleIdAndProductCodeFields(true);
+	if (RomFields::isTabSelected(tabMask, 0)) {
+		d->fields->setTabIndex(0);
+		if (warning) {
+			d->fields->addField_string(C_("RomData", "Warning"),
+				warning, RomFields::STRF_WARNING);
 		}
 
-		// Add the SMDH fields from the Nintendo3DS_SMDH object.
-		const RomFields *const smdh_fields = d->sbptr.smdh.data->fields();
-		assert(smdh_fields != nullptr);
-		if (smdh_fields) {
-			// Add the SMDH fields.
-			d->fields->addFields_romFields(smdh_fields, 0);
-		}
-	} else if (d->sbptr.srl.data) {
-		// DSiWare SRL.
-		const RomFields *const srl_fields = d->sbptr.srl.data->fields();
-		assert(srl_fields != nullptr);
-		if (srl_fields) {
-			d->fields->setTabName(0, C_("Nintendo3DS", "DSiWare"));
-
-			// Will we end up having a separate DSiWare tab?
-			if (!(d->headers_loaded & (Nintendo3DSPrivate::HEADER_NCSD | Nintendo3DSPrivate::HEADER_TMD))) {
+		// Load and parse the SMDH header.
+		if (d->headers_loaded & Nintendo3DSPrivate::HEADER_SMDH) {
+			if (!haveSeparateSMDHTab) {
 				// There will only be a single tab.
 				// Add the title ID and product code fields here.
 				// (Include the content type, if available.)
-				haveSeparateSMDHTab = false;
 				d->addTitleIdAndProductCodeFields(true);
 			}
 
-			// Do we have additional tabs?
-			// TODO: Combine "DSiWare" (tab 0) and "DSi" (tab 1)?
-			const int subtab_count = srl_fields->tabCount();
-			if (subtab_count > 1) {
-				for (int subtab = 1; subtab < subtab_count; subtab++) {
-					d->fields->setTabName(subtab, srl_fields->tabName(subtab));
-				}
+			// Add the SMDH fields from the Nintendo3DS_SMDH object.
+			const RomFields *const smdh_fields = d->sbptr.smdh.data->fields();
+			assert(smdh_fields != nullptr);
+			if (smdh_fields) {
+				// Add the SMDH fields.
+				d->fields->addFields_romFields(smdh_fields, 0);
+			}
+		} else if (srl_fields) {
+			// DSiWare SRL.
+			if (!haveSeparateSMDHTab) {
+				// There will only be a single tab.
+				// Add the title ID and product code fields here.
+				// (Include the content type, if available.)
+				d->addTitleIdAndProductCodeFields(true);
 			}
 
 			// Add the DSiWare fields.
 			d->fields->addFields_romFields(srl_fields, 0);
+		} else {
+			// Single tab.
+			// Add the title ID and product code fields here.
+			// (Include the content type, if available.)
+			d->addTitleIdAndProductCodeFields(true);
 		}
-	} else {
-		// Single tab.
-		// Add the title ID and product code fields here.
-		// (Include the content type, if available.)
-		haveSeparateSMDHTab = false;
-		d->addTitleIdAndProductCodeFields(true);
 	}
 
 	// Is the NCSD header loaded?
-	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_NCSD) {
+	if (ncsdTabIdx >= 0 && RomFields::isTabSelected(tabMask, ncsdTabIdx)) {
 		// Display the NCSD header.
+		d->fields->setTabIndex(ncsdTabIdx);
 		if (haveSeparateSMDHTab) {
-			d->fields->addTab("NCSD");
 			// Add the title ID and product code fields here.
 			// (Content type is listed in the NCSD partition table.)
 			d->addTitleIdAndProductCodeFields(false);
-		} else {
-			d->fields->setTabName(0, "NCSD");
 		}
 
 		if (!ncch) {
@@ -2291,16 +2361,14 @@ int Nintendo3DS::loadFieldData(void)
 	}
 
 	// Is the TMD header loaded?
-	if (d->headers_loaded & Nintendo3DSPrivate::HEADER_TMD) {
+	if (ciaTabIdx >= 0 && RomFields::isTabSelected(tabMask, ciaTabIdx)) {
 		// Display the TMD header.
 		// NOTE: This is usually for CIAs only.
+		d->fields->setTabIndex(ciaTabIdx);
 		if (haveSeparateSMDHTab) {
-			d->fields->addTab("CIA");
 			// Add the title ID and product code fields here.
 			// (Content type is listed in the CIA contents table.)
 			d->addTitleIdAndProductCodeFields(false);
-		} else {
-			d->fields->setTabName(0, "CIA");
 		}
 
 		// TODO: Add more fields?
@@ -2489,13 +2557,10 @@ int Nintendo3DS::loadFieldData(void)
 		d->fields->addField_listData(C_("Nintendo3DS", "Contents"), &params);
 	}
 
-	// Get the NCCH Extended Header.
-	const N3DS_NCCH_ExHeader_t *const ncch_exheader =
-		(ncch && ncch->isOpen() ? ncch->ncchExHeader() : nullptr);
-	if (ncch_exheader) {
+	if (exheaderTabIdx >= 0 && RomFields::isTabSelected(tabMask, exheaderTabIdx)) {
 		// Display the NCCH Extended Header.
 		// TODO: Add more fields?
-		d->fields->addTab("ExHeader");
+		d->fields->setTabIndex(exheaderTabIdx);
 
 		// Process name.
 		d->fields->addField_string(C_("Nintendo3DS", "Process Name"),
@@ -2599,15 +2664,18 @@ int Nintendo3DS::loadFieldData(void)
 		// TODO: Ideal CPU and affinity mask.
 		// TODO: core_version is probably specified for e.g. AGB.
 		// Indicate that somehow.
+	}
 
+	if (exheaderTabIdx >= 0 && RomFields::isTabSelected(tabMask, exheaderTabIdx + 1)) {
 		// Permissions. These are technically part of the
 		// ExHeader, but we're using a separate tab because
 		// there's a lot of them.
-		d->fields->addTab(C_("Nintendo3DS", "Permissions"));
+		d->fields->setTabIndex(exheaderTabIdx + 1);
 		d->addFields_permissions();
 	}
 
 	// Finished reading the field data.
+	d->fieldsTabsLoaded |= tabMask;
 	return static_cast<int>(d->fields->count());
 }
 
@@ -237,8 +237,10 @@ int Nintendo3DSFirm::loadFieldData(void)
 		// Firmware binary is 4 MB or less.
 		szFile = static_cast<unsigned int>(d->file->size());
 		firmBuf.reset(new uint8_t[szFile]);
+		d->file->setAccessHint(IRpFile::AH_SEQUENTIAL);
 		d->file->rewind();
 		size_t size = d->file->read(firmBuf.get(), szFile);
+		d->file->setAccessHint(IRpFile::AH_NORMAL);
 		if (size != szFile) {
 			// Error reading the firmware binary.
 			firmBuf.reset();
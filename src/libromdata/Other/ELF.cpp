@@ -110,6 +110,9 @@ class ELFPrivate : public LibRpBase::RomDataPrivate
 
 		// PT_DYNAMIC
 		hdr_info_t pt_dynamic;	// If addr == 0, not dynamic.
+		bool hasCheckedPtDynamic;	// Have we checked PT_DYNAMIC yet?
+		bool has_DT_FLAGS, has_DT_FLAGS_1;
+		uint32_t val_DT_FLAGS, val_DT_FLAGS_1;
 
 		// Section Header information.
 		bool hasCheckedSH;	// Have we checked section headers yet?
@@ -154,11 +157,22 @@ class ELFPrivate : public LibRpBase::RomDataPrivate
 		 */
 		int checkSectionHeaders(void);
 
+		/**
+		 * Check PT_DYNAMIC for relevant entries.
+		 * @return 0 if DT_FLAGS and/or DT_FLAGS_1 are present; non-zero if not.
+		 */
+		int checkPtDynamic(void);
+
 		/**
 		 * Add PT_DYNAMIC fields.
 		 * @return 0 on success; non-zero on error.
 		 */
 		int addPtDynamicFields(void);
+
+		/**
+		 * Add fields for the ELF header tab.
+		 */
+		void addFields_ELF(void);
 };
 
 /** ELFPrivate **/
@@ -169,6 +183,11 @@ ELFPrivate::ELFPrivate(ELF *q, IRpFile *file)
 	, hasCheckedPH(false)
 	, isPie(false)
 	, isWiiU(false)
+	, hasCheckedPtDynamic(false)
+	, has_DT_FLAGS(false)
+	, has_DT_FLAGS_1(false)
+	, val_DT_FLAGS(0)
+	, val_DT_FLAGS_1(0)
 	, hasCheckedSH(false)
 	, build_id_type(nullptr)
 {
@@ -605,11 +624,17 @@ int ELFPrivate::checkSectionHeaders(void)
 }
 
 /**
- * Add PT_DYNAMIC fields.
- * @return 0 on success; non-zero on error.
+ * Check PT_DYNAMIC for relevant entries.
+ * @return 0 if DT_FLAGS and/or DT_FLAGS_1 are present; non-zero if not.
  */
-int ELFPrivate::addPtDynamicFields(void)
+int ELFPrivate::checkPtDynamic(void)
 {
+	if (hasCheckedPtDynamic) {
+		// PT_DYNAMIC has already been checked.
+		return (has_DT_FLAGS || has_DT_FLAGS_1 ? 0 : -ENOENT);
+	}
+	hasCheckedPtDynamic = true;
+
 	if (isWiiU || pt_dynamic.addr == 0) {
 		// Not a dynamic object.
 		// (Wii U dynamic objects don't work the same way as
@@ -634,9 +659,6 @@ int ELFPrivate::addPtDynamicFields(void)
 
 	// Process headers.
 	// NOTE: Separate loops for 32-bit vs. 64-bit.
-	bool has_DT_FLAGS = false, has_DT_FLAGS_1 = false;
-	uint32_t val_DT_FLAGS = 0, val_DT_FLAGS_1 = 0;
-
 	// TODO: DT_RPATH/DT_RUNPATH
 	// Requires string table parsing too?
 	if (Elf_Header.primary.e_class == ELFCLASS64) {
@@ -678,13 +700,24 @@ int ELFPrivate::addPtDynamicFields(void)
 		}
 	}
 
-	if (!has_DT_FLAGS && !has_DT_FLAGS_1) {
+	// Relevant PT_DYNAMIC entries must be present.
+	return (has_DT_FLAGS || has_DT_FLAGS_1 ? 0 : -ENOENT);
+}
+
+/**
+ * Add PT_DYNAMIC fields.
+ * @return 0 on success; non-zero on error.
+ */
+int ELFPrivate::addPtDynamicFields(void)
+{
+	int ret = checkPtDynamic();
+	if (ret != 0) {
 		// No relevant PT_DYNAMIC entries.
-		return 0;
+		return ret;
 	}
 
 	// Add the PT_DYNAMIC tab.
-	fields->addTab("PT_DYNAMIC");
+	fields->setTabIndex(1);
 
 	if (has_DT_FLAGS) {
 		// DT_FLAGS
@@ -1069,12 +1102,20 @@ const char *const *ELF::supportedMimeTypes_static(void)
  * @return Number of fields read on success; negative POSIX error code on error.
  */
 int ELF::loadFieldData(void)
+{
+	return loadFieldTabs(RomFields::TAB_MASK_ALL);
+}
+
+/**
+ * Load field data for the specified tabs.
+ * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+ * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int ELF::loadFieldTabs(uint32_t tabMask)
 {
 	RP_D(ELF);
-	if (!d->fields->empty()) {
-		// Field data *has* been loaded...
-		return 0;
-	} else if (!d->file || !d->file->isOpen()) {
+	if (!d->file || !d->file->isOpen()) {
 		// File isn't open.
 		return -EBADF;
 	} else if (!d->isValid) {
@@ -1082,12 +1123,48 @@ int ELF::loadFieldData(void)
 		return -EIO;
 	}
 
-	// Primary ELF header.
-	const Elf_PrimaryEhdr *const primary = &d->Elf_Header.primary;
-	d->fields->reserve(12);	// Maximum of 12 fields. [3 for machine subtype] [TODO verify this]
+	// Don't load tabs that have already been loaded.
+	// loadFieldData() may be called after fields() loaded some tabs.
+	tabMask &= ~d->fieldsTabsLoaded;
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Field data *has* been loaded...
+		return 0;
+	}
 
+	// Tab layout:
+	// - 0: ELF header
+	// - 1: PT_DYNAMIC (only if relevant entries are present)
 	d->fields->reserveTabs(2);
 	d->fields->setTabName(0, "ELF");
+	if (d->checkPtDynamic() == 0) {
+		d->fields->setTabName(1, "PT_DYNAMIC");
+	}
+
+	if (RomFields::isTabSelected(tabMask, 0)) {
+		d->addFields_ELF();
+	}
+
+	if (RomFields::isTabSelected(tabMask, 1)) {
+		// If this is a dynamically-linked executable,
+		// print DT_FLAGS and DT_FLAGS_1.
+		// TODO: Print required libraries?
+		d->addPtDynamicFields();
+	}
+
+	// Finished reading the field data.
+	d->fieldsTabsLoaded |= tabMask;
+	return static_cast<int>(d->fields->count());
+}
+
+/**
+ * Add fields for the ELF header tab.
+ */
+void ELFPrivate::addFields_ELF(void)
+{
+	// Primary ELF header.
+	const Elf_PrimaryEhdr *const primary = &Elf_Header.primary;
+	fields->reserve(12);	// Maximum of 12 fields. [3 for machine subtype] [TODO verify this]
+	fields->setTabIndex(0);
 
 	// NOTE: Executable type is used as File Type.
 
@@ -1099,17 +1176,17 @@ int ELF::loadFieldData(void)
 		NOP_C_("RomData|ExecType", "64-bit Big-Endian"),
 	};
 	const char *const format_title = C_("ELF", "Format");
-	if (d->elfFormat > ELFPrivate::ELF_FORMAT_UNKNOWN &&
-	    d->elfFormat < ARRAY_SIZE(exec_type_tbl))
+	if (elfFormat > ELFPrivate::ELF_FORMAT_UNKNOWN &&
+	    elfFormat < ARRAY_SIZE(exec_type_tbl))
 	{
-		d->fields->addField_string(format_title,
-			dpgettext_expr(RP_I18N_DOMAIN, "RomData|ExecType", exec_type_tbl[d->elfFormat]));
+		fields->addField_string(format_title,
+			dpgettext_expr(RP_I18N_DOMAIN, "RomData|ExecType", exec_type_tbl[elfFormat]));
 	}
 	else
 	{
 		// TODO: Show individual values.
 		// NOTE: This shouldn't happen...
-		d->fields->addField_string(format_title,
+		fields->addField_string(format_title,
 			C_("RomData", "Unknown"));
 	}
 
@@ -1117,9 +1194,9 @@ int ELF::loadFieldData(void)
 	const char *const cpu_title = C_("ELF", "CPU");
 	const char *const cpu = ELFData::lookup_cpu(primary->e_machine);
 	if (cpu) {
-		d->fields->addField_string(cpu_title, cpu);
+		fields->addField_string(cpu_title, cpu);
 	} else {
-		d->fields->addField_string(cpu_title,
+		fields->addField_string(cpu_title,
 			rp_sprintf(C_("ELF", "Unknown (0x%04X)"), primary->e_machine));
 	}
 
@@ -1131,8 +1208,8 @@ int ELF::loadFieldData(void)
 	// - ppc64.h, rl78.h, rx.h, s390.h, score.h, sparc.h, tic6x.h, v850.h,
 	// - vax.h, visium.h, xgate.h, xtensa.h
 	Elf32_Word e_flags = (primary->e_class == ELFCLASS64
-		? d->Elf_Header.elf64.e_flags
-		: d->Elf_Header.elf32.e_flags);
+		? Elf_Header.elf64.e_flags
+		: Elf_Header.elf32.e_flags);
 	switch (primary->e_machine) {
 		case EM_68K: {
 			// binutils: include/elf/m68k.h
@@ -1158,7 +1235,7 @@ int ELF::loadFieldData(void)
 			}
 
 			if (m68k_insn) {
-				d->fields->addField_string(C_("ELF", "Instruction Set"), m68k_insn);
+				fields->addField_string(C_("ELF", "Instruction Set"), m68k_insn);
 			}
 			break;
 		}
@@ -1186,7 +1263,7 @@ int ELF::loadFieldData(void)
 				NOP_C_("ELF|SPARC_MM", "Relaxed Memory Ordering"),
 				NOP_C_("ELF|SPARC_MM", "Invalid"),
 			};
-			d->fields->addField_string(C_("ELF", "Memory Ordering"),
+			fields->addField_string(C_("ELF", "Memory Ordering"),
 				dpgettext_expr(RP_I18N_DOMAIN, "ELF|SPARC_MM", sparc_mm[e_flags & 3]));
 
 			// SPARC CPU flags. (rshifted by 8)
@@ -1204,7 +1281,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_sparc_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|SPARCFlags", sparc_flags_names, ARRAY_SIZE(sparc_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_sparc_flags_names, 4, (e_flags >> 8));
 			break;
 		}
@@ -1213,7 +1290,7 @@ int ELF::loadFieldData(void)
 		case EM_MIPS_RS3_LE: {
 			// 32-bit: O32 vs. N32
 			if (primary->e_class == ELFCLASS32) {
-				d->fields->addField_string(C_("ELF", "MIPS ABI"),
+				fields->addField_string(C_("ELF", "MIPS ABI"),
 					(e_flags & 0x20) ? "N32" : "O32");
 			}
 
@@ -1226,9 +1303,9 @@ int ELF::loadFieldData(void)
 			const unsigned int level = (e_flags >> 28);
 			const char *const cpu_level_title = C_("ELF", "CPU Level");
 			if (level < ARRAY_SIZE(mips_levels)) {
-				d->fields->addField_string(cpu_level_title, mips_levels[level]);
+				fields->addField_string(cpu_level_title, mips_levels[level]);
 			} else {
-				d->fields->addField_string(cpu_level_title,
+				fields->addField_string(cpu_level_title,
 					rp_sprintf(C_("RomData", "Unknown (0x%02X)"), level));
 			}
 
@@ -1250,7 +1327,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_mips_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|MIPSFlags", mips_flags_names, ARRAY_SIZE(mips_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_mips_flags_names, 4, mips_cpu_flags);
 			break;
 		}
@@ -1276,7 +1353,7 @@ int ELF::loadFieldData(void)
 			if (e_flags & 0x0008) {
 				parisc_version += " (LP64)";
 			}
-			d->fields->addField_string(C_("ELF", "PA-RISC Version"), parisc_version);
+			fields->addField_string(C_("ELF", "PA-RISC Version"), parisc_version);
 
 			// PA-RISC CPU flags.
 			static const char *const parisc_flags_names[] = {
@@ -1291,7 +1368,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_parisc_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|PARISCFlags", parisc_flags_names, ARRAY_SIZE(parisc_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_parisc_flags_names, 4, ((e_flags >> 16) & 0x7F));
 			break;
 		}
@@ -1310,7 +1387,7 @@ int ELF::loadFieldData(void)
 			if (e_flags & 0x00400000) {
 				arm_eabi += " LE8";
 			}
-			d->fields->addField_string(C_("ELF", "ARM EABI"), arm_eabi);
+			fields->addField_string(C_("ELF", "ARM EABI"), arm_eabi);
 
 			// ARM CPU flags.
 			// NOTE: Most of these are deprecated. (pre-EABI)
@@ -1330,7 +1407,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_arm_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|ARMFlags", arm_flags_names, ARRAY_SIZE(arm_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_arm_flags_names, 4, (e_flags & 0xFFF));
 			break;
 		}
@@ -1347,7 +1424,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_alpha_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|AlphaFlags", alpha_flags_names, ARRAY_SIZE(alpha_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_alpha_flags_names, 2, (e_flags & 0x03));
 			break;
 		}
@@ -1374,7 +1451,7 @@ int ELF::loadFieldData(void)
 				s_cpu_subtype = superh_cpu_subtype_tbl[cpu_subtype];
 			}
 			if (s_cpu_subtype) {
-				d->fields->addField_string(C_("ELF", "CPU Subtype"), s_cpu_subtype);
+				fields->addField_string(C_("ELF", "CPU Subtype"), s_cpu_subtype);
 			}
 
 			// SuperH CPU flags. (rshifted by 8)
@@ -1387,7 +1464,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_superh_flags_names = RomFields::strArrayToVector(
 				superh_flags_names, ARRAY_SIZE(superh_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_superh_flags_names, 2, (e_flags >> 8));
 			break;
 		}
@@ -1407,13 +1484,13 @@ int ELF::loadFieldData(void)
 				s_cpu_subtype = arc_cpu_subtypes[cpu_subtype];
 			}
 			if (s_cpu_subtype) {
-				d->fields->addField_string(C_("ELF", "CPU Subtype"), s_cpu_subtype);
+				fields->addField_string(C_("ELF", "CPU Subtype"), s_cpu_subtype);
 			}
 
 			// ARC Linux specific ABIs.
 			const uint8_t arc_linux_osabi = (e_flags >> 8) & 0x0F;
 			if (arc_linux_osabi != 1 && arc_linux_osabi <= 4) {
-				d->fields->addField_string(C_("ELF", "Linux OSABI"),
+				fields->addField_string(C_("ELF", "Linux OSABI"),
 					rp_sprintf("ARC Linux OSABI v%u", arc_linux_osabi));
 			}
 
@@ -1424,7 +1501,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_arc_flags_names = RomFields::strArrayToVector(
 				arc_flags_names, ARRAY_SIZE(arc_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_arc_flags_names, 1, ((e_flags >> 8) & 1));
 			break;
 		}
@@ -1482,7 +1559,7 @@ int ELF::loadFieldData(void)
 			}
 
 			if (!s_cf_isa.empty()) {
-				d->fields->addField_string(C_("ELF", "ColdFire ISA"), s_cf_isa);
+				fields->addField_string(C_("ELF", "ColdFire ISA"), s_cf_isa);
 			}
 			break;
 		}
@@ -1507,7 +1584,7 @@ int ELF::loadFieldData(void)
 			}
 
 			if (s_avr_subtype[0] != '\0') {
-				d->fields->addField_string(C_("ELF", "CPU Subtype"), s_avr_subtype);
+				fields->addField_string(C_("ELF", "CPU Subtype"), s_avr_subtype);
 			}
 			break;
 		}
@@ -1520,7 +1597,7 @@ int ELF::loadFieldData(void)
 			};
 			const char *const m32r_insn_set = m32r_insn_set_tbl[(e_flags >> 28) & 0x03];
 			if (m32r_insn_set) {
-				d->fields->addField_string(C_("ELF", "Instruction Set"), m32r_insn_set);
+				fields->addField_string(C_("ELF", "Instruction Set"), m32r_insn_set);
 			}
 
 			// M32R new instructions field.
@@ -1530,7 +1607,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_m32r_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|M32RFlags", m32r_flags_names, ARRAY_SIZE(m32r_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "M32R New Insns"),
+			fields->addField_bitfield(C_("ELF", "M32R New Insns"),
 				v_m32r_flags_names, 4, ((e_flags >> 16) & 0x0FFF));
 
 			// TODO: 4-bit m32r ignore to check field? (0x0000000F)
@@ -1553,7 +1630,7 @@ int ELF::loadFieldData(void)
 			}
 
 			if (s_msp430_subtype[0] != '\0') {
-				d->fields->addField_string(C_("ELF", "CPU Subtype"), s_msp430_subtype);
+				fields->addField_string(C_("ELF", "CPU Subtype"), s_msp430_subtype);
 			}
 			break;
 		}
@@ -1571,7 +1648,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_blackfin_flags_names = RomFields::strArrayToVector_i18n(
 				"ELF|BlackfinFlags", blackfin_flags_names, ARRAY_SIZE(blackfin_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_blackfin_flags_names, 2, (e_flags & 0x33));
 			break;
 		}
@@ -1594,7 +1671,7 @@ int ELF::loadFieldData(void)
 					break;
 			}
 			if (m32c_subtype) {
-				d->fields->addField_string(C_("ELF", "CPU Subtype"), m32c_subtype);
+				fields->addField_string(C_("ELF", "CPU Subtype"), m32c_subtype);
 			}
 			break;
 		}
@@ -1614,7 +1691,7 @@ int ELF::loadFieldData(void)
 				z80_insn_set = "eZ80 (ADL mode)";
 			}
 			if (z80_insn_set) {
-				d->fields->addField_string(C_("ELF", "Instruction Set"), z80_insn_set);
+				fields->addField_string(C_("ELF", "Instruction Set"), z80_insn_set);
 			}
 			break;
 		}
@@ -1629,7 +1706,7 @@ int ELF::loadFieldData(void)
 				NOP_C_("ELF|RISCVFPABI", "Double-Float"),
 				NOP_C_("ELF|RISCVFPABI", "Quad-Float"),
 			};
-			d->fields->addField_string(C_("ELF", "Floating-Point ABI"),
+			fields->addField_string(C_("ELF", "Floating-Point ABI"),
 				dpgettext_expr(RP_I18N_DOMAIN, "ELF|RISCVFPABI", riscv_fpabi_tbl[((e_flags & 0x0006) >> 1)]));
 
 			// RISC-V CPU flags.
@@ -1639,7 +1716,7 @@ int ELF::loadFieldData(void)
 			};
 			vector<string> *const v_riscv_flags_names = RomFields::strArrayToVector(
 				riscv_flags_names, ARRAY_SIZE(riscv_flags_names));
-			d->fields->addField_bitfield(C_("ELF", "CPU Flags"),
+			fields->addField_bitfield(C_("ELF", "CPU Flags"),
 				v_riscv_flags_names, 2, (e_flags & 0x0F));
 			break;
 		}
@@ -1653,75 +1730,65 @@ int ELF::loadFieldData(void)
 	const char *const osabi_title = C_("ELF", "OS ABI");
 	const char *const osabi = ELFData::lookup_osabi(primary->e_osabi);
 	if (osabi) {
-		d->fields->addField_string(osabi_title, osabi);
+		fields->addField_string(osabi_title, osabi);
 	} else {
-		d->fields->addField_string(osabi_title,
+		fields->addField_string(osabi_title,
 			rp_sprintf(C_("RomData", "Unknown (%u)"), primary->e_osabi));
 	}
 
 	// ABI version.
-	if (!d->isWiiU) {
-		d->fields->addField_string_numeric(C_("ELF", "ABI Version"),
+	if (!isWiiU) {
+		fields->addField_string_numeric(C_("ELF", "ABI Version"),
 			primary->e_osabiversion);
 	}
 
 	// Linkage. (Executables only)
-	if (d->fileType == FTYPE_EXECUTABLE) {
-		d->fields->addField_string(C_("ELF", "Linkage"),
-			d->pt_dynamic.addr != 0
+	if (fileType == RomData::FTYPE_EXECUTABLE) {
+		fields->addField_string(C_("ELF", "Linkage"),
+			pt_dynamic.addr != 0
 				? C_("ELF|Linkage", "Dynamic")
 				: C_("ELF|Linkage", "Static"));
 	}
 
 	// Interpreter.
-	if (!d->interpreter.empty()) {
-		d->fields->addField_string(C_("ELF", "Interpreter"), d->interpreter);
+	if (!interpreter.empty()) {
+		fields->addField_string(C_("ELF", "Interpreter"), interpreter);
 	}
 
 	// Operating system.
-	if (!d->osVersion.empty()) {
-		d->fields->addField_string(C_("ELF", "OS Version"), d->osVersion);
+	if (!osVersion.empty()) {
+		fields->addField_string(C_("ELF", "OS Version"), osVersion);
 	}
 
 	// Entry point.
 	// Also indicates PIE.
 	// NOTE: Formatting using 8 digits, since 64-bit executables
 	// usually have entry points within the first 4 GB.
-	if (d->fileType == FTYPE_EXECUTABLE) {
+	if (fileType == RomData::FTYPE_EXECUTABLE) {
 		string entry_point;
 		if (primary->e_class == ELFCLASS64) {
-			entry_point = rp_sprintf("0x%08" PRIX64, d->Elf_Header.elf64.e_entry);
+			entry_point = rp_sprintf("0x%08" PRIX64, Elf_Header.elf64.e_entry);
 		} else {
-			entry_point = rp_sprintf("0x%08X", d->Elf_Header.elf32.e_entry);
+			entry_point = rp_sprintf("0x%08X", Elf_Header.elf32.e_entry);
 		}
-		if (d->isPie) {
+		if (isPie) {
 			// tr: Entry point, then "Position-Independent".
 			entry_point = rp_sprintf(C_("ELF", "%s (Position-Independent)"),
 				entry_point.c_str());
 		}
-		d->fields->addField_string(C_("ELF", "Entry Point"), entry_point);
+		fields->addField_string(C_("ELF", "Entry Point"), entry_point);
 	}
 
 	// Build ID.
-	if (!d->build_id.empty()) {
+	if (!build_id.empty()) {
 		// TODO: Put the build ID type in the field itself.
 		// Using field name for now.
-		const string fieldName = rp_sprintf("BuildID[%s]", (d->build_id_type ? d->build_id_type : "unknown"));
-		d->fields->addField_string_hexdump(fieldName.c_str(),
-			d->build_id.data(), d->build_id.size(),
+		const string fieldName = rp_sprintf("BuildID[%s]", (build_id_type ? build_id_type : "unknown"));
+		fields->addField_string_hexdump(fieldName.c_str(),
+			build_id.data(), build_id.size(),
 			RomFields::STRF_HEX_LOWER | RomFields::STRF_HEXDUMP_NO_SPACES);
 	}
 
-	// If this is a dynamically-linked executable,
-	// print DT_FLAGS and DT_FLAGS_1.
-	// TODO: Print required libraries?
-	// Sanity check: Maximum of 1 MB.
-	if (!d->isWiiU && d->pt_dynamic.addr != 0) {
-		d->addPtDynamicFields();
-	}
-
-	// Finished reading the field data.
-	return static_cast<int>(d->fields->count());
 }
 
 }
@@ -14,6 +14,7 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(ELF)
+ROMDATA_DECL_FIELDTABS()
 ROMDATA_DECL_END()
 
 }
@@ -806,12 +806,20 @@ const char *const *EXE::supportedMimeTypes_static(void)
  * @return Number of fields read on success; negative POSIX error code on error.
  */
 int EXE::loadFieldData(void)
+{
+	return loadFieldTabs(RomFields::TAB_MASK_ALL);
+}
+
+/**
+ * Load field data for the specified tabs.
+ * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+ * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int EXE::loadFieldTabs(uint32_t tabMask)
 {
 	RP_D(EXE);
-	if (!d->fields->empty()) {
-		// Field data *has* been loaded...
-		return 0;
-	} else if (!d->file || !d->file->isOpen()) {
+	if (!d->file || !d->file->isOpen()) {
 		// File isn't open.
 		return -EBADF;
 	} else if (!d->isValid || d->exeType < 0) {
@@ -819,6 +827,22 @@ int EXE::loadFieldData(void)
 		return -EIO;
 	}
 
+	const bool isPE = (d->exeType == EXEPrivate::EXE_TYPE_PE ||
+	                   d->exeType == EXEPrivate::EXE_TYPE_PE32PLUS);
+	if (!isPE) {
+		// Only PE executables have a fixed tab layout.
+		// Other types are always loaded all at once.
+		tabMask = RomFields::TAB_MASK_ALL;
+	}
+
+	// Don't load tabs that have already been loaded.
+	// loadFieldData() may be called after fields() loaded some tabs.
+	tabMask &= ~d->fieldsTabsLoaded;
+	if (tabMask == RomFields::TAB_MASK_NONE) {
+		// Field data *has* been loaded...
+		return 0;
+	}
+
 	// Maximum number of fields:
 	// - NE: 6
 	// - PE: 8
@@ -826,22 +850,25 @@ int EXE::loadFieldData(void)
 	//   - PE Manifest: +12
 	d->fields->reserve(26);
 
-	// Executable type.
-	// NOTE: Not translatable.
-	static const char *const exeTypes[EXEPrivate::EXE_TYPE_LAST] = {
-		"MS-DOS Executable",		// EXE_TYPE_MZ
-		"16-bit New Executable",	// EXE_TYPE_NE
-		"Mixed-Mode Linear Executable",	// EXE_TYPE_LE
-		"Windows/386 Kernel",		// EXE_TYPE_W3
-		"32-bit Linear Executable",	// EXE_TYPE_LX
-		"32-bit Portable Executable",	// EXE_TYPE_PE
-		"64-bit Portable Executable",	// EXE_TYPE_PE32PLUS
-	};
-	const char *const type_title = C_("EXE", "Type");
-	if (d->exeType >= EXEPrivate::EXE_TYPE_MZ && d->exeType < EXEPrivate::EXE_TYPE_LAST) {
-		d->fields->addField_string(type_title, exeTypes[d->exeType]);
-	} else {
-		d->fields->addField_string(type_title, C_("EXE", "Unknown"));
+	if (RomFields::isTabSelected(tabMask, 0)) {
+		// Executable type.
+		// NOTE: Not translatable.
+		static const char *const exeTypes[EXEPrivate::EXE_TYPE_LAST] = {
+			"MS-DOS Executable",		// EXE_TYPE_MZ
+			"16-bit New Executable",	// EXE_TYPE_NE
+			"Mixed-Mode Linear Executable",	// EXE_TYPE_LE
+			"Windows/386 Kernel",		// EXE_TYPE_W3
+			"32-bit Linear Executable",	// EXE_TYPE_LX
+			"32-bit Portable Executable",	// EXE_TYPE_PE
+			"64-bit Portable Executable",	// EXE_TYPE_PE32PLUS
+		};
+		const char *const type_title = C_("EXE", "Type");
+		d->fields->setTabIndex(0);
+		if (d->exeType >= EXEPrivate::EXE_TYPE_MZ && d->exeType < EXEPrivate::EXE_TYPE_LAST) {
+			d->fields->addField_string(type_title, exeTypes[d->exeType]);
+		} else {
+			d->fields->addField_string(type_title, C_("EXE", "Unknown"));
+		}
 	}
 
 	switch (d->exeType) {
@@ -860,7 +887,7 @@ int EXE::loadFieldData(void)
 
 		case EXEPrivate::EXE_TYPE_PE:
 		case EXEPrivate::EXE_TYPE_PE32PLUS:
-			d->addFields_PE();
+			d->addFields_PE(tabMask);
 			break;
 
 		default:
@@ -869,13 +896,21 @@ int EXE::loadFieldData(void)
 	}
 
 	// Add MZ tab for non-MZ executables
-	if (d->exeType != EXEPrivate::EXE_TYPE_MZ) {
+	if (isPE) {
+		// PE tab layout: PE, Version, Manifest, MZ
+		d->fields->setTabName(EXEPrivate::PE_TAB_MZ, "MZ");
+		if (RomFields::isTabSelected(tabMask, EXEPrivate::PE_TAB_MZ)) {
+			d->fields->setTabIndex(EXEPrivate::PE_TAB_MZ);
+			d->addFields_MZ();
+		}
+	} else if (d->exeType != EXEPrivate::EXE_TYPE_MZ) {
 		// NOTE: This doesn't actually create a separate tab for non-implemented types.
 		d->fields->addTab("MZ");
 		d->addFields_MZ();
 	}
 
 	// Finished reading the field data.
+	d->fieldsTabsLoaded |= tabMask;
 	return static_cast<int>(d->fields->count());
 }
 
@@ -35,6 +35,49 @@ namespace LibRomData {
 extern int DelayLoad_test_TinyXML2(void);
 #endif /* defined(_MSC_VER) && defined(XML_IS_DLL) */
 
+// Manifest resource IDs
+struct ManifestResourceID_t {
+	uint16_t id;
+	const char *name;
+};
+
+static const ManifestResourceID_t manifest_resource_ids[] = {
+	{CREATEPROCESS_MANIFEST_RESOURCE_ID, "CreateProcess"},
+	{ISOLATIONAWARE_MANIFEST_RESOURCE_ID, "Isolation-Aware"},
+	{ISOLATIONAWARE_NOSTATICIMPORT_MANIFEST_RESOURCE_ID, "Isolation-Aware, No Static Import"},
+
+	// Windows XP's explorer.exe uses resource ID 123.
+	// Reference: https://docs.microsoft.com/en-us/windows/desktop/Controls/cookbook-overview
+	{XP_VISUAL_STYLE_MANIFEST_RESOURCE_ID, "Visual Style"},
+};
+
+/**
+ * Open the Win32 manifest resource.
+ * rsrcReader must have been loaded by loadPEResourceTypes().
+ * @param pIdIdx	[out,opt] Index of the manifest resource ID.
+ * @return Manifest resource, or nullptr if not found. (Must be unref()'d.)
+ */
+IRpFile *EXEPrivate::openPEManifest(unsigned int *pIdIdx)
+{
+	assert(rsrcReader != nullptr);
+	if (!rsrcReader)
+		return nullptr;
+
+	// Search for a PE manifest resource.
+	for (unsigned int id_idx = 0; id_idx < ARRAY_SIZE(manifest_resource_ids); id_idx++) {
+		IRpFile *const f_manifest = rsrcReader->open(RT_MANIFEST, manifest_resource_ids[id_idx].id, -1);
+		if (f_manifest != nullptr) {
+			if (pIdIdx) {
+				*pIdIdx = id_idx;
+			}
+			return f_manifest;
+		}
+	}
+
+	// No manifest resource.
+	return nullptr;
+}
+
 /**
  * Add fields from the Win32 manifest resource.
  * @return 0 on success; negative POSIX error code on error.
@@ -51,31 +94,9 @@ int EXEPrivate::addFields_PE_Manifest(void)
 	}
 #endif /* defined(_MSC_VER) && defined(XML_IS_DLL) */
 
-	// Manifest resource IDs
-	struct ManifestResourceID_t {
-		uint16_t id;
-		const char *name;
-	};
-
-	static const ManifestResourceID_t resource_ids[] = {
-		{CREATEPROCESS_MANIFEST_RESOURCE_ID, "CreateProcess"},
-		{ISOLATIONAWARE_MANIFEST_RESOURCE_ID, "Isolation-Aware"},
-		{ISOLATIONAWARE_NOSTATICIMPORT_MANIFEST_RESOURCE_ID, "Isolation-Aware, No Static Import"},
-
-		// Windows XP's explorer.exe uses resource ID 123.
-		// Reference: https://docs.microsoft.com/en-us/windows/desktop/Controls/cookbook-overview
-		{XP_VISUAL_STYLE_MANIFEST_RESOURCE_ID, "Visual Style"},
-	};
-
 	// Search for a PE manifest resource.
-	IRpFile *f_manifest = nullptr;
-	unsigned int id_idx;
-	for (id_idx = 0; id_idx < ARRAY_SIZE(resource_ids); id_idx++) {
-		f_manifest = rsrcReader->open(RT_MANIFEST, resource_ids[id_idx].id, -1);
-		if (f_manifest != nullptr)
-			break;
-	}
-
+	unsigned int id_idx = 0;
+	IRpFile *const f_manifest = openPEManifest(&id_idx);
 	if (!f_manifest) {
 		// No manifest resource.
 		return -ENOENT;
@@ -136,10 +157,11 @@ int EXEPrivate::addFields_PE_Manifest(void)
 	}
 
 	// Add the manifest fields.
-	fields->addTab(C_("EXE", "Manifest"));
+	fields->setTabName(PE_TAB_MANIFEST, C_("EXE", "Manifest"));
+	fields->setTabIndex(PE_TAB_MANIFEST);
 
 	// Manifest ID.
-	fields->addField_string(C_("EXE|Manifest", "Manifest ID"), resource_ids[id_idx].name);
+	fields->addField_string(C_("EXE|Manifest", "Manifest ID"), manifest_resource_ids[id_idx].name);
 
 	#define FIRST_CHILD_ELEMENT_NS(var, parent_elem, child_elem_name, namespace) \
 		const XMLElement *var = parent_elem->FirstChildElement(child_elem_name); \
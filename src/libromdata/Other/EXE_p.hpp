@@ -49,6 +49,17 @@ class EXEPrivate : public LibRpBase::RomDataPrivate
 		};
 		int exeType;
 
+		// PE tab layout.
+		// Tab indexes are fixed so tabs can be loaded separately.
+		enum PE_Tab {
+			PE_TAB_PE = 0,		// PE header
+			PE_TAB_VERSION = 1,	// VS_VERSION_INFO
+			PE_TAB_MANIFEST = 2,	// Win32 manifest
+			PE_TAB_MZ = 3,		// DOS MZ header
+
+			PE_TAB_COUNT
+		};
+
 	public:
 		// DOS MZ header.
 		IMAGE_DOS_HEADER mz;
@@ -169,10 +180,19 @@ class EXEPrivate : public LibRpBase::RomDataPrivate
 
 		/**
 		 * Add fields for PE and PE32+ executables.
+		 * @param tabMask RomFields::TabMask of tabs to load. (See PE_Tab.)
 		 */
-		void addFields_PE(void);
+		void addFields_PE(uint32_t tabMask);
 
 #ifdef ENABLE_XML
+		/**
+		 * Open the Win32 manifest resource.
+		 * rsrcReader must have been loaded by loadPEResourceTypes().
+		 * @param pIdIdx	[out,opt] Index of the manifest resource ID.
+		 * @return Manifest resource, or nullptr if not found. (Must be unref()'d.)
+		 */
+		LibRpBase::IRpFile *openPEManifest(unsigned int *pIdIdx = nullptr);
+
 		/**
 		 * Add fields from the Win32 manifest resource.
 		 * @return 0 on success; negative POSIX error code on error.
@@ -115,9 +115,9 @@ int RpTextureWrapper::isRomSupported_static(const DetectInfo *info)
 		return -1;
 	}
 
-	// TODO: FileFormatFactory::isTextureSupported()
-	// For now, delegate to FileFormatFactory::create().
-	return 0;
+	// Check the magic number using FileFormatFactory.
+	// NOTE: FileFormatFactory::create() does the actual validation.
+	return (FileFormatFactory::isTextureSupported(info->header.pData, info->header.size) ? 0 : -1);
 }
 
 /**
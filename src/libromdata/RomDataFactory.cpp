@@ -11,13 +11,20 @@
 #include "libromdata/config.libromdata.h"
 
 #include "RomDataFactory.hpp"
+#include "DetectCache.hpp"
+#include "CachedRomData.hpp"
 
 // librpbase
 #include "librpbase/file/RelatedFile.hpp"
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/CachedRpFile.hpp"
 using namespace LibRpBase;
 
 // librpthreads
 #include "librpthreads/pthread_once.h"
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
 
 // librptexture
 #include "librptexture/FileFormatFactory.hpp"
@@ -25,6 +32,7 @@ using LibRpTexture::FileFormatFactory;
 
 // C++ STL classes.
 using std::string;
+using std::unique_ptr;
 using std::unordered_map;
 using std::unordered_set;
 using std::vector;
@@ -123,6 +131,15 @@ class RomDataFactoryPrivate
 			// appear at specific addresses.
 			uint32_t address;
 			uint32_t size;	// Contains magic number for fast 32-bit magic checking.
+
+			// Class name. (Same as RomData::className().)
+			const char *className;
+
+			// Generic file type and system name, for identify().
+			// These don't depend on the file, so they may be less
+			// specific than RomData::fileType() and systemName().
+			RomData::FileType fileType;
+			const char *systemName;	// nullptr if it depends on the file
 		};
 
 		/**
@@ -135,19 +152,19 @@ class RomDataFactoryPrivate
 			return new klass(file);
 		}
 
-#define GetRomDataFns(sys, attrs) \
+#define GetRomDataFns(sys, attrs, ftype, sysName) \
 	{sys::isRomSupported_static, \
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
-	 attrs, 0, 0}
+	 attrs, 0, 0, #sys, RomData::FTYPE_##ftype, sysName}
 
-#define GetRomDataFns_addr(sys, attrs, address, size) \
+#define GetRomDataFns_addr(sys, attrs, address, size, ftype, sysName) \
 	{sys::isRomSupported_static, \
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
-	 attrs, address, size}
+	 attrs, address, size, #sys, RomData::FTYPE_##ftype, sysName}
 
 		// RomData subclasses that use a header at 0 and
 		// definitely have a 32-bit magic number in the header.
@@ -168,6 +185,97 @@ class RomDataFactoryPrivate
 		// in each function.
 		static const RomDataFns *const romDataFns_tbl[];
 
+		// RomData subclasses that are created by special cases
+		// in create_int(). Only used for detection cache lookups.
+		static const RomDataFns romDataFns_special[];
+
+		/**
+		 * Find a RomData subclass by class name.
+		 * @param className Class name.
+		 * @return RomDataFns, or nullptr if not found.
+		 */
+		static const RomDataFns *findRomDataFns(const string &className);
+
+		/**
+		 * Set identification info for a RomData subclass.
+		 * @param pIdInfo	[out,opt] Identification info.
+		 * @param fns		[in] RomDataFns, or nullptr if the file isn't supported.
+		 * @param romType	[in] Class-specific system ID from isRomSupported_static().
+		 * @param attrs		[in] RomDataAttr bitfield.
+		 */
+		static void setIdInfo(RomDataFactory::IdentifyInfo *pIdInfo,
+			const RomDataFns *fns, int romType, unsigned int attrs);
+
+		/**
+		 * Get a file's identity for the detection cache.
+		 * @param file		[in] ROM file.
+		 * @param pFileId	[out] File identity.
+		 * @return True if the detection cache can be used for this file; false if not.
+		 */
+		static bool getDetectCacheFileId(IRpFile *file, FileSystem::FileId *pFileId);
+
+		/**
+		 * Wrap a file in a CachedRpFile if it would benefit from it.
+		 * Only regular files opened using RpFile are wrapped.
+		 * @param file ROM file.
+		 * @return CachedRpFile, or file->ref() if the file isn't wrapped. (Caller must unref() it.)
+		 */
+		static IRpFile *openCachedFile(IRpFile *file);
+
+		// Maximum number of CachedRpFile blocks to keep
+		// after the RomData subclass has been created.
+		static const unsigned int CACHED_FILE_BLOCKS_AFTER_DETECT = 2;
+
+		/**
+		 * Create a RomData subclass for the specified ROM file,
+		 * using the detection cache if possible.
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported.
+		 */
+		static RomData *create_detectCache(IRpFile *file, unsigned int attrs);
+
+		// Magic number dispatch index for romDataFns_magic[].
+		// Sorted by key, then by romDataFns_magic[] index.
+		// - key: (address << 32) | magic
+		// - idx: Index in romDataFns_magic[].
+		struct MagicIndexEntry {
+			uint64_t key;
+			unsigned int idx;
+
+			inline bool operator<(const MagicIndexEntry &other) const
+			{
+				return (key < other.key) ||
+				       (key == other.key && idx < other.idx);
+			}
+		};
+		static vector<MagicIndexEntry> vec_magicIndex;
+		// Distinct magic number addresses in romDataFns_magic[].
+		static vector<uint32_t> vec_magicAddrs;
+		static pthread_once_t once_magicIndex;
+
+		/**
+		 * Initialize the magic number dispatch index.
+		 *
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void init_magicIndex(void);
+
+		/**
+		 * Look up RomData subclasses with a matching magic number.
+		 *
+		 * Candidates are returned in romDataFns_magic[] order,
+		 * so detection priority is the same as a linear scan.
+		 *
+		 * @param header	[in] Header data. (starting at address 0)
+		 * @param size		[in] Size of header data.
+		 * @param pIdx		[out] Array of romDataFns_magic[] indexes.
+		 * @param maxIdx	[in] Maximum number of indexes.
+		 * @return Number of matching indexes.
+		 */
+		static unsigned int lookupMagic(const uint8_t *header, uint32_t size,
+			unsigned int *pIdx, unsigned int maxIdx);
+
 		/**
 		 * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
 		 * @param file One opened file in the .VMI+.VMS pair.
@@ -211,9 +319,86 @@ class RomDataFactoryPrivate
 		 * RomData subclasses support it, an ISO object will be returned.
 		 *
 		 * @param file ISO-9660 disc image
-		 * @return Game-specific RomData subclass, or nullptr if none are supported.
+		 * @param pIdInfo [out,opt] If not nullptr, set to the identification info for game-specific subclasses. (Not changed otherwise.)
+		 * @param construct If false, only identify the file; don't create a RomData subclass.
+		 * @return Game-specific RomData subclass, or nullptr if none are supported or construct is false.
+		 */
+		static RomData *checkISO(IRpFile *file,
+			RomDataFactory::IdentifyInfo *pIdInfo, bool construct);
+
+		/**
+		 * Create a RomData subclass for the specified ROM file,
+		 * or identify the RomData subclass without creating it.
+		 *
+		 * If construct is true, this works like RomDataFactory::create().
+		 * Otherwise, the RomData subclass is not created.
+		 *
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @param pIdInfo [out,opt] Identification info. (className is nullptr if the ROM isn't supported.)
+		 * @param construct If false, only identify the file; don't create a RomData subclass.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported or construct is false.
+		 */
+		static RomData *create_int(IRpFile *file, unsigned int attrs,
+			RomDataFactory::IdentifyInfo *pIdInfo, bool construct);
+
+	public:
+		/**
+		 * createBatch() job information.
+		 * Shared by all worker threads.
 		 */
-		static RomData *checkISO(IRpFile *file);
+		struct BatchJob {
+			// Input: Either files or filenames must be set.
+			const vector<IRpFile*> *files;
+			const vector<string> *filenames;
+			unsigned int count;
+			unsigned int attrs;
+			unsigned int flags;
+
+			// Output: Either results or callback must be set.
+			vector<RomData*> *results;
+			RomDataFactory::pfnBatchCallback_t callback;
+			void *userdata;
+			Mutex mtxCallback;	// Serializes callback calls.
+
+			// Next job index. (Incremented atomically.)
+			volatile int nextIdx;
+
+			// Header prefetching. (filenames only)
+			// Addresses of the blocks to prefetch; empty if not prefetching.
+			vector<uint32_t> prefetchBlocks;
+		};
+
+		// Number of files ahead of the worker threads to prefetch.
+		static const unsigned int PREFETCH_DISTANCE = 32;
+
+		/**
+		 * createBatch() worker thread function.
+		 * @param arg BatchJob.
+		 */
+		static void batchWorker(void *arg);
+
+		/**
+		 * Prefetch the blocks that detection will read first
+		 * for a createBatch() file.
+		 *
+		 * The kernel is asked to read the blocks in the background
+		 * using IRpFile::setAccessHint(AH_WILLNEED), so the worker
+		 * threads' dependent reads don't have to wait for the disk
+		 * one at a time. Nothing is read into memory here.
+		 *
+		 * @param job BatchJob.
+		 * @param idx File index.
+		 */
+		static void batchPrefetch(const BatchJob *job, unsigned int idx);
+
+		/**
+		 * Run a createBatch() job.
+		 * The calling thread is used as one of the worker threads.
+		 * @param job BatchJob.
+		 * @param threads Number of worker threads. (0 for the number of CPUs)
+		 */
+		static void runBatch(BatchJob *job, unsigned int threads);
 };
 
 /** RomDataFactoryPrivate **/
@@ -222,6 +407,9 @@ vector<RomDataFactory::ExtInfo> RomDataFactoryPrivate::vec_exts;
 vector<const char*> RomDataFactoryPrivate::vec_mimeTypes;
 pthread_once_t RomDataFactoryPrivate::once_exts = PTHREAD_ONCE_INIT;
 pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
+vector<RomDataFactoryPrivate::MagicIndexEntry> RomDataFactoryPrivate::vec_magicIndex;
+vector<uint32_t> RomDataFactoryPrivate::vec_magicAddrs;
+pthread_once_t RomDataFactoryPrivate::once_magicIndex = PTHREAD_ONCE_INIT;
 
 #define ATTR_NONE		RomDataFactory::RDA_NONE
 #define ATTR_HAS_THUMBNAIL	RomDataFactory::RDA_HAS_THUMBNAIL
@@ -237,108 +425,116 @@ pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
 // TODO: Add support for multiple magic numbers per class.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_magic[] = {
 	// Consoles
-	GetRomDataFns_addr(WiiWIBN, ATTR_HAS_THUMBNAIL, 0, 'WIBN'),
-	GetRomDataFns_addr(Xbox_XBE, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XBEH'),
-	GetRomDataFns_addr(Xbox360_XDBF, ATTR_HAS_THUMBNAIL, 0, 'XDBF'),
-	GetRomDataFns_addr(Xbox360_XEX, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XEX1'),
-	GetRomDataFns_addr(Xbox360_XEX, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XEX2'),
+	GetRomDataFns_addr(WiiWIBN, ATTR_HAS_THUMBNAIL, 0, 'WIBN', BANNER_FILE, "Nintendo Wii"),
+	GetRomDataFns_addr(Xbox_XBE, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XBEH', EXECUTABLE, "Microsoft Xbox"),
+	GetRomDataFns_addr(Xbox360_XDBF, ATTR_HAS_THUMBNAIL, 0, 'XDBF', RESOURCE_FILE, "Microsoft Xbox 360"),
+	GetRomDataFns_addr(Xbox360_XEX, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XEX1', EXECUTABLE, "Microsoft Xbox 360"),
+	GetRomDataFns_addr(Xbox360_XEX, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'XEX2', EXECUTABLE, "Microsoft Xbox 360"),
 
 	// Handhelds
-	GetRomDataFns_addr(DMG, ATTR_HAS_METADATA, 0x104, 0xCEED6666),
-	GetRomDataFns_addr(GameBoyAdvance, ATTR_NONE, 0x04, 0x24FFAE51),
-	GetRomDataFns_addr(Lynx, ATTR_NONE, 0, 'LYNX'),
-	GetRomDataFns_addr(NGPC, ATTR_HAS_METADATA, 12, ' SNK'),
-	GetRomDataFns_addr(Nintendo3DSFirm, ATTR_NONE, 0, 'FIRM'),
-	GetRomDataFns_addr(Nintendo3DS_SMDH, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'SMDH'),
-	GetRomDataFns_addr(NintendoDS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA, 0xC0, 0x24FFAE51),
-	GetRomDataFns_addr(NintendoDS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA, 0xC0, 0xC8604FE2),
+	GetRomDataFns_addr(DMG, ATTR_HAS_METADATA, 0x104, 0xCEED6666, ROM_IMAGE, "Nintendo Game Boy"),
+	GetRomDataFns_addr(GameBoyAdvance, ATTR_NONE, 0x04, 0x24FFAE51, ROM_IMAGE, "Nintendo Game Boy Advance"),
+	GetRomDataFns_addr(Lynx, ATTR_NONE, 0, 'LYNX', ROM_IMAGE, "Atari Lynx"),
+	GetRomDataFns_addr(NGPC, ATTR_HAS_METADATA, 12, ' SNK', ROM_IMAGE, "Neo Geo Pocket"),
+	GetRomDataFns_addr(Nintendo3DSFirm, ATTR_NONE, 0, 'FIRM', FIRMWARE_BINARY, "Nintendo 3DS"),
+	GetRomDataFns_addr(Nintendo3DS_SMDH, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'SMDH', ICON_FILE, "Nintendo 3DS"),
+	GetRomDataFns_addr(NintendoDS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA, 0xC0, 0x24FFAE51, ROM_IMAGE, "Nintendo DS"),
+	GetRomDataFns_addr(NintendoDS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA, 0xC0, 0xC8604FE2, ROM_IMAGE, "Nintendo DS"),
 
 	// Audio
-	GetRomDataFns_addr(BRSTM, ATTR_HAS_METADATA, 0, 'RSTM'),
-	GetRomDataFns_addr(GBS, ATTR_HAS_METADATA, 0, 'GBS\x01'),
-	GetRomDataFns_addr(NSF, ATTR_HAS_METADATA, 0, 'NESM'),
-	GetRomDataFns_addr(SPC, ATTR_HAS_METADATA, 0, 'SNES'),
-	GetRomDataFns_addr(VGM, ATTR_HAS_METADATA, 0, 'Vgm '),
+	GetRomDataFns_addr(BCSTM, ATTR_HAS_METADATA, 0, 'CSTM', AUDIO_FILE, "Nintendo 3DS"),
+	GetRomDataFns_addr(BCSTM, ATTR_HAS_METADATA, 0, 'FSTM', AUDIO_FILE, "Nintendo 3DS"),
+	GetRomDataFns_addr(BCSTM, ATTR_HAS_METADATA, 0, 'CWAV', AUDIO_FILE, "Nintendo 3DS"),
+	GetRomDataFns_addr(BRSTM, ATTR_HAS_METADATA, 0, 'RSTM', AUDIO_FILE, "Nintendo Wii"),
+	GetRomDataFns_addr(GBS, ATTR_HAS_METADATA, 0, 'GBS\x01', AUDIO_FILE, "Game Boy Sound System"),
+	GetRomDataFns_addr(NSF, ATTR_HAS_METADATA, 0, 'NESM', AUDIO_FILE, "Nintendo Sound Format"),
+	GetRomDataFns_addr(SAP, ATTR_HAS_METADATA, 0, 'SAP\r', AUDIO_FILE, "Atari 8-bit SAP Audio"),
+	GetRomDataFns_addr(SAP, ATTR_HAS_METADATA, 0, 'SAP\n', AUDIO_FILE, "Atari 8-bit SAP Audio"),
+	GetRomDataFns_addr(SPC, ATTR_HAS_METADATA, 0, 'SNES', AUDIO_FILE, "Super NES SPC Audio"),
+	GetRomDataFns_addr(VGM, ATTR_HAS_METADATA, 0, 'Vgm ', AUDIO_FILE, "Video Game Music"),
 
 	// Other
-	GetRomDataFns_addr(ELF, ATTR_NONE, 0, '\177ELF'),
+	GetRomDataFns_addr(ELF, ATTR_NONE, 0, '\177ELF', EXECUTABLE, "Executable and Linkable Format"),
 
 	// Consoles: Xbox 360 STFS
 	// Moved here to prevent conflicts with the Nintendo DS ROM image
 	// "Live On Card Live-R DS".
-	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'CON '),
-	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'PIRS'),
-	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'LIVE'),
+	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'CON ', APPLICATION_PACKAGE, "Microsoft Xbox 360"),
+	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'PIRS', APPLICATION_PACKAGE, "Microsoft Xbox 360"),
+	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'LIVE', APPLICATION_PACKAGE, "Microsoft Xbox 360"),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0, nullptr, RomData::FTYPE_UNKNOWN, nullptr}
 };
 
 // RomData subclasses that use a header.
 // Headers with addresses other than 0 should be
 // placed at the end of this array.
+// NOTE: These aren't in the magic number index, so each
+// isRomSupported() function is called in order. They either
+// don't have a fixed 32-bit magic number, or they have to be
+// checked after another class with an overlapping header:
+// e.g. SID's "RSID" is also a valid Wii game ID.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_header[] = {
 	// Consoles
-	GetRomDataFns(Dreamcast, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES),
-	GetRomDataFns(DreamcastSave, ATTR_HAS_THUMBNAIL),
-	GetRomDataFns(GameCube, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES),
-	GetRomDataFns(GameCubeBNR, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
-	GetRomDataFns(GameCubeSave, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
-	GetRomDataFns(iQuePlayer, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
-	GetRomDataFns(MegaDrive, ATTR_SUPPORTS_DEVICES),	// ATTR_SUPPORTS_DEVICES for Sega CD
-	GetRomDataFns(N64, ATTR_NONE | ATTR_HAS_METADATA),
-	GetRomDataFns(NES, ATTR_NONE),
-	GetRomDataFns(SNES, ATTR_NONE),
-	GetRomDataFns(SegaSaturn, ATTR_NONE | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES),
-	GetRomDataFns(WiiSave, ATTR_HAS_THUMBNAIL),
-	GetRomDataFns(WiiU, ATTR_HAS_THUMBNAIL | ATTR_SUPPORTS_DEVICES),
-	GetRomDataFns(WiiWAD, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
+	GetRomDataFns(Dreamcast, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES, DISC_IMAGE, "Sega Dreamcast"),
+	GetRomDataFns(DreamcastSave, ATTR_HAS_THUMBNAIL, SAVE_FILE, "Sega Dreamcast"),
+	GetRomDataFns(GameCube, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES, DISC_IMAGE, "Nintendo GameCube"),
+	GetRomDataFns(GameCubeBNR, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, BANNER_FILE, "Nintendo GameCube"),
+	GetRomDataFns(GameCubeSave, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, SAVE_FILE, "Nintendo GameCube"),
+	GetRomDataFns(iQuePlayer, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, METADATA_FILE, "iQue Player"),
+	GetRomDataFns(MegaDrive, ATTR_SUPPORTS_DEVICES, ROM_IMAGE, "Sega Mega Drive"),	// ATTR_SUPPORTS_DEVICES for Sega CD
+	GetRomDataFns(N64, ATTR_NONE | ATTR_HAS_METADATA, ROM_IMAGE, "Nintendo 64"),
+	GetRomDataFns(NES, ATTR_NONE, ROM_IMAGE, "Nintendo Entertainment System"),
+	GetRomDataFns(SNES, ATTR_NONE, ROM_IMAGE, "Super Nintendo Entertainment System"),
+	GetRomDataFns(SegaSaturn, ATTR_NONE | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES, DISC_IMAGE, "Sega Saturn"),
+	GetRomDataFns(WiiSave, ATTR_HAS_THUMBNAIL, SAVE_FILE, "Nintendo Wii"),
+	GetRomDataFns(WiiU, ATTR_HAS_THUMBNAIL | ATTR_SUPPORTS_DEVICES, DISC_IMAGE, "Nintendo Wii U"),
+	GetRomDataFns(WiiWAD, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, APPLICATION_PACKAGE, "Nintendo Wii"),
 
 	// Handhelds
-	GetRomDataFns(Nintendo3DS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA),
+	GetRomDataFns(Nintendo3DS, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY | ATTR_HAS_METADATA, ROM_IMAGE, "Nintendo 3DS"),
 
 	// Audio
-	GetRomDataFns(ADX, ATTR_HAS_METADATA),
-	GetRomDataFns(BCSTM, ATTR_HAS_METADATA),
-	GetRomDataFns(PSF, ATTR_HAS_METADATA),
-	GetRomDataFns(SAP, ATTR_HAS_METADATA),	// "SAP\r\n", "SAP\n"; maybe move to _magic[]?
-	GetRomDataFns(SNDH, ATTR_HAS_METADATA),	// "SNDH", or "ICE!" or "Ice!" if packed.
-	GetRomDataFns(SID, ATTR_HAS_METADATA),	// PSID/RSID; maybe move to _magic[]?
+	GetRomDataFns(ADX, ATTR_HAS_METADATA, AUDIO_FILE, "CRI ADX"),
+	GetRomDataFns(PSF, ATTR_HAS_METADATA, AUDIO_FILE, "Portable Sound Format"),
+	GetRomDataFns(SNDH, ATTR_HAS_METADATA, AUDIO_FILE, "Atari ST SNDH Audio"),	// "SNDH", or "ICE!" or "Ice!" if packed.
+	GetRomDataFns(SID, ATTR_HAS_METADATA, AUDIO_FILE, "Commodore 64 SID Music"),	// PSID/RSID; must be after GameCube. (Wii game IDs)
 
 	// Other
-	GetRomDataFns(Amiibo, ATTR_HAS_THUMBNAIL),
-	GetRomDataFns(MachO, ATTR_NONE),
-	GetRomDataFns(NintendoBadge, ATTR_HAS_THUMBNAIL),
+	GetRomDataFns(Amiibo, ATTR_HAS_THUMBNAIL, NFC_DUMP, "Nintendo Figurine Platform"),
+	GetRomDataFns(MachO, ATTR_NONE, EXECUTABLE, "Mach Microkernel"),
+	GetRomDataFns(NintendoBadge, ATTR_HAS_THUMBNAIL, TEXTURE_FILE, "Nintendo Badge Arcade"),
 
 	// The following formats have 16-bit magic numbers,
 	// so they should go at the end of the address=0 section.
-	GetRomDataFns(EXE, ATTR_NONE),	// TODO: Thumbnailing on non-Windows platforms.
-	GetRomDataFns(PlayStationSave, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
+	GetRomDataFns(EXE, ATTR_NONE, EXECUTABLE, "Microsoft Windows"),	// TODO: Thumbnailing on non-Windows platforms.
+	GetRomDataFns(PlayStationSave, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, SAVE_FILE, "Sony PlayStation"),
 
 	// NOTE: game.com may be at either 0 or 0x40000.
 	// The 0x40000 address is checked below.
-	GetRomDataFns(GameCom, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
+	GetRomDataFns(GameCom, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, ROM_IMAGE, "Tiger game.com"),
 
 	// Headers with non-zero addresses.
-	GetRomDataFns_addr(Sega8Bit, ATTR_HAS_METADATA, 0x7FE0, 0x20),
-	GetRomDataFns_addr(PokemonMini, ATTR_HAS_METADATA, 0x2100, 0xD0),
+	GetRomDataFns_addr(Sega8Bit, ATTR_HAS_METADATA, 0x7FE0, 0x20, ROM_IMAGE, "Sega Master System"),
+	GetRomDataFns_addr(PokemonMini, ATTR_HAS_METADATA, 0x2100, 0xD0, ROM_IMAGE, "Pok\xC3\xA9mon Mini"),
 	// NOTE: game.com may be at either 0 or 0x40000.
 	// The 0 address is checked above.
-	GetRomDataFns_addr(GameCom, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0x40000, 0x20),
+	GetRomDataFns_addr(GameCom, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0x40000, 0x20, ROM_IMAGE, "Tiger game.com"),
 
 	// Last chance: ISO-9660 disc images.
 	// NOTE: This might include some console-specific disc images
 	// that don't have an identifying boot sector at 0x0000.
 	// NOTE: Keeping the same address, since ISO only checks the file extension.
 	// NOTE: ATTR_HAS_THUMBNAIL is needed for Xbox 360.
-	GetRomDataFns_addr(ISO, ATTR_HAS_THUMBNAIL | ATTR_SUPPORTS_DEVICES | ATTR_CHECK_ISO, 0x40000, 0x20),
+	GetRomDataFns_addr(ISO, ATTR_HAS_THUMBNAIL | ATTR_SUPPORTS_DEVICES | ATTR_CHECK_ISO, 0x40000, 0x20, DISC_IMAGE, "ISO-9660"),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0, nullptr, RomData::FTYPE_UNKNOWN, nullptr}
 };
 
 // RomData subclasses that use a footer.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_footer[] = {
-	GetRomDataFns(VirtualBoy, ATTR_NONE),
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	GetRomDataFns(VirtualBoy, ATTR_NONE, ROM_IMAGE, "Nintendo Virtual Boy"),
+	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0, nullptr, RomData::FTYPE_UNKNOWN, nullptr}
 };
 
 // Table of pointers to tables.
@@ -351,6 +547,187 @@ const RomDataFactoryPrivate::RomDataFns *const RomDataFactoryPrivate::romDataFns
 	nullptr
 };
 
+// RomData subclasses that are created by special cases
+// in create_int(). Only used for detection cache lookups.
+const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_special[] = {
+	GetRomDataFns(RpTextureWrapper, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, TEXTURE_FILE, nullptr),
+	GetRomDataFns(XboxDisc, ATTR_HAS_THUMBNAIL | ATTR_SUPPORTS_DEVICES, DISC_IMAGE, "Microsoft Xbox"),
+	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0, nullptr, RomData::FTYPE_UNKNOWN, nullptr}
+};
+
+/**
+ * Initialize the magic number dispatch index.
+ *
+ * Internal function; must be called using pthread_once().
+ */
+void RomDataFactoryPrivate::init_magicIndex(void)
+{
+	vec_magicIndex.reserve(ARRAY_SIZE(romDataFns_magic));
+	unsigned int idx = 0;
+	for (const RomDataFns *fns = &romDataFns_magic[0];
+	     fns->supportedFileExtensions != nullptr; fns++, idx++)
+	{
+		// TODO: Verify alignment restrictions.
+		assert(fns->address % 4 == 0);
+		assert(fns->address + sizeof(uint32_t) <= 4096+256);
+
+		MagicIndexEntry entry;
+		entry.key = (static_cast<uint64_t>(fns->address) << 32) | fns->size;
+		entry.idx = idx;
+		vec_magicIndex.emplace_back(entry);
+
+		if (std::find(vec_magicAddrs.cbegin(), vec_magicAddrs.cend(), fns->address) == vec_magicAddrs.cend()) {
+			vec_magicAddrs.emplace_back(fns->address);
+		}
+	}
+
+	std::sort(vec_magicIndex.begin(), vec_magicIndex.end());
+}
+
+/**
+ * Look up RomData subclasses with a matching magic number.
+ *
+ * Candidates are returned in romDataFns_magic[] order,
+ * so detection priority is the same as a linear scan.
+ *
+ * @param header	[in] Header data. (starting at address 0)
+ * @param size		[in] Size of header data.
+ * @param pIdx		[out] Array of romDataFns_magic[] indexes.
+ * @param maxIdx	[in] Maximum number of indexes.
+ * @return Number of matching indexes.
+ */
+unsigned int RomDataFactoryPrivate::lookupMagic(const uint8_t *header, uint32_t size,
+	unsigned int *pIdx, unsigned int maxIdx)
+{
+	pthread_once(&once_magicIndex, init_magicIndex);
+
+	unsigned int count = 0;
+	for (auto addr_iter = vec_magicAddrs.cbegin();
+	     addr_iter != vec_magicAddrs.cend(); ++addr_iter)
+	{
+		const uint32_t address = *addr_iter;
+		if (address + sizeof(uint32_t) > size) {
+			// Header is too small.
+			continue;
+		}
+
+		uint32_t magic;
+		memcpy(&magic, &header[address], sizeof(magic));
+		MagicIndexEntry key;
+		key.key = (static_cast<uint64_t>(address) << 32) | be32_to_cpu(magic);
+		key.idx = 0;
+
+		auto iter = std::lower_bound(vec_magicIndex.cbegin(), vec_magicIndex.cend(), key);
+		for (; iter != vec_magicIndex.cend() && iter->key == key.key && count < maxIdx; ++iter) {
+			pIdx[count++] = iter->idx;
+		}
+	}
+
+	// Candidates from multiple addresses need to be
+	// checked in table order.
+	if (count > 1) {
+		std::sort(pIdx, pIdx + count);
+	}
+	return count;
+}
+
+/**
+ * Find a RomData subclass by class name.
+ * @param className Class name.
+ * @return RomDataFns, or nullptr if not found.
+ */
+const RomDataFactoryPrivate::RomDataFns *RomDataFactoryPrivate::findRomDataFns(const string &className)
+{
+	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0];
+	     *tblptr != nullptr; tblptr++)
+	{
+		for (const RomDataFns *fns = *tblptr; fns->className != nullptr; fns++) {
+			if (className == fns->className)
+				return fns;
+		}
+	}
+
+	for (const RomDataFns *fns = &romDataFns_special[0]; fns->className != nullptr; fns++) {
+		if (className == fns->className)
+			return fns;
+	}
+
+	// Not found.
+	return nullptr;
+}
+
+/**
+ * Set identification info for a RomData subclass.
+ * @param pIdInfo	[out,opt] Identification info.
+ * @param fns		[in] RomDataFns, or nullptr if the file isn't supported.
+ * @param romType	[in] Class-specific system ID from isRomSupported_static().
+ * @param attrs		[in] RomDataAttr bitfield.
+ */
+void RomDataFactoryPrivate::setIdInfo(RomDataFactory::IdentifyInfo *pIdInfo,
+	const RomDataFns *fns, int romType, unsigned int attrs)
+{
+	if (!pIdInfo)
+		return;
+
+	if (!fns) {
+		// Not supported.
+		pIdInfo->className = nullptr;
+		pIdInfo->romType = -1;
+		pIdInfo->attrs = 0;
+		pIdInfo->fileType = RomData::FTYPE_UNKNOWN;
+		pIdInfo->systemName = nullptr;
+		return;
+	}
+
+	pIdInfo->className = fns->className;
+	pIdInfo->romType = romType;
+	pIdInfo->attrs = attrs;
+	pIdInfo->fileType = fns->fileType;
+	pIdInfo->systemName = fns->systemName;
+}
+
+/**
+ * Get a file's identity for the detection cache.
+ * @param file		[in] ROM file.
+ * @param pFileId	[out] File identity.
+ * @return True if the detection cache can be used for this file; false if not.
+ */
+bool RomDataFactoryPrivate::getDetectCacheFileId(IRpFile *file, FileSystem::FileId *pFileId)
+{
+	if (!DetectCache::isEnabled() || file->isDevice())
+		return false;
+
+	const string filename = file->filename();
+	if (filename.empty())
+		return false;
+
+	// Dreamcast .VMI+.VMS pairs depend on the other file,
+	// so they can't be cached using this file's identity.
+	const char *const ext = FileSystem::file_ext(filename);
+	if (ext && (!strcasecmp(ext, ".vms") || !strcasecmp(ext, ".vmi")))
+		return false;
+
+	return (FileSystem::get_file_id(filename, pFileId) == 0);
+}
+
+/**
+ * Wrap a file in a CachedRpFile if it would benefit from it.
+ * Only regular files opened using RpFile are wrapped.
+ * @param file ROM file.
+ * @return CachedRpFile, or file->ref() if the file isn't wrapped. (Caller must unref() it.)
+ */
+IRpFile *RomDataFactoryPrivate::openCachedFile(IRpFile *file)
+{
+	// Device files are not wrapped, since some RomData
+	// subclasses need the RpFile for SCSI commands.
+	// Memory-backed files don't need a cache.
+	if (file->isDevice() || !dynamic_cast<RpFile*>(file)) {
+		return file->ref();
+	}
+
+	return new CachedRpFile(file);
+}
+
 /**
  * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
  * @param file One opened file in the .VMI+.VMS pair.
@@ -424,9 +801,12 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
  * RomData subclasses support it, an ISO object will be returned.
  *
  * @param file ISO-9660 disc image
- * @return Game-specific RomData subclass, or nullptr if none are supported.
+ * @param pIdInfo [out,opt] If not nullptr, set to the identification info for game-specific subclasses. (Not changed otherwise.)
+ * @param construct If false, only identify the file; don't create a RomData subclass.
+ * @return Game-specific RomData subclass, or nullptr if none are supported or construct is false.
  */
-RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
+RomData *RomDataFactoryPrivate::checkISO(IRpFile *file,
+	RomDataFactory::IdentifyInfo *pIdInfo, bool construct)
 {
 	// Check for specific disc file systems.
 	// TODO: 2352-byte sector handling?
@@ -440,7 +820,8 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	// Try various game disc file systems.
 
 	// Xbox / Xbox 360
-	bool mayBeXbox = (XboxDisc::isRomSupported_static(&pvd) >= 0);
+	int xboxType = XboxDisc::isRomSupported_static(&pvd);
+	bool mayBeXbox = (xboxType >= 0);
 	if (!mayBeXbox) {
 		// This might be an extracted XDVDFS.
 		// Check for the magic number at the base offset.
@@ -453,44 +834,61 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 			    !memcmp(xdvdfsHeader.magic_footer, XDVDFS_MAGIC, sizeof(xdvdfsHeader.magic_footer)))
 			{
 				// It's a match!
+				// NOTE: 0 == extracted XDVDFS
 				mayBeXbox = true;
+				xboxType = 0;
 			}
 		}
 	}
 
 	if (mayBeXbox) {
+		const RomDataFns *const fns = findRomDataFns("XboxDisc");
+		assert(fns != nullptr);
+		if (!construct) {
+			// Identify only.
+			setIdInfo(pIdInfo, fns, xboxType, fns->attrs);
+			return nullptr;
+		}
+
 		RomData *const romData = new XboxDisc(file);
 		if (romData->isValid()) {
 			// Got an Xbox disc.
+			setIdInfo(pIdInfo, fns, xboxType, fns->attrs);
 			return romData;
 		}
 		romData->unref();
 	}
 
+	if (!construct) {
+		// Identify only.
+		return nullptr;
+	}
+
 	// Not a game-specific file system.
 	// Use the generic ISO-9660 parser.
 	return new ISO(file);
 }
 
-/** RomDataFactory **/
-
 /**
- * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
+ * Create a RomData subclass for the specified ROM file,
+ * or identify the RomData subclass without creating it.
  *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
+ * If construct is true, this works like RomDataFactory::create().
+ * Otherwise, the RomData subclass is not created.
  *
  * @param file ROM file.
  * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
- * @return RomData subclass, or nullptr if the ROM isn't supported.
+ * @param pIdInfo [out,opt] Identification info. (className is nullptr if the ROM isn't supported.)
+ * @param construct If false, only identify the file; don't create a RomData subclass.
+ * @return RomData subclass, or nullptr if the ROM isn't supported or construct is false.
  */
-RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+RomData *RomDataFactoryPrivate::create_int(IRpFile *file, unsigned int attrs,
+	RomDataFactory::IdentifyInfo *pIdInfo, bool construct)
 {
+	// NOTE: pIdInfo is only set once the RomData subclass
+	// has been accepted, so clear it in case nothing is.
+	setIdInfo(pIdInfo, nullptr, -1, 0);
+
 	RomData::DetectInfo info;
 
 	// Get the file size.
@@ -532,16 +930,20 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	}
 
 	// Special handling for Dreamcast .VMI+.VMS pairs.
-	if (info.ext != nullptr &&
+	// NOTE: Skipped when identifying, since this opens the other file.
+	if (construct && info.ext != nullptr &&
 	    (!strcasecmp(info.ext, ".vms") ||
 	     !strcasecmp(info.ext, ".vmi")))
 	{
 		// Dreamcast .VMI+.VMS pair.
 		// Attempt to open the other file in the pair.
-		RomData *romData = RomDataFactoryPrivate::openDreamcastVMSandVMI(file);
+		RomData *romData = openDreamcastVMSandVMI(file);
 		if (romData) {
 			if (romData->isValid()) {
 				// .VMI+.VMS pair opened.
+				const RomDataFns *const fns = findRomDataFns("DreamcastSave");
+				assert(fns != nullptr);
+				setIdInfo(pIdInfo, fns, -1, fns->attrs);
 				return romData;
 			}
 			// Not a .VMI+.VMS pair.
@@ -553,42 +955,55 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 	// Check RomData subclasses that take a header at 0
 	// and definitely have a 32-bit magic number in the header.
-	const RomDataFactoryPrivate::RomDataFns *fns =
-		&RomDataFactoryPrivate::romDataFns_magic[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
+	// The magic number index is used to find candidate
+	// subclasses without checking every table entry.
+	unsigned int magicIdx[ARRAY_SIZE(RomDataFactoryPrivate::romDataFns_magic)];
+	const unsigned int magicCount = lookupMagic(
+		header.u8, info.header.size, magicIdx, ARRAY_SIZE(magicIdx));
+	for (unsigned int i = 0; i < magicCount; i++) {
+		const RomDataFns *const fns = &romDataFns_magic[magicIdx[i]];
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
 			// required attributes.
 			continue;
 		}
 
-		// Check the magic number.
-		// TODO: Verify alignment restrictions.
-		assert(fns->address % 4 == 0);
-		assert(fns->address + sizeof(uint32_t) <= sizeof(header.u32));
-		// FIXME: Fix strict aliasing warnings on Ubuntu 14.04.
-		uint32_t magic = header.u32[fns->address/4];
-		if (be32_to_cpu(magic) == fns->size) {
-			// Found a matching magic number.
-			if (fns->isRomSupported(&info) >= 0) {
-				RomData *const romData = fns->newRomData(file);
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return romData;
-				}
+		// Found a matching magic number.
+		const int romType = fns->isRomSupported(&info);
+		if (romType >= 0) {
+			if (!construct) {
+				// Identify only.
+				setIdInfo(pIdInfo, fns, romType, fns->attrs);
+				return nullptr;
+			}
 
-				// Not actually supported.
-				romData->unref();
+			RomData *const romData = fns->newRomData(file);
+			if (romData->isValid()) {
+				// RomData subclass obtained.
+				setIdInfo(pIdInfo, fns, romType, fns->attrs);
+				return romData;
 			}
+
+			// Not actually supported.
+			romData->unref();
 		}
 	}
 
 	// Check for supported textures.
-	{
-		// TODO: RpTextureWrapper::isRomSupported()?
+	const int texType = RpTextureWrapper::isRomSupported_static(&info);
+	if (texType >= 0) {
+		const RomDataFns *const texFns = findRomDataFns("RpTextureWrapper");
+		assert(texFns != nullptr);
+		if (!construct) {
+			// Identify only.
+			setIdInfo(pIdInfo, texFns, texType, texFns->attrs);
+			return nullptr;
+		}
+
 		RomData *const romData = new RpTextureWrapper(file);
 		if (romData->isValid()) {
 			// RomData subclass obtained.
+			setIdInfo(pIdInfo, texFns, texType, texFns->attrs);
 			return romData;
 		}
 
@@ -598,7 +1013,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 	// Check other RomData subclasses that take a header,
 	// but don't have a simple 32-bit magic number check.
-	fns = &RomDataFactoryPrivate::romDataFns_header[0];
+	const RomDataFns *fns = &romDataFns_header[0];
 	bool checked_exts = false;
 	for (; fns->supportedFileExtensions != nullptr; fns++) {
 		if ((fns->attrs & attrs) != attrs) {
@@ -665,20 +1080,35 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 				continue;
 
 			// Read the header data.
+			// NOTE: create() passes a CachedRpFile, so this is usually
+			// read from a cached block, and the RomData constructor
+			// can read the same header again without another read
+			// from the underlying file.
 			info.header.addr = fns->address;
-			int ret = file->seek(info.header.addr);
-			if (ret != 0)
-				continue;
-			info.header.size = static_cast<uint32_t>(file->read(header.u8, fns->size));
+			info.header.size = static_cast<uint32_t>(
+				file->seekAndRead(info.header.addr, header.u8, fns->size));
 			if (info.header.size != fns->size)
 				continue;
 		}
 
-		if (fns->isRomSupported(&info) >= 0) {
+		const int romType = fns->isRomSupported(&info);
+		if (romType >= 0) {
 			RomData *romData;
-			if (fns->attrs & RDA_CHECK_ISO) {
+			if (fns->attrs & ATTR_CHECK_ISO) {
 				// Check for a game-specific ISO subclass.
-				romData = RomDataFactoryPrivate::checkISO(file);
+				// NOTE: pIdInfo is set by checkISO() if one is found.
+				romData = checkISO(file, pIdInfo, construct);
+				if (!construct) {
+					// Identify only.
+					if (pIdInfo && !pIdInfo->className) {
+						setIdInfo(pIdInfo, fns, romType, fns->attrs);
+					}
+					return nullptr;
+				}
+			} else if (!construct) {
+				// Identify only.
+				setIdInfo(pIdInfo, fns, romType, fns->attrs);
+				return nullptr;
 			} else {
 				// Standard RomData subclass.
 				romData = fns->newRomData(file);
@@ -687,6 +1117,9 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 			if (romData) {
 				if (romData->isValid()) {
 					// RomData subclass obtained.
+					if (pIdInfo && !pIdInfo->className) {
+						setIdInfo(pIdInfo, fns, romType, fns->attrs);
+					}
 					return romData;
 				}
 				// Not actually supported.
@@ -703,7 +1136,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	}
 
 	bool readFooter = false;
-	fns = &RomDataFactoryPrivate::romDataFns_footer[0];
+	fns = &romDataFns_footer[0];
 	for (; fns->supportedFileExtensions != nullptr; fns++) {
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
@@ -733,10 +1166,18 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 			readFooter = true;
 		}
 
-		if (fns->isRomSupported(&info) >= 0) {
+		const int romType = fns->isRomSupported(&info);
+		if (romType >= 0) {
+			if (!construct) {
+				// Identify only.
+				setIdInfo(pIdInfo, fns, romType, fns->attrs);
+				return nullptr;
+			}
+
 			RomData *const romData = fns->newRomData(file);
 			if (romData->isValid()) {
 				// RomData subclass obtained.
+				setIdInfo(pIdInfo, fns, romType, fns->attrs);
 				return romData;
 			}
 
@@ -749,6 +1190,521 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	return nullptr;
 }
 
+/**
+ * Create a RomData subclass for the specified ROM file,
+ * using the detection cache if possible.
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactoryPrivate::create_detectCache(IRpFile *file, unsigned int attrs)
+{
+	FileSystem::FileId fileId;
+	const bool useCache = getDetectCacheFileId(file, &fileId);
+	if (useCache) {
+		DetectCache::Entry entry;
+		if (DetectCache::lookup(fileId, attrs, &entry)) {
+			if (entry.className.empty()) {
+				// File is known to be unsupported.
+				return nullptr;
+			}
+
+			const RomDataFns *const fns = findRomDataFns(entry.className);
+			if (fns) {
+				// If the fields and metadata are cached, use them
+				// without parsing the file. The RomData subclass
+				// is only created if it's needed, e.g. for images.
+				DetectCache::Data data;
+				if (DetectCache::lookupData(fileId, fns->className, &data)) {
+					return new CachedRomData(file, fns->className, fns->newRomData, data);
+				}
+
+				// Create the cached RomData subclass directly.
+				RomData *const romData = fns->newRomData(file);
+				if (romData->isValid()) {
+					// RomData subclass obtained.
+					return romData;
+				}
+
+				// Not actually supported.
+				// Run the full detection sequence.
+				romData->unref();
+			}
+		}
+	}
+
+	RomDataFactory::IdentifyInfo idInfo;
+	RomData *const romData = create_int(
+		file, attrs, (useCache ? &idInfo : nullptr), true);
+	if (useCache) {
+		DetectCache::Entry entry;
+		if (romData) {
+			entry.className = idInfo.className;
+			entry.romType = idInfo.romType;
+			entry.attrs = idInfo.attrs;
+		} else {
+			entry.romType = -1;
+			entry.attrs = 0;
+		}
+		DetectCache::store(fileId, attrs, entry);
+	}
+	return romData;
+}
+
+/** RomDataFactory **/
+
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * Regular files opened using RpFile are wrapped in a CachedRpFile,
+ * so the RomData subclass's file will be the CachedRpFile.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+{
+	// Use a read-ahead block cache for regular files.
+	// Many RomData subclasses do lots of small reads.
+	unique_IRpFile<IRpFile> cachedFile(RomDataFactoryPrivate::openCachedFile(file));
+	RomData *const romData = RomDataFactoryPrivate::create_detectCache(cachedFile.get(), attrs);
+
+	if (romData) {
+		// Detection is done, so most of the cache isn't needed anymore.
+		// Keep a few blocks for loading the fields and images.
+		CachedRpFile *const cf = dynamic_cast<CachedRpFile*>(cachedFile.get());
+		if (cf) {
+			cf->shrink(RomDataFactoryPrivate::CACHED_FILE_BLOCKS_AFTER_DETECT);
+		}
+	}
+	return romData;
+}
+
+/**
+ * Identify the RomData subclass for the specified ROM file
+ * without creating it.
+ *
+ * Only the isRomSupported_static() functions are checked, so no
+ * headers are parsed beyond the detection headers, and no partitions
+ * or encryption keys are initialized. Because RomData::isValid() is
+ * not checked, this may identify a file that create() rejects if
+ * the file is corrupted past the detection header.
+ *
+ * NOTE: Dreamcast .VMI+.VMS pairs are identified as single files.
+ *
+ * @param file		[in] ROM file.
+ * @param pIdInfo	[out] Identification information.
+ * @param attrs		[in] RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return True if the file is supported; false if not.
+ */
+bool RomDataFactory::identify(IRpFile *file, IdentifyInfo *pIdInfo, unsigned int attrs)
+{
+	assert(pIdInfo != nullptr);
+	if (!pIdInfo)
+		return false;
+
+	FileSystem::FileId fileId;
+	const bool useCache = RomDataFactoryPrivate::getDetectCacheFileId(file, &fileId);
+	if (useCache) {
+		DetectCache::Entry entry;
+		if (DetectCache::lookup(fileId, attrs, &entry)) {
+			if (entry.className.empty()) {
+				// File is known to be unsupported.
+				RomDataFactoryPrivate::setIdInfo(pIdInfo, nullptr, -1, 0);
+				return false;
+			}
+
+			const RomDataFactoryPrivate::RomDataFns *const fns =
+				RomDataFactoryPrivate::findRomDataFns(entry.className);
+			if (fns) {
+				RomDataFactoryPrivate::setIdInfo(pIdInfo, fns, entry.romType, entry.attrs);
+				return true;
+			}
+		}
+	}
+
+	// NOTE: identify() results are not stored in the detection
+	// cache, since RomData::isValid() isn't checked.
+	RomDataFactoryPrivate::create_int(file, attrs, pIdInfo, false);
+	return (pIdInfo->className != nullptr);
+}
+
+/**
+ * Enable or disable the persistent detection cache.
+ *
+ * If enabled, create() stores the detected RomData subclass
+ * for each file in the rom-properties cache directory, keyed
+ * by the file's device, inode, size, and modification time.
+ * If the file hasn't changed, later calls to create() and
+ * identify() skip the detection sequence. If the fields and
+ * metadata were stored by updateDetectCache(), create() uses
+ * them without parsing the file; the RomData subclass is only
+ * created if other data, e.g. images, is requested.
+ *
+ * Entries are ignored if the program version, the system
+ * language, or the configuration or key files changed.
+ *
+ * The detection cache is disabled by default.
+ *
+ * @param enabled True to enable; false to disable.
+ */
+void RomDataFactory::setDetectCacheEnabled(bool enabled)
+{
+	DetectCache::setEnabled(enabled);
+}
+
+/**
+ * Store a RomData object's fields and metadata in the detection cache.
+ *
+ * The fields and metadata are loaded if they haven't been loaded yet.
+ * If the file's fields are already stored, nothing is written.
+ * Later calls to create() for the same file will use the stored
+ * fields and metadata instead of loading them from the file.
+ *
+ * NOTE: Fields with ListData icons can't be stored,
+ * since the icons aren't serialized.
+ *
+ * @param file ROM file that was used to create the RomData object.
+ * @param romData RomData object.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataFactory::updateDetectCache(IRpFile *file, const RomData *romData)
+{
+	assert(file != nullptr);
+	assert(romData != nullptr);
+	if (!file || !romData)
+		return -EINVAL;
+
+	FileSystem::FileId fileId;
+	if (!RomDataFactoryPrivate::getDetectCacheFileId(file, &fileId))
+		return -ENOTSUP;
+	const char *const className = romData->className();
+	if (!className)
+		return -ENOTSUP;
+	if (DetectCache::hasData(fileId, className))
+		return 0;
+
+	const RomFields *const fields = romData->fields();
+	if (!fields)
+		return -EIO;
+	return DetectCache::storeData(fileId, className, romData->fileType(),
+		romData->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL),
+		fields, romData->metaData());
+}
+
+/**
+ * createBatch() worker thread function.
+ * @param arg BatchJob.
+ */
+void RomDataFactoryPrivate::batchWorker(void *arg)
+{
+	BatchJob *const job = static_cast<BatchJob*>(arg);
+
+	while (true) {
+		const unsigned int idx = static_cast<unsigned int>(ATOMIC_INC_FETCH(&job->nextIdx) - 1);
+		if (idx >= job->count)
+			break;
+
+		// Prefetch a file that the worker threads will reach later.
+		// Each index is only taken once, so each file is only
+		// prefetched once. The first files are prefetched by runBatch().
+		if (!job->prefetchBlocks.empty() && idx + PREFETCH_DISTANCE < job->count) {
+			batchPrefetch(job, idx + PREFETCH_DISTANCE);
+		}
+
+		RomData *romData = nullptr;
+		IRpFile *file;
+		if (job->files) {
+			file = job->files->at(idx);
+			if (file && file->isOpen()) {
+				file->ref();
+				romData = RomDataFactory::create(file, job->attrs);
+			} else {
+				file = nullptr;
+			}
+		} else {
+			file = new RpFile(job->filenames->at(idx), RpFile::FM_OPEN_READ_GZ);
+			if (file->isOpen()) {
+				romData = RomDataFactory::create(file, job->attrs);
+			}
+		}
+
+		if (romData) {
+			// Load the field data and/or metadata here so
+			// the caller doesn't have to do it serially.
+			if (job->flags & RomDataFactory::BATCH_LOAD_FIELDS) {
+				romData->fields();
+				if (DetectCache::isEnabled()) {
+					// Store the fields for the next scan.
+					RomDataFactory::updateDetectCache(file, romData);
+				}
+			}
+			if (job->flags & RomDataFactory::BATCH_LOAD_METADATA) {
+				romData->metaData();
+			}
+		}
+		if (file) {
+			file->unref();
+		}
+
+		if (job->callback) {
+			MutexLocker mtxLocker(job->mtxCallback);
+			job->callback(idx, romData, job->userdata);
+		} else {
+			// Each index is only written by one thread.
+			(*job->results)[idx] = romData;
+		}
+	}
+}
+
+/**
+ * Prefetch the blocks that detection will read first
+ * for a createBatch() file.
+ *
+ * The kernel is asked to read the blocks in the background
+ * using IRpFile::setAccessHint(AH_WILLNEED), so the worker
+ * threads' dependent reads don't have to wait for the disk
+ * one at a time. Nothing is read into memory here.
+ *
+ * @param job BatchJob.
+ * @param idx File index.
+ */
+void RomDataFactoryPrivate::batchPrefetch(const BatchJob *job, unsigned int idx)
+{
+	// NOTE: Transparent gzip decompression isn't used here,
+	// since the hints refer to the data that's on disk.
+	// For gzipped files, this prefetches the start of the
+	// compressed data, which is read first regardless.
+	RpFile *const file = new RpFile(job->filenames->at(idx), RpFile::FM_OPEN_READ);
+	if (!file->isOpen() || file->isDevice()) {
+		file->unref();
+		return;
+	}
+
+	static const uint32_t blockSize = CachedRpFile::DEFAULT_BLOCK_SIZE;
+	const off64_t szFile = file->size();
+	for (auto iter = job->prefetchBlocks.cbegin(); iter != job->prefetchBlocks.cend(); ++iter) {
+		if (static_cast<off64_t>(*iter) >= szFile)
+			break;
+		if (file->setAccessHint(IRpFile::AH_WILLNEED, *iter, blockSize) != 0)
+			break;
+	}
+
+	// NOTE: The kernel keeps reading after the file is closed.
+	file->unref();
+}
+
+/**
+ * Run a createBatch() job.
+ * The calling thread is used as one of the worker threads.
+ * @param job BatchJob.
+ * @param threads Number of worker threads. (0 for the number of CPUs)
+ */
+void RomDataFactoryPrivate::runBatch(BatchJob *job, unsigned int threads)
+{
+	job->nextIdx = 0;
+	if (job->count == 0)
+		return;
+
+	if (threads == 0) {
+		threads = Thread::cpuCount();
+	}
+	if (threads > job->count) {
+		threads = job->count;
+	}
+
+	// If files are being opened by filename, prefetch the headers
+	// for files that the worker threads haven't reached yet.
+	if (job->filenames && job->count > 1) {
+		// create() reads files through CachedRpFile, so prefetch
+		// the CachedRpFile blocks containing the magic numbers.
+		// Every file reaches this stage of detection; the header
+		// checks at other addresses only run for some files, so
+		// prefetching them would mostly waste disk bandwidth.
+		// NOTE: The header read at address 0 is always done.
+		static const uint32_t blockSize = CachedRpFile::DEFAULT_BLOCK_SIZE;
+		pthread_once(&once_magicIndex, init_magicIndex);
+		vector<uint32_t> &vec_blocks = job->prefetchBlocks;
+		vec_blocks.push_back(0);
+		for (auto iter = vec_magicAddrs.cbegin(); iter != vec_magicAddrs.cend(); ++iter) {
+			const uint32_t addr = *iter & ~(blockSize - 1);
+			if (std::find(vec_blocks.cbegin(), vec_blocks.cend(), addr) == vec_blocks.cend()) {
+				vec_blocks.push_back(addr);
+			}
+		}
+		std::sort(vec_blocks.begin(), vec_blocks.end());
+
+		// The worker threads prefetch files PREFETCH_DISTANCE
+		// ahead of the ones they're processing, so prefetch
+		// the files before that here.
+		const unsigned int count = (job->count < PREFETCH_DISTANCE ? job->count : PREFETCH_DISTANCE);
+		for (unsigned int i = 0; i < count; i++) {
+			batchPrefetch(job, i);
+		}
+	}
+
+	// Start the additional worker threads.
+	// Each worker takes the next file from job->nextIdx, so if a
+	// thread can't be started, its share of the work is handled
+	// by the calling thread and the threads that did start.
+	// NOTE: If starting a thread fails, the system is probably
+	// out of resources, so don't try to start any more threads.
+	unique_ptr<Thread[]> workers(threads > 1 ? new Thread[threads - 1] : nullptr);
+	unsigned int started = 0;
+	for (; started < threads - 1; started++) {
+		if (workers[started].start(batchWorker, job) != 0)
+			break;
+	}
+
+	// The calling thread is also a worker thread.
+	// It keeps taking files until all of them are done.
+	batchWorker(job);
+
+	for (unsigned int i = 0; i < started; i++) {
+		workers[i].join();
+	}
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ *
+ * Thread-safety: The RomDataFns tables are const and are never
+ * modified after static initialization. The magic number index,
+ * supported file extensions, and supported MIME types are built
+ * using pthread_once(), and the configuration readers (Config,
+ * KeyManager) are protected by an internal mutex, so create()
+ * can be called from multiple threads concurrently.
+ * Each IRpFile object must only appear once in the list,
+ * since IRpFile objects are not thread-safe.
+ *
+ * @param files		[in] ROM files.
+ * @param attrs		[in] RomDataAttr bitfield. (See create().)
+ * @param flags		[in] BatchFlags bitfield.
+ * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+ * @return RomData subclasses, in submission order. (Entries may be nullptr.)
+ */
+vector<RomData*> RomDataFactory::createBatch(const vector<IRpFile*> &files,
+	unsigned int attrs, unsigned int flags, unsigned int threads)
+{
+	vector<RomData*> results(files.size(), nullptr);
+
+	RomDataFactoryPrivate::BatchJob job;
+	job.files = &files;
+	job.filenames = nullptr;
+	job.count = static_cast<unsigned int>(files.size());
+	job.attrs = attrs;
+	job.flags = flags;
+	job.results = &results;
+	job.callback = nullptr;
+	job.userdata = nullptr;
+	RomDataFactoryPrivate::runBatch(&job, threads);
+	return results;
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ * Files are opened using RpFile with transparent gzip decompression.
+ * (See the IRpFile version for thread-safety information.)
+ *
+ * @param filenames	[in] ROM filenames. (UTF-8)
+ * @param attrs		[in] RomDataAttr bitfield. (See create().)
+ * @param flags		[in] BatchFlags bitfield.
+ * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+ * @return RomData subclasses, in submission order. (Entries may be nullptr.)
+ */
+vector<RomData*> RomDataFactory::createBatch(const vector<string> &filenames,
+	unsigned int attrs, unsigned int flags, unsigned int threads)
+{
+	vector<RomData*> results(filenames.size(), nullptr);
+
+	RomDataFactoryPrivate::BatchJob job;
+	job.files = nullptr;
+	job.filenames = &filenames;
+	job.count = static_cast<unsigned int>(filenames.size());
+	job.attrs = attrs;
+	job.flags = flags;
+	job.results = &results;
+	job.callback = nullptr;
+	job.userdata = nullptr;
+	RomDataFactoryPrivate::runBatch(&job, threads);
+	return results;
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ * Results are passed to the callback function as they finish,
+ * so they may not be in submission order.
+ * (See the IRpFile version for thread-safety information.)
+ *
+ * @param files		[in] ROM files.
+ * @param callback	[in] Callback function.
+ * @param userdata	[in] User data for the callback function.
+ * @param attrs		[in] RomDataAttr bitfield. (See create().)
+ * @param flags		[in] BatchFlags bitfield.
+ * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+ */
+void RomDataFactory::createBatch(const vector<IRpFile*> &files,
+	pfnBatchCallback_t callback, void *userdata,
+	unsigned int attrs, unsigned int flags, unsigned int threads)
+{
+	assert(callback != nullptr);
+	if (!callback)
+		return;
+
+	RomDataFactoryPrivate::BatchJob job;
+	job.files = &files;
+	job.filenames = nullptr;
+	job.count = static_cast<unsigned int>(files.size());
+	job.attrs = attrs;
+	job.flags = flags;
+	job.results = nullptr;
+	job.callback = callback;
+	job.userdata = userdata;
+	RomDataFactoryPrivate::runBatch(&job, threads);
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ * Results are passed to the callback function as they finish,
+ * so they may not be in submission order.
+ * (See the IRpFile version for thread-safety information.)
+ *
+ * @param filenames	[in] ROM filenames. (UTF-8)
+ * @param callback	[in] Callback function.
+ * @param userdata	[in] User data for the callback function.
+ * @param attrs		[in] RomDataAttr bitfield. (See create().)
+ * @param flags		[in] BatchFlags bitfield.
+ * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+ */
+void RomDataFactory::createBatch(const vector<string> &filenames,
+	pfnBatchCallback_t callback, void *userdata,
+	unsigned int attrs, unsigned int flags, unsigned int threads)
+{
+	assert(callback != nullptr);
+	if (!callback)
+		return;
+
+	RomDataFactoryPrivate::BatchJob job;
+	job.files = nullptr;
+	job.filenames = &filenames;
+	job.count = static_cast<unsigned int>(filenames.size());
+	job.attrs = attrs;
+	job.flags = flags;
+	job.results = nullptr;
+	job.callback = callback;
+	job.userdata = userdata;
+	RomDataFactoryPrivate::runBatch(&job, threads);
+}
+
 /**
  * Initialize the vector of supported file extensions.
  * Used for Win32 COM registration.
@@ -12,6 +12,7 @@
 #include "librpbase/common.h"
 
 // C++ includes.
+#include <string>
 #include <vector>
 
 namespace LibRpBase {
@@ -67,12 +68,187 @@ class RomDataFactory
 		 * types must be supported by the RomData subclass in order to
 		 * be returned.
 		 *
+		 * Regular files opened using RpFile are wrapped in a CachedRpFile,
+		 * so the RomData subclass's file will be the CachedRpFile.
+		 *
 		 * @param file ROM file.
 		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
 		 * @return RomData subclass, or nullptr if the ROM isn't supported.
 		 */
 		static LibRpBase::RomData *create(LibRpBase::IRpFile *file, unsigned int attrs = 0);
 
+		/**
+		 * RomData subclass identification information.
+		 */
+		struct IdentifyInfo {
+			const char *className;	// RomData subclass name. (Same as RomData::className().)
+			int romType;		// Class-specific system ID from isRomSupported_static().
+			unsigned int attrs;	// RomDataAttr bitfield.
+
+			// Generic file type and system name for the RomData subclass.
+			// These are determined without parsing the file, so they may
+			// be less specific than RomData::fileType() and systemName(),
+			// e.g. "Nintendo GameCube" is used for Wii disc images.
+			int fileType;		// RomData::FileType
+			const char *systemName;	// Long system name. (nullptr if unknown)
+		};
+
+		/**
+		 * Identify the RomData subclass for the specified ROM file
+		 * without creating it.
+		 *
+		 * Only the isRomSupported_static() functions are checked, so no
+		 * headers are parsed beyond the detection headers, and no partitions
+		 * or encryption keys are initialized. Because RomData::isValid() is
+		 * not checked, this may identify a file that create() rejects if
+		 * the file is corrupted past the detection header.
+		 *
+		 * NOTE: Dreamcast .VMI+.VMS pairs are identified as single files.
+		 *
+		 * @param file		[in] ROM file.
+		 * @param pIdInfo	[out] Identification information.
+		 * @param attrs		[in] RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @return True if the file is supported; false if not.
+		 */
+		static bool identify(LibRpBase::IRpFile *file, IdentifyInfo *pIdInfo, unsigned int attrs = 0);
+
+		/**
+		 * Enable or disable the persistent detection cache.
+		 *
+		 * If enabled, create() stores the detected RomData subclass
+		 * for each file in the rom-properties cache directory, keyed
+		 * by the file's device, inode, size, and modification time.
+		 * If the file hasn't changed, later calls to create() and
+		 * identify() skip the detection sequence. If the fields and
+		 * metadata were stored by updateDetectCache(), create() uses
+		 * them without parsing the file; the RomData subclass is only
+		 * created if other data, e.g. images, is requested.
+		 *
+		 * Entries are ignored if the program version, the system
+		 * language, or the configuration or key files changed.
+		 *
+		 * The detection cache is disabled by default.
+		 *
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setDetectCacheEnabled(bool enabled);
+
+		/**
+		 * Store a RomData object's fields and metadata in the detection cache.
+		 *
+		 * The fields and metadata are loaded if they haven't been loaded yet.
+		 * If the file's fields are already stored, nothing is written.
+		 * Later calls to create() for the same file will use the stored
+		 * fields and metadata instead of loading them from the file.
+		 *
+		 * NOTE: Fields with ListData icons can't be stored,
+		 * since the icons aren't serialized.
+		 *
+		 * @param file ROM file that was used to create the RomData object.
+		 * @param romData RomData object.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int updateDetectCache(LibRpBase::IRpFile *file, const LibRpBase::RomData *romData);
+
+		/**
+		 * Flags for createBatch().
+		 */
+		enum BatchFlags {
+			// Load the field data for each created RomData object.
+			BATCH_LOAD_FIELDS	= (1 << 0),
+
+			// Load the metadata for each created RomData object.
+			BATCH_LOAD_METADATA	= (1 << 1),
+		};
+
+		/**
+		 * createBatch() streaming callback.
+		 *
+		 * NOTE: This function is called from worker threads,
+		 * but calls are serialized, so only one callback runs
+		 * at any given time.
+		 *
+		 * @param idx Index of the file in the submitted list.
+		 * @param romData RomData subclass, or nullptr if the ROM isn't supported. (Callback takes ownership.)
+		 * @param userdata User data specified in createBatch().
+		 */
+		typedef void (*pfnBatchCallback_t)(unsigned int idx, LibRpBase::RomData *romData, void *userdata);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 *
+		 * Thread-safety: The RomDataFns tables are const and are never
+		 * modified after static initialization. The magic number index,
+		 * supported file extensions, and supported MIME types are built
+		 * using pthread_once(), and the configuration readers (Config,
+		 * KeyManager) are protected by an internal mutex, so create()
+		 * can be called from multiple threads concurrently.
+		 * Each IRpFile object must only appear once in the list,
+		 * since IRpFile objects are not thread-safe.
+		 *
+		 * @param files		[in] ROM files.
+		 * @param attrs		[in] RomDataAttr bitfield. (See create().)
+		 * @param flags		[in] BatchFlags bitfield.
+		 * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+		 * @return RomData subclasses, in submission order. (Entries may be nullptr.)
+		 */
+		static std::vector<LibRpBase::RomData*> createBatch(
+			const std::vector<LibRpBase::IRpFile*> &files,
+			unsigned int attrs = 0, unsigned int flags = 0,
+			unsigned int threads = 0);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 * Files are opened using RpFile with transparent gzip decompression.
+		 * (See the IRpFile version for thread-safety information.)
+		 *
+		 * @param filenames	[in] ROM filenames. (UTF-8)
+		 * @param attrs		[in] RomDataAttr bitfield. (See create().)
+		 * @param flags		[in] BatchFlags bitfield.
+		 * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+		 * @return RomData subclasses, in submission order. (Entries may be nullptr.)
+		 */
+		static std::vector<LibRpBase::RomData*> createBatch(
+			const std::vector<std::string> &filenames,
+			unsigned int attrs = 0, unsigned int flags = 0,
+			unsigned int threads = 0);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 * Results are passed to the callback function as they finish,
+		 * so they may not be in submission order.
+		 * (See the IRpFile version for thread-safety information.)
+		 *
+		 * @param files		[in] ROM files.
+		 * @param callback	[in] Callback function.
+		 * @param userdata	[in] User data for the callback function.
+		 * @param attrs		[in] RomDataAttr bitfield. (See create().)
+		 * @param flags		[in] BatchFlags bitfield.
+		 * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+		 */
+		static void createBatch(const std::vector<LibRpBase::IRpFile*> &files,
+			pfnBatchCallback_t callback, void *userdata,
+			unsigned int attrs = 0, unsigned int flags = 0,
+			unsigned int threads = 0);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 * Results are passed to the callback function as they finish,
+		 * so they may not be in submission order.
+		 * (See the IRpFile version for thread-safety information.)
+		 *
+		 * @param filenames	[in] ROM filenames. (UTF-8)
+		 * @param callback	[in] Callback function.
+		 * @param userdata	[in] User data for the callback function.
+		 * @param attrs		[in] RomDataAttr bitfield. (See create().)
+		 * @param flags		[in] BatchFlags bitfield.
+		 * @param threads	[in] Number of worker threads. (0 for the number of CPUs)
+		 */
+		static void createBatch(const std::vector<std::string> &filenames,
+			pfnBatchCallback_t callback, void *userdata,
+			unsigned int attrs = 0, unsigned int flags = 0,
+			unsigned int threads = 0);
+
 		struct ExtInfo {
 			const char *ext;
 			unsigned int attrs;
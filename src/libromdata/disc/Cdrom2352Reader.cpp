@@ -20,8 +20,14 @@
 // librpbase
 using namespace LibRpBase;
 
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("Cdrom2352Reader");
+
 class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		Cdrom2352ReaderPrivate(Cdrom2352Reader *q);
@@ -37,6 +43,9 @@ class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
 		// Physical block size.
 		static const unsigned int physBlockSize = 2352;
 
+		// Maximum number of physical blocks to read at once.
+		static const unsigned int maxBlocksPerRead = 32;
+
 		// Number of 2352-byte blocks.
 		unsigned int blockCount;
 };
@@ -48,9 +57,13 @@ const uint8_t Cdrom2352ReaderPrivate::CDROM_2352_MAGIC[12] =
 	{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
 
 Cdrom2352ReaderPrivate::Cdrom2352ReaderPrivate(Cdrom2352Reader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, blockCount(0)
-{ }
+{
+	// ISO-9660 directory walks use many small reads.
+	// Cache 64 2 KB blocks.
+	cacheLineCount = 64;
+}
 
 /** Cdrom2352Reader **/
 
@@ -144,4 +157,72 @@ off64_t Cdrom2352Reader::getPhysBlockAddr(uint32_t blockIdx) const
 	return (static_cast<off64_t>(blockIdx) * d->physBlockSize) + 16;
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Physical blocks are 2352 bytes, so they're never contiguous.
+ * Instead, multiple physical blocks are read at once, and the
+ * user data is copied from each block.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of bytes read.
+ */
+size_t Cdrom2352Reader::readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr)
+{
+	RP_D(Cdrom2352Reader);
+	static const unsigned int physBlockSize = Cdrom2352ReaderPrivate::physBlockSize;
+	assert(blockIdx + blockCount <= d->blockCount);
+	if (blockIdx >= d->blockCount) {
+		// Out of range.
+		return 0;
+	} else if (blockCount > d->blockCount - blockIdx) {
+		blockCount = d->blockCount - blockIdx;
+	}
+
+	const unsigned int maxBlocks = (blockCount < Cdrom2352ReaderPrivate::maxBlocksPerRead
+		? blockCount : Cdrom2352ReaderPrivate::maxBlocksPerRead);
+	unique_ptr<uint8_t[]> buf(new uint8_t[maxBlocks * physBlockSize]);
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	while (blockCount > 0) {
+		const unsigned int count = std::min(blockCount, maxBlocks);
+		const size_t sz_req = static_cast<size_t>(count) * physBlockSize;
+		const size_t sz_read = m_file->pread(
+			static_cast<off64_t>(blockIdx) * physBlockSize, buf.get(), sz_req);
+
+		// Copy the user data from each complete physical block.
+		// FIXME: Currently only supports Mode 1.
+		const unsigned int blocksRead = static_cast<unsigned int>(sz_read / physBlockSize);
+		const uint8_t *src = buf.get() + 16;
+		for (unsigned int i = 0; i < blocksRead; i++) {
+			memcpy(ptr8, src, d->block_size);
+			ptr8 += d->block_size;
+			src += physBlockSize;
+		}
+		ret += static_cast<size_t>(blocksRead) * d->block_size;
+
+		if (sz_read != sz_req) {
+			// Short read.
+			// Copy the user data that was read from the partial
+			// physical block, the same as readBlock() does.
+			const size_t sz_tail = sz_read % physBlockSize;
+			if (sz_tail > 16) {
+				const size_t sz_user = std::min<size_t>(sz_tail - 16, d->block_size);
+				memcpy(ptr8, src, sz_user);
+				ret += sz_user;
+			}
+			m_lastError = m_file->lastError();
+			break;
+		}
+
+		blockIdx += count;
+		blockCount -= count;
+	}
+
+	return ret;
+}
+
 }
@@ -64,6 +64,20 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		 * @return Physical address. (0 == empty block; -1 == invalid block index)
 		 */
 		off64_t getPhysBlockAddr(uint32_t blockIdx) const final;
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Physical blocks are 2352 bytes, so they're never contiguous.
+		 * Instead, multiple physical blocks are read at once, and the
+		 * user data is copied from each block.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of bytes read.
+		 */
+		size_t readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr) final;
 };
 
 }
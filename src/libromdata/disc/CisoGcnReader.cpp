@@ -23,6 +23,9 @@ using std::array;
 
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("CisoGcnReader");
+
 class CisoGcnReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		CisoGcnReaderPrivate(CisoGcnReader *q);
@@ -47,13 +50,17 @@ class CisoGcnReaderPrivate : public SparseDiscReaderPrivate {
 /** CisoGcnReaderPrivate **/
 
 CisoGcnReaderPrivate::CisoGcnReaderPrivate(CisoGcnReader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, maxLogicalBlockUsed(-1)
 {
 	// Clear the CISO header struct.
 	memset(&cisoHeader, 0, sizeof(cisoHeader));
 	// Clear the CISO block map initially.
 	blockMap.fill(0xFFFF);
+
+	// Blocks are usually large, so they're cached in 32 KB lines.
+	// Cache 16 lines for FST and partition header reads.
+	cacheLineCount = 16;
 }
 
 /** CisoGcnReader **/
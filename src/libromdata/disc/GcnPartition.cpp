@@ -11,6 +11,7 @@
 #include "GcnFst.hpp"
 
 // librpbase
+#include "librpbase/file/IoStats.hpp"
 using namespace LibRpBase;
 
 // C++ STL classes.
@@ -19,6 +20,9 @@ using std::unique_ptr;
 #include "GcnPartitionPrivate.hpp"
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("GcnPartition");
+
 /** GcnPartition **/
 
 /**
@@ -62,6 +66,7 @@ GcnPartition::GcnPartition(GcnPartitionPrivate *d, IDiscReader *discReader)
  */
 size_t GcnPartition::read(void *ptr, size_t size)
 {
+	IoStats::ReadScope ioScope(ioLayer);
 	assert(m_discReader != nullptr);
 	assert(m_discReader->isOpen());
 	if (!m_discReader || !m_discReader->isOpen()) {
@@ -71,7 +76,36 @@ size_t GcnPartition::read(void *ptr, size_t size)
 
 	// GCN partitions are stored as-is.
 	// TODO: data_size checks?
-	return m_discReader->read(ptr, size);
+	return ioScope.done(m_discReader->read(ptr, size));
+}
+
+/**
+ * Read data from the partition at the specified position.
+ * This does not change the partition position.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GcnPartition::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
+	RP_D(const GcnPartition);
+	assert(m_discReader != nullptr);
+	assert(m_discReader->isOpen());
+	if (!m_discReader || !m_discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	size_t ret = m_discReader->pread(d->data_offset + pos, ptr, size);
+	if (ret != size) {
+		m_lastError = m_discReader->lastError();
+	}
+	return ioScope.done(ret);
 }
 
 /**
@@ -81,6 +115,7 @@ size_t GcnPartition::read(void *ptr, size_t size)
  */
 int GcnPartition::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	RP_D(GcnPartition);
 	assert(m_discReader != nullptr);
 	assert(m_discReader->isOpen());
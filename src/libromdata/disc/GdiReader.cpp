@@ -27,6 +27,9 @@ using std::vector;
 
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("GdiReader");
+
 class GdiReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		GdiReaderPrivate(GdiReader *q);
@@ -88,9 +91,13 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 /** GdiReaderPrivate **/
 
 GdiReaderPrivate::GdiReaderPrivate(GdiReader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, blockCount(0)
-{ }
+{
+	// ISO-9660 directory walks use many small reads.
+	// Cache 64 2 KB blocks.
+	cacheLineCount = 64;
+}
 
 GdiReaderPrivate::~GdiReaderPrivate()
 {
@@ -559,11 +566,42 @@ int GdiReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size)
 		// Mode 1 data starts at byte 16; Mode 2 data starts at byte 24.
 		phys_pos += 16;
 	}
-	size_t sz_read = blockRange->file->seekAndRead(phys_pos, ptr, size);
+	size_t sz_read = blockRange->file->pread(phys_pos, ptr, size);
 	m_lastError = blockRange->file->lastError();
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Blocks may be stored in different track files,
+ * so each block is read using readBlock().
+ *
+ * @param blockIdx	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of bytes read.
+ */
+size_t GdiReader::readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr)
+{
+	RP_D(const GdiReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	for (; blockCount > 0; blockCount--, blockIdx++) {
+		const int rd = this->readBlock(blockIdx, ptr8, 0, block_size);
+		if (rd != static_cast<int>(block_size)) {
+			// Error reading the data.
+			return ret + (rd > 0 ? rd : 0);
+		}
+		ptr8 += block_size;
+		ret += block_size;
+	}
+
+	return ret;
+}
+
 /** GDI-specific functions. **/
 // TODO: "CdromReader" class?
 
@@ -84,6 +84,19 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		 */
 		int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size) final;
 
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Blocks may be stored in different track files,
+		 * so each block is read using readBlock().
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of bytes read.
+		 */
+		size_t readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr) final;
+
 	public:
 		/** GDI-specific functions. **/
 
@@ -20,6 +20,9 @@ using namespace LibRpBase;
 
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("NASOSReader");
+
 class NASOSReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		NASOSReaderPrivate(NASOSReader *q);
@@ -57,12 +60,16 @@ class NASOSReaderPrivate : public SparseDiscReaderPrivate {
 /** NASOSReaderPrivate **/
 
 NASOSReaderPrivate::NASOSReaderPrivate(NASOSReader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, discType(DT_UNKNOWN)
 	, blockMapShift(0)
 {
 	// Clear the NASOSHeader structs.
 	memset(&header, 0, sizeof(header));
+
+	// Blocks are 1 KB or 2 KB, and GcnFst reads are small.
+	// Cache 64 blocks.
+	cacheLineCount = 64;
 }
 
 /** NASOSReader **/
@@ -39,6 +39,12 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
 	, cipher(nullptr)
+	, cacheAddress(0)
+	, cacheLength(0)
+	, cipherKeyIdx(-1)
+	, ctrSection(N3DS_NCCH_SECTION_PLAIN)
+	, ctrBase(0)
+	, ctrNextAddress(~0U)
 	, tmd_content_index(0)
 	, isDebug(false)
 #endif /* ENABLE_DECRYPTION */
@@ -345,6 +351,103 @@ int NCCHReaderPrivate::findEncSection(uint32_t address) const
 	// Not an encrypted section.
 	return -1;
 }
+
+/**
+ * Decrypt data that was read from the ROM image.
+ * Data outside of encrypted sections is left as-is.
+ *
+ * NOTE: Address and size must both be multiples of 16.
+ *
+ * @param address	[in] Starting address, relative to the beginning of the NCCH.
+ * @param buf		[in/out] Data buffer.
+ * @param size		[in] Size of buf, in bytes.
+ */
+void NCCHReaderPrivate::decryptRange(uint32_t address, uint8_t *buf, size_t size)
+{
+	assert(address % 16 == 0);
+	assert(size % 16 == 0);
+
+	while (size > 0) {
+		const int sectIdx = findEncSection(address);
+		size_t sz;
+		if (sectIdx < 0) {
+			// Not in a defined section.
+			// Leave the data as-is up to the next section.
+			uint32_t next = address + static_cast<uint32_t>(size);
+			for (const auto &section : encSections) {
+				if (section.address > address && section.address < next) {
+					next = section.address;
+				}
+			}
+			sz = next - address;
+		} else {
+			const EncSection &section = encSections[sectIdx];
+			sz = section.address + section.length - address;
+			// Sections may end in the middle of an AES block.
+			// The next section always starts on a 16-byte boundary.
+			sz = ALIGN_BYTES(16, sz);
+			if (sz > size) {
+				sz = size;
+			}
+
+			if (section.section > N3DS_NCCH_SECTION_PLAIN) {
+				// Set the key if it changed.
+				if (cipherKeyIdx != section.keyIdx) {
+					cipher->setKey(ncch_keys[section.keyIdx].u8, sizeof(ncch_keys[section.keyIdx].u8));
+					cipherKeyIdx = section.keyIdx;
+					ctrNextAddress = ~0U;
+				}
+
+				// Set the counter if this isn't a continuation
+				// of the previous decryption.
+				if (ctrNextAddress != address ||
+				    ctrSection != section.section ||
+				    ctrBase != section.ctr_base)
+				{
+					u128_t ctr;
+					ctr.init_ctr(tid_be, section.section, address - section.ctr_base);
+					cipher->setIV(ctr.u8, sizeof(ctr.u8));
+					ctrSection = section.section;
+					ctrBase = section.ctr_base;
+				}
+
+				// Decrypt the data.
+				// The counter is automatically updated.
+				cipher->decrypt(buf, sz);
+				ctrNextAddress = address + static_cast<uint32_t>(sz);
+			}
+		}
+
+		address += static_cast<uint32_t>(sz);
+		buf += sz;
+		size -= sz;
+	}
+}
+
+/**
+ * Read and decrypt data from the ROM image.
+ * The data may span multiple sections.
+ *
+ * NOTE: Address and size must both be multiples of 16.
+ *
+ * @param address	[in] Starting address, relative to the beginning of the NCCH.
+ * @param buf		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read and decrypted. (Always a multiple of 16.)
+ */
+size_t NCCHReaderPrivate::readAndDecrypt(uint32_t address, uint8_t *buf, size_t size)
+{
+	// Read from the ROM image.
+	// This automatically removes the outer CIA
+	// title key encryption if it's present.
+	// NOTE: readFromROM() sets q->m_lastError on short reads.
+	size_t sz_read = readFromROM(address, buf, size);
+	sz_read &= ~static_cast<size_t>(15);
+	if (sz_read > 0) {
+		decryptRange(address, buf, sz_read);
+	}
+	return sz_read;
+}
 #endif /* ENABLE_DECRYPTION */
 
 /**
@@ -577,69 +680,56 @@ size_t NCCHReader::read(void *ptr, size_t size)
 	}
 
 #ifdef ENABLE_DECRYPTION
-	// TODO: Handle reads that aren't a multiple of 16 bytes.
-	assert(d->pos % 16 == 0);
-	assert(size % 16 == 0);
-	if (d->pos % 16 != 0 || size % 16 != 0) {
-		// Cannot read now.
-		return 0;
-	}
-
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t sz_total_read = 0;
 	while (size > 0) {
-		// Determine what section we're in.
-		int sectIdx = d->findEncSection(d->pos);
-		const NCCHReaderPrivate::EncSection *section = (
-			sectIdx >= 0 ? &d->encSections.at(sectIdx) : nullptr);
-
-		size_t sz_to_read = 0;
-		if (!section) {
-			// Not in a defined section.
-			// TODO: Handle this?
-			assert(!"Reading in an undefined section.");
-			return sz_total_read;
-		} else {
-			// We're in an encrypted section.
-			uint32_t section_offset = static_cast<uint32_t>(d->pos - section->address);
-			if (section_offset + size <= section->length) {
-				// Remainder of reading is in this section.
-				sz_to_read = size;
-			} else {
-				// We're reading past the end of this section.
-				sz_to_read = section->length - section_offset;
+		// Check the decrypted block cache.
+		if (d->cacheLength > 0 && d->pos >= d->cacheAddress &&
+		    d->pos < d->cacheAddress + d->cacheLength)
+		{
+			const uint32_t cache_offset = d->pos - d->cacheAddress;
+			size_t sz = d->cacheLength - cache_offset;
+			if (sz > size) {
+				sz = size;
 			}
+			memcpy(ptr8, &d->cacheData[cache_offset], sz);
+			d->pos += static_cast<uint32_t>(sz);
+			ptr8 += sz;
+			sz_total_read += sz;
+			size -= sz;
+			continue;
 		}
 
-		// Read from the ROM image.
-		// This automatically removes the outer CIA
-		// title key encryption if it's present.
-		size_t ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
-
-		if (section && section->section > N3DS_NCCH_SECTION_PLAIN) {
-			// Set the required key.
-			// TODO: Don't set the key if it hasn't changed.
-			d->cipher->setKey(d->ncch_keys[section->keyIdx].u8, sizeof(d->ncch_keys[section->keyIdx].u8));
-
-			// Initialize the counter based on section and offset.
-			u128_t ctr;
-			ctr.init_ctr(d->tid_be, section->section, d->pos - section->ctr_base);
-			d->cipher->setIV(ctr.u8, sizeof(ctr.u8));
-
-			// Decrypt the data.
-			// FIXME: Round up to 16 if a short read occurred?
-			ret_sz = d->cipher->decrypt(static_cast<uint8_t*>(ptr), ret_sz);
+		const uint32_t blockAddress = d->pos & ~(NCCHReaderPrivate::CACHE_BLOCK_SIZE - 1);
+		if (d->pos == blockAddress && size >= NCCHReaderPrivate::CACHE_BLOCK_SIZE) {
+			// Reading one or more full blocks.
+			// Decrypt directly into the output buffer.
+			const size_t sz = size & ~static_cast<size_t>(NCCHReaderPrivate::CACHE_BLOCK_SIZE - 1);
+			const size_t ret_sz = d->readAndDecrypt(d->pos, ptr8, sz);
+			d->pos += static_cast<uint32_t>(ret_sz);
+			ptr8 += ret_sz;
+			sz_total_read += ret_sz;
+			size -= ret_sz;
+			if (ret_sz != sz) {
+				// Short read.
+				break;
+			}
+			continue;
 		}
 
-		d->pos += static_cast<uint32_t>(ret_sz);
-		ptr8 += ret_sz;
-		sz_total_read += ret_sz;
-		size -= ret_sz;
-		if (d->pos > d->ncch_length) {
-			d->pos = d->ncch_length;
-			break;
+		// Load the block into the cache.
+		if (!d->cacheData) {
+			d->cacheData.reset(new uint8_t[NCCHReaderPrivate::CACHE_BLOCK_SIZE]);
+		}
+		uint32_t sz_block = d->ncch_length - blockAddress;
+		if (sz_block > NCCHReaderPrivate::CACHE_BLOCK_SIZE) {
+			sz_block = NCCHReaderPrivate::CACHE_BLOCK_SIZE;
 		}
-		if (ret_sz != sz_to_read) {
+		sz_block &= ~15U;
+		d->cacheAddress = blockAddress;
+		d->cacheLength = static_cast<uint32_t>(
+			d->readAndDecrypt(blockAddress, d->cacheData.get(), sz_block));
+		if (d->pos >= d->cacheAddress + d->cacheLength) {
 			// Short read.
 			break;
 		}
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 // C++ includes.
+#include <memory>
 #include <vector>
 
 #ifdef ENABLE_DECRYPTION
@@ -153,6 +154,47 @@ class NCCHReaderPrivate
 		 */
 		int findEncSection(uint32_t address) const;
 
+		// Decrypted block cache.
+		// Reads smaller than a block are serviced from this cache.
+		// Each block is read and decrypted in a single pass.
+		static const uint32_t CACHE_BLOCK_SIZE = 64 * 1024;
+		std::unique_ptr<uint8_t[]> cacheData;	// Allocated on first use.
+		uint32_t cacheAddress;	// NCCH-relative address of the cached block.
+		uint32_t cacheLength;	// Amount of valid data in the cache. (0 if empty)
+
+		// Current cipher state.
+		// Used to skip setKey() and setIV() if the key and
+		// counter haven't changed since the last decryption.
+		int cipherKeyIdx;		// ncch_keys[] index, or -1 if not set.
+		uint8_t ctrSection;		// N3DS_NCCH_Sections
+		uint32_t ctrBase;		// Counter base address.
+		uint32_t ctrNextAddress;	// Next address for the counter, or ~0U if not set.
+
+		/**
+		 * Decrypt data that was read from the ROM image.
+		 * Data outside of encrypted sections is left as-is.
+		 *
+		 * NOTE: Address and size must both be multiples of 16.
+		 *
+		 * @param address	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param buf		[in/out] Data buffer.
+		 * @param size		[in] Size of buf, in bytes.
+		 */
+		void decryptRange(uint32_t address, uint8_t *buf, size_t size);
+
+		/**
+		 * Read and decrypt data from the ROM image.
+		 * The data may span multiple sections.
+		 *
+		 * NOTE: Address and size must both be multiples of 16.
+		 *
+		 * @param address	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param buf		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read and decrypted. (Always a multiple of 16.)
+		 */
+		size_t readAndDecrypt(uint32_t address, uint8_t *buf, size_t size);
+
 		// TMD content index.
 		uint16_t tmd_content_index;
 
@@ -16,6 +16,9 @@ using namespace LibRpBase;
 
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("WbfsReader");
+
 class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		WbfsReaderPrivate(WbfsReader *q);
@@ -82,11 +85,15 @@ class WbfsReaderPrivate : public SparseDiscReaderPrivate {
 const uint8_t WbfsReaderPrivate::WBFS_MAGIC[4] = {'W','B','F','S'};
 
 WbfsReaderPrivate::WbfsReaderPrivate(WbfsReader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, m_wbfs(nullptr)
 	, m_wbfs_disc(nullptr)
 	, wlba_table(nullptr)
-{ }
+{
+	// Blocks are usually large, so they're cached in 32 KB lines.
+	// Cache 16 lines for FST and partition header reads.
+	cacheLineCount = 16;
+}
 
 WbfsReaderPrivate::~WbfsReaderPrivate()
 {
@@ -14,18 +14,31 @@
 
 // librpbase
 #include "librpbase/crypto/KeyManager.hpp"
+#include "librpbase/crypto/Sha1.hpp"
+#include "librpbase/file/IoStats.hpp"
 #ifdef ENABLE_DECRYPTION
 # include "librpbase/crypto/IAesCipher.hpp"
 # include "librpbase/crypto/AesCipherFactory.hpp"
 #endif /* ENABLE_DECRYPTION */
 using namespace LibRpBase;
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+
+// C++ includes.
+#include <algorithm>
+
 // C++ STL classes.
 using std::unique_ptr;
+using std::vector;
 
 #include "GcnPartitionPrivate.hpp"
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("WiiPartition");
+
 #define SECTOR_SIZE_ENCRYPTED 0x8000
 #define SECTOR_SIZE_DECRYPTED 0x7C00
 #define SECTOR_SIZE_DECRYPTED_OFFSET 0x400
@@ -68,20 +81,97 @@ class WiiPartitionPrivate : public GcnPartitionPrivate
 		// NOTE: Actual read position if ((cryptoMethod & CM_MASK_SECTOR) == CM_32K).
 		off64_t pos_7C00;
 
-		// Decrypted sector cache.
+		// Decrypted sector cache. (LRU)
 		// NOTE: Actual data starts at 0x400.
 		// Hashes and the sector IV are stored first.
-		uint32_t sector_num;				// Sector number.
-		uint8_t sector_buf[SECTOR_SIZE_ENCRYPTED];	// Decrypted sector data.
+		static const unsigned int SECTOR_CACHE_COUNT = 8;
+		struct SectorCacheEntry {
+			uint32_t sector_num;			// Sector number. (~0 if unused)
+			uint64_t lastUse;			// LRU counter value at last use.
+			uint8_t data[SECTOR_SIZE_ENCRYPTED];	// Decrypted sector data.
+		};
+		SectorCacheEntry sectorCache[SECTOR_CACHE_COUNT];
+		uint64_t sectorLruCounter;
+
+		// Buffer for reading multiple sectors at once.
+		// Allocated on first use.
+		static const unsigned int SECTOR_BATCH_COUNT = 32;
+		unique_ptr<uint8_t[]> batch_buf;
+
+		// Sector cache mutex.
+		// Locked by WiiPartition::pread() while using the sector cache
+		// and batch_buf, since multiple threads may read from this partition.
+		Mutex sectorMutex;
 
 		/**
 		 * Read and decrypt a sector.
-		 * The decrypted sector is stored in sector_buf.
+		 * The decrypted sector is stored in the sector cache.
 		 *
 		 * @param sector_num Sector number. (address / 0x7C00)
-		 * @return 0 on success; negative POSIX error code on error.
+		 * @return Decrypted sector, or nullptr on error.
+		 */
+		const uint8_t *readSector(uint32_t sector_num);
+
+		/**
+		 * Read and decrypt multiple consecutive sectors.
+		 * The sectors are read from the disc using a single read,
+		 * and the user data is copied to the output buffer.
+		 * The sector cache is not used.
+		 *
+		 * @param sector_num	[in] First sector number. (address / 0x7C00)
+		 * @param count		[in] Number of sectors. (Must be <= SECTOR_BATCH_COUNT!)
+		 * @param ptr		[out] Output buffer. (Must be at least count * sector data size bytes!)
+		 * @return Number of sectors read and decrypted.
+		 */
+		unsigned int readSectors(uint32_t sector_num, unsigned int count, uint8_t *ptr);
+
+	public:
+		/** Hash verification **/
+
+		// Number of clusters in each H3 group.
+		static const unsigned int CLUSTERS_PER_GROUP = 64;
+
+		/**
+		 * Hash verification job.
 		 */
-		int readSector(uint32_t sector_num);
+		struct VerifyJob {
+			WiiPartitionPrivate *d;
+			IDiscReader *discReader;
+			off64_t data_addr;		// Address of the partition data on the disc.
+			const uint8_t *h3_table;	// H3 table. (RVL_H3_TABLE_SIZE bytes)
+			uint32_t clusterCount;		// Number of clusters.
+			uint32_t nextGroup;		// Next group to read. (protected by sectorMutex)
+			bool isCrypted;			// True if clusters must be decrypted.
+		};
+
+		/**
+		 * Hash verification worker.
+		 * Each worker thread has its own cipher and results.
+		 */
+		struct VerifyWorker {
+			VerifyJob *job;
+#ifdef ENABLE_DECRYPTION
+			unique_ptr<IAesCipher> cipher;
+#endif /* ENABLE_DECRYPTION */
+			vector<uint32_t> badClusters;
+		};
+
+		/**
+		 * Verify a decrypted cluster's hashes.
+		 * @param cluster	[in] Decrypted cluster. (SECTOR_SIZE_ENCRYPTED bytes)
+		 * @param cluster_num	[in] Cluster number.
+		 * @param h3_table	[in] H3 table. (RVL_H3_TABLE_SIZE bytes)
+		 * @return True if all hashes are valid; false if not.
+		 */
+		static bool verifyCluster(const uint8_t *cluster, uint32_t cluster_num, const uint8_t *h3_table);
+
+		/**
+		 * Hash verification worker thread function.
+		 * Groups are read in order, so the disc is read sequentially
+		 * while other workers decrypt and hash the groups they read.
+		 * @param arg VerifyWorker.
+		 */
+		static void verifyWorker(void *arg);
 
 #ifdef ENABLE_DECRYPTION
 	public:
@@ -163,7 +253,7 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKeyReal(WiiPartition::ENCKEY_UNKNOWN)
 	, cryptoMethod(cryptoMethod)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, sectorLruCounter(0)
 	, aes_title(nullptr)
 #else /* !ENABLE_DECRYPTION */
 	, verifyResult(KeyManager::VERIFY_NO_SUPPORT)
@@ -171,7 +261,7 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKeyReal(WiiPartition::ENCKEY_UNKNOWN)
 	, cryptoMethod(cryptoMethod)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, sectorLruCounter(0)
 #endif /* ENABLE_DECRYPTION */
 {
 	// NOTE: The discReader parameter is needed because
@@ -191,6 +281,12 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	// Clear the partition header struct.
 	memset(&partitionHeader, 0, sizeof(partitionHeader));
 
+	// Clear the sector cache.
+	for (unsigned int i = 0; i < SECTOR_CACHE_COUNT; i++) {
+		sectorCache[i].sector_num = ~0U;
+		sectorCache[i].lastUse = 0;
+	}
+
 	// Partition header will be read in the WiiPartition constructor.
 }
 
@@ -350,7 +446,8 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 
 	// Read sector 0, which contains a disc header.
 	// NOTE: readSector() doesn't check verifyResult.
-	if (readSector(0) != 0) {
+	const uint8_t *const sector0 = readSector(0);
+	if (!sector0) {
 		// Error reading sector 0.
 		delete aes_title;
 		aes_title = nullptr;
@@ -361,7 +458,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	// Verify that this is a Wii partition.
 	// If it isn't, the key is probably wrong.
 	const GCN_DiscHeader *discHeader =
-		reinterpret_cast<const GCN_DiscHeader*>(&sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET]);
+		reinterpret_cast<const GCN_DiscHeader*>(&sector0[SECTOR_SIZE_DECRYPTED_OFFSET]);
 	if (discHeader->magic_wii != cpu_to_be32(WII_MAGIC)) {
 		// Invalid disc header.
 		verifyResult = KeyManager::VERIFY_WRONG_KEY;
@@ -383,16 +480,25 @@ WiiPartitionPrivate::~WiiPartitionPrivate()
 
 /**
  * Read and decrypt a sector.
- * The decrypted sector is stored in sector_buf.
+ * The decrypted sector is stored in the sector cache.
  *
  * @param sector_num Sector number. (address / 0x7C00)
- * @return 0 on success; negative POSIX error code on error.
+ * @return Decrypted sector, or nullptr on error.
  */
-int WiiPartitionPrivate::readSector(uint32_t sector_num)
+const uint8_t *WiiPartitionPrivate::readSector(uint32_t sector_num)
 {
-	if (this->sector_num == sector_num) {
-		// Sector is already in memory.
-		return 0;
+	// Check if the sector is already cached.
+	// If not, the least recently used entry will be replaced.
+	SectorCacheEntry *entry = &sectorCache[0];
+	for (unsigned int i = 0; i < SECTOR_CACHE_COUNT; i++) {
+		if (sectorCache[i].sector_num == sector_num) {
+			// Sector is already in memory.
+			sectorCache[i].lastUse = ++sectorLruCounter;
+			return sectorCache[i].data;
+		}
+		if (sectorCache[i].lastUse < entry->lastUse) {
+			entry = &sectorCache[i];
+		}
 	}
 
 	RP_Q(WiiPartition);
@@ -401,7 +507,7 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	if (isCrypted) {
 		// Decryption is disabled.
 		q->m_lastError = EIO;
-		return -1;
+		return nullptr;
 	}
 #endif /* !ENABLE_DECRYPTION */
 
@@ -411,18 +517,13 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	off64_t sector_addr = partition_offset + data_offset;
 	sector_addr += (static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
 
-	int ret = q->m_discReader->seek(sector_addr);
-	if (ret != 0) {
-		q->m_lastError = q->m_discReader->lastError();
-		return ret;
-	}
-
-	size_t sz = q->m_discReader->read(sector_buf, sizeof(sector_buf));
+	uint8_t *const sector_buf = entry->data;
+	entry->sector_num = ~0U;
+	size_t sz = q->m_discReader->pread(sector_addr, sector_buf, SECTOR_SIZE_ENCRYPTED);
 	if (sz != SECTOR_SIZE_ENCRYPTED) {
 		// sector_buf may be invalid.
-		this->sector_num = ~0;
 		q->m_lastError = EIO;
-		return -1;
+		return nullptr;
 	}
 
 #ifdef ENABLE_DECRYPTION
@@ -432,16 +533,191 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 		    &sector_buf[0x3D0], 16) != SECTOR_SIZE_DECRYPTED)
 		{
 			// sector_buf may be invalid.
-			this->sector_num = ~0;
 			q->m_lastError = EIO;
-			return -1;
+			return nullptr;
 		}
 	}
 #endif /* ENABLE_DECRYPTION */
 
 	// Sector read and decrypted.
-	this->sector_num = sector_num;
-	return 0;
+	entry->sector_num = sector_num;
+	entry->lastUse = ++sectorLruCounter;
+	return sector_buf;
+}
+
+/**
+ * Read and decrypt multiple consecutive sectors.
+ * The sectors are read from the disc using a single read,
+ * and the user data is copied to the output buffer.
+ * The sector cache is not used.
+ *
+ * @param sector_num	[in] First sector number. (address / 0x7C00)
+ * @param count		[in] Number of sectors. (Must be <= SECTOR_BATCH_COUNT!)
+ * @param ptr		[out] Output buffer. (Must be at least count * sector data size bytes!)
+ * @return Number of sectors read and decrypted.
+ */
+unsigned int WiiPartitionPrivate::readSectors(uint32_t sector_num, unsigned int count, uint8_t *ptr)
+{
+	RP_Q(WiiPartition);
+	assert(count <= SECTOR_BATCH_COUNT);
+	if (count > SECTOR_BATCH_COUNT) {
+		count = SECTOR_BATCH_COUNT;
+	}
+
+	off64_t sector_addr = partition_offset + data_offset;
+	sector_addr += (static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
+	const size_t sz_req = static_cast<size_t>(count) * SECTOR_SIZE_ENCRYPTED;
+
+	if ((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K) {
+		// Full 32K sectors. (implies no encryption)
+		// Read directly into the output buffer.
+		const size_t sz = q->m_discReader->pread(sector_addr, ptr, sz_req);
+		if (sz != sz_req) {
+			q->m_lastError = EIO;
+		}
+		return static_cast<unsigned int>(sz / SECTOR_SIZE_ENCRYPTED);
+	}
+
+	const bool isCrypted = ((cryptoMethod & WiiPartition::CM_MASK_ENCRYPTED) == WiiPartition::CM_ENCRYPTED);
+#ifndef ENABLE_DECRYPTION
+	if (isCrypted) {
+		// Decryption is disabled.
+		q->m_lastError = EIO;
+		return 0;
+	}
+#endif /* !ENABLE_DECRYPTION */
+
+	if (!batch_buf) {
+		batch_buf.reset(new uint8_t[SECTOR_BATCH_COUNT * SECTOR_SIZE_ENCRYPTED]);
+	}
+	const size_t sz = q->m_discReader->pread(sector_addr, batch_buf.get(), sz_req);
+	if (sz != sz_req) {
+		q->m_lastError = EIO;
+	}
+
+	// Decrypt each sector's user data and copy it to the output buffer.
+	// NOTE: Each sector's IV is stored in its (encrypted) hash block.
+	const unsigned int sectorsRead = static_cast<unsigned int>(sz / SECTOR_SIZE_ENCRYPTED);
+	uint8_t *sector_buf = batch_buf.get();
+	for (unsigned int i = 0; i < sectorsRead; i++, sector_buf += SECTOR_SIZE_ENCRYPTED) {
+#ifdef ENABLE_DECRYPTION
+		if (isCrypted) {
+			if (aes_title->decrypt(&sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED,
+			    &sector_buf[0x3D0], 16) != SECTOR_SIZE_DECRYPTED)
+			{
+				// Decryption failed.
+				q->m_lastError = EIO;
+				return i;
+			}
+		}
+#endif /* ENABLE_DECRYPTION */
+		memcpy(ptr, &sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED);
+		ptr += SECTOR_SIZE_DECRYPTED;
+	}
+
+	return sectorsRead;
+}
+
+/**
+ * Verify a decrypted cluster's hashes.
+ * @param cluster	[in] Decrypted cluster. (SECTOR_SIZE_ENCRYPTED bytes)
+ * @param cluster_num	[in] Cluster number.
+ * @param h3_table	[in] H3 table. (RVL_H3_TABLE_SIZE bytes)
+ * @return True if all hashes are valid; false if not.
+ */
+bool WiiPartitionPrivate::verifyCluster(const uint8_t *cluster, uint32_t cluster_num, const uint8_t *h3_table)
+{
+	const RVL_HashBlock *const hashBlock = reinterpret_cast<const RVL_HashBlock*>(cluster);
+	const uint8_t *const data = &cluster[SECTOR_SIZE_DECRYPTED_OFFSET];
+	uint8_t digest[Sha1::DIGEST_SIZE];
+
+	// H0: Hashes of each 1 KB data block.
+	for (unsigned int i = 0; i < ARRAY_SIZE(hashBlock->h0); i++) {
+		Sha1::hash(&data[i * 0x400], 0x400, digest);
+		if (memcmp(digest, hashBlock->h0[i], sizeof(digest)) != 0) {
+			return false;
+		}
+	}
+
+	// H1: Hash of this cluster's H0 table.
+	Sha1::hash(hashBlock->h0, sizeof(hashBlock->h0), digest);
+	if (memcmp(digest, hashBlock->h1[cluster_num % 8], sizeof(digest)) != 0) {
+		return false;
+	}
+
+	// H2: Hash of this subgroup's H1 table.
+	Sha1::hash(hashBlock->h1, sizeof(hashBlock->h1), digest);
+	if (memcmp(digest, hashBlock->h2[(cluster_num / 8) % 8], sizeof(digest)) != 0) {
+		return false;
+	}
+
+	// H3: Hash of this group's H2 table.
+	const unsigned int group = cluster_num / CLUSTERS_PER_GROUP;
+	if (group >= RVL_H3_TABLE_SIZE / Sha1::DIGEST_SIZE) {
+		// Out of range.
+		return false;
+	}
+	Sha1::hash(hashBlock->h2, sizeof(hashBlock->h2), digest);
+	return (memcmp(digest, &h3_table[group * Sha1::DIGEST_SIZE], sizeof(digest)) == 0);
+}
+
+/**
+ * Hash verification worker thread function.
+ * Groups are read in order, so the disc is read sequentially
+ * while other workers decrypt and hash the groups they read.
+ * @param arg VerifyWorker.
+ */
+void WiiPartitionPrivate::verifyWorker(void *arg)
+{
+	VerifyWorker *const worker = static_cast<VerifyWorker*>(arg);
+	VerifyJob *const job = worker->job;
+
+	unique_ptr<uint8_t[]> buf(new uint8_t[CLUSTERS_PER_GROUP * SECTOR_SIZE_ENCRYPTED]);
+	while (true) {
+		// Read the next group.
+		// NOTE: The disc reader is shared with WiiPartition::pread().
+		uint32_t first, count;
+		size_t sz;
+		{
+			MutexLocker sectorLock(job->d->sectorMutex);
+			first = job->nextGroup * CLUSTERS_PER_GROUP;
+			if (first >= job->clusterCount)
+				break;
+			job->nextGroup++;
+
+			count = job->clusterCount - first;
+			if (count > CLUSTERS_PER_GROUP) {
+				count = CLUSTERS_PER_GROUP;
+			}
+			sz = job->discReader->pread(
+				job->data_addr + (static_cast<off64_t>(first) * SECTOR_SIZE_ENCRYPTED),
+				buf.get(), static_cast<size_t>(count) * SECTOR_SIZE_ENCRYPTED);
+		}
+
+		// Clusters that couldn't be read are bad.
+		const unsigned int clustersRead = static_cast<unsigned int>(sz / SECTOR_SIZE_ENCRYPTED);
+		uint8_t *cluster = buf.get();
+		for (unsigned int i = 0; i < count; i++, cluster += SECTOR_SIZE_ENCRYPTED) {
+			bool ok = (i < clustersRead);
+#ifdef ENABLE_DECRYPTION
+			if (ok && job->isCrypted) {
+				// Decrypt the data using the IV from the encrypted
+				// hash block, then decrypt the hash block.
+				uint8_t iv[16];
+				memcpy(iv, &cluster[0x3D0], sizeof(iv));
+				ok = (worker->cipher->decrypt(&cluster[SECTOR_SIZE_DECRYPTED_OFFSET],
+					SECTOR_SIZE_DECRYPTED, iv, sizeof(iv)) == SECTOR_SIZE_DECRYPTED);
+				memset(iv, 0, sizeof(iv));
+				ok = ok && (worker->cipher->decrypt(cluster,
+					SECTOR_SIZE_DECRYPTED_OFFSET, iv, sizeof(iv)) == SECTOR_SIZE_DECRYPTED_OFFSET);
+			}
+#endif /* ENABLE_DECRYPTION */
+
+			if (!ok || !verifyCluster(cluster, first + i, job->h3_table)) {
+				worker->badClusters.push_back(first + i);
+			}
+		}
+	}
 }
 
 /** WiiPartition **/
@@ -500,9 +776,7 @@ WiiPartition::WiiPartition(IDiscReader *discReader, off64_t partition_offset,
 	}
 
 	d->partition_size = d->data_size + d->data_offset;
-#ifdef ENABLE_DECRYPTION
 	d->pos_7C00 = 0;
-#endif /* ENABLE_DECRYPTION */
 
 	// Encryption will not be initialized until
 	// read() is called.
@@ -521,85 +795,53 @@ WiiPartition::~WiiPartition()
  */
 size_t WiiPartition::read(void *ptr, size_t size)
 {
+	RP_D(WiiPartition);
+	size_t ret = this->pread(d->pos_7C00, ptr, size);
+	d->pos_7C00 += ret;
+	return ret;
+}
+
+/**
+ * Read data from the partition at the specified position.
+ * This does not change the partition position.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t WiiPartition::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
 	RP_D(WiiPartition);
 	assert(m_discReader != nullptr);
 	assert(m_discReader->isOpen());
 	if (!m_discReader || !m_discReader->isOpen()) {
 		m_lastError = EBADF;
 		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
 	}
 
-	// TODO: Consolidate this code and optimize it.
-	size_t ret = 0;
-	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
-
 	// Are we already at the end of the file?
-	if (d->pos_7C00 >= d->data_size)
+	if (pos >= d->data_size)
 		return 0;
 
-	// Make sure d->pos_7C00 + size <= d->data_size.
+	// Make sure pos + size <= d->data_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos_7C00 + static_cast<off64_t>(size) >= d->data_size) {
-		size = static_cast<size_t>(d->data_size - d->pos_7C00);
+	if (pos + static_cast<off64_t>(size) >= d->data_size) {
+		size = static_cast<size_t>(d->data_size - pos);
 	}
 
+	// The sector cache and decryption state are shared.
+	MutexLocker sectorLock(d->sectorMutex);
+
+	// Sector size and data offset within sector_buf.
+	unsigned int sector_size, sector_data_offset;
 	if ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K) {
 		// Full 32K sectors. (implies no encryption)
-
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_ENCRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_ENCRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf[blockStartOffset], read_sz);
-
-			// Starting block read.
-			size -= read_sz;
-			ptr8 += read_sz;
-			ret += read_sz;
-			d->pos_7C00 += read_sz;
-		}
-
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_ENCRYPTED;
-		     size -= SECTOR_SIZE_ENCRYPTED, ptr8 += SECTOR_SIZE_ENCRYPTED,
-		     ret += SECTOR_SIZE_ENCRYPTED, d->pos_7C00 += SECTOR_SIZE_ENCRYPTED)
-		{
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-
-			// Read the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf, SECTOR_SIZE_ENCRYPTED);
-		}
-
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
-
-			// Read the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockEnd);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf[blockStartOffset], size);
-
-			ret += size;
-			d->pos_7C00 += size;
-		}
+		sector_size = SECTOR_SIZE_ENCRYPTED;
+		sector_data_offset = 0;
 	} else {
 		if ((d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED) {
 #ifdef ENABLE_DECRYPTION
@@ -611,7 +853,7 @@ size_t WiiPartition::read(void *ptr, size_t size)
 						// Decryption could not be initialized.
 						// TODO: Better error?
 						m_lastError = EIO;
-						return -m_lastError;
+						return 0;
 					}
 					break;
 
@@ -623,73 +865,66 @@ size_t WiiPartition::read(void *ptr, size_t size)
 					// Decryption failed to initialize.
 					// TODO: Better error?
 					m_lastError = EIO;
-					return -m_lastError;
+					return 0;
 			}
 #else /* !ENABLE_DECRYPTION */
 			// Decryption is not enabled.
 			m_lastError = EIO;
-			ret = 0;
+			return 0;
 #endif /* ENABLE_DECRYPTION */
 		}
 
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_DECRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_DECRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET + blockStartOffset], read_sz);
+		sector_size = SECTOR_SIZE_DECRYPTED;
+		sector_data_offset = SECTOR_SIZE_DECRYPTED_OFFSET;
+	}
 
-			// Starting block read.
+	size_t ret = 0;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	while (size > 0) {
+		const uint32_t sector_num = static_cast<uint32_t>(pos / sector_size);
+		const unsigned int sectorOffset = static_cast<unsigned int>(pos % sector_size);
+
+		if (sectorOffset == 0 && size >= sector_size) {
+			// Read and decrypt multiple full sectors at once.
+			size_t count = size / sector_size;
+			if (count > WiiPartitionPrivate::SECTOR_BATCH_COUNT) {
+				count = WiiPartitionPrivate::SECTOR_BATCH_COUNT;
+			}
+			const unsigned int sectorsRead = d->readSectors(sector_num, static_cast<unsigned int>(count), ptr8);
+			const size_t read_sz = static_cast<size_t>(sectorsRead) * sector_size;
 			size -= read_sz;
 			ptr8 += read_sz;
 			ret += read_sz;
-			d->pos_7C00 += read_sz;
+			pos += read_sz;
+			if (sectorsRead != count) {
+				// Error reading the sectors.
+				break;
+			}
+			continue;
 		}
 
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_DECRYPTED;
-		size -= SECTOR_SIZE_DECRYPTED, ptr8 += SECTOR_SIZE_DECRYPTED,
-		ret += SECTOR_SIZE_DECRYPTED, d->pos_7C00 += SECTOR_SIZE_DECRYPTED)
-		{
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], SECTOR_SIZE_DECRYPTED);
+		// Read and decrypt the sector.
+		const uint8_t *const sector_buf = d->readSector(sector_num);
+		if (!sector_buf) {
+			// Error reading the sector.
+			break;
 		}
 
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
-
-			// Read and decrypt the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockEnd);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf[SECTOR_SIZE_DECRYPTED_OFFSET], size);
-
-			ret += size;
-			d->pos_7C00 += size;
+		// Copy data from the sector.
+		size_t read_sz = sector_size - sectorOffset;
+		if (size < read_sz) {
+			read_sz = size;
 		}
+		memcpy(ptr8, &sector_buf[sector_data_offset + sectorOffset], read_sz);
+
+		size -= read_sz;
+		ptr8 += read_sz;
+		ret += read_sz;
+		pos += read_sz;
 	}
 
 	// Finished reading the data.
-	return ret;
+	return ioScope.done(ret);
 }
 
 /**
@@ -699,6 +934,7 @@ size_t WiiPartition::read(void *ptr, size_t size)
  */
 int WiiPartition::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	RP_D(WiiPartition);
 	assert(m_discReader != nullptr);
 	assert(m_discReader->isOpen());
@@ -831,6 +1067,146 @@ const RVL_TMD_Header *WiiPartition::tmdHeader(void) const
 		: nullptr);
 }
 
+/**
+ * Verify the partition's hash tree.
+ *
+ * Each cluster's H0 hashes are checked against its data,
+ * and its H1, H2, and H3 hashes are checked against the
+ * next level down. The H3 table is checked against the
+ * TMD content hash.
+ *
+ * Groups of clusters are read sequentially and decrypted
+ * and hashed by multiple worker threads. The calling
+ * thread is used as one of the worker threads.
+ *
+ * @param pResult	[out] Verification result.
+ * @param threads	[in,opt] Number of worker threads. (0 for the number of CPUs)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartition::verifyHashes(HashVerifyResult *pResult, unsigned int threads)
+{
+	RP_D(WiiPartition);
+	assert(pResult != nullptr);
+	assert(m_discReader != nullptr);
+	assert(m_discReader->isOpen());
+	if (!pResult) {
+		return -EINVAL;
+	} else if (!m_discReader || !m_discReader->isOpen()) {
+		m_lastError = EBADF;
+		return -EBADF;
+	} else if ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K) {
+		// Full 32K sectors don't have hashes.
+		return -ENOTSUP;
+	}
+
+	const bool isCrypted = ((d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED);
+	if (isCrypted) {
+#ifdef ENABLE_DECRYPTION
+		// Make sure decryption is initialized.
+		MutexLocker sectorLock(d->sectorMutex);
+		if (d->initDecryption() != KeyManager::VERIFY_OK) {
+			m_lastError = EIO;
+			return -EIO;
+		}
+#else /* !ENABLE_DECRYPTION */
+		// Decryption is not enabled.
+		return -ENOTSUP;
+#endif /* ENABLE_DECRYPTION */
+	}
+
+	// Read the H3 table.
+	unique_ptr<uint8_t[]> h3_table(new uint8_t[RVL_H3_TABLE_SIZE]);
+	{
+		const off64_t h3_addr = d->partition_offset +
+			(static_cast<off64_t>(be32_to_cpu(d->partitionHeader.h3_table_offset)) << 2);
+		MutexLocker sectorLock(d->sectorMutex);
+		size_t size = m_discReader->pread(h3_addr, h3_table.get(), RVL_H3_TABLE_SIZE);
+		if (size != RVL_H3_TABLE_SIZE) {
+			m_lastError = EIO;
+			return -EIO;
+		}
+	}
+
+	// Check the H3 table against the TMD content hash.
+	pResult->h3TableOK = false;
+	const RVL_TMD_Header *const tmdHeader = this->tmdHeader();
+	if (tmdHeader && be16_to_cpu(tmdHeader->nbr_cont) >= 1) {
+		const RVL_Content_Entry *const content =
+			reinterpret_cast<const RVL_Content_Entry*>(&d->partitionHeader.tmd[sizeof(*tmdHeader)]);
+		uint8_t digest[Sha1::DIGEST_SIZE];
+		Sha1::hash(h3_table.get(), RVL_H3_TABLE_SIZE, digest);
+		pResult->h3TableOK = (memcmp(digest, content->sha1_hash, sizeof(digest)) == 0);
+	}
+
+	WiiPartitionPrivate::VerifyJob job;
+	job.d = d;
+	job.discReader = m_discReader;
+	job.data_addr = d->partition_offset + d->data_offset;
+	job.h3_table = h3_table.get();
+	job.clusterCount = static_cast<uint32_t>(d->data_size / SECTOR_SIZE_ENCRYPTED);
+	job.nextGroup = 0;
+	job.isCrypted = isCrypted;
+
+	const unsigned int groupCount = (job.clusterCount + WiiPartitionPrivate::CLUSTERS_PER_GROUP - 1) /
+		WiiPartitionPrivate::CLUSTERS_PER_GROUP;
+	if (threads == 0) {
+		threads = Thread::cpuCount();
+	}
+	if (threads > groupCount) {
+		threads = groupCount;
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	// Each worker needs its own cipher, since the
+	// cipher objects aren't thread-safe.
+	unique_ptr<WiiPartitionPrivate::VerifyWorker[]> workers(new WiiPartitionPrivate::VerifyWorker[threads]);
+	for (unsigned int i = 0; i < threads; i++) {
+		workers[i].job = &job;
+#ifdef ENABLE_DECRYPTION
+		if (isCrypted) {
+			workers[i].cipher.reset(AesCipherFactory::create());
+			if (!workers[i].cipher || !workers[i].cipher->isInit()) {
+				m_lastError = EIO;
+				return -EIO;
+			}
+			int ret = workers[i].cipher->setKey(d->title_key, sizeof(d->title_key));
+			ret |= workers[i].cipher->setChainingMode(IAesCipher::CM_CBC);
+			if (ret != 0) {
+				m_lastError = EIO;
+				return -EIO;
+			}
+		}
+#endif /* ENABLE_DECRYPTION */
+	}
+
+	// Start the additional worker threads.
+	// If a thread can't be started, the remaining
+	// threads will handle its share of the work.
+	unique_ptr<Thread[]> workerThreads(threads > 1 ? new Thread[threads - 1] : nullptr);
+	for (unsigned int i = 1; i < threads; i++) {
+		workerThreads[i - 1].start(WiiPartitionPrivate::verifyWorker, &workers[i]);
+	}
+
+	// The calling thread is also a worker thread.
+	WiiPartitionPrivate::verifyWorker(&workers[0]);
+
+	for (unsigned int i = 1; i < threads; i++) {
+		workerThreads[i - 1].join();
+	}
+
+	// Merge the results.
+	pResult->clusterCount = job.clusterCount;
+	pResult->badClusters.clear();
+	for (unsigned int i = 0; i < threads; i++) {
+		pResult->badClusters.insert(pResult->badClusters.end(),
+			workers[i].badClusters.cbegin(), workers[i].badClusters.cend());
+	}
+	std::sort(pResult->badClusters.begin(), pResult->badClusters.end());
+	return 0;
+}
+
 #ifdef ENABLE_DECRYPTION
 /** Encryption keys. **/
 
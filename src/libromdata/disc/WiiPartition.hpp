@@ -16,6 +16,9 @@
 // librpbase
 #include "librpbase/crypto/KeyManager.hpp"
 
+// C++ includes.
+#include <vector>
+
 namespace LibRomData {
 
 class WiiPartitionPrivate;
@@ -72,6 +75,16 @@ class WiiPartition : public GcnPartition
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the partition at the specified position.
+		 * This does not change the partition position.
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
@@ -141,6 +154,34 @@ class WiiPartition : public GcnPartition
 		 */
 		const RVL_TMD_Header *tmdHeader(void) const;
 
+	public:
+		/**
+		 * Hash verification result.
+		 */
+		struct HashVerifyResult {
+			uint32_t clusterCount;			// Number of clusters checked.
+			bool h3TableOK;				// True if the H3 table matches the TMD content hash.
+			std::vector<uint32_t> badClusters;	// Clusters that failed verification. (sorted)
+		};
+
+		/**
+		 * Verify the partition's hash tree.
+		 *
+		 * Each cluster's H0 hashes are checked against its data,
+		 * and its H1, H2, and H3 hashes are checked against the
+		 * next level down. The H3 table is checked against the
+		 * TMD content hash.
+		 *
+		 * Groups of clusters are read sequentially and decrypted
+		 * and hashed by multiple worker threads. The calling
+		 * thread is used as one of the worker threads.
+		 *
+		 * @param pResult	[out] Verification result.
+		 * @param threads	[in,opt] Number of worker threads. (0 for the number of CPUs)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int verifyHashes(HashVerifyResult *pResult, unsigned int threads = 0);
+
 	public:
 		// Encryption key indexes.
 		enum EncryptionKeys {
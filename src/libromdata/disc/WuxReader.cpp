@@ -22,6 +22,9 @@ using std::array;
 
 namespace LibRomData {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("WuxReader");
+
 class WuxReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		WuxReaderPrivate(WuxReader *q);
@@ -46,11 +49,14 @@ class WuxReaderPrivate : public SparseDiscReaderPrivate {
 /** WuxReaderPrivate **/
 
 WuxReaderPrivate::WuxReaderPrivate(WuxReader *q)
-	: super(q)
+	: super(q, ioLayer)
 	, dataOffset(0)
 {
 	// Clear the .wux header struct.
 	memset(&wuxHeader, 0, sizeof(wuxHeader));
+
+	// Blocks are 32 KB. Cache 16 blocks.
+	cacheLineCount = 16;
 }
 
 /** WuxReader **/
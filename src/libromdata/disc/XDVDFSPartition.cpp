@@ -363,6 +363,34 @@ size_t XDVDFSPartition::read(void *ptr, size_t size)
 	return m_discReader->read(ptr, size);
 }
 
+/**
+ * Read data from the partition at the specified position.
+ * This does not change the partition position.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t XDVDFSPartition::pread(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(const XDVDFSPartition);
+	assert(m_discReader != nullptr);
+	assert(m_discReader->isOpen());
+	if (!m_discReader || !m_discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	size_t ret = m_discReader->pread(d->partition_offset + pos, ptr, size);
+	if (ret != size) {
+		m_lastError = m_discReader->lastError();
+	}
+	return ret;
+}
+
 /**
  * Set the partition position.
  * @param pos Partition position.
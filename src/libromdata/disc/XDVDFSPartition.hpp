@@ -56,6 +56,16 @@ class XDVDFSPartition : public LibRpBase::IPartition
 		 */
 		size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the partition at the specified position.
+		 * This does not change the partition position.
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
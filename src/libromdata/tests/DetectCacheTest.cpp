@@ -0,0 +1,346 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * DetectCacheTest.cpp: DetectCache test.                                  *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/file/FileSystem.hpp"
+#include "librpbase/file/RpFile.hpp"
+using namespace LibRpBase;
+using LibRpBase::FileSystem::FileId;
+
+// libromdata
+#include "DetectCache.hpp"
+
+// C includes.
+#ifndef _WIN32
+# include <sys/stat.h>
+# include <unistd.h>
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <memory>
+#include <string>
+using std::string;
+using std::unique_ptr;
+
+namespace LibRomData { namespace Tests {
+
+class DetectCacheTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final
+		{
+			FileSystem::delete_file(CACHE_FILENAME);
+			DetectCache::setFilename(CACHE_FILENAME);
+		}
+
+		void TearDown(void) final
+		{
+			DetectCache::setFilename(string());
+			FileSystem::delete_file(CACHE_FILENAME);
+		}
+
+		/**
+		 * Reload the cache file, as if another process opened it.
+		 */
+		static void reload(void)
+		{
+			DetectCache::setFilename(CACHE_FILENAME);
+		}
+
+		/**
+		 * Get a file identity for testing.
+		 * @param ino Inode number.
+		 * @return File identity.
+		 */
+		static FileId fileId(uint64_t ino)
+		{
+			FileId id;
+			id.dev = 0x801;
+			id.ino = ino;
+			id.size = 0x100000;
+			id.mtime = 1234567890;
+			return id;
+		}
+
+	public:
+		static const char CACHE_FILENAME[];
+};
+
+const char DetectCacheTest::CACHE_FILENAME[] = "DetectCacheTest.cache";
+
+/**
+ * Files that haven't been stored must not be found.
+ */
+TEST_F(DetectCacheTest, miss)
+{
+	DetectCache::Entry entry;
+	EXPECT_FALSE(DetectCache::lookup(fileId(1), 0, &entry));
+
+	DetectCache::Data data;
+	EXPECT_FALSE(DetectCache::hasData(fileId(1), "GameCube"));
+	EXPECT_FALSE(DetectCache::lookupData(fileId(1), "GameCube", &data));
+}
+
+/**
+ * Stored entries must be found, including after reloading the cache file.
+ */
+TEST_F(DetectCacheTest, hit)
+{
+	DetectCache::Entry entry;
+	entry.className = "GameCube";
+	entry.romType = 3;
+	entry.attrs = 5;
+	DetectCache::store(fileId(1), 0, entry);
+
+	// Unsupported file.
+	DetectCache::Entry entry2;
+	entry2.romType = -1;
+	entry2.attrs = 0;
+	DetectCache::store(fileId(2), 0, entry2);
+
+	for (int i = 0; i < 2; i++) {
+		DetectCache::Entry found;
+		ASSERT_TRUE(DetectCache::lookup(fileId(1), 0, &found)) << "pass " << i;
+		EXPECT_EQ("GameCube", found.className);
+		EXPECT_EQ(3, found.romType);
+		EXPECT_EQ(5U, found.attrs);
+
+		ASSERT_TRUE(DetectCache::lookup(fileId(2), 0, &found)) << "pass " << i;
+		EXPECT_TRUE(found.className.empty());
+
+		// Entries are stored per requested attribute set.
+		EXPECT_FALSE(DetectCache::lookup(fileId(1), 1, &found)) << "pass " << i;
+
+		reload();
+	}
+}
+
+/**
+ * Entries must not be used if the file's size or mtime changed.
+ */
+TEST_F(DetectCacheTest, invalidation)
+{
+	DetectCache::Entry entry;
+	entry.className = "GameCube";
+	entry.romType = 3;
+	entry.attrs = 5;
+	DetectCache::store(fileId(1), 0, entry);
+
+	FileId id = fileId(1);
+	id.mtime++;
+	DetectCache::Entry found;
+	EXPECT_FALSE(DetectCache::lookup(id, 0, &found));
+	id = fileId(1);
+	id.size++;
+	EXPECT_FALSE(DetectCache::lookup(id, 0, &found));
+
+	// A new entry replaces the old one.
+	entry.className = "WiiU";
+	DetectCache::store(id, 0, entry);
+	reload();
+	EXPECT_FALSE(DetectCache::lookup(fileId(1), 0, &found));
+	ASSERT_TRUE(DetectCache::lookup(id, 0, &found));
+	EXPECT_EQ("WiiU", found.className);
+}
+
+/**
+ * Fields and metadata must be stored and invalidated.
+ */
+TEST_F(DetectCacheTest, data)
+{
+	// Use strings that are too long for the small string optimization.
+	const string title(100, 'T');
+	const string desc(3000, 'D');
+
+	RomFields fields;
+	fields.addField_string("Title", title);
+	fields.addField_string("Description", desc);
+	fields.addField_dateTime("Date", 1234567890, RomFields::RFT_DATETIME_HAS_DATE);
+	RomMetaData metaData;
+	metaData.addMetaData_string(Property::Title, title);
+
+	EXPECT_EQ(0, DetectCache::storeData(fileId(1), "GameCube",
+		RomData::FTYPE_DISC_IMAGE, "Nintendo GameCube", &fields, &metaData));
+	EXPECT_TRUE(DetectCache::hasData(fileId(1), "GameCube"));
+	reload();
+	EXPECT_TRUE(DetectCache::hasData(fileId(1), "GameCube"));
+
+	DetectCache::Data data;
+	ASSERT_TRUE(DetectCache::lookupData(fileId(1), "GameCube", &data));
+	unique_ptr<RomFields> fields2(data.fields);
+	unique_ptr<RomMetaData> metaData2(data.metaData);
+	EXPECT_EQ(static_cast<int>(RomData::FTYPE_DISC_IMAGE), data.fileType);
+	EXPECT_EQ("Nintendo GameCube", data.systemName);
+	ASSERT_EQ(3, fields2->count());
+	ASSERT_TRUE(fields2->at(0)->data.str != nullptr);
+	EXPECT_EQ(title, *fields2->at(0)->data.str);
+	ASSERT_TRUE(fields2->at(1)->data.str != nullptr);
+	EXPECT_EQ(desc, *fields2->at(1)->data.str);
+	EXPECT_EQ(1234567890, fields2->at(2)->data.date_time);
+	ASSERT_TRUE(metaData2 != nullptr);
+	ASSERT_EQ(1, metaData2->count());
+	EXPECT_EQ(title, *metaData2->prop(0)->data.str);
+
+	// Different class.
+	EXPECT_FALSE(DetectCache::hasData(fileId(1), "WiiU"));
+	EXPECT_FALSE(DetectCache::lookupData(fileId(1), "WiiU", &data));
+
+	// Modified file.
+	FileId id = fileId(1);
+	id.mtime++;
+	EXPECT_FALSE(DetectCache::hasData(id, "GameCube"));
+	EXPECT_FALSE(DetectCache::lookupData(id, "GameCube", &data));
+
+	// ListData icons aren't serialized, so those fields can't be stored.
+	RomFields iconFields;
+	RomFields::ListData_t *const list_data = new RomFields::ListData_t(1);
+	(*list_data)[0].push_back("a");
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_ICONS, 0);
+	params.data.single = list_data;
+	params.mxd.icons = new RomFields::ListDataIcons_t(1);
+	iconFields.addField_listData("List", &params);
+	EXPECT_EQ(-ENOTSUP, DetectCache::storeData(fileId(2), "GameCube",
+		RomData::FTYPE_DISC_IMAGE, nullptr, &iconFields, nullptr));
+	EXPECT_FALSE(DetectCache::hasData(fileId(2), "GameCube"));
+}
+
+/**
+ * Outdated entries must be removed when the cache file is loaded.
+ */
+TEST_F(DetectCacheTest, compaction)
+{
+	RomFields fields;
+	fields.addField_string("Title", string(1000, 'T'));
+
+	// Replace the same entries many times.
+	DetectCache::Entry entry;
+	entry.className = "GameCube";
+	entry.attrs = 0;
+	for (unsigned int i = 0; i < 200; i++) {
+		entry.romType = static_cast<int>(i);
+		DetectCache::store(fileId(1), 0, entry);
+		ASSERT_EQ(0, DetectCache::storeData(fileId(2), "GameCube",
+			RomData::FTYPE_DISC_IMAGE, nullptr, &fields, nullptr));
+	}
+	const off64_t oldSize = FileSystem::filesize(CACHE_FILENAME);
+
+	// Reloading the cache file compacts it.
+	reload();
+	DetectCache::Entry found;
+	ASSERT_TRUE(DetectCache::lookup(fileId(1), 0, &found));
+	EXPECT_EQ(199, found.romType);
+	const off64_t newSize = FileSystem::filesize(CACHE_FILENAME);
+	EXPECT_LT(newSize * 100, oldSize);
+
+	// The remaining entries must still be usable.
+	for (int i = 0; i < 2; i++) {
+		DetectCache::Data data;
+		ASSERT_TRUE(DetectCache::lookupData(fileId(2), "GameCube", &data)) << "pass " << i;
+		unique_ptr<RomFields> fields2(data.fields);
+		EXPECT_TRUE(data.metaData == nullptr);
+		EXPECT_TRUE(data.systemName.empty());
+		ASSERT_EQ(1, fields2->count());
+		EXPECT_EQ(string(1000, 'T'), *fields2->at(0)->data.str);
+
+		reload();
+		ASSERT_TRUE(DetectCache::lookup(fileId(1), 0, &found)) << "pass " << i;
+		EXPECT_EQ(199, found.romType);
+		EXPECT_EQ(newSize, FileSystem::filesize(CACHE_FILENAME));
+	}
+}
+
+#ifndef _WIN32
+/**
+ * Entries must not be used if the configuration files changed.
+ * NOTE: Not on Windows, since the configuration directory
+ * can't be changed for the test.
+ */
+TEST_F(DetectCacheTest, stateChanged)
+{
+	const string &configDir = FileSystem::getConfigDirectory();
+	ASSERT_FALSE(configDir.empty());
+	string keysFilename = configDir;
+	if (keysFilename.at(keysFilename.size()-1) != DIR_SEP_CHR) {
+		keysFilename += DIR_SEP_CHR;
+	}
+	keysFilename += "keys.conf";
+	ASSERT_NE(0, FileSystem::access(keysFilename, R_OK)) << "keys.conf must not exist in the test config directory";
+	ASSERT_EQ(0, FileSystem::rmkdir(keysFilename));
+
+	DetectCache::Entry entry;
+	entry.className = "GameCube";
+	entry.romType = 3;
+	entry.attrs = 5;
+	DetectCache::store(fileId(1), 0, entry);
+	RomFields fields;
+	fields.addField_string("Title", "Title");
+	ASSERT_EQ(0, DetectCache::storeData(fileId(1), "GameCube",
+		RomData::FTYPE_DISC_IMAGE, nullptr, &fields, nullptr));
+
+	DetectCache::Entry found;
+	ASSERT_TRUE(DetectCache::lookup(fileId(1), 0, &found));
+	ASSERT_TRUE(DetectCache::hasData(fileId(1), "GameCube"));
+
+	// Adding keys may change the detection results.
+	RpFile *const file = new RpFile(keysFilename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	EXPECT_EQ(7U, file->write("[Keys]\n", 7));
+	file->unref();
+
+	EXPECT_FALSE(DetectCache::lookup(fileId(1), 0, &found));
+	EXPECT_FALSE(DetectCache::hasData(fileId(1), "GameCube"));
+	DetectCache::Data data;
+	EXPECT_FALSE(DetectCache::lookupData(fileId(1), "GameCube", &data));
+
+	// A new entry is used with the new state.
+	DetectCache::store(fileId(1), 0, entry);
+	EXPECT_TRUE(DetectCache::lookup(fileId(1), 0, &found));
+
+	FileSystem::delete_file(keysFilename);
+	EXPECT_FALSE(DetectCache::lookup(fileId(1), 0, &found));
+}
+#endif /* !_WIN32 */
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: DetectCache tests.\n\n");
+	fflush(nullptr);
+
+#ifndef _WIN32
+	// Use a separate configuration directory, since
+	// the tests create configuration files.
+	// NOTE: This must be done before the configuration
+	// directory is used for the first time.
+	char cwd[4096];
+	if (getcwd(cwd, sizeof(cwd)) != nullptr) {
+		string configHome = cwd;
+		configHome += "/DetectCacheTest.config";
+		mkdir(configHome.c_str(), 0777);
+		setenv("XDG_CONFIG_HOME", configHome.c_str(), 1);
+	}
+#endif /* !_WIN32 */
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,391 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomDataFactoryTest.cpp: RomDataFactory class test.                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// RomDataFactory
+#include "libromdata/DetectCache.hpp"
+#include "libromdata/RomDataFactory.hpp"
+#include "librpbase/RomData.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/file/FileSystem.hpp"
+#include "librpbase/file/IoStats.hpp"
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+using namespace LibRpBase;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RomDataFactoryTest : public ::testing::Test
+{
+	protected:
+		RomDataFactoryTest()
+		{
+			memset(m_buf, 0, sizeof(m_buf));
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100000;
+
+	protected:
+		// Test file buffer.
+		// NOTE: Must be at least 4096+256 bytes in order
+		// to cover the full detection header.
+		uint8_t m_buf[8192];
+};
+
+/**
+ * Detect a file with a 32-bit magic number at address 0.
+ */
+TEST_F(RomDataFactoryTest, createMagicNSF)
+{
+	// NSF: "NESM\x1A\x01"
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	RomData *const romData = RomDataFactory::create(file);
+	file->unref();
+
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_TRUE(romData->isValid());
+	EXPECT_STREQ("NSF", romData->className());
+	romData->unref();
+}
+
+/**
+ * A matching magic number at the wrong address must not be detected.
+ */
+TEST_F(RomDataFactoryTest, createMagicWrongAddress)
+{
+	memcpy(&m_buf[4], "NESM\x1A\x01", 6);
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	RomData *const romData = RomDataFactory::create(file);
+	file->unref();
+
+	if (romData) {
+		EXPECT_STRNE("NSF", romData->className());
+		romData->unref();
+	}
+}
+
+/**
+ * identify() must return the same class as create() without constructing it.
+ */
+TEST_F(RomDataFactoryTest, identifyNSF)
+{
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	RomDataFactory::IdentifyInfo idInfo;
+	EXPECT_TRUE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_STREQ("NSF", idInfo.className);
+	EXPECT_GE(idInfo.romType, 0);
+	EXPECT_NE(0U, idInfo.attrs & RomDataFactory::RDA_HAS_METADATA);
+	EXPECT_EQ(static_cast<int>(RomData::FTYPE_AUDIO_FILE), idInfo.fileType);
+	EXPECT_STREQ("Nintendo Sound Format", idInfo.systemName);
+
+	// The file type and system name must match the constructed object.
+	RomData *const romData = RomDataFactory::create(file);
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_EQ(static_cast<int>(romData->fileType()), idInfo.fileType);
+	EXPECT_STREQ(romData->systemName(RomData::SYSNAME_TYPE_LONG), idInfo.systemName);
+	romData->unref();
+
+	// Unknown file.
+	memset(m_buf, 0xA5, sizeof(m_buf));
+	EXPECT_FALSE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_TRUE(idInfo.className == nullptr);
+	EXPECT_EQ(static_cast<int>(RomData::FTYPE_UNKNOWN), idInfo.fileType);
+	EXPECT_TRUE(idInfo.systemName == nullptr);
+	file->unref();
+}
+
+/**
+ * Classes with multiple magic numbers must be indexed for each of them.
+ */
+TEST_F(RomDataFactoryTest, identifyMagicSAP)
+{
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	RomDataFactory::IdentifyInfo idInfo;
+	memcpy(m_buf, "SAP\r\n", 5);
+	EXPECT_TRUE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_STREQ("SAP", idInfo.className);
+
+	memcpy(m_buf, "SAP\nA", 5);
+	EXPECT_TRUE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_STREQ("SAP", idInfo.className);
+	file->unref();
+}
+
+/**
+ * Classes that aren't in the magic number index must still be
+ * checked in table order: "RSID" is both a SID magic number
+ * and a valid Wii game ID.
+ */
+TEST_F(RomDataFactoryTest, identifyHeaderOrder)
+{
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	RomDataFactory::IdentifyInfo idInfo;
+	memcpy(m_buf, "RSID01", 6);
+	EXPECT_TRUE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_STREQ("SID", idInfo.className);
+
+	// Wii magic number.
+	memcpy(&m_buf[0x18], "\x5D\x1C\x9E\xA3", 4);
+	EXPECT_TRUE(RomDataFactory::identify(file, &idInfo));
+	EXPECT_STREQ("GameCube", idInfo.className);
+	file->unref();
+}
+
+/**
+ * createBatch() must return results in submission order.
+ */
+TEST_F(RomDataFactoryTest, createBatchOrder)
+{
+	// Every third file is an NSF; the rest are unknown.
+	uint8_t bufUnknown[sizeof(m_buf)];
+	memset(bufUnknown, 0xA5, sizeof(bufUnknown));
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+
+	vector<IRpFile*> files;
+	for (unsigned int i = 0; i < 30; i++) {
+		files.push_back(new RpMemFile(
+			(i % 3 == 0) ? m_buf : bufUnknown, sizeof(m_buf)));
+	}
+
+	vector<RomData*> results = RomDataFactory::createBatch(files, 0,
+		RomDataFactory::BATCH_LOAD_FIELDS, 4);
+	ASSERT_EQ(files.size(), results.size());
+	for (unsigned int i = 0; i < results.size(); i++) {
+		if (i % 3 == 0) {
+			ASSERT_TRUE(results[i] != nullptr) << "index " << i;
+			EXPECT_STREQ("NSF", results[i]->className());
+			results[i]->unref();
+		} else {
+			EXPECT_TRUE(results[i] == nullptr) << "index " << i;
+		}
+		files[i]->unref();
+	}
+}
+
+/**
+ * createBatch() with filenames must return results in submission order.
+ * Headers for upcoming files are prefetched using access hints
+ * while the files are being processed.
+ */
+TEST_F(RomDataFactoryTest, createBatchFilenames)
+{
+	// Every third file is an NSF; the rest are unknown.
+	uint8_t bufUnknown[sizeof(m_buf)];
+	memset(bufUnknown, 0xA5, sizeof(bufUnknown));
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+
+	vector<string> filenames;
+	for (unsigned int i = 0; i < 30; i++) {
+		char filename[64];
+		snprintf(filename, sizeof(filename), "RomDataFactoryTest.%u.bin", i);
+		RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+		ASSERT_TRUE(file->isOpen());
+		file->write((i % 3 == 0) ? m_buf : bufUnknown, sizeof(m_buf));
+		file->unref();
+		filenames.push_back(filename);
+	}
+
+	vector<RomData*> results = RomDataFactory::createBatch(filenames, 0,
+		RomDataFactory::BATCH_LOAD_FIELDS, 2);
+	ASSERT_EQ(filenames.size(), results.size());
+	for (unsigned int i = 0; i < results.size(); i++) {
+		if (i % 3 == 0) {
+			EXPECT_TRUE(results[i] != nullptr) << "index " << i;
+			if (results[i]) {
+				EXPECT_STREQ("NSF", results[i]->className());
+				results[i]->unref();
+			}
+		} else {
+			EXPECT_TRUE(results[i] == nullptr) << "index " << i;
+		}
+		remove(filenames[i].c_str());
+	}
+}
+
+/**
+ * Headers at non-zero addresses must only be read when they're
+ * checked, and the RomData constructor must not read the header
+ * from the underlying file again.
+ */
+TEST_F(RomDataFactoryTest, createHeaderReads)
+{
+	// Sega 8-bit: "TMR SEGA" at 0x7FF0.
+	// The file is large enough to include the 0x40000 header range,
+	// which must not be read since Sega8Bit is checked first.
+	static const char filename[] = "RomDataFactoryTest.sms";
+	vector<uint8_t> image(0x50000, 0);
+	memcpy(&image[0x7FF0], "TMR SEGA", 8);
+	RpFile *file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(image.size(), file->write(image.data(), image.size()));
+	file->unref();
+
+	file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+	RomData *const romData = RomDataFactory::create(file);
+	IoStats::snapshot(after);
+	IoStats::setEnabled(false);
+	file->unref();
+	remove(filename);
+
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_STREQ("Sega8Bit", romData->className());
+	romData->unref();
+
+	// Only the first cache block (0x0000-0xFFFF) may be read.
+	ASSERT_EQ(before.size(), after.size());
+	bool found = false;
+	for (size_t i = 0; i < after.size(); i++) {
+		if (!strcmp(after[i].name, "RpFile")) {
+			found = true;
+			EXPECT_EQ(1U, after[i].reads - before[i].reads);
+			EXPECT_EQ(65536U, after[i].bytesRead - before[i].bytesRead);
+			break;
+		}
+	}
+	EXPECT_TRUE(found) << "RpFile layer was not registered";
+}
+
+/**
+ * If the fields are stored in the detection cache, create()
+ * must use them without reading the file, and the RomData
+ * subclass must only be created when it's needed.
+ */
+TEST_F(RomDataFactoryTest, createFromDetectCache)
+{
+	static const char filename[] = "RomDataFactoryTest.nsf";
+	static const char cacheFilename[] = "RomDataFactoryTest.cache";
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+	memcpy(&m_buf[0x0E], "Test Title", 10);
+	RpFile *file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(sizeof(m_buf), file->write(m_buf, sizeof(m_buf)));
+	file->unref();
+
+	FileSystem::delete_file(cacheFilename);
+	DetectCache::setFilename(cacheFilename);
+	RomDataFactory::setDetectCacheEnabled(true);
+
+	// Detect the file and store its fields.
+	file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	RomData *romData = RomDataFactory::create(file);
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_EQ(0, RomDataFactory::updateDetectCache(file, romData));
+	const int fieldCount = romData->fields()->count();
+	const string systemName = romData->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
+	const string systemNameShort = romData->systemName(RomData::SYSNAME_TYPE_SHORT);
+	romData->unref();
+	file->unref();
+
+	// Create it again. The file must not be read.
+	file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+	romData = RomDataFactory::create(file);
+	ASSERT_TRUE(romData != nullptr);
+	EXPECT_TRUE(romData->isValid());
+	EXPECT_STREQ("NSF", romData->className());
+	EXPECT_EQ(RomData::FTYPE_AUDIO_FILE, romData->fileType());
+	EXPECT_EQ(systemName, romData->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL));
+	const RomFields *const fields = romData->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_EQ(fieldCount, fields->count());
+	ASSERT_TRUE(fields->at(0)->data.str != nullptr);
+	EXPECT_EQ("Test Title", *fields->at(0)->data.str);
+	IoStats::snapshot(after);
+	IoStats::setEnabled(false);
+
+	ASSERT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < after.size(); i++) {
+		if (!strcmp(after[i].name, "CachedRpFile")) {
+			EXPECT_EQ(0U, after[i].reads - before[i].reads);
+		}
+	}
+
+	// Data that isn't cached must be retrieved from the RomData subclass.
+	EXPECT_EQ(systemNameShort, romData->systemName(RomData::SYSNAME_TYPE_SHORT));
+
+	romData->unref();
+	file->unref();
+	RomDataFactory::setDetectCacheEnabled(false);
+	DetectCache::setFilename(string());
+	FileSystem::delete_file(cacheFilename);
+	remove(filename);
+}
+
+/**
+ * Benchmark detection of a file with a 32-bit magic number.
+ */
+TEST_F(RomDataFactoryTest, createMagic_benchmark)
+{
+	memcpy(m_buf, "NESM\x1A\x01", 6);
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RomData *const romData = RomDataFactory::create(file);
+		ASSERT_TRUE(romData != nullptr);
+		romData->unref();
+	}
+	file->unref();
+}
+
+/**
+ * Benchmark detection of a file that doesn't match any magic number.
+ * This is the worst case for magic number dispatch.
+ */
+TEST_F(RomDataFactoryTest, createUnknown_benchmark)
+{
+	memset(m_buf, 0xA5, sizeof(m_buf));
+	RpMemFile *const file = new RpMemFile(m_buf, sizeof(m_buf));
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		RomData *const romData = RomDataFactory::create(file);
+		if (romData) {
+			romData->unref();
+		}
+	}
+	file->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomDataFactory tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRomData::Tests::RomDataFactoryTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * Cdrom2352ReaderTest.cpp: Cdrom2352Reader test.                          *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/file/RpFile.hpp"
+using namespace LibRpBase;
+
+// libromdata
+#include "disc/Cdrom2352Reader.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class Cdrom2352ReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			remove(FILENAME);
+		}
+
+	public:
+		static const unsigned int PHYS_BLOCK_SIZE = 2352;
+		static const unsigned int BLOCK_SIZE = 2048;
+		static const unsigned int BLOCK_COUNT = 4;
+
+		static const char FILENAME[];
+
+	protected:
+		vector<uint8_t> m_data;		// Expected user data.
+};
+
+const char Cdrom2352ReaderTest::FILENAME[] = "Cdrom2352ReaderTest.bin";
+
+void Cdrom2352ReaderTest::SetUp(void)
+{
+	static const uint8_t sync[12] =
+		{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
+
+	// Mode 1 sectors: sync, header, user data, EDC/ECC.
+	// NOTE: EDC/ECC isn't checked, so it's left as 0xA5.
+	vector<uint8_t> image(BLOCK_COUNT * PHYS_BLOCK_SIZE, 0xA5);
+	m_data.resize(BLOCK_COUNT * BLOCK_SIZE);
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		uint8_t *const sector = &image[i * PHYS_BLOCK_SIZE];
+		memcpy(sector, sync, sizeof(sync));
+		sector[15] = 1;	// Mode 1
+		for (unsigned int j = 0; j < BLOCK_SIZE; j++) {
+			m_data[i * BLOCK_SIZE + j] = static_cast<uint8_t>((j * 7) ^ i);
+		}
+		memcpy(&sector[16], &m_data[i * BLOCK_SIZE], BLOCK_SIZE);
+	}
+
+	RpFile *const file = new RpFile(FILENAME, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(image.size(), file->write(image.data(), image.size()));
+	file->unref();
+}
+
+/**
+ * Reading multiple blocks must return the user data of each sector.
+ */
+TEST_F(Cdrom2352ReaderTest, readBlocks)
+{
+	RpFile *const file = new RpFile(FILENAME, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	Cdrom2352Reader reader(file);
+	file->unref();
+	ASSERT_TRUE(reader.isOpen());
+	ASSERT_EQ(static_cast<off64_t>(m_data.size()), reader.size());
+
+	vector<uint8_t> buf(m_data.size());
+	ASSERT_EQ(buf.size(), reader.pread(0, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+}
+
+/**
+ * If the last physical sector is only partially readable,
+ * its available user data must still be returned.
+ */
+TEST_F(Cdrom2352ReaderTest, readBlocksPartialTail)
+{
+	RpFile *const file = new RpFile(FILENAME, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	Cdrom2352Reader reader(file);
+	file->unref();
+	ASSERT_TRUE(reader.isOpen());
+
+	// Truncate the image in the middle of the last sector's user data.
+	static const unsigned int TAIL_SIZE = 100;
+	RpFile *const wrFile = new RpFile(FILENAME, RpFile::FM_OPEN_WRITE);
+	ASSERT_TRUE(wrFile->isOpen());
+	ASSERT_EQ(0, wrFile->truncate((BLOCK_COUNT - 1) * PHYS_BLOCK_SIZE + 16 + TAIL_SIZE));
+	wrFile->unref();
+
+	vector<uint8_t> buf(m_data.size());
+	const size_t expected = (BLOCK_COUNT - 1) * BLOCK_SIZE + TAIL_SIZE;
+	ASSERT_EQ(expected, reader.pread(0, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), expected));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: Cdrom2352Reader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
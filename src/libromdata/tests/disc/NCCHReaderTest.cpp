@@ -0,0 +1,261 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * NCCHReaderTest.cpp: NCCHReader test.                                    *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// libromdata
+#include "disc/NCCHReader.hpp"
+#include "Handheld/n3ds_structs.h"
+#include "crypto/N3DSVerifyKeys.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * IRpFile wrapper that counts read() calls.
+ */
+class CountingFile : public IRpFile
+{
+	public:
+		explicit CountingFile(IRpFile *file)
+			: m_file(file->ref())
+			, reads(0)
+		{ }
+
+	protected:
+		virtual ~CountingFile()
+		{
+			m_file->unref();
+		}
+
+	public:
+		bool isOpen(void) const final { return m_file->isOpen(); }
+		void close(void) final { }
+		size_t read(void *ptr, size_t size) final
+		{
+			reads++;
+			return m_file->read(ptr, size);
+		}
+		size_t write(const void *ptr, size_t size) final { RP_UNUSED(ptr); RP_UNUSED(size); return 0; }
+		int seek(off64_t pos) final { return m_file->seek(pos); }
+		off64_t tell(void) final { return m_file->tell(); }
+		int truncate(off64_t size) final { RP_UNUSED(size); return -1; }
+		off64_t size(void) final { return m_file->size(); }
+		string filename(void) const final { return string(); }
+
+	private:
+		IRpFile *const m_file;
+	public:
+		unsigned int reads;
+};
+
+class NCCHReaderTest : public ::testing::Test
+{
+	protected:
+		NCCHReaderTest()
+			: m_file(nullptr)
+			, m_reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			delete m_reader;
+			if (m_file) {
+				m_file->unref();
+			}
+		}
+
+	public:
+		// Fixed-key NCCH layout: (media unit = 512 bytes)
+		// - 0x00200: ExHeader (0x400 bytes; followed by an undefined region)
+		// - 0x00C00: ExeFS header, ".code" (key 1), "icon" (key 0)
+		// - 0x06000: RomFS
+		static const unsigned int MEDIA_UNIT_SHIFT = 9;
+		static const unsigned int EXEFS_OFFSET = 0xC00;
+		static const unsigned int CODE_OFFSET = EXEFS_OFFSET + 0x200;
+		static const unsigned int CODE_SIZE = 0x1238;	// not a multiple of 16
+		static const unsigned int CODE_SIZE_ALIGNED = (CODE_SIZE + 15) & ~15U;
+		static const unsigned int ICON_OFFSET = EXEFS_OFFSET + 0x200 + 0x1400;
+		static const unsigned int ICON_SIZE = 0x36C0;
+		static const unsigned int ROMFS_OFFSET = 0x6000;
+		static const unsigned int ROMFS_SIZE = 0x30000;
+		static const unsigned int NCCH_LENGTH = ROMFS_OFFSET + ROMFS_SIZE;
+
+	protected:
+		vector<uint8_t> m_image;	// Encrypted NCCH image.
+		vector<uint8_t> m_data;		// Expected decrypted data.
+		CountingFile *m_file;
+		NCCHReader *m_reader;
+};
+
+void NCCHReaderTest::SetUp(void)
+{
+	m_data.resize(NCCH_LENGTH);
+	TestRandom rnd(0x2468ACE0);
+	rnd.fill(m_data.data(), m_data.size());
+
+	// NCCH header. (plaintext)
+	N3DS_NCCH_Header_t *const header = reinterpret_cast<N3DS_NCCH_Header_t*>(m_data.data());
+	memset(header, 0, sizeof(*header));
+	header->hdr.magic = cpu_to_be32(N3DS_NCCH_HEADER_MAGIC);
+	header->hdr.content_size = cpu_to_le32(NCCH_LENGTH >> MEDIA_UNIT_SHIFT);
+	header->hdr.title_id.id = cpu_to_le64(0x0004000000123400ULL);
+	header->hdr.program_id.id = header->hdr.title_id.id;
+	header->hdr.exheader_size = cpu_to_le32(0x400);
+	header->hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] = N3DS_NCCH_BIT_MASK_FixedCryptoKey;
+	header->hdr.exefs_offset = cpu_to_le32(EXEFS_OFFSET >> MEDIA_UNIT_SHIFT);
+	header->hdr.exefs_size = cpu_to_le32((ROMFS_OFFSET - EXEFS_OFFSET) >> MEDIA_UNIT_SHIFT);
+	header->hdr.romfs_offset = cpu_to_le32(ROMFS_OFFSET >> MEDIA_UNIT_SHIFT);
+	header->hdr.romfs_size = cpu_to_le32(ROMFS_SIZE >> MEDIA_UNIT_SHIFT);
+
+	// ExeFS header.
+	N3DS_ExeFS_Header_t *const exefs = reinterpret_cast<N3DS_ExeFS_Header_t*>(&m_data[EXEFS_OFFSET]);
+	memset(exefs, 0, sizeof(*exefs));
+	strcpy(exefs->files[0].name, ".code");
+	exefs->files[0].offset = cpu_to_le32(CODE_OFFSET - EXEFS_OFFSET - 0x200);
+	exefs->files[0].size = cpu_to_le32(CODE_SIZE);
+	strcpy(exefs->files[1].name, "icon");
+	exefs->files[1].offset = cpu_to_le32(ICON_OFFSET - EXEFS_OFFSET - 0x200);
+	exefs->files[1].size = cpu_to_le32(ICON_SIZE);
+
+	// Encrypt the sections.
+	// Fixed-key NCCHs use an all-zero key.
+	// NOTE: CTR encryption is the same as CTR decryption.
+	static const struct {
+		uint32_t address;
+		uint32_t ctr_base;
+		uint32_t length;
+		uint8_t section;
+	} sections[] = {
+		{0x200, 0x200, 0x400, N3DS_NCCH_SECTION_EXHEADER},
+		{EXEFS_OFFSET, EXEFS_OFFSET, 0x200, N3DS_NCCH_SECTION_EXEFS},
+		{CODE_OFFSET, EXEFS_OFFSET, CODE_SIZE_ALIGNED, N3DS_NCCH_SECTION_EXEFS},
+		{ICON_OFFSET, EXEFS_OFFSET, ICON_SIZE, N3DS_NCCH_SECTION_EXEFS},
+		{ROMFS_OFFSET, ROMFS_OFFSET, ROMFS_SIZE, N3DS_NCCH_SECTION_ROMFS},
+	};
+
+	m_image = m_data;
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher != nullptr);
+	static const uint8_t zero_key[16] = {0};
+	ASSERT_EQ(0, cipher->setChainingMode(IAesCipher::CM_CTR));
+	ASSERT_EQ(0, cipher->setKey(zero_key, sizeof(zero_key)));
+	const uint64_t tid_be = __swab64(header->hdr.title_id.id);
+	for (size_t i = 0; i < ARRAY_SIZE(sections); i++) {
+		u128_t ctr;
+		ctr.init_ctr(tid_be, sections[i].section, sections[i].address - sections[i].ctr_base);
+		ASSERT_EQ(0, cipher->setIV(ctr.u8, sizeof(ctr.u8)));
+		ASSERT_EQ(sections[i].length, cipher->decrypt(&m_image[sections[i].address], sections[i].length));
+	}
+
+	RpMemFile *const memFile = new RpMemFile(m_image.data(), m_image.size());
+	m_file = new CountingFile(memFile);
+	memFile->unref();
+	m_reader = new NCCHReader(m_file, MEDIA_UNIT_SHIFT, 0, NCCH_LENGTH);
+	ASSERT_TRUE(m_reader->isOpen());
+	ASSERT_TRUE(m_reader->exefsHeader() != nullptr);
+	ASSERT_STREQ(".code", m_reader->exefsHeader()->files[0].name);
+}
+
+/**
+ * Read the whole NCCH in one call.
+ * This spans the ExHeader, ExeFS, and RomFS.
+ */
+TEST_F(NCCHReaderTest, fullRead)
+{
+	vector<uint8_t> buf(NCCH_LENGTH);
+	ASSERT_EQ(0, m_reader->seek(0));
+	ASSERT_EQ(buf.size(), m_reader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+}
+
+/**
+ * Unaligned reads, including reads that span
+ * the ExeFS and RomFS boundary.
+ */
+TEST_F(NCCHReaderTest, unalignedReads)
+{
+	static const struct {
+		unsigned int pos;
+		unsigned int size;
+	} reads[] = {
+		{0x1F3, 0x20},				// NCCH header -> ExHeader
+		{CODE_OFFSET + CODE_SIZE - 5, 0x10},	// end of ".code"
+		{ICON_OFFSET - 0x101, 0x3F03},		// ".code" padding -> "icon"
+		{ICON_OFFSET + 7, 0x8123},		// "icon" -> RomFS
+		{0xFFF1, 0x10013},			// RomFS, spanning three cache blocks
+		{0x31234, 0x100},			// RomFS, non-sequential
+		{0x20010, 0x100},			// RomFS, backwards
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(reads); i++) {
+		vector<uint8_t> buf(reads[i].size);
+		ASSERT_EQ(buf.size(), m_reader->seekAndRead(reads[i].pos, buf.data(), buf.size())) << "pos " << reads[i].pos;
+		EXPECT_EQ(0, memcmp(buf.data(), &m_data[reads[i].pos], buf.size())) << "pos " << reads[i].pos;
+	}
+}
+
+/**
+ * Small sequential reads should be serviced from
+ * the decrypted block cache.
+ */
+TEST_F(NCCHReaderTest, smallReadsUseCache)
+{
+	m_file->reads = 0;
+
+	// 0x100 reads of 0x1F0 bytes: 0x1F000 bytes, starting in the ExeFS.
+	// This covers 0x10000 byte cache blocks 0 and 1, and part of 2.
+	ASSERT_EQ(0, m_reader->seek(ICON_OFFSET));
+	uint32_t pos = ICON_OFFSET;
+	uint8_t buf[0x1F0];
+	for (unsigned int i = 0; i < 0x100; i++, pos += sizeof(buf)) {
+		ASSERT_EQ(sizeof(buf), m_reader->read(buf, sizeof(buf)));
+		ASSERT_EQ(0, memcmp(buf, &m_data[pos], sizeof(buf))) << "pos " << pos;
+	}
+
+	EXPECT_EQ(3U, m_file->reads);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: NCCHReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
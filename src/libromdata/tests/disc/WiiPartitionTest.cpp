@@ -0,0 +1,266 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WiiPartitionTest.cpp: WiiPartition test.                                *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/crypto/Sha1.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpbase/file/IoStats.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// libromdata
+#include "disc/WiiPartition.hpp"
+#include "Console/wii_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class WiiPartitionTest : public ::testing::Test
+{
+	protected:
+		WiiPartitionTest()
+			: m_discReader(nullptr)
+			, m_partition(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			IoStats::setEnabled(false);
+			delete m_partition;
+			delete m_discReader;
+		}
+
+		/**
+		 * Get the number of DiscReader reads between two snapshots.
+		 * @param before Snapshot taken before the I/O.
+		 * @param after Snapshot taken after the I/O.
+		 * @return Number of reads.
+		 */
+		static uint64_t discReaderReads(const vector<IoStats::LayerStats> &before,
+			const vector<IoStats::LayerStats> &after);
+
+	public:
+		// Unencrypted partition with 1K hashes and 31K data. (NASOS)
+		// 80 sectors: One full H3 group and one partial group.
+		static const unsigned int SECTOR_COUNT = 80;
+		static const unsigned int H3_TABLE_OFFSET = 0x8000;
+		static const unsigned int DATA_OFFSET = 0x20000;
+
+	protected:
+		vector<uint8_t> m_image;	// Partition image.
+		vector<uint8_t> m_data;		// Expected partition data.
+		DiscReader *m_discReader;
+		WiiPartition *m_partition;
+};
+
+void WiiPartitionTest::SetUp(void)
+{
+	m_image.resize(DATA_OFFSET + (SECTOR_COUNT * 0x8000));
+	m_data.resize(SECTOR_COUNT * 0x7C00);
+
+	// Partition header.
+	RVL_PartitionHeader *const header = reinterpret_cast<RVL_PartitionHeader*>(m_image.data());
+	header->ticket.signature_type = cpu_to_be32(RVL_SIGNATURE_TYPE_RSA2048);
+	header->h3_table_offset = cpu_to_be32(H3_TABLE_OFFSET >> 2);
+	header->data_offset = cpu_to_be32(DATA_OFFSET >> 2);
+	header->data_size = cpu_to_be32((SECTOR_COUNT * 0x8000) >> 2);
+
+	// Sectors: 0x400 bytes of hashes, then 0x7C00 bytes of data.
+	// H0: Hashes of each 1 KB data block.
+	TestRandom rnd(0x2468ACE0);
+	for (unsigned int sector = 0; sector < SECTOR_COUNT; sector++) {
+		uint8_t *const pSector = &m_image[DATA_OFFSET + (sector * 0x8000)];
+		rnd.fill(&pSector[0x400], 0x7C00);
+		memcpy(&m_data[sector * 0x7C00], &pSector[0x400], 0x7C00);
+
+		RVL_HashBlock *const hashBlock = reinterpret_cast<RVL_HashBlock*>(pSector);
+		for (unsigned int i = 0; i < 31; i++) {
+			Sha1::hash(&pSector[0x400 + (i * 0x400)], 0x400, hashBlock->h0[i]);
+		}
+	}
+
+	// H1: Hashes of each H0 table in the subgroup. (8 sectors)
+	RVL_HashBlock *const hashBlocks = reinterpret_cast<RVL_HashBlock*>(&m_image[DATA_OFFSET]);
+	static const unsigned int HB_STRIDE = 0x8000 / sizeof(RVL_HashBlock);
+	for (unsigned int sg = 0; sg < SECTOR_COUNT / 8; sg++) {
+		uint8_t h1[8][20];
+		for (unsigned int i = 0; i < 8; i++) {
+			const RVL_HashBlock &hb = hashBlocks[((sg * 8) + i) * HB_STRIDE];
+			Sha1::hash(hb.h0, sizeof(hb.h0), h1[i]);
+		}
+		for (unsigned int i = 0; i < 8; i++) {
+			memcpy(hashBlocks[((sg * 8) + i) * HB_STRIDE].h1, h1, sizeof(h1));
+		}
+	}
+
+	// H2: Hashes of each H1 table in the group. (64 sectors)
+	// H3: Hashes of each H2 table.
+	uint8_t *const h3_table = &m_image[H3_TABLE_OFFSET];
+	for (unsigned int g = 0; g < (SECTOR_COUNT + 63) / 64; g++) {
+		uint8_t h2[8][20];
+		memset(h2, 0, sizeof(h2));
+		for (unsigned int sg = 0; sg < 8 && ((g * 64) + (sg * 8)) < SECTOR_COUNT; sg++) {
+			const RVL_HashBlock &hb = hashBlocks[((g * 64) + (sg * 8)) * HB_STRIDE];
+			Sha1::hash(hb.h1, sizeof(hb.h1), h2[sg]);
+		}
+		for (unsigned int i = 0; i < 64 && ((g * 64) + i) < SECTOR_COUNT; i++) {
+			memcpy(hashBlocks[((g * 64) + i) * HB_STRIDE].h2, h2, sizeof(h2));
+		}
+		Sha1::hash(h2, sizeof(h2), &h3_table[g * 20]);
+	}
+
+	// TMD with one content entry containing the H3 table hash.
+	RVL_TMD_Header *const tmdHeader = reinterpret_cast<RVL_TMD_Header*>(header->tmd);
+	tmdHeader->signature_type = cpu_to_be32(RVL_SIGNATURE_TYPE_RSA2048);
+	tmdHeader->nbr_cont = cpu_to_be16(1);
+	RVL_Content_Entry *const content = reinterpret_cast<RVL_Content_Entry*>(&header->tmd[sizeof(*tmdHeader)]);
+	Sha1::hash(h3_table, RVL_H3_TABLE_SIZE, content->sha1_hash);
+
+	RpMemFile *const memFile = new RpMemFile(m_image.data(), m_image.size());
+	m_discReader = new DiscReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(m_discReader->isOpen());
+
+	m_partition = new WiiPartition(m_discReader, 0, m_image.size(), WiiPartition::CM_NASOS);
+	ASSERT_TRUE(m_partition->isOpen());
+}
+
+/**
+ * Get the number of DiscReader reads between two snapshots.
+ * @param before Snapshot taken before the I/O.
+ * @param after Snapshot taken after the I/O.
+ * @return Number of reads.
+ */
+uint64_t WiiPartitionTest::discReaderReads(const vector<IoStats::LayerStats> &before,
+	const vector<IoStats::LayerStats> &after)
+{
+	EXPECT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < before.size() && i < after.size(); i++) {
+		if (!strcmp(after[i].name, "DiscReader")) {
+			return after[i].reads - before[i].reads;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Large unaligned reads spanning multiple sector batches.
+ */
+TEST_F(WiiPartitionTest, largeReads)
+{
+	static const unsigned int START = 0x123;
+	vector<uint8_t> buf(m_data.size() - START);
+	ASSERT_EQ(buf.size(), m_partition->pread(START, buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[START], buf.size()));
+
+	// Aligned read through the end of the partition.
+	ASSERT_EQ(0, m_partition->seek(0x7C00 * 3));
+	ASSERT_EQ(m_data.size() - (0x7C00 * 3), m_partition->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[0x7C00 * 3], m_data.size() - (0x7C00 * 3)));
+}
+
+/**
+ * Small reads alternating between two sectors should
+ * only read each sector from the disc once.
+ */
+TEST_F(WiiPartitionTest, alternatingSectors)
+{
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	static const unsigned int offsets[2] = {0x7C00 * 2 + 0x100, 0x7C00 * 40 + 0x7BF0};
+	uint8_t buf[0x20];
+	for (unsigned int i = 0; i < 100; i++) {
+		const unsigned int pos = offsets[i & 1];
+		ASSERT_EQ(sizeof(buf), m_partition->pread(pos, buf, sizeof(buf)));
+		ASSERT_EQ(0, memcmp(buf, &m_data[pos], sizeof(buf)));
+	}
+
+	IoStats::snapshot(after);
+	// The second offset spans two sectors.
+	EXPECT_EQ(3U, discReaderReads(before, after));
+}
+
+/**
+ * Verify a valid hash tree.
+ */
+TEST_F(WiiPartitionTest, verifyHashes)
+{
+	// Multiple threads and a single thread should have the same result.
+	static const unsigned int threads[] = {0, 1, 4};
+	for (size_t i = 0; i < ARRAY_SIZE(threads); i++) {
+		WiiPartition::HashVerifyResult result;
+		ASSERT_EQ(0, m_partition->verifyHashes(&result, threads[i])) << "threads: " << threads[i];
+		EXPECT_EQ(static_cast<uint32_t>(SECTOR_COUNT), result.clusterCount) << "threads: " << threads[i];
+		EXPECT_TRUE(result.h3TableOK) << "threads: " << threads[i];
+		EXPECT_TRUE(result.badClusters.empty()) << "threads: " << threads[i];
+	}
+}
+
+/**
+ * Verify a hash tree with bad clusters at each level.
+ */
+TEST_F(WiiPartitionTest, verifyHashesBadClusters)
+{
+	// Bad data. (H0)
+	m_image[DATA_OFFSET + (5 * 0x8000) + 0x1234] ^= 0xFF;
+	// Bad H0 table. (H1)
+	m_image[DATA_OFFSET + (17 * 0x8000) + 0x20] ^= 0xFF;
+	// Bad H1 table. (H2)
+	m_image[DATA_OFFSET + (66 * 0x8000) + 0x290] ^= 0xFF;
+	// Bad H2 table. (H3)
+	m_image[DATA_OFFSET + (79 * 0x8000) + 0x350] ^= 0xFF;
+
+	WiiPartition::HashVerifyResult result;
+	ASSERT_EQ(0, m_partition->verifyHashes(&result, 4));
+	EXPECT_EQ(static_cast<uint32_t>(SECTOR_COUNT), result.clusterCount);
+	EXPECT_TRUE(result.h3TableOK);
+
+	static const uint32_t expected[] = {5, 17, 66, 79};
+	ASSERT_EQ(ARRAY_SIZE(expected), result.badClusters.size());
+	for (size_t i = 0; i < ARRAY_SIZE(expected); i++) {
+		EXPECT_EQ(expected[i], result.badClusters[i]);
+	}
+
+	// Bad H3 table.
+	m_image[H3_TABLE_OFFSET + 0x100] ^= 0xFF;
+	ASSERT_EQ(0, m_partition->verifyHashes(&result, 4));
+	EXPECT_FALSE(result.h3TableOK);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WiiPartition tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WuxReaderTest.cpp: WuxReader test.                                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/byteswap.h"
+#include "librpbase/file/IoStats.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+using namespace LibRpBase;
+
+// libromdata
+#include "disc/WuxReader.hpp"
+#include "disc/wux_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class WuxReaderTest : public ::testing::Test
+{
+	protected:
+		WuxReaderTest()
+			: m_file(nullptr)
+			, m_reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			IoStats::setEnabled(false);
+			delete m_reader;
+			if (m_file) {
+				m_file->unref();
+			}
+		}
+
+		/**
+		 * Get the statistics for a layer between two snapshots.
+		 * @param before Snapshot taken before the I/O.
+		 * @param after Snapshot taken after the I/O.
+		 * @param name Layer name.
+		 * @return Layer statistics. (name is nullptr if the layer wasn't found)
+		 */
+		static IoStats::LayerStats diff(const vector<IoStats::LayerStats> &before,
+			const vector<IoStats::LayerStats> &after, const char *name);
+
+	public:
+		static const unsigned int BLOCK_SIZE = 256;
+		static const unsigned int LOGICAL_BLOCK_COUNT = 6;
+
+	protected:
+		vector<uint8_t> m_image;	// .wux image.
+		vector<uint8_t> m_data;		// Expected logical data.
+		RpMemFile *m_file;
+		WuxReader *m_reader;
+};
+
+void WuxReaderTest::SetUp(void)
+{
+	// Three physical blocks, deduplicated into six logical blocks.
+	static const uint32_t idxTbl[LOGICAL_BLOCK_COUNT] = {0, 1, 0, 2, 2, 1};
+
+	wuxHeader_t wuxHeader;
+	memset(&wuxHeader, 0, sizeof(wuxHeader));
+	wuxHeader.magic[0] = cpu_to_le32(WUX_MAGIC_0);
+	wuxHeader.magic[1] = cpu_to_le32(WUX_MAGIC_1);
+	wuxHeader.sectorSize = cpu_to_le32(BLOCK_SIZE);
+	wuxHeader.uncompressedSize = cpu_to_le64(LOGICAL_BLOCK_COUNT * BLOCK_SIZE);
+
+	// Data starts at the first block boundary after the index table.
+	const size_t dataOffset = BLOCK_SIZE;
+	m_image.assign(dataOffset + 3 * BLOCK_SIZE, 0);
+	memcpy(m_image.data(), &wuxHeader, sizeof(wuxHeader));
+	for (unsigned int i = 0; i < LOGICAL_BLOCK_COUNT; i++) {
+		const uint32_t idx = cpu_to_le32(idxTbl[i]);
+		memcpy(&m_image[sizeof(wuxHeader) + i * sizeof(idx)], &idx, sizeof(idx));
+	}
+	for (size_t i = dataOffset; i < m_image.size(); i++) {
+		m_image[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+	}
+
+	m_data.resize(LOGICAL_BLOCK_COUNT * BLOCK_SIZE);
+	for (unsigned int i = 0; i < LOGICAL_BLOCK_COUNT; i++) {
+		memcpy(&m_data[i * BLOCK_SIZE], &m_image[dataOffset + idxTbl[i] * BLOCK_SIZE], BLOCK_SIZE);
+	}
+
+	m_file = new RpMemFile(m_image.data(), m_image.size());
+	m_reader = new WuxReader(m_file);
+	ASSERT_TRUE(m_reader->isOpen());
+}
+
+/**
+ * Get the statistics for a layer between two snapshots.
+ * @param before Snapshot taken before the I/O.
+ * @param after Snapshot taken after the I/O.
+ * @param name Layer name.
+ * @return Layer statistics. (name is nullptr if the layer wasn't found)
+ */
+IoStats::LayerStats WuxReaderTest::diff(const vector<IoStats::LayerStats> &before,
+	const vector<IoStats::LayerStats> &after, const char *name)
+{
+	IoStats::LayerStats ret;
+	memset(&ret, 0, sizeof(ret));
+
+	EXPECT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < before.size() && i < after.size(); i++) {
+		if (!strcmp(after[i].name, name)) {
+			ret.name = after[i].name;
+			ret.reads = after[i].reads - before[i].reads;
+			ret.bytesRead = after[i].bytesRead - before[i].bytesRead;
+			ret.seeks = after[i].seeks - before[i].seeks;
+			ret.consumed = after[i].consumed - before[i].consumed;
+			break;
+		}
+	}
+	return ret;
+}
+
+/**
+ * Read the whole disc with I/O statistics enabled.
+ * The reads must be counted in the WuxReader layer.
+ */
+TEST_F(WuxReaderTest, ioStats)
+{
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	vector<uint8_t> buf(m_data.size());
+	ASSERT_EQ(0, m_reader->seek(0));
+	ASSERT_EQ(buf.size(), m_reader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+
+	uint8_t buf2[100];
+	ASSERT_EQ(sizeof(buf2), m_reader->pread(BLOCK_SIZE + 10, buf2, sizeof(buf2)));
+	EXPECT_EQ(0, memcmp(buf2, &m_data[BLOCK_SIZE + 10], sizeof(buf2)));
+
+	IoStats::snapshot(after);
+
+	const IoStats::LayerStats wux = diff(before, after, "WuxReader");
+	ASSERT_TRUE(wux.name != nullptr) << "WuxReader layer was not registered";
+	EXPECT_EQ(2U, wux.reads);
+	EXPECT_EQ(buf.size() + sizeof(buf2), wux.bytesRead);
+	EXPECT_EQ(1U, wux.seeks);
+	EXPECT_EQ(buf.size() + sizeof(buf2), wux.consumed);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WuxReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -38,6 +38,7 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	, file(nullptr)
 	, fields(new RomFields())
 	, metaData(nullptr)
+	, fieldsTabsLoaded(RomFields::TAB_MASK_NONE)
 	, className(nullptr)
 	, fileType(RomData::FTYPE_ROM_IMAGE)
 {
@@ -658,23 +659,77 @@ int RomData::loadMetaData(void)
 	return -ENOSYS;
 }
 
+/**
+ * Load field data for the specified tabs.
+ * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+ *
+ * The default implementation loads all tabs using loadFieldData().
+ * Subclasses with expensive tabs can override this to skip tabs that
+ * weren't requested. Fields for a tab must be added in a single call,
+ * and tab indexes must not depend on which tabs were requested.
+ * The names of all tabs must be set by the first call, even if they
+ * weren't requested, so frontends can create the tabs before loading them.
+ *
+ * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int RomData::loadFieldTabs(uint32_t tabMask)
+{
+	RP_UNUSED(tabMask);
+	RP_D(RomData);
+	int ret = loadFieldData();
+	if (ret >= 0) {
+		// All tabs were loaded.
+		d->fieldsTabsLoaded = RomFields::TAB_MASK_ALL;
+	}
+	return ret;
+}
+
 /**
  * Get the ROM Fields object.
  * @return ROM Fields object.
  */
 const RomFields *RomData::fields(void) const
 {
-	RP_D(const RomData);
-	if (d->fields->empty()) {
-		// Data has not been loaded.
-		// Load it now.
-		int ret = const_cast<RomData*>(this)->loadFieldData();
+	return fields(RomFields::TAB_MASK_ALL);
+}
+
+/**
+ * Get the ROM Fields object, loading only the specified tabs.
+ *
+ * Tabs that weren't requested might not be loaded, but the
+ * subclass is allowed to load them anyway. Fields are stored
+ * in the order they were loaded, so if tabs are requested in
+ * separate calls, use RomFields::Field::tabIdx to group them.
+ *
+ * @param tabMask RomFields::TabMask of tabs to load.
+ * @return ROM Fields object.
+ */
+const RomFields *RomData::fields(uint32_t tabMask) const
+{
+	RP_D(RomData);
+	const RomFields::TabMask toLoad = (tabMask & ~d->fieldsTabsLoaded);
+	if (toLoad != RomFields::TAB_MASK_NONE) {
+		// Some of the requested tabs have not been loaded.
+		// Load them now.
+		int ret = const_cast<RomData*>(this)->loadFieldTabs(toLoad);
 		if (ret < 0)
 			return nullptr;
+		d->fieldsTabsLoaded |= toLoad;
 	}
 	return d->fields;
 }
 
+/**
+ * Get the tabs that have been loaded by fields().
+ * @return RomFields::TabMask of loaded tabs.
+ */
+uint32_t RomData::fieldTabsLoaded(void) const
+{
+	RP_D(const RomData);
+	return d->fieldsTabsLoaded;
+}
+
 /**
  * Get the ROM Metadata object.
  * @return ROM Metadata object.
@@ -692,6 +747,32 @@ const RomMetaData *RomData::metaData(void) const
 	return d->metaData;
 }
 
+/**
+ * Use fields and metadata that were loaded previously,
+ * e.g. from a cache, instead of loading them from the ROM.
+ *
+ * This must be called before fields() or metaData().
+ * Ownership of the objects is transferred to this RomData.
+ *
+ * @param fields	[in,opt] RomFields, or nullptr to load the fields normally.
+ * @param metaData	[in,opt] RomMetaData, or nullptr to load the metadata normally.
+ */
+void RomData::setCachedData(RomFields *fields, RomMetaData *metaData)
+{
+	RP_D(RomData);
+	if (fields) {
+		assert(d->fieldsTabsLoaded == RomFields::TAB_MASK_NONE);
+		delete d->fields;
+		d->fields = fields;
+		d->fieldsTabsLoaded = RomFields::TAB_MASK_ALL;
+	}
+	if (metaData) {
+		assert(!d->metaData || d->metaData->empty());
+		delete d->metaData;
+		d->metaData = metaData;
+	}
+}
+
 /**
  * Get an internal image from the ROM.
  *
@@ -387,6 +387,22 @@ class RomData
 		 */
 		virtual int loadFieldData(void) = 0;
 
+		/**
+		 * Load field data for the specified tabs.
+		 * Called by RomData::fields() if any of the requested tabs haven't been loaded yet.
+		 *
+		 * The default implementation loads all tabs using loadFieldData().
+		 * Subclasses with expensive tabs can override this to skip tabs that
+		 * weren't requested. Fields for a tab must be added in a single call,
+		 * and tab indexes must not depend on which tabs were requested.
+		 * The names of all tabs must be set by the first call, even if they
+		 * weren't requested, so frontends can create the tabs before loading them.
+		 *
+		 * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.)
+		 * @return Number of fields read on success; negative POSIX error code on error.
+		 */
+		virtual int loadFieldTabs(uint32_t tabMask);
+
 		/**
 		 * Load metadata properties.
 		 * Called by RomData::metaData() if the field data hasn't been loaded yet.
@@ -413,12 +429,43 @@ class RomData
 		 */
 		const RomFields *fields(void) const;
 
+		/**
+		 * Get the ROM Fields object, loading only the specified tabs.
+		 *
+		 * Tabs that weren't requested might not be loaded, but the
+		 * subclass is allowed to load them anyway. Fields are stored
+		 * in the order they were loaded, so if tabs are requested in
+		 * separate calls, use RomFields::Field::tabIdx to group them.
+		 *
+		 * @param tabMask RomFields::TabMask of tabs to load.
+		 * @return ROM Fields object.
+		 */
+		const RomFields *fields(uint32_t tabMask) const;
+
+		/**
+		 * Get the tabs that have been loaded by fields().
+		 * @return RomFields::TabMask of loaded tabs.
+		 */
+		uint32_t fieldTabsLoaded(void) const;
+
 		/**
 		 * Get the ROM Metadata object.
 		 * @return ROM Metadata object.
 		 */
 		const RomMetaData *metaData(void) const;
 
+		/**
+		 * Use fields and metadata that were loaded previously,
+		 * e.g. from a cache, instead of loading them from the ROM.
+		 *
+		 * This must be called before fields() or metaData().
+		 * Ownership of the objects is transferred to this RomData.
+		 *
+		 * @param fields	[in,opt] RomFields, or nullptr to load the fields normally.
+		 * @param metaData	[in,opt] RomMetaData, or nullptr to load the metadata normally.
+		 */
+		void setCachedData(RomFields *fields, RomMetaData *metaData);
+
 	private:
 		/**
 		 * Verify that the specified image type has been loaded.
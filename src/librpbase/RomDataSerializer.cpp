@@ -0,0 +1,885 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RomDataSerializer.cpp: RomFields/RomMetaData binary serialization.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomDataSerializer.hpp"
+#include "RomFields.hpp"
+#include "RomMetaData.hpp"
+#include "byteswap.h"
+
+// C++ includes.
+using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::vector;
+
+using LibRpTexture::rp_image;
+
+namespace LibRpBase { namespace RomDataSerializer {
+
+/** Serialization **/
+
+/**
+ * Serialization buffers.
+ * Strings are deduplicated.
+ */
+class RdsWriter
+{
+	public:
+		RdsWriter() { }
+
+	private:
+		RP_DISABLE_COPY(RdsWriter)
+
+	public:
+		/**
+		 * Add a string to the string table.
+		 * @param str String.
+		 * @return String reference.
+		 */
+		uint32_t addString(const string &str)
+		{
+			auto iter = map_strings.find(str);
+			if (iter != map_strings.end()) {
+				return iter->second;
+			}
+
+			const uint32_t ref = static_cast<uint32_t>(strtbl.size());
+			const uint32_t len = cpu_to_le32(static_cast<uint32_t>(str.size()));
+			strtbl.append(reinterpret_cast<const char*>(&len), sizeof(len));
+			strtbl.append(str);
+			// NULL terminator, plus padding to a multiple of 4 bytes.
+			strtbl.append(4 - (str.size() & 3), '\0');
+			map_strings.insert(std::make_pair(str, ref));
+			return ref;
+		}
+
+		/**
+		 * Add a string to the string table.
+		 * @param str String. (may be nullptr)
+		 * @return String reference, or RDS_NULL if str is nullptr.
+		 */
+		inline uint32_t addString(const string *str)
+		{
+			return (str ? addString(*str) : RDS_NULL);
+		}
+
+		/**
+		 * Reserve words in the data area.
+		 * @param count Number of words.
+		 * @return Word index of the first reserved word.
+		 */
+		inline uint32_t reserveWords(size_t count)
+		{
+			const uint32_t idx = static_cast<uint32_t>(data.size());
+			data.resize(data.size() + count);
+			return idx;
+		}
+
+		/**
+		 * Set a word in the data area.
+		 * @param idx Word index.
+		 * @param value Value.
+		 */
+		inline void setWord(uint32_t idx, uint32_t value)
+		{
+			data[idx] = cpu_to_le32(value);
+		}
+
+		/**
+		 * Add a string list to the data area.
+		 * @param vec String list. (may be nullptr)
+		 * @return Word index, or RDS_NULL if vec is nullptr.
+		 */
+		uint32_t addStringList(const vector<string> *vec)
+		{
+			if (!vec)
+				return RDS_NULL;
+
+			const uint32_t idx = reserveWords(1 + vec->size());
+			setWord(idx, static_cast<uint32_t>(vec->size()));
+			uint32_t i = idx + 1;
+			for (auto iter = vec->cbegin(); iter != vec->cend(); ++iter, i++) {
+				setWord(i, addString(*iter));
+			}
+			return idx;
+		}
+
+		/**
+		 * Add single-language ListData to the data area.
+		 * @param list_data ListData. (may be nullptr)
+		 * @return Word index, or RDS_NULL if list_data is nullptr.
+		 */
+		uint32_t addListData(const RomFields::ListData_t *list_data)
+		{
+			if (!list_data)
+				return RDS_NULL;
+
+			const uint32_t idx = reserveWords(1 + list_data->size());
+			setWord(idx, static_cast<uint32_t>(list_data->size()));
+			uint32_t i = idx + 1;
+			for (auto iter = list_data->cbegin(); iter != list_data->cend(); ++iter, i++) {
+				// NOTE: addStringList() may reallocate the data area,
+				// so the index must be stored after it returns.
+				const uint32_t row_idx = addStringList(&(*iter));
+				setWord(i, row_idx);
+			}
+			return idx;
+		}
+
+	public:
+		vector<uint32_t> data;		// Data area. (little-endian)
+		string strtbl;			// String table.
+
+	private:
+		unordered_map<string, uint32_t> map_strings;
+};
+
+/**
+ * Serialize a RomFields object.
+ * @param fields	[in] RomFields object.
+ * @param buf		[out] Output buffer. (existing contents will be replaced)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int serializeFields(const RomFields *fields, ao::uvector<uint8_t> &buf)
+{
+	assert(fields != nullptr);
+	if (!fields)
+		return -EINVAL;
+
+	RdsWriter writer;
+	vector<RDS_Field> vec_fields;
+	vec_fields.reserve(fields->count());
+
+	// Tab names.
+	const int tabCount = fields->tabCount();
+	const uint32_t tabs_idx = writer.reserveWords(tabCount);
+	for (int i = 0; i < tabCount; i++) {
+		const char *const tabName = fields->tabName(i);
+		writer.setWord(tabs_idx + i, (tabName ? writer.addString(tabName) : RDS_NULL));
+	}
+
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid || field.type == RomFields::RFT_INVALID)
+			continue;
+
+		RDS_Field rdsField;
+		rdsField.type = field.type;
+		rdsField.tabIdx = field.tabIdx;
+		rdsField.reserved = 0;
+		rdsField.flags = 0;
+		rdsField.name = writer.addString(field.name);
+		rdsField.data_idx = RDS_NULL;
+		rdsField.value = 0;
+
+		switch (field.type) {
+			case RomFields::RFT_STRING:
+				rdsField.flags = field.desc.flags;
+				rdsField.value = writer.addString(field.data.str);
+				break;
+
+			case RomFields::RFT_BITFIELD: {
+				rdsField.value = field.data.bitfield;
+				const uint32_t names_idx = writer.addStringList(field.desc.bitfield.names);
+				rdsField.data_idx = writer.reserveWords(2);
+				writer.setWord(rdsField.data_idx, field.desc.bitfield.elemsPerRow);
+				writer.setWord(rdsField.data_idx + 1, names_idx);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				const unsigned int flags = field.desc.list_data.flags;
+				rdsField.flags = flags;
+
+				const uint32_t names_idx = writer.addStringList(field.desc.list_data.names);
+				uint32_t list_idx;
+				if (flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataMultiMap_t *const multi = field.data.list_data.data.multi;
+					if (multi) {
+						list_idx = writer.reserveWords(1 + (multi->size() * 2));
+						writer.setWord(list_idx, static_cast<uint32_t>(multi->size()));
+						uint32_t i = list_idx + 1;
+						for (auto mIter = multi->cbegin(); mIter != multi->cend(); ++mIter, i += 2) {
+							const uint32_t single_idx = writer.addListData(&mIter->second);
+							writer.setWord(i, mIter->first);
+							writer.setWord(i + 1, single_idx);
+						}
+					} else {
+						list_idx = RDS_NULL;
+					}
+				} else {
+					list_idx = writer.addListData(field.data.list_data.data.single);
+				}
+
+				uint32_t mxd = 0;
+				if (flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					mxd = field.data.list_data.mxd.checkboxes;
+				} else if (flags & RomFields::RFT_LISTDATA_ICONS) {
+					// Icons are stored by reference.
+					const RomFields::ListDataIcons_t *const icons = field.data.list_data.mxd.icons;
+					if (icons) {
+						mxd = writer.reserveWords(1 + icons->size());
+						writer.setWord(mxd, static_cast<uint32_t>(icons->size()));
+						for (uint32_t i = 0; i < icons->size(); i++) {
+							writer.setWord(mxd + 1 + i, (icons->at(i) ? i : RDS_NULL));
+						}
+					} else {
+						mxd = RDS_NULL;
+					}
+				}
+
+				rdsField.data_idx = writer.reserveWords(6);
+				writer.setWord(rdsField.data_idx + 0, field.desc.list_data.rows_visible);
+				writer.setWord(rdsField.data_idx + 1, field.desc.list_data.alignment.headers);
+				writer.setWord(rdsField.data_idx + 2, field.desc.list_data.alignment.data);
+				writer.setWord(rdsField.data_idx + 3, names_idx);
+				writer.setWord(rdsField.data_idx + 4, list_idx);
+				writer.setWord(rdsField.data_idx + 5, mxd);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				rdsField.flags = field.desc.flags;
+				rdsField.value = field.data.date_time;
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				const RomFields::age_ratings_t *const age_ratings = field.data.age_ratings;
+				if (!age_ratings)
+					break;
+				static_assert(RomFields::AGE_MAX % 2 == 0, "RomFields::AGE_MAX must be a multiple of 2.");
+				rdsField.data_idx = writer.reserveWords(RomFields::AGE_MAX / 2);
+				for (unsigned int i = 0; i < RomFields::AGE_MAX / 2; i++) {
+					writer.setWord(rdsField.data_idx + i,
+						(*age_ratings)[i*2] | ((*age_ratings)[i*2 + 1] << 16));
+				}
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS:
+				rdsField.data_idx = writer.reserveWords(3);
+				for (unsigned int i = 0; i < 3; i++) {
+					writer.setWord(rdsField.data_idx + i, field.data.dimensions[i]);
+				}
+				break;
+
+			case RomFields::RFT_STRING_MULTI: {
+				rdsField.flags = field.desc.flags;
+				const RomFields::StringMultiMap_t *const str_multi = field.data.str_multi;
+				if (!str_multi)
+					break;
+				rdsField.data_idx = writer.reserveWords(1 + (str_multi->size() * 2));
+				writer.setWord(rdsField.data_idx, static_cast<uint32_t>(str_multi->size()));
+				uint32_t i = rdsField.data_idx + 1;
+				for (auto mIter = str_multi->cbegin(); mIter != str_multi->cend(); ++mIter, i += 2) {
+					writer.setWord(i, mIter->first);
+					writer.setWord(i + 1, writer.addString(mIter->second));
+				}
+				break;
+			}
+
+			default:
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				return -EINVAL;
+		}
+
+		// Byteswap the field record.
+		rdsField.flags = cpu_to_le32(rdsField.flags);
+		rdsField.name = cpu_to_le32(rdsField.name);
+		rdsField.data_idx = cpu_to_le32(rdsField.data_idx);
+		rdsField.value = cpu_to_le64(rdsField.value);
+		vec_fields.push_back(rdsField);
+	}
+
+	// Assemble the output buffer.
+	const size_t data_offset = sizeof(RDS_FieldsHeader) + (vec_fields.size() * sizeof(RDS_Field));
+	const size_t strtbl_offset = data_offset + (writer.data.size() * sizeof(uint32_t));
+	const size_t total_size = strtbl_offset + writer.strtbl.size();
+	if (total_size > 0xFFFFFFFFU) {
+		// Too big.
+		return -E2BIG;
+	}
+	buf.resize(total_size);
+
+	RDS_FieldsHeader *const header = reinterpret_cast<RDS_FieldsHeader*>(buf.data());
+	memcpy(header->magic, "RPRF", sizeof(header->magic));
+	header->version = cpu_to_le16(RDS_VERSION);
+	header->field_size = cpu_to_le16(static_cast<uint16_t>(sizeof(RDS_Field)));
+	header->field_count = cpu_to_le32(static_cast<uint32_t>(vec_fields.size()));
+	header->tab_count = cpu_to_le32(static_cast<uint32_t>(tabCount));
+	header->tabs_idx = cpu_to_le32(tabs_idx);
+	header->def_lc = cpu_to_le32(fields->defaultLanguageCode());
+	header->data_offset = cpu_to_le32(static_cast<uint32_t>(data_offset));
+	header->data_count = cpu_to_le32(static_cast<uint32_t>(writer.data.size()));
+	header->strtbl_offset = cpu_to_le32(static_cast<uint32_t>(strtbl_offset));
+	header->strtbl_size = cpu_to_le32(static_cast<uint32_t>(writer.strtbl.size()));
+
+	if (!vec_fields.empty()) {
+		memcpy(&buf[sizeof(RDS_FieldsHeader)], vec_fields.data(), vec_fields.size() * sizeof(RDS_Field));
+	}
+	if (!writer.data.empty()) {
+		memcpy(&buf[data_offset], writer.data.data(), writer.data.size() * sizeof(uint32_t));
+	}
+	if (!writer.strtbl.empty()) {
+		memcpy(&buf[strtbl_offset], writer.strtbl.data(), writer.strtbl.size());
+	}
+	return 0;
+}
+
+/**
+ * Serialize a RomMetaData object.
+ * @param metaData	[in] RomMetaData object.
+ * @param buf		[out] Output buffer. (existing contents will be replaced)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int serializeMetaData(const RomMetaData *metaData, ao::uvector<uint8_t> &buf)
+{
+	assert(metaData != nullptr);
+	if (!metaData)
+		return -EINVAL;
+
+	RdsWriter writer;
+	const int count = metaData->count();
+	vector<RDS_MetaData> vec_props;
+	vec_props.reserve(count);
+
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		if (!prop || prop->type == PropertyType::Invalid)
+			continue;
+
+		RDS_MetaData rdsProp;
+		rdsProp.name = static_cast<uint8_t>(prop->name);
+		rdsProp.type = static_cast<uint8_t>(prop->type);
+		rdsProp.reserved1 = 0;
+		rdsProp.reserved2 = 0;
+		switch (prop->type) {
+			case PropertyType::Integer:
+				rdsProp.value = prop->data.ivalue;
+				break;
+			case PropertyType::UnsignedInteger:
+				rdsProp.value = prop->data.uvalue;
+				break;
+			case PropertyType::String:
+				rdsProp.value = writer.addString(prop->data.str);
+				break;
+			case PropertyType::Timestamp:
+				rdsProp.value = prop->data.timestamp;
+				break;
+			default:
+				assert(!"Unsupported RomMetaData PropertyType.");
+				return -EINVAL;
+		}
+
+		rdsProp.value = cpu_to_le64(rdsProp.value);
+		vec_props.push_back(rdsProp);
+	}
+
+	// Assemble the output buffer.
+	const size_t strtbl_offset = sizeof(RDS_MetaDataHeader) + (vec_props.size() * sizeof(RDS_MetaData));
+	const size_t total_size = strtbl_offset + writer.strtbl.size();
+	if (total_size > 0xFFFFFFFFU) {
+		// Too big.
+		return -E2BIG;
+	}
+	buf.resize(total_size);
+
+	RDS_MetaDataHeader *const header = reinterpret_cast<RDS_MetaDataHeader*>(buf.data());
+	memcpy(header->magic, "RPMD", sizeof(header->magic));
+	header->version = cpu_to_le16(RDS_VERSION);
+	header->prop_size = cpu_to_le16(static_cast<uint16_t>(sizeof(RDS_MetaData)));
+	header->prop_count = cpu_to_le32(static_cast<uint32_t>(vec_props.size()));
+	header->strtbl_offset = cpu_to_le32(static_cast<uint32_t>(strtbl_offset));
+	header->strtbl_size = cpu_to_le32(static_cast<uint32_t>(writer.strtbl.size()));
+	header->reserved = 0;
+
+	if (!vec_props.empty()) {
+		memcpy(&buf[sizeof(RDS_MetaDataHeader)], vec_props.data(), vec_props.size() * sizeof(RDS_MetaData));
+	}
+	if (!writer.strtbl.empty()) {
+		memcpy(&buf[strtbl_offset], writer.strtbl.data(), writer.strtbl.size());
+	}
+	return 0;
+}
+
+/** Deserialization **/
+
+/**
+ * Bounds-checked reader for the data area and string table.
+ */
+class RdsReader
+{
+	public:
+		RdsReader(const uint8_t *data, uint32_t data_count,
+			  const uint8_t *strtbl, uint32_t strtbl_size)
+			: data(data)
+			, data_count(data_count)
+			, strtbl(strtbl)
+			, strtbl_size(strtbl_size)
+		{ }
+
+	private:
+		RP_DISABLE_COPY(RdsReader)
+
+	public:
+		/**
+		 * Get a word from the data area.
+		 * @param idx Word index.
+		 * @param pValue Output value.
+		 * @return True on success; false if out of range.
+		 */
+		inline bool getWord(uint32_t idx, uint32_t *pValue) const
+		{
+			if (idx >= data_count)
+				return false;
+			*pValue = word(idx);
+			return true;
+		}
+
+		/**
+		 * Get a word from the data area without bounds checking.
+		 * The range must have been validated with checkWords().
+		 * @param idx Word index.
+		 * @return Value.
+		 */
+		inline uint32_t word(uint32_t idx) const
+		{
+			uint32_t value;
+			memcpy(&value, &data[idx * sizeof(uint32_t)], sizeof(value));
+			return le32_to_cpu(value);
+		}
+
+		/**
+		 * Check that a range of words is in the data area.
+		 * @param idx Word index.
+		 * @param count Number of words.
+		 * @return True if the range is valid; false if not.
+		 */
+		inline bool checkWords(uint32_t idx, uint32_t count) const
+		{
+			return (idx <= data_count && count <= data_count - idx);
+		}
+
+		/**
+		 * Get a string from the string table.
+		 * The string is not copied.
+		 * @param ref String reference.
+		 * @param pStr Output string pointer. (NULL-terminated)
+		 * @param pLen Output string length.
+		 * @return True on success; false if out of range.
+		 */
+		bool getString(uint32_t ref, const char **pStr, uint32_t *pLen) const
+		{
+			if (ref > strtbl_size || strtbl_size - ref < sizeof(uint32_t))
+				return false;
+			uint32_t len;
+			memcpy(&len, &strtbl[ref], sizeof(len));
+			len = le32_to_cpu(len);
+			// Length must include the NULL terminator.
+			if (len >= strtbl_size - ref - sizeof(uint32_t))
+				return false;
+			const char *const str = reinterpret_cast<const char*>(&strtbl[ref + sizeof(uint32_t)]);
+			if (str[len] != '\0')
+				return false;
+			*pStr = str;
+			*pLen = len;
+			return true;
+		}
+
+		/**
+		 * Allocate a string from the string table.
+		 * @param ref String reference.
+		 * @param str Output string.
+		 * @return True on success; false if out of range.
+		 */
+		inline bool getString(uint32_t ref, string &str) const
+		{
+			const char *s;
+			uint32_t len;
+			if (!getString(ref, &s, &len))
+				return false;
+			str.assign(s, len);
+			return true;
+		}
+
+		/**
+		 * Allocate a string list from the data area.
+		 * @param idx Word index.
+		 * @param vec Output vector.
+		 * @return True on success; false on error.
+		 */
+		bool getStringList(uint32_t idx, vector<string> &vec) const
+		{
+			uint32_t count;
+			if (!getWord(idx, &count) || !checkWords(idx + 1, count))
+				return false;
+			vec.resize(count);
+			for (uint32_t i = 0; i < count; i++) {
+				const uint32_t ref = word(idx + 1 + i);
+				if (!getString(ref, vec[i]))
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * Allocate single-language ListData from the data area.
+		 * @param idx Word index.
+		 * @param list_data Output ListData.
+		 * @return True on success; false on error.
+		 */
+		bool getListData(uint32_t idx, RomFields::ListData_t &list_data) const
+		{
+			uint32_t count;
+			if (!getWord(idx, &count) || !checkWords(idx + 1, count))
+				return false;
+			list_data.resize(count);
+			for (uint32_t i = 0; i < count; i++) {
+				const uint32_t row_idx = word(idx + 1 + i);
+				if (!getStringList(row_idx, list_data[i]))
+					return false;
+			}
+			return true;
+		}
+
+	private:
+		const uint8_t *const data;
+		const uint32_t data_count;
+		const uint8_t *const strtbl;
+		const uint32_t strtbl_size;
+};
+
+/**
+ * Deserialize a RomFields object.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @param pfnResolveIcon	[in,opt] Icon reference callback. If nullptr, icons will be nullptr.
+ * @param userdata	[in,opt] User data for pfnResolveIcon.
+ * @return RomFields object, or nullptr on error. (Caller must delete it.)
+ */
+RomFields *deserializeFields(const uint8_t *buf, size_t size,
+	pfnResolveIcon_t pfnResolveIcon, void *userdata)
+{
+	assert(buf != nullptr);
+	if (!buf || size < sizeof(RDS_FieldsHeader))
+		return nullptr;
+
+	// Check the header.
+	RDS_FieldsHeader header;
+	memcpy(&header, buf, sizeof(header));
+	if (memcmp(header.magic, "RPRF", sizeof(header.magic)) != 0 ||
+	    le16_to_cpu(header.version) != RDS_VERSION ||
+	    le16_to_cpu(header.field_size) != sizeof(RDS_Field))
+	{
+		// Incorrect header.
+		return nullptr;
+	}
+
+	const uint32_t field_count = le32_to_cpu(header.field_count);
+	const uint32_t tab_count = le32_to_cpu(header.tab_count);
+	const uint32_t tabs_idx = le32_to_cpu(header.tabs_idx);
+	const uint32_t data_offset = le32_to_cpu(header.data_offset);
+	const uint32_t data_count = le32_to_cpu(header.data_count);
+	const uint32_t strtbl_offset = le32_to_cpu(header.strtbl_offset);
+	const uint32_t strtbl_size = le32_to_cpu(header.strtbl_size);
+
+	// Validate the offsets.
+	if (static_cast<uint64_t>(field_count) * sizeof(RDS_Field) > size - sizeof(header) ||
+	    data_offset < sizeof(header) + (static_cast<uint64_t>(field_count) * sizeof(RDS_Field)) ||
+	    data_offset > size || static_cast<uint64_t>(data_count) * sizeof(uint32_t) > size - data_offset ||
+	    strtbl_offset > size || strtbl_size > size - strtbl_offset ||
+	    tab_count > 256)
+	{
+		// Out of range.
+		return nullptr;
+	}
+
+	const RdsReader reader(&buf[data_offset], data_count, &buf[strtbl_offset], strtbl_size);
+	unique_ptr<RomFields> fields(new RomFields());
+
+	// Tab names.
+	if (tab_count > 0) {
+		if (!reader.checkWords(tabs_idx, tab_count))
+			return nullptr;
+		fields->reserveTabs(static_cast<int>(tab_count));
+		for (uint32_t i = 0; i < tab_count; i++) {
+			const uint32_t ref = reader.word(tabs_idx + i);
+			string tabName;
+			if (ref != RDS_NULL && !reader.getString(ref, tabName))
+				return nullptr;
+			fields->setTabName(static_cast<int>(i), tabName.c_str());
+		}
+	}
+
+	const uint32_t def_lc = le32_to_cpu(header.def_lc);
+	const uint8_t *pField = &buf[sizeof(header)];
+	for (uint32_t fieldIdx = 0; fieldIdx < field_count; fieldIdx++, pField += sizeof(RDS_Field)) {
+		RDS_Field rdsField;
+		memcpy(&rdsField, pField, sizeof(rdsField));
+		const uint32_t flags = le32_to_cpu(rdsField.flags);
+		const uint32_t data_idx = le32_to_cpu(rdsField.data_idx);
+		const int64_t value = le64_to_cpu(rdsField.value);
+
+		string name;
+		if (!reader.getString(le32_to_cpu(rdsField.name), name))
+			return nullptr;
+		fields->setTabIndex(rdsField.tabIdx);
+
+		switch (rdsField.type) {
+			case RomFields::RFT_STRING: {
+				const uint32_t ref = static_cast<uint32_t>(value);
+				if (ref == RDS_NULL) {
+					fields->addField_string(name.c_str(), static_cast<const char*>(nullptr), flags);
+					break;
+				}
+				string str;
+				if (!reader.getString(ref, str))
+					return nullptr;
+				fields->addField_string(name.c_str(), str, flags);
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				if (!reader.checkWords(data_idx, 2))
+					return nullptr;
+				const uint32_t elemsPerRow = reader.word(data_idx);
+				const uint32_t names_idx = reader.word(data_idx + 1);
+
+				vector<string> *bit_names = nullptr;
+				if (names_idx != RDS_NULL) {
+					bit_names = new vector<string>();
+					if (!reader.getStringList(names_idx, *bit_names)) {
+						delete bit_names;
+						return nullptr;
+					}
+				}
+				fields->addField_bitfield(name.c_str(), bit_names,
+					static_cast<int>(elemsPerRow), static_cast<uint32_t>(value));
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				uint32_t words[6];
+				if (!reader.checkWords(data_idx, ARRAY_SIZE(words)))
+					return nullptr;
+				for (unsigned int i = 0; i < ARRAY_SIZE(words); i++) {
+					words[i] = reader.word(data_idx + i);
+				}
+
+				RomFields::AFLD_PARAMS params(flags, static_cast<int>(words[0]));
+				params.alignment.headers = words[1];
+				params.alignment.data = words[2];
+				params.def_lc = def_lc;
+
+				// NOTE: unique_ptr<> is used until the
+				// data is handed off to the RomFields object.
+				unique_ptr<vector<string> > headers;
+				if (words[3] != RDS_NULL) {
+					headers.reset(new vector<string>());
+					if (!reader.getStringList(words[3], *headers))
+						return nullptr;
+				}
+
+				unique_ptr<RomFields::ListData_t> single;
+				unique_ptr<RomFields::ListDataMultiMap_t> multi;
+				if (words[4] != RDS_NULL) {
+					if (flags & RomFields::RFT_LISTDATA_MULTI) {
+						uint32_t count;
+						if (!reader.getWord(words[4], &count) ||
+						    count > data_count / 2 ||
+						    !reader.checkWords(words[4] + 1, count * 2))
+						{
+							return nullptr;
+						}
+						multi.reset(new RomFields::ListDataMultiMap_t());
+						for (uint32_t i = 0; i < count; i++) {
+							const uint32_t lc = reader.word(words[4] + 1 + (i * 2));
+							const uint32_t single_idx = reader.word(words[4] + 2 + (i * 2));
+							if (!reader.getListData(single_idx, (*multi)[lc]))
+								return nullptr;
+						}
+					} else {
+						single.reset(new RomFields::ListData_t());
+						if (!reader.getListData(words[4], *single))
+							return nullptr;
+					}
+				}
+
+				unique_ptr<RomFields::ListDataIcons_t> icons;
+				if (flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					params.mxd.checkboxes = words[5];
+				} else if ((flags & RomFields::RFT_LISTDATA_ICONS) && words[5] != RDS_NULL) {
+					uint32_t count;
+					if (!reader.getWord(words[5], &count) ||
+					    !reader.checkWords(words[5] + 1, count))
+					{
+						return nullptr;
+					}
+					icons.reset(new RomFields::ListDataIcons_t(count));
+					const int newFieldIdx = fields->count();
+					for (uint32_t i = 0; i < count; i++) {
+						const uint32_t iconIdx = reader.word(words[5] + 1 + i);
+						if (iconIdx != RDS_NULL && pfnResolveIcon) {
+							(*icons)[i] = pfnResolveIcon(newFieldIdx, iconIdx, userdata);
+						}
+					}
+				}
+
+				params.headers = headers.release();
+				if (flags & RomFields::RFT_LISTDATA_MULTI) {
+					params.data.multi = multi.release();
+				} else {
+					params.data.single = single.release();
+				}
+				if (flags & RomFields::RFT_LISTDATA_ICONS) {
+					params.mxd.icons = icons.release();
+				}
+				fields->addField_listData(name.c_str(), &params);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				fields->addField_dateTime(name.c_str(), static_cast<time_t>(value), flags);
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				if (!reader.checkWords(data_idx, RomFields::AGE_MAX / 2))
+					return nullptr;
+				RomFields::age_ratings_t age_ratings;
+				for (unsigned int i = 0; i < RomFields::AGE_MAX / 2; i++) {
+					const uint32_t val = reader.word(data_idx + i);
+					age_ratings[i*2] = static_cast<uint16_t>(val & 0xFFFF);
+					age_ratings[i*2 + 1] = static_cast<uint16_t>(val >> 16);
+				}
+				fields->addField_ageRatings(name.c_str(), age_ratings);
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS: {
+				uint32_t dims[3];
+				if (!reader.checkWords(data_idx, ARRAY_SIZE(dims)))
+					return nullptr;
+				for (unsigned int i = 0; i < ARRAY_SIZE(dims); i++) {
+					dims[i] = reader.word(data_idx + i);
+				}
+				fields->addField_dimensions(name.c_str(),
+					static_cast<int>(dims[0]), static_cast<int>(dims[1]), static_cast<int>(dims[2]));
+				break;
+			}
+
+			case RomFields::RFT_STRING_MULTI: {
+				RomFields::StringMultiMap_t *str_multi = nullptr;
+				if (data_idx != RDS_NULL) {
+					uint32_t count;
+					if (!reader.getWord(data_idx, &count) ||
+					    count > data_count / 2 ||
+					    !reader.checkWords(data_idx + 1, count * 2))
+					{
+						return nullptr;
+					}
+					str_multi = new RomFields::StringMultiMap_t();
+					for (uint32_t i = 0; i < count; i++) {
+						const uint32_t lc = reader.word(data_idx + 1 + (i * 2));
+						const uint32_t ref = reader.word(data_idx + 2 + (i * 2));
+						if (!reader.getString(ref, (*str_multi)[lc])) {
+							delete str_multi;
+							return nullptr;
+						}
+					}
+				}
+				fields->addField_string_multi(name.c_str(), str_multi, def_lc, flags);
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				return nullptr;
+		}
+	}
+
+	return fields.release();
+}
+
+/**
+ * Deserialize a RomMetaData object.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @return RomMetaData object, or nullptr on error. (Caller must delete it.)
+ */
+RomMetaData *deserializeMetaData(const uint8_t *buf, size_t size)
+{
+	assert(buf != nullptr);
+	if (!buf || size < sizeof(RDS_MetaDataHeader))
+		return nullptr;
+
+	// Check the header.
+	RDS_MetaDataHeader header;
+	memcpy(&header, buf, sizeof(header));
+	if (memcmp(header.magic, "RPMD", sizeof(header.magic)) != 0 ||
+	    le16_to_cpu(header.version) != RDS_VERSION ||
+	    le16_to_cpu(header.prop_size) != sizeof(RDS_MetaData))
+	{
+		// Incorrect header.
+		return nullptr;
+	}
+
+	const uint32_t prop_count = le32_to_cpu(header.prop_count);
+	const uint32_t strtbl_offset = le32_to_cpu(header.strtbl_offset);
+	const uint32_t strtbl_size = le32_to_cpu(header.strtbl_size);
+	if (static_cast<uint64_t>(prop_count) * sizeof(RDS_MetaData) > size - sizeof(header) ||
+	    strtbl_offset > size || strtbl_size > size - strtbl_offset)
+	{
+		// Out of range.
+		return nullptr;
+	}
+
+	const RdsReader reader(nullptr, 0, &buf[strtbl_offset], strtbl_size);
+	unique_ptr<RomMetaData> metaData(new RomMetaData());
+	metaData->reserve(static_cast<int>(prop_count));
+
+	const uint8_t *pProp = &buf[sizeof(header)];
+	for (uint32_t i = 0; i < prop_count; i++, pProp += sizeof(RDS_MetaData)) {
+		RDS_MetaData rdsProp;
+		memcpy(&rdsProp, pProp, sizeof(rdsProp));
+		const Property::Property name = static_cast<Property::Property>(rdsProp.name);
+		const int64_t value = le64_to_cpu(rdsProp.value);
+
+		int ret;
+		switch (rdsProp.type) {
+			case PropertyType::Integer:
+				ret = metaData->addMetaData_integer(name, static_cast<int>(value));
+				break;
+			case PropertyType::UnsignedInteger:
+				ret = metaData->addMetaData_uint(name, static_cast<unsigned int>(value));
+				break;
+			case PropertyType::String: {
+				string str;
+				if (!reader.getString(static_cast<uint32_t>(value), str))
+					return nullptr;
+				ret = metaData->addMetaData_string(name, str);
+				break;
+			}
+			case PropertyType::Timestamp:
+				ret = metaData->addMetaData_timestamp(name, static_cast<time_t>(value));
+				break;
+			default:
+				// Unsupported property type.
+				return nullptr;
+		}
+
+		if (ret < 0) {
+			// Property name doesn't match the type.
+			return nullptr;
+		}
+	}
+
+	return metaData.release();
+}
+
+} }
@@ -0,0 +1,182 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RomDataSerializer.hpp: RomFields/RomMetaData binary serialization.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_ROMDATASERIALIZER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_ROMDATASERIALIZER_HPP__
+
+#include "common.h"
+#include "uvector.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+namespace LibRpTexture {
+	class rp_image;
+}
+
+namespace LibRpBase {
+
+class RomFields;
+class RomMetaData;
+
+/**
+ * Binary serialization for RomFields and RomMetaData.
+ *
+ * All integers are little-endian. Strings are stored once in a string
+ * table as a 32-bit length, the string data, and a NULL terminator,
+ * padded to a multiple of 4 bytes. String references are byte offsets
+ * into the string table, so a reader can use strings in place without
+ * copying them. Field records are fixed-size, and variable-length field
+ * data is stored as arrays of 32-bit words referenced by word index.
+ *
+ * ListData icons are not serialized. Instead, each icon is stored as a
+ * reference to its index in the field's icon vector, and the caller can
+ * provide a callback to resolve the references when deserializing.
+ *
+ * Invalid fields (RomFields::Field::isValid == false) are not serialized.
+ */
+namespace RomDataSerializer {
+
+// Binary format version.
+// Increment this if the format changes.
+static const uint16_t RDS_VERSION = 1;
+
+// Reference value for null pointers.
+static const uint32_t RDS_NULL = 0xFFFFFFFFU;
+
+#pragma pack(1)
+
+/**
+ * RomFields binary header.
+ * All fields are in little-endian.
+ */
+typedef struct PACKED _RDS_FieldsHeader {
+	char magic[4];		// [0x000] "RPRF"
+	uint16_t version;	// [0x004] RDS_VERSION
+	uint16_t field_size;	// [0x006] sizeof(RDS_Field)
+	uint32_t field_count;	// [0x008] Number of RDS_Field records. (immediately after the header)
+	uint32_t tab_count;	// [0x00C] Number of tabs.
+	uint32_t tabs_idx;	// [0x010] Word index of tab name string references.
+	uint32_t def_lc;	// [0x014] Default language code.
+	uint32_t data_offset;	// [0x018] Byte offset of the data area. (32-bit words)
+	uint32_t data_count;	// [0x01C] Number of 32-bit words in the data area.
+	uint32_t strtbl_offset;	// [0x020] Byte offset of the string table.
+	uint32_t strtbl_size;	// [0x024] Size of the string table, in bytes.
+} RDS_FieldsHeader;
+ASSERT_STRUCT(RDS_FieldsHeader, 40);
+
+/**
+ * RomFields binary field record.
+ * All fields are in little-endian.
+ *
+ * Field data by type:
+ * - RFT_STRING: value = string reference
+ * - RFT_BITFIELD: value = bitfield; data = [elemsPerRow, names list idx]
+ * - RFT_LISTDATA: data = [rows_visible, headers alignment, data alignment,
+ *                         names list idx, list data idx, checkboxes or icon list idx]
+ *   - Single: list data = [row count, row string list idx...]
+ *   - Multi: list data = [language count, (language code, single list data idx)...]
+ *   - Icons: icon list = [icon count, (icon index or RDS_NULL)...]
+ * - RFT_DATETIME: value = UNIX timestamp
+ * - RFT_AGE_RATINGS: data = 16 uint16_t values, packed two per word (low half first)
+ * - RFT_DIMENSIONS: data = [dimX, dimY, dimZ]
+ * - RFT_STRING_MULTI: data = [language count, (language code, string reference)...]
+ *
+ * String lists are stored as [count, string references...].
+ */
+typedef struct PACKED _RDS_Field {
+	uint8_t type;		// [0x000] RomFields::RomFieldType
+	uint8_t tabIdx;		// [0x001] Tab index
+	uint16_t reserved;	// [0x002]
+	uint32_t flags;		// [0x004] Field flags
+	uint32_t name;		// [0x008] Field name (string reference)
+	uint32_t data_idx;	// [0x00C] Word index in the data area, or RDS_NULL.
+	int64_t value;		// [0x010] Type-specific value.
+} RDS_Field;
+ASSERT_STRUCT(RDS_Field, 24);
+
+/**
+ * RomMetaData binary header.
+ * All fields are in little-endian.
+ */
+typedef struct PACKED _RDS_MetaDataHeader {
+	char magic[4];		// [0x000] "RPMD"
+	uint16_t version;	// [0x004] RDS_VERSION
+	uint16_t prop_size;	// [0x006] sizeof(RDS_MetaData)
+	uint32_t prop_count;	// [0x008] Number of RDS_MetaData records. (immediately after the header)
+	uint32_t strtbl_offset;	// [0x00C] Byte offset of the string table.
+	uint32_t strtbl_size;	// [0x010] Size of the string table, in bytes.
+	uint32_t reserved;	// [0x014]
+} RDS_MetaDataHeader;
+ASSERT_STRUCT(RDS_MetaDataHeader, 24);
+
+/**
+ * RomMetaData binary property record.
+ * All fields are in little-endian.
+ */
+typedef struct PACKED _RDS_MetaData {
+	uint8_t name;		// [0x000] Property::Property
+	uint8_t type;		// [0x001] PropertyType::PropertyType
+	uint16_t reserved1;	// [0x002]
+	uint32_t reserved2;	// [0x004]
+	int64_t value;		// [0x008] Integer value, timestamp, or string reference.
+} RDS_MetaData;
+ASSERT_STRUCT(RDS_MetaData, 16);
+
+#pragma pack()
+
+/**
+ * Serialize a RomFields object.
+ * @param fields	[in] RomFields object.
+ * @param buf		[out] Output buffer. (existing contents will be replaced)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int serializeFields(const RomFields *fields, ao::uvector<uint8_t> &buf);
+
+/**
+ * Resolve a ListData icon reference.
+ * @param fieldIdx Field index in the deserialized RomFields.
+ * @param iconIdx Icon index in the original icon vector.
+ * @param userdata User data.
+ * @return Icon, or nullptr if not available. (Caller retains ownership.)
+ */
+typedef const LibRpTexture::rp_image *(*pfnResolveIcon_t)(int fieldIdx, unsigned int iconIdx, void *userdata);
+
+/**
+ * Deserialize a RomFields object.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @param pfnResolveIcon	[in,opt] Icon reference callback. If nullptr, icons will be nullptr.
+ * @param userdata	[in,opt] User data for pfnResolveIcon.
+ * @return RomFields object, or nullptr on error. (Caller must delete it.)
+ */
+RomFields *deserializeFields(const uint8_t *buf, size_t size,
+	pfnResolveIcon_t pfnResolveIcon = nullptr, void *userdata = nullptr);
+
+/**
+ * Serialize a RomMetaData object.
+ * @param metaData	[in] RomMetaData object.
+ * @param buf		[out] Output buffer. (existing contents will be replaced)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int serializeMetaData(const RomMetaData *metaData, ao::uvector<uint8_t> &buf);
+
+/**
+ * Deserialize a RomMetaData object.
+ * @param buf		[in] Serialized data.
+ * @param size		[in] Size of buf.
+ * @return RomMetaData object, or nullptr on error. (Caller must delete it.)
+ */
+RomMetaData *deserializeMetaData(const uint8_t *buf, size_t size);
+
+}
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_ROMDATASERIALIZER_HPP__ */
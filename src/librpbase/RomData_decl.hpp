@@ -116,6 +116,20 @@ class klass : public LibRpBase::RomData { \
 		 */ \
 		int loadFieldData(void) final;
 
+/**
+ * RomData subclass function declaration for loading field data by tab.
+ * Use this if some tabs are expensive to load.
+ */
+#define ROMDATA_DECL_FIELDTABS() \
+	protected: \
+		/** \
+		 * Load field data for the specified tabs. \
+		 * Called by RomData::fields() if any of the requested tabs haven't been loaded yet. \
+		 * @param tabMask RomFields::TabMask of tabs to load. (Tabs that are already loaded are not included.) \
+		 * @return Number of fields read on success; negative POSIX error code on error. \
+		 */ \
+		int loadFieldTabs(uint32_t tabMask) final;
+
 /**
  * RomData subclass function declaration for loading metadata properties.
  */
@@ -54,8 +54,9 @@ class RomDataPrivate
 		volatile int ref_cnt;		// Reference count.
 		bool isValid;			// Subclass must set this to true if the ROM is valid.
 		IRpFile *file;			// Open file.
-		RomFields *const fields;	// ROM fields. (NOTE: allocated by the base class)
+		RomFields *fields;		// ROM fields. (NOTE: allocated by the base class)
 		RomMetaData *metaData;		// ROM metadata. (NOTE: nullptr initially.)
+		RomFields::TabMask fieldsTabsLoaded;	// Tabs loaded by RomData::fields().
 
 		// Class name for user configuration. (ASCII) (default is nullptr)
 		const char *className;
@@ -14,6 +14,9 @@
 // librpthreads
 #include "librpthreads/Atomics.h"
 
+// C++ includes.
+#include <deque>
+
 // C++ STL classes.
 using std::map;
 using std::string;
@@ -47,6 +50,42 @@ class RomFieldsPrivate
 		// and/or addField_listData with RFT_LISTDATA_MULTI.
 		uint32_t def_lc;
 
+		// String and age rating pools.
+		// RFT_STRING and RFT_AGE_RATINGS data points into these.
+		// std::deque<> allocates elements in blocks and never
+		// moves existing elements when appending, so this saves
+		// one heap allocation per field.
+		// NOTE: Strings that don't fit in std::string's small string
+		// buffer still have their own heap buffer. Pass temporary
+		// strings using std::move() to avoid copying the buffer.
+		// NOTE: RFT_LISTDATA isn't pooled, since ListData_t is
+		// allocated by the caller and owned by the field.
+		std::deque<string> strPool;
+		std::deque<RomFields::age_ratings_t> ageRatingsPool;
+
+		/**
+		 * Allocate a string from the string pool.
+		 * @param str String.
+		 * @return Pooled string.
+		 */
+		template<typename T>
+		inline string *poolString(T &&str)
+		{
+			strPool.emplace_back(std::forward<T>(str));
+			return &strPool.back();
+		}
+
+		/**
+		 * Allocate age ratings from the age ratings pool.
+		 * @param age_ratings Age ratings.
+		 * @return Pooled age ratings.
+		 */
+		inline RomFields::age_ratings_t *poolAgeRatings(const RomFields::age_ratings_t &age_ratings)
+		{
+			ageRatingsPool.push_back(age_ratings);
+			return &ageRatingsPool.back();
+		}
+
 		/**
 		 * Delete allocated objects in this->fields.
 		 * The vector will be cleared afterwards.
@@ -88,7 +127,8 @@ void RomFieldsPrivate::delete_data(void)
 					break;
 
 				case RomFields::RFT_STRING:
-					delete const_cast<string*>(field.data.str);
+				case RomFields::RFT_AGE_RATINGS:
+					// Allocated from a pool.
 					break;
 				case RomFields::RFT_BITFIELD:
 					delete const_cast<vector<string>*>(field.desc.bitfield.names);
@@ -104,9 +144,6 @@ void RomFieldsPrivate::delete_data(void)
 						delete const_cast<RomFields::ListDataIcons_t*>(field.data.list_data.mxd.icons);
 					}
 					break;
-				case RomFields::RFT_AGE_RATINGS:
-					delete const_cast<RomFields::age_ratings_t*>(field.data.age_ratings);
-					break;
 				case RomFields::RFT_STRING_MULTI:
 					delete const_cast<RomFields::StringMultiMap_t*>(field.data.str_multi);
 					break;
@@ -118,8 +155,10 @@ void RomFieldsPrivate::delete_data(void)
 		}
 	);
 
-	// Clear the fields vector.
+	// Clear the fields vector and pools.
 	this->fields.clear();
+	this->strPool.clear();
+	this->ageRatingsPool.clear();
 }
 
 /** RomFields **/
@@ -662,7 +701,7 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 				break;
 
 			case RFT_STRING:
-				field_dest.data.str = (field_src.data.str ? new string(*field_src.data.str) : nullptr);
+				field_dest.data.str = (field_src.data.str ? d->poolString(*field_src.data.str) : nullptr);
 				break;
 			case RFT_BITFIELD:
 				field_dest.desc.bitfield.elemsPerRow = field_src.desc.bitfield.elemsPerRow;
@@ -708,7 +747,7 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 				break;
 			case RFT_AGE_RATINGS:
 				field_dest.data.age_ratings = (field_src.data.age_ratings
-						? new age_ratings_t(*field_src.data.age_ratings)
+						? d->poolAgeRatings(*field_src.data.age_ratings)
 						: nullptr);
 				break;
 			case RFT_DIMENSIONS:
@@ -749,7 +788,7 @@ int RomFields::addField_string(const char *name, const char *str, unsigned int f
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (str ? new string(str) : nullptr);
+	string *const nstr = (str ? d->poolString(str) : nullptr);
 	field.name = name;
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
@@ -783,7 +822,43 @@ int RomFields::addField_string(const char *name, const string &str, unsigned int
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (!str.empty() ? new string(str) : nullptr);
+	string *const nstr = (!str.empty() ? d->poolString(str) : nullptr);
+	field.name = name;
+	field.type = RFT_STRING;
+	field.desc.flags = flags;
+	field.data.str = nstr;
+	field.tabIdx = d->tabIdx;
+	field.isValid = true;
+
+	// Handle string trimming flags.
+	if (nstr && (flags & STRF_TRIM_END)) {
+		trimEnd(*nstr);
+	}
+	return static_cast<int>(idx);
+}
+
+/**
+ * Add string field data.
+ * The string is moved into the RomFields object, so
+ * long strings don't have to be copied.
+ * @param name Field name.
+ * @param str String.
+ * @param flags Formatting flags.
+ * @return Field index.
+ */
+int RomFields::addField_string(const char *name, string &&str, unsigned int flags)
+{
+	assert(name != nullptr);
+	if (!name)
+		return -1;
+
+	// RFT_STRING
+	RP_D(RomFields);
+	size_t idx = d->fields.size();
+	d->fields.resize(idx+1);
+	Field &field = d->fields.at(idx);
+
+	string *const nstr = (!str.empty() ? d->poolString(std::move(str)) : nullptr);
 	field.name = name;
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
@@ -1087,7 +1162,7 @@ int RomFields::addField_ageRatings(const char *name, const age_ratings_t &age_ra
 
 	field.name = name;
 	field.type = RFT_AGE_RATINGS;
-	field.data.age_ratings = new age_ratings_t(age_ratings);
+	field.data.age_ratings = d->poolAgeRatings(age_ratings);
 	field.tabIdx = d->tabIdx;
 	field.isValid = true;
 	return static_cast<int>(idx);
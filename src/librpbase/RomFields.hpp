@@ -172,6 +172,36 @@ class RomFields
 			TXA_RIGHT	= 3,
 		};
 
+		// Tab bitmask for RomData::fields().
+		// Bit N selects tab N. Tabs 32 and higher
+		// are only selected by TAB_MASK_ALL.
+		typedef uint32_t TabMask;
+		enum TabMaskBits : uint32_t {
+			TAB_MASK_NONE	= 0U,
+			TAB_MASK_ALL	= 0xFFFFFFFFU,
+		};
+
+		/**
+		 * Get the TabMask bit for a tab.
+		 * @param tabIdx Tab index.
+		 * @return TabMask bit, or TAB_MASK_NONE if tabIdx is out of range.
+		 */
+		static inline TabMask tabMaskBit(int tabIdx)
+		{
+			return (tabIdx >= 0 && tabIdx < 32 ? (1U << tabIdx) : TAB_MASK_NONE);
+		}
+
+		/**
+		 * Is a tab selected in a TabMask?
+		 * @param tabMask TabMask.
+		 * @param tabIdx Tab index.
+		 * @return True if the tab is selected; false if not.
+		 */
+		static inline bool isTabSelected(TabMask tabMask, int tabIdx)
+		{
+			return (tabMask == TAB_MASK_ALL || (tabMask & tabMaskBit(tabIdx)));
+		}
+
 		// Typedefs for various containers.
 		typedef std::map<uint32_t, std::string> StringMultiMap_t;
 		typedef std::vector<std::vector<std::string> > ListData_t;
@@ -472,6 +502,17 @@ class RomFields
 		 */
 		int addField_string(const char *name, const std::string &str, unsigned int flags = 0);
 
+		/**
+		 * Add string field data.
+		 * The string is moved into the RomFields object, so
+		 * long strings don't have to be copied.
+		 * @param name Field name.
+		 * @param str String.
+		 * @param flags Formatting flags.
+		 * @return Field index.
+		 */
+		int addField_string(const char *name, std::string &&str, unsigned int flags = 0);
+
 		enum Base {
 			FB_DEC,
 			FB_HEX,
@@ -44,9 +44,11 @@
 
 // Flags stored in the %ecx register.
 #define CPUFLAG_IA32_ECX_SSE3		((uint32_t)(1U << 0))
+#define CPUFLAG_IA32_ECX_PCLMULQDQ	((uint32_t)(1U << 1))
 #define CPUFLAG_IA32_ECX_SSSE3		((uint32_t)(1U << 9))
 #define CPUFLAG_IA32_ECX_SSE41		((uint32_t)(1U << 19))
 #define CPUFLAG_IA32_ECX_SSE42		((uint32_t)(1U << 20))
+#define CPUFLAG_IA32_ECX_AES		((uint32_t)(1U << 25))
 #define CPUFLAG_IA32_ECX_XSAVE		((uint32_t)(1U << 26))
 #define CPUFLAG_IA32_ECX_OSXSAVE	((uint32_t)(1U << 27))
 #define CPUFLAG_IA32_ECX_AVX		((uint32_t)(1U << 28))
@@ -56,6 +58,7 @@
 
 // Flags stored in the %ebx register.
 #define CPUFLAG_IA32_FN7_EBX_AVX2	((uint32_t)(1U << 5))
+#define CPUFLAG_IA32_FN7_EBX_SHA	((uint32_t)(1U << 29))
 
 // CPUID function 0x80000001: Extended Processor Info and Feature Bits
 
@@ -139,6 +142,7 @@ static FORCEINLINE int is_cpuid_supported(void)
 
 /**
  * Run the `cpuid` instruction.
+ * %ecx is set to 0, since some functions have subleaves.
  * @param level
  * @param regs Registers. (%eax, %ebx, %ecx, %edx)
  */
@@ -153,19 +157,24 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 		"cpuid\n"
 		"xchgl	%%ebx, %1\n"
 		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # else /* !ASM_RESERVE_EBX */
 	__asm__ (
 		"cpuid\n"
 		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
-		: "0" (level)
+		: "0" (level), "2" (0)
 		);
 # endif
 #elif defined(_MSC_VER)
-# if _MSC_VER >= 1400
-	// CPUID for MSVC 2005+
+# if _MSC_VER >= 1500
+	// CPUID for MSVC 2008+
+	// Uses the __cpuidex() intrinsic.
+	__cpuidex((int*)regs, level, 0);
+# elif _MSC_VER >= 1400
+	// CPUID for MSVC 2005
 	// Uses the __cpuid() intrinsic.
+	// NOTE: %ecx isn't cleared here.
 	__cpuid((int*)regs, level);
 # else /* _MSC_VER < 1400 */
 	// CPUID for old MSVC that doesn't support intrinsics.
@@ -174,6 +183,8 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #   error Cannot use inline assembly on 64-bit MSVC.
 #  endif
 	__asm {
+		mov	eax, level
+		xor	ecx, ecx
 		cpuid
 		mov	regs[0 * TYPE int], eax
 		mov	regs[1 * TYPE int], ebx
@@ -296,6 +307,10 @@ static void RP_CPU_InitCPUFlags_int(void)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_AES)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AES;
+			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 		}
 #else /* !(defined(__i386__) || defined(_M_IX86)) */
 		// AMD64: SSE2 and lower are always supported.
@@ -308,9 +323,21 @@ static void RP_CPU_InitCPUFlags_int(void)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_AES)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AES;
+		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 #endif /* defined(__i386__) || defined(_M_IX86) */
 	}
 
+	if (maxFunc >= CPUID_EXT_FEATURES && (RP_CPU_Flags & RP_CPUFLAG_X86_SSE2)) {
+		// Get the extended features.
+		cpuid(CPUID_EXT_FEATURES, regs);
+
+		if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_SHA)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_SHA;
+	}
+
 	// CPU flags initialized.
 	RP_CPU_Flags_Init = 1;
 }
@@ -29,6 +29,9 @@ extern "C" {
 #define RP_CPUFLAG_X86_SSSE3		((uint32_t)(1U << 4))
 #define RP_CPUFLAG_X86_SSE41		((uint32_t)(1U << 5))
 #define RP_CPUFLAG_X86_SSE42		((uint32_t)(1U << 6))
+#define RP_CPUFLAG_X86_AES		((uint32_t)(1U << 7))
+#define RP_CPUFLAG_X86_PCLMULQDQ	((uint32_t)(1U << 8))
+#define RP_CPUFLAG_X86_SHA		((uint32_t)(1U << 9))
 
 #endif /* defined(__i386__) || defined(__amd64__) || defined(__x86_64__) */
 
@@ -99,6 +102,42 @@ static FORCEINLINE int RP_CPU_HasSSE41(void)
 	return (RP_CPU_Flags & RP_CPUFLAG_X86_SSE41);
 }
 
+/**
+ * Check if the CPU supports AES-NI.
+ * @return Non-zero if AES-NI is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasAES(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_AES);
+}
+
+/**
+ * Check if the CPU supports PCLMULQDQ.
+ * @return Non-zero if PCLMULQDQ is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasPCLMULQDQ(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_PCLMULQDQ);
+}
+
+/**
+ * Check if the CPU supports the SHA extensions.
+ * @return Non-zero if the SHA extensions are supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasSHA(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_X86_SHA);
+}
+
 #ifdef __cplusplus
 }
 #endif
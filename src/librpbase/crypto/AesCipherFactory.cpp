@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librpbase)                        *
  * AesCipherFactory.cpp: IAesCipher factory class.                         *
  *                                                                         *
- * Copyright (c) 2016-2019 by David Korth.                                 *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -12,6 +12,9 @@
 #include "AesCipherFactory.hpp"
 
 // IAesCipher implementations.
+#ifdef HAVE_AESNI
+# include "AesNI.hpp"
+#endif /* HAVE_AESNI */
 #if defined(_WIN32)
 # include "AesCAPI.hpp"
 # include "AesCAPI_NG.hpp"
@@ -32,6 +35,13 @@ namespace LibRpBase {
  */
 IAesCipher *AesCipherFactory::create(void)
 {
+#ifdef HAVE_AESNI
+	// Use AES-NI if the CPU supports it.
+	if (AesNI::isUsable()) {
+		return new AesNI();
+	}
+#endif /* HAVE_AESNI */
+
 #if defined(_WIN32)
 	// Windows: Use CryptoAPI NG if available.
 	// If not, fall back to CryptoAPI.
@@ -0,0 +1,517 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.cpp: AES decryption class using AES-NI.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+
+#include "AesNI.hpp"
+#include "../cpuflags_x86.h"
+
+// AES-NI intrinsics.
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+namespace LibRpBase {
+
+class AesNIPrivate
+{
+	public:
+		AesNIPrivate();
+		~AesNIPrivate() { }
+
+	private:
+		RP_DISABLE_COPY(AesNIPrivate)
+
+	public:
+		static const unsigned int AES_BLOCK_SIZE = 16;
+		static const unsigned int MAX_ROUNDS = 14;
+
+		// Number of blocks to process at once.
+		// AESDEC/AESENC have a latency of 4-7 cycles and a
+		// throughput of 1 cycle on most CPUs, so 8 independent
+		// blocks keep the pipeline full.
+		static const unsigned int BLOCKS_IN_FLIGHT = 8;
+
+		// Round keys.
+		// enc_keys: Encryption round keys. (CTR)
+		// dec_keys: Decryption round keys, in AESDEC order. (ECB, CBC)
+		uint8_t enc_keys[MAX_ROUNDS + 1][AES_BLOCK_SIZE];
+		uint8_t dec_keys[MAX_ROUNDS + 1][AES_BLOCK_SIZE];
+		unsigned int rounds;	// 0 if no key is set.
+
+		// CBC: Initialization vector.
+		// CTR: Counter.
+		uint8_t iv[AES_BLOCK_SIZE];
+
+		IAesCipher::ChainingMode chainingMode;
+
+	public:
+		/**
+		 * Expand an AES key into encryption and decryption round keys.
+		 * @param pKey	[in] Key data.
+		 * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+		 */
+		void expandKey(const uint8_t *RESTRICT pKey, size_t size);
+
+		/**
+		 * Decrypt data using ECB.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void decrypt_ECB(uint8_t *RESTRICT pData, size_t blocks) const;
+
+		/**
+		 * Decrypt data using CBC.
+		 * The IV is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void decrypt_CBC(uint8_t *RESTRICT pData, size_t blocks);
+
+		/**
+		 * Decrypt data using CTR.
+		 * The counter is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void crypt_CTR(uint8_t *RESTRICT pData, size_t blocks);
+};
+
+/** AesNIPrivate **/
+
+AesNIPrivate::AesNIPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::CM_ECB)
+{
+	// Clear the keys.
+	memset(enc_keys, 0, sizeof(enc_keys));
+	memset(dec_keys, 0, sizeof(dec_keys));
+	memset(iv, 0, sizeof(iv));
+}
+
+/**
+ * SubWord() from the AES key schedule.
+ * @param w Word, in memory byte order.
+ * @return SubWord(w), in memory byte order.
+ */
+static inline uint32_t aes_SubWord(uint32_t w)
+{
+	// AESKEYGENASSIST applies the S-box to dwords 1 and 3.
+	// Dword 0 of the result is SubWord(dword 1).
+	const __m128i x = _mm_set_epi32(0, 0, static_cast<int>(w), 0);
+	return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_aeskeygenassist_si128(x, 0)));
+}
+
+/**
+ * Expand an AES key into encryption and decryption round keys.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+ */
+void AesNIPrivate::expandKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// FIPS-197 key expansion.
+	// Words are stored in memory byte order, so RotWord()
+	// is a right rotation on little-endian x86.
+	const unsigned int nk = static_cast<unsigned int>(size / 4);
+	rounds = nk + 6;
+	const unsigned int total = (rounds + 1) * 4;
+
+	uint32_t w[(MAX_ROUNDS + 1) * 4];
+	memcpy(w, pKey, size);
+	uint8_t rcon = 0x01;
+	for (unsigned int i = nk; i < total; i++) {
+		uint32_t temp = w[i - 1];
+		if (i % nk == 0) {
+			temp = aes_SubWord((temp >> 8) | (temp << 24)) ^ rcon;
+			rcon = static_cast<uint8_t>((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0));
+		} else if (nk > 6 && i % nk == 4) {
+			temp = aes_SubWord(temp);
+		}
+		w[i] = w[i - nk] ^ temp;
+	}
+	memcpy(enc_keys, w, total * sizeof(uint32_t));
+
+	// Decryption keys for the equivalent inverse cipher:
+	// reversed order, with InvMixColumns applied to the
+	// middle round keys.
+	memcpy(dec_keys[0], enc_keys[rounds], AES_BLOCK_SIZE);
+	for (unsigned int i = 1; i < rounds; i++) {
+		const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(enc_keys[rounds - i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dec_keys[i]), _mm_aesimc_si128(k));
+	}
+	memcpy(dec_keys[rounds], enc_keys[0], AES_BLOCK_SIZE);
+}
+
+/**
+ * Load a round key.
+ * @param keys	[in] Round keys.
+ * @param r	[in] Round number.
+ * @return Round key.
+ */
+static inline __m128i loadRoundKey(const uint8_t keys[][16], unsigned int r)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[r]));
+}
+
+// Apply an AES round to 8 blocks in registers.
+// NOTE: Individual variables are used instead of an array
+// so the compiler keeps all 8 blocks in registers.
+#define AES_ROUND_X8(op, k) do { \
+	x0 = op(x0, k); x1 = op(x1, k); x2 = op(x2, k); x3 = op(x3, k); \
+	x4 = op(x4, k); x5 = op(x5, k); x6 = op(x6, k); x7 = op(x7, k); \
+} while (0)
+
+// Run the full AES decryption on 8 blocks in registers.
+#define AES_DECRYPT_X8(keys, rounds) do { \
+	AES_ROUND_X8(_mm_xor_si128, loadRoundKey(keys, 0)); \
+	for (unsigned int r = 1; r < (rounds); r++) { \
+		const __m128i k = loadRoundKey(keys, r); \
+		AES_ROUND_X8(_mm_aesdec_si128, k); \
+	} \
+	AES_ROUND_X8(_mm_aesdeclast_si128, loadRoundKey(keys, (rounds))); \
+} while (0)
+
+/**
+ * Decrypt a single block with AESDEC.
+ * @param x	[in] Block.
+ * @param keys	[in] Decryption round keys.
+ * @param rounds	[in] Number of rounds.
+ * @return Decrypted block.
+ */
+static inline __m128i aesdec_single(__m128i x, const uint8_t keys[][16], unsigned int rounds)
+{
+	x = _mm_xor_si128(x, loadRoundKey(keys, 0));
+	for (unsigned int r = 1; r < rounds; r++) {
+		x = _mm_aesdec_si128(x, loadRoundKey(keys, r));
+	}
+	return _mm_aesdeclast_si128(x, loadRoundKey(keys, rounds));
+}
+
+/**
+ * Encrypt a single block with AESENC.
+ * @param x	[in] Block.
+ * @param keys	[in] Encryption round keys.
+ * @param rounds	[in] Number of rounds.
+ * @return Encrypted block.
+ */
+static inline __m128i aesenc_single(__m128i x, const uint8_t keys[][16], unsigned int rounds)
+{
+	x = _mm_xor_si128(x, loadRoundKey(keys, 0));
+	for (unsigned int r = 1; r < rounds; r++) {
+		x = _mm_aesenc_si128(x, loadRoundKey(keys, r));
+	}
+	return _mm_aesenclast_si128(x, loadRoundKey(keys, rounds));
+}
+
+/**
+ * Decrypt data using ECB.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::decrypt_ECB(uint8_t *RESTRICT pData, size_t blocks) const
+{
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= BLOCKS_IN_FLIGHT; blocks -= BLOCKS_IN_FLIGHT, p += BLOCKS_IN_FLIGHT) {
+		__m128i x0 = _mm_loadu_si128(&p[0]);
+		__m128i x1 = _mm_loadu_si128(&p[1]);
+		__m128i x2 = _mm_loadu_si128(&p[2]);
+		__m128i x3 = _mm_loadu_si128(&p[3]);
+		__m128i x4 = _mm_loadu_si128(&p[4]);
+		__m128i x5 = _mm_loadu_si128(&p[5]);
+		__m128i x6 = _mm_loadu_si128(&p[6]);
+		__m128i x7 = _mm_loadu_si128(&p[7]);
+		AES_DECRYPT_X8(dec_keys, rounds);
+		_mm_storeu_si128(&p[0], x0);
+		_mm_storeu_si128(&p[1], x1);
+		_mm_storeu_si128(&p[2], x2);
+		_mm_storeu_si128(&p[3], x3);
+		_mm_storeu_si128(&p[4], x4);
+		_mm_storeu_si128(&p[5], x5);
+		_mm_storeu_si128(&p[6], x6);
+		_mm_storeu_si128(&p[7], x7);
+	}
+	for (; blocks > 0; blocks--, p++) {
+		_mm_storeu_si128(p, aesdec_single(_mm_loadu_si128(p), dec_keys, rounds));
+	}
+}
+
+/**
+ * Decrypt data using CBC.
+ * The IV is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::decrypt_CBC(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+	// CBC decryption doesn't depend on the previous plaintext,
+	// so multiple blocks can be decrypted in parallel.
+	// The ciphertext is reloaded from memory for the XOR step
+	// before it's overwritten.
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= BLOCKS_IN_FLIGHT; blocks -= BLOCKS_IN_FLIGHT, p += BLOCKS_IN_FLIGHT) {
+		__m128i x0 = _mm_loadu_si128(&p[0]);
+		__m128i x1 = _mm_loadu_si128(&p[1]);
+		__m128i x2 = _mm_loadu_si128(&p[2]);
+		__m128i x3 = _mm_loadu_si128(&p[3]);
+		__m128i x4 = _mm_loadu_si128(&p[4]);
+		__m128i x5 = _mm_loadu_si128(&p[5]);
+		__m128i x6 = _mm_loadu_si128(&p[6]);
+		__m128i x7 = _mm_loadu_si128(&p[7]);
+		AES_DECRYPT_X8(dec_keys, rounds);
+		const __m128i next = _mm_loadu_si128(&p[7]);
+		x7 = _mm_xor_si128(x7, _mm_loadu_si128(&p[6]));
+		x6 = _mm_xor_si128(x6, _mm_loadu_si128(&p[5]));
+		x5 = _mm_xor_si128(x5, _mm_loadu_si128(&p[4]));
+		x4 = _mm_xor_si128(x4, _mm_loadu_si128(&p[3]));
+		x3 = _mm_xor_si128(x3, _mm_loadu_si128(&p[2]));
+		x2 = _mm_xor_si128(x2, _mm_loadu_si128(&p[1]));
+		x1 = _mm_xor_si128(x1, _mm_loadu_si128(&p[0]));
+		x0 = _mm_xor_si128(x0, prev);
+		_mm_storeu_si128(&p[0], x0);
+		_mm_storeu_si128(&p[1], x1);
+		_mm_storeu_si128(&p[2], x2);
+		_mm_storeu_si128(&p[3], x3);
+		_mm_storeu_si128(&p[4], x4);
+		_mm_storeu_si128(&p[5], x5);
+		_mm_storeu_si128(&p[6], x6);
+		_mm_storeu_si128(&p[7], x7);
+		prev = next;
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i c = _mm_loadu_si128(p);
+		_mm_storeu_si128(p, _mm_xor_si128(aesdec_single(c, dec_keys, rounds), prev));
+		prev = c;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+/**
+ * Decrypt data using CTR.
+ * The counter is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::crypt_CTR(uint8_t *RESTRICT pData, size_t blocks)
+{
+	// The counter is a 128-bit big-endian value.
+	uint64_t ctr_hi, ctr_lo;
+	memcpy(&ctr_hi, &iv[0], sizeof(ctr_hi));
+	memcpy(&ctr_lo, &iv[8], sizeof(ctr_lo));
+	ctr_hi = be64_to_cpu(ctr_hi);
+	ctr_lo = be64_to_cpu(ctr_lo);
+
+	// Counter block for the current counter value.
+#define CTR_BLOCK(lo) _mm_set_epi64x( \
+		static_cast<int64_t>(cpu_to_be64(lo)), \
+		static_cast<int64_t>(cpu_to_be64(ctr_hi)))
+
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= BLOCKS_IN_FLIGHT; blocks -= BLOCKS_IN_FLIGHT, p += BLOCKS_IN_FLIGHT) {
+		__m128i x0, x1, x2, x3, x4, x5, x6, x7;
+		if (likely(ctr_lo <= ~0ULL - BLOCKS_IN_FLIGHT)) {
+			// The low 64 bits won't wrap around.
+			x0 = CTR_BLOCK(ctr_lo);
+			x1 = CTR_BLOCK(ctr_lo + 1);
+			x2 = CTR_BLOCK(ctr_lo + 2);
+			x3 = CTR_BLOCK(ctr_lo + 3);
+			x4 = CTR_BLOCK(ctr_lo + 4);
+			x5 = CTR_BLOCK(ctr_lo + 5);
+			x6 = CTR_BLOCK(ctr_lo + 6);
+			x7 = CTR_BLOCK(ctr_lo + 7);
+			ctr_lo += BLOCKS_IN_FLIGHT;
+		} else {
+			// The low 64 bits will wrap around.
+			__m128i x[BLOCKS_IN_FLIGHT];
+			for (unsigned int j = 0; j < BLOCKS_IN_FLIGHT; j++) {
+				x[j] = CTR_BLOCK(ctr_lo);
+				if (++ctr_lo == 0) {
+					ctr_hi++;
+				}
+			}
+			x0 = x[0]; x1 = x[1]; x2 = x[2]; x3 = x[3];
+			x4 = x[4]; x5 = x[5]; x6 = x[6]; x7 = x[7];
+		}
+
+		AES_ROUND_X8(_mm_xor_si128, loadRoundKey(enc_keys, 0));
+		for (unsigned int r = 1; r < rounds; r++) {
+			const __m128i k = loadRoundKey(enc_keys, r);
+			AES_ROUND_X8(_mm_aesenc_si128, k);
+		}
+		AES_ROUND_X8(_mm_aesenclast_si128, loadRoundKey(enc_keys, rounds));
+
+		_mm_storeu_si128(&p[0], _mm_xor_si128(_mm_loadu_si128(&p[0]), x0));
+		_mm_storeu_si128(&p[1], _mm_xor_si128(_mm_loadu_si128(&p[1]), x1));
+		_mm_storeu_si128(&p[2], _mm_xor_si128(_mm_loadu_si128(&p[2]), x2));
+		_mm_storeu_si128(&p[3], _mm_xor_si128(_mm_loadu_si128(&p[3]), x3));
+		_mm_storeu_si128(&p[4], _mm_xor_si128(_mm_loadu_si128(&p[4]), x4));
+		_mm_storeu_si128(&p[5], _mm_xor_si128(_mm_loadu_si128(&p[5]), x5));
+		_mm_storeu_si128(&p[6], _mm_xor_si128(_mm_loadu_si128(&p[6]), x6));
+		_mm_storeu_si128(&p[7], _mm_xor_si128(_mm_loadu_si128(&p[7]), x7));
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i x = aesenc_single(CTR_BLOCK(ctr_lo), enc_keys, rounds);
+		_mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), x));
+		if (++ctr_lo == 0) {
+			ctr_hi++;
+		}
+	}
+#undef CTR_BLOCK
+
+	ctr_hi = cpu_to_be64(ctr_hi);
+	ctr_lo = cpu_to_be64(ctr_lo);
+	memcpy(&iv[0], &ctr_hi, sizeof(ctr_hi));
+	memcpy(&iv[8], &ctr_lo, sizeof(ctr_lo));
+}
+
+/** AesNI **/
+
+AesNI::AesNI()
+	: d_ptr(new AesNIPrivate())
+{ }
+
+AesNI::~AesNI()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is AES-NI usable on this system?
+ * @return True if the CPU supports AES-NI.
+ */
+bool AesNI::isUsable(void)
+{
+	return !!RP_CPU_HasAES();
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name.
+ */
+const char *AesNI::name(void) const
+{
+	return "AES-NI";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesNI::isInit(void) const
+{
+	// AES-NI only works if the CPU supports it.
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!pKey || !(size == 16 || size == 24 || size == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		return -ENOTSUP;
+	}
+
+	RP_D(AesNI);
+	d->expandKey(pKey, size);
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setChainingMode(ChainingMode mode)
+{
+	if (mode < CM_ECB || mode > CM_CTR) {
+		return -EINVAL;
+	}
+
+	RP_D(AesNI);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param pIV	[in] IV/counter data.
+ * @param size	[in] Size of pIV, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setIV(const uint8_t *RESTRICT pIV, size_t size)
+{
+	RP_D(AesNI);
+	if (!pIV || size != AesNIPrivate::AES_BLOCK_SIZE ||
+	    d->chainingMode < CM_CBC || d->chainingMode > CM_CTR)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv, pIV, AesNIPrivate::AES_BLOCK_SIZE);
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * @param pData	[in/out] Data block.
+ * @param size	[in] Length of data block. (Must be a multiple of 16.)
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+size_t AesNI::decrypt(uint8_t *RESTRICT pData, size_t size)
+{
+	if (!pData || size == 0 || (size % AesNIPrivate::AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesNI);
+	if (d->rounds == 0) {
+		// No key set...
+		return 0;
+	}
+
+	const size_t blocks = size / AesNIPrivate::AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case CM_ECB:
+			d->decrypt_ECB(pData, blocks);
+			break;
+		case CM_CBC:
+			// IV is automatically updated for the next block.
+			d->decrypt_CBC(pData, blocks);
+			break;
+		case CM_CTR:
+			// ctr is automatically updated for the next block.
+			// NOTE: ctr uses the *encrypt* function, even for decryption.
+			d->crypt_CTR(pData, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return size;
+}
+
+}
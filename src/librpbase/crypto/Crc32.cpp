@@ -0,0 +1,74 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Crc32.cpp: CRC-32 checksum.                                             *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+#include "Crc32.hpp"
+
+#ifdef HAVE_PCLMUL
+# include "../cpuflags_x86.h"
+#endif /* HAVE_PCLMUL */
+
+// zlib
+#include <zlib.h>
+
+namespace LibRpBase {
+
+#ifdef HAVE_PCLMUL
+// Minimum size for the PCLMULQDQ version.
+// Smaller buffers aren't worth the setup cost.
+static const size_t PCLMUL_MIN_SIZE = 64;
+#endif /* HAVE_PCLMUL */
+
+Crc32::Crc32()
+	: m_crc(0)
+{ }
+
+/**
+ * Add data to the checksum.
+ * @param data Data.
+ * @param size Size of data, in bytes.
+ */
+void Crc32::update(const void *data, size_t size)
+{
+	m_crc = calc(data, size, m_crc);
+}
+
+/**
+ * Calculate the CRC-32 of a buffer.
+ * @param data	[in] Data.
+ * @param size	[in] Size of data, in bytes.
+ * @param crc	[in] Initial CRC-32, for continuing a previous checksum.
+ * @return CRC-32.
+ */
+uint32_t Crc32::calc(const void *data, size_t size, uint32_t crc)
+{
+	const uint8_t *data8 = static_cast<const uint8_t*>(data);
+
+#ifdef HAVE_PCLMUL
+	if (size >= PCLMUL_MIN_SIZE && RP_CPU_HasPCLMULQDQ() && RP_CPU_HasSSE41()) {
+		// Process multiples of 16 bytes using PCLMULQDQ.
+		// The remainder is handled by zlib.
+		const size_t sz = size & ~static_cast<size_t>(15);
+		crc = ~update_PCLMUL(~crc, data8, sz);
+		data8 += sz;
+		size -= sz;
+	}
+#endif /* HAVE_PCLMUL */
+
+	// zlib's crc32() takes a uInt length.
+	while (size > 0) {
+		const uInt sz = (size > 0x40000000U ? 0x40000000U : static_cast<uInt>(size));
+		crc = static_cast<uint32_t>(crc32(crc, data8, sz));
+		data8 += sz;
+		size -= sz;
+	}
+	return crc;
+}
+
+}
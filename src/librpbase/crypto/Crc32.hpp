@@ -0,0 +1,86 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Crc32.hpp: CRC-32 checksum.                                             *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase {
+
+/**
+ * CRC-32 checksum. (ISO-HDLC; same as zlib's crc32())
+ *
+ * zlib is used for small buffers. On x86, large buffers are
+ * processed using PCLMULQDQ if the CPU supports it.
+ */
+class Crc32
+{
+	public:
+		Crc32();
+
+	private:
+		RP_DISABLE_COPY(Crc32)
+
+	public:
+		/**
+		 * Reset the checksum.
+		 */
+		void reset(void)
+		{
+			m_crc = 0;
+		}
+
+		/**
+		 * Add data to the checksum.
+		 * @param data Data.
+		 * @param size Size of data, in bytes.
+		 */
+		void update(const void *data, size_t size);
+
+		/**
+		 * Get the current checksum.
+		 * More data can be added afterwards.
+		 * @return CRC-32.
+		 */
+		uint32_t value(void) const
+		{
+			return m_crc;
+		}
+
+		/**
+		 * Calculate the CRC-32 of a buffer.
+		 * @param data	[in] Data.
+		 * @param size	[in] Size of data, in bytes.
+		 * @param crc	[in] Initial CRC-32, for continuing a previous checksum.
+		 * @return CRC-32.
+		 */
+		static uint32_t calc(const void *data, size_t size, uint32_t crc = 0);
+
+	private:
+		/**
+		 * Update a CRC-32 using PCLMULQDQ.
+		 * Selected at runtime if the CPU supports it.
+		 * @param crc Current CRC-32. (internal form, i.e. inverted)
+		 * @param data Data.
+		 * @param size Size of data, in bytes. (must be >= 64 and a multiple of 16)
+		 * @return Updated CRC-32. (internal form)
+		 */
+		static uint32_t update_PCLMUL(uint32_t crc, const uint8_t *data, size_t size);
+
+	private:
+		uint32_t m_crc;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_CRC32_HPP__ */
@@ -0,0 +1,111 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Crc32_PCLMUL.cpp: CRC-32 checksum. (PCLMULQDQ optimized version)        *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Crc32.hpp"
+
+// PCLMULQDQ intrinsics.
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Update a CRC-32 using PCLMULQDQ.
+ * Selected at runtime if the CPU supports it.
+ *
+ * This folds four 128-bit lanes at a time, then folds the
+ * result down to 32 bits using a Barrett reduction, as
+ * described in Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction".
+ *
+ * @param crc Current CRC-32. (internal form, i.e. inverted)
+ * @param data Data.
+ * @param size Size of data, in bytes. (must be >= 64 and a multiple of 16)
+ * @return Updated CRC-32. (internal form)
+ */
+uint32_t Crc32::update_PCLMUL(uint32_t crc, const uint8_t *data, size_t size)
+{
+	assert(size >= 64);
+	assert(size % 16 == 0);
+
+	// Folding constants for the bit-reflected polynomial 0x104C11DB7.
+	const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596ULL, 0x0154442BD4ULL);	// fold by 512 bits
+	const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009EULL, 0x01751997D0ULL);	// fold by 128 bits
+	const __m128i k5k0 = _mm_set_epi64x(0, 0x0163CD6124ULL);		// fold 96 bits to 64 bits
+	const __m128i poly = _mm_set_epi64x(0x01F7011641ULL, 0x01DB710641ULL);	// Barrett: mu, P(x)
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	const __m128i *data128 = reinterpret_cast<const __m128i*>(data);
+	__m128i x1 = _mm_loadu_si128(&data128[0]);
+	__m128i x2 = _mm_loadu_si128(&data128[1]);
+	__m128i x3 = _mm_loadu_si128(&data128[2]);
+	__m128i x4 = _mm_loadu_si128(&data128[3]);
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+	data128 += 4;
+	size -= 64;
+
+	// Fold four lanes at a time.
+	for (; size >= 64; size -= 64, data128 += 4) {
+		const __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		const __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		const __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		const __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(&data128[0]));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(&data128[1]));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(&data128[2]));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(&data128[3]));
+	}
+
+	// Fold the four lanes into one.
+	__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold the remaining 128-bit blocks.
+	for (; size >= 16; size -= 16, data128++) {
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(data128)), x5);
+	}
+
+	// Fold 128 bits to 64 bits.
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits.
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+}
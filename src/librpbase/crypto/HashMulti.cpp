@@ -0,0 +1,117 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashMulti.cpp: Hash multiple independent buffers at once.               *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "HashMulti.hpp"
+
+#include "Md5.hpp"
+#include "Sha1.hpp"
+#include "Sha256.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+
+// C++ STL classes.
+using std::unique_ptr;
+
+namespace LibRpBase {
+
+template<class Hash>
+struct HashMulti<Hash>::Queue {
+	const Buffer *bufs;
+	unsigned int count;
+	unsigned int next;	// Next buffer to hash. (protected by mutex)
+	Mutex mutex;
+};
+
+/**
+ * Worker thread function.
+ * Hashes buffers until the queue is empty.
+ * @param arg Queue.
+ */
+template<class Hash>
+void HashMulti<Hash>::worker(void *arg)
+{
+	Queue *const queue = static_cast<Queue*>(arg);
+	for (;;) {
+		unsigned int i;
+		{
+			MutexLocker lock(queue->mutex);
+			if (queue->next >= queue->count)
+				break;
+			i = queue->next++;
+		}
+
+		const Buffer &buf = queue->bufs[i];
+		Hash::hash(buf.data, buf.size, buf.digest);
+	}
+}
+
+/**
+ * Hash multiple buffers.
+ * @param bufs	[in/out] Buffers.
+ * @param count	[in] Number of buffers.
+ */
+template<class Hash>
+void HashMulti<Hash>::hash(const Buffer *bufs, unsigned int count)
+{
+	size_t totalSize = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		totalSize += bufs[i].size;
+	}
+
+	unsigned int threads = 1;
+	if (count > 1 && totalSize >= PARALLEL_MIN_SIZE) {
+		threads = Thread::cpuCount();
+		if (threads > count) {
+			threads = count;
+		}
+		if (threads > PARALLEL_MAX_THREADS) {
+			threads = PARALLEL_MAX_THREADS;
+		}
+	}
+
+	if (threads <= 1) {
+		// Hash everything on the calling thread.
+		for (unsigned int i = 0; i < count; i++) {
+			Hash::hash(bufs[i].data, bufs[i].size, bufs[i].digest);
+		}
+		return;
+	}
+
+	Queue queue;
+	queue.bufs = bufs;
+	queue.count = count;
+	queue.next = 0;
+
+	// Start the additional worker threads.
+	// If a thread can't be started, the remaining
+	// workers will pick up its share of the queue.
+	unique_ptr<Thread[]> workerThreads(new Thread[threads - 1]);
+	unique_ptr<bool[]> started(new bool[threads - 1]);
+	for (unsigned int i = 0; i < threads - 1; i++) {
+		started[i] = (workerThreads[i].start(worker, &queue) == 0);
+	}
+
+	// The calling thread is also a worker thread.
+	worker(&queue);
+
+	for (unsigned int i = 0; i < threads - 1; i++) {
+		if (started[i]) {
+			workerThreads[i].join();
+		}
+	}
+}
+
+// Supported hash functions.
+template class HashMulti<Md5>;
+template class HashMulti<Sha1>;
+template class HashMulti<Sha256>;
+
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashMulti.hpp: Hash multiple independent buffers at once.               *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASHMULTI_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASHMULTI_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase {
+
+/**
+ * Hash multiple independent buffers at once,
+ * e.g. all sections of a 3DS ExeFS.
+ *
+ * The buffers are distributed across worker threads.
+ * Each buffer is hashed using Hash::hash().
+ * Instantiated for Sha1, Sha256, and Md5.
+ */
+template<class Hash>
+class HashMulti
+{
+	private:
+		HashMulti();
+		~HashMulti();
+		RP_DISABLE_COPY(HashMulti)
+
+	public:
+		struct Buffer {
+			const void *data;	// [in] Data.
+			size_t size;		// [in] Size of data, in bytes.
+			uint8_t *digest;	// [out] Digest. (Hash::DIGEST_SIZE bytes)
+		};
+
+		// Minimum total size to use multiple threads.
+		static const size_t PARALLEL_MIN_SIZE = 256*1024;
+		static const unsigned int PARALLEL_MAX_THREADS = 16;
+
+		/**
+		 * Hash multiple buffers.
+		 * @param bufs	[in/out] Buffers.
+		 * @param count	[in] Number of buffers.
+		 */
+		static void hash(const Buffer *bufs, unsigned int count);
+
+	private:
+		struct Queue;
+
+		/**
+		 * Worker thread function.
+		 * Hashes buffers until the queue is empty.
+		 * @param arg Queue.
+		 */
+		static void worker(void *arg);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASHMULTI_HPP__ */
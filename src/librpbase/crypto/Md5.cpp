@@ -0,0 +1,194 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Md5.cpp: MD5 hash function.                                             *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Md5.hpp"
+
+namespace LibRpBase {
+
+static inline uint32_t rol32(uint32_t x, unsigned int n)
+{
+	return (x << n) | (x >> (32 - n));
+}
+
+// Sine-derived constants.
+static const uint32_t md5_k[64] = {
+	0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE,
+	0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
+	0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE,
+	0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
+	0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA,
+	0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
+	0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED,
+	0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
+	0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C,
+	0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
+	0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05,
+	0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
+	0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039,
+	0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
+	0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1,
+	0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391,
+};
+
+Md5::Md5()
+{
+	reset();
+}
+
+/**
+ * Reset the hash state.
+ */
+void Md5::reset(void)
+{
+	m_state[0] = 0x67452301;
+	m_state[1] = 0xEFCDAB89;
+	m_state[2] = 0x98BADCFE;
+	m_state[3] = 0x10325476;
+	m_length = 0;
+	m_bufLen = 0;
+}
+
+/**
+ * Process 64-byte blocks.
+ * @param data Data.
+ * @param count Number of blocks.
+ */
+void Md5::processBlocks(const uint8_t *data, size_t count)
+{
+	// Per-round shift amounts.
+	static const uint8_t s[64] = {
+		7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
+		5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
+		4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
+		6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,
+	};
+
+	uint32_t m[16];
+	for (; count > 0; count--, data += BLOCK_SIZE) {
+		for (unsigned int i = 0; i < 16; i++) {
+			uint32_t x;
+			memcpy(&x, &data[i * 4], sizeof(x));
+			m[i] = le32_to_cpu(x);
+		}
+
+		uint32_t a = m_state[0];
+		uint32_t b = m_state[1];
+		uint32_t c = m_state[2];
+		uint32_t d = m_state[3];
+
+#define MD5_ROUND(f, g, i) do { \
+	const uint32_t t = b + rol32(a + (f) + md5_k[i] + m[g], s[i]); \
+	a = d; d = c; c = b; b = t; \
+} while (0)
+
+		unsigned int i = 0;
+		for (; i < 16; i++)
+			MD5_ROUND((b & c) | (~b & d), i, i);
+		for (; i < 32; i++)
+			MD5_ROUND((d & b) | (~d & c), (5*i + 1) & 15, i);
+		for (; i < 48; i++)
+			MD5_ROUND(b ^ c ^ d, (3*i + 5) & 15, i);
+		for (; i < 64; i++)
+			MD5_ROUND(c ^ (b | ~d), (7*i) & 15, i);
+
+#undef MD5_ROUND
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+	}
+}
+
+/**
+ * Add data to the hash.
+ * @param data Data.
+ * @param size Size of data, in bytes.
+ */
+void Md5::update(const void *data, size_t size)
+{
+	const uint8_t *data8 = static_cast<const uint8_t*>(data);
+	m_length += size;
+
+	if (m_bufLen > 0) {
+		// Fill the partial block first.
+		size_t sz = BLOCK_SIZE - m_bufLen;
+		if (sz > size) {
+			sz = size;
+		}
+		memcpy(&m_buf[m_bufLen], data8, sz);
+		m_bufLen += static_cast<unsigned int>(sz);
+		data8 += sz;
+		size -= sz;
+		if (m_bufLen < BLOCK_SIZE) {
+			return;
+		}
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+
+	// Process full blocks directly from the input buffer.
+	const size_t blocks = size / BLOCK_SIZE;
+	if (blocks > 0) {
+		processBlocks(data8, blocks);
+		data8 += blocks * BLOCK_SIZE;
+		size -= blocks * BLOCK_SIZE;
+	}
+
+	// Save the remaining data.
+	if (size > 0) {
+		memcpy(m_buf, data8, size);
+		m_bufLen = static_cast<unsigned int>(size);
+	}
+}
+
+/**
+ * Finish the hash and get the digest.
+ * The hash state is reset afterwards.
+ * @param digest [out] Digest. (DIGEST_SIZE bytes)
+ */
+void Md5::finish(uint8_t *digest)
+{
+	const uint64_t bitLength = m_length * 8;
+
+	// Padding: 0x80, then zeroes, then the 64-bit length. (little-endian)
+	m_buf[m_bufLen++] = 0x80;
+	if (m_bufLen > BLOCK_SIZE - 8) {
+		memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - m_bufLen);
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+	memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - 8 - m_bufLen);
+	for (unsigned int i = 0; i < 8; i++) {
+		m_buf[BLOCK_SIZE - 8 + i] = static_cast<uint8_t>(bitLength >> (i * 8));
+	}
+	processBlocks(m_buf, 1);
+
+	for (unsigned int i = 0; i < 4; i++) {
+		const uint32_t x = cpu_to_le32(m_state[i]);
+		memcpy(&digest[i * 4], &x, sizeof(x));
+	}
+
+	reset();
+}
+
+/**
+ * Hash a buffer.
+ * @param data		[in] Data.
+ * @param size		[in] Size of data, in bytes.
+ * @param digest	[out] Digest. (DIGEST_SIZE bytes)
+ */
+void Md5::hash(const void *data, size_t size, uint8_t *digest)
+{
+	Md5 md5;
+	md5.update(data, size);
+	md5.finish(digest);
+}
+
+}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha1.cpp: SHA-1 hash function.                                          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+#include "Sha1.hpp"
+
+#ifdef HAVE_SHA_NI
+# include "../cpuflags_x86.h"
+#endif /* HAVE_SHA_NI */
+
+namespace LibRpBase {
+
+static inline uint32_t rol32(uint32_t x, unsigned int n)
+{
+	return (x << n) | (x >> (32 - n));
+}
+
+Sha1::Sha1()
+{
+	reset();
+}
+
+/**
+ * Reset the hash state.
+ */
+void Sha1::reset(void)
+{
+	m_state[0] = 0x67452301;
+	m_state[1] = 0xEFCDAB89;
+	m_state[2] = 0x98BADCFE;
+	m_state[3] = 0x10325476;
+	m_state[4] = 0xC3D2E1F0;
+	m_length = 0;
+	m_bufLen = 0;
+}
+
+/**
+ * Process 64-byte blocks.
+ * @param data Data.
+ * @param count Number of blocks.
+ */
+void Sha1::processBlocks(const uint8_t *data, size_t count)
+{
+#ifdef HAVE_SHA_NI
+	if (RP_CPU_HasSHA() && RP_CPU_HasSSE41()) {
+		// Use the SHA extensions.
+		processBlocks_ShaNI(m_state, data, count);
+		return;
+	}
+#endif /* HAVE_SHA_NI */
+
+	uint32_t w[80];
+	for (; count > 0; count--, data += BLOCK_SIZE) {
+		for (unsigned int i = 0; i < 16; i++) {
+			uint32_t x;
+			memcpy(&x, &data[i * 4], sizeof(x));
+			w[i] = be32_to_cpu(x);
+		}
+		for (unsigned int i = 16; i < 80; i++) {
+			w[i] = rol32(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+		}
+
+		uint32_t a = m_state[0];
+		uint32_t b = m_state[1];
+		uint32_t c = m_state[2];
+		uint32_t d = m_state[3];
+		uint32_t e = m_state[4];
+
+#define SHA1_ROUND(f, k, i) do { \
+	const uint32_t t = rol32(a, 5) + (f) + e + (k) + w[i]; \
+	e = d; d = c; c = rol32(b, 30); b = a; a = t; \
+} while (0)
+
+		unsigned int i = 0;
+		for (; i < 20; i++)
+			SHA1_ROUND((b & c) | (~b & d), 0x5A827999, i);
+		for (; i < 40; i++)
+			SHA1_ROUND(b ^ c ^ d, 0x6ED9EBA1, i);
+		for (; i < 60; i++)
+			SHA1_ROUND((b & c) | (b & d) | (c & d), 0x8F1BBCDC, i);
+		for (; i < 80; i++)
+			SHA1_ROUND(b ^ c ^ d, 0xCA62C1D6, i);
+
+#undef SHA1_ROUND
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+		m_state[4] += e;
+	}
+}
+
+/**
+ * Add data to the hash.
+ * @param data Data.
+ * @param size Size of data, in bytes.
+ */
+void Sha1::update(const void *data, size_t size)
+{
+	const uint8_t *data8 = static_cast<const uint8_t*>(data);
+	m_length += size;
+
+	if (m_bufLen > 0) {
+		// Fill the partial block first.
+		size_t sz = BLOCK_SIZE - m_bufLen;
+		if (sz > size) {
+			sz = size;
+		}
+		memcpy(&m_buf[m_bufLen], data8, sz);
+		m_bufLen += static_cast<unsigned int>(sz);
+		data8 += sz;
+		size -= sz;
+		if (m_bufLen < BLOCK_SIZE) {
+			return;
+		}
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+
+	// Process full blocks directly from the input buffer.
+	const size_t blocks = size / BLOCK_SIZE;
+	if (blocks > 0) {
+		processBlocks(data8, blocks);
+		data8 += blocks * BLOCK_SIZE;
+		size -= blocks * BLOCK_SIZE;
+	}
+
+	// Save the remaining data.
+	if (size > 0) {
+		memcpy(m_buf, data8, size);
+		m_bufLen = static_cast<unsigned int>(size);
+	}
+}
+
+/**
+ * Finish the hash and get the digest.
+ * The hash state is reset afterwards.
+ * @param digest [out] Digest. (DIGEST_SIZE bytes)
+ */
+void Sha1::finish(uint8_t *digest)
+{
+	const uint64_t bitLength = m_length * 8;
+
+	// Padding: 0x80, then zeroes, then the 64-bit length.
+	m_buf[m_bufLen++] = 0x80;
+	if (m_bufLen > BLOCK_SIZE - 8) {
+		memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - m_bufLen);
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+	memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - 8 - m_bufLen);
+	for (unsigned int i = 0; i < 8; i++) {
+		m_buf[BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+	}
+	processBlocks(m_buf, 1);
+
+	for (unsigned int i = 0; i < 5; i++) {
+		const uint32_t x = cpu_to_be32(m_state[i]);
+		memcpy(&digest[i * 4], &x, sizeof(x));
+	}
+
+	reset();
+}
+
+/**
+ * Hash a buffer.
+ * @param data		[in] Data.
+ * @param size		[in] Size of data, in bytes.
+ * @param digest	[out] Digest. (DIGEST_SIZE bytes)
+ */
+void Sha1::hash(const void *data, size_t size, uint8_t *digest)
+{
+	Sha1 sha1;
+	sha1.update(data, size);
+	sha1.finish(digest);
+}
+
+}
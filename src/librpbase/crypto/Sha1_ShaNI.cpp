@@ -0,0 +1,108 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha1_ShaNI.cpp: SHA-1 hash function. (SHA-NI optimized version)         *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Sha1.hpp"
+
+// SHA-NI intrinsics.
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Process four rounds.
+ * Message schedule instructions are only issued where
+ * their results are actually used by a later round.
+ * @param k	[in] Round group. (0-19; rounds 4k to 4k+3)
+ * @param E	[in/out] E for this round group.
+ * @param Enext	[out] E for the next round group.
+ * @param M	[in] Message words for this round group.
+ * @param M1	[in/out] Message words for round group k+1.
+ * @param M2	[in/out] Message words for round group k+2.
+ * @param M3	[in/out] Message words for round group k+3.
+ */
+#define SHA1_ROUNDS4(k, E, Enext, M, M1, M2, M3) do { \
+	E = _mm_sha1nexte_epu32(E, M); \
+	Enext = abcd; \
+	if (k >= 3 && k <= 18) { \
+		M1 = _mm_sha1msg2_epu32(M1, M); \
+	} \
+	abcd = _mm_sha1rnds4_epu32(abcd, E, (k) / 5); \
+	if (k >= 1 && k <= 16) { \
+		M3 = _mm_sha1msg1_epu32(M3, M); \
+	} \
+	if (k >= 2 && k <= 17) { \
+		M2 = _mm_xor_si128(M2, M); \
+	} \
+} while (0)
+
+/**
+ * Process 64-byte blocks using the x86 SHA extensions.
+ * Selected at runtime if the CPU supports it.
+ * @param state Hash state.
+ * @param data Data.
+ * @param count Number of blocks.
+ */
+void Sha1::processBlocks_ShaNI(uint32_t *state, const uint8_t *data, size_t count)
+{
+	// Byte-swap mask for big-endian message words.
+	const __m128i bswap_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+	// The SHA-1 instructions expect A in the high dword.
+	__m128i abcd = _mm_shuffle_epi32(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+	__m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+	__m128i e1;
+
+	for (; count > 0; count--, data += BLOCK_SIZE) {
+		const __m128i abcd_save = abcd;
+		const __m128i e0_save = e0;
+
+		const __m128i *const data128 = reinterpret_cast<const __m128i*>(data);
+		__m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[0]), bswap_mask);
+		__m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[1]), bswap_mask);
+		__m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[2]), bswap_mask);
+		__m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[3]), bswap_mask);
+
+		// Rounds 0-3: E is added directly.
+		e0 = _mm_add_epi32(e0, m0);
+		e1 = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+		SHA1_ROUNDS4( 1, e1, e0, m1, m2, m3, m0);
+		SHA1_ROUNDS4( 2, e0, e1, m2, m3, m0, m1);
+		SHA1_ROUNDS4( 3, e1, e0, m3, m0, m1, m2);
+		SHA1_ROUNDS4( 4, e0, e1, m0, m1, m2, m3);
+		SHA1_ROUNDS4( 5, e1, e0, m1, m2, m3, m0);
+		SHA1_ROUNDS4( 6, e0, e1, m2, m3, m0, m1);
+		SHA1_ROUNDS4( 7, e1, e0, m3, m0, m1, m2);
+		SHA1_ROUNDS4( 8, e0, e1, m0, m1, m2, m3);
+		SHA1_ROUNDS4( 9, e1, e0, m1, m2, m3, m0);
+		SHA1_ROUNDS4(10, e0, e1, m2, m3, m0, m1);
+		SHA1_ROUNDS4(11, e1, e0, m3, m0, m1, m2);
+		SHA1_ROUNDS4(12, e0, e1, m0, m1, m2, m3);
+		SHA1_ROUNDS4(13, e1, e0, m1, m2, m3, m0);
+		SHA1_ROUNDS4(14, e0, e1, m2, m3, m0, m1);
+		SHA1_ROUNDS4(15, e1, e0, m3, m0, m1, m2);
+		SHA1_ROUNDS4(16, e0, e1, m0, m1, m2, m3);
+		SHA1_ROUNDS4(17, e1, e0, m1, m2, m3, m0);
+		SHA1_ROUNDS4(18, e0, e1, m2, m3, m0, m1);
+		SHA1_ROUNDS4(19, e1, e0, m3, m0, m1, m2);
+
+		// Add this block's hash to the state.
+		e0 = _mm_sha1nexte_epu32(e0, e0_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+}
@@ -0,0 +1,211 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha256.cpp: SHA-256 hash function.                                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+#include "Sha256.hpp"
+
+#ifdef HAVE_SHA_NI
+# include "../cpuflags_x86.h"
+#endif /* HAVE_SHA_NI */
+
+namespace LibRpBase {
+
+static inline uint32_t ror32(uint32_t x, unsigned int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+// Round constants.
+const uint32_t Sha256::K[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+	0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+	0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+	0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+Sha256::Sha256()
+{
+	reset();
+}
+
+/**
+ * Reset the hash state.
+ */
+void Sha256::reset(void)
+{
+	m_state[0] = 0x6A09E667;
+	m_state[1] = 0xBB67AE85;
+	m_state[2] = 0x3C6EF372;
+	m_state[3] = 0xA54FF53A;
+	m_state[4] = 0x510E527F;
+	m_state[5] = 0x9B05688C;
+	m_state[6] = 0x1F83D9AB;
+	m_state[7] = 0x5BE0CD19;
+	m_length = 0;
+	m_bufLen = 0;
+}
+
+/**
+ * Process 64-byte blocks.
+ * @param data Data.
+ * @param count Number of blocks.
+ */
+void Sha256::processBlocks(const uint8_t *data, size_t count)
+{
+#ifdef HAVE_SHA_NI
+	if (RP_CPU_HasSHA() && RP_CPU_HasSSE41()) {
+		// Use the SHA extensions.
+		processBlocks_ShaNI(m_state, data, count);
+		return;
+	}
+#endif /* HAVE_SHA_NI */
+
+	uint32_t w[64];
+	for (; count > 0; count--, data += BLOCK_SIZE) {
+		for (unsigned int i = 0; i < 16; i++) {
+			uint32_t x;
+			memcpy(&x, &data[i * 4], sizeof(x));
+			w[i] = be32_to_cpu(x);
+		}
+		for (unsigned int i = 16; i < 64; i++) {
+			const uint32_t s0 = ror32(w[i-15], 7) ^ ror32(w[i-15], 18) ^ (w[i-15] >> 3);
+			const uint32_t s1 = ror32(w[i-2], 17) ^ ror32(w[i-2], 19) ^ (w[i-2] >> 10);
+			w[i] = w[i-16] + s0 + w[i-7] + s1;
+		}
+
+		uint32_t a = m_state[0];
+		uint32_t b = m_state[1];
+		uint32_t c = m_state[2];
+		uint32_t d = m_state[3];
+		uint32_t e = m_state[4];
+		uint32_t f = m_state[5];
+		uint32_t g = m_state[6];
+		uint32_t h = m_state[7];
+
+		for (unsigned int i = 0; i < 64; i++) {
+			const uint32_t S1 = ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25);
+			const uint32_t ch = (e & f) ^ (~e & g);
+			const uint32_t t1 = h + S1 + ch + K[i] + w[i];
+			const uint32_t S0 = ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22);
+			const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+			const uint32_t t2 = S0 + maj;
+
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+		m_state[4] += e;
+		m_state[5] += f;
+		m_state[6] += g;
+		m_state[7] += h;
+	}
+}
+
+/**
+ * Add data to the hash.
+ * @param data Data.
+ * @param size Size of data, in bytes.
+ */
+void Sha256::update(const void *data, size_t size)
+{
+	const uint8_t *data8 = static_cast<const uint8_t*>(data);
+	m_length += size;
+
+	if (m_bufLen > 0) {
+		// Fill the partial block first.
+		size_t sz = BLOCK_SIZE - m_bufLen;
+		if (sz > size) {
+			sz = size;
+		}
+		memcpy(&m_buf[m_bufLen], data8, sz);
+		m_bufLen += static_cast<unsigned int>(sz);
+		data8 += sz;
+		size -= sz;
+		if (m_bufLen < BLOCK_SIZE) {
+			return;
+		}
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+
+	// Process full blocks directly from the input buffer.
+	const size_t blocks = size / BLOCK_SIZE;
+	if (blocks > 0) {
+		processBlocks(data8, blocks);
+		data8 += blocks * BLOCK_SIZE;
+		size -= blocks * BLOCK_SIZE;
+	}
+
+	// Save the remaining data.
+	if (size > 0) {
+		memcpy(m_buf, data8, size);
+		m_bufLen = static_cast<unsigned int>(size);
+	}
+}
+
+/**
+ * Finish the hash and get the digest.
+ * The hash state is reset afterwards.
+ * @param digest [out] Digest. (DIGEST_SIZE bytes)
+ */
+void Sha256::finish(uint8_t *digest)
+{
+	const uint64_t bitLength = m_length * 8;
+
+	// Padding: 0x80, then zeroes, then the 64-bit length.
+	m_buf[m_bufLen++] = 0x80;
+	if (m_bufLen > BLOCK_SIZE - 8) {
+		memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - m_bufLen);
+		processBlocks(m_buf, 1);
+		m_bufLen = 0;
+	}
+	memset(&m_buf[m_bufLen], 0, BLOCK_SIZE - 8 - m_bufLen);
+	for (unsigned int i = 0; i < 8; i++) {
+		m_buf[BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+	}
+	processBlocks(m_buf, 1);
+
+	for (unsigned int i = 0; i < 8; i++) {
+		const uint32_t x = cpu_to_be32(m_state[i]);
+		memcpy(&digest[i * 4], &x, sizeof(x));
+	}
+
+	reset();
+}
+
+/**
+ * Hash a buffer.
+ * @param data		[in] Data.
+ * @param size		[in] Size of data, in bytes.
+ * @param digest	[out] Digest. (DIGEST_SIZE bytes)
+ */
+void Sha256::hash(const void *data, size_t size, uint8_t *digest)
+{
+	Sha256 sha256;
+	sha256.update(data, size);
+	sha256.finish(digest);
+}
+
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha256.hpp: SHA-256 hash function.                                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase {
+
+/**
+ * SHA-256 hash function.
+ *
+ * This is a portable implementation that doesn't depend on
+ * the system crypto library, so it's available even if
+ * decryption is disabled. On x86, the SHA extensions are
+ * used if the CPU supports them.
+ */
+class Sha256
+{
+	public:
+		Sha256();
+
+	private:
+		RP_DISABLE_COPY(Sha256)
+
+	public:
+		// Digest size, in bytes.
+		static const unsigned int DIGEST_SIZE = 32;
+		// Block size, in bytes.
+		static const unsigned int BLOCK_SIZE = 64;
+
+		/**
+		 * Reset the hash state.
+		 */
+		void reset(void);
+
+		/**
+		 * Add data to the hash.
+		 * @param data Data.
+		 * @param size Size of data, in bytes.
+		 */
+		void update(const void *data, size_t size);
+
+		/**
+		 * Finish the hash and get the digest.
+		 * The hash state is reset afterwards.
+		 * @param digest [out] Digest. (DIGEST_SIZE bytes)
+		 */
+		void finish(uint8_t *digest);
+
+		/**
+		 * Hash a buffer.
+		 * @param data		[in] Data.
+		 * @param size		[in] Size of data, in bytes.
+		 * @param digest	[out] Digest. (DIGEST_SIZE bytes)
+		 */
+		static void hash(const void *data, size_t size, uint8_t *digest);
+
+	private:
+		/**
+		 * Process 64-byte blocks.
+		 * @param data Data.
+		 * @param count Number of blocks.
+		 */
+		void processBlocks(const uint8_t *data, size_t count);
+
+		/**
+		 * Process 64-byte blocks using the x86 SHA extensions.
+		 * Selected at runtime if the CPU supports it.
+		 * @param state Hash state.
+		 * @param data Data.
+		 * @param count Number of blocks.
+		 */
+		static void processBlocks_ShaNI(uint32_t *state, const uint8_t *data, size_t count);
+
+	private:
+		// Round constants.
+		static const uint32_t K[64];
+
+		uint32_t m_state[8];
+		uint64_t m_length;		// Total length, in bytes.
+		uint8_t m_buf[BLOCK_SIZE];	// Partial block.
+		unsigned int m_bufLen;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_SHA256_HPP__ */
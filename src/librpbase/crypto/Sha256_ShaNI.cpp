@@ -0,0 +1,104 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Sha256_ShaNI.cpp: SHA-256 hash function. (SHA-NI optimized version)     *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Sha256.hpp"
+
+// SHA-NI intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Process four rounds.
+ * Message schedule instructions are only issued where
+ * their results are actually used by a later round.
+ * @param k	[in] Round group. (0-15; rounds 4k to 4k+3)
+ * @param M	[in] Message words for this round group.
+ * @param M1	[in/out] Message words for round group k+1.
+ * @param M3	[in/out] Message words for round group k+3.
+ */
+#define SHA256_ROUNDS4(k, M, M1, M3) do { \
+	__m128i msg = _mm_add_epi32(M, \
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[(k) * 4]))); \
+	cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg); \
+	if (k >= 3 && k <= 14) { \
+		M1 = _mm_add_epi32(M1, _mm_alignr_epi8(M, M3, 4)); \
+		M1 = _mm_sha256msg2_epu32(M1, M); \
+	} \
+	msg = _mm_shuffle_epi32(msg, 0x0E); \
+	abef = _mm_sha256rnds2_epu32(abef, cdgh, msg); \
+	if (k >= 1 && k <= 12) { \
+		M3 = _mm_sha256msg1_epu32(M3, M); \
+	} \
+} while (0)
+
+/**
+ * Process 64-byte blocks using the x86 SHA extensions.
+ * Selected at runtime if the CPU supports it.
+ * @param state Hash state.
+ * @param data Data.
+ * @param count Number of blocks.
+ */
+void Sha256::processBlocks_ShaNI(uint32_t *state, const uint8_t *data, size_t count)
+{
+	// Byte-swap mask for big-endian message words.
+	const __m128i bswap_mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+	// The SHA-256 instructions use the state as ABEF and CDGH.
+	__m128i tmp = _mm_shuffle_epi32(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);	// CDAB
+	__m128i cdgh = _mm_shuffle_epi32(
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);	// EFGH
+	__m128i abef = _mm_alignr_epi8(tmp, cdgh, 8);	// ABEF
+	cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);	// CDGH
+
+	for (; count > 0; count--, data += BLOCK_SIZE) {
+		const __m128i abef_save = abef;
+		const __m128i cdgh_save = cdgh;
+
+		const __m128i *const data128 = reinterpret_cast<const __m128i*>(data);
+		__m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[0]), bswap_mask);
+		__m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[1]), bswap_mask);
+		__m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[2]), bswap_mask);
+		__m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128(&data128[3]), bswap_mask);
+
+		SHA256_ROUNDS4( 0, m0, m1, m3);
+		SHA256_ROUNDS4( 1, m1, m2, m0);
+		SHA256_ROUNDS4( 2, m2, m3, m1);
+		SHA256_ROUNDS4( 3, m3, m0, m2);
+		SHA256_ROUNDS4( 4, m0, m1, m3);
+		SHA256_ROUNDS4( 5, m1, m2, m0);
+		SHA256_ROUNDS4( 6, m2, m3, m1);
+		SHA256_ROUNDS4( 7, m3, m0, m2);
+		SHA256_ROUNDS4( 8, m0, m1, m3);
+		SHA256_ROUNDS4( 9, m1, m2, m0);
+		SHA256_ROUNDS4(10, m2, m3, m1);
+		SHA256_ROUNDS4(11, m3, m0, m2);
+		SHA256_ROUNDS4(12, m0, m1, m3);
+		SHA256_ROUNDS4(13, m1, m2, m0);
+		SHA256_ROUNDS4(14, m2, m3, m1);
+		SHA256_ROUNDS4(15, m3, m0, m2);
+
+		// Add this block's hash to the state.
+		abef = _mm_add_epi32(abef, abef_save);
+		cdgh = _mm_add_epi32(cdgh, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(abef, 0x1B);		// FEBA
+	cdgh = _mm_shuffle_epi32(cdgh, 0xB1);		// DCHG
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]),
+		_mm_blend_epi16(tmp, cdgh, 0xF0));	// DCBA
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]),
+		_mm_alignr_epi8(cdgh, tmp, 8));		// HGFE
+}
+
+}
@@ -12,14 +12,24 @@
 
 // librpbase
 #include "file/IRpFile.hpp"
+#include "file/IoStats.hpp"
 #ifdef ENABLE_DECRYPTION
 # include "crypto/AesCipherFactory.hpp"
 # include "crypto/IAesCipher.hpp"
 # include "crypto/KeyManager.hpp"
+
+// librpthreads
+# include "librpthreads/Mutex.hpp"
+# include "librpthreads/Thread.hpp"
 #endif
 
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRpBase {
 
+static IoStats::Layer ioLayer("CBCReader");
+
 class CBCReaderPrivate
 {
 	public:
@@ -44,7 +54,51 @@ class CBCReaderPrivate
 		// Encryption cipher.
 		uint8_t key[16];
 		uint8_t iv[16];
+		bool isCBC;			// True for CBC; false for ECB.
 		LibRpBase::IAesCipher *cipher;
+
+		// Locked by CBCReader::pread() while using the ciphers.
+		Mutex cipherMutex;
+
+		// Minimum amount of data to decrypt using multiple threads,
+		// and the minimum amount of data for each thread.
+		static const size_t PARALLEL_MIN_SIZE = 1024*1024;
+		static const size_t PARALLEL_CHUNK_MIN_SIZE = 256*1024;
+		static const unsigned int PARALLEL_MAX_THREADS = 16;
+
+		// Additional ciphers for parallel decryption.
+		// The calling thread uses the main cipher.
+		// Allocated on first use. (protected by cipherMutex)
+		unique_ptr<unique_ptr<IAesCipher>[]> workerCiphers;
+		unsigned int workerCipherCount;
+
+		/**
+		 * Decryption job for a single thread.
+		 */
+		struct DecryptJob {
+			IAesCipher *cipher;
+			uint8_t *data;
+			size_t size;
+			uint8_t iv[16];
+			bool isCBC;
+			bool ok;
+		};
+
+		/**
+		 * Decryption worker thread function.
+		 * @param arg DecryptJob.
+		 */
+		static void decryptWorker(void *arg);
+
+		/**
+		 * Read and decrypt full blocks at the specified position.
+		 * cipherMutex must *not* be locked by the caller.
+		 * @param pos_block	[in] Position, in bytes. (Must be a multiple of 16.)
+		 * @param buf		[out] Output buffer.
+		 * @param size		[in] Size, in bytes. (Must be a multiple of 16.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readBlocks(off64_t pos_block, uint8_t *buf, size_t size);
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -58,7 +112,9 @@ CBCReaderPrivate::CBCReaderPrivate(CBCReader *q,
 	, length(length)
 	, pos(0)
 #ifdef ENABLE_DECRYPTION
+	, isCBC(iv != nullptr)
 	, cipher(nullptr)
+	, workerCipherCount(0)
 #endif
 {
 	assert(q->m_file != nullptr);
@@ -117,6 +173,165 @@ CBCReaderPrivate::~CBCReaderPrivate()
 #endif /* ENABLE_DECRYPTION */
 }
 
+#ifdef ENABLE_DECRYPTION
+/**
+ * Decryption worker thread function.
+ * @param arg DecryptJob.
+ */
+void CBCReaderPrivate::decryptWorker(void *arg)
+{
+	DecryptJob *const job = static_cast<DecryptJob*>(arg);
+	size_t sz_dec;
+	if (job->isCBC) {
+		sz_dec = job->cipher->decrypt(job->data, job->size, job->iv, sizeof(job->iv));
+	} else {
+		sz_dec = job->cipher->decrypt(job->data, job->size);
+	}
+	job->ok = (sz_dec == job->size);
+}
+
+/**
+ * Read and decrypt full blocks at the specified position.
+ * cipherMutex must *not* be locked by the caller.
+ * @param pos_block	[in] Position, in bytes. (Must be a multiple of 16.)
+ * @param buf		[out] Output buffer.
+ * @param size		[in] Size, in bytes. (Must be a multiple of 16.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CBCReaderPrivate::readBlocks(off64_t pos_block, uint8_t *buf, size_t size)
+{
+	assert((pos_block & 15) == 0);
+	assert((size & 15) == 0);
+	RP_Q(CBCReader);
+	IRpFile *const file = q->m_file;
+
+	// Get the IV.
+	// This is either the specified IV or the previous
+	// ciphertext block. ECB doesn't use an IV.
+	uint8_t iv[16];
+	if (!isCBC) {
+		memset(iv, 0, sizeof(iv));
+	} else if (pos_block == 0) {
+		// Start of data.
+		// Use the specified IV.
+		memcpy(iv, this->iv, sizeof(iv));
+	} else {
+		// Not start of data.
+		// Read the IV from the previous 16 bytes.
+		if (file->pread(offset + pos_block - 16, iv, sizeof(iv)) != sizeof(iv)) {
+			// Read error.
+			return -EIO;
+		}
+	}
+
+	// Read the encrypted data.
+	if (file->pread(offset + pos_block, buf, size) != size) {
+		// Short read.
+		// Cannot decrypt with a short read.
+		return -EIO;
+	}
+
+	// Determine how many threads to use.
+	unsigned int threads = 1;
+	if (size >= PARALLEL_MIN_SIZE) {
+		threads = Thread::cpuCount();
+		const size_t maxThreads = size / PARALLEL_CHUNK_MIN_SIZE;
+		if (threads > maxThreads) {
+			threads = static_cast<unsigned int>(maxThreads);
+		}
+		if (threads > PARALLEL_MAX_THREADS) {
+			threads = PARALLEL_MAX_THREADS;
+		}
+		if (threads == 0) {
+			threads = 1;
+		}
+	}
+
+	MutexLocker cipherLock(cipherMutex);
+	if (threads == 1) {
+		// Decrypt the data using the main cipher.
+		DecryptJob job;
+		job.cipher = cipher;
+		job.data = buf;
+		job.size = size;
+		memcpy(job.iv, iv, sizeof(iv));
+		job.isCBC = isCBC;
+		decryptWorker(&job);
+		return (job.ok ? 0 : -EIO);
+	}
+
+	// Make sure we have enough ciphers.
+	// The cipher objects aren't thread-safe.
+	if (workerCipherCount < threads - 1) {
+		unique_ptr<unique_ptr<IAesCipher>[]> newCiphers(new unique_ptr<IAesCipher>[threads - 1]);
+		for (unsigned int i = 0; i < workerCipherCount; i++) {
+			newCiphers[i] = std::move(workerCiphers[i]);
+		}
+		for (unsigned int i = workerCipherCount; i < threads - 1; i++) {
+			IAesCipher *const newCipher = AesCipherFactory::create();
+			if (!newCipher || !newCipher->isInit()) {
+				delete newCipher;
+				return -EIO;
+			}
+			newCiphers[i].reset(newCipher);
+			int ret = newCipher->setChainingMode(isCBC ? IAesCipher::CM_CBC : IAesCipher::CM_ECB);
+			ret |= newCipher->setKey(key, sizeof(key));
+			if (ret != 0) {
+				return -EIO;
+			}
+		}
+		workerCiphers = std::move(newCiphers);
+		workerCipherCount = threads - 1;
+	}
+
+	// Split the data into one chunk per thread.
+	// Each chunk's IV is the last ciphertext block of the
+	// previous chunk, so get the IVs before decrypting.
+	const size_t chunkSize = ((size / threads) + 15) & ~static_cast<size_t>(15);
+	unique_ptr<DecryptJob[]> jobs(new DecryptJob[threads]);
+	size_t chunkPos = 0;
+	for (unsigned int i = 0; i < threads; i++) {
+		DecryptJob &job = jobs[i];
+		job.cipher = (i == 0 ? cipher : workerCiphers[i - 1].get());
+		job.data = &buf[chunkPos];
+		job.size = std::min(chunkSize, size - chunkPos);
+		if (i == 0) {
+			memcpy(job.iv, iv, sizeof(iv));
+		} else {
+			memcpy(job.iv, &buf[chunkPos - 16], sizeof(job.iv));
+		}
+		job.isCBC = isCBC;
+		job.ok = false;
+		chunkPos += job.size;
+	}
+	assert(chunkPos == size);
+
+	// Start the additional worker threads.
+	// If a thread can't be started, its chunk will be
+	// decrypted by the calling thread afterwards.
+	unique_ptr<Thread[]> workerThreads(new Thread[threads - 1]);
+	unique_ptr<bool[]> started(new bool[threads - 1]);
+	for (unsigned int i = 1; i < threads; i++) {
+		started[i - 1] = (workerThreads[i - 1].start(decryptWorker, &jobs[i]) == 0);
+	}
+
+	// The calling thread is also a worker thread.
+	decryptWorker(&jobs[0]);
+
+	bool ok = jobs[0].ok;
+	for (unsigned int i = 1; i < threads; i++) {
+		if (started[i - 1]) {
+			workerThreads[i - 1].join();
+		} else {
+			decryptWorker(&jobs[i]);
+		}
+		ok &= jobs[i].ok;
+	}
+
+	return (ok ? 0 : -EIO);
+}
+#endif /* ENABLE_DECRYPTION */
+
 /** CBCReader **/
 
 /**
@@ -152,6 +367,28 @@ CBCReader::~CBCReader()
  */
 size_t CBCReader::read(void *ptr, size_t size)
 {
+	RP_D(CBCReader);
+	size_t ret = this->pread(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the partition at the specified position.
+ * This does not change the partition position.
+ *
+ * Large reads are decrypted using multiple threads,
+ * since each CBC block only depends on the previous
+ * ciphertext block.
+ *
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CBCReader::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
 	RP_D(CBCReader);
 	assert(ptr != nullptr);
 	assert(m_file != nullptr);
@@ -162,19 +399,22 @@ size_t CBCReader::read(void *ptr, size_t size)
 	} else if (!m_file || !m_file->isOpen()) {
 		m_lastError = EBADF;
 		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
 	} else if (size == 0) {
 		// Nothing to do...
 		return 0;
 	}
 
 	// Are we already at the end of the file?
-	if (d->pos >= d->length)
+	if (pos >= d->length)
 		return 0;
 
-	// Make sure d->pos + size <= d->length.
+	// Make sure pos + size <= d->length.
 	// If it isn't, we'll do a short read.
-	if (d->pos + (off64_t)size >= d->length) {
-		size = (size_t)(d->length - d->pos);
+	if (pos + (off64_t)size >= d->length) {
+		size = (size_t)(d->length - pos);
 	}
 
 #ifdef ENABLE_DECRYPTION
@@ -184,7 +424,7 @@ size_t CBCReader::read(void *ptr, size_t size)
 #endif /* ENABLE_DECRYPTION */
 	{
 		// No encryption. Read directly from the file.
-		size_t sz_read = m_file->seekAndRead(d->offset + d->pos, ptr, size);
+		size_t sz_read = m_file->pread(d->offset + pos, ptr, size);
 		if (sz_read != size) {
 			// Seek and/or read error.
 			m_lastError = m_file->lastError();
@@ -193,144 +433,74 @@ size_t CBCReader::read(void *ptr, size_t size)
 			}
 			return 0;
 		}
-		d->pos += size;
 		return sz_read;
 	}
 
 #ifdef ENABLE_DECRYPTION
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 
-	// TODO: Check for overflow.
-	if (d->pos + (off64_t)size > d->length) {
-		// Reduce size so it doesn't go out of bounds.
-		size = d->length - d->pos;
-	}
-
-	uint8_t iv[16];
-
-	// Read the first block.
-	// NOTE: If we're in the middle of a block, round it down.
-	const off64_t pos_block = d->pos & ~15LL;
-
 	// Total number of bytes read.
 	size_t total_sz_read = 0;
 
-	// Get the IV.
-	if (pos_block == 0) {
-		// Start of data.
-		// Use the specified IV.
-		memcpy(iv, d->iv, sizeof(iv));
-		m_file->seek(d->offset);
-	} else {
-		// Not start of data.
-		// Read the IV from the previous 16 bytes.
-		// TODO: Cache it!
-		m_file->seek(d->offset + pos_block - 16);
-		size_t sz_read = m_file->read(iv, sizeof(iv));
-		if (sz_read != sizeof(iv)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
-		}
-	}
-
-	// Set the IV.
-	int ret = d->cipher->setIV(iv, sizeof(iv));
-	if (ret != 0) {
-		// setIV() failed.
-		m_lastError = EIO;
-		return 0;
-	}
-
 	uint8_t block_tmp[16];
-	if (d->pos != pos_block) {
+	if (pos & 15) {
 		// We're in the middle of a block.
 		// Read and decrypt the full block, and copy out
 		// the necessary bytes.
-		const size_t sz = std::min(16U - (static_cast<size_t>(d->pos) & 15U), size);
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
-			// Read error.
+		const size_t sz = std::min(16U - (static_cast<size_t>(pos) & 15U), size);
+		int ret = d->readBlocks(pos & ~15LL, block_tmp, sizeof(block_tmp));
+		if (ret != 0) {
+			// Read and/or decrypt error.
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
-				m_lastError = EIO;
+				m_lastError = -ret;
 			}
 			return 0;
 		}
 
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
-		}
-
-		memcpy(ptr8, &block_tmp[d->pos & 15], sz);
+		memcpy(ptr8, &block_tmp[pos & 15], sz);
 		ptr8 += sz;
 		size -= sz;
 		total_sz_read += sz;
-		d->pos += sz;
+		pos += sz;
 	}
 
 	// Read full blocks.
-	size_t full_block_sz = size & ~15LL;
+	// Large reads are decrypted using multiple threads.
+	const size_t full_block_sz = size & ~static_cast<size_t>(15);
 	if (full_block_sz > 0) {
-		size_t sz_read = m_file->read(ptr8, full_block_sz);
-		if (sz_read != full_block_sz) {
-			// Short read.
-			// Cannot decrypt with a short read.
+		int ret = d->readBlocks(pos, ptr8, full_block_sz);
+		if (ret != 0) {
+			// Read and/or decrypt error.
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
-				m_lastError = EIO;
+				m_lastError = -ret;
 			}
 			return 0;
 		}
 
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(ptr8, full_block_sz);
-		if (sz_dec != full_block_sz) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
-		}
-
-		ptr8 += sz_read;
-		size -= sz_read;
-		total_sz_read += sz_read;
-		d->pos += sz_read;
+		ptr8 += full_block_sz;
+		size -= full_block_sz;
+		total_sz_read += full_block_sz;
+		pos += full_block_sz;
 	}
 
 	if (size > 0) {
 		// We need to decrypt a partial block at the end.
 		// Read and decrypt the full block, and copy out
 		// the necessary bytes.
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
-			// Read error.
+		int ret = d->readBlocks(pos, block_tmp, sizeof(block_tmp));
+		if (ret != 0) {
+			// Read and/or decrypt error.
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
-				m_lastError = EIO;
+				m_lastError = -ret;
 			}
 			return 0;
 		}
 
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
-		}
-
 		memcpy(ptr8, block_tmp, size);
-		ptr8 += size;
 		total_sz_read += size;
-		d->pos += size;
-		size = 0;
 	}
 
 	// Data read and decrypted successfully.
@@ -348,6 +518,7 @@ size_t CBCReader::read(void *ptr, size_t size)
  */
 int CBCReader::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	RP_D(CBCReader);
 	assert(m_file != nullptr);
 	assert(m_file->isOpen());
@@ -364,7 +535,7 @@ int CBCReader::seek(off64_t pos)
 	} else if (pos >= d->length) {
 		d->pos = d->length;
 	} else {
-		d->pos = static_cast<uint32_t>(pos);
+		d->pos = pos;
 	}
 	return 0;
 }
@@ -55,6 +55,21 @@ class CBCReader : public LibRpBase::IPartition
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the partition at the specified position.
+		 * This does not change the partition position.
+		 *
+		 * Large reads are decrypted using multiple threads,
+		 * since each CBC block only depends on the previous
+		 * ciphertext block.
+		 *
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
@@ -10,9 +10,13 @@
 
 #include "stdafx.h"
 #include "DiscReader.hpp"
+#include "../file/IoStats.hpp"
 
 namespace LibRpBase {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("DiscReader");
+
 /**
  * Construct a DiscReader with the specified file.
  * The file is ref()'d, so the original file can be
@@ -104,6 +108,7 @@ int DiscReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
  */
 size_t DiscReader::read(void *ptr, size_t size)
 {
+	IoStats::ReadScope ioScope(ioLayer);
 	assert(m_file != nullptr);
 	if (!m_file) {
 		m_lastError = EBADF;
@@ -118,7 +123,42 @@ size_t DiscReader::read(void *ptr, size_t size)
 
 	size_t ret = m_file->read(ptr, size);
 	m_lastError = m_file->lastError();
-	return ret;
+	return ioScope.done(ret);
+}
+
+/**
+ * Read data from the disc image at the specified position.
+ * This does not change the disc image position.
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t DiscReader::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (pos >= m_length) {
+		// End of the disc image.
+		return 0;
+	}
+
+	// Constrain size based on the length.
+	if (static_cast<off64_t>(size) > m_length - pos) {
+		size = static_cast<size_t>(m_length - pos);
+	}
+
+	size_t ret = m_file->pread(pos + m_offset, ptr, size);
+	if (ret != size) {
+		m_lastError = m_file->lastError();
+	}
+	return ioScope.done(ret);
 }
 
 /**
@@ -128,6 +168,7 @@ size_t DiscReader::read(void *ptr, size_t size)
  */
 int DiscReader::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	assert(m_file != nullptr);
 	if (!m_file) {
 		m_lastError = EBADF;
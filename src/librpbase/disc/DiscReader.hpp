@@ -69,6 +69,16 @@ class DiscReader : public IDiscReader
 		 */
 		size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * This does not change the disc image position.
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) override;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos Disc image position.
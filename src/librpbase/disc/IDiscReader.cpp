@@ -53,6 +53,38 @@ bool IDiscReader::isOpen(void) const
 	}
 }
 
+/**
+ * Read data from the disc image at the specified position.
+ *
+ * The default implementation saves the disc image position,
+ * calls seek() and read(), and then restores the position.
+ * It is *not* thread-safe.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IDiscReader::pread(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+	if (prev_pos < 0) {
+		// tell() error.
+		return 0;
+	}
+
+	size_t ret = 0;
+	if (this->seek(pos) == 0) {
+		ret = this->read(ptr, size);
+	}
+
+	// Restore the disc image position.
+	const int lastError = m_lastError;
+	this->seek(prev_pos);
+	m_lastError = lastError;
+	return ret;
+}
+
 /**
  * Seek to the specified address, then read data.
  * @param pos	[in] Requested seek address.
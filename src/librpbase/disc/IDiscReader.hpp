@@ -76,6 +76,25 @@ class IDiscReader
 		 */
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 *
+		 * Unlike seekAndRead(), this does not change the disc image
+		 * position. Subclasses that override this function allow it
+		 * to be called from multiple threads at once, as long as the
+		 * underlying file or disc reader does too.
+		 *
+		 * The default implementation saves the disc image position,
+		 * calls seek() and read(), and then restores the position.
+		 * It is *not* thread-safe.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(off64_t pos, void *ptr, size_t size);
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
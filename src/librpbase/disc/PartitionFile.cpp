@@ -9,12 +9,16 @@
 #include "stdafx.h"
 #include "PartitionFile.hpp"
 #include "IDiscReader.hpp"
+#include "../file/IoStats.hpp"
 
 // C++ STL classes.
 using std::string;
 
 namespace LibRpBase {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("PartitionFile");
+
 /**
  * Open a file from an IPartition.
  * NOTE: These files are read-only.
@@ -62,39 +66,52 @@ void PartitionFile::close(void)
  */
 size_t PartitionFile::read(void *ptr, size_t size)
 {
+	size_t ret = this->pread(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * This does not change the file position.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t PartitionFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
 	if (!m_partition) {
 		m_lastError = EBADF;
 		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
 	}
 
 	// Check if size is in bounds.
-	if (m_pos > m_size - static_cast<off64_t>(size)) {
+	if (pos > m_size - static_cast<off64_t>(size)) {
 		// Not enough data.
 		// Copy whatever's left in the file.
-		size = static_cast<size_t>(m_size - m_pos);
-		if (size == 0) {
+		if (pos >= m_size) {
 			// Nothing left.
 			// TODO: Set an error?
 			return 0;
 		}
+		size = static_cast<size_t>(m_size - pos);
 	}
 
-	m_partition->clearError();
-	int iRet = m_partition->seek(m_offset + m_pos);
-	if (iRet != 0) {
-		m_lastError = m_partition->lastError();
+	if (size == 0) {
+		// Nothing to read.
 		return 0;
 	}
 
-	size_t ret = 0;
-	if (size > 0) {
-		m_partition->clearError();
-		ret = m_partition->read(ptr, size);
-		m_pos += ret;
+	size_t ret = m_partition->pread(m_offset + pos, ptr, size);
+	if (ret != size) {
 		m_lastError = m_partition->lastError();
 	}
-
-	return ret;
+	return ioScope.done(ret);
 }
 
 /**
@@ -120,6 +137,7 @@ size_t PartitionFile::write(const void *ptr, size_t size)
  */
 int PartitionFile::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	if (!m_partition) {
 		m_lastError = EBADF;
 		return -1;
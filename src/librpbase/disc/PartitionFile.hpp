@@ -54,6 +54,16 @@ class PartitionFile : public IRpFile
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * This does not change the file position.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * (NOTE: Not valid for PartitionFile; this will always return 0.)
@@ -15,16 +15,120 @@ namespace LibRpBase {
 
 /** SparseDiscReaderPrivate **/
 
-SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
+/**
+ * SparseDiscReaderPrivate constructor.
+ * @param q		[in] SparseDiscReader
+ * @param ioLayer	[in] I/O statistics layer for the subclass.
+ */
+SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q, IoStats::Layer &ioLayer)
 	: q_ptr(q)
+	, ioStatsLayer(ioLayer)
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, cacheLineCount(8)
+	, lruCounter(0)
 {
 	// NOTE: Can't check q->m_file here.
 
 	// disc_size, pos, and block_size must be
 	// set by the subclass.
+	memset(&cacheStats, 0, sizeof(cacheStats));
+}
+
+/**
+ * Read part of a block using the block cache.
+ * @param blockIdx	[in] Block index.
+ * @param ptr		[out] Output data buffer.
+ * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+ * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int SparseDiscReaderPrivate::readBlockCached(uint32_t blockIdx, void *ptr, int pos, size_t size)
+{
+	RP_Q(SparseDiscReader);
+
+	// Cache lines are CACHE_LINE_SIZE if the block size is a multiple
+	// of CACHE_LINE_SIZE; otherwise, cache lines are full blocks.
+	unsigned int lineSize = block_size;
+	if (block_size > CACHE_LINE_SIZE) {
+		if (block_size % CACHE_LINE_SIZE != 0) {
+			// Block size is too large to cache.
+			return q->readBlock(blockIdx, ptr, pos, size);
+		}
+		lineSize = CACHE_LINE_SIZE;
+	}
+	if (cacheLineCount == 0 || pos < 0) {
+		// Cache is disabled.
+		return q->readBlock(blockIdx, ptr, pos, size);
+	}
+
+	MutexLocker mutexLocker(cacheMutex);
+	if (cacheLines.empty()) {
+		cacheLines.resize(cacheLineCount);
+		for (auto iter = cacheLines.begin(); iter != cacheLines.end(); ++iter) {
+			iter->blockIdx = 0;
+			iter->lineIdx = ~0U;
+			iter->lastUse = 0;
+			iter->size = 0;
+		}
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	int ret = 0;
+	while (size > 0) {
+		const uint32_t lineIdx = static_cast<uint32_t>(pos) / lineSize;
+		const unsigned int lineOffset = static_cast<unsigned int>(pos) % lineSize;
+
+		// Find the cache line, or the least recently used line.
+		CacheLine *line = nullptr;
+		CacheLine *lruLine = &cacheLines[0];
+		for (auto iter = cacheLines.begin(); iter != cacheLines.end(); ++iter) {
+			if (iter->lineIdx == lineIdx && iter->blockIdx == blockIdx) {
+				line = &(*iter);
+				break;
+			}
+			if (iter->lastUse < lruLine->lastUse) {
+				lruLine = &(*iter);
+			}
+		}
+
+		if (line) {
+			cacheStats.hits++;
+		} else {
+			// Load the cache line.
+			cacheStats.misses++;
+			line = lruLine;
+			line->data.resize(lineSize);
+			const int rd = q->readBlock(blockIdx, line->data.data(), lineIdx * lineSize, lineSize);
+			if (rd <= 0) {
+				// Read error.
+				line->lineIdx = ~0U;
+				return (ret > 0 ? ret : rd);
+			}
+			line->blockIdx = blockIdx;
+			line->lineIdx = lineIdx;
+			line->size = static_cast<unsigned int>(rd);
+		}
+		line->lastUse = ++lruCounter;
+
+		if (lineOffset >= line->size) {
+			// Short cache line. (end of the image)
+			break;
+		}
+		size_t sz_copy = line->size - lineOffset;
+		if (sz_copy > size) {
+			sz_copy = size;
+		}
+		memcpy(ptr8, &line->data[lineOffset], sz_copy);
+
+		ptr8 += sz_copy;
+		pos += static_cast<int>(sz_copy);
+		size -= sz_copy;
+		ret += static_cast<int>(sz_copy);
+	}
+
+	return ret;
 }
 
 /** SparseDiscReader **/
@@ -50,34 +154,64 @@ SparseDiscReader::~SparseDiscReader()
 size_t SparseDiscReader::read(void *ptr, size_t size)
 {
 	RP_D(SparseDiscReader);
+	assert(d->pos >= 0);
+	if (d->pos < 0) {
+		// Disc image wasn't initialized properly.
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	size_t ret = this->pread(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the disc image at the specified position.
+ *
+ * This does not change the disc image position. It's
+ * thread-safe if the subclass's readBlock() is.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReader::pread(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(SparseDiscReader);
+	IoStats::ReadScope ioScope(d->ioStatsLayer);
 	assert(m_file != nullptr);
 	assert(d->disc_size > 0);
-	assert(d->pos >= 0);
 	assert(d->block_size != 0);
-	if (!m_file || d->disc_size <= 0 || d->pos < 0 || d->block_size == 0) {
+	if (!m_file || d->disc_size <= 0 || d->block_size == 0) {
 		// Disc image wasn't initialized properly.
 		m_lastError = EBADF;
-		return -1;
+		return 0;
+	} else if (pos < 0) {
+		// Negative is invalid.
+		m_lastError = EINVAL;
+		return 0;
 	}
 
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t ret = 0;
 
 	// Are we already at the end of the disc?
-	if (d->pos >= d->disc_size) {
+	if (pos >= d->disc_size) {
 		// End of the disc.
 		return 0;
 	}
 
-	// Make sure d->pos + size <= d->disc_size.
+	// Make sure pos + size <= d->disc_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos + static_cast<off64_t>(size) >= d->disc_size) {
-		size = static_cast<size_t>(d->disc_size - d->pos);
+	if (pos + static_cast<off64_t>(size) >= d->disc_size) {
+		size = static_cast<size_t>(d->disc_size - pos);
 	}
 
 	// Check if we're not starting on a block boundary.
 	const uint32_t block_size = d->block_size;
-	const uint32_t blockStartOffset = d->pos % block_size;
+	const uint32_t blockStartOffset = pos % block_size;
 	if (blockStartOffset != 0) {
 		// Not a block boundary.
 		// Read the end of the block.
@@ -86,53 +220,56 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 			read_sz = static_cast<uint32_t>(size);
 		}
 
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, blockStartOffset, read_sz);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, ptr8, blockStartOffset, read_sz);
 		if (rd < 0 || rd != static_cast<int>(read_sz)) {
 			// Error reading the data.
-			return (rd > 0 ? rd : 0);
+			return ioScope.done(rd > 0 ? rd : 0);
 		}
 
 		// Starting block read.
 		size -= read_sz;
 		ptr8 += read_sz;
 		ret += read_sz;
-		d->pos += read_sz;
+		pos += read_sz;
 	}
 
 	// Read entire blocks.
-	for (; size >= block_size;
-	    size -= block_size, ptr8 += block_size,
-	    ret += block_size, d->pos += block_size)
-	{
-		assert(d->pos % block_size == 0);
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, 0, block_size);
-		if (rd < 0 || rd != static_cast<int>(block_size)) {
+	if (size >= block_size) {
+		assert(pos % block_size == 0);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		const uint32_t blockCount = static_cast<uint32_t>(size / block_size);
+		const size_t blocks_sz = static_cast<size_t>(blockCount) * block_size;
+		const size_t rd = this->readBlocks(blockIdx, blockCount, ptr8);
+		if (rd != blocks_sz) {
 			// Error reading the data.
-			return ret + (rd > 0 ? rd : 0);
+			return ioScope.done(ret + rd);
 		}
+
+		size -= blocks_sz;
+		ptr8 += blocks_sz;
+		ret += blocks_sz;
+		pos += blocks_sz;
 	}
 
 	// Check if we still have data left. (not a full block)
 	if (size > 0) {
 		// Not a full block.
-		assert(d->pos % block_size == 0);
+		assert(pos % block_size == 0);
 
 		// Read the start of the block.
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, ptr8, 0, size);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, ptr8, 0, size);
 		if (rd < 0 || rd != static_cast<int>(size)) {
 			// Error reading the data.
-			return ret + (rd > 0 ? rd : 0);
+			return ioScope.done(ret + (rd > 0 ? rd : 0));
 		}
 
 		ret += size;
-		d->pos += size;
 	}
 
 	// Finished reading the data.
-	return ret;
+	return ioScope.done(ret);
 }
 
 /**
@@ -143,6 +280,7 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 int SparseDiscReader::seek(off64_t pos)
 {
 	RP_D(SparseDiscReader);
+	IoStats::seek(d->ioStatsLayer);
 	assert(m_file != nullptr);
 	assert(d->disc_size > 0);
 	assert(d->pos >= 0);
@@ -206,6 +344,33 @@ off64_t SparseDiscReader::size(void)
 	return d->disc_size;
 }
 
+/** Block cache. **/
+
+/**
+ * Get the block cache statistics.
+ * @param pStats	[out] Cache statistics.
+ */
+void SparseDiscReader::getCacheStats(CacheStats *pStats) const
+{
+	RP_D(const SparseDiscReader);
+	assert(pStats != nullptr);
+	if (!pStats)
+		return;
+
+	MutexLocker mutexLocker(d->cacheMutex);
+	*pStats = d->cacheStats;
+}
+
+/**
+ * Reset the block cache statistics.
+ */
+void SparseDiscReader::resetCacheStats(void)
+{
+	RP_D(SparseDiscReader);
+	MutexLocker mutexLocker(d->cacheMutex);
+	memset(&d->cacheStats, 0, sizeof(d->cacheStats));
+}
+
 /** SparseDiscReader **/
 
 /**
@@ -255,9 +420,78 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, void *ptr, int pos, size_t si
 	}
 
 	// Read from the block.
-	size_t sz_read = m_file->seekAndRead(physBlockAddr + pos, ptr, size);
+	size_t sz_read = m_file->pread(physBlockAddr + pos, ptr, size);
 	m_lastError = m_file->lastError();
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Runs of physically contiguous blocks are read using a
+ * single pread(), and runs of empty blocks are cleared
+ * using a single memset().
+ *
+ * Subclasses that override readBlock() instead of
+ * getPhysBlockAddr() must override this function, too.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReader::readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr)
+{
+	// NOTE: This can only be called by SparseDiscReader,
+	// so the main assertions are already checked there.
+	RP_D(SparseDiscReader);
+	const unsigned int block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+
+	off64_t physBlockAddr = getPhysBlockAddr(blockIdx);
+	while (blockCount > 0) {
+		assert(physBlockAddr >= 0);
+		if (physBlockAddr < 0) {
+			// Out of range.
+			break;
+		}
+
+		// Find the end of the run.
+		// Empty blocks are all 0; other blocks must be
+		// physically contiguous.
+		const off64_t runStart = physBlockAddr;
+		const off64_t stride = (runStart != 0 ? block_size : 0);
+		uint32_t runCount = 1;
+		for (; runCount < blockCount; runCount++) {
+			physBlockAddr = getPhysBlockAddr(blockIdx + runCount);
+			if (physBlockAddr != runStart + (stride * runCount)) {
+				// End of the run.
+				break;
+			}
+		}
+
+		const size_t run_sz = static_cast<size_t>(runCount) * block_size;
+		if (runStart == 0) {
+			// Empty blocks.
+			memset(ptr8, 0, run_sz);
+		} else {
+			// Read the blocks.
+			const size_t sz_read = m_file->pread(runStart, ptr8, run_sz);
+			if (sz_read != run_sz) {
+				// Short read.
+				m_lastError = m_file->lastError();
+				return ret + sz_read;
+			}
+		}
+
+		blockIdx += runCount;
+		blockCount -= runCount;
+		ptr8 += run_sz;
+		ret += run_sz;
+	}
+
+	return ret;
+}
+
 }
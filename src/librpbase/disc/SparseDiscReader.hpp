@@ -40,6 +40,19 @@ class SparseDiscReader : public IDiscReader
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 *
+		 * This does not change the disc image position. It's
+		 * thread-safe if the subclass's readBlock() is.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -59,6 +72,28 @@ class SparseDiscReader : public IDiscReader
 		 */
 		off64_t size(void) final;
 
+	public:
+		/** Block cache. **/
+
+		/**
+		 * Block cache statistics.
+		 */
+		struct CacheStats {
+			uint64_t hits;		// Cache lines found in the cache.
+			uint64_t misses;	// Cache lines that had to be read.
+		};
+
+		/**
+		 * Get the block cache statistics.
+		 * @param pStats	[out] Cache statistics.
+		 */
+		void getCacheStats(CacheStats *pStats) const;
+
+		/**
+		 * Reset the block cache statistics.
+		 */
+		void resetCacheStats(void);
+
 	protected:
 		/** Virtual functions for SparseDiscReader subclasses. **/
 
@@ -92,6 +127,23 @@ class SparseDiscReader : public IDiscReader
 		 * @return Number of bytes read, or -1 if the block index is invalid.
 		 */
 		virtual int readBlock(uint32_t blockIdx, void *ptr, int pos, size_t size);
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Runs of physically contiguous blocks are read using a
+		 * single pread(), and runs of empty blocks are cleared
+		 * using a single memset().
+		 *
+		 * Subclasses that override readBlock() instead of
+		 * getPhysBlockAddr() must override this function, too.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of bytes read.
+		 */
+		virtual size_t readBlocks(uint32_t blockIdx, uint32_t blockCount, void *ptr);
 };
 
 }
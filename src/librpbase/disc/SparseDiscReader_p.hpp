@@ -13,6 +13,14 @@
 
 #include <stdint.h>
 #include "../common.h"
+#include "../file/IoStats.hpp"
+#include "SparseDiscReader.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ includes.
+#include <vector>
 
 namespace LibRpBase {
 
@@ -22,7 +30,12 @@ class SparseDiscReader;
 class SparseDiscReaderPrivate
 {
 	protected:
-		SparseDiscReaderPrivate(SparseDiscReader *q);
+		/**
+		 * SparseDiscReaderPrivate constructor.
+		 * @param q		[in] SparseDiscReader
+		 * @param ioLayer	[in] I/O statistics layer for the subclass.
+		 */
+		SparseDiscReaderPrivate(SparseDiscReader *q, IoStats::Layer &ioLayer);
 	public:
 		virtual ~SparseDiscReaderPrivate() { };
 
@@ -31,11 +44,55 @@ class SparseDiscReaderPrivate
 	protected:
 		friend class SparseDiscReader;
 		SparseDiscReader *const q_ptr;
+		// I/O statistics layer.
+		// NOTE: Not named "ioLayer", since that would hide the
+		// subclasses' static ioLayer objects when they're used
+		// in the subclass constructors' mem-initializers.
+		IoStats::Layer &ioStatsLayer;
 
 	public:
 		off64_t disc_size;		// Virtual disc image size.
 		off64_t pos;			// Read position.
 		unsigned int block_size;	// Block size.
+
+	public:
+		/** Block cache. **/
+
+		// Partial-block reads are done in cache lines of up to
+		// CACHE_LINE_SIZE bytes, which are kept in an LRU cache.
+		// Full-block reads bypass the cache.
+		static const unsigned int CACHE_LINE_SIZE = 32768;
+
+		// Number of cache lines. (0 to disable the cache)
+		// May be changed by the subclass constructor.
+		unsigned int cacheLineCount;
+
+		// Cache line.
+		struct CacheLine {
+			uint32_t blockIdx;	// Block index.
+			uint32_t lineIdx;	// Line index within the block. (~0 if unused)
+			uint64_t lastUse;	// LRU counter value at last use.
+			unsigned int size;	// Valid data size. (< line size at the end of the image)
+			std::vector<uint8_t> data;
+		};
+		std::vector<CacheLine> cacheLines;
+		uint64_t lruCounter;
+
+		// Cache statistics.
+		SparseDiscReader::CacheStats cacheStats;
+
+		// Locked while accessing the cache.
+		mutable Mutex cacheMutex;
+
+		/**
+		 * Read part of a block using the block cache.
+		 * @param blockIdx	[in] Block index.
+		 * @param ptr		[out] Output data buffer.
+		 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+		 * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+		 * @return Number of bytes read, or -1 if the block index is invalid.
+		 */
+		int readBlockCached(uint32_t blockIdx, void *ptr, int pos, size_t size);
 };
 
 }
@@ -0,0 +1,618 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AsyncReader.cpp: Asynchronous batch reader.                             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+#include "AsyncReader.hpp"
+
+#include "RpFile.hpp"
+#include "RpFile_p.hpp"
+
+#ifdef HAVE_LINUX_IO_URING_H
+// io_uring (raw syscalls; liburing isn't needed)
+# include <linux/io_uring.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif /* HAVE_LINUX_IO_URING_H */
+
+// C++ includes.
+#include <deque>
+using std::deque;
+
+// C++ STL classes.
+using std::vector;
+
+namespace LibRpBase {
+
+/** AsyncReaderPrivate **/
+
+class AsyncReaderPrivate
+{
+	public:
+		AsyncReaderPrivate(unsigned int queueDepth, bool useIoUring);
+		~AsyncReaderPrivate();
+
+	private:
+		RP_DISABLE_COPY(AsyncReaderPrivate)
+
+	public:
+		// Read request.
+		struct Request {
+			IRpFile *file;		// File. (ref()'d; nullptr if the slot is free)
+			int fd;			// Native file descriptor, or -1 for synchronous reads.
+			off64_t pos;		// File position.
+			uint8_t *buf;		// Output buffer.
+			size_t size;		// Requested size.
+			size_t done;		// Bytes read so far.
+			int err;		// POSIX error code.
+			AsyncReader::pfnReadCallback_t callback;
+			void *userdata;
+#ifdef HAVE_LINUX_IO_URING_H
+			struct iovec iov;	// Must remain valid until the read completes.
+#endif /* HAVE_LINUX_IO_URING_H */
+		};
+
+		unsigned int queueDepth;
+		vector<Request> requests;	// Fixed size; indexed by slot number.
+		vector<unsigned int> freeSlots;
+		deque<unsigned int> completed;	// Slots that are ready for their callbacks.
+
+		/**
+		 * Get the native file descriptor for a file, if it can be read using io_uring.
+		 * @param file File.
+		 * @return File descriptor, or -1 if reads must be synchronous.
+		 */
+		int getNativeFd(IRpFile *file) const;
+
+		/**
+		 * Deliver a completed request to its callback.
+		 * The slot is freed before the callback is called.
+		 * @param slot Slot number.
+		 */
+		void deliver(unsigned int slot);
+
+#ifdef HAVE_LINUX_IO_URING_H
+	public:
+		/** io_uring **/
+		int ring_fd;			// io_uring file descriptor, or -1 if not in use.
+		unsigned int inKernel;		// Requests queued in the SQ ring or being processed.
+		unsigned int toSubmit;		// SQEs not yet passed to io_uring_enter().
+
+		// Ring mappings.
+		void *sq_ptr;
+		size_t sq_ring_sz;
+		void *cq_ptr;
+		size_t cq_ring_sz;
+		struct io_uring_sqe *sqes;
+		size_t sqes_sz;
+
+		// SQ ring fields.
+		unsigned int *sq_tail;
+		unsigned int sq_mask;
+		unsigned int *sq_array;
+
+		// CQ ring fields.
+		unsigned int *cq_head;
+		unsigned int *cq_tail;
+		unsigned int cq_mask;
+		struct io_uring_cqe *cqes;
+
+		/**
+		 * Initialize io_uring.
+		 * @param entries Number of SQ entries.
+		 * @return True on success; false on error.
+		 */
+		bool initIoUring(unsigned int entries);
+
+		/**
+		 * Shut down io_uring.
+		 */
+		void closeIoUring(void);
+
+		/**
+		 * Queue an SQE for the remaining part of a request.
+		 * @param slot Slot number.
+		 */
+		void queueRead(unsigned int slot);
+
+		/**
+		 * Submit queued SQEs and optionally wait for completions.
+		 * @param minComplete Minimum number of CQEs to wait for.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int enter(unsigned int minComplete);
+
+		/**
+		 * Move completed requests from the CQ ring to the completed list.
+		 * Short reads are resubmitted.
+		 */
+		void reap(void);
+#endif /* HAVE_LINUX_IO_URING_H */
+};
+
+AsyncReaderPrivate::AsyncReaderPrivate(unsigned int queueDepth, bool useIoUring)
+	: queueDepth(queueDepth > 0 ? queueDepth : 1)
+#ifdef HAVE_LINUX_IO_URING_H
+	, ring_fd(-1)
+	, inKernel(0)
+	, toSubmit(0)
+	, sq_ptr(MAP_FAILED)
+	, sq_ring_sz(0)
+	, cq_ptr(MAP_FAILED)
+	, cq_ring_sz(0)
+	, sqes(static_cast<struct io_uring_sqe*>(MAP_FAILED))
+	, sqes_sz(0)
+	, sq_tail(nullptr)
+	, sq_mask(0)
+	, sq_array(nullptr)
+	, cq_head(nullptr)
+	, cq_tail(nullptr)
+	, cq_mask(0)
+	, cqes(nullptr)
+#endif /* HAVE_LINUX_IO_URING_H */
+{
+	requests.resize(this->queueDepth);
+	freeSlots.reserve(this->queueDepth);
+	for (unsigned int i = this->queueDepth; i > 0; i--) {
+		requests[i-1].file = nullptr;
+		freeSlots.push_back(i-1);
+	}
+
+#ifdef HAVE_LINUX_IO_URING_H
+	if (useIoUring) {
+		if (!initIoUring(this->queueDepth)) {
+			// io_uring isn't available.
+			// Reads will be synchronous.
+			closeIoUring();
+		}
+	}
+#else /* !HAVE_LINUX_IO_URING_H */
+	RP_UNUSED(useIoUring);
+#endif /* HAVE_LINUX_IO_URING_H */
+}
+
+AsyncReaderPrivate::~AsyncReaderPrivate()
+{
+#ifdef HAVE_LINUX_IO_URING_H
+	// The kernel may still be writing to request buffers,
+	// so wait for all outstanding reads before unmapping.
+	while (inKernel > 0) {
+		if (enter(1) != 0)
+			break;
+		reap();
+	}
+	closeIoUring();
+#endif /* HAVE_LINUX_IO_URING_H */
+
+	// Release any undelivered requests.
+	for (auto iter = requests.begin(); iter != requests.end(); ++iter) {
+		if (iter->file) {
+			iter->file->unref();
+		}
+	}
+}
+
+/**
+ * Get the native file descriptor for a file, if it can be read using io_uring.
+ * @param file File.
+ * @return File descriptor, or -1 if reads must be synchronous.
+ */
+int AsyncReaderPrivate::getNativeFd(IRpFile *file) const
+{
+#ifdef HAVE_LINUX_IO_URING_H
+	if (ring_fd < 0)
+		return -1;
+
+	// Only plain RpFile objects can be read directly.
+	// gzip-compressed files are decompressed by GzIndexReader,
+	// and device files require sector-aligned reads.
+	RpFile *const rpFile = dynamic_cast<RpFile*>(file);
+	if (!rpFile)
+		return -1;
+	const RpFilePrivate *const fd = rpFile->d_ptr;
+	if (!fd->file || fd->gzReader || fd->devInfo)
+		return -1;
+	return fileno(fd->file);
+#else /* !HAVE_LINUX_IO_URING_H */
+	RP_UNUSED(file);
+	return -1;
+#endif /* HAVE_LINUX_IO_URING_H */
+}
+
+/**
+ * Deliver a completed request to its callback.
+ * The slot is freed before the callback is called.
+ * @param slot Slot number.
+ */
+void AsyncReaderPrivate::deliver(unsigned int slot)
+{
+	Request &req = requests[slot];
+	IRpFile *const file = req.file;
+	const AsyncReader::pfnReadCallback_t callback = req.callback;
+	void *const userdata = req.userdata;
+	const size_t done = req.done;
+	const int err = req.err;
+
+	// Free the slot first so the callback can submit another read.
+	req.file = nullptr;
+	freeSlots.push_back(slot);
+
+	callback(userdata, done, err);
+	file->unref();
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * Initialize io_uring.
+ * @param entries Number of SQ entries.
+ * @return True on success; false on error.
+ */
+bool AsyncReaderPrivate::initIoUring(unsigned int entries)
+{
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+	if (ring_fd < 0) {
+		// Not supported by this kernel, or blocked by seccomp.
+		ring_fd = -1;
+		return false;
+	}
+	if (p.sq_entries < entries) {
+		// Shouldn't happen...
+		return false;
+	}
+
+	sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	const bool singleMmap = !!(p.features & IORING_FEAT_SINGLE_MMAP);
+	if (singleMmap) {
+		// The SQ and CQ rings share a single mapping.
+		if (cq_ring_sz > sq_ring_sz) {
+			sq_ring_sz = cq_ring_sz;
+		}
+		cq_ring_sz = sq_ring_sz;
+	}
+
+	sq_ptr = mmap(nullptr, sq_ring_sz, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (sq_ptr == MAP_FAILED)
+		return false;
+	if (singleMmap) {
+		cq_ptr = sq_ptr;
+	} else {
+		cq_ptr = mmap(nullptr, cq_ring_sz, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED)
+			return false;
+	}
+
+	sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+	sqes = static_cast<struct io_uring_sqe*>(mmap(nullptr, sqes_sz,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+	if (sqes == MAP_FAILED)
+		return false;
+
+	uint8_t *const sq8 = static_cast<uint8_t*>(sq_ptr);
+	sq_tail = reinterpret_cast<unsigned int*>(sq8 + p.sq_off.tail);
+	sq_mask = *reinterpret_cast<unsigned int*>(sq8 + p.sq_off.ring_mask);
+	sq_array = reinterpret_cast<unsigned int*>(sq8 + p.sq_off.array);
+
+	uint8_t *const cq8 = static_cast<uint8_t*>(cq_ptr);
+	cq_head = reinterpret_cast<unsigned int*>(cq8 + p.cq_off.head);
+	cq_tail = reinterpret_cast<unsigned int*>(cq8 + p.cq_off.tail);
+	cq_mask = *reinterpret_cast<unsigned int*>(cq8 + p.cq_off.ring_mask);
+	cqes = reinterpret_cast<struct io_uring_cqe*>(cq8 + p.cq_off.cqes);
+	return true;
+}
+
+/**
+ * Shut down io_uring.
+ */
+void AsyncReaderPrivate::closeIoUring(void)
+{
+	if (sqes != MAP_FAILED) {
+		munmap(sqes, sqes_sz);
+		sqes = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+	}
+	if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+		munmap(cq_ptr, cq_ring_sz);
+	}
+	cq_ptr = MAP_FAILED;
+	if (sq_ptr != MAP_FAILED) {
+		munmap(sq_ptr, sq_ring_sz);
+		sq_ptr = MAP_FAILED;
+	}
+	if (ring_fd >= 0) {
+		::close(ring_fd);
+		ring_fd = -1;
+	}
+}
+
+/**
+ * Queue an SQE for the remaining part of a request.
+ * @param slot Slot number.
+ */
+void AsyncReaderPrivate::queueRead(unsigned int slot)
+{
+	Request &req = requests[slot];
+	req.iov.iov_base = req.buf + req.done;
+	req.iov.iov_len = req.size - req.done;
+
+	// We're the only producer, so the tail can be read directly.
+	const unsigned int tail = *sq_tail;
+	const unsigned int index = tail & sq_mask;
+	struct io_uring_sqe *const sqe = &sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	// NOTE: IORING_OP_READV is used instead of IORING_OP_READ
+	// for compatibility with Linux 5.1-5.5.
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = req.fd;
+	sqe->off = static_cast<uint64_t>(req.pos + req.done);
+	sqe->addr = reinterpret_cast<uintptr_t>(&req.iov);
+	sqe->len = 1;
+	sqe->user_data = slot;
+	sq_array[index] = index;
+
+	// Make the SQE visible to the kernel.
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+	toSubmit++;
+}
+
+/**
+ * Submit queued SQEs and optionally wait for completions.
+ * @param minComplete Minimum number of CQEs to wait for.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AsyncReaderPrivate::enter(unsigned int minComplete)
+{
+	while (toSubmit > 0 || minComplete > 0) {
+		const unsigned int flags = (minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+		const int ret = static_cast<int>(syscall(__NR_io_uring_enter,
+			ring_fd, toSubmit, minComplete, flags, nullptr, 0));
+		if (ret < 0) {
+			const int err = errno;
+			if (err == EINTR)
+				continue;
+			return -(err != 0 ? err : EIO);
+		}
+
+		// If the wait was satisfied, any remaining
+		// SQEs will be submitted on the next call.
+		toSubmit -= static_cast<unsigned int>(ret);
+		break;
+	}
+	return 0;
+}
+
+/**
+ * Move completed requests from the CQ ring to the completed list.
+ * Short reads are resubmitted.
+ */
+void AsyncReaderPrivate::reap(void)
+{
+	unsigned int head = *cq_head;
+	const unsigned int tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+	for (; head != tail; head++) {
+		const struct io_uring_cqe *const cqe = &cqes[head & cq_mask];
+		const unsigned int slot = static_cast<unsigned int>(cqe->user_data);
+		const int res = cqe->res;
+		Request &req = requests[slot];
+		assert(req.file != nullptr);
+
+		if (res < 0) {
+			if (res == -EINTR || res == -EAGAIN) {
+				// Try again.
+				queueRead(slot);
+				continue;
+			}
+			req.err = -res;
+		} else if (res > 0) {
+			req.done += static_cast<size_t>(res);
+			if (req.done < req.size) {
+				// Short read. Read the rest.
+				// EOF will be indicated by a 0-byte read.
+				queueRead(slot);
+				continue;
+			}
+		}
+
+		// Request is finished.
+		inKernel--;
+		completed.push_back(slot);
+	}
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+#endif /* HAVE_LINUX_IO_URING_H */
+
+/** AsyncReader **/
+
+/**
+ * Create an asynchronous batch reader.
+ *
+ * On Linux, io_uring is used to keep multiple reads in
+ * flight, possibly across many files. If io_uring isn't
+ * available, or if a file can't be read using io_uring
+ * (e.g. gzip-compressed files, device files, or files
+ * that aren't RpFile), the file's pread() function is
+ * used instead, and the read completes immediately.
+ *
+ * NOTE: AsyncReader is not thread-safe. Each thread
+ * should use its own AsyncReader object.
+ *
+ * @param queueDepth	[in,opt] Maximum number of reads in flight.
+ * @param useIoUring	[in,opt] If false, don't use io_uring, even if it's available.
+ */
+AsyncReader::AsyncReader(unsigned int queueDepth, bool useIoUring)
+	: d_ptr(new AsyncReaderPrivate(queueDepth, useIoUring))
+{ }
+
+AsyncReader::~AsyncReader()
+{
+	delete d_ptr;
+}
+
+/**
+ * Are reads actually asynchronous?
+ * If false, all reads are done synchronously in submit().
+ * @return True if io_uring is in use; false if not.
+ */
+bool AsyncReader::isAsync(void) const
+{
+#ifdef HAVE_LINUX_IO_URING_H
+	RP_D(const AsyncReader);
+	return (d->ring_fd >= 0);
+#else /* !HAVE_LINUX_IO_URING_H */
+	return false;
+#endif /* HAVE_LINUX_IO_URING_H */
+}
+
+/**
+ * Get the maximum number of reads in flight.
+ * @return Queue depth.
+ */
+unsigned int AsyncReader::queueDepth(void) const
+{
+	RP_D(const AsyncReader);
+	return d->queueDepth;
+}
+
+/**
+ * Get the number of reads that haven't been delivered to their callbacks yet.
+ * @return Number of pending reads.
+ */
+unsigned int AsyncReader::pending(void) const
+{
+	RP_D(const AsyncReader);
+	return d->queueDepth - static_cast<unsigned int>(d->freeSlots.size());
+}
+
+/**
+ * Submit a read.
+ *
+ * The file is ref()'d until the callback is called, and
+ * the buffer must remain valid until the callback is called.
+ * Callbacks are only called from wait(), never from submit().
+ * Callbacks may submit additional reads.
+ *
+ * @param file		[in] File to read from.
+ * @param pos		[in] File position.
+ * @param buf		[out] Output data buffer.
+ * @param size		[in] Amount of data to read, in bytes.
+ * @param callback	[in] Completion callback.
+ * @param userdata	[in] User data for the callback.
+ * @return 0 on success; -EAGAIN if pending() == queueDepth(); other negative POSIX error code on error.
+ */
+int AsyncReader::submit(IRpFile *file, off64_t pos, void *buf, size_t size,
+	pfnReadCallback_t callback, void *userdata)
+{
+	assert(file != nullptr);
+	assert(callback != nullptr);
+	if (!file || !callback || pos < 0) {
+		return -EINVAL;
+	}
+
+	RP_D(AsyncReader);
+	if (d->freeSlots.empty()) {
+		// Queue is full.
+		return -EAGAIN;
+	}
+	const unsigned int slot = d->freeSlots.back();
+	d->freeSlots.pop_back();
+
+	AsyncReaderPrivate::Request &req = d->requests[slot];
+	req.file = file->ref();
+	req.fd = d->getNativeFd(file);
+	req.pos = pos;
+	req.buf = static_cast<uint8_t*>(buf);
+	req.size = size;
+	req.done = 0;
+	req.err = 0;
+	req.callback = callback;
+	req.userdata = userdata;
+
+#ifdef HAVE_LINUX_IO_URING_H
+	if (req.fd >= 0 && size > 0) {
+		// Queue the read. It will be sent to the
+		// kernel along with other reads in wait().
+		d->queueRead(slot);
+		d->inKernel++;
+		return 0;
+	}
+#endif /* HAVE_LINUX_IO_URING_H */
+
+	// Synchronous read.
+	req.done = file->pread(pos, buf, size);
+	if (req.done == 0 && size > 0) {
+		req.err = file->lastError();
+	}
+	d->completed.push_back(slot);
+	return 0;
+}
+
+/**
+ * Wait for reads to complete, and call their callbacks.
+ * Submitted reads are sent to the kernel here if they
+ * haven't been sent already.
+ * @param minComplete [in] Minimum number of callbacks to call. (clamped to pending())
+ * @return Number of callbacks called, or negative POSIX error code on error.
+ */
+int AsyncReader::wait(unsigned int minComplete)
+{
+	RP_D(AsyncReader);
+	int count = 0;
+
+	do {
+#ifdef HAVE_LINUX_IO_URING_H
+		if (d->ring_fd >= 0) {
+			// Only block if we don't have enough completions yet.
+			unsigned int waitFor = 0;
+			const unsigned int have = static_cast<unsigned int>(count + d->completed.size());
+			if (have < minComplete && d->inKernel > 0) {
+				waitFor = 1;
+			}
+			if (d->toSubmit > 0 || waitFor > 0) {
+				const int ret = d->enter(waitFor);
+				if (ret != 0)
+					return ret;
+			}
+			d->reap();
+		}
+#endif /* HAVE_LINUX_IO_URING_H */
+
+		// Deliver completed reads.
+		// NOTE: Callbacks may submit more reads, which may
+		// be completed synchronously and appended here.
+		while (!d->completed.empty()) {
+			const unsigned int slot = d->completed.front();
+			d->completed.pop_front();
+			d->deliver(slot);
+			count++;
+		}
+	} while (static_cast<unsigned int>(count) < minComplete && pending() > 0);
+
+	return count;
+}
+
+/**
+ * Wait for all reads to complete, including reads
+ * that were submitted by callbacks.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AsyncReader::waitAll(void)
+{
+	while (pending() > 0) {
+		const int ret = wait(pending());
+		if (ret < 0)
+			return ret;
+	}
+	return 0;
+}
+
+}
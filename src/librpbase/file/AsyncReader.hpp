@@ -0,0 +1,120 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AsyncReader.hpp: Asynchronous batch reader.                             *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_FILE_ASYNCREADER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_FILE_ASYNCREADER_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase {
+
+class IRpFile;
+
+class AsyncReaderPrivate;
+class AsyncReader
+{
+	public:
+		// Default queue depth.
+		static const unsigned int DEFAULT_QUEUE_DEPTH = 256;
+
+		/**
+		 * Create an asynchronous batch reader.
+		 *
+		 * On Linux, io_uring is used to keep multiple reads in
+		 * flight, possibly across many files. If io_uring isn't
+		 * available, or if a file can't be read using io_uring
+		 * (e.g. gzip-compressed files, device files, or files
+		 * that aren't RpFile), the file's pread() function is
+		 * used instead, and the read completes immediately.
+		 *
+		 * NOTE: AsyncReader is not thread-safe. Each thread
+		 * should use its own AsyncReader object.
+		 *
+		 * @param queueDepth	[in,opt] Maximum number of reads in flight.
+		 * @param useIoUring	[in,opt] If false, don't use io_uring, even if it's available.
+		 */
+		explicit AsyncReader(unsigned int queueDepth = DEFAULT_QUEUE_DEPTH, bool useIoUring = true);
+		~AsyncReader();
+
+	private:
+		RP_DISABLE_COPY(AsyncReader)
+	private:
+		friend class AsyncReaderPrivate;
+		AsyncReaderPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Are reads actually asynchronous?
+		 * If false, all reads are done synchronously in submit().
+		 * @return True if io_uring is in use; false if not.
+		 */
+		bool isAsync(void) const;
+
+		/**
+		 * Get the maximum number of reads in flight.
+		 * @return Queue depth.
+		 */
+		unsigned int queueDepth(void) const;
+
+		/**
+		 * Get the number of reads that haven't been delivered to their callbacks yet.
+		 * @return Number of pending reads.
+		 */
+		unsigned int pending(void) const;
+
+		/**
+		 * Read completion callback.
+		 * @param userdata	[in] User data specified in submit().
+		 * @param size		[in] Number of bytes read.
+		 * @param err		[in] POSIX error code, or 0 on success.
+		 */
+		typedef void (*pfnReadCallback_t)(void *userdata, size_t size, int err);
+
+		/**
+		 * Submit a read.
+		 *
+		 * The file is ref()'d until the callback is called, and
+		 * the buffer must remain valid until the callback is called.
+		 * Callbacks are only called from wait(), never from submit().
+		 * Callbacks may submit additional reads.
+		 *
+		 * @param file		[in] File to read from.
+		 * @param pos		[in] File position.
+		 * @param buf		[out] Output data buffer.
+		 * @param size		[in] Amount of data to read, in bytes.
+		 * @param callback	[in] Completion callback.
+		 * @param userdata	[in] User data for the callback.
+		 * @return 0 on success; -EAGAIN if pending() == queueDepth(); other negative POSIX error code on error.
+		 */
+		int submit(IRpFile *file, off64_t pos, void *buf, size_t size,
+			pfnReadCallback_t callback, void *userdata);
+
+		/**
+		 * Wait for reads to complete, and call their callbacks.
+		 * Submitted reads are sent to the kernel here if they
+		 * haven't been sent already.
+		 * @param minComplete [in] Minimum number of callbacks to call. (clamped to pending())
+		 * @return Number of callbacks called, or negative POSIX error code on error.
+		 */
+		int wait(unsigned int minComplete = 1);
+
+		/**
+		 * Wait for all reads to complete, including reads
+		 * that were submitted by callbacks.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int waitAll(void);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_FILE_ASYNCREADER_HPP__ */
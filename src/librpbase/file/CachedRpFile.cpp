@@ -0,0 +1,690 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * CachedRpFile.cpp: IRpFile wrapper with a read-ahead block cache.        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CachedRpFile.hpp"
+#include "IoStats.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRpBase {
+
+// I/O statistics.
+static IoStats::Layer ioLayer("CachedRpFile");
+
+/** CachedRpFilePrivate **/
+
+class CachedRpFilePrivate
+{
+	public:
+		CachedRpFilePrivate(IRpFile *file, unsigned int blockSize, unsigned int blockCount);
+		~CachedRpFilePrivate();
+
+	private:
+		RP_DISABLE_COPY(CachedRpFilePrivate)
+
+	public:
+		// Underlying file.
+		// NOTE: The file size isn't cached, since it may change
+		// for transparently-decompressed files once the exact
+		// uncompressed size is known. Reads are clamped by the
+		// underlying file instead.
+		IRpFile *file;
+		off64_t pos;		// Current position.
+
+		unsigned int blockSize;		// Block size. (power of two)
+		unsigned int blockCount;	// Maximum number of cached blocks.
+		unsigned int maxReadAhead;	// Maximum read-ahead, in blocks.
+		size_t bypassSize;		// Reads this large bypass the cache.
+
+		// Cached block.
+		struct Block {
+			uint64_t blockIdx;	// Block index. (~0 if unused)
+			uint64_t lastUse;	// LRU counter value at last use.
+			size_t size;		// Valid data size. (< blockSize for the last block)
+			ao::uvector<uint8_t> data;
+		};
+		vector<Block> blocks;
+		uint64_t lruCounter;
+
+		// Sequential access detection.
+		uint64_t nextSeqBlock;		// Block following the last block that was read.
+		unsigned int readAhead;		// Current read-ahead window, in blocks.
+		IRpFile::AccessHint accessHint;	// Access pattern hint from setAccessHint().
+
+		// Temporary buffer for multi-block reads.
+		ao::uvector<uint8_t> raBuf;
+
+		// Cache statistics.
+		CachedRpFile::Stats stats;
+
+		// Locked while accessing the cache.
+		mutable Mutex mutex;
+
+	public:
+		/**
+		 * Set the maximum number of cached blocks.
+		 * This also updates the read-ahead and bypass limits.
+		 * @param blockCount Maximum number of cached blocks.
+		 */
+		void setBlockCount(unsigned int blockCount);
+
+		/**
+		 * Find a cached block.
+		 * @param blockIdx Block index.
+		 * @return Block, or nullptr if it isn't cached.
+		 */
+		Block *findBlock(uint64_t blockIdx);
+
+		/**
+		 * Get a block slot to load data into.
+		 * An unused slot is returned if available;
+		 * otherwise, the least recently used block is evicted.
+		 * @return Block slot.
+		 */
+		Block *getFreeBlock(void);
+
+		/**
+		 * Load a block into the cache, reading ahead if the
+		 * access pattern is sequential.
+		 * Mutex must be locked by the caller.
+		 * @param blockIdx Block index.
+		 * @return Block, or nullptr on error.
+		 */
+		Block *loadBlock(uint64_t blockIdx);
+};
+
+CachedRpFilePrivate::CachedRpFilePrivate(IRpFile *file, unsigned int blockSize, unsigned int blockCount)
+	: file(file ? file->ref() : nullptr)
+	, pos(0)
+	, blockSize(blockSize)
+	, blockCount(0)
+	, maxReadAhead(0)
+	, bypassSize(0)
+	, lruCounter(0)
+	, nextSeqBlock(~0ULL)
+	, readAhead(1)
+	, accessHint(IRpFile::AH_NORMAL)
+{
+	// Block size must be a power of two.
+	assert(blockSize != 0 && (blockSize & (blockSize - 1)) == 0);
+	assert(blockCount != 0);
+	if (this->blockSize == 0 || (this->blockSize & (this->blockSize - 1)) != 0) {
+		this->blockSize = CachedRpFile::DEFAULT_BLOCK_SIZE;
+	}
+	setBlockCount(blockCount);
+
+	memset(&stats, 0, sizeof(stats));
+}
+
+CachedRpFilePrivate::~CachedRpFilePrivate()
+{
+	if (file) {
+		file->unref();
+	}
+}
+
+/**
+ * Set the maximum number of cached blocks.
+ * This also updates the read-ahead and bypass limits.
+ * @param blockCount Maximum number of cached blocks.
+ */
+void CachedRpFilePrivate::setBlockCount(unsigned int blockCount)
+{
+	this->blockCount = (blockCount != 0 ? blockCount : 1);
+	maxReadAhead = this->blockCount / 4;
+	if (maxReadAhead == 0) {
+		maxReadAhead = 1;
+	}
+	if (readAhead > maxReadAhead) {
+		readAhead = maxReadAhead;
+	}
+	bypassSize = static_cast<size_t>(blockSize) *
+		(this->blockCount > 1 ? this->blockCount / 2 : 1);
+}
+
+/**
+ * Find a cached block.
+ * @param blockIdx Block index.
+ * @return Block, or nullptr if it isn't cached.
+ */
+CachedRpFilePrivate::Block *CachedRpFilePrivate::findBlock(uint64_t blockIdx)
+{
+	// NOTE: The block count is small, so a linear search is fine.
+	for (auto iter = blocks.begin(); iter != blocks.end(); ++iter) {
+		if (iter->blockIdx == blockIdx) {
+			iter->lastUse = ++lruCounter;
+			return &(*iter);
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Get a block slot to load data into.
+ * An unused slot is returned if available;
+ * otherwise, the least recently used block is evicted.
+ * @return Block slot.
+ */
+CachedRpFilePrivate::Block *CachedRpFilePrivate::getFreeBlock(void)
+{
+	if (blocks.size() < blockCount) {
+		// Allocate a new block.
+		// NOTE: blocks is reserved in the constructor,
+		// so this won't invalidate other Block pointers.
+		blocks.resize(blocks.size() + 1);
+		Block *const block = &blocks.back();
+		block->data.resize(blockSize);
+		block->blockIdx = ~0ULL;
+		return block;
+	}
+
+	// Evict the least recently used block.
+	Block *lru = &blocks[0];
+	for (auto iter = blocks.begin() + 1; iter != blocks.end(); ++iter) {
+		if (iter->lastUse < lru->lastUse) {
+			lru = &(*iter);
+		}
+	}
+	lru->blockIdx = ~0ULL;
+	return lru;
+}
+
+/**
+ * Load a block into the cache, reading ahead if the
+ * access pattern is sequential.
+ * Mutex must be locked by the caller.
+ * @param blockIdx Block index.
+ * @return Block, or nullptr on error.
+ */
+CachedRpFilePrivate::Block *CachedRpFilePrivate::loadBlock(uint64_t blockIdx)
+{
+	// Adjust the read-ahead window.
+	if (accessHint == IRpFile::AH_SEQUENTIAL) {
+		// Caller says it's sequential, so don't wait
+		// for the window to grow.
+		readAhead = maxReadAhead;
+	} else if (accessHint == IRpFile::AH_RANDOM) {
+		// Caller says it's random. Adjacent blocks
+		// are probably a coincidence.
+		readAhead = 1;
+	} else if (blockIdx == nextSeqBlock) {
+		// Sequential access. Double the window.
+		readAhead *= 2;
+		if (readAhead > maxReadAhead) {
+			readAhead = maxReadAhead;
+		}
+	} else {
+		// Random access. Read a single block.
+		readAhead = 1;
+	}
+
+	// Determine how many blocks to read.
+	// Stop at the first block that's already cached.
+	// NOTE: The end of the file is handled by short reads.
+	unsigned int count = 1;
+	while (count < readAhead) {
+		bool isCached = false;
+		for (auto iter = blocks.cbegin(); iter != blocks.cend(); ++iter) {
+			if (iter->blockIdx == blockIdx + count) {
+				isCached = true;
+				break;
+			}
+		}
+		if (isCached)
+			break;
+		count++;
+	}
+
+	// Read the blocks in a single read.
+	const off64_t blockAddr = static_cast<off64_t>(blockIdx) * blockSize;
+	const size_t sz_req = static_cast<size_t>(count) * blockSize;
+	if (raBuf.size() < sz_req) {
+		raBuf.resize(sz_req);
+	}
+	const size_t sz_read = file->pread(blockAddr, raBuf.data(), sz_req);
+	stats.reads++;
+	stats.bytesRead += sz_read;
+	if (sz_read == 0) {
+		// Read error or end of file.
+		nextSeqBlock = ~0ULL;
+		return nullptr;
+	}
+
+	// Copy the data into the cache.
+	// NOTE: The first block won't be evicted by the read-ahead
+	// blocks, since it's the most recently used block, and
+	// count <= maxReadAhead <= blockCount / 4.
+	Block *first = nullptr;
+	const uint8_t *src = raBuf.data();
+	size_t sz_left = sz_read;
+	for (unsigned int i = 0; i < count && sz_left > 0; i++) {
+		Block *const block = getFreeBlock();
+		block->blockIdx = blockIdx + i;
+		block->lastUse = ++lruCounter;
+		block->size = (sz_left < blockSize ? sz_left : blockSize);
+		memcpy(block->data.data(), src, block->size);
+		src += block->size;
+		sz_left -= block->size;
+		if (i == 0) {
+			first = block;
+		} else {
+			stats.readahead++;
+		}
+	}
+
+	nextSeqBlock = blockIdx + count;
+	return first;
+}
+
+/** CachedRpFile **/
+
+/**
+ * Wrap an IRpFile with a read-only block cache.
+ *
+ * Reads are done in aligned blocks, and the most recently
+ * used blocks are kept in memory. Sequential access is
+ * detected, and additional blocks are read ahead in a
+ * single read from the underlying file.
+ *
+ * The file is ref()'d, so the original file can be
+ * unref()'d by the caller afterwards.
+ *
+ * @param file		[in] Underlying file.
+ * @param blockSize	[in,opt] Block size. (must be a power of two)
+ * @param blockCount	[in,opt] Maximum number of cached blocks.
+ */
+CachedRpFile::CachedRpFile(IRpFile *file, unsigned int blockSize, unsigned int blockCount)
+	: super()
+	, d_ptr(new CachedRpFilePrivate(file, blockSize, blockCount))
+{
+	RP_D(CachedRpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return;
+	}
+
+	// Reserve space for all blocks so Block pointers
+	// remain valid when new blocks are allocated.
+	d->blocks.reserve(d->blockCount);
+}
+
+CachedRpFile::~CachedRpFile()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool CachedRpFile::isOpen(void) const
+{
+	RP_D(const CachedRpFile);
+	return (d->file != nullptr && d->file->isOpen());
+}
+
+/**
+ * Close the file.
+ */
+void CachedRpFile::close(void)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (d->file) {
+		d->file->unref();
+		d->file = nullptr;
+	}
+	d->blocks.clear();
+	d->raBuf.clear();
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CachedRpFile::read(void *ptr, size_t size)
+{
+	RP_D(CachedRpFile);
+	size_t ret = this->pread(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * This does not change the file position, and it's thread-safe.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CachedRpFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	// Large reads bypass the cache, since they would
+	// evict most of the cached blocks anyway.
+	if (size >= d->bypassSize) {
+		const size_t sz_read = d->file->pread(pos, ptr, size);
+		d->stats.bypass++;
+		d->stats.reads++;
+		d->stats.bytesRead += sz_read;
+		if (sz_read != size && d->file->lastError() != 0) {
+			m_lastError = d->file->lastError();
+		}
+		return ioScope.done(sz_read);
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const uint64_t blockIdx = static_cast<uint64_t>(pos) / d->blockSize;
+		const unsigned int blockOffset = static_cast<unsigned int>(pos % d->blockSize);
+
+		CachedRpFilePrivate::Block *block = d->findBlock(blockIdx);
+		if (block) {
+			d->stats.hits++;
+		} else {
+			d->stats.misses++;
+			block = d->loadBlock(blockIdx);
+			if (!block) {
+				// Read error or end of file.
+				if (d->file->lastError() != 0) {
+					m_lastError = d->file->lastError();
+				}
+				break;
+			}
+		}
+
+		if (blockOffset >= block->size) {
+			// Short block. (end of file)
+			break;
+		}
+		size_t sz_copy = block->size - blockOffset;
+		if (sz_copy > size) {
+			sz_copy = size;
+		}
+		memcpy(ptr8, &block->data[blockOffset], sz_copy);
+
+		ptr8 += sz_copy;
+		pos += sz_copy;
+		size -= sz_copy;
+		ret += sz_copy;
+	}
+
+	return ioScope.done(ret);
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for CachedRpFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t CachedRpFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for CachedRpFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int CachedRpFile::seek(off64_t pos)
+{
+	IoStats::seek(ioLayer);
+	RP_D(CachedRpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -1;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	d->pos = pos;
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t CachedRpFile::tell(void)
+{
+	RP_D(const CachedRpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return d->pos;
+}
+
+/**
+ * Truncate the file.
+ * (NOTE: Not valid for CachedRpFile; this will always return -1.)
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int CachedRpFile::truncate(off64_t size)
+{
+	// Not supported.
+	RP_UNUSED(size);
+	m_lastError = ENOTSUP;
+	return -1;
+}
+
+/** File properties **/
+
+/**
+ * Get the file size.
+ * This is queried from the underlying file.
+ * @return File size, or negative on error.
+ */
+off64_t CachedRpFile::size(void)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	const off64_t ret = d->file->size();
+	if (ret < 0) {
+		m_lastError = d->file->lastError();
+	}
+	return ret;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string CachedRpFile::filename(void) const
+{
+	RP_D(const CachedRpFile);
+	return (d->file ? d->file->filename() : string());
+}
+
+/** Device file functions **/
+
+/**
+ * Is this a device file?
+ * @return True if this is a device file; false if not.
+ */
+bool CachedRpFile::isDevice(void) const
+{
+	RP_D(const CachedRpFile);
+	return (d->file && d->file->isDevice());
+}
+
+/**
+ * Get a read-only view of part of the file without copying it.
+ * This is passed through to the underlying file.
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+ */
+const uint8_t *CachedRpFile::map(off64_t pos, size_t size)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+	return d->file->map(pos, size);
+}
+
+/**
+ * Tell the file how it's going to be read.
+ *
+ * AH_SEQUENTIAL starts with the maximum read-ahead window,
+ * and AH_RANDOM disables read-ahead. AH_NORMAL restores
+ * sequential access detection. All hints are also passed
+ * through to the underlying file.
+ *
+ * @param hint	[in] Access pattern hint.
+ * @param pos	[in,opt] Starting address of the affected range.
+ * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+ * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+ */
+int CachedRpFile::setAccessHint(AccessHint hint, off64_t pos, off64_t size)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	if (hint != AH_WILLNEED) {
+		// NOTE: The read-ahead window applies to the whole file,
+		// so the range is only used by the underlying file.
+		d->accessHint = hint;
+		d->readAhead = 1;
+	}
+
+	const int ret = d->file->setAccessHint(hint, pos, size);
+	if (ret != 0) {
+		m_lastError = d->file->lastError();
+	}
+	return ret;
+}
+
+/**
+ * Reduce the maximum number of cached blocks.
+ *
+ * The most recently used blocks are kept, and memory used
+ * by the other blocks is released. This is useful once the
+ * file has been identified, since most RomData subclasses
+ * only do a few small reads afterwards.
+ *
+ * @param blockCount	[in] New maximum number of cached blocks. (Ignored if not smaller.)
+ */
+void CachedRpFile::shrink(unsigned int blockCount)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	if (blockCount == 0) {
+		blockCount = 1;
+	}
+	if (blockCount >= d->blockCount)
+		return;
+
+	// Keep the most recently used blocks.
+	// NOTE: A new vector is used so the memory is actually released.
+	vector<CachedRpFilePrivate::Block> blocks;
+	blocks.reserve(blockCount);
+	while (blocks.size() < blockCount) {
+		auto mru = d->blocks.end();
+		for (auto iter = d->blocks.begin(); iter != d->blocks.end(); ++iter) {
+			if (iter->blockIdx != ~0ULL && (mru == d->blocks.end() || iter->lastUse > mru->lastUse)) {
+				mru = iter;
+			}
+		}
+		if (mru == d->blocks.end())
+			break;
+
+		blocks.resize(blocks.size() + 1);
+		CachedRpFilePrivate::Block &block = blocks.back();
+		block.blockIdx = mru->blockIdx;
+		block.lastUse = mru->lastUse;
+		block.size = mru->size;
+		block.data.swap(mru->data);
+		mru->blockIdx = ~0ULL;
+	}
+	d->blocks.swap(blocks);
+
+	// Release the read-ahead buffer.
+	// It will be reallocated if needed.
+	d->raBuf.clear();
+	d->raBuf.shrink_to_fit();
+
+	d->setBlockCount(blockCount);
+}
+
+/** Cache statistics **/
+
+/**
+ * Get the cache statistics.
+ * @param pStats	[out] Cache statistics.
+ */
+void CachedRpFile::getStats(Stats *pStats) const
+{
+	assert(pStats != nullptr);
+	if (!pStats)
+		return;
+
+	RP_D(const CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	*pStats = d->stats;
+}
+
+/**
+ * Reset the cache statistics.
+ */
+void CachedRpFile::resetStats(void)
+{
+	RP_D(CachedRpFile);
+	MutexLocker mutexLocker(d->mutex);
+	memset(&d->stats, 0, sizeof(d->stats));
+}
+
+}
@@ -0,0 +1,203 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * CachedRpFile.hpp: IRpFile wrapper with a read-ahead block cache.        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CACHEDRPFILE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CACHEDRPFILE_HPP__
+
+#include "IRpFile.hpp"
+
+namespace LibRpBase {
+
+class CachedRpFilePrivate;
+class CachedRpFile : public IRpFile
+{
+	public:
+		// Default block size. (must be a power of two)
+		static const unsigned int DEFAULT_BLOCK_SIZE = 64*1024;
+		// Default number of cached blocks.
+		static const unsigned int DEFAULT_BLOCK_COUNT = 16;
+
+		/**
+		 * Wrap an IRpFile with a read-only block cache.
+		 *
+		 * Reads are done in aligned blocks, and the most recently
+		 * used blocks are kept in memory. Sequential access is
+		 * detected, and additional blocks are read ahead in a
+		 * single read from the underlying file.
+		 *
+		 * The file is ref()'d, so the original file can be
+		 * unref()'d by the caller afterwards.
+		 *
+		 * @param file		[in] Underlying file.
+		 * @param blockSize	[in,opt] Block size. (must be a power of two)
+		 * @param blockCount	[in,opt] Maximum number of cached blocks.
+		 */
+		explicit CachedRpFile(IRpFile *file,
+			unsigned int blockSize = DEFAULT_BLOCK_SIZE,
+			unsigned int blockCount = DEFAULT_BLOCK_COUNT);
+	protected:
+		virtual ~CachedRpFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(CachedRpFile)
+	private:
+		friend class CachedRpFilePrivate;
+		CachedRpFilePrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const final;
+
+		/**
+		 * Close the file.
+		 */
+		void close(void) final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Read data from the file at the specified position.
+		 * This does not change the file position, and it's thread-safe.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for CachedRpFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		size_t write(const void *ptr, size_t size) final;
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		off64_t tell(void) final;
+
+		/**
+		 * Truncate the file.
+		 * (NOTE: Not valid for CachedRpFile; this will always return -1.)
+		 * @param size New size. (default is 0)
+		 * @return 0 on success; -1 on error.
+		 */
+		int truncate(off64_t size = 0) final;
+
+	public:
+		/** File properties **/
+
+		/**
+		 * Get the file size.
+		 * This is queried from the underlying file.
+		 * @return File size, or negative on error.
+		 */
+		off64_t size(void) final;
+
+		/**
+		 * Get the filename.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		std::string filename(void) const final;
+
+	public:
+		/** Device file functions **/
+
+		/**
+		 * Is this a device file?
+		 * @return True if this is a device file; false if not.
+		 */
+		bool isDevice(void) const final;
+
+	public:
+		/**
+		 * Get a read-only view of part of the file without copying it.
+		 * This is passed through to the underlying file.
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the view, in bytes.
+		 * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+		 */
+		const uint8_t *map(off64_t pos, size_t size) final;
+
+		/**
+		 * Tell the file how it's going to be read.
+		 *
+		 * AH_SEQUENTIAL starts with the maximum read-ahead window,
+		 * and AH_RANDOM disables read-ahead. AH_NORMAL restores
+		 * sequential access detection. All hints are also passed
+		 * through to the underlying file.
+		 *
+		 * @param hint	[in] Access pattern hint.
+		 * @param pos	[in,opt] Starting address of the affected range.
+		 * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+		 * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+		 */
+		int setAccessHint(AccessHint hint, off64_t pos = 0, off64_t size = 0) final;
+
+	public:
+		/**
+		 * Reduce the maximum number of cached blocks.
+		 *
+		 * The most recently used blocks are kept, and memory used
+		 * by the other blocks is released. This is useful once the
+		 * file has been identified, since most RomData subclasses
+		 * only do a few small reads afterwards.
+		 *
+		 * @param blockCount	[in] New maximum number of cached blocks. (Ignored if not smaller.)
+		 */
+		void shrink(unsigned int blockCount);
+
+	public:
+		/** Cache statistics **/
+
+		struct Stats {
+			uint64_t hits;		// Blocks found in the cache.
+			uint64_t misses;	// Blocks that had to be read.
+			uint64_t readahead;	// Blocks read ahead of a miss.
+			uint64_t bypass;	// Large reads passed to the underlying file.
+			uint64_t bytesRead;	// Bytes read from the underlying file.
+			uint64_t reads;		// Reads from the underlying file.
+		};
+
+		/**
+		 * Get the cache statistics.
+		 * @param pStats	[out] Cache statistics.
+		 */
+		void getStats(Stats *pStats) const;
+
+		/**
+		 * Reset the cache statistics.
+		 */
+		void resetStats(void);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CACHEDRPFILE_HPP__ */
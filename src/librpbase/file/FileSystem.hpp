@@ -172,6 +172,26 @@ bool isOnBadFS(const char *filename, bool netFS = false);
  */
 int get_file_size_and_mtime(const std::string &filename, off64_t *pFileSize, time_t *pMtime);
 
+/**
+ * File identity.
+ * If any of these fields change, the file should be
+ * assumed to have been modified.
+ */
+struct FileId {
+	uint64_t dev;	// Device ID (POSIX) or volume serial number (Win32)
+	uint64_t ino;	// Inode number (POSIX) or file index (Win32)
+	off64_t size;	// File size
+	time_t mtime;	// Modification time
+};
+
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_id(const std::string &filename, FileId *pFileId);
+
 } }
 
 #endif /* __ROMPROPERTIES_LIBRPBASE_FILESYSTEM_HPP__ */
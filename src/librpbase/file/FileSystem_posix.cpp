@@ -349,4 +349,39 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 	return 0;
 }
 
+
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_id(const string &filename, FileId *pFileId)
+{
+	assert(pFileId != nullptr);
+
+	struct stat sb;
+	if (stat(filename.c_str(), &sb) != 0) {
+		// An error occurred.
+		int ret = -errno;
+		if (ret == 0) {
+			// No error?
+			ret = -EIO;
+		}
+		return ret;
+	}
+
+	// Make sure this is not a directory.
+	if (S_ISDIR(sb.st_mode)) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	pFileId->dev = sb.st_dev;
+	pFileId->ino = sb.st_ino;
+	pFileId->size = sb.st_size;
+	pFileId->mtime = sb.st_mtime;
+	return 0;
+}
+
 } }
@@ -0,0 +1,1054 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * GzIndexReader.cpp: Random-access reader for gzip-compressed files.      *
+ * (INTERNAL CLASS; used by RpFile for FM_OPEN_READ_GZ)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "GzIndexReader.hpp"
+
+#include "IRpFile.hpp"
+#include "RpFile.hpp"
+#include "FileSystem.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// zlib
+#include <zlib.h>
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRpBase {
+
+/** GzIndexReaderPrivate **/
+
+class GzIndexReaderPrivate
+{
+	public:
+		/**
+		 * Open a gzip file or a raw deflate stream.
+		 * @param file		[in] Compressed file.
+		 * @param filename	[in,opt] Filename, for the index cache. (gzip only)
+		 * @param rawOffset	[in] Raw deflate stream offset, or -1 for gzip.
+		 * @param rawCompSize	[in] Raw deflate stream compressed size.
+		 * @param rawUncompSize	[in] Raw deflate stream uncompressed size.
+		 */
+		GzIndexReaderPrivate(IRpFile *file, const char *filename,
+			off64_t rawOffset, off64_t rawCompSize, off64_t rawUncompSize);
+		~GzIndexReaderPrivate();
+
+	private:
+		RP_DISABLE_COPY(GzIndexReaderPrivate)
+
+	public:
+		// Deflate window size.
+		static const unsigned int WINSIZE = 32768;
+		// Input buffer size.
+		static const unsigned int CHUNK = 65536;
+		// Initial spacing between seek points, in uncompressed bytes.
+		static const off64_t SPAN_INITIAL = 1024*1024;
+		// Maximum number of seek points.
+		// Each seek point uses up to WINSIZE bytes of memory.
+		static const unsigned int MAX_POINTS = 512;
+		// Maximum deflate compression ratio. (258 bytes per 2-bit code,
+		// rounded up to include the block headers)
+		static const unsigned int MAX_DEFLATE_RATIO = 1032;
+
+		// Is the seek point index cache enabled?
+		static volatile bool cacheEnabled;
+		// Custom index cache directory. (empty for the default)
+		static string cacheDirectory;
+
+		// Seek point.
+		struct Point {
+			off64_t out;		// Uncompressed position.
+			off64_t in;		// Compressed position of the first full byte.
+			unsigned int bits;	// Number of bits (1-7) from the byte at in-1, or 0.
+			ao::uvector<uint8_t> dict;	// Previous uncompressed data. (up to WINSIZE)
+		};
+
+	public:
+		IRpFile *file;		// Compressed file.
+		off64_t compSize;	// End of the compressed data. (file size for gzip)
+		bool isRaw;		// True for a raw deflate stream; false for gzip.
+		string filename;	// Filename, for the index cache.
+		int lastError;
+		bool isOpen;
+
+		// Seek point index.
+		vector<Point> points;
+		off64_t span;		// Current spacing between seek points.
+		off64_t frontier;	// Highest uncompressed position decompressed so far.
+		off64_t uncompSize;	// Uncompressed size. (-1 if not known yet)
+		off64_t sizeEstimate;	// Uncompressed size estimate from ISIZE. (-1 if not available)
+		bool indexDirty;	// True if seek points were added since the index was loaded or saved.
+
+		// Decompression state.
+		z_stream strm;
+		bool strmInit;		// True if strm was initialized.
+		bool cursorValid;	// True if the decompression state is valid.
+		bool cursorEof;		// True if the end of the compressed data was reached.
+		off64_t in_pos;		// Compressed position of the next input read.
+		off64_t out_pos;	// Uncompressed position of the next output byte.
+		unsigned int win_pos;	// Next write position in window.
+		unsigned int win_fill;	// Valid data in window.
+		uint8_t window[WINSIZE];	// Circular buffer with the most recent output.
+		ao::uvector<uint8_t> inbuf;	// Input buffer.
+
+		// Locked while using the decompression state.
+		Mutex mutex;
+
+	public:
+		/**
+		 * Parse a gzip member header.
+		 * @param pos Compressed position of the header.
+		 * @return Compressed position of the deflate data, or -1 if the header is invalid.
+		 */
+		off64_t parseGzipHeader(off64_t pos);
+
+		/**
+		 * Add a seek point at the current decompression position.
+		 * @param in Compressed position of the first full byte.
+		 * @param bits Number of bits (0-7) from the byte at in-1.
+		 * @param withDict If true, save the dictionary.
+		 */
+		void addPoint(off64_t in, unsigned int bits, bool withDict);
+
+		/**
+		 * Restart decompression at a seek point.
+		 * @param pt Seek point.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int resetToPoint(const Point &pt);
+
+		/**
+		 * Decompress the next bit of data into the window.
+		 * Seek points are added if we're past the frontier.
+		 * @param pStart [out] Window index of the first new byte.
+		 * @return Number of bytes decompressed, or -1 on error.
+		 */
+		int inflateStep(unsigned int *pStart);
+
+		/**
+		 * Handle the end of a gzip member or raw deflate stream.
+		 * For gzip, this checks for another gzip member.
+		 */
+		void memberEnd(void);
+
+		/**
+		 * Position the decompression state for reading from pos.
+		 * @param pos Uncompressed position.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int seekCursor(off64_t pos);
+
+		/**
+		 * Decompress the rest of the file to determine the uncompressed size.
+		 */
+		void finishIndex(void);
+
+		/**
+		 * Estimate the uncompressed size using the ISIZE field
+		 * in the gzip trailer at the end of the file.
+		 * @param dataStart Compressed position of the deflate data.
+		 * @return Estimated uncompressed size, or -1 on error.
+		 */
+		off64_t estimateSize(off64_t dataStart);
+
+		/**
+		 * Get the index cache filename.
+		 * @param filename [in] Compressed filename.
+		 * @param pFileId [out] File identity.
+		 * @return Index cache filename, or empty string on error.
+		 */
+		static string getCacheFilename(const string &filename, FileSystem::FileId *pFileId);
+
+		/**
+		 * Load the seek point index from the cache.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadIndex(void);
+
+		/**
+		 * Save the seek point index to the cache.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int saveIndex(void);
+};
+
+volatile bool GzIndexReaderPrivate::cacheEnabled = false;
+string GzIndexReaderPrivate::cacheDirectory;
+
+/**
+ * Seek point index cache file.
+ * Stored in the "gzindex" subdirectory of the rom-properties
+ * cache directory. All values are in host byte order, since
+ * the cache is only valid on the system that created it.
+ *
+ * The header is followed by point_count GzIndexCachePoint
+ * records, followed by the dictionary data for each point.
+ *
+ * If the file wasn't completely decompressed, uncomp_size is -1,
+ * and frontier is the highest position that was decompressed.
+ */
+static const uint32_t GZINDEX_CACHE_MAGIC = 'RPGZ';
+static const uint32_t GZINDEX_CACHE_VERSION = 2;
+
+struct GzIndexCacheHeader {
+	uint32_t magic;		// [0x000] 'RPGZ' (host byte order)
+	uint32_t version;	// [0x004] GZINDEX_CACHE_VERSION
+	int64_t comp_size;	// [0x008] Compressed file size
+	int64_t mtime;		// [0x010] Compressed file modification time
+	int64_t uncomp_size;	// [0x018] Uncompressed size (-1 if not known)
+	int64_t frontier;	// [0x020] Highest uncompressed position decompressed
+	int64_t span;		// [0x028] Spacing between seek points
+	uint32_t point_count;	// [0x030] Number of seek points
+	uint32_t reserved;	// [0x034]
+};
+ASSERT_STRUCT(GzIndexCacheHeader, 56);
+
+struct GzIndexCachePoint {
+	int64_t out;		// [0x000] Uncompressed position
+	int64_t in;		// [0x008] Compressed position
+	uint32_t bits;		// [0x010] Number of bits from the byte at in-1
+	uint32_t dict_len;	// [0x014] Dictionary length
+};
+ASSERT_STRUCT(GzIndexCachePoint, 24);
+
+GzIndexReaderPrivate::GzIndexReaderPrivate(IRpFile *file, const char *filename,
+		off64_t rawOffset, off64_t rawCompSize, off64_t rawUncompSize)
+	: file(file ? file->ref() : nullptr)
+	, compSize(0)
+	, isRaw(rawOffset >= 0)
+	, lastError(0)
+	, isOpen(false)
+	, span(SPAN_INITIAL)
+	, frontier(0)
+	, uncompSize(-1)
+	, sizeEstimate(-1)
+	, indexDirty(false)
+	, strmInit(false)
+	, cursorValid(false)
+	, cursorEof(false)
+	, in_pos(0)
+	, out_pos(0)
+	, win_pos(0)
+	, win_fill(0)
+{
+	memset(&strm, 0, sizeof(strm));
+	if (!this->file) {
+		lastError = EBADF;
+		return;
+	}
+	if (filename) {
+		this->filename = filename;
+	}
+
+	off64_t dataStart;
+	if (isRaw) {
+		// Raw deflate stream.
+		// The uncompressed size is provided by the caller.
+		const off64_t fileSize = this->file->size();
+		if (rawCompSize < 0 || rawUncompSize < 0 || rawOffset > fileSize ||
+		    rawCompSize > fileSize - rawOffset)
+		{
+			lastError = EIO;
+			return;
+		}
+		dataStart = rawOffset;
+		compSize = rawOffset + rawCompSize;
+		uncompSize = rawUncompSize;
+	} else {
+		compSize = this->file->size();
+		dataStart = parseGzipHeader(0);
+		if (dataStart < 0) {
+			// Not a gzip file.
+			lastError = EIO;
+			return;
+		}
+		sizeEstimate = estimateSize(dataStart);
+	}
+
+	// Raw deflate. gzip headers and trailers are handled manually
+	// so seek points can be restarted using raw deflate.
+	if (inflateInit2(&strm, -15) != Z_OK) {
+		lastError = ENOMEM;
+		return;
+	}
+	strmInit = true;
+	inbuf.resize(CHUNK);
+
+	// Try loading the seek point index from the cache.
+	if (cacheEnabled && !isRaw && !this->filename.empty()) {
+		if (loadIndex() == 0) {
+			isOpen = true;
+			return;
+		}
+		points.clear();
+		span = SPAN_INITIAL;
+		frontier = 0;
+		uncompSize = -1;
+	}
+
+	// The first seek point is the start of the deflate data.
+	Point pt;
+	pt.out = 0;
+	pt.in = dataStart;
+	pt.bits = 0;
+	points.push_back(std::move(pt));
+	isOpen = true;
+}
+
+GzIndexReaderPrivate::~GzIndexReaderPrivate()
+{
+	// Save the index if seek points were added, so the next
+	// reader doesn't have to decompress this much again.
+	if (isOpen && indexDirty && cacheEnabled && !isRaw && points.size() > 1) {
+		saveIndex();
+	}
+
+	if (strmInit) {
+		inflateEnd(&strm);
+	}
+	if (file) {
+		file->unref();
+	}
+}
+
+/**
+ * Parse a gzip member header.
+ * @param pos Compressed position of the header.
+ * @return Compressed position of the deflate data, or -1 if the header is invalid.
+ */
+off64_t GzIndexReaderPrivate::parseGzipHeader(off64_t pos)
+{
+	// Reference: RFC 1952
+	uint8_t hdr[10];
+	if (file->pread(pos, hdr, sizeof(hdr)) != sizeof(hdr)) {
+		return -1;
+	}
+	if (hdr[0] != 0x1F || hdr[1] != 0x8B || hdr[2] != 8 /* CM_DEFLATE */) {
+		return -1;
+	}
+	const uint8_t flg = hdr[3];
+	if (flg & 0xE0) {
+		// Reserved flags are set.
+		return -1;
+	}
+	pos += sizeof(hdr);
+
+	if (flg & 0x04) {
+		// FEXTRA
+		uint8_t xlen[2];
+		if (file->pread(pos, xlen, sizeof(xlen)) != sizeof(xlen)) {
+			return -1;
+		}
+		pos += 2 + (xlen[0] | (xlen[1] << 8));
+	}
+
+	// FNAME and FCOMMENT are NULL-terminated strings.
+	for (unsigned int flag = 0x08; flag <= 0x10; flag <<= 1) {
+		if (!(flg & flag))
+			continue;
+
+		bool found = false;
+		do {
+			uint8_t buf[256];
+			const size_t size = file->pread(pos, buf, sizeof(buf));
+			if (size == 0) {
+				return -1;
+			}
+			const uint8_t *const nul = static_cast<const uint8_t*>(memchr(buf, 0, size));
+			if (nul) {
+				pos += (nul - buf) + 1;
+				found = true;
+			} else {
+				pos += size;
+			}
+		} while (!found);
+	}
+
+	if (flg & 0x02) {
+		// FHCRC
+		pos += 2;
+	}
+
+	return (pos <= compSize ? pos : -1);
+}
+
+/**
+ * Add a seek point at the current decompression position.
+ * @param in Compressed position of the first full byte.
+ * @param bits Number of bits (0-7) from the byte at in-1.
+ * @param withDict If true, save the dictionary.
+ */
+void GzIndexReaderPrivate::addPoint(off64_t in, unsigned int bits, bool withDict)
+{
+	Point pt;
+	pt.out = out_pos;
+	pt.in = in;
+	pt.bits = bits;
+	if (withDict && win_fill > 0) {
+		// Linearize the most recent output.
+		pt.dict.resize(win_fill);
+		const unsigned int wp = win_pos % WINSIZE;
+		if (win_fill < WINSIZE) {
+			// Window hasn't wrapped around yet.
+			assert(wp == win_fill);
+			memcpy(pt.dict.data(), window, win_fill);
+		} else {
+			memcpy(pt.dict.data(), &window[wp], WINSIZE - wp);
+			memcpy(&pt.dict[WINSIZE - wp], window, wp);
+		}
+	}
+	points.push_back(std::move(pt));
+	indexDirty = true;
+
+	if (points.size() > MAX_POINTS) {
+		// Too many seek points.
+		// Discard every other point and double the spacing.
+		size_t j = 1;
+		for (size_t i = 2; i < points.size(); i += 2, j++) {
+			points[j] = std::move(points[i]);
+		}
+		points.resize(j);
+		span *= 2;
+	}
+}
+
+/**
+ * Restart decompression at a seek point.
+ * @param pt Seek point.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexReaderPrivate::resetToPoint(const Point &pt)
+{
+	cursorValid = false;
+	if (inflateReset(&strm) != Z_OK) {
+		lastError = EIO;
+		return -EIO;
+	}
+	strm.avail_in = 0;
+
+	if (pt.bits != 0) {
+		// Seek point is in the middle of a byte.
+		uint8_t byte;
+		if (file->pread(pt.in - 1, &byte, 1) != 1) {
+			lastError = EIO;
+			return -EIO;
+		}
+		inflatePrime(&strm, pt.bits, byte >> (8 - pt.bits));
+	}
+
+	const unsigned int dictLen = static_cast<unsigned int>(pt.dict.size());
+	if (dictLen > 0) {
+		inflateSetDictionary(&strm, pt.dict.data(), dictLen);
+		memcpy(window, pt.dict.data(), dictLen);
+	}
+	win_pos = dictLen;
+	win_fill = dictLen;
+
+	in_pos = pt.in;
+	out_pos = pt.out;
+	cursorEof = false;
+	cursorValid = true;
+	return 0;
+}
+
+/**
+ * Decompress the next bit of data into the window.
+ * Seek points are added if we're past the frontier.
+ * @param pStart [out] Window index of the first new byte.
+ * @return Number of bytes decompressed, or -1 on error.
+ */
+int GzIndexReaderPrivate::inflateStep(unsigned int *pStart)
+{
+	assert(cursorValid);
+	if (win_pos == WINSIZE) {
+		win_pos = 0;
+	}
+
+	if (strm.avail_in == 0) {
+		// Read more compressed data.
+		size_t sz_req = CHUNK;
+		if (in_pos + static_cast<off64_t>(sz_req) > compSize) {
+			sz_req = static_cast<size_t>(compSize - in_pos);
+		}
+		const size_t sz_read = (sz_req > 0 ? file->pread(in_pos, inbuf.data(), sz_req) : 0);
+		if (sz_read == 0) {
+			// Truncated gzip data.
+			lastError = EIO;
+			cursorValid = false;
+			return -1;
+		}
+		in_pos += sz_read;
+		strm.next_in = inbuf.data();
+		strm.avail_in = static_cast<uInt>(sz_read);
+	}
+
+	*pStart = win_pos;
+	strm.next_out = &window[win_pos];
+	strm.avail_out = WINSIZE - win_pos;
+	const int ret = inflate(&strm, Z_BLOCK);
+	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+		// Decompression error.
+		lastError = EIO;
+		cursorValid = false;
+		return -1;
+	}
+
+	const unsigned int produced = (WINSIZE - win_pos) - strm.avail_out;
+	win_pos += produced;
+	win_fill += produced;
+	if (win_fill > WINSIZE) {
+		win_fill = WINSIZE;
+	}
+	out_pos += produced;
+
+	const bool isExtending = (out_pos >= frontier);
+	if (ret == Z_STREAM_END) {
+		memberEnd();
+	} else if (isExtending && (strm.data_type & 128) && !(strm.data_type & 64) &&
+		   out_pos - points.back().out >= span)
+	{
+		// End of a deflate block that isn't the last block.
+		addPoint(in_pos - strm.avail_in, strm.data_type & 7, true);
+	}
+
+	if (out_pos > frontier) {
+		frontier = out_pos;
+		if (sizeEstimate >= 0 && frontier > sizeEstimate) {
+			// ISIZE didn't include all of the data.
+			sizeEstimate = -1;
+		}
+	}
+	return static_cast<int>(produced);
+}
+
+/**
+ * Handle the end of a gzip member or raw deflate stream.
+ * For gzip, this checks for another gzip member.
+ */
+void GzIndexReaderPrivate::memberEnd(void)
+{
+	if (isRaw) {
+		// End of the raw deflate stream.
+		cursorEof = true;
+		return;
+	}
+
+	// Skip the 8-byte trailer. (CRC32 and ISIZE)
+	const off64_t trailerEnd = (in_pos - strm.avail_in) + 8;
+	const off64_t dataStart = (trailerEnd < compSize ? parseGzipHeader(trailerEnd) : -1);
+	if (dataStart < 0) {
+		// No more gzip members.
+		// NOTE: Trailing garbage is ignored, like gzip does.
+		cursorEof = true;
+		if (uncompSize < 0) {
+			uncompSize = out_pos;
+
+			// The index is complete, so save it now
+			// if it's large enough to be worth it.
+			if (indexDirty && cacheEnabled && points.size() > 1) {
+				saveIndex();
+			}
+		}
+		return;
+	}
+
+	// Start of another gzip member.
+	// ISIZE only includes the last member, so it can't be used.
+	sizeEstimate = -1;
+	inflateReset(&strm);
+	strm.avail_in = 0;
+	in_pos = dataStart;
+	win_pos = 0;
+	win_fill = 0;
+
+	if (out_pos >= frontier && out_pos > points.back().out) {
+		// New members don't need a dictionary.
+		addPoint(dataStart, 0, false);
+	}
+}
+
+/**
+ * Position the decompression state for reading from pos.
+ * @param pos Uncompressed position.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexReaderPrivate::seekCursor(off64_t pos)
+{
+	// Find the last seek point at or before pos.
+	auto iter = std::upper_bound(points.cbegin(), points.cend(), pos,
+		[](off64_t pos, const Point &pt) { return pos < pt.out; });
+	assert(iter != points.cbegin());
+	--iter;
+
+	if (cursorValid && out_pos <= pos && out_pos >= iter->out) {
+		// The current position is closer than the seek point.
+		return 0;
+	}
+	return resetToPoint(*iter);
+}
+
+/**
+ * Decompress the rest of the file to determine the uncompressed size.
+ */
+void GzIndexReaderPrivate::finishIndex(void)
+{
+	if (uncompSize >= 0)
+		return;
+
+	// Continue from the frontier.
+	if (seekCursor(frontier) != 0)
+		return;
+
+	// NOTE: The index is saved by memberEnd() once
+	// the end of the file is reached.
+	unsigned int start;
+	while (!cursorEof) {
+		if (inflateStep(&start) < 0) {
+			// Decompression error.
+			// Use the data that was decompressed.
+			uncompSize = frontier;
+			return;
+		}
+	}
+}
+
+/**
+ * Estimate the uncompressed size using the ISIZE field
+ * in the gzip trailer at the end of the file.
+ * @param dataStart Compressed position of the deflate data.
+ * @return Estimated uncompressed size, or -1 if ISIZE can't be used.
+ */
+off64_t GzIndexReaderPrivate::estimateSize(off64_t dataStart)
+{
+	// The trailer is 8 bytes: CRC32, then ISIZE.
+	if (compSize - dataStart < 8) {
+		return -1;
+	}
+
+	// ISIZE is modulo 2^32, so it's only correct if the
+	// uncompressed data is smaller than 4 GiB. That's only
+	// certain if the compressed data is small enough.
+	const off64_t deflateSize = compSize - dataStart - 8;
+	if (deflateSize >= static_cast<off64_t>(0x100000000LL / MAX_DEFLATE_RATIO)) {
+		return -1;
+	}
+
+	uint32_t isize;
+	if (file->pread(compSize - 4, &isize, sizeof(isize)) != sizeof(isize)) {
+		return -1;
+	}
+	const off64_t size = le32_to_cpu(isize);
+
+	// Deflate adds at most 5 bytes per 64 KiB stored block, so the
+	// uncompressed data can't be much smaller than the compressed
+	// data. If ISIZE is smaller than that, this is a file with
+	// multiple gzip members, so the exact size has to be
+	// determined by decompression.
+	if (size < deflateSize - (5 * (deflateSize / 65535 + 1))) {
+		return -1;
+	}
+	return size;
+}
+
+/**
+ * Get the index cache filename.
+ * @param filename [in] Compressed filename.
+ * @param pFileId [out] File identity.
+ * @return Index cache filename, or empty string on error.
+ */
+string GzIndexReaderPrivate::getCacheFilename(const string &filename, FileSystem::FileId *pFileId)
+{
+	if (filename.empty() || FileSystem::get_file_id(filename, pFileId) != 0) {
+		return string();
+	}
+
+	string cacheFilename;
+	if (!cacheDirectory.empty()) {
+		cacheFilename = cacheDirectory;
+	} else {
+		cacheFilename = FileSystem::getCacheDirectory();
+		if (cacheFilename.empty()) {
+			return string();
+		}
+		if (cacheFilename.at(cacheFilename.size()-1) != DIR_SEP_CHR) {
+			cacheFilename += DIR_SEP_CHR;
+		}
+		cacheFilename += "gzindex";
+	}
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%08X%08X_%08X%08X.gzi",
+		static_cast<unsigned int>(pFileId->dev >> 32),
+		static_cast<unsigned int>(pFileId->dev & 0xFFFFFFFFU),
+		static_cast<unsigned int>(pFileId->ino >> 32),
+		static_cast<unsigned int>(pFileId->ino & 0xFFFFFFFFU));
+	if (cacheFilename.at(cacheFilename.size()-1) != DIR_SEP_CHR) {
+		cacheFilename += DIR_SEP_CHR;
+	}
+	cacheFilename += buf;
+	return cacheFilename;
+}
+
+/**
+ * Load the seek point index from the cache.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexReaderPrivate::loadIndex(void)
+{
+	FileSystem::FileId fileId;
+	const string cacheFilename = getCacheFilename(filename, &fileId);
+	if (cacheFilename.empty()) {
+		return -ENOENT;
+	}
+
+	unique_IRpFile<RpFile> cacheFile(new RpFile(cacheFilename, RpFile::FM_OPEN_READ));
+	if (!cacheFile->isOpen()) {
+		return -ENOENT;
+	}
+
+	GzIndexCacheHeader header;
+	if (cacheFile->read(&header, sizeof(header)) != sizeof(header) ||
+	    header.magic != GZINDEX_CACHE_MAGIC ||
+	    header.version != GZINDEX_CACHE_VERSION ||
+	    header.comp_size != fileId.size ||
+	    header.comp_size != compSize ||
+	    header.mtime != static_cast<int64_t>(fileId.mtime) ||
+	    header.frontier < 0 || header.uncomp_size < -1 ||
+	    (header.uncomp_size >= 0 && header.frontier != header.uncomp_size) ||
+	    header.span <= 0 ||
+	    header.point_count == 0 || header.point_count > MAX_POINTS)
+	{
+		// Incorrect header, or the file has changed.
+		return -EIO;
+	}
+
+	vector<GzIndexCachePoint> cachePoints(header.point_count);
+	const size_t sz_points = header.point_count * sizeof(GzIndexCachePoint);
+	if (cacheFile->read(cachePoints.data(), sz_points) != sz_points) {
+		return -EIO;
+	}
+
+	points.resize(header.point_count);
+	off64_t prev_out = -1;
+	for (unsigned int i = 0; i < header.point_count; i++) {
+		const GzIndexCachePoint &cp = cachePoints[i];
+		if (cp.out <= prev_out || cp.out > header.frontier ||
+		    cp.in <= 0 || cp.in > compSize ||
+		    cp.bits > 7 || cp.dict_len > WINSIZE)
+		{
+			// Invalid seek point.
+			return -EIO;
+		}
+		prev_out = cp.out;
+
+		Point &pt = points[i];
+		pt.out = cp.out;
+		pt.in = cp.in;
+		pt.bits = cp.bits;
+		pt.dict.resize(cp.dict_len);
+		if (cp.dict_len > 0 &&
+		    cacheFile->read(pt.dict.data(), cp.dict_len) != cp.dict_len)
+		{
+			return -EIO;
+		}
+	}
+
+	span = header.span;
+	uncompSize = header.uncomp_size;
+	frontier = header.frontier;
+	if (sizeEstimate >= 0 && frontier > sizeEstimate) {
+		// ISIZE didn't include all of the data.
+		sizeEstimate = -1;
+	}
+	indexDirty = false;
+	return 0;
+}
+
+/**
+ * Save the seek point index to the cache.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexReaderPrivate::saveIndex(void)
+{
+	FileSystem::FileId fileId;
+	const string cacheFilename = getCacheFilename(filename, &fileId);
+	if (cacheFilename.empty()) {
+		return -ENOENT;
+	}
+	if (FileSystem::rmkdir(cacheFilename) != 0) {
+		return -EIO;
+	}
+
+	unique_IRpFile<RpFile> cacheFile(new RpFile(cacheFilename, RpFile::FM_CREATE_WRITE));
+	if (!cacheFile->isOpen()) {
+		return -EIO;
+	}
+
+	GzIndexCacheHeader header;
+	header.magic = GZINDEX_CACHE_MAGIC;
+	header.version = GZINDEX_CACHE_VERSION;
+	header.comp_size = compSize;
+	header.mtime = static_cast<int64_t>(fileId.mtime);
+	header.uncomp_size = uncompSize;
+	header.frontier = frontier;
+	header.span = span;
+	header.point_count = static_cast<uint32_t>(points.size());
+	header.reserved = 0;
+
+	vector<GzIndexCachePoint> cachePoints(points.size());
+	for (size_t i = 0; i < points.size(); i++) {
+		GzIndexCachePoint &cp = cachePoints[i];
+		cp.out = points[i].out;
+		cp.in = points[i].in;
+		cp.bits = points[i].bits;
+		cp.dict_len = static_cast<uint32_t>(points[i].dict.size());
+	}
+
+	bool ok = (cacheFile->write(&header, sizeof(header)) == sizeof(header));
+	const size_t sz_points = cachePoints.size() * sizeof(GzIndexCachePoint);
+	ok = ok && (cacheFile->write(cachePoints.data(), sz_points) == sz_points);
+	for (auto iter = points.cbegin(); ok && iter != points.cend(); ++iter) {
+		if (!iter->dict.empty()) {
+			ok = (cacheFile->write(iter->dict.data(), iter->dict.size()) == iter->dict.size());
+		}
+	}
+
+	if (!ok) {
+		// Write error. Don't leave a partial file.
+		cacheFile->truncate(0);
+		return -EIO;
+	}
+	indexDirty = false;
+	return 0;
+}
+
+/** GzIndexReader **/
+
+/**
+ * Open a gzip-compressed file.
+ * The file is ref()'d, so the original file can be
+ * unref()'d by the caller afterwards.
+ * @param file		[in] Compressed file.
+ * @param filename	[in,opt] Filename, for the index cache.
+ */
+GzIndexReader::GzIndexReader(IRpFile *file, const char *filename)
+	: d_ptr(new GzIndexReaderPrivate(file, filename, -1, 0, 0))
+{ }
+
+/**
+ * Open a raw deflate stream, e.g. a ZIP archive member.
+ * The index cache is not used for raw deflate streams.
+ * The file is ref()'d, so the original file can be
+ * unref()'d by the caller afterwards.
+ * @param file		[in] File containing the deflate stream.
+ * @param offset	[in] Starting offset of the deflate stream.
+ * @param compSize	[in] Compressed size.
+ * @param uncompSize	[in] Uncompressed size.
+ */
+GzIndexReader::GzIndexReader(IRpFile *file, off64_t offset, off64_t compSize, off64_t uncompSize)
+	: d_ptr(new GzIndexReaderPrivate(file, nullptr, offset, compSize, uncompSize))
+{ }
+
+GzIndexReader::~GzIndexReader()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the file open?
+ * This returns false if the file doesn't have a valid gzip header.
+ * @return True if the file is open; false if it isn't.
+ */
+bool GzIndexReader::isOpen(void) const
+{
+	RP_D(const GzIndexReader);
+	return d->isOpen;
+}
+
+/**
+ * Get the last error.
+ * @return Last POSIX error, or 0 if no error.
+ */
+int GzIndexReader::lastError(void) const
+{
+	RP_D(const GzIndexReader);
+	return d->lastError;
+}
+
+/**
+ * Get the uncompressed size.
+ *
+ * If the exact size isn't known yet, it's estimated using the
+ * ISIZE field in the gzip trailer, so nothing is decompressed.
+ * ISIZE is only used if the compressed data is too small for
+ * the uncompressed data to reach 4 GiB; otherwise, the file
+ * is decompressed in order to determine the exact size.
+ * NOTE: For files with multiple gzip members, the estimate
+ * only includes the last member. It's discarded as soon as
+ * another member is found while decompressing.
+ *
+ * @return Uncompressed size, or -1 on error.
+ */
+off64_t GzIndexReader::size(void)
+{
+	RP_D(GzIndexReader);
+	if (!d->isOpen) {
+		return -1;
+	}
+
+	MutexLocker mutexLocker(d->mutex);
+	if (d->uncompSize >= 0) {
+		return d->uncompSize;
+	} else if (d->sizeEstimate >= 0) {
+		return d->sizeEstimate;
+	}
+	d->finishIndex();
+	return d->uncompSize;
+}
+
+/**
+ * Get the exact uncompressed size.
+ * If it isn't known yet, the rest of the file will be
+ * decompressed in order to determine it.
+ * @return Uncompressed size, or -1 on error.
+ */
+off64_t GzIndexReader::exactSize(void)
+{
+	RP_D(GzIndexReader);
+	if (!d->isOpen) {
+		return -1;
+	}
+
+	MutexLocker mutexLocker(d->mutex);
+	d->finishIndex();
+	return d->uncompSize;
+}
+
+/**
+ * Read uncompressed data from the specified position.
+ * This function is thread-safe.
+ * @param pos	[in] Uncompressed position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GzIndexReader::pread(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(GzIndexReader);
+	if (!d->isOpen) {
+		d->lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		d->lastError = EINVAL;
+		return 0;
+	}
+
+	MutexLocker mutexLocker(d->mutex);
+	if (size == 0 || (d->uncompSize >= 0 && pos >= d->uncompSize)) {
+		// Nothing to read.
+		return 0;
+	}
+	static const unsigned int WINSIZE = GzIndexReaderPrivate::WINSIZE;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	const off64_t end = pos + static_cast<off64_t>(size);
+	off64_t cur = pos;
+
+	if (d->cursorValid && pos < d->out_pos &&
+	    pos >= d->out_pos - static_cast<off64_t>(d->win_fill))
+	{
+		// The start of the requested data is still in the window.
+		// This is usually the case for sequential reads.
+		const unsigned int back = static_cast<unsigned int>(d->out_pos - pos);
+		unsigned int idx = (d->win_pos + WINSIZE - back) % WINSIZE;
+		size_t sz_copy = (static_cast<size_t>(back) < size ? back : size);
+		while (sz_copy > 0) {
+			size_t sz_chunk = WINSIZE - idx;
+			if (sz_chunk > sz_copy) {
+				sz_chunk = sz_copy;
+			}
+			memcpy(ptr8, &d->window[idx], sz_chunk);
+			ptr8 += sz_chunk;
+			cur += sz_chunk;
+			sz_copy -= sz_chunk;
+			idx = 0;
+		}
+	} else if (d->seekCursor(pos) != 0) {
+		return 0;
+	}
+
+	while (cur < end && !d->cursorEof) {
+		const off64_t before = d->out_pos;
+		unsigned int start;
+		const int produced = d->inflateStep(&start);
+		if (produced < 0) {
+			// Decompression error.
+			break;
+		}
+
+		// Copy the requested part of the new data.
+		if (before + produced > cur) {
+			assert(cur >= before);
+			const unsigned int skip = static_cast<unsigned int>(cur - before);
+			size_t sz_copy = produced - skip;
+			if (static_cast<off64_t>(sz_copy) > end - cur) {
+				sz_copy = static_cast<size_t>(end - cur);
+			}
+			memcpy(ptr8, &d->window[start + skip], sz_copy);
+			ptr8 += sz_copy;
+			cur += sz_copy;
+		}
+	}
+
+	return static_cast<size_t>(cur - pos);
+}
+
+/**
+ * Enable or disable the seek point index cache.
+ * The index cache is disabled by default.
+ * @param enabled True to enable; false to disable.
+ */
+void GzIndexReader::setCacheEnabled(bool enabled)
+{
+	GzIndexReaderPrivate::cacheEnabled = enabled;
+}
+
+/**
+ * Is the seek point index cache enabled?
+ * @return True if enabled; false if not.
+ */
+bool GzIndexReader::isCacheEnabled(void)
+{
+	return GzIndexReaderPrivate::cacheEnabled;
+}
+
+/**
+ * Set the seek point index cache directory.
+ * @param dir Cache directory. (If empty, the gzindex subdirectory of the cache directory is used.)
+ */
+void GzIndexReader::setCacheDirectory(const string &dir)
+{
+	GzIndexReaderPrivate::cacheDirectory = dir;
+}
+
+/**
+ * Get the seek point index cache filename for a gzip-compressed file.
+ * @param filename Compressed filename.
+ * @return Index cache filename, or empty string on error.
+ */
+string GzIndexReader::getCacheFilename(const string &filename)
+{
+	FileSystem::FileId fileId;
+	return GzIndexReaderPrivate::getCacheFilename(filename, &fileId);
+}
+
+}
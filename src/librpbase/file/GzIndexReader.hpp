@@ -0,0 +1,163 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * GzIndexReader.hpp: Random-access reader for gzip-compressed files.      *
+ * (INTERNAL CLASS; used by RpFile for FM_OPEN_READ_GZ)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_FILE_GZINDEXREADER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_FILE_GZINDEXREADER_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstddef>	/* for size_t */
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+class IRpFile;
+
+/**
+ * Random-access reader for gzip-compressed files
+ * and raw deflate streams.
+ *
+ * Seek points are recorded at deflate block boundaries while
+ * the file is being decompressed. Each seek point stores the
+ * compressed and uncompressed positions and the previous 32 KiB
+ * of uncompressed data, so decompression can be restarted from
+ * the closest seek point instead of from the beginning of the file.
+ *
+ * The number of seek points is limited; if the limit is reached,
+ * every other seek point is discarded and the spacing is doubled.
+ *
+ * Concatenated gzip members are supported. size() returns an
+ * estimate from the ISIZE field until the whole file has been
+ * decompressed, since ISIZE is only the lower 32 bits of the
+ * last member's size. exactSize() decompresses the rest of the
+ * file if necessary.
+ *
+ * If enabled, the seek point index is saved in the rom-properties
+ * cache directory, keyed by the file's identity. It's saved once
+ * the end of the file is reached, or when the reader is closed
+ * if new seek points were added.
+ */
+class GzIndexReaderPrivate;
+class GzIndexReader
+{
+	public:
+		/**
+		 * Open a gzip-compressed file.
+		 * The file is ref()'d, so the original file can be
+		 * unref()'d by the caller afterwards.
+		 * @param file		[in] Compressed file.
+		 * @param filename	[in,opt] Filename, for the index cache.
+		 */
+		explicit GzIndexReader(IRpFile *file, const char *filename = nullptr);
+
+		/**
+		 * Open a raw deflate stream, e.g. a ZIP archive member.
+		 * The index cache is not used for raw deflate streams.
+		 * The file is ref()'d, so the original file can be
+		 * unref()'d by the caller afterwards.
+		 * @param file		[in] File containing the deflate stream.
+		 * @param offset	[in] Starting offset of the deflate stream.
+		 * @param compSize	[in] Compressed size.
+		 * @param uncompSize	[in] Uncompressed size.
+		 */
+		GzIndexReader(IRpFile *file, off64_t offset, off64_t compSize, off64_t uncompSize);
+
+		~GzIndexReader();
+
+	private:
+		RP_DISABLE_COPY(GzIndexReader)
+	private:
+		friend class GzIndexReaderPrivate;
+		GzIndexReaderPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the file open?
+		 * This returns false if the file doesn't have a valid gzip header.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const;
+
+		/**
+		 * Get the last error.
+		 * @return Last POSIX error, or 0 if no error.
+		 */
+		int lastError(void) const;
+
+		/**
+		 * Get the uncompressed size.
+		 *
+		 * If the exact size isn't known yet, it's estimated using the
+		 * ISIZE field in the gzip trailer, so nothing is decompressed.
+		 * ISIZE is only used if the compressed data is too small for
+		 * the uncompressed data to reach 4 GiB; otherwise, the file
+		 * is decompressed in order to determine the exact size.
+		 * NOTE: For files with multiple gzip members, the estimate
+		 * only includes the last member. It's discarded as soon as
+		 * another member is found while decompressing.
+		 *
+		 * @return Uncompressed size, or -1 on error.
+		 */
+		off64_t size(void);
+
+		/**
+		 * Get the exact uncompressed size.
+		 * If it isn't known yet, the rest of the file will be
+		 * decompressed in order to determine it.
+		 * @return Uncompressed size, or -1 on error.
+		 */
+		off64_t exactSize(void);
+
+		/**
+		 * Read uncompressed data from the specified position.
+		 * This function is thread-safe.
+		 * @param pos	[in] Uncompressed position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size);
+
+	public:
+		/**
+		 * Enable or disable the seek point index cache.
+		 * The index cache is disabled by default.
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setCacheEnabled(bool enabled);
+
+		/**
+		 * Is the seek point index cache enabled?
+		 * @return True if enabled; false if not.
+		 */
+		static bool isCacheEnabled(void);
+
+		/**
+		 * Set the seek point index cache directory.
+		 * @param dir Cache directory. (If empty, the gzindex subdirectory of the cache directory is used.)
+		 */
+		static void setCacheDirectory(const std::string &dir);
+
+		/**
+		 * Get the seek point index cache filename for a gzip-compressed file.
+		 * @param filename Compressed filename.
+		 * @return Index cache filename, or empty string on error.
+		 */
+		static std::string getCacheFilename(const std::string &filename);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_FILE_GZINDEXREADER_HPP__ */
@@ -53,6 +53,38 @@ void IRpFile::unref(void)
 	ATOMIC_DEC_FETCH(&ms_refCntTotal);
 }
 
+/**
+ * Read data from the file at the specified position.
+ *
+ * The default implementation saves the file position, calls
+ * seek() and read(), and then restores the file position.
+ * It is *not* thread-safe.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IRpFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+	if (prev_pos < 0) {
+		// tell() error.
+		return 0;
+	}
+
+	size_t ret = 0;
+	if (this->seek(pos) == 0) {
+		ret = this->read(ptr, size);
+	}
+
+	// Restore the file position.
+	const int lastError = m_lastError;
+	this->seek(prev_pos);
+	m_lastError = lastError;
+	return ret;
+}
+
 /**
  * Get a single character (byte) from the file
  * @return Character from file, or EOF on end of file or error.
@@ -105,4 +137,35 @@ size_t IRpFile::seekAndRead(off64_t pos, void *ptr, size_t size)
 	return this->read(ptr, size);
 }
 
+/**
+ * Get a read-only view of part of the file.
+ *
+ * If map() is supported and the mapped data is suitably
+ * aligned for structs, the mapped data is returned directly.
+ * Otherwise, the data is read into buf.
+ *
+ * The returned pointer is valid until buf is modified
+ * or the file is closed, whichever comes first.
+ *
+ * NOTE: The file position is undefined afterwards.
+ *
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @param buf	[out] Fallback buffer.
+ * @return Pointer to the data, or nullptr on seek or read error.
+ */
+const uint8_t *IRpFile::mapOrRead(off64_t pos, size_t size, ao::uvector<uint8_t> &buf)
+{
+	const uint8_t *const p = this->map(pos, size);
+	if (p && (reinterpret_cast<uintptr_t>(p) % sizeof(uint32_t)) == 0) {
+		// Mapped data is available.
+		return p;
+	}
+
+	// Read the data into the fallback buffer.
+	buf.resize(size);
+	size_t sz_read = seekAndRead(pos, buf.data(), size);
+	return (sz_read == size ? buf.data() : nullptr);
+}
+
 }
@@ -10,6 +10,7 @@
 #define __ROMPROPERTIES_LIBRPBASE_IRPFILE_HPP__
 
 #include "../common.h"
+#include "../uvector.h"
 
 // C includes.
 #include <stdint.h>
@@ -83,6 +84,25 @@ class IRpFile
 		 */
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the file at the specified position.
+		 *
+		 * Unlike seekAndRead(), this does not change the file position.
+		 * Subclasses that can read without a shared file position,
+		 * e.g. RpMemFile and RpFile on regular files, override this
+		 * function so it can be called from multiple threads at once.
+		 *
+		 * The default implementation saves the file position, calls
+		 * seek() and read(), and then restores the file position.
+		 * It is *not* thread-safe.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		virtual size_t pread(off64_t pos, void *ptr, size_t size);
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -147,6 +167,59 @@ class IRpFile
 			return false;
 		}
 
+	public:
+		/**
+		 * Get a read-only view of part of the file without copying it.
+		 *
+		 * The returned pointer is owned by the file object and remains
+		 * valid until the file is closed or destroyed. The file position
+		 * is not changed.
+		 *
+		 * The default implementation returns nullptr. Callers must
+		 * fall back to read() if this function returns nullptr.
+		 * See mapOrRead() for a wrapper that does this.
+		 *
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the view, in bytes.
+		 * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+		 */
+		virtual const uint8_t *map(off64_t pos, size_t size)
+		{
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return nullptr;
+		}
+
+		// Access pattern hints.
+		enum AccessHint : uint8_t {
+			AH_NORMAL	= 0,	// No particular access pattern. (default)
+			AH_SEQUENTIAL	= 1,	// Data will be read sequentially.
+			AH_RANDOM	= 2,	// Data will be read in random order.
+			AH_WILLNEED	= 3,	// Data will be needed soon.
+		};
+
+		/**
+		 * Tell the file how it's going to be read.
+		 *
+		 * This is only a hint. It may be used to adjust read-ahead
+		 * or to start reading data in the background, but it never
+		 * changes the result of a read.
+		 *
+		 * The default implementation ignores the hint.
+		 *
+		 * @param hint	[in] Access pattern hint.
+		 * @param pos	[in,opt] Starting address of the affected range.
+		 * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+		 * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+		 */
+		virtual int setAccessHint(AccessHint hint, off64_t pos = 0, off64_t size = 0)
+		{
+			RP_UNUSED(hint);
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return 0;
+		}
+
 	public:
 		/** Convenience functions implemented for all IRpFile classes. **/
 
@@ -177,6 +250,25 @@ class IRpFile
 		 */
 		size_t seekAndRead(off64_t pos, void *ptr, size_t size);
 
+		/**
+		 * Get a read-only view of part of the file.
+		 *
+		 * If map() is supported and the mapped data is suitably
+		 * aligned for structs, the mapped data is returned directly.
+		 * Otherwise, the data is read into buf.
+		 *
+		 * The returned pointer is valid until buf is modified
+		 * or the file is closed, whichever comes first.
+		 *
+		 * NOTE: The file position is undefined afterwards.
+		 *
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the view, in bytes.
+		 * @param buf	[out] Fallback buffer.
+		 * @return Pointer to the data, or nullptr on seek or read error.
+		 */
+		const uint8_t *mapOrRead(off64_t pos, size_t size, ao::uvector<uint8_t> &buf);
+
 	protected:
 		int m_lastError;
 	private:
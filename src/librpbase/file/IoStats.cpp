@@ -0,0 +1,126 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * IoStats.cpp: I/O statistics for file and disc reader layers.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "IoStats.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ STL classes.
+using std::vector;
+
+// Thread-local storage.
+// NOTE: C++11 thread_local isn't supported on older MSVC and macOS.
+#ifdef _MSC_VER
+# define IOSTATS_TLS __declspec(thread)
+#else
+# define IOSTATS_TLS __thread
+#endif
+
+namespace LibRpBase {
+
+bool IoStats::s_enabled = false;
+
+// Registered layers.
+// NOTE: Layers are registered during static initialization,
+// so this must not have a constructor.
+static IoStats::Layer *s_layers = nullptr;
+
+// Mutex for the layer counters.
+static Mutex s_mutex;
+
+// Read nesting depth for the current thread.
+// Reads made at depth 0 are made by the parser.
+static IOSTATS_TLS unsigned int s_depth = 0;
+
+/** IoStats::Layer **/
+
+/**
+ * Register a reader layer.
+ * @param name Layer name. (must be a string literal)
+ */
+IoStats::Layer::Layer(const char *name)
+	: name(name)
+	, next(nullptr)
+	, reads(0)
+	, bytesRead(0)
+	, seeks(0)
+	, consumed(0)
+{
+	// Append the layer to the list so the
+	// registration order is preserved.
+	Layer **pp = &s_layers;
+	while (*pp) {
+		pp = &(*pp)->next;
+	}
+	*pp = this;
+}
+
+/** IoStats::ReadScope **/
+
+void IoStats::ReadScope::enter(void)
+{
+	m_top = (s_depth == 0);
+	s_depth++;
+}
+
+void IoStats::ReadScope::leave(void)
+{
+	s_depth--;
+
+	MutexLocker mutexLocker(s_mutex);
+	m_layer->reads++;
+	m_layer->bytesRead += m_bytes;
+	if (m_top) {
+		m_layer->consumed += m_bytes;
+	}
+}
+
+/** IoStats **/
+
+void IoStats::countSeek(Layer &layer)
+{
+	MutexLocker mutexLocker(s_mutex);
+	layer.seeks++;
+}
+
+/**
+ * Enable or disable I/O statistics.
+ * This should be set before any files are opened.
+ * @param enabled True to enable; false to disable.
+ */
+void IoStats::setEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+/**
+ * Get a snapshot of all layers' statistics.
+ * Layers are always returned in the same order, so
+ * two snapshots can be subtracted to get the I/O
+ * done in between.
+ * @param stats [out] Layer statistics.
+ */
+void IoStats::snapshot(vector<LayerStats> &stats)
+{
+	stats.clear();
+
+	MutexLocker mutexLocker(s_mutex);
+	for (const Layer *layer = s_layers; layer != nullptr; layer = layer->next) {
+		LayerStats ls;
+		ls.name = layer->name;
+		ls.reads = layer->reads;
+		ls.bytesRead = layer->bytesRead;
+		ls.seeks = layer->seeks;
+		ls.consumed = layer->consumed;
+		stats.push_back(ls);
+	}
+}
+
+}
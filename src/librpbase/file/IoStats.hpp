@@ -0,0 +1,177 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * IoStats.hpp: I/O statistics for file and disc reader layers.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_FILE_IOSTATS_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_FILE_IOSTATS_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes.
+#include <vector>
+
+namespace LibRpBase {
+
+/**
+ * I/O statistics.
+ *
+ * Each reader class (RpFile, CachedRpFile, WbfsReader, WiiPartition,
+ * PartitionFile, etc.) has a static IoStats::Layer object that counts
+ * read() and pread() calls, bytes read, and seek() calls.
+ *
+ * Reads are "consumed" if they weren't made by another instrumented
+ * layer, i.e. the parser requested the data directly. Comparing the
+ * consumed bytes to the bytes read from the lowest layer shows how
+ * much data was read just to get to the data the parser wanted.
+ *
+ * Statistics are disabled by default. When disabled, the only
+ * cost is a check of a global flag on each read or seek.
+ */
+class IoStats
+{
+	private:
+		IoStats();
+		~IoStats();
+	private:
+		RP_DISABLE_COPY(IoStats)
+
+	public:
+		/**
+		 * Reader layer.
+		 * This should be declared as a static object in the
+		 * reader class's .cpp file.
+		 */
+		class Layer
+		{
+			public:
+				/**
+				 * Register a reader layer.
+				 * @param name Layer name. (must be a string literal)
+				 */
+				explicit Layer(const char *name);
+
+			private:
+				RP_DISABLE_COPY(Layer)
+				friend class IoStats;
+
+				const char *const name;
+				Layer *next;
+
+				// Counters. (protected by the IoStats mutex)
+				uint64_t reads;		// read() and pread() calls
+				uint64_t bytesRead;	// Bytes returned by read() and pread()
+				uint64_t seeks;		// seek() calls
+				uint64_t consumed;	// Bytes returned to non-layer callers
+		};
+
+		/**
+		 * Statistics for a single layer.
+		 */
+		struct LayerStats {
+			const char *name;
+			uint64_t reads;
+			uint64_t bytesRead;
+			uint64_t seeks;
+			uint64_t consumed;
+		};
+
+		/**
+		 * Read scope.
+		 * Create one at the start of a read() or pread() function,
+		 * and use done() to specify the number of bytes read.
+		 * If done() isn't called, the read is counted with 0 bytes.
+		 */
+		class ReadScope
+		{
+			public:
+				inline explicit ReadScope(Layer &layer)
+					: m_layer(s_enabled ? &layer : nullptr)
+					, m_bytes(0)
+				{
+					if (m_layer) {
+						enter();
+					}
+				}
+
+				inline ~ReadScope()
+				{
+					if (m_layer) {
+						leave();
+					}
+				}
+
+				/**
+				 * Set the number of bytes read.
+				 * @param bytes Number of bytes read.
+				 * @return bytes
+				 */
+				inline size_t done(size_t bytes)
+				{
+					m_bytes = bytes;
+					return bytes;
+				}
+
+			private:
+				RP_DISABLE_COPY(ReadScope)
+
+				void enter(void);
+				void leave(void);
+
+				Layer *const m_layer;
+				size_t m_bytes;
+				bool m_top;
+		};
+
+		/**
+		 * Count a seek() call.
+		 * @param layer Layer.
+		 */
+		static inline void seek(Layer &layer)
+		{
+			if (s_enabled) {
+				countSeek(layer);
+			}
+		}
+
+		/**
+		 * Are I/O statistics enabled?
+		 * @return True if enabled; false if not.
+		 */
+		static inline bool isEnabled(void)
+		{
+			return s_enabled;
+		}
+
+		/**
+		 * Enable or disable I/O statistics.
+		 * This should be set before any files are opened.
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setEnabled(bool enabled);
+
+		/**
+		 * Get a snapshot of all layers' statistics.
+		 * Layers are always returned in the same order, so
+		 * two snapshots can be subtracted to get the I/O
+		 * done in between.
+		 * @param stats [out] Layer statistics.
+		 */
+		static void snapshot(std::vector<LayerStats> &stats);
+
+	private:
+		static void countSeek(Layer &layer);
+
+		static bool s_enabled;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_FILE_IOSTATS_HPP__ */
@@ -64,6 +64,7 @@ class RpFile : public IRpFile
 		RP_DISABLE_COPY(RpFile)
 	protected:
 		friend class RpFilePrivate;
+		friend class AsyncReaderPrivate;	// needs the native file descriptor
 		RpFilePrivate *const d_ptr;
 
 	public:
@@ -87,6 +88,20 @@ class RpFile : public IRpFile
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 *
+		 * This does not change the file position. For regular files,
+		 * this is thread-safe. Device files and gzip-compressed files
+		 * use the default seek() and read() implementation.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -130,6 +145,76 @@ class RpFile : public IRpFile
 		 */
 		std::string filename(void) const final;
 
+	public:
+		/**
+		 * Get a read-only view of part of the file without copying it.
+		 *
+		 * Only the requested range (rounded to the mapping granularity)
+		 * is memory-mapped. Views remain mapped until the file is closed
+		 * and are reused for later requests within the same range.
+		 * This is only supported for regular files opened with
+		 * FM_OPEN_READ that are not using transparent gzip decompression.
+		 *
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the view, in bytes.
+		 * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+		 */
+		const uint8_t *map(off64_t pos, size_t size) final;
+
+		/**
+		 * Tell the file how it's going to be read.
+		 *
+		 * On systems with posix_fadvise(), this adjusts the kernel's
+		 * read-ahead for the file, or starts reading the specified
+		 * range in the background for AH_WILLNEED.
+		 *
+		 * Hints are ignored for files using transparent gzip
+		 * decompression, since the range refers to uncompressed data.
+		 *
+		 * @param hint	[in] Access pattern hint.
+		 * @param pos	[in,opt] Starting address of the affected range.
+		 * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+		 * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+		 */
+		int setAccessHint(AccessHint hint, off64_t pos = 0, off64_t size = 0) final;
+
+	public:
+		/**
+		 * Lock the file for exclusive access.
+		 *
+		 * This is an advisory lock that only affects other processes
+		 * that also lock the file. If another process holds the lock,
+		 * this function blocks until it's released.
+		 *
+		 * NOTE: The lock is per-process. Threads in the same process
+		 * must use their own synchronization.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int lock(void);
+
+		/**
+		 * Unlock the file.
+		 * Pending writes are flushed before the lock is released.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int unlock(void);
+
+	public:
+		/**
+		 * Enable or disable the gzip seek point index cache.
+		 *
+		 * If enabled, the seek point index for files opened with
+		 * FM_OPEN_READ_GZ is saved in the rom-properties cache
+		 * directory once the file has been fully decompressed,
+		 * and it's reused if the file hasn't changed.
+		 *
+		 * The gzip index cache is disabled by default.
+		 *
+		 * @param enabled True to enable; false to disable.
+		 */
+		static void setGzIndexCacheEnabled(bool enabled);
+
 	public:
 		/** Device file functions **/
 
@@ -21,17 +21,8 @@
 using std::string;
 using std::vector;
 
-// zlib for transparent gzip decompression.
-#include <zlib.h>
-// gzclose_r() and gzclose_w() were introduced in zlib-1.2.4.
-#if (ZLIB_VER_MAJOR > 1) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR > 2) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR == 2 && ZLIB_VER_REVISION >= 4)
-// zlib-1.2.4 or later
-#else
-# define gzclose_r(file) gzclose(file)
-# define gzclose_w(file) gzclose(file)
-#endif
+// Transparent gzip decompression.
+#include "GzIndexReader.hpp"
 
 #ifdef _WIN32
 // Windows SDK
@@ -75,10 +66,20 @@ class RpFilePrivate
 
 		RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode mode)
 			: q_ptr(q), file(FILE_INIT), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzpos(0), devInfo(nullptr)
+			, mapFailed(false)
+#ifdef _WIN32
+			, hMapping(nullptr)
+#endif /* _WIN32 */
+			{ }
 		RpFilePrivate(RpFile *q, const string &filename, RpFile::FileMode mode)
 			: q_ptr(q), file(FILE_INIT), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzpos(0), devInfo(nullptr)
+			, mapFailed(false)
+#ifdef _WIN32
+			, hMapping(nullptr)
+#endif /* _WIN32 */
+			{ }
 		~RpFilePrivate();
 
 	private:
@@ -90,8 +91,8 @@ class RpFilePrivate
 		string filename;	// Filename.
 		RpFile::FileMode mode;	// File mode.
 
-		gzFile gzfd;		// Used for transparent gzip decompression.
-		off64_t gzsz;		// Uncompressed file size.
+		GzIndexReader *gzReader;	// Used for transparent gzip decompression.
+		off64_t gzpos;		// Uncompressed file position.
 
 		// Device information struct.
 		// Only used if the underlying file
@@ -169,6 +170,61 @@ class RpFilePrivate
 
 		DeviceInfo *devInfo;
 
+		// Memory-mapped views of the file.
+		// Each RpFile::map() call that isn't covered by an existing
+		// view maps only the requested range. Views are kept until
+		// the file is closed, since callers may still be using them.
+		struct MapView {
+			uint8_t *addr;	// Mapped address. (aligned to the mapping granularity)
+			off64_t pos;	// File offset of addr.
+			size_t size;	// Mapped size.
+		};
+		vector<MapView> mapViews;
+		bool mapFailed;		// True if the file can't be mapped. (Don't retry.)
+#ifdef _WIN32
+		HANDLE hMapping;	// File mapping object.
+#endif /* _WIN32 */
+
+		// Maximum view size for map().
+		// 32-bit systems don't have enough address
+		// space to map large parts of disc images.
+		static const off64_t MAP_MAX_SIZE = (sizeof(void*) >= 8
+			? (1LL << 40)
+			: (256LL * 1024 * 1024));
+
+		/**
+		 * Find a mapped view containing the specified range.
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the range, in bytes.
+		 * @return Pointer to the data, or nullptr if no view contains the range.
+		 */
+		inline const uint8_t *findMapView(off64_t pos, size_t size) const
+		{
+			for (auto iter = mapViews.cbegin(); iter != mapViews.cend(); ++iter) {
+				if (pos >= iter->pos &&
+				    static_cast<uint64_t>(pos - iter->pos) + size <= iter->size)
+				{
+					return iter->addr + static_cast<size_t>(pos - iter->pos);
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		 * Can this file be mapped with map()?
+		 * @return True if it can; false if not.
+		 */
+		inline bool canMap(void) const
+		{
+			return (!mapFailed && !gzReader && !devInfo &&
+				(mode & RpFile::FM_MODE_MASK) == RpFile::FM_OPEN_READ);
+		}
+
+		/**
+		 * Unmap all mapped views of the file.
+		 */
+		void unmapFile(void);
+
 	public:
 #ifdef _WIN32
 		/**
@@ -195,7 +251,7 @@ class RpFilePrivate
 		/**
 		 * (Re-)Open the main file.
 		 *
-		 * INTERNAL FUNCTION. This does NOT affect gzfd.
+		 * INTERNAL FUNCTION. This does NOT affect gzReader.
 		 * NOTE: This function sets q->m_lastError.
 		 *
 		 * Uses parameters stored in this->filename and this->mode.
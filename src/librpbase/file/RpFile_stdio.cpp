@@ -15,26 +15,43 @@
 
 #include "RpFile.hpp"
 #include "RpFile_p.hpp"
+#include "IoStats.hpp"
 
 // C includes.
+#include <fcntl.h>	// posix_fadvise()
+#include <sys/file.h>	// flock()
+#include <sys/mman.h>	// mmap(), posix_madvise()
 #include <sys/stat.h>
-#include <unistd.h>	// ftruncate()
+#include <unistd.h>	// ftruncate(), pread()
 
 namespace LibRpBase {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("RpFile");
+
 /** RpFilePrivate **/
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd) {
-		gzclose_r(gzfd);
-	}
+	unmapFile();
+	delete gzReader;
 	if (file) {
 		fclose(file);
 	}
 	delete devInfo;
 }
 
+/**
+ * Unmap all mapped views of the file.
+ */
+void RpFilePrivate::unmapFile(void)
+{
+	for (auto iter = mapViews.cbegin(); iter != mapViews.cend(); ++iter) {
+		munmap(iter->addr, iter->size);
+	}
+	mapViews.clear();
+}
+
 /**
  * Convert an RpFile::FileMode to an fopen() mode string.
  * @param mode	[in] FileMode
@@ -59,7 +76,7 @@ inline const char *RpFilePrivate::mode_to_str(RpFile::FileMode mode)
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -234,47 +251,24 @@ void RpFile::init(void)
 		size_t size = fread(&gzmagic, 1, sizeof(gzmagic), d->file);
 		if (size == sizeof(gzmagic) && gzmagic == be16_to_cpu(0x1F8B)) {
 			// This is a gzipped file.
-			// Get the uncompressed size at the end of the file.
-			fseeko(d->file, 0, SEEK_END);
-			off64_t real_sz = ftello(d->file);
-			if (real_sz > 10+8) {
-				int ret = fseeko(d->file, real_sz-4, SEEK_SET);
-				if (!ret) {
-					uint32_t uncomp_sz;
-					size = fread(&uncomp_sz, 1, sizeof(uncomp_sz), d->file);
-					uncomp_sz = le32_to_cpu(uncomp_sz);
-					if (size == sizeof(uncomp_sz) /*&& uncomp_sz >= real_sz-(10+8)*/) {
-						// NOTE: Uncompressed size might be smaller than the real filesize
-						// in cases where gzip doesn't help much.
-						// TODO: Add better verification heuristics?
-						d->gzsz = (off64_t)uncomp_sz;
-
-						// Make sure the CRC32 table is initialized.
-						get_crc_table();
-
-						// Open the file with gzdopen().
-						::rewind(d->file);
-						::fflush(d->file);
-						int gzfd_dup = ::dup(fileno(d->file));
-						if (gzfd_dup >= 0) {
-							d->gzfd = gzdopen(gzfd_dup, "r");
-							if (!d->gzfd) {
-								// gzdopen() failed.
-								// Close the dup()'d handle to prevent a leak.
-								::close(gzfd_dup);
-							}
-						}
-					}
+			// Open a second handle for the compressed data.
+			// NOTE: The uncompressed size is determined by GzIndexReader,
+			// since ISIZE is only the lower 32 bits of the last member.
+			RpFile *const gzRawFile = new RpFile(d->filename, FM_OPEN_READ);
+			if (gzRawFile->isOpen()) {
+				d->gzReader = new GzIndexReader(gzRawFile, d->filename.c_str());
+				if (!d->gzReader->isOpen()) {
+					// Not a valid gzip header.
+					delete d->gzReader;
+					d->gzReader = nullptr;
 				}
 			}
+			gzRawFile->unref();
 		}
 
-		if (!d->gzfd) {
-			// Not a gzipped file.
-			// Rewind and flush the file.
-			::rewind(d->file);
-			::fflush(d->file);
-		}
+		// Rewind and flush the file.
+		::rewind(d->file);
+		::fflush(d->file);
 	}
 }
 
@@ -309,10 +303,9 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
-	}
+	d->unmapFile();
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file) {
 		fclose(d->file);
 		d->file = nullptr;
@@ -327,6 +320,7 @@ void RpFile::close(void)
  */
 size_t RpFile::read(void *ptr, size_t size)
 {
+	IoStats::ReadScope ioScope(ioLayer);
 	RP_D(RpFile);
 	if (!d->file) {
 		m_lastError = EBADF;
@@ -335,18 +329,16 @@ size_t RpFile::read(void *ptr, size_t size)
 
 	if (d->devInfo) {
 		// Block device. Need to read in multiples of the block size.
-		return d->readUsingBlocks(ptr, size);
+		return ioScope.done(d->readUsingBlocks(ptr, size));
 	}
 
 	size_t ret;
-	if (d->gzfd) {
-		int iret = gzread(d->gzfd, ptr, size);
-		if (iret >= 0) {
-			ret = (size_t)iret;
-		} else {
+	if (d->gzReader) {
+		ret = d->gzReader->pread(d->gzpos, ptr, size);
+		d->gzpos += ret;
+		if (ret != size && d->gzReader->lastError() != 0) {
 			// An error occurred.
-			ret = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		ret = fread(ptr, 1, size, d->file);
@@ -355,7 +347,79 @@ size_t RpFile::read(void *ptr, size_t size)
 			m_lastError = errno;
 		}
 	}
-	return ret;
+	return ioScope.done(ret);
+}
+
+/**
+ * Read data from the file at the specified position.
+ *
+ * This does not change the file position. For regular files,
+ * this is thread-safe. Device files use the default seek()
+ * and read() implementation.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (d->devInfo) {
+		// Block devices need to use the file position.
+		return ioScope.done(super::pread(pos, ptr, size));
+	}
+
+	if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (d->gzReader) {
+		// gzip-compressed file.
+		// GzIndexReader::pread() is thread-safe.
+		const size_t ret = d->gzReader->pread(pos, ptr, size);
+		if (ret != size && d->gzReader->lastError() != 0) {
+			m_lastError = d->gzReader->lastError();
+		}
+		return ioScope.done(ret);
+	}
+
+	if (d->mode & FM_WRITE) {
+		// Make sure buffered writes are visible to pread().
+		fflush(d->file);
+	}
+
+	const int fd = fileno(d->file);
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const ssize_t sz_read = ::pread(fd, ptr8, size, pos);
+		if (sz_read < 0) {
+			if (errno == EINTR) {
+				// Interrupted. Try again.
+				continue;
+			}
+			// An error occurred.
+			m_lastError = errno;
+			break;
+		} else if (sz_read == 0) {
+			// End of file.
+			break;
+		}
+
+		ptr8 += sz_read;
+		pos += sz_read;
+		size -= static_cast<size_t>(sz_read);
+		ret += static_cast<size_t>(sz_read);
+	}
+	return ioScope.done(ret);
 }
 
 /**
@@ -389,6 +453,7 @@ size_t RpFile::write(const void *ptr, size_t size)
  */
 int RpFile::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	RP_D(RpFile);
 	if (!d->file) {
 		m_lastError = EBADF;
@@ -409,21 +474,19 @@ int RpFile::seek(off64_t pos)
 		return 0;
 	}
 
-	int ret;
-	if (d->gzfd) {
-		z_off_t zret = gzseek(d->gzfd, pos, SEEK_SET);
-		if (zret >= 0) {
-			ret = 0;
-		} else {
-			// TODO: Does gzseek() set errno?
-			ret = -1;
-			m_lastError = -EIO;
-		}
-	} else {
-		ret = fseeko(d->file, pos, SEEK_SET);
-		if (ret != 0) {
-			m_lastError = errno;
+	if (d->gzReader) {
+		// Seeking is done in GzIndexReader::pread().
+		if (pos < 0) {
+			m_lastError = EINVAL;
+			return -1;
 		}
+		d->gzpos = pos;
+		return 0;
+	}
+
+	int ret = fseeko(d->file, pos, SEEK_SET);
+	if (ret != 0) {
+		m_lastError = errno;
 	}
 	::fflush(d->file);	// needed for some things like gzip
 	return ret;
@@ -441,8 +504,8 @@ off64_t RpFile::tell(void)
 		return -1;
 	}
 
-	if (d->gzfd) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->gzReader) {
+		return d->gzpos;
 	}
 	return ftello(d->file);
 }
@@ -513,10 +576,11 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd) {
-		// gzipped files have the uncompressed size stored
-		// at the end of the stream.
-		return d->gzsz;
+	} else if (d->gzReader) {
+		// gzipped files: The uncompressed size is estimated
+		// using the gzip trailer until the file has been fully
+		// decompressed. This doesn't decompress anything.
+		return d->gzReader->size();
 	}
 
 	// Save the current position.
@@ -543,6 +607,226 @@ string RpFile::filename(void) const
 	return d->filename;
 }
 
+/**
+ * Get a read-only view of part of the file without copying it.
+ *
+ * Only the requested range (rounded to the mapping granularity)
+ * is memory-mapped. Views remain mapped until the file is closed
+ * and are reused for later requests within the same range.
+ * This is only supported for regular files opened with
+ * FM_OPEN_READ that are not using transparent gzip decompression.
+ *
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+ */
+const uint8_t *RpFile::map(off64_t pos, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	if (!d->canMap()) {
+		// Mapping isn't supported for this file.
+		return nullptr;
+	}
+	if (pos < 0 || size == 0 || static_cast<off64_t>(size) > RpFilePrivate::MAP_MAX_SIZE) {
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	// Check for an existing view.
+	const uint8_t *const p = d->findMapView(pos, size);
+	if (p) {
+		return p;
+	}
+
+	const int fd = fileno(d->file);
+	struct stat sbuf;
+	if (fstat(fd, &sbuf) != 0 || !S_ISREG(sbuf.st_mode)) {
+		// Not a regular file.
+		// NOTE: We won't try again.
+		d->mapFailed = true;
+		return nullptr;
+	}
+	if (static_cast<uint64_t>(pos) + size > static_cast<uint64_t>(sbuf.st_size)) {
+		// Out of range.
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	// Map the requested range.
+	// NOTE: mmap() requires a page-aligned offset.
+	const off64_t pageMask = static_cast<off64_t>(sysconf(_SC_PAGESIZE)) - 1;
+	RpFilePrivate::MapView view;
+	view.pos = pos & ~pageMask;
+	view.size = static_cast<size_t>(pos - view.pos) + size;
+	void *const addr = mmap(nullptr, view.size, PROT_READ, MAP_PRIVATE, fd, view.pos);
+	if (addr == MAP_FAILED) {
+		m_lastError = errno;
+		return nullptr;
+	}
+	view.addr = static_cast<uint8_t*>(addr);
+	d->mapViews.push_back(view);
+	return view.addr + static_cast<size_t>(pos - view.pos);
+}
+
+/**
+ * Tell the file how it's going to be read.
+ *
+ * On systems with posix_fadvise(), this adjusts the kernel's
+ * read-ahead for the file, or starts reading the specified
+ * range in the background for AH_WILLNEED.
+ *
+ * Hints are ignored for files using transparent gzip
+ * decompression, since the range refers to uncompressed data.
+ *
+ * @param hint	[in] Access pattern hint.
+ * @param pos	[in,opt] Starting address of the affected range.
+ * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+ * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+ */
+int RpFile::setAccessHint(AccessHint hint, off64_t pos, off64_t size)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	} else if (pos < 0 || size < 0) {
+		m_lastError = EINVAL;
+		return -m_lastError;
+	}
+
+	if (d->gzReader) {
+		// GzIndexReader always reads the compressed data
+		// sequentially, and the range can't be mapped to
+		// the compressed data.
+		return 0;
+	}
+
+#ifdef HAVE_POSIX_FADVISE
+	int advice;
+	switch (hint) {
+		case AH_NORMAL:		advice = POSIX_FADV_NORMAL;	break;
+		case AH_SEQUENTIAL:	advice = POSIX_FADV_SEQUENTIAL;	break;
+		case AH_RANDOM:		advice = POSIX_FADV_RANDOM;	break;
+		case AH_WILLNEED:	advice = POSIX_FADV_WILLNEED;	break;
+		default:
+			assert(!"Invalid access hint.");
+			m_lastError = EINVAL;
+			return -m_lastError;
+	}
+
+	// NOTE: posix_fadvise() returns the error code instead of setting errno.
+	const int ret = posix_fadvise(fileno(d->file), pos, size, advice);
+	if (ret != 0) {
+		m_lastError = ret;
+		return -m_lastError;
+	}
+
+# ifdef HAVE_POSIX_MADVISE
+	if (!d->mapViews.empty()) {
+		// The file is memory-mapped, so page faults on the mapped
+		// views use the mapping's read-ahead setting, not the file's.
+		// NOTE: posix_madvise() requires a page-aligned address.
+		const off64_t pageMask = static_cast<off64_t>(sysconf(_SC_PAGESIZE)) - 1;
+		int madv;
+		switch (hint) {
+			default:
+			case AH_NORMAL:		madv = POSIX_MADV_NORMAL;	break;
+			case AH_SEQUENTIAL:	madv = POSIX_MADV_SEQUENTIAL;	break;
+			case AH_RANDOM:		madv = POSIX_MADV_RANDOM;	break;
+			case AH_WILLNEED:	madv = POSIX_MADV_WILLNEED;	break;
+		}
+		for (auto iter = d->mapViews.cbegin(); iter != d->mapViews.cend(); ++iter) {
+			const off64_t viewEnd = iter->pos + static_cast<off64_t>(iter->size);
+			const off64_t start = std::max(pos & ~pageMask, iter->pos);
+			const off64_t end = (size > 0 ? std::min(pos + size, viewEnd) : viewEnd);
+			if (start >= end) {
+				// Not in this view.
+				continue;
+			}
+			// Errors are ignored here, since the hint
+			// was already applied to the file itself.
+			posix_madvise(iter->addr + static_cast<size_t>(start - iter->pos),
+				static_cast<size_t>(end - start), madv);
+		}
+	}
+# endif /* HAVE_POSIX_MADVISE */
+#else /* !HAVE_POSIX_FADVISE */
+	// Hints aren't supported on this system.
+	RP_UNUSED(hint);
+#endif /* HAVE_POSIX_FADVISE */
+	return 0;
+}
+
+/**
+ * Lock the file for exclusive access.
+ *
+ * This is an advisory lock that only affects other processes
+ * that also lock the file. If another process holds the lock,
+ * this function blocks until it's released.
+ *
+ * NOTE: The lock is per-process. Threads in the same process
+ * must use their own synchronization.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::lock(void)
+{
+	RP_D(RpFile);
+	if (!d->file || d->devInfo || d->gzReader) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	if (flock(fileno(d->file), LOCK_EX) != 0) {
+		m_lastError = errno;
+		return -m_lastError;
+	}
+	return 0;
+}
+
+/**
+ * Unlock the file.
+ * Pending writes are flushed before the lock is released.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::unlock(void)
+{
+	RP_D(RpFile);
+	if (!d->file || d->devInfo || d->gzReader) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	::fflush(d->file);
+	if (flock(fileno(d->file), LOCK_UN) != 0) {
+		m_lastError = errno;
+		return -m_lastError;
+	}
+	return 0;
+}
+
+/**
+ * Enable or disable the gzip seek point index cache.
+ *
+ * If enabled, the seek point index for files opened with
+ * FM_OPEN_READ_GZ is saved in the rom-properties cache
+ * directory once the file has been fully decompressed,
+ * and it's reused if the file hasn't changed.
+ *
+ * The gzip index cache is disabled by default.
+ *
+ * @param enabled True to enable; false to disable.
+ */
+void RpFile::setGzIndexCacheEnabled(bool enabled)
+{
+	GzIndexReader::setCacheEnabled(enabled);
+}
+
 /** Device file functions **/
 
 /**
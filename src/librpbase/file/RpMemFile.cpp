@@ -102,6 +102,42 @@ size_t RpMemFile::read(void *ptr, size_t size)
 	return size;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * This does not change the file position, and it's thread-safe.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpMemFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (unlikely(size == 0) || static_cast<uint64_t>(pos) >= m_size) {
+		// Not reading anything...
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	if (size > m_size - static_cast<size_t>(pos)) {
+		// Not enough data.
+		// Copy whatever's left in the buffer.
+		size = m_size - static_cast<size_t>(pos);
+	}
+
+	// Copy the data.
+	const uint8_t *const buf = static_cast<const uint8_t*>(m_buf);
+	memcpy(ptr, &buf[static_cast<size_t>(pos)], size);
+	return size;
+}
+
 /**
  * Write data to the file.
  * (NOTE: Not valid for RpMemFile; this will always return 0.)
@@ -198,4 +234,25 @@ string RpMemFile::filename(void) const
 	return string();
 }
 
+/**
+ * Get a read-only view of part of the file without copying it.
+ * This returns a pointer into the memory buffer.
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @return Pointer to the data, or nullptr if the range is out of bounds.
+ */
+const uint8_t *RpMemFile::map(off64_t pos, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return nullptr;
+	} else if (pos < 0 || static_cast<uint64_t>(pos) > m_size || size > m_size - static_cast<size_t>(pos)) {
+		// Out of range.
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	return static_cast<const uint8_t*>(m_buf) + static_cast<size_t>(pos);
+}
+
 }
@@ -61,6 +61,16 @@ class RpMemFile : public IRpFile
 		 */
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * This does not change the file position, and it's thread-safe.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * (NOTE: Not valid for RpMemFile; this will always return 0.)
@@ -106,6 +116,16 @@ class RpMemFile : public IRpFile
 		 */
 		std::string filename(void) const final;
 
+	public:
+		/**
+		 * Get a read-only view of part of the file without copying it.
+		 * This returns a pointer into the memory buffer.
+		 * @param pos	[in] Starting address.
+		 * @param size	[in] Size of the view, in bytes.
+		 * @return Pointer to the data, or nullptr if the range is out of bounds.
+		 */
+		const uint8_t *map(off64_t pos, size_t size) final;
+
 	protected:
 		const void *m_buf;	// Memory buffer.
 		size_t m_size;		// Size of memory buffer.
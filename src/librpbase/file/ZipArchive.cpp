@@ -0,0 +1,727 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ZipArchive.cpp: ZIP archive reader with IRpFile access to members.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ZipArchive.hpp"
+
+#include "IRpFile.hpp"
+#include "GzIndexReader.hpp"
+#include "tcharx.h"	/* for DIR_SEP_CHR */
+
+// MiniZip
+#include <zlib.h>
+#include "mz.h"
+#include "mz_strm.h"
+#include "mz_zip.h"
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRpBase {
+
+/** minizip stream wrapper for IRpFile **/
+
+/**
+ * mz_stream implementation that reads from an IRpFile.
+ * Only the functions needed to read the central directory
+ * are implemented.
+ */
+struct RpFileMzStream {
+	mz_stream stream;	// must be first
+	IRpFile *file;
+	off64_t pos;
+	int32_t error;
+};
+
+static int32_t RpFileMzStream_open(void *stream, const char *path, int32_t mode)
+{
+	RP_UNUSED(stream);
+	RP_UNUSED(path);
+	return (mode == MZ_OPEN_MODE_READ ? MZ_OK : MZ_OPEN_ERROR);
+}
+
+static int32_t RpFileMzStream_is_open(void *stream)
+{
+	const RpFileMzStream *const rps = static_cast<const RpFileMzStream*>(stream);
+	return (rps->file && rps->file->isOpen() ? MZ_OK : MZ_OPEN_ERROR);
+}
+
+static int32_t RpFileMzStream_read(void *stream, void *buf, int32_t size)
+{
+	RpFileMzStream *const rps = static_cast<RpFileMzStream*>(stream);
+	if (size < 0) {
+		return MZ_PARAM_ERROR;
+	}
+	const size_t sz_read = rps->file->pread(rps->pos, buf, static_cast<size_t>(size));
+	if (sz_read != static_cast<size_t>(size) && rps->file->lastError() != 0) {
+		rps->error = rps->file->lastError();
+	}
+	rps->pos += sz_read;
+	return static_cast<int32_t>(sz_read);
+}
+
+static int32_t RpFileMzStream_write(void *stream, const void *buf, int32_t size)
+{
+	// Read-only.
+	RP_UNUSED(stream);
+	RP_UNUSED(buf);
+	RP_UNUSED(size);
+	return MZ_WRITE_ERROR;
+}
+
+static int64_t RpFileMzStream_tell(void *stream)
+{
+	const RpFileMzStream *const rps = static_cast<const RpFileMzStream*>(stream);
+	return rps->pos;
+}
+
+static int32_t RpFileMzStream_seek(void *stream, int64_t offset, int32_t origin)
+{
+	RpFileMzStream *const rps = static_cast<RpFileMzStream*>(stream);
+	switch (origin) {
+		case MZ_SEEK_SET:
+			break;
+		case MZ_SEEK_CUR:
+			offset += rps->pos;
+			break;
+		case MZ_SEEK_END:
+			offset += rps->file->size();
+			break;
+		default:
+			return MZ_SEEK_ERROR;
+	}
+	if (offset < 0) {
+		return MZ_SEEK_ERROR;
+	}
+	rps->pos = offset;
+	return MZ_OK;
+}
+
+static int32_t RpFileMzStream_close(void *stream)
+{
+	RP_UNUSED(stream);
+	return MZ_OK;
+}
+
+static int32_t RpFileMzStream_error(void *stream)
+{
+	const RpFileMzStream *const rps = static_cast<const RpFileMzStream*>(stream);
+	return rps->error;
+}
+
+static mz_stream_vtbl RpFileMzStream_vtbl = {
+	RpFileMzStream_open,
+	RpFileMzStream_is_open,
+	RpFileMzStream_read,
+	RpFileMzStream_write,
+	RpFileMzStream_tell,
+	RpFileMzStream_seek,
+	RpFileMzStream_close,
+	RpFileMzStream_error,
+	nullptr,	// create (stream is allocated by the caller)
+	nullptr,	// destroy
+	nullptr,	// get_prop_int64
+	nullptr,	// set_prop_int64
+};
+
+/** ZipMemberFile **/
+
+/**
+ * IRpFile implementation for ZIP archive members.
+ * Stored members are read directly from the archive file.
+ * Deflated members use GzIndexReader in raw deflate mode.
+ */
+class ZipMemberFile : public IRpFile
+{
+	public:
+		/**
+		 * Open a ZIP archive member.
+		 * @param file		[in] ZIP archive file.
+		 * @param filename	[in] Filename to report.
+		 * @param dataOffset	[in] Starting offset of the member data.
+		 * @param entry		[in] Archive member.
+		 */
+		ZipMemberFile(IRpFile *file, const string &filename,
+			off64_t dataOffset, const ZipArchive::Entry &entry);
+	protected:
+		virtual ~ZipMemberFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(ZipMemberFile)
+
+	public:
+		bool isOpen(void) const final;
+		void close(void) final;
+		size_t read(void *ptr, size_t size) final;
+		size_t pread(off64_t pos, void *ptr, size_t size) final;
+		size_t write(const void *ptr, size_t size) final;
+		int seek(off64_t pos) final;
+		off64_t tell(void) final;
+		int truncate(off64_t size = 0) final;
+
+	public:
+		off64_t size(void) final;
+		string filename(void) const final;
+		const uint8_t *map(off64_t pos, size_t size) final;
+
+	private:
+		IRpFile *m_file;		// ZIP archive file.
+		GzIndexReader *m_gzReader;	// Deflate decompressor. (nullptr if stored)
+		string m_filename;		// Filename to report.
+		off64_t m_dataOffset;		// Starting offset of the member data.
+		off64_t m_size;			// Uncompressed size.
+		off64_t m_pos;			// Current position.
+};
+
+/**
+ * Open a ZIP archive member.
+ * @param file		[in] ZIP archive file.
+ * @param filename	[in] Filename to report.
+ * @param dataOffset	[in] Starting offset of the member data.
+ * @param entry		[in] Archive member.
+ */
+ZipMemberFile::ZipMemberFile(IRpFile *file, const string &filename,
+		off64_t dataOffset, const ZipArchive::Entry &entry)
+	: super()
+	, m_file(file->ref())
+	, m_gzReader(nullptr)
+	, m_filename(filename)
+	, m_dataOffset(dataOffset)
+	, m_size(entry.uncompSize)
+	, m_pos(0)
+{
+	if (entry.method == ZipArchive::METHOD_DEFLATE) {
+		m_gzReader = new GzIndexReader(file, dataOffset, entry.compSize, entry.uncompSize);
+		if (!m_gzReader->isOpen()) {
+			m_lastError = m_gzReader->lastError();
+			close();
+		}
+	}
+}
+
+ZipMemberFile::~ZipMemberFile()
+{
+	delete m_gzReader;
+	if (m_file) {
+		m_file->unref();
+	}
+}
+
+/**
+ * Is the file open?
+ * This usually only returns false if an error occurred.
+ * @return True if the file is open; false if it isn't.
+ */
+bool ZipMemberFile::isOpen(void) const
+{
+	return (m_file != nullptr);
+}
+
+/**
+ * Close the file.
+ */
+void ZipMemberFile::close(void)
+{
+	delete m_gzReader;
+	m_gzReader = nullptr;
+	if (m_file) {
+		m_file->unref();
+		m_file = nullptr;
+	}
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t ZipMemberFile::read(void *ptr, size_t size)
+{
+	const size_t ret = this->pread(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * This does not change the file position, and it's thread-safe.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t ZipMemberFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (pos >= m_size || size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	// Make sure pos + size <= m_size.
+	if (static_cast<off64_t>(size) > m_size - pos) {
+		size = static_cast<size_t>(m_size - pos);
+	}
+
+	size_t ret;
+	if (m_gzReader) {
+		// Deflated member.
+		ret = m_gzReader->pread(pos, ptr, size);
+		if (ret != size) {
+			m_lastError = m_gzReader->lastError();
+			if (m_lastError == 0) {
+				m_lastError = EIO;
+			}
+		}
+	} else {
+		// Stored member.
+		ret = m_file->pread(m_dataOffset + pos, ptr, size);
+		if (ret != size) {
+			m_lastError = m_file->lastError();
+		}
+	}
+	return ret;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for ZipMemberFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t ZipMemberFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for ZipMemberFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int ZipMemberFile::seek(off64_t pos)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	m_pos = pos;
+	return 0;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t ZipMemberFile::tell(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_pos;
+}
+
+/**
+ * Truncate the file.
+ * (NOTE: Not valid for ZipMemberFile; this will always return -1.)
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int ZipMemberFile::truncate(off64_t size)
+{
+	// Not supported.
+	RP_UNUSED(size);
+	m_lastError = ENOTSUP;
+	return -1;
+}
+
+/**
+ * Get the file size.
+ * @return File size, or negative on error.
+ */
+off64_t ZipMemberFile::size(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	return m_size;
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string ZipMemberFile::filename(void) const
+{
+	return m_filename;
+}
+
+/**
+ * Get a read-only view of part of the file without copying it.
+ * This is only supported for stored members.
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+ */
+const uint8_t *ZipMemberFile::map(off64_t pos, size_t size)
+{
+	if (!m_file || m_gzReader) {
+		// Deflated members can't be mapped.
+		return nullptr;
+	} else if (pos < 0 || pos > m_size || static_cast<off64_t>(size) > m_size - pos) {
+		// Out of bounds.
+		return nullptr;
+	}
+	return m_file->map(m_dataOffset + pos, size);
+}
+
+/** ZipArchivePrivate **/
+
+class ZipArchivePrivate
+{
+	public:
+		explicit ZipArchivePrivate(IRpFile *file);
+		~ZipArchivePrivate();
+
+	private:
+		RP_DISABLE_COPY(ZipArchivePrivate)
+
+	public:
+		IRpFile *file;		// ZIP archive file.
+		int lastError;
+
+		// Archive members.
+		vector<ZipArchive::Entry> entries;
+
+	public:
+		/**
+		 * Read the central directory.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readCentralDirectory(void);
+
+		/**
+		 * Get the starting offset of a member's data.
+		 * @param entry Archive member.
+		 * @return Data offset, or -1 on error.
+		 */
+		off64_t getDataOffset(const ZipArchive::Entry &entry);
+};
+
+// ZIP local file header.
+// Reference: https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+#define ZIP_LOCAL_FILE_HEADER_MAGIC 0x04034B50	// "PK\x03\x04"
+#pragma pack(1)
+typedef struct PACKED _ZIP_LocalFileHeader {
+	uint32_t magic;			// [0x000] ZIP_LOCAL_FILE_HEADER_MAGIC
+	uint16_t version_needed;	// [0x004]
+	uint16_t flags;			// [0x006]
+	uint16_t method;		// [0x008]
+	uint16_t mtime;			// [0x00A] DOS time
+	uint16_t mdate;			// [0x00C] DOS date
+	uint32_t crc32;			// [0x00E]
+	uint32_t comp_size;		// [0x012]
+	uint32_t uncomp_size;		// [0x016]
+	uint16_t filename_len;		// [0x01A]
+	uint16_t extra_len;		// [0x01C]
+} ZIP_LocalFileHeader;
+ASSERT_STRUCT(ZIP_LocalFileHeader, 30);
+#pragma pack()
+
+ZipArchivePrivate::ZipArchivePrivate(IRpFile *file)
+	: file(file ? file->ref() : nullptr)
+	, lastError(0)
+{
+	if (!this->file) {
+		lastError = EBADF;
+		return;
+	}
+
+	int ret = readCentralDirectory();
+	if (ret != 0) {
+		lastError = -ret;
+		this->file->unref();
+		this->file = nullptr;
+	}
+}
+
+ZipArchivePrivate::~ZipArchivePrivate()
+{
+	if (file) {
+		file->unref();
+	}
+}
+
+/**
+ * Read the central directory.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ZipArchivePrivate::readCentralDirectory(void)
+{
+	RpFileMzStream rps;
+	rps.stream.vtbl = &RpFileMzStream_vtbl;
+	rps.stream.base = nullptr;
+	rps.file = file;
+	rps.pos = 0;
+	rps.error = 0;
+
+	void *zip = nullptr;
+	mz_zip_create(&zip);
+	if (!zip) {
+		return -ENOMEM;
+	}
+
+	int32_t err = mz_zip_open(zip, &rps, MZ_OPEN_MODE_READ);
+	if (err != MZ_OK) {
+		// Not a ZIP archive.
+		mz_zip_delete(&zip);
+		return (rps.error != 0 ? -rps.error : -EIO);
+	}
+
+	// Enumerate all members.
+	uint64_t number_entry = 0;
+	if (mz_zip_get_number_entry(zip, &number_entry) == MZ_OK && number_entry <= 65536) {
+		entries.reserve(static_cast<size_t>(number_entry));
+	}
+	for (err = mz_zip_goto_first_entry(zip); err == MZ_OK; err = mz_zip_goto_next_entry(zip)) {
+		mz_zip_file *file_info = nullptr;
+		if (mz_zip_entry_get_info(zip, &file_info) != MZ_OK || !file_info) {
+			err = MZ_FORMAT_ERROR;
+			break;
+		}
+
+		ZipArchive::Entry entry;
+		if (file_info->filename) {
+			entry.filename = file_info->filename;
+		}
+		entry.compSize = file_info->compressed_size;
+		entry.uncompSize = file_info->uncompressed_size;
+		entry.headerOffset = file_info->disk_offset;
+		entry.mtime = file_info->modified_date;
+		entry.crc32 = file_info->crc;
+		entry.method = file_info->compression_method;
+		entry.flags = file_info->flag;
+		entry.isDir = (mz_zip_entry_is_dir(zip) == MZ_OK);
+		entries.push_back(std::move(entry));
+	}
+
+	mz_zip_close(zip);
+	mz_zip_delete(&zip);
+	if (err != MZ_END_OF_LIST) {
+		// Error reading the central directory.
+		entries.clear();
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * Get the starting offset of a member's data.
+ * @param entry Archive member.
+ * @return Data offset, or -1 on error.
+ */
+off64_t ZipArchivePrivate::getDataOffset(const ZipArchive::Entry &entry)
+{
+	// The local file header's filename and extra field
+	// may differ from the central directory, so the
+	// local file header must be read.
+	ZIP_LocalFileHeader lfh;
+	if (file->pread(entry.headerOffset, &lfh, sizeof(lfh)) != sizeof(lfh) ||
+	    lfh.magic != cpu_to_le32(ZIP_LOCAL_FILE_HEADER_MAGIC))
+	{
+		return -1;
+	}
+
+	return entry.headerOffset + sizeof(lfh) +
+		le16_to_cpu(lfh.filename_len) + le16_to_cpu(lfh.extra_len);
+}
+
+/** ZipArchive **/
+
+/**
+ * Open a ZIP archive.
+ *
+ * The central directory is read using minizip, and all
+ * members are enumerated in a single pass.
+ *
+ * The file is ref()'d, so the original file can be
+ * unref()'d by the caller afterwards.
+ *
+ * @param file ZIP archive.
+ */
+ZipArchive::ZipArchive(IRpFile *file)
+	: d_ptr(new ZipArchivePrivate(file))
+{ }
+
+ZipArchive::~ZipArchive()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the archive open?
+ * This returns false if the file isn't a valid ZIP archive.
+ * @return True if the archive is open; false if it isn't.
+ */
+bool ZipArchive::isOpen(void) const
+{
+	RP_D(const ZipArchive);
+	return (d->file != nullptr);
+}
+
+/**
+ * Get the last error.
+ * @return Last POSIX error, or 0 if no error.
+ */
+int ZipArchive::lastError(void) const
+{
+	RP_D(const ZipArchive);
+	return d->lastError;
+}
+
+/**
+ * Get the number of archive members.
+ * @return Number of archive members.
+ */
+int ZipArchive::count(void) const
+{
+	RP_D(const ZipArchive);
+	return static_cast<int>(d->entries.size());
+}
+
+/**
+ * Get an archive member.
+ * @param idx Member index.
+ * @return Archive member, or nullptr if the index is out of range.
+ */
+const ZipArchive::Entry *ZipArchive::at(int idx) const
+{
+	RP_D(const ZipArchive);
+	assert(idx >= 0);
+	assert(idx < static_cast<int>(d->entries.size()));
+	if (idx < 0 || idx >= static_cast<int>(d->entries.size()))
+		return nullptr;
+	return &d->entries[idx];
+}
+
+/**
+ * Find an archive member by filename.
+ * @param filename Filename (UTF-8)
+ * @param ignoreCase If true, use a case-insensitive comparison.
+ * @return Member index, or -1 if not found.
+ */
+int ZipArchive::find(const char *filename, bool ignoreCase) const
+{
+	RP_D(const ZipArchive);
+	assert(filename != nullptr);
+	if (!filename)
+		return -1;
+
+	int idx = 0;
+	for (auto iter = d->entries.cbegin(); iter != d->entries.cend(); ++iter, idx++) {
+		const int cmp = (ignoreCase
+			? strcasecmp(iter->filename.c_str(), filename)
+			: strcmp(iter->filename.c_str(), filename));
+		if (cmp == 0) {
+			return idx;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Open an archive member as a read-only IRpFile.
+ *
+ * Stored members are read directly from the archive,
+ * and map() is passed through to the archive file.
+ * Deflated members are decompressed on demand using
+ * seek points, so reads near the end of a member
+ * don't require decompressing the whole member again.
+ *
+ * The archive member remains valid after the
+ * ZipArchive object is deleted.
+ *
+ * @param idx Member index.
+ * @return IRpFile, or nullptr on error. (Check lastError().)
+ */
+IRpFile *ZipArchive::open(int idx)
+{
+	RP_D(ZipArchive);
+	if (!d->file) {
+		d->lastError = EBADF;
+		return nullptr;
+	}
+	const Entry *const entry = at(idx);
+	if (!entry) {
+		d->lastError = EINVAL;
+		return nullptr;
+	} else if (entry->isDir) {
+		d->lastError = EISDIR;
+		return nullptr;
+	}
+
+	if ((entry->flags & MZ_ZIP_FLAG_ENCRYPTED) ||
+	    (entry->method != METHOD_STORE && entry->method != METHOD_DEFLATE))
+	{
+		// Encryption and other compression methods aren't supported.
+		d->lastError = ENOTSUP;
+		return nullptr;
+	} else if (entry->method == METHOD_STORE && entry->compSize != entry->uncompSize) {
+		// Stored members must have the same compressed and uncompressed sizes.
+		d->lastError = EIO;
+		return nullptr;
+	}
+
+	const off64_t dataOffset = d->getDataOffset(*entry);
+	if (dataOffset < 0) {
+		d->lastError = EIO;
+		return nullptr;
+	}
+
+	// Report the member as being inside of the archive.
+	// This prevents RelatedFile lookups from finding
+	// unrelated files in the current directory.
+	string filename = d->file->filename();
+	if (!filename.empty()) {
+		filename += DIR_SEP_CHR;
+	}
+	filename += entry->filename;
+
+	ZipMemberFile *const file = new ZipMemberFile(d->file, filename, dataOffset, *entry);
+	if (!file->isOpen()) {
+		d->lastError = file->lastError();
+		file->unref();
+		return nullptr;
+	}
+	return file;
+}
+
+}
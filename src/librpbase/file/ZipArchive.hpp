@@ -0,0 +1,124 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ZipArchive.hpp: ZIP archive reader with IRpFile access to members.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_FILE_ZIPARCHIVE_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_FILE_ZIPARCHIVE_HPP__
+
+#include "../common.h"
+
+// C includes.
+#include <stdint.h>
+#include <time.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+class IRpFile;
+
+class ZipArchivePrivate;
+class ZipArchive
+{
+	public:
+		/**
+		 * Open a ZIP archive.
+		 *
+		 * The central directory is read using minizip, and all
+		 * members are enumerated in a single pass.
+		 *
+		 * The file is ref()'d, so the original file can be
+		 * unref()'d by the caller afterwards.
+		 *
+		 * @param file ZIP archive.
+		 */
+		explicit ZipArchive(IRpFile *file);
+		~ZipArchive();
+
+	private:
+		RP_DISABLE_COPY(ZipArchive)
+	private:
+		friend class ZipArchivePrivate;
+		ZipArchivePrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the archive open?
+		 * This returns false if the file isn't a valid ZIP archive.
+		 * @return True if the archive is open; false if it isn't.
+		 */
+		bool isOpen(void) const;
+
+		/**
+		 * Get the last error.
+		 * @return Last POSIX error, or 0 if no error.
+		 */
+		int lastError(void) const;
+
+	public:
+		// Compression methods.
+		enum CompressionMethod : uint16_t {
+			METHOD_STORE	= 0,
+			METHOD_DEFLATE	= 8,
+		};
+
+		// Archive member.
+		struct Entry {
+			std::string filename;	// Filename (UTF-8)
+			off64_t compSize;	// Compressed size
+			off64_t uncompSize;	// Uncompressed size
+			off64_t headerOffset;	// Local file header offset
+			time_t mtime;		// Modification time
+			uint32_t crc32;		// CRC32 of the uncompressed data
+			uint16_t method;	// Compression method (see CompressionMethod)
+			uint16_t flags;		// General purpose bit flags
+			bool isDir;		// True if this is a directory
+		};
+
+		/**
+		 * Get the number of archive members.
+		 * @return Number of archive members.
+		 */
+		int count(void) const;
+
+		/**
+		 * Get an archive member.
+		 * @param idx Member index.
+		 * @return Archive member, or nullptr if the index is out of range.
+		 */
+		const Entry *at(int idx) const;
+
+		/**
+		 * Find an archive member by filename.
+		 * @param filename Filename (UTF-8)
+		 * @param ignoreCase If true, use a case-insensitive comparison.
+		 * @return Member index, or -1 if not found.
+		 */
+		int find(const char *filename, bool ignoreCase = false) const;
+
+		/**
+		 * Open an archive member as a read-only IRpFile.
+		 *
+		 * Stored members are read directly from the archive,
+		 * and map() is passed through to the archive file.
+		 * Deflated members are decompressed on demand using
+		 * seek points, so reads near the end of a member
+		 * don't require decompressing the whole member again.
+		 *
+		 * The archive member remains valid after the
+		 * ZipArchive object is deleted.
+		 *
+		 * @param idx Member index.
+		 * @return IRpFile, or nullptr on error. (Check lastError().)
+		 */
+		IRpFile *open(int idx);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_FILE_ZIPARCHIVE_HPP__ */
@@ -517,4 +517,39 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 
 }
 
+
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_id(const string &filename, FileId *pFileId)
+{
+	assert(pFileId != nullptr);
+	const tstring tfilename = makeWinPath(filename);
+
+	HANDLE hFile = CreateFile(tfilename.c_str(),
+		GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// Error opening the file.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	BY_HANDLE_FILE_INFORMATION bhfi;
+	BOOL bRet = GetFileInformationByHandle(hFile, &bhfi);
+	CloseHandle(hFile);
+	if (!bRet) {
+		// Error getting the file information.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	pFileId->dev = bhfi.dwVolumeSerialNumber;
+	pFileId->ino = (static_cast<uint64_t>(bhfi.nFileIndexHigh) << 32) | bhfi.nFileIndexLow;
+	pFileId->size = (static_cast<off64_t>(bhfi.nFileSizeHigh) << 32) | bhfi.nFileSizeLow;
+	pFileId->mtime = FileTimeToUnixTime(&bhfi.ftLastWriteTime);
+	return 0;
+}
+
 } }
@@ -11,6 +11,7 @@
 
 #include "../RpFile.hpp"
 #include "../RpFile_p.hpp"
+#include "../IoStats.hpp"
 
 // librpbase
 #include "TextFuncs_wchar.hpp"
@@ -18,8 +19,8 @@
 // libwin32common
 #include "libwin32common/w32err.h"
 
-// C includes.
-#include <fcntl.h>
+// zlib
+#include <zlib.h>
 
 // C++ STL classes.
 using std::string;
@@ -33,6 +34,9 @@ using std::wstring;
 
 namespace LibRpBase {
 
+// I/O statistics.
+static IoStats::Layer ioLayer("RpFile");
+
 #ifdef _MSC_VER
 // DelayLoad test implementation.
 DELAYLOAD_TEST_FUNCTION_IMPL0(zlibVersion);
@@ -42,15 +46,29 @@ DELAYLOAD_TEST_FUNCTION_IMPL0(zlibVersion);
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd) {
-		gzclose_r(gzfd);
-	}
+	unmapFile();
+	delete gzReader;
 	if (file && file != INVALID_HANDLE_VALUE) {
 		CloseHandle(file);
 	}
 	delete devInfo;
 }
 
+/**
+ * Unmap all mapped views of the file.
+ */
+void RpFilePrivate::unmapFile(void)
+{
+	for (auto iter = mapViews.cbegin(); iter != mapViews.cend(); ++iter) {
+		UnmapViewOfFile(iter->addr);
+	}
+	mapViews.clear();
+	if (hMapping) {
+		CloseHandle(hMapping);
+		hMapping = nullptr;
+	}
+}
+
 /**
  * Convert an RpFile::FileMode to Win32 CreateFile() parameters.
  * @param mode				[in] FileMode
@@ -93,7 +111,7 @@ inline int RpFilePrivate::mode_to_win32(RpFile::FileMode mode,
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -327,77 +345,31 @@ void RpFile::init(void)
 #endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
 
 		DWORD bytesRead;
-		BOOL bRet;
-
 		uint16_t gzmagic;
-		bRet = ReadFile(d->file, &gzmagic, sizeof(gzmagic), &bytesRead, nullptr);
+		BOOL bRet = ReadFile(d->file, &gzmagic, sizeof(gzmagic), &bytesRead, nullptr);
 		if (bRet && bytesRead == sizeof(gzmagic) && gzmagic == be16_to_cpu(0x1F8B)) {
 			// This is a gzipped file.
-			// Get the uncompressed size at the end of the file.
-			LARGE_INTEGER liFileSize;
-			bRet = GetFileSizeEx(d->file, &liFileSize);
-			if (bRet && liFileSize.QuadPart > 10+8) {
-				LARGE_INTEGER liSeekPos;
-				liSeekPos.QuadPart = liFileSize.QuadPart - 4;
-				bRet = SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
-				if (bRet) {
-					uint32_t uncomp_sz;
-					bRet = ReadFile(d->file, &uncomp_sz, sizeof(uncomp_sz), &bytesRead, nullptr);
-					uncomp_sz = le32_to_cpu(uncomp_sz);
-					if (bRet && bytesRead == sizeof(uncomp_sz) /*&& uncomp_sz >= liFileSize.QuadPart-(10+8)*/) {
-						// NOTE: Uncompressed size might be smaller than the real filesize
-						// in cases where gzip doesn't help much.
-						// TODO: Add better verification heuristics?
-						d->gzsz = (off64_t)uncomp_sz;
-
-						liSeekPos.QuadPart = 0;
-						SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
-						// NOTE: Not sure if this is needed on Windows.
-						FlushFileBuffers(d->file);
-
-						// Open the file with gzdopen().
-						HANDLE hGzDup;
-						BOOL bRet = DuplicateHandle(
-							GetCurrentProcess(),	// hSourceProcessHandle
-							d->file,		// hSourceHandle
-							GetCurrentProcess(),	// hTargetProcessHandle
-							&hGzDup,		// lpTargetHandle
-							0,			// dwDesiredAccess
-							FALSE,			// bInheritHandle
-							DUPLICATE_SAME_ACCESS);	// dwOptions
-						if (bRet) {
-							// NOTE: close() on gzfd_dup() will close the
-							// underlying Windows handle.
-							int gzfd_dup = _open_osfhandle((intptr_t)hGzDup, _O_RDONLY);
-							if (gzfd_dup >= 0) {
-								// Make sure the CRC32 table is initialized.
-								get_crc_table();
-
-								d->gzfd = gzdopen(gzfd_dup, "r");
-								if (!d->gzfd) {
-									// gzdopen() failed.
-									// Close the dup()'d handle to prevent a leak.
-									_close(gzfd_dup);
-								}
-							} else {
-								// Unable to open an fd.
-								CloseHandle(hGzDup);
-							}
-						}
-					}
+			// Open a second handle for the compressed data.
+			// NOTE: The uncompressed size is determined by GzIndexReader,
+			// since ISIZE is only the lower 32 bits of the last member.
+			RpFile *const gzRawFile = new RpFile(d->filename, FM_OPEN_READ);
+			if (gzRawFile->isOpen()) {
+				d->gzReader = new GzIndexReader(gzRawFile, d->filename.c_str());
+				if (!d->gzReader->isOpen()) {
+					// Not a valid gzip header.
+					delete d->gzReader;
+					d->gzReader = nullptr;
 				}
 			}
+			gzRawFile->unref();
 		}
 
-		if (!d->gzfd) {
-			// Not a gzipped file.
-			// Rewind and flush the file.
-			LARGE_INTEGER liSeekPos;
-			liSeekPos.QuadPart = 0;
-			SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
-			// NOTE: Not sure if this is needed on Windows.
-			FlushFileBuffers(d->file);
-		}
+		// Rewind and flush the file.
+		LARGE_INTEGER liSeekPos;
+		liSeekPos.QuadPart = 0;
+		SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
+		// NOTE: Not sure if this is needed on Windows.
+		FlushFileBuffers(d->file);
 	}
 }
 
@@ -432,10 +404,9 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
-	}
+	d->unmapFile();
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file && d->file != INVALID_HANDLE_VALUE) {
 		CloseHandle(d->file);
 		d->file = INVALID_HANDLE_VALUE;
@@ -450,6 +421,7 @@ void RpFile::close(void)
  */
 size_t RpFile::read(void *ptr, size_t size)
 {
+	IoStats::ReadScope ioScope(ioLayer);
 	RP_D(RpFile);
 	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
 		m_lastError = EBADF;
@@ -461,18 +433,16 @@ size_t RpFile::read(void *ptr, size_t size)
 
 	if (d->devInfo) {
 		// Block device. Need to read in multiples of the block size.
-		return d->readUsingBlocks(ptr, size);
+		return ioScope.done(d->readUsingBlocks(ptr, size));
 	}
 
 	DWORD bytesRead;
-	if (d->gzfd) {
-		int iret = gzread(d->gzfd, ptr, (unsigned int)size);
-		if (iret >= 0) {
-			bytesRead = (DWORD)iret;
-		} else {
+	if (d->gzReader) {
+		bytesRead = static_cast<DWORD>(d->gzReader->pread(d->gzpos, ptr, size));
+		d->gzpos += bytesRead;
+		if (bytesRead != size && d->gzReader->lastError() != 0) {
 			// An error occurred.
-			bytesRead = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		BOOL bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, nullptr);
@@ -483,7 +453,86 @@ size_t RpFile::read(void *ptr, size_t size)
 		}
 	}
 
-	return bytesRead;
+	return ioScope.done(bytesRead);
+}
+
+/**
+ * Read data from the file at the specified position.
+ *
+ * This does not change the file position. For regular files,
+ * this is thread-safe. Device files use the default seek()
+ * and read() implementation.
+ *
+ * NOTE: ReadFile() with an OVERLAPPED offset moves the file
+ * pointer for synchronous handles, so the file pointer is
+ * restored afterwards. Concurrent pread() calls are safe, but
+ * they must not be mixed with concurrent read() calls.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::pread(off64_t pos, void *ptr, size_t size)
+{
+	IoStats::ReadScope ioScope(ioLayer);
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (d->devInfo) {
+		// Block devices need to use the file position.
+		return ioScope.done(super::pread(pos, ptr, size));
+	}
+
+	if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (d->gzReader) {
+		// gzip-compressed file.
+		// GzIndexReader::pread() is thread-safe.
+		const size_t ret = d->gzReader->pread(pos, ptr, size);
+		if (ret != size && d->gzReader->lastError() != 0) {
+			m_lastError = d->gzReader->lastError();
+		}
+		return ioScope.done(ret);
+	}
+
+	// Save the file pointer.
+	LARGE_INTEGER liSeekPos, liSeekRet;
+	liSeekPos.QuadPart = 0;
+	BOOL bRet = SetFilePointerEx(d->file, liSeekPos, &liSeekRet, FILE_CURRENT);
+	if (!bRet) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return 0;
+	}
+
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFU);
+	ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(pos) >> 32);
+
+	DWORD bytesRead;
+	bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, &ov);
+	if (!bRet) {
+		const DWORD dwError = GetLastError();
+		if (dwError != ERROR_HANDLE_EOF) {
+			// An error occurred.
+			m_lastError = w32err_to_posix(dwError);
+		}
+		bytesRead = 0;
+	}
+
+	// Restore the file pointer.
+	SetFilePointerEx(d->file, liSeekRet, nullptr, FILE_BEGIN);
+	return ioScope.done(bytesRead);
 }
 
 /**
@@ -526,6 +575,7 @@ size_t RpFile::write(const void *ptr, size_t size)
  */
 int RpFile::seek(off64_t pos)
 {
+	IoStats::seek(ioLayer);
 	RP_D(RpFile);
 	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
 		m_lastError = EBADF;
@@ -547,15 +597,14 @@ int RpFile::seek(off64_t pos)
 	}
 
 	int ret;
-	if (d->gzfd) {
-		// FIXME: Might not work with >2GB files...
-		z_off_t zret = gzseek(d->gzfd, (long)pos, SEEK_SET);
-		if (zret >= 0) {
+	if (d->gzReader) {
+		// Seeking is done in GzIndexReader::pread().
+		if (pos >= 0) {
+			d->gzpos = pos;
 			ret = 0;
 		} else {
-			// TODO: Does gzseek() set errno?
 			ret = -1;
-			m_lastError = -EIO;
+			m_lastError = EINVAL;
 		}
 	} else {
 		LARGE_INTEGER liSeekPos;
@@ -591,8 +640,8 @@ off64_t RpFile::tell(void)
 		return d->devInfo->device_pos;
 	}
 
-	if (d->gzfd) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->gzReader) {
+		return d->gzpos;
 	}
 
 	LARGE_INTEGER liSeekPos, liSeekRet;
@@ -680,10 +729,11 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd) {
-		// gzipped files have the uncompressed size stored
-		// at the end of the stream.
-		return d->gzsz;
+	} else if (d->gzReader) {
+		// gzipped files: The uncompressed size is estimated
+		// using the gzip trailer until the file has been fully
+		// decompressed. This doesn't decompress anything.
+		return d->gzReader->size();
 	}
 
 	// Regular file.
@@ -708,6 +758,180 @@ string RpFile::filename(void) const
 	return d->filename;
 }
 
+/**
+ * Get a read-only view of part of the file without copying it.
+ *
+ * Only the requested range (rounded to the mapping granularity)
+ * is memory-mapped. Views remain mapped until the file is closed
+ * and are reused for later requests within the same range.
+ * This is only supported for regular files opened with
+ * FM_OPEN_READ that are not using transparent gzip decompression.
+ *
+ * @param pos	[in] Starting address.
+ * @param size	[in] Size of the view, in bytes.
+ * @return Pointer to the data, or nullptr if mapping isn't supported or the range is out of bounds.
+ */
+const uint8_t *RpFile::map(off64_t pos, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	if (!d->canMap()) {
+		// Mapping isn't supported for this file.
+		return nullptr;
+	}
+	if (pos < 0 || size == 0 || static_cast<off64_t>(size) > RpFilePrivate::MAP_MAX_SIZE) {
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	// Check for an existing view.
+	const uint8_t *const p = d->findMapView(pos, size);
+	if (p) {
+		return p;
+	}
+
+	LARGE_INTEGER liFileSize;
+	if (!GetFileSizeEx(d->file, &liFileSize) || liFileSize.QuadPart <= 0) {
+		// NOTE: We won't try again.
+		d->mapFailed = true;
+		return nullptr;
+	}
+	if (static_cast<uint64_t>(pos) + size > static_cast<uint64_t>(liFileSize.QuadPart)) {
+		// Out of range.
+		m_lastError = EINVAL;
+		return nullptr;
+	}
+
+	if (!d->hMapping) {
+		d->hMapping = CreateFileMapping(d->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!d->hMapping) {
+			// NOTE: We won't try again.
+			d->mapFailed = true;
+			return nullptr;
+		}
+	}
+
+	// Map the requested range.
+	// NOTE: MapViewOfFile() requires an offset aligned to
+	// the system's allocation granularity.
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	const off64_t granMask = static_cast<off64_t>(sysInfo.dwAllocationGranularity) - 1;
+	RpFilePrivate::MapView view;
+	view.pos = pos & ~granMask;
+	view.size = static_cast<size_t>(pos - view.pos) + size;
+	void *const addr = MapViewOfFile(d->hMapping, FILE_MAP_READ,
+		static_cast<DWORD>(static_cast<uint64_t>(view.pos) >> 32),
+		static_cast<DWORD>(view.pos & 0xFFFFFFFFU), view.size);
+	if (!addr) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return nullptr;
+	}
+	view.addr = static_cast<uint8_t*>(addr);
+	d->mapViews.push_back(view);
+	return view.addr + static_cast<size_t>(pos - view.pos);
+}
+
+/**
+ * Tell the file how it's going to be read.
+ *
+ * Windows only supports access pattern hints when opening
+ * the file (FILE_FLAG_SEQUENTIAL_SCAN, FILE_FLAG_RANDOM_ACCESS),
+ * so hints are currently ignored.
+ *
+ * @param hint	[in] Access pattern hint.
+ * @param pos	[in,opt] Starting address of the affected range.
+ * @param size	[in,opt] Size of the affected range. (0 for the rest of the file)
+ * @return 0 on success (or if the hint was ignored); negative POSIX error code on error.
+ */
+int RpFile::setAccessHint(AccessHint hint, off64_t pos, off64_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	RP_UNUSED(hint);
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return 0;
+}
+
+/**
+ * Lock the file for exclusive access.
+ *
+ * This is an advisory lock that only affects other processes
+ * that also lock the file. If another process holds the lock,
+ * this function blocks until it's released.
+ *
+ * NOTE: The lock is per-process. Threads in the same process
+ * must use their own synchronization.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::lock(void)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE || d->devInfo || d->gzReader) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	if (!LockFileEx(d->file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &ov)) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return -m_lastError;
+	}
+	return 0;
+}
+
+/**
+ * Unlock the file.
+ * Pending writes are flushed before the lock is released.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::unlock(void)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE || d->devInfo || d->gzReader) {
+		m_lastError = EBADF;
+		return -m_lastError;
+	}
+
+	// NOTE: WriteFile() isn't buffered by RpFile,
+	// so there's nothing to flush here.
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	if (!UnlockFileEx(d->file, 0, MAXDWORD, MAXDWORD, &ov)) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return -m_lastError;
+	}
+	return 0;
+}
+
+/**
+ * Enable or disable the gzip seek point index cache.
+ *
+ * If enabled, the seek point index for files opened with
+ * FM_OPEN_READ_GZ is saved in the rom-properties cache
+ * directory once the file has been fully decompressed,
+ * and it's reused if the file hasn't changed.
+ *
+ * The gzip index cache is disabled by default.
+ *
+ * @param enabled True to enable; false to disable.
+ */
+void RpFile::setGzIndexCacheEnabled(bool enabled)
+{
+	GzIndexReader::setCacheEnabled(enabled);
+}
+
 /** Device file functions **/
 
 /**
@@ -11,18 +11,24 @@
 #include "tcharx.h"
 
 // AesCipher
+#include "librpbase/config.librpbase.h"
 #include "../crypto/IAesCipher.hpp"
+#ifdef HAVE_AESNI
+# include "../crypto/AesNI.hpp"
+#endif /* HAVE_AESNI */
 #ifdef _WIN32
 # include "../crypto/AesCAPI.hpp"
 # include "../crypto/AesCAPI_NG.hpp"
 #else /* !_WIN32 */
 # include "../crypto/AesNettle.hpp"
 #endif /* _WIN32 */
+#include "librpbase/tests/TestRandom.hpp"
 
 // C includes. (C++ namespace)
 #include <cstdio>
 
 // C++ includes.
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -125,6 +131,14 @@ class AesCipherTest : public ::testing::TestWithParam<AesCipherTest_mode>
 			size_t size,
 			const char *data_type);
 
+		/**
+		 * Set the cipher settings for the current test mode.
+		 * @param cipher	[in] Cipher.
+		 * @param iv		[in] IV/counter. (16 bytes; ignored for ECB)
+		 * @return 0 on success; non-zero on error.
+		 */
+		int InitCipher(IAesCipher *cipher, const uint8_t *iv);
+
 	public:
 		/** Test case parameters. **/
 
@@ -384,6 +398,109 @@ TEST_P(AesCipherTest, decryptTest_blockAtATime)
 		buf.data(), buf.size(), "plaintext data");
 }
 
+/**
+ * Set the cipher settings for the current test mode.
+ * @param cipher	[in] Cipher.
+ * @param iv		[in] IV/counter. (16 bytes; ignored for ECB)
+ * @return 0 on success; non-zero on error.
+ */
+int AesCipherTest::InitCipher(IAesCipher *cipher, const uint8_t *iv)
+{
+	const AesCipherTest_mode &mode = GetParam();
+	int ret = cipher->setChainingMode(mode.chainingMode);
+	if (ret != 0)
+		return ret;
+	ret = cipher->setKey(aes_key, mode.key_len);
+	if (ret != 0 || mode.chainingMode == IAesCipher::CM_ECB)
+		return ret;
+	return cipher->setIV(iv, 16);
+}
+
+/**
+ * Decrypt a large buffer in one call and in chunks of
+ * varying sizes. The results should be identical.
+ * This tests multi-block processing and IV/counter
+ * updates across calls.
+ */
+TEST_P(AesCipherTest, decryptTest_multiBlock)
+{
+	const AesCipherTest_mode &mode = GetParam();
+	if (!mode.isRequired && !m_cipher->isInit()) {
+		return;
+	}
+
+	// Counter that carries into the high 64 bits.
+	static const uint8_t ctr_iv[16] = {
+		0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,
+		0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFB
+	};
+	const uint8_t *const iv = (mode.chainingMode == IAesCipher::CM_CTR ? ctr_iv : aes_iv);
+
+	// 259 blocks of pseudo-random data.
+	vector<uint8_t> src(259 * 16);
+	TestRandom rnd(0x13579BDF);
+	rnd.fill(src.data(), src.size());
+
+	// Decrypt everything at once.
+	ASSERT_EQ(0, InitCipher(m_cipher, iv));
+	vector<uint8_t> buf_all(src);
+	ASSERT_EQ(buf_all.size(), m_cipher->decrypt(buf_all.data(), buf_all.size()));
+
+	// Decrypt in chunks of 1, 2, ..., 17 blocks.
+	IAesCipher *const cipher2 = mode.pfnCreateIAesCipher();
+	ASSERT_EQ(0, InitCipher(cipher2, iv));
+	vector<uint8_t> buf_chunks(src);
+	size_t pos = 0;
+	for (size_t blocks = 1; pos < buf_chunks.size(); blocks = (blocks % 17) + 1) {
+		size_t sz = blocks * 16;
+		if (sz > buf_chunks.size() - pos) {
+			sz = buf_chunks.size() - pos;
+		}
+		EXPECT_EQ(sz, cipher2->decrypt(&buf_chunks[pos], sz));
+		pos += sz;
+	}
+	delete cipher2;
+
+	CompareByteArrays(buf_all.data(), buf_chunks.data(), buf_all.size(), "plaintext data");
+}
+
+/**
+ * Decryption throughput benchmark.
+ * This doesn't fail on slow implementations; it only
+ * prints the throughput for comparison.
+ *
+ * NOTE: Excluded from the default CTest run.
+ * Run AesCipherTest --gtest_filter=*benchmark* manually.
+ */
+TEST_P(AesCipherTest, decrypt_benchmark)
+{
+	const AesCipherTest_mode &mode = GetParam();
+	if (!mode.isRequired && !m_cipher->isInit()) {
+		return;
+	}
+
+	static const size_t BUF_SIZE = 1024 * 1024;
+	static const unsigned int ITERATIONS = 8;
+	ASSERT_EQ(0, InitCipher(m_cipher, aes_iv));
+	vector<uint8_t> buf(BUF_SIZE, 0x5A);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < ITERATIONS; i++) {
+		ASSERT_EQ(buf.size(), m_cipher->decrypt(buf.data(), buf.size()));
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double secs = std::chrono::duration<double>(end - start).count();
+	const double mib = static_cast<double>(BUF_SIZE) * ITERATIONS / (1024.0 * 1024.0);
+	ostringstream oss;
+	oss << m_cipher->name() << ", " << mode;
+	if (secs > 0) {
+		printf("%s: %.1f MiB/s\n", oss.str().c_str(), mib / secs);
+	} else {
+		printf("%s: too fast to measure\n", oss.str().c_str());
+	}
+}
+
 /** Decryption tests. **/
 
 /**
@@ -566,6 +683,9 @@ INSTANTIATE_TEST_CASE_P(AesDecryptTest_##klass, AesCipherTest, \
 	\
 	, AesCipherTest::test_case_suffix_generator);
 
+#ifdef HAVE_AESNI
+AesDecryptTestSet(NI, false)
+#endif /* HAVE_AESNI */
 #ifdef _WIN32
 AesDecryptTestSet(CAPI, true)
 AesDecryptTestSet(CAPI_NG, false)
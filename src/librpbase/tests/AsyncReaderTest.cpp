@@ -0,0 +1,195 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * AsyncReaderTest.cpp: AsyncReader test.                                  *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// AsyncReader
+#include "librpbase/file/AsyncReader.hpp"
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class AsyncReaderTest : public ::testing::TestWithParam<bool>
+{
+	protected:
+		AsyncReaderTest()
+			: m_file(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			if (m_file) {
+				m_file->unref();
+				m_file = nullptr;
+			}
+			remove(FILENAME);
+		}
+
+	public:
+		// Test file.
+		static const char FILENAME[];
+		static const unsigned int FILE_SIZE = 1024*1024 + 123;
+
+		// Read request for the callback.
+		struct ReadInfo {
+			AsyncReaderTest *test;
+			off64_t pos;
+			size_t size;
+			unique_ptr<uint8_t[]> buf;
+			bool done;
+		};
+
+		/**
+		 * AsyncReader callback.
+		 * Checks the data against the expected data.
+		 */
+		static void readCallback(void *userdata, size_t size, int err);
+
+	protected:
+		vector<uint8_t> m_data;	// File data.
+		IRpFile *m_file;
+		unsigned int m_callbacks;
+};
+
+const char AsyncReaderTest::FILENAME[] = "AsyncReaderTest.bin";
+
+void AsyncReaderTest::SetUp(void)
+{
+	m_callbacks = 0;
+	m_data.resize(FILE_SIZE);
+	TestRandom rnd(0x12345678);
+	rnd.fill(m_data.data(), m_data.size());
+
+	RpFile *const file = new RpFile(FILENAME, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(m_data.size(), file->write(m_data.data(), m_data.size()));
+	file->unref();
+
+	m_file = new RpFile(FILENAME, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(m_file->isOpen());
+}
+
+/**
+ * AsyncReader callback.
+ * Checks the data against the expected data.
+ */
+void AsyncReaderTest::readCallback(void *userdata, size_t size, int err)
+{
+	ReadInfo *const info = static_cast<ReadInfo*>(userdata);
+	AsyncReaderTest *const test = info->test;
+	EXPECT_FALSE(info->done);
+	info->done = true;
+	test->m_callbacks++;
+
+	size_t expected = info->size;
+	if (info->pos + expected > test->m_data.size()) {
+		expected = test->m_data.size() - static_cast<size_t>(info->pos);
+	}
+	EXPECT_EQ(0, err) << "pos " << info->pos;
+	ASSERT_EQ(expected, size) << "pos " << info->pos;
+	EXPECT_EQ(0, memcmp(info->buf.get(), &test->m_data[static_cast<size_t>(info->pos)], size)) << "pos " << info->pos;
+}
+
+/**
+ * More reads than the queue depth, including reads
+ * that end past EOF. All callbacks must be called
+ * exactly once with the correct data.
+ */
+TEST_P(AsyncReaderTest, manyReads)
+{
+	AsyncReader reader(16, GetParam());
+	if (GetParam() && !reader.isAsync()) {
+		fprintf(stderr, "*** io_uring is not available; testing the synchronous fallback.\n");
+	}
+
+	vector<ReadInfo> reads(500);
+	TestRandom rnd(0x87654321);
+	for (size_t i = 0; i < reads.size(); i++) {
+		ReadInfo &info = reads[i];
+		info.test = this;
+		info.pos = (rnd.next() >> 4) % m_data.size();
+		info.size = 1 + ((rnd.next() >> 8) % 32768);
+		info.buf.reset(new uint8_t[info.size]);
+		info.done = false;
+
+		int ret;
+		while ((ret = reader.submit(m_file, info.pos, info.buf.get(), info.size,
+			readCallback, &info)) == -EAGAIN)
+		{
+			ASSERT_EQ(reader.queueDepth(), reader.pending());
+			ASSERT_GT(reader.wait(1), 0);
+		}
+		ASSERT_EQ(0, ret);
+	}
+
+	EXPECT_EQ(0, reader.waitAll());
+	EXPECT_EQ(0U, reader.pending());
+	EXPECT_EQ(reads.size(), m_callbacks);
+}
+
+/**
+ * Callbacks must not be called from submit(), even if
+ * the read is synchronous. (RpMemFile is never async.)
+ */
+TEST_P(AsyncReaderTest, deferredCallbacks)
+{
+	AsyncReader reader(4, GetParam());
+	RpMemFile *const memFile = new RpMemFile(m_data.data(), m_data.size());
+
+	ReadInfo info;
+	info.test = this;
+	info.pos = 1000;
+	info.size = 2000;
+	info.buf.reset(new uint8_t[info.size]);
+	info.done = false;
+	ASSERT_EQ(0, reader.submit(memFile, info.pos, info.buf.get(), info.size, readCallback, &info));
+	memFile->unref();	// AsyncReader holds a reference.
+
+	EXPECT_FALSE(info.done);
+	EXPECT_EQ(1U, reader.pending());
+	EXPECT_EQ(1, reader.wait(1));
+	EXPECT_TRUE(info.done);
+	EXPECT_EQ(0U, reader.pending());
+}
+
+INSTANTIATE_TEST_CASE_P(AsyncReaderTest, AsyncReaderTest,
+	::testing::Values(true, false));
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: AsyncReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CBCReaderTest.cpp: CBCReader test.                                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpbase/disc/CBCReader.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * CBCReader test.
+ * Parameter: true for CBC; false for ECB.
+ */
+class CBCReaderTest : public ::testing::TestWithParam<bool>
+{
+	protected:
+		CBCReaderTest()
+			: m_file(nullptr)
+			, m_reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			delete m_reader;
+			if (m_file) {
+				m_file->unref();
+			}
+		}
+
+	public:
+		// Data length. This is large enough to use multiple
+		// threads, and it isn't a multiple of the chunk size.
+		static const unsigned int DATA_OFFSET = 0x200;
+		static const unsigned int DATA_LENGTH = 4*1024*1024 + 0x1230;
+
+		static const uint8_t key[16];
+		static const uint8_t iv[16];
+
+	protected:
+		vector<uint8_t> m_image;	// Encrypted image.
+		vector<uint8_t> m_data;		// Expected decrypted data.
+		RpMemFile *m_file;
+		CBCReader *m_reader;
+};
+
+const uint8_t CBCReaderTest::key[16] = {
+	0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,
+	0x88,0x99,0xAA,0xBB,0xCC,0xDD,0xEE,0xFF
+};
+
+const uint8_t CBCReaderTest::iv[16] = {
+	0x0F,0x1E,0x2D,0x3C,0x4B,0x5A,0x69,0x78,
+	0x87,0x96,0xA5,0xB4,0xC3,0xD2,0xE1,0xF0
+};
+
+void CBCReaderTest::SetUp(void)
+{
+	const bool isCBC = GetParam();
+
+	// Random "ciphertext". IAesCipher can only decrypt,
+	// so the expected plaintext is the result of decrypting
+	// the entire image in a single call.
+	m_image.resize(DATA_OFFSET + DATA_LENGTH);
+	TestRandom rnd(0x13579BDF);
+	rnd.fill(m_image.data(), m_image.size());
+
+	m_data.assign(m_image.begin() + DATA_OFFSET, m_image.end());
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher != nullptr);
+	ASSERT_EQ(0, cipher->setChainingMode(isCBC ? IAesCipher::CM_CBC : IAesCipher::CM_ECB));
+	ASSERT_EQ(0, cipher->setKey(key, sizeof(key)));
+	if (isCBC) {
+		ASSERT_EQ(0, cipher->setIV(iv, sizeof(iv)));
+	}
+	ASSERT_EQ(m_data.size(), cipher->decrypt(m_data.data(), m_data.size()));
+
+	m_file = new RpMemFile(m_image.data(), m_image.size());
+	m_reader = new CBCReader(m_file, DATA_OFFSET, DATA_LENGTH, key, isCBC ? iv : nullptr);
+	ASSERT_TRUE(m_reader->isOpen());
+}
+
+/**
+ * Read all of the data in one call.
+ * This is decrypted using multiple threads.
+ */
+TEST_P(CBCReaderTest, fullRead)
+{
+	vector<uint8_t> buf(DATA_LENGTH);
+	ASSERT_EQ(0, m_reader->seek(0));
+	ASSERT_EQ(buf.size(), m_reader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+	EXPECT_EQ((off64_t)DATA_LENGTH, m_reader->tell());
+}
+
+/**
+ * Unaligned reads, including large reads that
+ * are decrypted using multiple threads.
+ */
+TEST_P(CBCReaderTest, unalignedReads)
+{
+	static const struct {
+		unsigned int pos;
+		unsigned int size;
+	} reads[] = {
+		{0x3, 0x5},				// within the first block
+		{0xF, 0x22},				// head and tail blocks
+		{0x1234, 0x10},				// one block's worth, unaligned
+		{0x20000, 0x4000},			// aligned
+		{0x10007, 0x180009},			// multi-threaded
+		{0x1F, DATA_LENGTH - 0x1F},		// multi-threaded, to the end
+		{DATA_LENGTH - 0x17, 0x100},		// short read
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(reads); i++) {
+		const size_t expected = std::min(reads[i].size, DATA_LENGTH - reads[i].pos);
+		vector<uint8_t> buf(reads[i].size);
+		ASSERT_EQ(expected, m_reader->seekAndRead(reads[i].pos, buf.data(), buf.size())) << "pos " << reads[i].pos;
+		EXPECT_EQ(0, memcmp(buf.data(), &m_data[reads[i].pos], expected)) << "pos " << reads[i].pos;
+	}
+}
+
+/**
+ * pread() should not depend on or change the current position.
+ */
+TEST_P(CBCReaderTest, preadKeepsPosition)
+{
+	uint8_t buf[0x123];
+	ASSERT_EQ(0, m_reader->seek(0x101));
+
+	// Read from later and earlier positions.
+	ASSERT_EQ(sizeof(buf), m_reader->pread(0x31111, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[0x31111], sizeof(buf)));
+	ASSERT_EQ(sizeof(buf), m_reader->pread(0x5, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[0x5], sizeof(buf)));
+	EXPECT_EQ(0x101, m_reader->tell());
+
+	// Sequential reads should continue from the original position.
+	ASSERT_EQ(sizeof(buf), m_reader->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[0x101], sizeof(buf)));
+	ASSERT_EQ(sizeof(buf), m_reader->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_data[0x101 + sizeof(buf)], sizeof(buf)));
+	EXPECT_EQ((off64_t)(0x101 + 2*sizeof(buf)), m_reader->tell());
+
+	// Reading past the end returns nothing.
+	EXPECT_EQ(0U, m_reader->pread(DATA_LENGTH, buf, sizeof(buf)));
+}
+
+INSTANTIATE_TEST_CASE_P(CBCReaderTest, CBCReaderTest,
+	::testing::Values(true, false));
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: CBCReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
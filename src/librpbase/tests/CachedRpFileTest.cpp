@@ -0,0 +1,324 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CachedRpFileTest.cpp: CachedRpFile test.                                *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// CachedRpFile
+#include "librpbase/file/CachedRpFile.hpp"
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace LibRomData { namespace Tests {
+
+class CachedRpFileTest : public ::testing::Test
+{
+	protected:
+		CachedRpFileTest()
+			: m_memFile(nullptr)
+			, m_file(nullptr)
+		{ }
+
+		void SetUp(void) final
+		{
+			// Fill the buffer with a position-dependent pattern.
+			for (unsigned int i = 0; i < sizeof(m_buf); i++) {
+				m_buf[i] = static_cast<uint8_t>((i * 7) ^ (i >> 8));
+			}
+
+			m_memFile = new RpMemFile(m_buf, sizeof(m_buf));
+			m_file = new CachedRpFile(m_memFile, BLOCK_SIZE, BLOCK_COUNT);
+		}
+
+		void TearDown(void) final
+		{
+			if (m_file) {
+				m_file->unref();
+				m_file = nullptr;
+			}
+			if (m_memFile) {
+				m_memFile->unref();
+				m_memFile = nullptr;
+			}
+		}
+
+	public:
+		// Cache parameters for testing.
+		static const unsigned int BLOCK_SIZE = 4096;
+		static const unsigned int BLOCK_COUNT = 16;
+
+	protected:
+		// Test file buffer. (64 blocks, plus a partial block)
+		uint8_t m_buf[(BLOCK_SIZE * 64) + 1234];
+
+		RpMemFile *m_memFile;
+		CachedRpFile *m_file;
+};
+
+/**
+ * Random reads must return the same data as the underlying file.
+ */
+TEST_F(CachedRpFileTest, randomReads)
+{
+	uint8_t buf[BLOCK_SIZE * 3];
+	TestRandom rnd(0x12345678);
+	for (unsigned int i = 0; i < 1000; i++) {
+		const off64_t pos = (rnd.next() >> 8) % sizeof(m_buf);
+		const size_t size = (rnd.next() >> 8) % sizeof(buf);
+
+		size_t expected = size;
+		if (static_cast<size_t>(pos) + size > sizeof(m_buf)) {
+			expected = sizeof(m_buf) - static_cast<size_t>(pos);
+		}
+
+		ASSERT_EQ(expected, m_file->pread(pos, buf, size)) << "pos " << pos << ", size " << size;
+		ASSERT_EQ(0, memcmp(buf, &m_buf[pos], expected)) << "pos " << pos << ", size " << size;
+	}
+}
+
+/**
+ * Repeated small reads from the same block must hit the cache.
+ */
+TEST_F(CachedRpFileTest, hitsAndMisses)
+{
+	uint8_t buf[16];
+	for (unsigned int i = 0; i < 10; i++) {
+		ASSERT_EQ(sizeof(buf), m_file->pread(BLOCK_SIZE * 5 + i * 16, buf, sizeof(buf)));
+		EXPECT_EQ(0, memcmp(buf, &m_buf[BLOCK_SIZE * 5 + i * 16], sizeof(buf)));
+	}
+
+	CachedRpFile::Stats stats;
+	m_file->getStats(&stats);
+	EXPECT_EQ(1U, stats.misses);
+	EXPECT_EQ(9U, stats.hits);
+	EXPECT_EQ(1U, stats.reads);
+	EXPECT_EQ(static_cast<uint64_t>(BLOCK_SIZE), stats.bytesRead);
+}
+
+/**
+ * Sequential reads must use read-ahead to reduce the
+ * number of reads from the underlying file.
+ */
+TEST_F(CachedRpFileTest, sequentialReadAhead)
+{
+	uint8_t buf[1024];
+	m_file->rewind();
+	size_t total = 0;
+	for (;;) {
+		const size_t size = m_file->read(buf, sizeof(buf));
+		if (size == 0)
+			break;
+		ASSERT_EQ(0, memcmp(buf, &m_buf[total], size));
+		total += size;
+	}
+	EXPECT_EQ(sizeof(m_buf), total);
+	EXPECT_EQ(static_cast<off64_t>(sizeof(m_buf)), m_file->tell());
+
+	// The read-ahead window doubles from 1 block up to
+	// BLOCK_COUNT / 4 blocks: 1 + 2 + (15 * 4) + 2 = 65 blocks.
+	const unsigned int blocks = (sizeof(m_buf) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	ASSERT_EQ(65U, blocks);
+	CachedRpFile::Stats stats;
+	m_file->getStats(&stats);
+	EXPECT_EQ(18U, stats.reads);
+	EXPECT_EQ(18U, stats.misses);
+	EXPECT_EQ(static_cast<uint64_t>(blocks - 18), stats.readahead);
+	EXPECT_EQ(0U, stats.bypass);
+	EXPECT_EQ(static_cast<uint64_t>(sizeof(m_buf)), stats.bytesRead);
+}
+
+/**
+ * Read one byte from each of the first 8 blocks.
+ * @param file CachedRpFile.
+ * @return Bytes read from the underlying file.
+ */
+static uint64_t readBlockStarts(CachedRpFile *file)
+{
+	uint8_t b;
+	for (unsigned int i = 0; i < 8; i++) {
+		EXPECT_EQ(1U, file->pread(i * CachedRpFileTest::BLOCK_SIZE, &b, 1));
+	}
+
+	CachedRpFile::Stats stats;
+	file->getStats(&stats);
+	return stats.bytesRead;
+}
+
+/**
+ * AH_RANDOM must disable read-ahead, even if the
+ * accessed blocks happen to be adjacent.
+ */
+TEST_F(CachedRpFileTest, randomAccessHint)
+{
+	// Without the hint, adjacent blocks trigger read-ahead.
+	const uint64_t bytesNormal = readBlockStarts(m_file);
+
+	CachedRpFile *const file = new CachedRpFile(m_memFile, BLOCK_SIZE, BLOCK_COUNT);
+	EXPECT_EQ(0, file->setAccessHint(IRpFile::AH_RANDOM));
+	const uint64_t bytesRandom = readBlockStarts(file);
+	file->unref();
+
+	// Without the hint, blocks 0, 1-2, 3-6, and 7-10 are read.
+	EXPECT_EQ(static_cast<uint64_t>(BLOCK_SIZE * 11), bytesNormal);
+	EXPECT_EQ(static_cast<uint64_t>(BLOCK_SIZE * 8), bytesRandom);
+}
+
+/**
+ * AH_SEQUENTIAL must use the maximum read-ahead window immediately.
+ */
+TEST_F(CachedRpFileTest, sequentialAccessHint)
+{
+	EXPECT_EQ(0, m_file->setAccessHint(IRpFile::AH_SEQUENTIAL));
+
+	uint8_t buf[1024];
+	size_t total = 0;
+	for (;;) {
+		const size_t size = m_file->read(buf, sizeof(buf));
+		if (size == 0)
+			break;
+		ASSERT_EQ(0, memcmp(buf, &m_buf[total], size));
+		total += size;
+	}
+	EXPECT_EQ(sizeof(m_buf), total);
+
+	// Maximum read-ahead is BLOCK_COUNT / 4 blocks.
+	const unsigned int blocks = (sizeof(m_buf) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const unsigned int maxRA = BLOCK_COUNT / 4;
+	CachedRpFile::Stats stats;
+	m_file->getStats(&stats);
+	EXPECT_EQ(static_cast<uint64_t>((blocks + maxRA - 1) / maxRA), stats.reads);
+	EXPECT_EQ(static_cast<uint64_t>(sizeof(m_buf)), stats.bytesRead);
+}
+
+/**
+ * Access hints must be passed through to RpFile.
+ * NOTE: The effect on the kernel's read-ahead can't be measured
+ * reliably here, so this only checks that the hints are accepted
+ * and don't change the data that's read.
+ */
+TEST_F(CachedRpFileTest, rpFileAccessHints)
+{
+	static const char filename[] = "CachedRpFileTest.bin";
+	RpFile *const rpFile = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(rpFile->isOpen());
+	ASSERT_EQ(sizeof(m_buf), rpFile->write(m_buf, sizeof(m_buf)));
+	rpFile->unref();
+
+	RpFile *const rdFile = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(rdFile->isOpen());
+	CachedRpFile *const file = new CachedRpFile(rdFile, BLOCK_SIZE, BLOCK_COUNT);
+	rdFile->unref();
+
+	static const IRpFile::AccessHint hints[] = {
+		IRpFile::AH_SEQUENTIAL, IRpFile::AH_RANDOM,
+		IRpFile::AH_WILLNEED, IRpFile::AH_NORMAL,
+	};
+	uint8_t buf[BLOCK_SIZE * 2];
+	for (size_t i = 0; i < ARRAY_SIZE(hints); i++) {
+		EXPECT_EQ(0, file->setAccessHint(hints[i])) << "hint " << static_cast<int>(hints[i]);
+		EXPECT_EQ(0, file->setAccessHint(hints[i], BLOCK_SIZE, sizeof(buf))) << "hint " << static_cast<int>(hints[i]);
+
+		const off64_t pos = BLOCK_SIZE * (3 * i) + 100;
+		ASSERT_EQ(sizeof(buf), file->pread(pos, buf, sizeof(buf)));
+		EXPECT_EQ(0, memcmp(buf, &m_buf[pos], sizeof(buf)));
+	}
+
+	// Invalid ranges are rejected by RpFile.
+	EXPECT_EQ(-EINVAL, file->setAccessHint(IRpFile::AH_SEQUENTIAL, -1));
+
+	file->unref();
+	remove(filename);
+}
+
+/**
+ * shrink() must keep the most recently used blocks.
+ */
+TEST_F(CachedRpFileTest, shrink)
+{
+	EXPECT_EQ(0, m_file->setAccessHint(IRpFile::AH_RANDOM));
+
+	// Load 8 blocks, then use blocks 2 and 6 again.
+	uint8_t b;
+	for (unsigned int i = 0; i < 8; i++) {
+		ASSERT_EQ(1U, m_file->pread(i * BLOCK_SIZE, &b, 1));
+	}
+	ASSERT_EQ(1U, m_file->pread(2 * BLOCK_SIZE, &b, 1));
+	ASSERT_EQ(1U, m_file->pread(6 * BLOCK_SIZE, &b, 1));
+
+	m_file->shrink(2);
+	m_file->resetStats();
+
+	// Blocks 2 and 6 are still cached.
+	ASSERT_EQ(1U, m_file->pread(2 * BLOCK_SIZE + 1, &b, 1));
+	EXPECT_EQ(m_buf[2 * BLOCK_SIZE + 1], b);
+	ASSERT_EQ(1U, m_file->pread(6 * BLOCK_SIZE + 1, &b, 1));
+	EXPECT_EQ(m_buf[6 * BLOCK_SIZE + 1], b);
+	CachedRpFile::Stats stats;
+	m_file->getStats(&stats);
+	EXPECT_EQ(2U, stats.hits);
+	EXPECT_EQ(0U, stats.misses);
+
+	// Other blocks were released.
+	ASSERT_EQ(1U, m_file->pread(0, &b, 1));
+	EXPECT_EQ(m_buf[0], b);
+	m_file->getStats(&stats);
+	EXPECT_EQ(1U, stats.misses);
+
+	// Only 2 blocks are cached now, so block 2 was evicted.
+	ASSERT_EQ(1U, m_file->pread(2 * BLOCK_SIZE, &b, 1));
+	m_file->getStats(&stats);
+	EXPECT_EQ(2U, stats.misses);
+
+	// Large reads still work.
+	uint8_t buf[BLOCK_SIZE * 3];
+	ASSERT_EQ(sizeof(buf), m_file->pread(100, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_buf[100], sizeof(buf)));
+}
+
+/**
+ * pread() must not change the file position.
+ */
+TEST_F(CachedRpFileTest, preadPosition)
+{
+	uint8_t buf[64];
+	ASSERT_EQ(0, m_file->seek(100));
+	ASSERT_EQ(sizeof(buf), m_file->pread(BLOCK_SIZE * 10, buf, sizeof(buf)));
+	EXPECT_EQ(100, m_file->tell());
+
+	ASSERT_EQ(sizeof(buf), m_file->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_buf[100], sizeof(buf)));
+	EXPECT_EQ(static_cast<off64_t>(100 + sizeof(buf)), m_file->tell());
+
+	// Reading past the end of the file.
+	EXPECT_EQ(0U, m_file->pread(sizeof(m_buf), buf, sizeof(buf)));
+	EXPECT_EQ(10U, m_file->pread(sizeof(m_buf) - 10, buf, sizeof(buf)));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: CachedRpFile tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
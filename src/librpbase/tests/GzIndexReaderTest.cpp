@@ -0,0 +1,479 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * GzIndexReaderTest.cpp: GzIndexReader test.                              *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// zlib
+#include <zlib.h>
+
+// GzIndexReader
+#include "librpbase/file/CachedRpFile.hpp"
+#include "librpbase/file/FileSystem.hpp"
+#include "librpbase/file/GzIndexReader.hpp"
+#include "librpbase/file/IoStats.hpp"
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class GzIndexReaderTest : public ::testing::Test
+{
+	protected:
+		GzIndexReaderTest()
+			: m_memFile(nullptr)
+			, m_gzReader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			delete m_gzReader;
+			m_gzReader = nullptr;
+			if (m_memFile) {
+				m_memFile->unref();
+				m_memFile = nullptr;
+			}
+		}
+
+		/**
+		 * Compress data as a single gzip member.
+		 * @param out	[in,out] Output buffer. (data is appended)
+		 * @param data	[in] Uncompressed data.
+		 * @param size	[in] Size of data.
+		 */
+		static void gzipAppend(vector<uint8_t> &out, const uint8_t *data, size_t size);
+
+		/**
+		 * Write a test file.
+		 * @param filename	[in] Filename.
+		 * @param data		[in] File data.
+		 */
+		static void writeFile(const char *filename, const vector<uint8_t> &data)
+		{
+			RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+			ASSERT_TRUE(file->isOpen());
+			EXPECT_EQ(data.size(), file->write(data.data(), data.size()));
+			file->unref();
+		}
+
+		/**
+		 * Read from a gzip-compressed file using a new GzIndexReader.
+		 * @param filename	[in] Filename.
+		 * @param pos		[in] Uncompressed position.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of compressed bytes read from the file, including the index cache.
+		 */
+		static uint64_t readWithNewReader(const char *filename, off64_t pos, uint8_t *ptr, size_t size);
+
+	public:
+		// Uncompressed size of each gzip member.
+		static const unsigned int MEMBER1_SIZE = 5*1024*1024 + 1234;
+		static const unsigned int MEMBER2_SIZE = 3*1024*1024 + 567;
+
+	protected:
+		vector<uint8_t> m_data;		// Uncompressed data.
+		vector<uint8_t> m_gzData;	// Compressed data.
+
+		RpMemFile *m_memFile;
+		GzIndexReader *m_gzReader;
+};
+
+/**
+ * Compress data as a single gzip member.
+ * @param out	[in,out] Output buffer. (data is appended)
+ * @param data	[in] Uncompressed data.
+ * @param size	[in] Size of data.
+ */
+void GzIndexReaderTest::gzipAppend(vector<uint8_t> &out, const uint8_t *data, size_t size)
+{
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	// windowBits 15 + 16: gzip header and trailer
+	ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY));
+
+	const size_t start = out.size();
+	out.resize(start + deflateBound(&strm, static_cast<uLong>(size)));
+	strm.next_in = const_cast<Bytef*>(data);
+	strm.avail_in = static_cast<uInt>(size);
+	strm.next_out = &out[start];
+	strm.avail_out = static_cast<uInt>(out.size() - start);
+	ASSERT_EQ(Z_STREAM_END, deflate(&strm, Z_FINISH));
+	out.resize(start + strm.total_out);
+	deflateEnd(&strm);
+}
+
+/**
+ * Read from a gzip-compressed file using a new GzIndexReader.
+ * @param filename	[in] Filename.
+ * @param pos		[in] Uncompressed position.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of compressed bytes read from the file, including the index cache.
+ */
+uint64_t GzIndexReaderTest::readWithNewReader(const char *filename, off64_t pos, uint8_t *ptr, size_t size)
+{
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	EXPECT_TRUE(file->isOpen());
+	GzIndexReader *const gzReader = new GzIndexReader(file, filename);
+	file->unref();
+	EXPECT_TRUE(gzReader->isOpen());
+	EXPECT_EQ(size, gzReader->pread(pos, ptr, size));
+	delete gzReader;
+
+	IoStats::snapshot(after);
+	IoStats::setEnabled(false);
+
+	uint64_t bytesRead = 0;
+	EXPECT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < after.size() && i < before.size(); i++) {
+		if (!strcmp(after[i].name, "RpFile")) {
+			bytesRead = after[i].bytesRead - before[i].bytesRead;
+		}
+	}
+	return bytesRead;
+}
+
+void GzIndexReaderTest::SetUp(void)
+{
+	// Somewhat compressible data, so the deflate
+	// blocks aren't stored blocks.
+	m_data.resize(MEMBER1_SIZE + MEMBER2_SIZE);
+	TestRandom rnd(0x12345678);
+	rnd.fillText(m_data.data(), m_data.size());
+
+	// Two concatenated gzip members.
+	gzipAppend(m_gzData, m_data.data(), MEMBER1_SIZE);
+	gzipAppend(m_gzData, &m_data[MEMBER1_SIZE], MEMBER2_SIZE);
+
+	m_memFile = new RpMemFile(m_gzData.data(), m_gzData.size());
+	m_gzReader = new GzIndexReader(m_memFile);
+	ASSERT_TRUE(m_gzReader->isOpen());
+}
+
+/**
+ * The exact uncompressed size must include all gzip members.
+ */
+TEST_F(GzIndexReaderTest, exactSize)
+{
+	EXPECT_EQ(static_cast<off64_t>(m_data.size()), m_gzReader->exactSize());
+}
+
+/**
+ * size() uses ISIZE until the file has been decompressed.
+ */
+TEST_F(GzIndexReaderTest, sizeEstimate)
+{
+	// The last member's ISIZE is smaller than the compressed
+	// data, so it can't be used as an estimate.
+	EXPECT_EQ(static_cast<off64_t>(m_data.size()), m_gzReader->size());
+
+	// Single gzip member: The estimate is exact.
+	vector<uint8_t> gzData;
+	gzipAppend(gzData, m_data.data(), MEMBER1_SIZE);
+	RpMemFile *const memFile = new RpMemFile(gzData.data(), gzData.size());
+	GzIndexReader gzReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(gzReader.isOpen());
+	EXPECT_EQ(static_cast<off64_t>(MEMBER1_SIZE), gzReader.size());
+}
+
+/**
+ * Opening a gzip-compressed RpFile and getting its size
+ * must not decompress the file.
+ */
+TEST_F(GzIndexReaderTest, rpFileSizeIsLazy)
+{
+	static const char filename[] = "GzIndexReaderTest.gz";
+	vector<uint8_t> gzData;
+	gzipAppend(gzData, m_data.data(), MEMBER1_SIZE);
+	RpFile *file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(gzData.size(), file->write(gzData.data(), gzData.size()));
+	file->unref();
+
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	ASSERT_TRUE(file->isOpen());
+	EXPECT_EQ(static_cast<off64_t>(MEMBER1_SIZE), file->size());
+
+	IoStats::snapshot(after);
+	IoStats::setEnabled(false);
+	file->unref();
+	remove(filename);
+
+	// Only the gzip header and trailer should have been read.
+	ASSERT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < after.size(); i++) {
+		if (!strcmp(after[i].name, "RpFile")) {
+			EXPECT_LT(after[i].bytesRead - before[i].bytesRead, 1024U);
+		}
+	}
+}
+
+/**
+ * Reading the whole file sequentially.
+ */
+TEST_F(GzIndexReaderTest, sequentialRead)
+{
+	uint8_t buf[10000];
+	off64_t pos = 0;
+	for (;;) {
+		const size_t size = m_gzReader->pread(pos, buf, sizeof(buf));
+		if (size == 0)
+			break;
+		ASSERT_EQ(0, memcmp(buf, &m_data[static_cast<size_t>(pos)], size)) << "pos " << pos;
+		pos += size;
+	}
+	EXPECT_EQ(static_cast<off64_t>(m_data.size()), pos);
+}
+
+/**
+ * Random reads, including backwards seeks, must return
+ * the same data as the uncompressed file.
+ */
+TEST_F(GzIndexReaderTest, randomReads)
+{
+	// Build the seek point index first.
+	ASSERT_EQ(static_cast<off64_t>(m_data.size()), m_gzReader->exactSize());
+
+	uint8_t buf[65536];
+	TestRandom rnd(0x87654321);
+	for (unsigned int i = 0; i < 200; i++) {
+		const off64_t pos = (rnd.next() >> 4) % m_data.size();
+		const size_t size = (rnd.next() >> 8) % sizeof(buf);
+
+		size_t expected = size;
+		if (static_cast<size_t>(pos) + size > m_data.size()) {
+			expected = m_data.size() - static_cast<size_t>(pos);
+		}
+
+		ASSERT_EQ(expected, m_gzReader->pread(pos, buf, size)) << "pos " << pos << ", size " << size;
+		ASSERT_EQ(0, memcmp(buf, &m_data[static_cast<size_t>(pos)], expected)) << "pos " << pos << ", size " << size;
+	}
+}
+
+/**
+ * Reads before the index is complete.
+ * This includes a read that crosses the gzip member boundary.
+ */
+TEST_F(GzIndexReaderTest, readsBeforeSize)
+{
+	const off64_t positions[] = {
+		MEMBER1_SIZE - 100, 1000, 2*1024*1024 + 5, 0,
+		MEMBER1_SIZE + MEMBER2_SIZE - 50, 3*1024*1024,
+	};
+
+	uint8_t buf[200];
+	for (size_t i = 0; i < sizeof(positions)/sizeof(positions[0]); i++) {
+		const off64_t pos = positions[i];
+		size_t expected = sizeof(buf);
+		if (static_cast<size_t>(pos) + expected > m_data.size()) {
+			expected = m_data.size() - static_cast<size_t>(pos);
+		}
+		ASSERT_EQ(expected, m_gzReader->pread(pos, buf, sizeof(buf))) << "pos " << pos;
+		ASSERT_EQ(0, memcmp(buf, &m_data[static_cast<size_t>(pos)], expected)) << "pos " << pos;
+	}
+
+	// Reading past the end of the file.
+	EXPECT_EQ(0U, m_gzReader->pread(m_data.size(), buf, sizeof(buf)));
+}
+
+/**
+ * CachedRpFile must not clamp reads to the ISIZE estimate,
+ * since it may be smaller than the actual uncompressed size.
+ */
+TEST_F(GzIndexReaderTest, cachedRpFileReadsPastEstimate)
+{
+	// The second member is highly compressible, so its ISIZE
+	// is larger than the compressed data and is used as the
+	// estimate, even though it doesn't include the first member.
+	static const char filename[] = "GzIndexReaderTest.gz";
+	static const unsigned int ZERO_SIZE = 1024*1024;
+	const vector<uint8_t> zeroes(ZERO_SIZE);
+	vector<uint8_t> gzData;
+	gzipAppend(gzData, m_data.data(), 65536);
+	gzipAppend(gzData, zeroes.data(), zeroes.size());
+	RpFile *file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_EQ(gzData.size(), file->write(gzData.data(), gzData.size()));
+	file->unref();
+
+	file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	ASSERT_TRUE(file->isOpen());
+	CachedRpFile *const cachedFile = new CachedRpFile(file);
+	file->unref();
+
+	// Read the end of the file.
+	uint8_t buf[256];
+	const off64_t pos = 65536 + ZERO_SIZE - 100;
+	EXPECT_EQ(100U, cachedFile->pread(pos, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, zeroes.data(), 100));
+	EXPECT_EQ(0U, cachedFile->pread(65536 + ZERO_SIZE, buf, sizeof(buf)));
+	EXPECT_EQ(0, cachedFile->lastError());
+
+	// The size must be updated once the whole file has been decompressed.
+	EXPECT_EQ(static_cast<off64_t>(65536 + ZERO_SIZE), cachedFile->size());
+
+	cachedFile->unref();
+	remove(filename);
+}
+
+/**
+ * ISIZE must not be used if the compressed data is large
+ * enough for the uncompressed data to exceed 4 GiB, since
+ * it's only the lower 32 bits of the uncompressed size.
+ */
+TEST_F(GzIndexReaderTest, isizeNotTrustedForLargeFiles)
+{
+	// Incompressible data, so the compressed data is larger
+	// than 4 GiB divided by the maximum deflate ratio.
+	static const unsigned int RANDOM_SIZE = 5*1024*1024;
+	vector<uint8_t> data(RANDOM_SIZE);
+	TestRandom rnd(0x4953495A);
+	rnd.fill(data.data(), data.size());
+	vector<uint8_t> gzData;
+	gzipAppend(gzData, data.data(), data.size());
+
+	// Simulate a truncated ISIZE by making it larger than the actual size.
+	const uint32_t isize = RANDOM_SIZE + 4096;
+	const size_t isize_pos = gzData.size() - 4;
+	gzData[isize_pos+0] = isize & 0xFF;
+	gzData[isize_pos+1] = (isize >> 8) & 0xFF;
+	gzData[isize_pos+2] = (isize >> 16) & 0xFF;
+	gzData[isize_pos+3] = (isize >> 24) & 0xFF;
+
+	RpMemFile *const memFile = new RpMemFile(gzData.data(), gzData.size());
+	GzIndexReader gzReader(memFile);
+	memFile->unref();
+	ASSERT_TRUE(gzReader.isOpen());
+	EXPECT_EQ(static_cast<off64_t>(RANDOM_SIZE), gzReader.size());
+}
+
+/**
+ * The seek point index must be saved once the end of the
+ * file is reached, and used by the next reader.
+ */
+TEST_F(GzIndexReaderTest, indexCacheSavedAtEof)
+{
+	static const char filename[] = "GzIndexReaderTest.gz";
+	writeFile(filename, m_gzData);
+	GzIndexReader::setCacheDirectory(".");
+	GzIndexReader::setCacheEnabled(true);
+	const string cacheFilename = GzIndexReader::getCacheFilename(filename);
+	ASSERT_FALSE(cacheFilename.empty());
+	FileSystem::delete_file(cacheFilename);
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	GzIndexReader *const gzReader = new GzIndexReader(file, filename);
+	file->unref();
+	ASSERT_TRUE(gzReader->isOpen());
+
+	// Read the whole file sequentially.
+	vector<uint8_t> buf(65536);
+	off64_t pos = 0;
+	size_t size;
+	while ((size = gzReader->pread(pos, buf.data(), buf.size())) > 0) {
+		pos += size;
+	}
+	EXPECT_EQ(static_cast<off64_t>(m_data.size()), pos);
+
+	// The index must be saved before the reader is closed.
+	EXPECT_EQ(0, FileSystem::access(cacheFilename, R_OK));
+	delete gzReader;
+
+	// Reading the end of the file must use the index.
+	const off64_t endPos = m_data.size() - 100;
+	const uint64_t bytesRead = readWithNewReader(filename, endPos, buf.data(), 100);
+	EXPECT_EQ(0, memcmp(buf.data(), &m_data[static_cast<size_t>(endPos)], 100));
+	EXPECT_LT(bytesRead, m_gzData.size() / 2);
+
+	GzIndexReader::setCacheEnabled(false);
+	GzIndexReader::setCacheDirectory(string());
+	FileSystem::delete_file(cacheFilename);
+	remove(filename);
+}
+
+/**
+ * If the file wasn't completely decompressed, the partial
+ * seek point index must be saved when the reader is closed.
+ */
+TEST_F(GzIndexReaderTest, indexCacheSavedOnClose)
+{
+	static const char filename[] = "GzIndexReaderTest.gz";
+	writeFile(filename, m_gzData);
+	GzIndexReader::setCacheDirectory(".");
+	GzIndexReader::setCacheEnabled(true);
+	const string cacheFilename = GzIndexReader::getCacheFilename(filename);
+	ASSERT_FALSE(cacheFilename.empty());
+	FileSystem::delete_file(cacheFilename);
+
+	// Read from the second gzip member.
+	uint8_t buf[100];
+	const off64_t pos = MEMBER1_SIZE + 1024*1024;
+	readWithNewReader(filename, pos, buf, sizeof(buf));
+	EXPECT_EQ(0, memcmp(buf, &m_data[static_cast<size_t>(pos)], sizeof(buf)));
+	EXPECT_EQ(0, FileSystem::access(cacheFilename, R_OK));
+
+	// Reading the same position again must use the index.
+	const uint64_t bytesRead = readWithNewReader(filename, pos, buf, sizeof(buf));
+	EXPECT_EQ(0, memcmp(buf, &m_data[static_cast<size_t>(pos)], sizeof(buf)));
+	EXPECT_LT(bytesRead, m_gzData.size() / 2);
+
+	// The partial index must not be mistaken for a complete one.
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+	GzIndexReader gzReader(file, filename);
+	file->unref();
+	ASSERT_TRUE(gzReader.isOpen());
+	EXPECT_EQ(static_cast<off64_t>(m_data.size()), gzReader.exactSize());
+
+	GzIndexReader::setCacheEnabled(false);
+	GzIndexReader::setCacheDirectory(string());
+	FileSystem::delete_file(cacheFilename);
+	remove(filename);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: GzIndexReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,242 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * HashTest.cpp: SHA-256, MD5, and CRC-32 tests.                           *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// zlib
+#include <zlib.h>
+
+// librpbase
+#include "librpbase/crypto/Crc32.hpp"
+#include "librpbase/crypto/HashMulti.hpp"
+#include "librpbase/crypto/Md5.hpp"
+#include "librpbase/crypto/Sha256.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+class HashTest : public ::testing::Test
+{
+	protected:
+		/**
+		 * Convert a digest to a hexadecimal string.
+		 * @param digest Digest.
+		 * @param size Digest size, in bytes.
+		 * @return Hexadecimal string.
+		 */
+		static string toHex(const uint8_t *digest, unsigned int size);
+
+		/**
+		 * Get pseudo-random test data.
+		 * @param size Size, in bytes.
+		 * @return Test data.
+		 */
+		static vector<uint8_t> randomData(size_t size);
+};
+
+/**
+ * Convert a digest to a hexadecimal string.
+ * @param digest Digest.
+ * @param size Digest size, in bytes.
+ * @return Hexadecimal string.
+ */
+string HashTest::toHex(const uint8_t *digest, unsigned int size)
+{
+	string s;
+	s.reserve(size * 2);
+	for (unsigned int i = 0; i < size; i++) {
+		char buf[3];
+		snprintf(buf, sizeof(buf), "%02x", digest[i]);
+		s += buf;
+	}
+	return s;
+}
+
+/**
+ * Get pseudo-random test data.
+ * @param size Size, in bytes.
+ * @return Test data.
+ */
+vector<uint8_t> HashTest::randomData(size_t size)
+{
+	vector<uint8_t> data(size);
+	TestRandom rnd(0x2468ACE1);
+	rnd.fill(data.data(), size);
+	return data;
+}
+
+/**
+ * SHA-256: FIPS 180-2 test vectors.
+ */
+TEST_F(HashTest, sha256Vectors)
+{
+	static const struct {
+		const char *msg;
+		const char *digest;
+	} vectors[] = {
+		{"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+		{"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+		{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+		 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+	};
+
+	uint8_t digest[Sha256::DIGEST_SIZE];
+	for (size_t i = 0; i < ARRAY_SIZE(vectors); i++) {
+		Sha256::hash(vectors[i].msg, strlen(vectors[i].msg), digest);
+		EXPECT_EQ(vectors[i].digest, toHex(digest, sizeof(digest))) << "msg: " << vectors[i].msg;
+	}
+}
+
+/**
+ * SHA-256: One million 'a's, hashed incrementally with
+ * chunk sizes that aren't multiples of the block size.
+ */
+TEST_F(HashTest, sha256Incremental)
+{
+	static const size_t TOTAL = 1000000;
+	vector<char> buf(TOTAL, 'a');
+
+	Sha256 sha256;
+	size_t pos = 0;
+	for (size_t chunk = 1; pos < TOTAL; chunk = (chunk * 7) % 1013 + 1) {
+		const size_t sz = (TOTAL - pos < chunk ? TOTAL - pos : chunk);
+		sha256.update(&buf[pos], sz);
+		pos += sz;
+	}
+
+	uint8_t digest[Sha256::DIGEST_SIZE];
+	sha256.finish(digest);
+	EXPECT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+		toHex(digest, sizeof(digest)));
+}
+
+/**
+ * MD5: RFC 1321 test vectors.
+ */
+TEST_F(HashTest, md5Vectors)
+{
+	static const struct {
+		const char *msg;
+		const char *digest;
+	} vectors[] = {
+		{"", "d41d8cd98f00b204e9800998ecf8427e"},
+		{"a", "0cc175b9c0f1b6a831c399e269772661"},
+		{"abc", "900150983cd24fb0d6963f7d28e17f72"},
+		{"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+		{"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+		{"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+		 "57edf4a22be3c955ac49da2e2107b67a"},
+	};
+
+	uint8_t digest[Md5::DIGEST_SIZE];
+	for (size_t i = 0; i < ARRAY_SIZE(vectors); i++) {
+		Md5::hash(vectors[i].msg, strlen(vectors[i].msg), digest);
+		EXPECT_EQ(vectors[i].digest, toHex(digest, sizeof(digest))) << "msg: " << vectors[i].msg;
+	}
+
+	// Incremental hashing across block boundaries.
+	Md5 md5;
+	const char *const msg = vectors[ARRAY_SIZE(vectors) - 1].msg;
+	md5.update(msg, 3);
+	md5.update(msg + 3, 70);
+	md5.update(msg + 73, strlen(msg) - 73);
+	md5.finish(digest);
+	EXPECT_EQ(vectors[ARRAY_SIZE(vectors) - 1].digest, toHex(digest, sizeof(digest)));
+}
+
+/**
+ * CRC-32: Compare against zlib for various sizes and alignments.
+ */
+TEST_F(HashTest, crc32MatchesZlib)
+{
+	EXPECT_EQ(0xCBF43926U, Crc32::calc("123456789", 9));
+
+	const vector<uint8_t> data = randomData(1024*1024 + 77);
+	static const size_t sizes[] = {0, 1, 15, 16, 63, 64, 65, 127, 128, 200, 4096, 65537};
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		for (size_t align = 0; align < 4; align++) {
+			const uint32_t expected = crc32(0, &data[align], static_cast<uInt>(sizes[i]));
+			EXPECT_EQ(expected, Crc32::calc(&data[align], sizes[i]))
+				<< "size " << sizes[i] << ", align " << align;
+		}
+	}
+
+	// Entire buffer, in one call and incrementally.
+	const uint32_t expected = crc32(0, data.data(), static_cast<uInt>(data.size()));
+	EXPECT_EQ(expected, Crc32::calc(data.data(), data.size()));
+
+	Crc32 crc;
+	size_t pos = 0;
+	for (size_t chunk = 1; pos < data.size(); chunk = (chunk * 13) % 70001 + 1) {
+		const size_t sz = (data.size() - pos < chunk ? data.size() - pos : chunk);
+		crc.update(&data[pos], sz);
+		pos += sz;
+	}
+	EXPECT_EQ(expected, crc.value());
+
+	crc.reset();
+	EXPECT_EQ(0U, crc.value());
+}
+
+/**
+ * HashMulti: Results must match hashing each buffer separately.
+ */
+TEST_F(HashTest, hashMulti)
+{
+	const vector<uint8_t> data = randomData(1024*1024);
+	static const size_t sizes[] = {0, 3, 64, 100000, 262144, 300000, 1000, 330000};
+	static const unsigned int COUNT = ARRAY_SIZE(sizes);
+
+	HashMulti<Sha256>::Buffer bufs[COUNT];
+	uint8_t digests[COUNT][Sha256::DIGEST_SIZE];
+	size_t pos = 0;
+	for (unsigned int i = 0; i < COUNT; i++) {
+		bufs[i].data = &data[pos];
+		bufs[i].size = sizes[i];
+		bufs[i].digest = digests[i];
+		pos += sizes[i];
+	}
+	ASSERT_LE(pos, data.size());
+
+	HashMulti<Sha256>::hash(bufs, COUNT);
+	for (unsigned int i = 0; i < COUNT; i++) {
+		uint8_t expected[Sha256::DIGEST_SIZE];
+		Sha256::hash(bufs[i].data, bufs[i].size, expected);
+		EXPECT_EQ(toHex(expected, sizeof(expected)), toHex(digests[i], sizeof(digests[i])))
+			<< "buffer " << i;
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: Hash tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,181 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * IoStatsTest.cpp: IoStats test.                                          *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// IoStats
+#include "librpbase/file/IoStats.hpp"
+#include "librpbase/file/CachedRpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpbase/disc/PartitionFile.hpp"
+using namespace LibRpBase;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class IoStatsTest : public ::testing::Test
+{
+	protected:
+		IoStatsTest()
+			: m_file(nullptr)
+			, m_discReader(nullptr)
+			, m_partFile(nullptr)
+		{ }
+
+		void SetUp(void) final
+		{
+			for (unsigned int i = 0; i < sizeof(m_buf); i++) {
+				m_buf[i] = static_cast<uint8_t>(i * 7);
+			}
+
+			// PartitionFile -> DiscReader -> CachedRpFile -> RpMemFile
+			RpMemFile *const memFile = new RpMemFile(m_buf, sizeof(m_buf));
+			m_file = new CachedRpFile(memFile, 4096, 4);
+			memFile->unref();
+			m_discReader = new DiscReader(m_file);
+			m_partFile = new PartitionFile(m_discReader, 1024, sizeof(m_buf) - 1024);
+		}
+
+		void TearDown(void) final
+		{
+			IoStats::setEnabled(false);
+			if (m_partFile) {
+				m_partFile->unref();
+			}
+			delete m_discReader;
+			if (m_file) {
+				m_file->unref();
+			}
+		}
+
+		/**
+		 * Get the difference between two snapshots for a layer.
+		 * @param before Snapshot taken before the I/O.
+		 * @param after Snapshot taken after the I/O.
+		 * @param name Layer name.
+		 * @return Layer statistics.
+		 */
+		static IoStats::LayerStats diff(const vector<IoStats::LayerStats> &before,
+			const vector<IoStats::LayerStats> &after, const char *name);
+
+	protected:
+		uint8_t m_buf[16384];
+		CachedRpFile *m_file;
+		DiscReader *m_discReader;
+		PartitionFile *m_partFile;
+};
+
+/**
+ * Get the difference between two snapshots for a layer.
+ * @param before Snapshot taken before the I/O.
+ * @param after Snapshot taken after the I/O.
+ * @param name Layer name.
+ * @return Layer statistics.
+ */
+IoStats::LayerStats IoStatsTest::diff(const vector<IoStats::LayerStats> &before,
+	const vector<IoStats::LayerStats> &after, const char *name)
+{
+	IoStats::LayerStats ret;
+	memset(&ret, 0, sizeof(ret));
+	ret.name = name;
+
+	EXPECT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < before.size() && i < after.size(); i++) {
+		if (!strcmp(after[i].name, name)) {
+			ret.reads = after[i].reads - before[i].reads;
+			ret.bytesRead = after[i].bytesRead - before[i].bytesRead;
+			ret.seeks = after[i].seeks - before[i].seeks;
+			ret.consumed = after[i].consumed - before[i].consumed;
+			break;
+		}
+	}
+	return ret;
+}
+
+/**
+ * Only the outermost layer's reads are consumed.
+ */
+TEST_F(IoStatsTest, nestedLayers)
+{
+	IoStats::setEnabled(true);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	uint8_t buf[100];
+	ASSERT_EQ(0, m_partFile->seek(10));
+	ASSERT_EQ(sizeof(buf), m_partFile->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_buf[1024 + 10], sizeof(buf)));
+	ASSERT_EQ(sizeof(buf), m_partFile->pread(200, buf, sizeof(buf)));
+
+	IoStats::snapshot(after);
+
+	const IoStats::LayerStats pf = diff(before, after, "PartitionFile");
+	EXPECT_EQ(2U, pf.reads);
+	EXPECT_EQ(200U, pf.bytesRead);
+	EXPECT_EQ(1U, pf.seeks);
+	EXPECT_EQ(200U, pf.consumed);
+
+	const IoStats::LayerStats dr = diff(before, after, "DiscReader");
+	EXPECT_EQ(2U, dr.reads);
+	EXPECT_EQ(200U, dr.bytesRead);
+	EXPECT_EQ(0U, dr.consumed);
+
+	const IoStats::LayerStats crf = diff(before, after, "CachedRpFile");
+	EXPECT_EQ(2U, crf.reads);
+	EXPECT_EQ(200U, crf.bytesRead);
+	EXPECT_EQ(0U, crf.consumed);
+}
+
+/**
+ * Nothing is counted if IoStats is disabled.
+ */
+TEST_F(IoStatsTest, disabled)
+{
+	IoStats::setEnabled(false);
+	vector<IoStats::LayerStats> before, after;
+	IoStats::snapshot(before);
+
+	uint8_t buf[100];
+	ASSERT_EQ(0, m_partFile->seek(10));
+	ASSERT_EQ(sizeof(buf), m_partFile->read(buf, sizeof(buf)));
+	ASSERT_EQ(sizeof(buf), m_file->pread(0, buf, sizeof(buf)));
+
+	IoStats::snapshot(after);
+	ASSERT_EQ(before.size(), after.size());
+	for (size_t i = 0; i < before.size(); i++) {
+		EXPECT_EQ(before[i].reads, after[i].reads) << before[i].name;
+		EXPECT_EQ(before[i].bytesRead, after[i].bytesRead) << before[i].name;
+		EXPECT_EQ(before[i].seeks, after[i].seeks) << before[i].name;
+		EXPECT_EQ(before[i].consumed, after[i].consumed) << before[i].name;
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: IoStats tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
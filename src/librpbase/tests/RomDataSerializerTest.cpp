@@ -0,0 +1,201 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RomDataSerializerTest.cpp: RomDataSerializer test.                      *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// RomDataSerializer
+#include "librpbase/RomDataSerializer.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+using namespace LibRpBase;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RomDataSerializerTest : public ::testing::Test
+{ };
+
+/**
+ * Round-trip a RomFields object with all field types.
+ */
+TEST_F(RomDataSerializerTest, fieldsRoundTrip)
+{
+	RomFields fields;
+	fields.reserveTabs(2);
+	fields.setTabName(0, "Main");
+	fields.setTabName(1, "Extra");
+
+	fields.addField_string("Title", "Test Title");
+	fields.addField_string("Serial", "ABCD", RomFields::STRF_MONOSPACE);
+
+	static const char *const bit_names[] = {"Bit 0", "Bit 1", "Bit 2"};
+	fields.addField_bitfield("Flags",
+		RomFields::strArrayToVector(bit_names, ARRAY_SIZE(bit_names)), 3, 0x5);
+
+	RomFields::ListData_t *const list_data = new RomFields::ListData_t(2);
+	(*list_data)[0].push_back("a");
+	(*list_data)[0].push_back("b");
+	(*list_data)[1].push_back("Test Title");
+	(*list_data)[1].push_back("d");
+	static const char *const headers[] = {"Col 1", "Col 2"};
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_CHECKBOXES, 4);
+	params.headers = RomFields::strArrayToVector(headers, ARRAY_SIZE(headers));
+	params.data.single = list_data;
+	params.mxd.checkboxes = 0x2;
+	fields.addField_listData("List", &params);
+
+	fields.setTabIndex(1);
+	fields.addField_dateTime("Date", 1234567890, RomFields::RFT_DATETIME_HAS_DATE);
+	RomFields::age_ratings_t age_ratings;
+	for (unsigned int i = 0; i < age_ratings.size(); i++) {
+		age_ratings[i] = static_cast<uint16_t>(i * 0x1111);
+	}
+	fields.addField_ageRatings("Ratings", age_ratings);
+	fields.addField_dimensions("Size", 64, 32, 1);
+
+	RomFields::StringMultiMap_t *const str_multi = new RomFields::StringMultiMap_t();
+	(*str_multi)['en'] = "English";
+	(*str_multi)['de'] = "Deutsch";
+	fields.addField_string_multi("Name", str_multi, 'de');
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, RomDataSerializer::serializeFields(&fields, buf));
+
+	unique_ptr<RomFields> fields2(RomDataSerializer::deserializeFields(buf.data(), buf.size()));
+	ASSERT_TRUE(fields2 != nullptr);
+	ASSERT_EQ(fields.count(), fields2->count());
+	ASSERT_EQ(2, fields2->tabCount());
+	EXPECT_STREQ("Main", fields2->tabName(0));
+	EXPECT_STREQ("Extra", fields2->tabName(1));
+	EXPECT_EQ(fields.defaultLanguageCode(), fields2->defaultLanguageCode());
+
+	// Compare each field by re-serializing the deserialized object.
+	ao::uvector<uint8_t> buf2;
+	ASSERT_EQ(0, RomDataSerializer::serializeFields(fields2.get(), buf2));
+	ASSERT_EQ(buf.size(), buf2.size());
+	EXPECT_EQ(0, memcmp(buf.data(), buf2.data(), buf.size()));
+
+	// Spot-check some of the field data.
+	const RomFields::Field *const f_title = fields2->at(0);
+	ASSERT_TRUE(f_title != nullptr);
+	EXPECT_EQ("Title", f_title->name);
+	ASSERT_TRUE(f_title->data.str != nullptr);
+	EXPECT_EQ("Test Title", *f_title->data.str);
+
+	const RomFields::Field *const f_list = fields2->at(3);
+	ASSERT_TRUE(f_list != nullptr);
+	EXPECT_EQ(RomFields::RFT_LISTDATA, f_list->type);
+	ASSERT_TRUE(f_list->data.list_data.data.single != nullptr);
+	EXPECT_EQ("Test Title", f_list->data.list_data.data.single->at(1).at(0));
+	EXPECT_EQ(0x2U, f_list->data.list_data.mxd.checkboxes);
+
+	const RomFields::Field *const f_size = fields2->at(6);
+	ASSERT_TRUE(f_size != nullptr);
+	EXPECT_EQ(1, f_size->tabIdx);
+	EXPECT_EQ(64, f_size->data.dimensions[0]);
+	EXPECT_EQ(32, f_size->data.dimensions[1]);
+	EXPECT_EQ(1, f_size->data.dimensions[2]);
+}
+
+/**
+ * Truncated or corrupted RomFields data must be rejected.
+ */
+TEST_F(RomDataSerializerTest, fieldsTruncated)
+{
+	RomFields fields;
+	fields.addField_string("Title", "Test Title");
+	RomFields::StringMultiMap_t *const str_multi = new RomFields::StringMultiMap_t();
+	(*str_multi)['en'] = "English";
+	fields.addField_string_multi("Name", str_multi);
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, RomDataSerializer::serializeFields(&fields, buf));
+
+	// Every truncated size must fail without crashing.
+	for (size_t size = 0; size < buf.size(); size++) {
+		RomFields *const fields2 = RomDataSerializer::deserializeFields(buf.data(), size);
+		EXPECT_TRUE(fields2 == nullptr) << "size " << size;
+		delete fields2;
+	}
+
+	// Incorrect magic number.
+	buf[0] = 'X';
+	EXPECT_TRUE(RomDataSerializer::deserializeFields(buf.data(), buf.size()) == nullptr);
+}
+
+/**
+ * Round-trip a RomMetaData object.
+ */
+TEST_F(RomDataSerializerTest, metaDataRoundTrip)
+{
+	RomMetaData metaData;
+	metaData.addMetaData_string(Property::Title, "Test Title");
+	metaData.addMetaData_string(Property::Publisher, "Test Title");
+	metaData.addMetaData_integer(Property::Width, 640);
+	metaData.addMetaData_uint(Property::TrackNumber, 12);
+	metaData.addMetaData_timestamp(Property::CreationDate, 1234567890);
+
+	ao::uvector<uint8_t> buf;
+	ASSERT_EQ(0, RomDataSerializer::serializeMetaData(&metaData, buf));
+
+	unique_ptr<RomMetaData> metaData2(RomDataSerializer::deserializeMetaData(buf.data(), buf.size()));
+	ASSERT_TRUE(metaData2 != nullptr);
+	ASSERT_EQ(metaData.count(), metaData2->count());
+	for (int i = 0; i < metaData.count(); i++) {
+		const RomMetaData::MetaData *const p1 = metaData.prop(i);
+		const RomMetaData::MetaData *const p2 = metaData2->prop(i);
+		ASSERT_TRUE(p1 != nullptr);
+		ASSERT_TRUE(p2 != nullptr);
+		EXPECT_EQ(p1->name, p2->name);
+		EXPECT_EQ(p1->type, p2->type);
+		switch (p1->type) {
+			case PropertyType::Integer:
+				EXPECT_EQ(p1->data.ivalue, p2->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				EXPECT_EQ(p1->data.uvalue, p2->data.uvalue);
+				break;
+			case PropertyType::String:
+				EXPECT_EQ(*p1->data.str, *p2->data.str);
+				break;
+			case PropertyType::Timestamp:
+				EXPECT_EQ(p1->data.timestamp, p2->data.timestamp);
+				break;
+			default:
+				ADD_FAILURE() << "Unexpected property type.";
+				break;
+		}
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RomDataSerializer tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,265 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RomFieldsTest.cpp: RomFields allocation test.                           *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// RomFields
+#include "librpbase/RomFields.hpp"
+using namespace LibRpBase;
+
+// C includes.
+#ifdef __GLIBC__
+# include <malloc.h>
+#endif /* __GLIBC__ */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+
+// C++ includes.
+#include <new>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+/** Allocation counting **/
+
+// Number of allocations while counting is enabled.
+static unsigned int alloc_count = 0;
+// Heap bytes used by allocations while counting is enabled.
+// Includes the malloc() chunk header. (glibc only)
+static size_t alloc_bytes = 0;
+static bool alloc_counting = false;
+
+void *operator new(size_t size)
+{
+	void *const ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	if (alloc_counting) {
+		alloc_count++;
+#ifdef __GLIBC__
+		alloc_bytes += malloc_usable_size(ptr) + sizeof(size_t);
+#endif /* __GLIBC__ */
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+namespace LibRomData { namespace Tests {
+
+class RomFieldsTest : public ::testing::Test
+{
+	public:
+		// Number of fields to add.
+		static const unsigned int FIELD_COUNT = 256;
+
+	protected:
+		/**
+		 * Start counting allocations.
+		 */
+		static void startCounting(void)
+		{
+			alloc_count = 0;
+			alloc_bytes = 0;
+			alloc_counting = true;
+		}
+
+		/**
+		 * Stop counting allocations.
+		 * @return Number of allocations since startCounting().
+		 */
+		static unsigned int stopCounting(void)
+		{
+			alloc_counting = false;
+			return alloc_count;
+		}
+};
+
+/**
+ * String fields should not require one heap allocation per field.
+ */
+TEST_F(RomFieldsTest, addField_string_allocs)
+{
+	// Short names and values, so std::string's
+	// small string optimization applies.
+	RomFields fields;
+	fields.reserve(FIELD_COUNT);
+
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields.addField_string("Name", "Value");
+	}
+	const unsigned int count = stopCounting();
+
+	EXPECT_EQ(static_cast<int>(FIELD_COUNT), fields.count());
+	EXPECT_LT(count, FIELD_COUNT / 4);
+
+	// Verify the strings.
+	for (int i = 0; i < fields.count(); i++) {
+		const RomFields::Field *const field = fields.at(i);
+		ASSERT_TRUE(field != nullptr);
+		ASSERT_TRUE(field->data.str != nullptr);
+		EXPECT_EQ("Value", *field->data.str);
+	}
+}
+
+/**
+ * Long string fields should only need one heap allocation
+ * per field for the string buffer, and none if the string
+ * is moved into the field.
+ */
+TEST_F(RomFieldsTest, addField_string_long_allocs)
+{
+	// Too long for std::string's small string optimization.
+	const string value(200, 'v');
+
+	// Copied strings: One allocation for each string buffer.
+	RomFields fields;
+	fields.reserve(FIELD_COUNT);
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields.addField_string("Name", value);
+	}
+	unsigned int count = stopCounting();
+	EXPECT_EQ(static_cast<int>(FIELD_COUNT), fields.count());
+	EXPECT_GE(count, static_cast<unsigned int>(FIELD_COUNT));
+	EXPECT_LT(count, FIELD_COUNT + (FIELD_COUNT / 4));
+
+	// Moved strings: The string buffers are reused.
+	vector<string> values(static_cast<size_t>(FIELD_COUNT), value);
+	RomFields fields2;
+	fields2.reserve(FIELD_COUNT);
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields2.addField_string("Name", std::move(values[i]));
+	}
+	count = stopCounting();
+	EXPECT_EQ(static_cast<int>(FIELD_COUNT), fields2.count());
+	EXPECT_LT(count, FIELD_COUNT / 4);
+
+	// Verify the strings.
+	for (int i = 0; i < fields.count(); i++) {
+		ASSERT_TRUE(fields.at(i)->data.str != nullptr);
+		EXPECT_EQ(value, *fields.at(i)->data.str);
+		ASSERT_TRUE(fields2.at(i)->data.str != nullptr);
+		EXPECT_EQ(value, *fields2.at(i)->data.str);
+	}
+}
+
+#ifdef __GLIBC__
+/**
+ * String fields should use less heap memory than
+ * allocating each string separately.
+ */
+TEST_F(RomFieldsTest, addField_string_heap_usage)
+{
+	RomFields fields;
+	fields.reserve(FIELD_COUNT);
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields.addField_string("Name", "Value");
+	}
+	stopCounting();
+	const size_t pooled_bytes = alloc_bytes;
+
+	// One allocation per string, as RomFields did without pools.
+	vector<string*> strs;
+	strs.reserve(FIELD_COUNT);
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		strs.push_back(new string("Value"));
+	}
+	stopCounting();
+	const size_t separate_bytes = alloc_bytes;
+	for (auto iter = strs.begin(); iter != strs.end(); ++iter) {
+		delete *iter;
+	}
+
+	EXPECT_LT(pooled_bytes, separate_bytes);
+}
+#endif /* __GLIBC__ */
+
+/**
+ * Age ratings fields should not require one heap allocation per field.
+ */
+TEST_F(RomFieldsTest, addField_ageRatings_allocs)
+{
+	RomFields::age_ratings_t age_ratings;
+	age_ratings.fill(0);
+	age_ratings[RomFields::AGE_USA] = 13 | RomFields::AGEBF_ACTIVE;
+
+	RomFields fields;
+	fields.reserve(FIELD_COUNT);
+
+	startCounting();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields.addField_ageRatings("Rating", age_ratings);
+	}
+	const unsigned int count = stopCounting();
+
+	EXPECT_EQ(static_cast<int>(FIELD_COUNT), fields.count());
+	EXPECT_LT(count, FIELD_COUNT / 4);
+
+	const RomFields::Field *const field = fields.at(FIELD_COUNT - 1);
+	ASSERT_TRUE(field != nullptr);
+	ASSERT_TRUE(field->data.age_ratings != nullptr);
+	EXPECT_EQ(age_ratings, *field->data.age_ratings);
+}
+
+/**
+ * Pooled data must remain valid after copying fields
+ * into another RomFields object.
+ */
+TEST_F(RomFieldsTest, addFields_romFields_pooled)
+{
+	RomFields *const fields = new RomFields();
+	for (unsigned int i = 0; i < FIELD_COUNT; i++) {
+		fields->addField_string("Name", string(i % 64 + 1, 'x'));
+	}
+
+	RomFields fields2;
+	fields2.addFields_romFields(fields, -1);
+	delete fields;
+
+	ASSERT_EQ(static_cast<int>(FIELD_COUNT), fields2.count());
+	for (int i = 0; i < fields2.count(); i++) {
+		const RomFields::Field *const field = fields2.at(i);
+		ASSERT_TRUE(field != nullptr);
+		ASSERT_TRUE(field->data.str != nullptr);
+		EXPECT_EQ(string(i % 64 + 1, 'x'), *field->data.str);
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RomFields tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
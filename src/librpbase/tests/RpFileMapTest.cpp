@@ -0,0 +1,196 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpFileMapTest.cpp: IRpFile::map() and mapOrRead() test.                 *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// zlib
+#include <zlib.h>
+
+// IRpFile
+#include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RpFileMapTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final
+		{
+			m_data.resize(DATA_SIZE);
+			TestRandom rnd(0x4D415021);
+			rnd.fill(m_data.data(), m_data.size());
+		}
+
+		void TearDown(void) final
+		{
+			remove(FILENAME);
+			remove(GZ_FILENAME);
+		}
+
+		/**
+		 * Write a test file.
+		 * @param filename	[in] Filename.
+		 * @param data		[in] File data.
+		 */
+		static void writeFile(const char *filename, const vector<uint8_t> &data)
+		{
+			RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+			ASSERT_TRUE(file->isOpen());
+			EXPECT_EQ(data.size(), file->write(data.data(), data.size()));
+			file->unref();
+		}
+
+	public:
+		// Larger than two 64 KiB mapping granularity units,
+		// and not a multiple of the page size.
+		static const unsigned int DATA_SIZE = 2*65536 + 1000;
+
+		static const char FILENAME[];
+		static const char GZ_FILENAME[];
+
+	protected:
+		vector<uint8_t> m_data;
+};
+
+const char RpFileMapTest::FILENAME[] = "RpFileMapTest.bin";
+const char RpFileMapTest::GZ_FILENAME[] = "RpFileMapTest.bin.gz";
+
+/**
+ * Regular files must map the requested ranges, reusing
+ * existing views for ranges that they contain.
+ */
+TEST_F(RpFileMapTest, regularFile)
+{
+	writeFile(FILENAME, m_data);
+	RpFile *const file = new RpFile(FILENAME, RpFile::FM_OPEN_READ);
+	ASSERT_TRUE(file->isOpen());
+
+	// Range in the second mapping granularity unit.
+	const uint8_t *const p = file->map(65536 + 100, 256);
+	ASSERT_TRUE(p != nullptr);
+	EXPECT_EQ(0, memcmp(p, &m_data[65536 + 100], 256));
+
+	// Subrange of the existing view.
+	EXPECT_EQ(p + 16, file->map(65536 + 116, 64));
+
+	// Range at the end of the file.
+	const uint8_t *const p2 = file->map(DATA_SIZE - 16, 16);
+	ASSERT_TRUE(p2 != nullptr);
+	EXPECT_EQ(0, memcmp(p2, &m_data[DATA_SIZE - 16], 16));
+
+	// The first view must still be valid.
+	EXPECT_EQ(0, memcmp(p, &m_data[65536 + 100], 256));
+
+	// Out of range.
+	EXPECT_TRUE(file->map(DATA_SIZE - 16, 17) == nullptr);
+	EXPECT_EQ(EINVAL, file->lastError());
+	EXPECT_TRUE(file->map(-1, 16) == nullptr);
+	EXPECT_TRUE(file->map(0, 0) == nullptr);
+
+	// mapOrRead() must use the mapped data if it's aligned.
+	ao::uvector<uint8_t> buf;
+	EXPECT_EQ(p, file->mapOrRead(65536 + 100, 256, buf));
+	EXPECT_TRUE(buf.empty());
+
+	// Unaligned data must be read into the buffer.
+	const uint8_t *const p3 = file->mapOrRead(65536 + 101, 255, buf);
+	ASSERT_TRUE(p3 != nullptr);
+	EXPECT_EQ(buf.data(), p3);
+	EXPECT_EQ(0, memcmp(p3, &m_data[65536 + 101], 255));
+
+	file->unref();
+}
+
+/**
+ * Files using transparent gzip decompression can't be mapped.
+ * mapOrRead() must read the uncompressed data instead.
+ */
+TEST_F(RpFileMapTest, gzFallback)
+{
+	// Compress the data.
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	// windowBits 15 + 16: gzip header and trailer
+	ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY));
+	vector<uint8_t> gzData(deflateBound(&strm, static_cast<uLong>(m_data.size())));
+	strm.next_in = m_data.data();
+	strm.avail_in = static_cast<uInt>(m_data.size());
+	strm.next_out = gzData.data();
+	strm.avail_out = static_cast<uInt>(gzData.size());
+	ASSERT_EQ(Z_STREAM_END, deflate(&strm, Z_FINISH));
+	gzData.resize(strm.total_out);
+	deflateEnd(&strm);
+	writeFile(GZ_FILENAME, gzData);
+
+	RpFile *const file = new RpFile(GZ_FILENAME, RpFile::FM_OPEN_READ_GZ);
+	ASSERT_TRUE(file->isOpen());
+	EXPECT_TRUE(file->map(0, 256) == nullptr);
+
+	ao::uvector<uint8_t> buf;
+	const uint8_t *const p = file->mapOrRead(65536 + 100, 256, buf);
+	ASSERT_TRUE(p != nullptr);
+	EXPECT_EQ(buf.data(), p);
+	EXPECT_EQ(0, memcmp(p, &m_data[65536 + 100], 256));
+
+	file->unref();
+}
+
+/**
+ * Memory files must return pointers into the memory buffer.
+ */
+TEST_F(RpFileMapTest, memFile)
+{
+	RpMemFile *const file = new RpMemFile(m_data.data(), m_data.size());
+	const uint8_t *const p = file->map(100, 256);
+	EXPECT_EQ(&m_data[100], p);
+	EXPECT_TRUE(file->map(DATA_SIZE - 16, 17) == nullptr);
+	EXPECT_EQ(EINVAL, file->lastError());
+
+	// mapOrRead() only uses the buffer if the data isn't aligned.
+	ao::uvector<uint8_t> buf;
+	const size_t alignedPos = (4 - (reinterpret_cast<uintptr_t>(m_data.data()) % 4)) % 4;
+	EXPECT_EQ(&m_data[alignedPos], file->mapOrRead(alignedPos, 256, buf));
+	EXPECT_TRUE(buf.empty());
+
+	const uint8_t *const p2 = file->mapOrRead(alignedPos + 1, 256, buf);
+	ASSERT_TRUE(p2 != nullptr);
+	EXPECT_EQ(buf.data(), p2);
+	EXPECT_EQ(0, memcmp(p2, &m_data[alignedPos + 1], 256));
+
+	file->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: RpFile mapping tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
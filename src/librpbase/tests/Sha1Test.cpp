@@ -0,0 +1,119 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * Sha1Test.cpp: SHA-1 test.                                               *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// Sha1
+#include "librpbase/crypto/Sha1.hpp"
+using namespace LibRpBase;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class Sha1Test : public ::testing::Test
+{
+	protected:
+		/**
+		 * Convert a digest to a hexadecimal string.
+		 * @param digest Digest. (Sha1::DIGEST_SIZE bytes)
+		 * @return Hexadecimal string.
+		 */
+		static string toHex(const uint8_t *digest);
+};
+
+/**
+ * Convert a digest to a hexadecimal string.
+ * @param digest Digest. (Sha1::DIGEST_SIZE bytes)
+ * @return Hexadecimal string.
+ */
+string Sha1Test::toHex(const uint8_t *digest)
+{
+	string s;
+	s.reserve(Sha1::DIGEST_SIZE * 2);
+	for (unsigned int i = 0; i < Sha1::DIGEST_SIZE; i++) {
+		char buf[3];
+		snprintf(buf, sizeof(buf), "%02x", digest[i]);
+		s += buf;
+	}
+	return s;
+}
+
+/**
+ * FIPS 180-2 test vectors.
+ */
+TEST_F(Sha1Test, testVectors)
+{
+	static const struct {
+		const char *msg;
+		const char *digest;
+	} vectors[] = {
+		{"", "da39a3ee5e6b4b0d3255bfef95601890afd80709"},
+		{"abc", "a9993e364706816aba3e25717850c26c9cd0d89d"},
+		{"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+		 "84983e441c3bd26ebaae4aa1f95129e5e54670f1"},
+	};
+
+	uint8_t digest[Sha1::DIGEST_SIZE];
+	for (size_t i = 0; i < ARRAY_SIZE(vectors); i++) {
+		Sha1::hash(vectors[i].msg, strlen(vectors[i].msg), digest);
+		EXPECT_EQ(vectors[i].digest, toHex(digest)) << "msg: " << vectors[i].msg;
+	}
+}
+
+/**
+ * One million 'a's, hashed incrementally with
+ * chunk sizes that aren't multiples of the block size.
+ */
+TEST_F(Sha1Test, incremental)
+{
+	static const size_t TOTAL = 1000000;
+	vector<char> buf(TOTAL, 'a');
+
+	Sha1 sha1;
+	size_t pos = 0;
+	for (size_t chunk = 1; pos < TOTAL; chunk = (chunk * 7) % 1013 + 1) {
+		const size_t sz = (TOTAL - pos < chunk ? TOTAL - pos : chunk);
+		sha1.update(&buf[pos], sz);
+		pos += sz;
+	}
+
+	uint8_t digest[Sha1::DIGEST_SIZE];
+	sha1.finish(digest);
+	EXPECT_EQ("34aa973cd4c4daa4f61eeb2bdbad27316534016f", toHex(digest));
+
+	// The hash state is reset by finish().
+	sha1.update("abc", 3);
+	sha1.finish(digest);
+	EXPECT_EQ("a9993e364706816aba3e25717850c26c9cd0d89d", toHex(digest));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: SHA-1 tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
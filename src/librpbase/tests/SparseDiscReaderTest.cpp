@@ -0,0 +1,283 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * SparseDiscReaderTest.cpp: SparseDiscReader test.                        *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// SparseDiscReader
+#include "librpbase/disc/SparseDiscReader.hpp"
+#include "librpbase/disc/SparseDiscReader_p.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * IRpFile wrapper that counts read() and pread() calls.
+ */
+class CountingFile : public IRpFile
+{
+	public:
+		explicit CountingFile(IRpFile *file)
+			: m_file(file->ref())
+			, reads(0)
+		{ }
+
+	protected:
+		virtual ~CountingFile()
+		{
+			m_file->unref();
+		}
+
+	public:
+		bool isOpen(void) const final { return m_file->isOpen(); }
+		void close(void) final { }
+		size_t read(void *ptr, size_t size) final
+		{
+			reads++;
+			return m_file->read(ptr, size);
+		}
+		size_t pread(off64_t pos, void *ptr, size_t size) final
+		{
+			reads++;
+			return m_file->pread(pos, ptr, size);
+		}
+		size_t write(const void *ptr, size_t size) final { RP_UNUSED(ptr); RP_UNUSED(size); return 0; }
+		int seek(off64_t pos) final { return m_file->seek(pos); }
+		off64_t tell(void) final { return m_file->tell(); }
+		int truncate(off64_t size) final { RP_UNUSED(size); return -1; }
+		off64_t size(void) final { return m_file->size(); }
+		string filename(void) const final { return string(); }
+
+	private:
+		IRpFile *const m_file;
+	public:
+		unsigned int reads;
+};
+
+// I/O statistics.
+static IoStats::Layer ioLayer("TestSparseReader");
+
+class TestSparseReader;
+class TestSparseReaderPrivate : public SparseDiscReaderPrivate
+{
+	public:
+		explicit TestSparseReaderPrivate(TestSparseReader *q);
+
+	public:
+		// Logical to physical block index table. (0 == empty block)
+		vector<uint32_t> blockMap;
+};
+
+/**
+ * Sparse disc reader with a block map.
+ */
+class TestSparseReader : public SparseDiscReader
+{
+	public:
+		TestSparseReader(IRpFile *file, const vector<uint32_t> &blockMap, unsigned int block_size)
+			: SparseDiscReader(new TestSparseReaderPrivate(this), file)
+		{
+			RP_D(TestSparseReader);
+			d->blockMap = blockMap;
+			d->block_size = block_size;
+			d->disc_size = static_cast<off64_t>(blockMap.size()) * block_size;
+			d->pos = 0;
+		}
+
+	public:
+		int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final
+		{
+			RP_UNUSED(pHeader);
+			RP_UNUSED(szHeader);
+			return -1;
+		}
+
+	protected:
+		off64_t getPhysBlockAddr(uint32_t blockIdx) const final
+		{
+			RP_D(const TestSparseReader);
+			if (blockIdx >= d->blockMap.size()) {
+				return -1;
+			}
+			return static_cast<off64_t>(d->blockMap[blockIdx]) * d->block_size;
+		}
+};
+
+TestSparseReaderPrivate::TestSparseReaderPrivate(TestSparseReader *q)
+	: SparseDiscReaderPrivate(q, ioLayer)
+{ }
+
+class SparseDiscReaderTest : public ::testing::Test
+{
+	protected:
+		SparseDiscReaderTest()
+			: m_file(nullptr)
+			, m_reader(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			delete m_reader;
+			if (m_file) {
+				m_file->unref();
+			}
+		}
+
+	public:
+		static const unsigned int BLOCK_SIZE = 1024;
+		static const unsigned int PHYS_BLOCK_COUNT = 80;
+
+	protected:
+		vector<uint8_t> m_physData;	// Physical image data.
+		vector<uint8_t> m_data;		// Expected logical data.
+		vector<uint32_t> m_blockMap;
+		CountingFile *m_file;
+		TestSparseReader *m_reader;
+};
+
+void SparseDiscReaderTest::SetUp(void)
+{
+	m_physData.resize(PHYS_BLOCK_COUNT * BLOCK_SIZE);
+	for (size_t i = 0; i < m_physData.size(); i++) {
+		m_physData[i] = static_cast<uint8_t>((i * 7) ^ (i >> 10));
+	}
+
+	// Block map with 5 runs:
+	// - 0-9: Physical blocks 1-10.
+	// - 10-19: Empty.
+	// - 20-29: Physical blocks 30-39.
+	// - 30-31: Physical blocks 11-12.
+	// - 32-63: Physical blocks 40-71.
+	m_blockMap.clear();
+	for (uint32_t i = 0; i < 10; i++)
+		m_blockMap.push_back(1 + i);
+	for (uint32_t i = 0; i < 10; i++)
+		m_blockMap.push_back(0);
+	for (uint32_t i = 0; i < 10; i++)
+		m_blockMap.push_back(30 + i);
+	for (uint32_t i = 0; i < 2; i++)
+		m_blockMap.push_back(11 + i);
+	for (uint32_t i = 0; i < 32; i++)
+		m_blockMap.push_back(40 + i);
+
+	m_data.resize(m_blockMap.size() * BLOCK_SIZE);
+	for (size_t i = 0; i < m_blockMap.size(); i++) {
+		if (m_blockMap[i] == 0) {
+			memset(&m_data[i * BLOCK_SIZE], 0, BLOCK_SIZE);
+		} else {
+			memcpy(&m_data[i * BLOCK_SIZE], &m_physData[m_blockMap[i] * BLOCK_SIZE], BLOCK_SIZE);
+		}
+	}
+
+	RpMemFile *const memFile = new RpMemFile(m_physData.data(), m_physData.size());
+	m_file = new CountingFile(memFile);
+	memFile->unref();
+	m_reader = new TestSparseReader(m_file, m_blockMap, BLOCK_SIZE);
+	ASSERT_TRUE(m_reader->isOpen());
+}
+
+/**
+ * Reading the whole disc should need one
+ * underlying read per non-empty run.
+ */
+TEST_F(SparseDiscReaderTest, coalescedFullRead)
+{
+	vector<uint8_t> buf(m_data.size());
+	ASSERT_EQ(buf.size(), m_reader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, memcmp(buf.data(), m_data.data(), buf.size()));
+	EXPECT_EQ(4U, m_file->reads);
+}
+
+/**
+ * Unaligned reads that span multiple runs.
+ */
+TEST_F(SparseDiscReaderTest, unalignedReads)
+{
+	static const struct {
+		unsigned int pos;
+		unsigned int size;
+	} reads[] = {
+		{500, 20000},
+		{9 * BLOCK_SIZE + 1, BLOCK_SIZE * 3},
+		{31 * BLOCK_SIZE - 3, 7},
+		{60 * BLOCK_SIZE + 100, 8000},	// short read
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(reads); i++) {
+		size_t expected = reads[i].size;
+		if (reads[i].pos + expected > m_data.size()) {
+			expected = m_data.size() - reads[i].pos;
+		}
+		vector<uint8_t> buf(reads[i].size);
+		ASSERT_EQ(expected, m_reader->pread(reads[i].pos, buf.data(), buf.size())) << "pos " << reads[i].pos;
+		EXPECT_EQ(0, memcmp(buf.data(), &m_data[reads[i].pos], expected)) << "pos " << reads[i].pos;
+	}
+}
+
+/**
+ * Random small reads within a few blocks should only
+ * read each block from the underlying file once.
+ */
+TEST_F(SparseDiscReaderTest, randomSmallReads)
+{
+	// Blocks 6-13 include empty blocks and two runs.
+	static const unsigned int START_BLOCK = 6;
+	static const unsigned int BLOCK_COUNT = 8;
+	static const unsigned int MAX_READ = 200;
+
+	m_reader->resetCacheStats();
+	TestRandom rnd(0x13579BDF);
+	uint8_t buf[MAX_READ];
+	for (unsigned int i = 0; i < 2000; i++) {
+		const unsigned int size = 1 + ((rnd.next() >> 8) % MAX_READ);
+		const unsigned int pos = (START_BLOCK * BLOCK_SIZE) +
+			((rnd.next() >> 4) % (BLOCK_COUNT * BLOCK_SIZE - size));
+
+		ASSERT_EQ(size, m_reader->pread(pos, buf, size)) << "pos " << pos;
+		ASSERT_EQ(0, memcmp(buf, &m_data[pos], size)) << "pos " << pos;
+	}
+
+	// Empty blocks don't need any reads.
+	EXPECT_LE(m_file->reads, BLOCK_COUNT);
+
+	SparseDiscReader::CacheStats stats;
+	m_reader->getCacheStats(&stats);
+	EXPECT_EQ(BLOCK_COUNT, stats.misses);
+	EXPECT_GT(stats.hits, 1000U);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: SparseDiscReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * TestRandom.hpp: Reproducible pseudo-random numbers for tests.           *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_TESTS_TESTRANDOM_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_TESTS_TESTRANDOM_HPP__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * Simple LCG for reproducible test data and offsets.
+ * Not suitable for anything other than tests.
+ */
+class TestRandom
+{
+	public:
+		explicit TestRandom(uint32_t seed)
+			: m_seed(seed)
+		{ }
+
+	public:
+		/**
+		 * Get the next LCG value.
+		 * The low bits aren't very random, so shift the value first.
+		 * @return Next LCG value.
+		 */
+		inline uint32_t next(void)
+		{
+			m_seed = m_seed * 1103515245 + 12345;
+			return m_seed;
+		}
+
+		/**
+		 * Fill a buffer with pseudo-random bytes.
+		 * @param buf Buffer.
+		 * @param size Size of buf, in bytes.
+		 */
+		inline void fill(uint8_t *buf, size_t size)
+		{
+			for (; size > 0; size--, buf++) {
+				*buf = static_cast<uint8_t>(next() >> 16);
+			}
+		}
+
+		/**
+		 * Fill a buffer with somewhat compressible data.
+		 * Each byte is one of 16 letters, starting at 'A'.
+		 * @param buf Buffer.
+		 * @param size Size of buf, in bytes.
+		 */
+		inline void fillText(uint8_t *buf, size_t size)
+		{
+			for (; size > 0; size--, buf++) {
+				*buf = static_cast<uint8_t>('A' + ((next() >> 16) % 16));
+			}
+		}
+
+	private:
+		uint32_t m_seed;
+};
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_TESTS_TESTRANDOM_HPP__ */
@@ -0,0 +1,339 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * ZipArchiveTest.cpp: ZipArchive test.                                    *
+ *                                                                         *
+ * Copyright (c) 2020 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// zlib
+#include <zlib.h>
+
+// ZipArchive
+#include "librpbase/file/ZipArchive.hpp"
+#include "librpbase/file/RpMemFile.hpp"
+#include "librpbase/tests/TestRandom.hpp"
+using namespace LibRpBase;
+using LibRpBase::Tests::TestRandom;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class ZipArchiveTest : public ::testing::Test
+{
+	protected:
+		ZipArchiveTest()
+			: m_memFile(nullptr)
+			, m_zip(nullptr)
+		{ }
+
+		void SetUp(void) final;
+
+		void TearDown(void) final
+		{
+			delete m_zip;
+			m_zip = nullptr;
+			if (m_memFile) {
+				m_memFile->unref();
+				m_memFile = nullptr;
+			}
+		}
+
+	private:
+		// Central directory record.
+		struct CdRecord {
+			string filename;
+			uint16_t method;
+			uint32_t crc;
+			uint32_t compSize;
+			uint32_t uncompSize;
+			uint32_t headerOffset;
+		};
+
+		/**
+		 * Append a little-endian value.
+		 * @param out Output buffer.
+		 * @param val Value.
+		 * @param bytes Number of bytes.
+		 */
+		static void put(vector<uint8_t> &out, uint32_t val, unsigned int bytes)
+		{
+			for (; bytes > 0; bytes--, val >>= 8) {
+				out.push_back(static_cast<uint8_t>(val & 0xFF));
+			}
+		}
+
+		/**
+		 * Add a member to the ZIP archive.
+		 * @param cd		[in,out] Central directory records.
+		 * @param filename	[in] Filename.
+		 * @param data		[in] Uncompressed data.
+		 * @param compress	[in] If true, compress the data using deflate.
+		 */
+		void addMember(vector<CdRecord> &cd, const char *filename,
+			const vector<uint8_t> &data, bool compress);
+
+	public:
+		// Member sizes.
+		static const unsigned int STORED_SIZE = 100000;
+		static const unsigned int DEFLATED_SIZE = 3*1024*1024 + 4321;
+
+	protected:
+		vector<uint8_t> m_stored;	// Stored member data.
+		vector<uint8_t> m_deflated;	// Deflated member data. (uncompressed)
+		vector<uint8_t> m_zipData;	// ZIP archive.
+
+		RpMemFile *m_memFile;
+		ZipArchive *m_zip;
+};
+
+/**
+ * Add a member to the ZIP archive.
+ * @param cd		[in,out] Central directory records.
+ * @param filename	[in] Filename.
+ * @param data		[in] Uncompressed data.
+ * @param compress	[in] If true, compress the data using deflate.
+ */
+void ZipArchiveTest::addMember(vector<CdRecord> &cd, const char *filename,
+	const vector<uint8_t> &data, bool compress)
+{
+	vector<uint8_t> comp;
+	if (compress) {
+		// Raw deflate.
+		z_stream strm;
+		memset(&strm, 0, sizeof(strm));
+		ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY));
+		comp.resize(deflateBound(&strm, static_cast<uLong>(data.size())));
+		strm.next_in = const_cast<Bytef*>(data.data());
+		strm.avail_in = static_cast<uInt>(data.size());
+		strm.next_out = comp.data();
+		strm.avail_out = static_cast<uInt>(comp.size());
+		ASSERT_EQ(Z_STREAM_END, deflate(&strm, Z_FINISH));
+		comp.resize(strm.total_out);
+		deflateEnd(&strm);
+	} else {
+		comp = data;
+	}
+
+	CdRecord rec;
+	rec.filename = filename;
+	rec.method = (compress ? 8 : 0);
+	rec.crc = crc32(0, data.data(), static_cast<uInt>(data.size()));
+	rec.compSize = static_cast<uint32_t>(comp.size());
+	rec.uncompSize = static_cast<uint32_t>(data.size());
+	rec.headerOffset = static_cast<uint32_t>(m_zipData.size());
+
+	// Local file header.
+	// NOTE: Adding an extra field that isn't in the central
+	// directory to make sure the local header is used.
+	put(m_zipData, 0x04034B50, 4);	// magic
+	put(m_zipData, 20, 2);		// version needed
+	put(m_zipData, 0, 2);		// flags
+	put(m_zipData, rec.method, 2);	// method
+	put(m_zipData, 0, 2);		// mtime
+	put(m_zipData, 0x21, 2);	// mdate (1980/01/01)
+	put(m_zipData, rec.crc, 4);
+	put(m_zipData, rec.compSize, 4);
+	put(m_zipData, rec.uncompSize, 4);
+	put(m_zipData, static_cast<uint32_t>(rec.filename.size()), 2);
+	put(m_zipData, 8, 2);		// extra field length
+	m_zipData.insert(m_zipData.end(), rec.filename.begin(), rec.filename.end());
+	put(m_zipData, 0xCAFE, 2);	// extra field: unknown ID
+	put(m_zipData, 4, 2);
+	put(m_zipData, 0x12345678, 4);
+	m_zipData.insert(m_zipData.end(), comp.begin(), comp.end());
+
+	cd.push_back(std::move(rec));
+}
+
+void ZipArchiveTest::SetUp(void)
+{
+	// Somewhat compressible data.
+	TestRandom rnd(0x12345678);
+	m_stored.resize(STORED_SIZE);
+	rnd.fill(m_stored.data(), m_stored.size());
+	m_deflated.resize(DEFLATED_SIZE);
+	rnd.fillText(m_deflated.data(), m_deflated.size());
+
+	vector<CdRecord> cd;
+	addMember(cd, "stored.bin", m_stored, false);
+	addMember(cd, "dir/deflated.bin", m_deflated, true);
+
+	// Central directory.
+	const uint32_t cdOffset = static_cast<uint32_t>(m_zipData.size());
+	for (auto iter = cd.cbegin(); iter != cd.cend(); ++iter) {
+		put(m_zipData, 0x02014B50, 4);	// magic
+		put(m_zipData, 20, 2);		// version made by
+		put(m_zipData, 20, 2);		// version needed
+		put(m_zipData, 0, 2);		// flags
+		put(m_zipData, iter->method, 2);
+		put(m_zipData, 0, 2);		// mtime
+		put(m_zipData, 0x21, 2);	// mdate
+		put(m_zipData, iter->crc, 4);
+		put(m_zipData, iter->compSize, 4);
+		put(m_zipData, iter->uncompSize, 4);
+		put(m_zipData, static_cast<uint32_t>(iter->filename.size()), 2);
+		put(m_zipData, 0, 2);		// extra field length
+		put(m_zipData, 0, 2);		// comment length
+		put(m_zipData, 0, 2);		// disk number
+		put(m_zipData, 0, 2);		// internal attributes
+		put(m_zipData, 0, 4);		// external attributes
+		put(m_zipData, iter->headerOffset, 4);
+		m_zipData.insert(m_zipData.end(), iter->filename.begin(), iter->filename.end());
+	}
+	const uint32_t cdSize = static_cast<uint32_t>(m_zipData.size()) - cdOffset;
+
+	// End of central directory record.
+	put(m_zipData, 0x06054B50, 4);	// magic
+	put(m_zipData, 0, 2);		// disk number
+	put(m_zipData, 0, 2);		// disk with central directory
+	put(m_zipData, static_cast<uint32_t>(cd.size()), 2);
+	put(m_zipData, static_cast<uint32_t>(cd.size()), 2);
+	put(m_zipData, cdSize, 4);
+	put(m_zipData, cdOffset, 4);
+	put(m_zipData, 0, 2);		// comment length
+
+	m_memFile = new RpMemFile(m_zipData.data(), m_zipData.size());
+	m_zip = new ZipArchive(m_memFile);
+	ASSERT_TRUE(m_zip->isOpen());
+}
+
+/**
+ * All members must be enumerated.
+ */
+TEST_F(ZipArchiveTest, enumerate)
+{
+	ASSERT_EQ(2, m_zip->count());
+
+	const ZipArchive::Entry *entry = m_zip->at(0);
+	ASSERT_TRUE(entry != nullptr);
+	EXPECT_EQ("stored.bin", entry->filename);
+	EXPECT_EQ(ZipArchive::METHOD_STORE, entry->method);
+	EXPECT_EQ(static_cast<off64_t>(STORED_SIZE), entry->uncompSize);
+	EXPECT_FALSE(entry->isDir);
+
+	entry = m_zip->at(1);
+	ASSERT_TRUE(entry != nullptr);
+	EXPECT_EQ("dir/deflated.bin", entry->filename);
+	EXPECT_EQ(ZipArchive::METHOD_DEFLATE, entry->method);
+	EXPECT_EQ(static_cast<off64_t>(DEFLATED_SIZE), entry->uncompSize);
+
+	EXPECT_EQ(1, m_zip->find("dir/deflated.bin"));
+	EXPECT_EQ(-1, m_zip->find("DIR/DEFLATED.BIN"));
+	EXPECT_EQ(1, m_zip->find("DIR/DEFLATED.BIN", true));
+	EXPECT_EQ(-1, m_zip->find("nonexistent.bin"));
+}
+
+/**
+ * Stored members must be readable and mappable.
+ */
+TEST_F(ZipArchiveTest, storedMember)
+{
+	IRpFile *const file = m_zip->open(0);
+	ASSERT_TRUE(file != nullptr);
+	EXPECT_EQ(static_cast<off64_t>(STORED_SIZE), file->size());
+
+	uint8_t buf[1000];
+	ASSERT_EQ(sizeof(buf), file->pread(5000, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, &m_stored[5000], sizeof(buf)));
+
+	// Reading past the end of the member.
+	EXPECT_EQ(100U, file->pread(STORED_SIZE - 100, buf, sizeof(buf)));
+	EXPECT_EQ(0U, file->pread(STORED_SIZE, buf, sizeof(buf)));
+
+	// RpMemFile supports map(), so stored members do, too.
+	const uint8_t *const p = file->map(0, STORED_SIZE);
+	ASSERT_TRUE(p != nullptr);
+	EXPECT_EQ(0, memcmp(p, m_stored.data(), STORED_SIZE));
+	EXPECT_TRUE(file->map(1, STORED_SIZE) == nullptr);
+
+	file->unref();
+}
+
+/**
+ * Deflated members must support random access,
+ * including backwards seeks.
+ */
+TEST_F(ZipArchiveTest, deflatedMember)
+{
+	IRpFile *const file = m_zip->open(1);
+	ASSERT_TRUE(file != nullptr);
+	EXPECT_EQ(static_cast<off64_t>(DEFLATED_SIZE), file->size());
+	EXPECT_TRUE(file->map(0, 16) == nullptr);
+
+	// Typical header probe positions.
+	const off64_t positions[] = {
+		0, 0x7FB0, 0x40000, 0x100, 2*1024*1024, 0x8000,
+		DEFLATED_SIZE - 512, 0,
+	};
+	uint8_t buf[512];
+	for (size_t i = 0; i < sizeof(positions)/sizeof(positions[0]); i++) {
+		const off64_t pos = positions[i];
+		ASSERT_EQ(sizeof(buf), file->pread(pos, buf, sizeof(buf))) << "pos " << pos;
+		ASSERT_EQ(0, memcmp(buf, &m_deflated[static_cast<size_t>(pos)], sizeof(buf))) << "pos " << pos;
+	}
+
+	// Sequential read of the whole member.
+	ASSERT_EQ(0, file->seek(0));
+	vector<uint8_t> all(DEFLATED_SIZE + 100);
+	EXPECT_EQ(static_cast<size_t>(DEFLATED_SIZE), file->read(all.data(), all.size()));
+	EXPECT_EQ(0, memcmp(all.data(), m_deflated.data(), DEFLATED_SIZE));
+
+	file->unref();
+}
+
+/**
+ * Members must remain valid after the ZipArchive is deleted.
+ */
+TEST_F(ZipArchiveTest, memberOutlivesArchive)
+{
+	IRpFile *const file = m_zip->open(0);
+	ASSERT_TRUE(file != nullptr);
+	delete m_zip;
+	m_zip = nullptr;
+
+	uint8_t buf[64];
+	ASSERT_EQ(sizeof(buf), file->pread(0, buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(buf, m_stored.data(), sizeof(buf)));
+	file->unref();
+}
+
+/**
+ * Non-ZIP files must be rejected.
+ */
+TEST_F(ZipArchiveTest, notZip)
+{
+	RpMemFile *const memFile = new RpMemFile(m_stored.data(), m_stored.size());
+	ZipArchive zip(memFile);
+	memFile->unref();
+	EXPECT_FALSE(zip.isOpen());
+	EXPECT_EQ(0, zip.count());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: ZipArchive tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -197,6 +197,53 @@ FileFormat *FileFormatFactory::create(IRpFile *file)
 	return nullptr;
 }
 
+/**
+ * Check if a texture file header has a known magic number.
+ *
+ * This is a cheap pre-check that can be used to avoid
+ * constructing FileFormat subclasses for files that
+ * definitely aren't textures. A positive result does
+ * not guarantee that create() will succeed.
+ *
+ * @param pHeader Header data. (starting at address 0)
+ * @param size Size of header data.
+ * @return True if the magic number matches a supported texture format; false if not.
+ */
+bool FileFormatFactory::isTextureSupported(const uint8_t *pHeader, size_t size)
+{
+	assert(pHeader != nullptr);
+	if (!pHeader || size < sizeof(uint32_t)*2) {
+		// Not enough data.
+		return false;
+	}
+
+	uint32_t magic[2];
+	memcpy(magic, pHeader, sizeof(magic));
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	// Magic number needs to be in host-endian.
+	magic[0] = be32_to_cpu(magic[0]);
+	magic[1] = be32_to_cpu(magic[1]);
+#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+
+	// Khronos KTX has the same 32-bit magic number
+	// for two completely different versions.
+	if (magic[0] == (uint32_t)'\xABKTX') {
+		return (magic[1] == ' 11\xBB' || magic[1] == ' 20\xBB');
+	}
+
+	const FileFormatFactoryPrivate::FileFormatFns *fns =
+		&FileFormatFactoryPrivate::FileFormatFns_magic[0];
+	for (; fns->supportedFileExtensions != nullptr; fns++) {
+		if (magic[0] == fns->magic) {
+			// Found a matching magic number.
+			return true;
+		}
+	}
+
+	// Not supported.
+	return false;
+}
+
 /**
  * Get all supported file extensions.
  * Used for Win32 COM registration.
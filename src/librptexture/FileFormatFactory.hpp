@@ -47,6 +47,20 @@ class FileFormatFactory
 		 */
 		static LibRpTexture::FileFormat *create(LibRpBase::IRpFile *file);
 
+		/**
+		 * Check if a texture file header has a known magic number.
+		 *
+		 * This is a cheap pre-check that can be used to avoid
+		 * constructing FileFormat subclasses for files that
+		 * definitely aren't textures. A positive result does
+		 * not guarantee that create() will succeed.
+		 *
+		 * @param pHeader Header data. (starting at address 0)
+		 * @param size Size of header data.
+		 * @return True if the magic number matches a supported texture format; false if not.
+		 */
+		static bool isTextureSupported(const uint8_t *pHeader, size_t size);
+
 		/**
 		 * Get all supported file extensions.
 		 * Used for Win32 COM registration.
@@ -0,0 +1,172 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPosix.cpp: POSIX thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpBase {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param arg User-specified argument.
+		 */
+		typedef void (*ThreadFn)(void *arg);
+
+		/**
+		 * Create a thread object.
+		 * The thread isn't started until start() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete;
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &);
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param fn Thread function.
+		 * @param arg User-specified argument.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int start(ThreadFn fn, void *arg);
+
+		/**
+		 * Wait for the thread to finish.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of online CPUs.
+		 * @return Number of online CPUs. (always at least 1)
+		 */
+		static inline unsigned int cpuCount(void);
+
+	private:
+		/**
+		 * pthread_create() wrapper function.
+		 * @param param Thread.
+		 * @return nullptr
+		 */
+		static inline void *threadProc(void *param);
+
+	private:
+		pthread_t m_thread;
+		ThreadFn m_fn;
+		void *m_arg;
+		bool m_isRunning;
+};
+
+/**
+ * Create a thread object.
+ * The thread isn't started until start() is called.
+ */
+inline Thread::Thread()
+	: m_fn(nullptr)
+	, m_arg(nullptr)
+	, m_isRunning(false)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_isRunning) {
+		join();
+	}
+}
+
+/**
+ * pthread_create() wrapper function.
+ * @param param Thread.
+ * @return nullptr
+ */
+inline void *Thread::threadProc(void *param)
+{
+	Thread *const thread = static_cast<Thread*>(param);
+	thread->m_fn(thread->m_arg);
+	return nullptr;
+}
+
+/**
+ * Start the thread.
+ * @param fn Thread function.
+ * @param arg User-specified argument.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::start(ThreadFn fn, void *arg)
+{
+	assert(fn != nullptr);
+	assert(!m_isRunning);
+	if (!fn) {
+		return -EINVAL;
+	} else if (m_isRunning) {
+		return -EBUSY;
+	}
+
+	m_fn = fn;
+	m_arg = arg;
+	int ret = pthread_create(&m_thread, nullptr, threadProc, this);
+	if (ret != 0) {
+		return -ret;
+	}
+	m_isRunning = true;
+	return 0;
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_isRunning) {
+		return -ESRCH;
+	}
+
+	int ret = pthread_join(m_thread, nullptr);
+	m_isRunning = false;
+	return -ret;
+}
+
+/**
+ * Get the number of online CPUs.
+ * @return Number of online CPUs. (always at least 1)
+ */
+inline unsigned int Thread::cpuCount(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0 ? static_cast<unsigned int>(count) : 1);
+#else /* !_SC_NPROCESSORS_ONLN */
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+}
@@ -0,0 +1,174 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadWin32.cpp: Win32 thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#include <process.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpBase {
+
+class Thread
+{
+	public:
+		/**
+		 * Thread function.
+		 * @param arg User-specified argument.
+		 */
+		typedef void (*ThreadFn)(void *arg);
+
+		/**
+		 * Create a thread object.
+		 * The thread isn't started until start() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete;
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &);
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param fn Thread function.
+		 * @param arg User-specified argument.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int start(ThreadFn fn, void *arg);
+
+		/**
+		 * Wait for the thread to finish.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of online CPUs.
+		 * @return Number of online CPUs. (always at least 1)
+		 */
+		static inline unsigned int cpuCount(void);
+
+	private:
+		/**
+		 * _beginthreadex() wrapper function.
+		 * @param param Thread.
+		 * @return 0
+		 */
+		static inline unsigned int WINAPI threadProc(void *param);
+
+	private:
+		HANDLE m_hThread;
+		ThreadFn m_fn;
+		void *m_arg;
+};
+
+/**
+ * Create a thread object.
+ * The thread isn't started until start() is called.
+ */
+inline Thread::Thread()
+	: m_hThread(nullptr)
+	, m_fn(nullptr)
+	, m_arg(nullptr)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_hThread) {
+		join();
+	}
+}
+
+/**
+ * _beginthreadex() wrapper function.
+ * @param param Thread.
+ * @return 0
+ */
+inline unsigned int WINAPI Thread::threadProc(void *param)
+{
+	Thread *const thread = static_cast<Thread*>(param);
+	thread->m_fn(thread->m_arg);
+	return 0;
+}
+
+/**
+ * Start the thread.
+ * @param fn Thread function.
+ * @param arg User-specified argument.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::start(ThreadFn fn, void *arg)
+{
+	assert(fn != nullptr);
+	assert(m_hThread == nullptr);
+	if (!fn) {
+		return -EINVAL;
+	} else if (m_hThread) {
+		return -EBUSY;
+	}
+
+	m_fn = fn;
+	m_arg = arg;
+	// NOTE: _beginthreadex() is required instead of CreateThread()
+	// in order to initialize the MSVCRT per-thread data.
+	m_hThread = reinterpret_cast<HANDLE>(_beginthreadex(nullptr, 0, threadProc, this, 0, nullptr));
+	if (!m_hThread) {
+		// TODO: Convert the Win32 error code?
+		return -EAGAIN;
+	}
+	return 0;
+}
+
+/**
+ * Wait for the thread to finish.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_hThread) {
+		return -ESRCH;
+	}
+
+	DWORD dwRet = WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	m_hThread = nullptr;
+	return (dwRet == WAIT_OBJECT_0 ? 0 : -EIO);
+}
+
+/**
+ * Get the number of online CPUs.
+ * @return Number of online CPUs. (always at least 1)
+ */
+inline unsigned int Thread::cpuCount(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (si.dwNumberOfProcessors > 0 ? si.dwNumberOfProcessors : 1);
+}
+
+}
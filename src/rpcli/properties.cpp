@@ -653,9 +653,10 @@ public:
 class FieldsOutput {
 	const RomFields& fields;
 	uint32_t lc;
+	uint32_t tabMask;
 public:
-	explicit FieldsOutput(const RomFields& fields, uint32_t lc = 0)
-		: fields(fields), lc(lc) { }
+	explicit FieldsOutput(const RomFields& fields, uint32_t lc = 0, uint32_t tabMask = RomFields::TAB_MASK_ALL)
+		: fields(fields), lc(lc), tabMask(tabMask) { }
 	friend std::ostream& operator<<(std::ostream& os, const FieldsOutput& fo) {
 		size_t maxWidth = 0;
 		const auto iter_end = fo.fields.cend();
@@ -674,7 +675,7 @@ public:
 		bool printed_first = false;
 		for (auto iter = fo.fields.cbegin(); iter != iter_end; ++iter) {
 			const auto &romField = *iter;
-			if (!romField.isValid)
+			if (!romField.isValid || !RomFields::isTabSelected(fo.tabMask, romField.tabIdx))
 				continue;
 
 			if (printed_first)
@@ -682,8 +683,9 @@ public:
 
 			// New tab?
 			if (tabCount > 1 && tabIdx != romField.tabIdx) {
-				// Tab indexes must be consecutive.
-				assert(tabIdx + 1 == romField.tabIdx);
+				// Tab indexes must be increasing.
+				// (They might not be consecutive if some tabs weren't selected.)
+				assert(tabIdx < romField.tabIdx);
 				tabIdx = romField.tabIdx;
 
 				// TODO: Better formatting?
@@ -794,15 +796,17 @@ public:
 
 class JSONFieldsOutput {
 	const RomFields& fields;
+	uint32_t tabMask;
 public:
-	explicit JSONFieldsOutput(const RomFields& fields) :fields(fields) {}
+	explicit JSONFieldsOutput(const RomFields& fields, uint32_t tabMask = RomFields::TAB_MASK_ALL)
+		: fields(fields), tabMask(tabMask) {}
 	friend std::ostream& operator<<(std::ostream& os, const JSONFieldsOutput& fo) {
 		os << "[\n";
 		bool printed_first = false;
 		const auto iter_end = fo.fields.cend();
 		for (auto iter = fo.fields.cbegin(); iter != iter_end; ++iter) {
 			const auto &romField = *iter;
-			if (!romField.isValid)
+			if (!romField.isValid || !RomFields::isTabSelected(fo.tabMask, romField.tabIdx))
 				continue;
 
 			if (printed_first)
@@ -1067,9 +1071,10 @@ public:
 
 
 
-ROMOutput::ROMOutput(const RomData *romdata, uint32_t lc)
+ROMOutput::ROMOutput(const RomData *romdata, uint32_t lc, uint32_t tabMask)
 	: romdata(romdata)
-	, lc(lc) { }
+	, lc(lc)
+	, tabMask(tabMask) { }
 std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 	auto romdata = fo.romdata;
 	const char *const systemName = romdata->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
@@ -1080,10 +1085,10 @@ std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 	os << "-- " << (systemName ? systemName : "(unknown system)") <<
 	      ' ' << (fileType ? fileType : "(unknown filetype)") <<
 	      " detected" << endl;
-	const RomFields *const fields = romdata->fields();
+	const RomFields *const fields = romdata->fields(fo.tabMask);
 	assert(fields != nullptr);
 	if (fields) {
-		os << FieldsOutput(*fields, fo.lc) << endl;
+		os << FieldsOutput(*fields, fo.lc, fo.tabMask) << endl;
 	}
 
 	const int supported = romdata->supportedImageTypes();
@@ -1129,9 +1134,10 @@ std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 	return os;
 }
 
-JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc)
+JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc, uint32_t tabMask)
 	: romdata(romdata)
-	, lc(lc) { }
+	, lc(lc)
+	, tabMask(tabMask) { }
 std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 	auto romdata = fo.romdata;
 	assert(romdata && romdata->isValid());
@@ -1153,10 +1159,10 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 	} else {
 		os << "\"unknown\"";
 	}
-	const RomFields *const fields = romdata->fields();
+	const RomFields *const fields = romdata->fields(fo.tabMask);
 	assert(fields != nullptr);
 	if (fields) {
-		os << ",\"fields\":" << JSONFieldsOutput(*fields);
+		os << ",\"fields\":" << JSONFieldsOutput(*fields, fo.tabMask);
 	}
 
 	const int supported = romdata->supportedImageTypes();
@@ -19,16 +19,18 @@ namespace LibRpBase {
 class ROMOutput {
 	const LibRpBase::RomData *const romdata;
 	uint32_t lc;
+	uint32_t tabMask;
 public:
-	explicit ROMOutput(const LibRpBase::RomData *romdata, uint32_t lc = 0);
+	explicit ROMOutput(const LibRpBase::RomData *romdata, uint32_t lc = 0, uint32_t tabMask = ~0U);
 	friend std::ostream& operator<<(std::ostream& os, const ROMOutput& fo);
 };
 
 class JSONROMOutput {
 	const LibRpBase::RomData *const romdata;
 	uint32_t lc;
+	uint32_t tabMask;
 public:
-	explicit JSONROMOutput(const LibRpBase::RomData *romdata, uint32_t lc = 0);
+	explicit JSONROMOutput(const LibRpBase::RomData *romdata, uint32_t lc = 0, uint32_t tabMask = ~0U);
 	friend std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo);
 };
 
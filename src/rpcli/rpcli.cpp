@@ -14,16 +14,20 @@
 #include "librpbase/config.librpbase.h"
 #include "librpbase/byteswap.h"
 #include "librpbase/RomData.hpp"
+#include "librpbase/RomFields.hpp"
 #include "librpbase/SystemRegion.hpp"
 #include "libi18n/i18n.h"
 using namespace LibRpBase;
 
 // libromdata
 #include "librpbase/TextFuncs.hpp"
+#include "librpbase/file/IoStats.hpp"
 #include "librpbase/file/RpFile.hpp"
+#include "librpbase/file/ZipArchive.hpp"
 #include "librpbase/img/RpPng.hpp"
 #include "librpbase/img/IconAnimData.hpp"
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/Console/GameCube.hpp"
 using namespace LibRomData;
 
 // librptexture
@@ -50,7 +54,9 @@ using LibRpTexture::rp_image;
 #include <cerrno>
 
 // C++ includes.
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <locale>
 #include <string>
@@ -60,6 +66,7 @@ using std::cerr;
 using std::endl;
 using std::locale;
 using std::ofstream;
+using std::setw;
 using std::string;
 using std::vector;
 
@@ -147,34 +154,125 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 }
 
 /**
- * Shows info about file
- * @param filename ROM filename
+ * Shows info about an open file.
+ * @param file Open file
  * @param json Is program running in json mode?
  * @param extract Vector of image extraction parameters
  * @param languageCode Language code. (0 for default)
+ * @param tabMask RomFields::TabMask of tabs to show.
+ * @param verifyHashes Verify Wii disc image hashes.
+ * @return True if the file is supported; false if not.
  */
-static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0)
+static bool DoRomData(IRpFile *file, bool json, vector<ExtractParam>& extract,
+	uint32_t languageCode, uint32_t tabMask, bool verifyHashes)
 {
-	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
-	if (file->isOpen()) {
-		RomData *romData = RomDataFactory::create(file);
-		if (romData && romData->isValid()) {
-			if (json) {
-				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
-				cout << JSONROMOutput(romData, languageCode) << endl;
-			} else {
-				cout << ROMOutput(romData, languageCode) << endl;
+	RomData *romData = RomDataFactory::create(file);
+	const bool isSupported = (romData && romData->isValid());
+	if (isSupported) {
+		if (verifyHashes) {
+			GameCube *const gcn = dynamic_cast<GameCube*>(romData);
+			if (gcn) {
+				gcn->setHashVerificationEnabled(true);
 			}
+		}
 
-			ExtractImages(romData, extract);
+		if (json) {
+			cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
+			cout << JSONROMOutput(romData, languageCode, tabMask) << endl;
 		} else {
+			cout << ROMOutput(romData, languageCode, tabMask) << endl;
+		}
+
+		ExtractImages(romData, extract);
+
+		if (tabMask == RomFields::TAB_MASK_ALL && !verifyHashes) {
+			// Store the fields in the detection cache, if it's enabled.
+			// NOTE: Not done if only some tabs were shown, since
+			// that would load the other tabs. Hash verification
+			// results aren't cached, either.
+			RomDataFactory::updateDetectCache(file, romData);
+		}
+	}
+
+	if (romData) {
+		romData->unref();
+	}
+	return isSupported;
+}
+
+/**
+ * Shows info about each member of a ZIP archive.
+ * Images are only extracted from the first supported member,
+ * since every member would use the same output filenames.
+ * @param zip ZIP archive
+ * @param json Is program running in json mode?
+ * @param extract Vector of image extraction parameters
+ * @param languageCode Language code. (0 for default)
+ * @param tabMask RomFields::TabMask of tabs to show.
+ * @param verifyHashes Verify Wii disc image hashes.
+ */
+static void DoZipArchive(ZipArchive &zip, bool json, vector<ExtractParam>& extract,
+	uint32_t languageCode, uint32_t tabMask, bool verifyHashes)
+{
+	vector<ExtractParam> noExtract;
+	bool extracted = false;
+
+	const int count = zip.count();
+	for (int i = 0; i < count; i++) {
+		if (zip.at(i)->isDir)
+			continue;
+
+		IRpFile *const file = zip.open(i);
+		if (!file) {
+			cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open archive member '%s': %s"),
+				zip.at(i)->filename.c_str(), strerror(zip.lastError())) << endl;
+			if (json) cout << "{\"error\":\"couldn't open archive member\",\"code\":" << zip.lastError() << "}" << endl;
+			continue;
+		}
+
+		cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), file->filename().c_str()) << endl;
+		if (!DoRomData(file, json, (extracted ? noExtract : extract),
+		               languageCode, tabMask, verifyHashes))
+		{
 			cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
 			if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+		} else if (!extract.empty()) {
+			if (extracted) {
+				cerr << "-- " << C_("rpcli", "Images were already extracted from a previous archive member; skipping") << endl;
+			}
+			extracted = true;
 		}
+		file->unref();
+	}
+}
 
-		if (romData) {
-			romData->unref();
+/**
+ * Shows info about file
+ * @param filename ROM filename
+ * @param json Is program running in json mode?
+ * @param extract Vector of image extraction parameters
+ * @param languageCode Language code. (0 for default)
+ * @param tabMask RomFields::TabMask of tabs to show.
+ * @param verifyHashes Verify Wii disc image hashes.
+ */
+static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract,
+	uint32_t languageCode = 0, uint32_t tabMask = RomFields::TAB_MASK_ALL,
+	bool verifyHashes = false)
+{
+	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	if (file->isOpen()) {
+		if (!DoRomData(file, json, extract, languageCode, tabMask, verifyHashes)) {
+			// Not a supported ROM image.
+			// If it's a ZIP archive, check each member.
+			ZipArchive zip(file);
+			if (zip.isOpen()) {
+				cerr << "-- " << rp_sprintf(C_("rpcli", "Reading ZIP archive with %d member(s)"), zip.count()) << endl;
+				DoZipArchive(zip, json, extract, languageCode, tabMask, verifyHashes);
+			} else {
+				cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
+				if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+			}
 		}
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
@@ -183,6 +281,44 @@ static void DoFile(const char *filename, bool json, vector<ExtractParam>& extrac
 	file->unref();
 }
 
+/**
+ * Print an I/O statistics table.
+ * Only layers that were used between the two snapshots are shown.
+ * @param title Table title.
+ * @param before IoStats snapshot taken before the I/O.
+ * @param after IoStats snapshot taken after the I/O.
+ */
+static void PrintIoStats(const char *title,
+	const vector<IoStats::LayerStats> &before,
+	const vector<IoStats::LayerStats> &after)
+{
+	assert(before.size() == after.size());
+	cerr << "-- " << title << endl;
+	cerr << "   " << std::left << setw(16) << C_("rpcli", "Layer") << std::right <<
+		setw(10) << C_("rpcli", "Reads") <<
+		setw(14) << C_("rpcli", "Bytes read") <<
+		setw(10) << C_("rpcli", "Seeks") <<
+		setw(14) << C_("rpcli", "Consumed") << endl;
+
+	uint64_t consumed = 0;
+	const size_t count = std::min(before.size(), after.size());
+	for (size_t i = 0; i < count; i++) {
+		const IoStats::LayerStats &a = after[i];
+		const IoStats::LayerStats &b = before[i];
+		if (a.reads == b.reads && a.seeks == b.seeks) {
+			// Layer wasn't used.
+			continue;
+		}
+		cerr << "   " << std::left << setw(16) << a.name << std::right <<
+			setw(10) << (a.reads - b.reads) <<
+			setw(14) << (a.bytesRead - b.bytesRead) <<
+			setw(10) << (a.seeks - b.seeks) <<
+			setw(14) << (a.consumed - b.consumed) << endl;
+		consumed += (a.consumed - b.consumed);
+	}
+	cerr << "   " << C_("rpcli", "Total bytes consumed by the parser:") << ' ' << consumed << endl;
+}
+
 /**
  * Print the system region information.
  */
@@ -313,14 +449,18 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-d] [-j] [-l lang] [-s] [-t tab] [-v] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-d] [-j] [-l lang] [-s] [-t tab] [-v] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
+		cerr << "  -d:   " << C_("rpcli", "Use the persistent detection and gzip index caches.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
+		cerr << "  -s:   " << C_("rpcli", "Print I/O statistics for each file, and for all files.") << endl;
+		cerr << "  -t:   " << C_("rpcli", "Only show the specified tab. (can be specified multiple times)") << endl;
+		cerr << "  -v:   " << C_("rpcli", "Verify Wii disc image hashes. (reads the entire disc image)") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
 		cerr << endl;
@@ -354,6 +494,9 @@ int RP_C_API main(int argc, char *argv[])
 	bool inq_ata = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
 	uint32_t languageCode = 0;
+	uint32_t tabMask = RomFields::TAB_MASK_NONE;
+	bool verifyHashes = false;
+	vector<IoStats::LayerStats> ioStatsStart, ioStatsBefore, ioStatsAfter;
 	bool first = true;
 	int ret = 0;
 	for (int i = 1; i < argc; i++){
@@ -375,6 +518,29 @@ int RP_C_API main(int argc, char *argv[])
 				PrintSystemRegion();
 				break;
 			}
+			case 'd': {
+				// Use the persistent detection and gzip index caches.
+				// NOTE: Cached fields don't have hash verification results.
+				RomDataFactory::setDetectCacheEnabled(!verifyHashes);
+				RpFile::setGzIndexCacheEnabled(true);
+				break;
+			}
+			case 's': {
+				// Print I/O statistics.
+				if (!IoStats::isEnabled()) {
+					IoStats::setEnabled(true);
+					IoStats::snapshot(ioStatsStart);
+				}
+				break;
+			}
+			case 'v': {
+				// Verify Wii disc image hashes.
+				// NOTE: Cached fields don't have hash verification results,
+				// so the detection cache can't be used.
+				verifyHashes = true;
+				RomDataFactory::setDetectCacheEnabled(false);
+				break;
+			}
 			case 'l': {
 				// Language code.
 				// NOTE: Actual language may be immediately after 'l',
@@ -408,6 +574,29 @@ int RP_C_API main(int argc, char *argv[])
 				languageCode = lc;
 				break;
 			}
+			case 't': {
+				// Tab index.
+				// NOTE: Like the language code, the tab mask
+				// affects files specified *after* it.
+				const char *s_tab;
+				if (argv[i][2] == '\0') {
+					// Separate argument.
+					s_tab = argv[i+1];
+					i++;
+				} else {
+					// Same argument.
+					s_tab = &argv[i][2];
+				}
+
+				char *endptr = nullptr;
+				const long tabIdx = (s_tab ? strtol(s_tab, &endptr, 10) : -1);
+				if (!s_tab || *endptr != '\0' || tabIdx < 0 || tabIdx >= 32) {
+					cerr << rp_sprintf(C_("rpcli", "Warning: ignoring invalid tab index '%s'"), (s_tab ? s_tab : "")) << endl;
+					break;
+				}
+				tabMask |= RomFields::tabMaskBit(static_cast<int>(tabIdx));
+				break;
+			}
 			case 'x': {
 				long num = atol(argv[i] + 2);
 				if (num<RomData::IMG_INT_MIN || num>RomData::IMG_INT_MAX) {
@@ -456,7 +645,16 @@ int RP_C_API main(int argc, char *argv[])
 #endif /* RP_OS_SCSI_SUPPORTED */
 			{
 				// Regular file.
-				DoFile(argv[i], json, extract, languageCode);
+				if (IoStats::isEnabled()) {
+					IoStats::snapshot(ioStatsBefore);
+				}
+				DoFile(argv[i], json, extract, languageCode,
+					(tabMask != RomFields::TAB_MASK_NONE ? tabMask : RomFields::TAB_MASK_ALL),
+					verifyHashes);
+				if (IoStats::isEnabled()) {
+					IoStats::snapshot(ioStatsAfter);
+					PrintIoStats(C_("rpcli", "I/O statistics:"), ioStatsBefore, ioStatsAfter);
+				}
 			}
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -467,5 +665,9 @@ int RP_C_API main(int argc, char *argv[])
 		}
 	}
 	if (json) cout << "]\n";
+	if (IoStats::isEnabled()) {
+		IoStats::snapshot(ioStatsAfter);
+		PrintIoStats(C_("rpcli", "I/O statistics for all files:"), ioStatsStart, ioStatsAfter);
+	}
 	return ret;
 }